@@ -0,0 +1,185 @@
+/**
+ * This module implements a benchmark of the AT server responses, over a pseudo-terminal.
+ *
+ * A host thread sends a command on the master side of the pty, and waits for its whole response
+ * (intermediate responses and final result code) before sending the next one. The number of
+ * responses per second is logged.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+#include "legato.h"
+#include "interfaces.h"
+#include <termios.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of commands sent
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_COMMANDS          2000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of intermediate responses per command
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_INTERMEDIATES     4
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timeout waiting for a response, in milliseconds
+ */
+//--------------------------------------------------------------------------------------------------
+#define RESPONSE_TIMEOUT_MS     10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmarked command
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_CMD               "AT+BENCH"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expected response to the benchmarked command
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_RSP               "\r\n+BENCH: 0\r\n" \
+                                "+BENCH: 1\r\n" \
+                                "+BENCH: 2\r\n" \
+                                "+BENCH: 3\r\n" \
+                                "\r\nOK\r\n"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Master side of the pty, used by the host
+ */
+//--------------------------------------------------------------------------------------------------
+static int MasterFd = -1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmarked command handler: send the intermediate responses and the final result code
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchCmdHandler
+(
+    le_atServer_CmdRef_t commandRef,
+    le_atServer_Type_t type,
+    uint32_t parametersNumber,
+    void* contextPtr
+)
+{
+    char rsp[LE_ATDEFS_RESPONSE_MAX_BYTES];
+    int i;
+
+    for (i = 0; i < BENCH_INTERMEDIATES; i++)
+    {
+        snprintf(rsp, sizeof(rsp), "+BENCH: %d", i);
+        LE_ASSERT_OK(le_atServer_SendIntermediateResponse(commandRef, rsp));
+    }
+
+    LE_ASSERT_OK(le_atServer_SendFinalResultCode(commandRef, LE_ATSERVER_OK, "", 0));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a whole response from the pty and check it
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadResponse
+(
+    void
+)
+{
+    char buf[sizeof(BENCH_RSP)];
+    size_t offset = 0;
+    struct pollfd pollFd = { .fd = MasterFd, .events = POLLIN };
+
+    while (offset < (sizeof(buf) - 1))
+    {
+        int ret = poll(&pollFd, 1, RESPONSE_TIMEOUT_MS);
+        LE_FATAL_IF(ret <= 0, "Timed out waiting for the response");
+
+        ssize_t size = read(MasterFd, buf + offset, sizeof(buf) - 1 - offset);
+        LE_FATAL_IF(size <= 0, "read failed: %m");
+
+        offset += size;
+    }
+
+    buf[offset] = '\0';
+    LE_FATAL_IF(strcmp(buf, BENCH_RSP) != 0, "Unexpected response");
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Host thread: send the commands and measure the responses rate
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void* AtHost
+(
+    void* contextPtr
+)
+{
+    static const char cmd[] = BENCH_CMD "\r";
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    int i;
+
+    for (i = 0; i < BENCH_COMMANDS; i++)
+    {
+        LE_FATAL_IF(write(MasterFd, cmd, sizeof(cmd) - 1) != (sizeof(cmd) - 1),
+                    "write failed: %m");
+        ReadResponse();
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    uint64_t elapsedUs = ((uint64_t)elapsed.sec * 1000000) + elapsed.usec;
+
+    LE_INFO("%d responses (%d lines each) in %" PRIu64 " us: %" PRIu64 " responses/s",
+            BENCH_COMMANDS,
+            BENCH_INTERMEDIATES + 1,
+            elapsedUs,
+            ((uint64_t)BENCH_COMMANDS * 1000000) / (elapsedUs ? elapsedUs : 1));
+
+    exit(EXIT_SUCCESS);
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the benchmark
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    struct termios tios;
+    int slaveFd;
+
+    MasterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    LE_ASSERT(MasterFd != -1);
+    LE_ASSERT(grantpt(MasterFd) == 0);
+    LE_ASSERT(unlockpt(MasterFd) == 0);
+
+    slaveFd = open(ptsname(MasterFd), O_RDWR | O_NOCTTY);
+    LE_ASSERT(slaveFd != -1);
+
+    // Raw mode: no echo, no line discipline processing of CR/LF
+    LE_ASSERT(tcgetattr(slaveFd, &tios) == 0);
+    cfmakeraw(&tios);
+    LE_ASSERT(tcsetattr(slaveFd, TCSANOW, &tios) == 0);
+
+    // The AT server owns the slave side from now on
+    LE_ASSERT(le_atServer_Open(slaveFd) != NULL);
+
+    le_atServer_CmdRef_t cmdRef = le_atServer_Create(BENCH_CMD);
+    LE_ASSERT(cmdRef != NULL);
+    LE_ASSERT(le_atServer_AddCommandHandler(cmdRef, BenchCmdHandler, NULL) != NULL);
+
+    le_thread_Start(le_thread_Create("atHostThread", AtHost, NULL));
+}
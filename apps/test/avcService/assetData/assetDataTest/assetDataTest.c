@@ -19,6 +19,20 @@ le_sem_Ref_t SemCreateOne;
 le_sem_Ref_t SemCreateTwo;
 
 
+// Size of the object used to benchmark the TLV encoding; the asset model is in asset_v2.cfg
+#define BENCH_NUM_INSTANCES 1000
+#define BENCH_NUM_FIELDS 20
+#define BENCH_NUM_INT_FIELDS 10
+#define BENCH_NUM_ITERATIONS 100
+
+// Large enough for the object: at most 256 bytes per instance
+#define BENCH_TLV_NUMBYTES (BENCH_NUM_INSTANCES * 256)
+
+static assetData_InstanceDataRef_t BenchInstanceRefs[BENCH_NUM_INSTANCES];
+static uint8_t BenchTlvBufferOne[BENCH_TLV_NUMBYTES];
+static uint8_t BenchTlvBufferTwo[BENCH_TLV_NUMBYTES];
+
+
 
 void banner(char *testName)
 {
@@ -397,6 +411,138 @@ void RunTest(void)
 }
 
 
+// Microseconds elapsed since the given start time
+static long ElapsedUsec(le_clk_Time_t startTime)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return elapsed.sec * 1000000 + elapsed.usec;
+}
+
+
+void RunTlvBenchmark(void)
+{
+    int i;
+    int fieldId;
+    int value;
+    double floatValue;
+    char name[32];
+    long elapsedUsec;
+    size_t bytesWritten;
+    size_t bytesWrittenOne;
+    size_t bytesWrittenTwo;
+    le_clk_Time_t startTime;
+    assetData_AssetDataRef_t assetRef;
+
+    banner("Object TLV Benchmark");
+
+    for (i=0; i<BENCH_NUM_INSTANCES; i++)
+    {
+        LE_TEST(LE_OK == assetData_CreateInstanceById("testOne", 2000, i, &BenchInstanceRefs[i]));
+    }
+    LE_TEST(LE_OK == assetData_GetAssetRefById("testOne", 2000, &assetRef));
+
+    // Field lookups by id and by name, in every instance
+    startTime = le_clk_GetRelativeTime();
+    for (i=0; i<BENCH_NUM_INSTANCES; i++)
+    {
+        for (fieldId=0; fieldId<BENCH_NUM_INT_FIELDS; fieldId++)
+        {
+            LE_ASSERT(LE_OK == assetData_client_GetInt(BenchInstanceRefs[i], fieldId, &value));
+            LE_ASSERT(value == fieldId);
+        }
+        for (; fieldId<BENCH_NUM_FIELDS; fieldId++)
+        {
+            LE_ASSERT(LE_OK == assetData_client_GetFloat(BenchInstanceRefs[i], fieldId, &floatValue));
+            LE_ASSERT(floatValue == fieldId + 0.5);
+        }
+    }
+    elapsedUsec = ElapsedUsec(startTime);
+    LE_INFO("Get %d fields by id: %ld us", BENCH_NUM_INSTANCES * BENCH_NUM_FIELDS, elapsedUsec);
+
+    snprintf(name, sizeof(name), "Sensor%02d/level", BENCH_NUM_FIELDS - 1);
+    startTime = le_clk_GetRelativeTime();
+    for (i=0; i<BENCH_NUM_INSTANCES; i++)
+    {
+        LE_ASSERT(LE_OK == assetData_GetFieldIdFromName(BenchInstanceRefs[i], name, &fieldId));
+        LE_ASSERT(BENCH_NUM_FIELDS - 1 == fieldId);
+    }
+    elapsedUsec = ElapsedUsec(startTime);
+    LE_INFO("Get %d field ids by name: %ld us", BENCH_NUM_INSTANCES, elapsedUsec);
+
+    // The first encoding of the object builds the instance TLVs, the next ones reuse them
+    startTime = le_clk_GetRelativeTime();
+    LE_TEST(LE_OK == assetData_WriteObjectToTLV(assetRef, -1, BenchTlvBufferOne,
+                                                sizeof(BenchTlvBufferOne), &bytesWrittenOne));
+    elapsedUsec = ElapsedUsec(startTime);
+    LE_INFO("Write object to TLV (%zu bytes), first time: %ld us", bytesWrittenOne, elapsedUsec);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i=0; i<BENCH_NUM_ITERATIONS; i++)
+    {
+        LE_ASSERT(LE_OK == assetData_WriteObjectToTLV(assetRef, -1, BenchTlvBufferTwo,
+                                                      sizeof(BenchTlvBufferTwo), &bytesWritten));
+    }
+    elapsedUsec = ElapsedUsec(startTime);
+    LE_INFO("Write object to TLV, unchanged: %ld us per object", elapsedUsec / BENCH_NUM_ITERATIONS);
+
+    LE_TEST(bytesWrittenOne == bytesWritten);
+    LE_TEST(0 == memcmp(BenchTlvBufferOne, BenchTlvBufferTwo, bytesWritten));
+
+    // A write to one field of every instance must show in the next encoding
+    startTime = le_clk_GetRelativeTime();
+    for (i=0; i<BENCH_NUM_ITERATIONS; i++)
+    {
+        LE_ASSERT(LE_OK == assetData_client_SetInt(BenchInstanceRefs[i % BENCH_NUM_INSTANCES],
+                                                   0, i + 1));
+        LE_ASSERT(LE_OK == assetData_WriteObjectToTLV(assetRef, -1, BenchTlvBufferTwo,
+                                                      sizeof(BenchTlvBufferTwo), &bytesWritten));
+    }
+    elapsedUsec = ElapsedUsec(startTime);
+    LE_INFO("Write object to TLV, one instance changed: %ld us per object",
+            elapsedUsec / BENCH_NUM_ITERATIONS);
+
+    for (i=0; i<BENCH_NUM_INSTANCES; i++)
+    {
+        LE_ASSERT(LE_OK == assetData_client_SetInt(BenchInstanceRefs[i], 0, 1000 + i));
+    }
+
+    startTime = le_clk_GetRelativeTime();
+    LE_TEST(LE_OK == assetData_WriteObjectToTLV(assetRef, -1, BenchTlvBufferTwo,
+                                                sizeof(BenchTlvBufferTwo), &bytesWrittenTwo));
+    elapsedUsec = ElapsedUsec(startTime);
+    LE_INFO("Write object to TLV, all instances changed: %ld us", elapsedUsec);
+
+    LE_TEST(bytesWrittenOne == bytesWrittenTwo);
+    LE_TEST(0 != memcmp(BenchTlvBufferOne, BenchTlvBufferTwo, bytesWrittenTwo));
+
+    // Restoring the default values through the server path restores the first encoding
+    for (i=0; i<BENCH_NUM_INSTANCES; i++)
+    {
+        LE_ASSERT(LE_OK == assetData_client_GetInt(BenchInstanceRefs[i], 0, &value));
+        LE_ASSERT(1000 + i == value);
+        LE_ASSERT(LE_OK == assetData_server_SetValue(BenchInstanceRefs[i], 0, "0"));
+    }
+    LE_TEST(LE_OK == assetData_WriteObjectToTLV(assetRef, -1, BenchTlvBufferTwo,
+                                                sizeof(BenchTlvBufferTwo), &bytesWrittenTwo));
+    LE_TEST(bytesWrittenOne == bytesWrittenTwo);
+    LE_TEST(0 == memcmp(BenchTlvBufferOne, BenchTlvBufferTwo, bytesWrittenTwo));
+
+    // Deleted instances must no longer be found, while the other ones still are
+    assetData_InstanceDataRef_t instanceRef;
+
+    for (i=0; i<BENCH_NUM_INSTANCES-1; i++)
+    {
+        assetData_DeleteInstanceAndAsset(BenchInstanceRefs[i]);
+    }
+    LE_TEST(LE_NOT_FOUND == assetData_GetInstanceRefById("testOne", 2000, 0, &instanceRef));
+    LE_TEST(LE_OK == assetData_GetInstanceRefById("testOne", 2000, i, &instanceRef));
+    LE_TEST(BenchInstanceRefs[i] == instanceRef);
+
+    assetData_DeleteInstanceAndAsset(BenchInstanceRefs[i]);
+}
+
+
 COMPONENT_INIT
 {
     LE_TEST_INIT;
@@ -412,6 +558,7 @@ COMPONENT_INIT
     SemCreateTwo = le_sem_Create("SemCreateTwo", 0);
 
     RunTest();
+    RunTlvBenchmark();
 
     LE_TEST_EXIT;
 }
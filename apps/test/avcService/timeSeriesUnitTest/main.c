@@ -0,0 +1,431 @@
+/**
+ * This module implements the unit tests for the time series streaming encoder.
+ *
+ * Time series are encoded the way the AirVantage daemon does (header map, then delta encoded
+ * samples in an indefinite length array), and the decompressed payload is compared with the same
+ * CBOR stream encoded in a single buffer. For 100k-point series, the encoding rate and the push
+ * latency are reported for several compression levels, and compared with compressing the whole
+ * buffer at push time.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "timeSeries.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test parameters
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMALL_SAMPLE_COUNT          10
+#define BENCHMARK_SAMPLE_COUNT      100000
+#define STRING_SAMPLE_COUNT         2000
+/// Size of the reference CBOR buffer, and of the decompressed payload buffer.
+#define RAW_MAX_NUMBYTES            (4 * 1024 * 1024)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference CBOR stream and decompressed payload.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t RefBuffer[RAW_MAX_NUMBYTES];
+static uint8_t InflateBuffer[RAW_MAX_NUMBYTES];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference CBOR encoders.
+ */
+//--------------------------------------------------------------------------------------------------
+static CborEncoder RefStream;
+static CborEncoder RefMap;
+static CborEncoder RefSamples;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delta encoded samples of a random walk.
+ */
+//--------------------------------------------------------------------------------------------------
+static int64_t TimeStampDeltas[BENCHMARK_SAMPLE_COUNT];
+static int ValueDeltas[BENCHMARK_SAMPLE_COUNT];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Elapsed time in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t ElapsedUs
+(
+    le_clk_Time_t start
+)
+{
+    le_clk_Time_t duration = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return (uint64_t)duration.sec * 1000000 + duration.usec;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode the time series header map, up to the opening of the sample array.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EncodeHeader
+(
+    CborEncoder* streamPtr,
+    CborEncoder* mapPtr,
+    CborEncoder* samplesPtr
+)
+{
+    CborEncoder array;
+
+    LE_ASSERT(CborNoError == cbor_encoder_create_map(streamPtr, mapPtr, 3));
+
+    LE_ASSERT(CborNoError == cbor_encode_text_stringz(mapPtr, "h"));
+    LE_ASSERT(CborNoError == cbor_encoder_create_array(mapPtr, &array, 1));
+    LE_ASSERT(CborNoError == cbor_encode_text_stringz(&array, "/0/1"));
+    LE_ASSERT(CborNoError == cbor_encoder_close_container(mapPtr, &array));
+
+    LE_ASSERT(CborNoError == cbor_encode_text_stringz(mapPtr, "f"));
+    LE_ASSERT(CborNoError == cbor_encoder_create_array(mapPtr, &array, 2));
+    LE_ASSERT(CborNoError == cbor_encode_double(&array, 1));
+    LE_ASSERT(CborNoError == cbor_encode_double(&array, 1));
+    LE_ASSERT(CborNoError == cbor_encoder_close_container(mapPtr, &array));
+
+    LE_ASSERT(CborNoError == cbor_encode_text_stringz(mapPtr, "s"));
+    LE_ASSERT(CborNoError == cbor_encoder_create_array(mapPtr, samplesPtr, CborIndefiniteLength));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a delta encoded sample: time stamp, then integer value or string.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EncodeSample
+(
+    CborEncoder* encoderPtr,
+    int64_t timeStampDelta,
+    int valueDelta,
+    const char* stringPtr
+)
+{
+    LE_ASSERT(CborNoError == cbor_encode_int(encoderPtr, timeStampDelta));
+
+    if (stringPtr != NULL)
+    {
+        LE_ASSERT(CborNoError == cbor_encode_text_stringz(encoderPtr, stringPtr));
+    }
+    else
+    {
+        LE_ASSERT(CborNoError == cbor_encode_int(encoderPtr, valueDelta));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a time series in both the stream and the reference buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartSeries
+(
+    timeSeries_Stream_t* streamPtr,
+    int compressionLevel
+)
+{
+    CborEncoder stream, map, samples;
+
+    LE_ASSERT_OK(timeSeries_Open(streamPtr, compressionLevel));
+    LE_ASSERT_OK(timeSeries_BeginItem(streamPtr, &stream));
+    EncodeHeader(&stream, &map, &samples);
+    LE_ASSERT_OK(timeSeries_EndItem(streamPtr, &samples));
+
+    cbor_encoder_init(&RefStream, RefBuffer, sizeof(RefBuffer), 0);
+    EncodeHeader(&RefStream, &RefMap, &RefSamples);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the samples of a random walk: one sample per second with some jitter, the first time
+ * stamp being absolute.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GenerateSamples
+(
+    uint32_t count
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        TimeStampDeltas[i] = (0 == i) ? 1500000000000LL : 1000 + (rand() % 3) - 1;
+        ValueDeltas[i] = (rand() % 21) - 10;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sample to the stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddSample
+(
+    timeSeries_Stream_t* streamPtr,
+    uint32_t index,
+    const char* stringPtr
+)
+{
+    CborEncoder sample;
+
+    LE_ASSERT_OK(timeSeries_BeginItem(streamPtr, &sample));
+    EncodeSample(&sample, TimeStampDeltas[index], ValueDeltas[index], stringPtr);
+    LE_ASSERT_OK(timeSeries_EndItem(streamPtr, &sample));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a sample to the reference buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddRefSample
+(
+    uint32_t index,
+    const char* stringPtr
+)
+{
+    EncodeSample(&RefSamples, TimeStampDeltas[index], ValueDeltas[index], stringPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the reference buffer.
+ *
+ * @return the size of the reference CBOR stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t EndReference
+(
+    void
+)
+{
+    LE_ASSERT(CborNoError == cbor_encoder_close_container(&RefMap, &RefSamples));
+    LE_ASSERT(CborNoError == cbor_encoder_close_container(&RefStream, &RefMap));
+
+    return cbor_encoder_get_buffer_size(&RefStream, RefBuffer);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the sample array and complete the stream, as a push does.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Push
+(
+    timeSeries_Stream_t* streamPtr,
+    uint8_t** payloadPtrPtr,
+    size_t* payloadNumBytesPtr
+)
+{
+    static const uint8_t breakByte = 0xFF;
+
+    LE_ASSERT_OK(timeSeries_Write(streamPtr, &breakByte, sizeof(breakByte)));
+    LE_ASSERT_OK(timeSeries_Finish(streamPtr, payloadPtrPtr, payloadNumBytesPtr));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the payload decompresses to the reference CBOR stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckPayload
+(
+    const uint8_t* payloadPtr,
+    size_t payloadNumBytes,
+    size_t refNumBytes
+)
+{
+    z_stream infstream;
+
+    memset(&infstream, 0, sizeof(infstream));
+    LE_ASSERT(Z_OK == inflateInit(&infstream));
+
+    infstream.next_in = (Bytef*)payloadPtr;
+    infstream.avail_in = payloadNumBytes;
+    infstream.next_out = InflateBuffer;
+    infstream.avail_out = sizeof(InflateBuffer);
+
+    LE_ASSERT(Z_STREAM_END == inflate(&infstream, Z_FINISH));
+    LE_ASSERT(0 == infstream.avail_in);
+    LE_ASSERT(refNumBytes == infstream.total_out);
+    LE_ASSERT(0 == memcmp(RefBuffer, InflateBuffer, refNumBytes));
+
+    inflateEnd(&infstream);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: a small series fits in a single chunk.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestSmallSeries
+(
+    void
+)
+{
+    timeSeries_Stream_t stream;
+    uint8_t* payloadPtr;
+    size_t payloadNumBytes;
+    size_t refNumBytes;
+    uint32_t i;
+
+    GenerateSamples(SMALL_SAMPLE_COUNT);
+    StartSeries(&stream, TIMESERIES_COMPRESSION_LEVEL);
+    for (i = 0; i < SMALL_SAMPLE_COUNT; i++)
+    {
+        AddSample(&stream, i, NULL);
+        AddRefSample(i, NULL);
+    }
+    Push(&stream, &payloadPtr, &payloadNumBytes);
+
+    refNumBytes = EndReference();
+    CheckPayload(payloadPtr, payloadNumBytes, refNumBytes);
+    LE_ASSERT(timeSeries_GetRawSize(&stream) == refNumBytes);
+
+    // Nothing can be added once the stream is finished.
+    LE_ASSERT(LE_FAULT == timeSeries_Finish(&stream, &payloadPtr, &payloadNumBytes));
+
+    timeSeries_Close(&stream);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: string samples, spanning many staging buffers and chunks.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestStringSeries
+(
+    void
+)
+{
+    timeSeries_Stream_t stream;
+    uint8_t* payloadPtr;
+    size_t payloadNumBytes;
+    char string[256];
+    uint32_t i;
+
+    GenerateSamples(STRING_SAMPLE_COUNT);
+    StartSeries(&stream, TIMESERIES_COMPRESSION_LEVEL);
+    for (i = 0; i < STRING_SAMPLE_COUNT; i++)
+    {
+        size_t len = rand() % (sizeof(string) - 1);
+        size_t j;
+
+        for (j = 0; j < len; j++)
+        {
+            string[j] = 'a' + (rand() % 26);
+        }
+        string[len] = '\0';
+
+        AddSample(&stream, i, string);
+        AddRefSample(i, string);
+    }
+    Push(&stream, &payloadPtr, &payloadNumBytes);
+
+    CheckPayload(payloadPtr, payloadNumBytes, EndReference());
+
+    timeSeries_Close(&stream);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark: encoding rate and push latency of a 100k-point series.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BenchmarkSeries
+(
+    int compressionLevel
+)
+{
+    timeSeries_Stream_t stream;
+    uint8_t* payloadPtr;
+    size_t payloadNumBytes;
+    size_t refNumBytes;
+    uint64_t encodeUs, pushUs, oneShotUs;
+    le_clk_Time_t start;
+    z_stream defstream;
+    uint32_t i;
+
+    GenerateSamples(BENCHMARK_SAMPLE_COUNT);
+    StartSeries(&stream, compressionLevel);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < BENCHMARK_SAMPLE_COUNT; i++)
+    {
+        AddSample(&stream, i, NULL);
+    }
+    encodeUs = ElapsedUs(start);
+
+    start = le_clk_GetRelativeTime();
+    Push(&stream, &payloadPtr, &payloadNumBytes);
+    pushUs = ElapsedUs(start);
+
+    for (i = 0; i < BENCHMARK_SAMPLE_COUNT; i++)
+    {
+        AddRefSample(i, NULL);
+    }
+    refNumBytes = EndReference();
+    CheckPayload(payloadPtr, payloadNumBytes, refNumBytes);
+
+    // Previous behavior: compress the whole CBOR stream at push time.
+    memset(&defstream, 0, sizeof(defstream));
+    defstream.next_in = RefBuffer;
+    defstream.avail_in = refNumBytes;
+    defstream.next_out = InflateBuffer;
+    defstream.avail_out = sizeof(InflateBuffer);
+
+    start = le_clk_GetRelativeTime();
+    LE_ASSERT(Z_OK == deflateInit(&defstream, compressionLevel));
+    LE_ASSERT(Z_STREAM_END == deflate(&defstream, Z_FINISH));
+    deflateEnd(&defstream);
+    oneShotUs = ElapsedUs(start);
+
+    LE_INFO("Level %d: %d samples, %zu bytes -> %zu bytes (one-shot %lu bytes)",
+            compressionLevel, BENCHMARK_SAMPLE_COUNT, refNumBytes, payloadNumBytes,
+            defstream.total_out);
+    LE_INFO("Level %d: %"PRIu64" samples/s, push %"PRIu64" us, "
+            "one-shot push %"PRIu64" us",
+            compressionLevel, (uint64_t)BENCHMARK_SAMPLE_COUNT * 1000000 / (encodeUs + 1),
+            pushUs, oneShotUs);
+
+    // Pushing only flushes the end of the stream.
+    LE_ASSERT(pushUs < oneShotUs);
+
+    timeSeries_Close(&stream);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the test
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    LE_INFO("======== Start time series UnitTest ========");
+
+    timeSeries_Init();
+
+    LE_INFO("======== Small series ========");
+    TestSmallSeries();
+
+    LE_INFO("======== String series ========");
+    TestStringSeries();
+
+    LE_INFO("======== Benchmark ========");
+    BenchmarkSeries(Z_BEST_SPEED);
+    BenchmarkSeries(Z_DEFAULT_COMPRESSION);
+    BenchmarkSeries(Z_BEST_COMPRESSION);
+
+    LE_INFO("======== time series UnitTest PASSED ========");
+    exit(EXIT_SUCCESS);
+}
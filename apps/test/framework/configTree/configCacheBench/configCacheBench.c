@@ -0,0 +1,203 @@
+/**
+ * Benchmark of the client side read cache of the Config Tree.
+ *
+ * VALUE_COUNT values are written, then read RUN_COUNT times:
+ *  - with a le_cfg read transaction, which takes a round trip to the Config Tree per value,
+ *  - with a cached read transaction after each change to the tree, which gets a copy of the
+ *    branch in one message, and
+ *  - with a cached read transaction while the tree doesn't change, which reuses the copy it
+ *    already has.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "cfgCache.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define VALUE_COUNT             1000
+#define RUN_COUNT               20
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the nodes used by the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_ROOT              "/configCacheBench"
+
+
+static le_clk_Time_t StartTime;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start timing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartTimer
+(
+    void
+)
+{
+    StartTime = le_clk_GetRelativeTime();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since StartTimer() was called, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedUs
+(
+    void
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+
+    return (uint64_t)elapsed.sec * 1000000 + elapsed.usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path to a value, relative to the root of the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetValuePath
+(
+    int index,
+    char* pathPtr,
+    size_t pathSize
+)
+{
+    snprintf(pathPtr, pathSize, "group%d/value%d", index % 10, index);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the values.  Every value is its index plus the run number.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteValues
+(
+    int run
+)
+{
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+    int i;
+
+    for (i = 0; i < VALUE_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        GetValuePath(i, path, sizeof(path));
+        le_cfg_SetInt(iterRef, path, i + run);
+    }
+
+    le_cfg_CommitTxn(iterRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the values with a le_cfg read transaction.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadValues
+(
+    int run
+)
+{
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(BENCH_ROOT);
+    int i;
+
+    for (i = 0; i < VALUE_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        GetValuePath(i, path, sizeof(path));
+        LE_ASSERT(le_cfg_GetInt(iterRef, path, -1) == i + run);
+    }
+
+    le_cfg_CancelTxn(iterRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the values with a cached read transaction.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadCachedValues
+(
+    int run
+)
+{
+    cfgCache_TxnRef_t txnRef = cfgCache_CreateReadTxn(BENCH_ROOT);
+    int i;
+
+    LE_ASSERT(txnRef != NULL);
+
+    for (i = 0; i < VALUE_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        GetValuePath(i, path, sizeof(path));
+        LE_ASSERT(cfgCache_GetInt(txnRef, path, -1) == i + run);
+    }
+
+    cfgCache_CancelTxn(txnRef);
+}
+
+
+COMPONENT_INIT
+{
+    uint64_t readUs = 0;
+    uint64_t changedUs = 0;
+    uint64_t unchangedUs = 0;
+    int run;
+
+    LE_INFO("======== Config tree read cache benchmark ========");
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+
+    for (run = 0; run < RUN_COUNT; run++)
+    {
+        WriteValues(run);
+
+        StartTimer();
+        ReadValues(run);
+        readUs += GetElapsedUs();
+
+        // The first cached transaction after a change gets a new copy, the next ones reuse it.
+        StartTimer();
+        ReadCachedValues(run);
+        changedUs += GetElapsedUs();
+
+        StartTimer();
+        ReadCachedValues(run);
+        unchangedUs += GetElapsedUs();
+    }
+
+    LE_INFO("Reading %d values, in microseconds: read transaction %" PRIu64
+            ", cached after a change %" PRIu64 ", cached without change %" PRIu64,
+            VALUE_COUNT,
+            readUs / RUN_COUNT,
+            changedUs / RUN_COUNT,
+            unchangedUs / RUN_COUNT);
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+
+    LE_INFO("======== Config tree read cache benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
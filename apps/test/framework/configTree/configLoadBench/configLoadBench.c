@@ -0,0 +1,298 @@
+/**
+ * Benchmark of the loading of configuration trees, from text and from snapshots.
+ *
+ * A system tree of about 5 MB is generated as text and imported into a tree.  Committing it makes
+ * the Config Tree write the tree file, which is a snapshot, and that snapshot is then imported into
+ * another tree.  Both trees must export to the same text.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "sysPaths.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Files and trees used by the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEXT_PATH               "/tmp/configLoadBench.cfg"
+#define SNAPSHOT_PATH           "/tmp/configLoadBench.snap"
+#define TEXT_EXPORT_PATH        "/tmp/configLoadBench.text.cfg"
+#define SNAPSHOT_EXPORT_PATH    "/tmp/configLoadBench.snap.cfg"
+
+#define TEXT_TREE               "configLoadBenchText"
+#define SNAPSHOT_TREE           "configLoadBenchSnapshot"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the generated tree, and number of times each load is measured.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TREE_BYTES              (5 * 1024 * 1024)
+#define RUN_COUNT               3
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate a system tree, in text form, with as many apps as it takes to reach TREE_BYTES.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GenerateTree
+(
+    void
+)
+{
+    FILE* filePtr = fopen(TEXT_PATH, "w");
+    LE_ASSERT(filePtr != NULL);
+
+    int appCount;
+    int i;
+    int j;
+
+    fprintf(filePtr, "{ \"apps\" {\n");
+
+    for (appCount = 0; ftell(filePtr) < TREE_BYTES; appCount++)
+    {
+        fprintf(filePtr, "\"benchApp%d\" { \"sandboxed\" !t \"startManual\" !f "
+                         "\"maxMemoryBytes\" [40960000] \"cpuShare\" [1024] "
+                         "\"watchdogTimeout\" (1.500000) \"version\" \"1.0 \\\"beta\\\"\"\n",
+                appCount);
+
+        fprintf(filePtr, "\"procs\" {\n");
+        for (i = 0; i < 8; i++)
+        {
+            fprintf(filePtr, "\"proc%d\" { \"args\" {", i);
+            for (j = 0; j < 16; j++)
+            {
+                fprintf(filePtr, " \"%d\" \"--option%d=value%d\"", j, j, i);
+            }
+            fprintf(filePtr, " } \"envVars\" {");
+            for (j = 0; j < 16; j++)
+            {
+                fprintf(filePtr, " \"VAR%d\" \"/legato/systems/current/apps/benchApp%d/%d\"",
+                        j, appCount, j);
+            }
+            fprintf(filePtr, " } \"priority\" \"medium\" \"maxCoreDumpFileBytes\" [8192] "
+                             "\"faultAction\" \"restart\" \"watchdogAction\" ~ }\n");
+        }
+        fprintf(filePtr, "}\n");
+
+        fprintf(filePtr, "\"bindings\" {");
+        for (i = 0; i < 40; i++)
+        {
+            fprintf(filePtr, " \"client%d\" { \"app\" \"serverApp%d\" \"interface\" \"server%d\" }",
+                    i, i % 7, i);
+        }
+        fprintf(filePtr, " }\n");
+
+        fprintf(filePtr, "\"requires\" { \"files\" {");
+        for (i = 0; i < 40; i++)
+        {
+            fprintf(filePtr, " \"%d\" { \"src\" \"/usr/lib/libBench%d.so\" "
+                             "\"dest\" \"/lib/libBench%d.so\" \"isReadable\" !t }",
+                    i, i, i);
+        }
+        fprintf(filePtr, " } }\n}\n");
+    }
+
+    fprintf(filePtr, "} }\n");
+
+    LE_INFO("Generated a tree of %d apps, %ld bytes", appCount, ftell(filePtr));
+
+    LE_ASSERT(fclose(filePtr) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since a start time, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedMs
+(
+    le_clk_Time_t start
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return (uint64_t)elapsed.sec * 1000 + elapsed.usec / 1000;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Import a file into a tree, RUN_COUNT times, and commit it.
+ *
+ * @return The shortest time an import took, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t ImportTree
+(
+    const char* treeName,
+    const char* filePath
+)
+{
+    char treePath[LE_CFG_STR_LEN_BYTES];
+    uint64_t bestMs = UINT64_MAX;
+    int i;
+
+    snprintf(treePath, sizeof(treePath), "%s:/", treeName);
+
+    for (i = 0; i < RUN_COUNT; i++)
+    {
+        le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(treePath);
+
+        le_clk_Time_t start = le_clk_GetRelativeTime();
+        LE_ASSERT_OK(le_cfgAdmin_ImportTree(iterRef, filePath, ""));
+        uint64_t ms = GetElapsedMs(start);
+
+        le_cfg_CommitTxn(iterRef);
+
+        if (ms < bestMs)
+        {
+            bestMs = ms;
+        }
+    }
+
+    return bestMs;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Export a tree as text.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ExportTree
+(
+    const char* treeName,
+    const char* filePath
+)
+{
+    char treePath[LE_CFG_STR_LEN_BYTES];
+
+    snprintf(treePath, sizeof(treePath), "%s:/", treeName);
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(treePath);
+    LE_ASSERT_OK(le_cfgAdmin_ExportTree(iterRef, filePath, ""));
+    le_cfg_CancelTxn(iterRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a whole file.
+ *
+ * @return The content of the file, to be freed by the caller.
+ */
+//--------------------------------------------------------------------------------------------------
+static char* ReadFile
+(
+    const char* filePath,
+    size_t* sizePtr
+)
+{
+    struct stat fileStat;
+
+    LE_ASSERT(stat(filePath, &fileStat) == 0);
+
+    char* dataPtr = malloc(fileStat.st_size);
+    LE_ASSERT(dataPtr != NULL);
+
+    FILE* filePtr = fopen(filePath, "r");
+    LE_ASSERT(filePtr != NULL);
+    LE_ASSERT(fread(dataPtr, 1, fileStat.st_size, filePtr) == (size_t)fileStat.st_size);
+    fclose(filePtr);
+
+    *sizePtr = fileStat.st_size;
+
+    return dataPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the file a tree was last committed to (one of its three revisions) to SNAPSHOT_PATH, so
+ * that it survives later commits.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CopyTreeFile
+(
+    const char* treeName
+)
+{
+    static const char* extensions[] = { "rock", "paper", "scissors" };
+    char filePath[PATH_MAX] = "";
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(extensions); i++)
+    {
+        snprintf(filePath, sizeof(filePath), CFG_TREE_PATH "/%s.%s", treeName, extensions[i]);
+
+        if (access(filePath, R_OK) == 0)
+        {
+            break;
+        }
+    }
+
+    LE_ASSERT(i < NUM_ARRAY_MEMBERS(extensions));
+
+    size_t size;
+    char* dataPtr = ReadFile(filePath, &size);
+
+    FILE* filePtr = fopen(SNAPSHOT_PATH, "w");
+    LE_ASSERT(filePtr != NULL);
+    LE_ASSERT(fwrite(dataPtr, 1, size, filePtr) == size);
+    LE_ASSERT(fclose(filePtr) == 0);
+
+    free(dataPtr);
+
+    LE_INFO("Snapshot of the tree, from '%s': %zu bytes", filePath, size);
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== Config tree load benchmark ========");
+
+    GenerateTree();
+
+    uint64_t textMs = ImportTree(TEXT_TREE, TEXT_PATH);
+
+    CopyTreeFile(TEXT_TREE);
+
+    uint64_t snapshotMs = ImportTree(SNAPSHOT_TREE, SNAPSHOT_PATH);
+
+    LE_INFO("Loaded in %" PRIu64 " ms from text, %" PRIu64 " ms from a snapshot",
+            textMs, snapshotMs);
+
+    // Both trees must be the same.
+    ExportTree(TEXT_TREE, TEXT_EXPORT_PATH);
+    ExportTree(SNAPSHOT_TREE, SNAPSHOT_EXPORT_PATH);
+
+    size_t textSize;
+    size_t snapshotSize;
+    char* textPtr = ReadFile(TEXT_EXPORT_PATH, &textSize);
+    char* snapshotPtr = ReadFile(SNAPSHOT_EXPORT_PATH, &snapshotSize);
+
+    LE_ASSERT((textSize == snapshotSize) && (memcmp(textPtr, snapshotPtr, textSize) == 0));
+
+    free(textPtr);
+    free(snapshotPtr);
+
+    le_cfgAdmin_DeleteTree(TEXT_TREE);
+    le_cfgAdmin_DeleteTree(SNAPSHOT_TREE);
+
+    unlink(TEXT_PATH);
+    unlink(SNAPSHOT_PATH);
+    unlink(TEXT_EXPORT_PATH);
+    unlink(SNAPSHOT_EXPORT_PATH);
+
+    LE_INFO("======== Config tree load benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,208 @@
+/**
+ * Benchmark of commits made while read transactions are open on the Config Tree.
+ *
+ * VALUE_COUNT values are rewritten RUN_COUNT times, with a growing number of read transactions
+ * held open over the commits.  The commits don't wait for the readers, and each reader keeps
+ * seeing the values as they were when it was created.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define VALUE_COUNT             1000
+#define RUN_COUNT               20
+#define MAX_READER_COUNT        16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the nodes used by the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_ROOT              "/configMvccBench"
+
+
+static le_clk_Time_t StartTime;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start timing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartTimer
+(
+    void
+)
+{
+    StartTime = le_clk_GetRelativeTime();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since StartTimer() was called, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedUs
+(
+    void
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+
+    return (uint64_t)elapsed.sec * 1000000 + elapsed.usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path to a value, relative to the root of the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetValuePath
+(
+    int index,
+    char* pathPtr,
+    size_t pathSize
+)
+{
+    snprintf(pathPtr, pathSize, "group%d/value%d", index % 10, index);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the values.  Every value is its index plus the generation.
+ *
+ * @return The time taken by the commit, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t WriteValues
+(
+    int generation
+)
+{
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+    int i;
+
+    for (i = 0; i < VALUE_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        GetValuePath(i, path, sizeof(path));
+        le_cfg_SetInt(iterRef, path, i + generation);
+    }
+
+    StartTimer();
+    le_cfg_CommitTxn(iterRef);
+
+    return GetElapsedUs();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a read transaction sees the values of a given generation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckValues
+(
+    le_cfg_IteratorRef_t iterRef,
+    int generation
+)
+{
+    int i;
+
+    for (i = 0; i < VALUE_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        GetValuePath(i, path, sizeof(path));
+        LE_ASSERT(le_cfg_GetInt(iterRef, path, -1) == i + generation);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure the commits with a number of read transactions open.  Each reader is created before a
+ * different commit, so the readers see different generations of the values.
+ *
+ * @return The generation of the values after the measurement.
+ */
+//--------------------------------------------------------------------------------------------------
+static int Measure
+(
+    int readerCount,
+    int generation
+)
+{
+    le_cfg_IteratorRef_t readerRefs[MAX_READER_COUNT];
+    int readerGenerations[MAX_READER_COUNT];
+    uint64_t commitUs = 0;
+    int run;
+    int i;
+
+    for (i = 0; i < readerCount; i++)
+    {
+        readerRefs[i] = le_cfg_CreateReadTxn(BENCH_ROOT);
+        readerGenerations[i] = generation;
+        WriteValues(++generation);
+    }
+
+    for (run = 0; run < RUN_COUNT; run++)
+    {
+        commitUs += WriteValues(++generation);
+    }
+
+    for (i = 0; i < readerCount; i++)
+    {
+        CheckValues(readerRefs[i], readerGenerations[i]);
+        le_cfg_CancelTxn(readerRefs[i]);
+    }
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(BENCH_ROOT);
+    CheckValues(iterRef, generation);
+    le_cfg_CancelTxn(iterRef);
+
+    LE_INFO("Committing %d values with %d read transaction(s) open: %" PRIu64 " microseconds",
+            VALUE_COUNT,
+            readerCount,
+            commitUs / RUN_COUNT);
+
+    return generation;
+}
+
+
+COMPONENT_INIT
+{
+    int generation = 0;
+    int readerCount;
+
+    LE_INFO("======== Config tree commits with open readers benchmark ========");
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+    WriteValues(generation);
+
+    generation = Measure(0, generation);
+
+    for (readerCount = 1; readerCount <= MAX_READER_COUNT; readerCount *= 4)
+    {
+        generation = Measure(readerCount, generation);
+    }
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+
+    LE_INFO("======== Config tree commits with open readers benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
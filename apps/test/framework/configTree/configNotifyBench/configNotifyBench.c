@@ -0,0 +1,236 @@
+/**
+ * Benchmark of the change notifications of the Config Tree.
+ *
+ * Watchers are registered on WATCHER_COUNT nodes, half of them wanting the changed paths, and a
+ * transaction changing NODES_PER_WATCHER nodes under each of them is committed.  The time it takes
+ * for the commit to be acknowledged, and for all the watchers to be notified, is measured.  Each
+ * watcher must be notified once per commit.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the benchmark: 100 watchers of 100 nodes each, so 10000 nodes changed per commit.
+ */
+//--------------------------------------------------------------------------------------------------
+#define WATCHER_COUNT           100
+#define NODES_PER_WATCHER       100
+#define RUN_COUNT               5
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the nodes used by the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_ROOT              "/configNotifyBench"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A watched node.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_cfg_ChangeHandlerRef_t handlerRef;               ///< Handler, if it doesn't want paths.
+    le_cfg_ChangedPathsHandlerRef_t pathsHandlerRef;    ///< Handler, if it wants paths.
+    int notifyCount;                                    ///< Notifications in the current run.
+}
+Watcher_t;
+
+
+static Watcher_t Watchers[WATCHER_COUNT];
+static int NotifiedCount;
+static int RunIndex;
+static le_clk_Time_t StartTime;
+static uint64_t CommitMs;
+
+
+static void StartRun(void* param1Ptr, void* param2Ptr);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since the start of the current run, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedMs
+(
+    void
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+
+    return (uint64_t)elapsed.sec * 1000 + elapsed.usec / 1000;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count a notification, and end the run once all the watchers have been notified.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Notified
+(
+    Watcher_t* watcherPtr
+)
+{
+    watcherPtr->notifyCount++;
+    LE_ASSERT(watcherPtr->notifyCount == 1);
+
+    if (++NotifiedCount < WATCHER_COUNT)
+    {
+        return;
+    }
+
+    LE_INFO("Run %d: commit acknowledged in %" PRIu64 " ms, all watchers notified in %" PRIu64
+            " ms", RunIndex, CommitMs, GetElapsedMs());
+
+    if (++RunIndex < RUN_COUNT)
+    {
+        le_event_QueueFunction(StartRun, NULL, NULL);
+        return;
+    }
+
+    int i;
+
+    for (i = 0; i < WATCHER_COUNT; i++)
+    {
+        if (Watchers[i].handlerRef != NULL)
+        {
+            le_cfg_RemoveChangeHandler(Watchers[i].handlerRef);
+        }
+        else
+        {
+            le_cfg_RemoveChangedPathsHandler(Watchers[i].pathsHandlerRef);
+        }
+    }
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+
+    LE_INFO("======== Config tree notification benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler of the watchers that don't want the changed paths.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ChangeHandler
+(
+    void* contextPtr
+)
+{
+    Notified(contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler of the watchers that want the changed paths.  Each of the nodes that changed under the
+ * watched node must be listed, unless the list was too long and was replaced by "/".
+ */
+//--------------------------------------------------------------------------------------------------
+static void ChangedPathsHandler
+(
+    const char* changedPaths,
+    void* contextPtr
+)
+{
+    if (strcmp(changedPaths, "/") != 0)
+    {
+        int pathCount = 1;
+        const char* charPtr;
+
+        for (charPtr = changedPaths; *charPtr != '\0'; charPtr++)
+        {
+            if (*charPtr == '\n')
+            {
+                pathCount++;
+            }
+        }
+
+        LE_ASSERT(pathCount == NODES_PER_WATCHER);
+    }
+
+    Notified(contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Change all the watched nodes in one transaction, and commit it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartRun
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    int i;
+    int j;
+
+    NotifiedCount = 0;
+
+    for (i = 0; i < WATCHER_COUNT; i++)
+    {
+        Watchers[i].notifyCount = 0;
+    }
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+
+    for (i = 0; i < WATCHER_COUNT; i++)
+    {
+        for (j = 0; j < NODES_PER_WATCHER; j++)
+        {
+            char path[LE_CFG_STR_LEN_BYTES];
+
+            snprintf(path, sizeof(path), "watcher%d/n%d", i, j);
+            le_cfg_SetInt(iterRef, path, RunIndex);
+        }
+    }
+
+    StartTime = le_clk_GetRelativeTime();
+    le_cfg_CommitTxn(iterRef);
+    CommitMs = GetElapsedMs();
+}
+
+
+COMPONENT_INIT
+{
+    int i;
+
+    LE_INFO("======== Config tree notification benchmark ========");
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+
+    for (i = 0; i < WATCHER_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        snprintf(path, sizeof(path), BENCH_ROOT "/watcher%d", i);
+
+        if ((i % 2) == 0)
+        {
+            Watchers[i].handlerRef = le_cfg_AddChangeHandler(path, ChangeHandler, &Watchers[i]);
+        }
+        else
+        {
+            Watchers[i].pathsHandlerRef = le_cfg_AddChangedPathsHandler(path,
+                                                                        ChangedPathsHandler,
+                                                                        &Watchers[i]);
+        }
+    }
+
+    le_event_QueueFunction(StartRun, NULL, NULL);
+}
@@ -0,0 +1,283 @@
+/**
+ * Benchmark of the import and export of large trees through the Config Tree admin API.
+ *
+ * A tree of VALUE_COUNT values is exported and imported again, in the text and JSON formats,
+ * with the data streamed through a file descriptor.  This is measured against walking the same
+ * tree one node at a time, the way the config tool used to handle JSON.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define VALUE_COUNT             10000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Roots of the nodes used by the benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_ROOT              "/configStreamBench"
+#define SOURCE_PATH             BENCH_ROOT "/source"
+#define DEST_PATH               BENCH_ROOT "/dest"
+
+
+static le_clk_Time_t StartTime;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start timing.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartTimer
+(
+    void
+)
+{
+    StartTime = le_clk_GetRelativeTime();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since StartTimer() was called, in microseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedUs
+(
+    void
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+
+    return (uint64_t)elapsed.sec * 1000000 + elapsed.usec;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path to a value, relative to the root of a copy of the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetValuePath
+(
+    int index,
+    char* pathPtr,
+    size_t pathSize
+)
+{
+    snprintf(pathPtr, pathSize, "group%d/item%d/value", index % 100, index);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the values of the source tree.  Even values are strings, odd ones are integers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteValues
+(
+    void
+)
+{
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(SOURCE_PATH);
+    int i;
+
+    for (i = 0; i < VALUE_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        GetValuePath(i, path, sizeof(path));
+
+        if (i % 2 == 0)
+        {
+            char value[LE_CFG_STR_LEN_BYTES];
+
+            snprintf(value, sizeof(value), "value \"%d\"", i);
+            le_cfg_SetString(iterRef, path, value);
+        }
+        else
+        {
+            le_cfg_SetInt(iterRef, path, i);
+        }
+    }
+
+    le_cfg_CommitTxn(iterRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a copy of the tree holds the values written by WriteValues().
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckValues
+(
+    const char* rootPathPtr
+)
+{
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(rootPathPtr);
+    int i;
+
+    for (i = 0; i < VALUE_COUNT; i++)
+    {
+        char path[LE_CFG_STR_LEN_BYTES];
+
+        GetValuePath(i, path, sizeof(path));
+
+        if (i % 2 == 0)
+        {
+            char value[LE_CFG_STR_LEN_BYTES];
+            char expected[LE_CFG_STR_LEN_BYTES];
+
+            snprintf(expected, sizeof(expected), "value \"%d\"", i);
+            LE_ASSERT(le_cfg_GetString(iterRef, path, value, sizeof(value), "") == LE_OK);
+            LE_ASSERT(strcmp(value, expected) == 0);
+        }
+        else
+        {
+            LE_ASSERT(le_cfg_GetInt(iterRef, path, -1) == i);
+        }
+    }
+
+    le_cfg_CancelTxn(iterRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Walk a tree one node at a time, reading every value, the way a client exporting it would.
+ *
+ * @return The number of values read.
+ */
+//--------------------------------------------------------------------------------------------------
+static int WalkTree
+(
+    le_cfg_IteratorRef_t iterRef
+)
+{
+    int count = 0;
+
+    if (le_cfg_GoToFirstChild(iterRef) != LE_OK)
+    {
+        return 0;
+    }
+
+    do
+    {
+        char value[LE_CFG_STR_LEN_BYTES];
+
+        switch (le_cfg_GetNodeType(iterRef, ""))
+        {
+            case LE_CFG_TYPE_STEM:
+                count += WalkTree(iterRef);
+                break;
+
+            case LE_CFG_TYPE_STRING:
+                le_cfg_GetString(iterRef, "", value, sizeof(value), "");
+                count++;
+                break;
+
+            default:
+                le_cfg_GetInt(iterRef, "", 0);
+                count++;
+                break;
+        }
+    }
+    while (le_cfg_GoToNextSibling(iterRef) == LE_OK);
+
+    le_cfg_GoToParent(iterRef);
+
+    return count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the source tree to the destination, streaming it through a temporary file in a format.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MeasureStream
+(
+    le_cfgAdmin_format_t dataFormat,
+    const char* formatNamePtr
+)
+{
+    FILE* filePtr = tmpfile();
+    LE_ASSERT(filePtr != NULL);
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(SOURCE_PATH);
+
+    StartTimer();
+    LE_ASSERT(le_cfgAdmin_ExportTreeStream(iterRef,
+                                           dup(fileno(filePtr)),
+                                           "",
+                                           dataFormat) == LE_OK);
+    uint64_t exportUs = GetElapsedUs();
+
+    le_cfg_CancelTxn(iterRef);
+
+    LE_ASSERT(fseek(filePtr, 0, SEEK_END) == 0);
+    long size = ftell(filePtr);
+    rewind(filePtr);
+
+    le_cfg_QuickDeleteNode(DEST_PATH);
+    iterRef = le_cfg_CreateWriteTxn(DEST_PATH);
+
+    StartTimer();
+    LE_ASSERT(le_cfgAdmin_ImportTreeStream(iterRef,
+                                           dup(fileno(filePtr)),
+                                           "",
+                                           dataFormat) == LE_OK);
+    le_cfg_CommitTxn(iterRef);
+    uint64_t importUs = GetElapsedUs();
+
+    fclose(filePtr);
+
+    CheckValues(DEST_PATH);
+
+    LE_INFO("Streaming %d values as %s (%ld bytes): export %" PRIu64 " microseconds, "
+            "import %" PRIu64 " microseconds",
+            VALUE_COUNT,
+            formatNamePtr,
+            size,
+            exportUs,
+            importUs);
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== Config tree stream import and export benchmark ========");
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+    WriteValues();
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(SOURCE_PATH);
+
+    StartTimer();
+    LE_ASSERT(WalkTree(iterRef) == VALUE_COUNT);
+    uint64_t walkUs = GetElapsedUs();
+
+    le_cfg_CancelTxn(iterRef);
+
+    LE_INFO("Walking %d values one node at a time: %" PRIu64 " microseconds", VALUE_COUNT, walkUs);
+
+    MeasureStream(LE_CFGADMIN_FORMAT_TEXT, "text");
+    MeasureStream(LE_CFGADMIN_FORMAT_JSON, "JSON");
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT);
+
+    LE_INFO("======== Config tree stream import and export benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
@@ -54,7 +54,7 @@ function testApp
     appName=$1
 
     echo "Clear out old logs."
-    logLoc="/tmp/legato_logs/syslog-$appName-badExe-"
+    logLoc="/tmp/legato_logs/syslog-$appName-badExe-*"
 
     RemoteCmd "rm -rf $logLoc"
 
@@ -65,7 +65,16 @@ function testApp
     app start $appName $targetAddr
     CheckRet
 
-    CheckLogfileStr "$logLoc" "==" 1 "Something wicked this way comes."
+    # The log is captured in the background after the crash, so wait for it.
+    echo "Wait for the log to be captured."
+    RemoteCmd "for i in \$(seq 30); do ls $logLoc > /dev/null 2>&1 && break; sleep 1; done; ls $logLoc"
+
+    count=$(ssh root@$targetAddr "for f in $logLoc; do case \$f in *.gz) zcat \$f;; *) cat \$f;; esac; done | grep -c 'Something wicked this way comes.'")
+
+    if [ "$count" != "1" ]; then
+        echo "Expected the crash message once in the captured log, found it ${count:-0} times."
+        exit 1
+    fi
 
     RemoteCmd "rm -rf $logLoc"
     tempFiles=""
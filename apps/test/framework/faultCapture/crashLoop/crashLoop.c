@@ -0,0 +1,182 @@
+/**
+ * Benchmark of the fault-to-restart latency of a crash looping app.
+ *
+ * The process crashes, dumping a core file, and the Supervisor captures its log and core file and
+ * restarts it.  The time of each crash is saved in a file that survives the restart, so that the
+ * restarted process can measure how long the Supervisor took.  After CRASH_COUNT crashes, the
+ * average and maximum latencies are logged and the process exits successfully.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of crashes measured.  More crashes would be too close together for the Supervisor to
+ * capture them all.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CRASH_COUNT         4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time to wait before crashing, in seconds.  The Supervisor stops apps that fault again within
+ * 10 seconds, so crashes must be further apart than that.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CRASH_DELAY         11
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A saved state older than this, in seconds, is left over from a benchmark that didn't finish.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STALE_STATE_AGE     60
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File holding the benchmark's state across restarts.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STATE_PATH          "/tmp/faultCaptureBench.state"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark state, saved before each crash.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int crashCount;             ///< Number of crashes so far.
+    le_clk_Time_t crashTime;    ///< Relative time of the last crash.
+    double totalLatency;        ///< Sum of the fault-to-restart latencies, in seconds.
+    double maxLatency;          ///< Largest fault-to-restart latency, in seconds.
+}
+State_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The benchmark state.
+ */
+//--------------------------------------------------------------------------------------------------
+static State_t State;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a time to seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double Seconds
+(
+    le_clk_Time_t time
+)
+{
+    return (double)time.sec + (double)time.usec / 1e6;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Loads the state saved before the last crash.
+ *
+ * @return true if there was one, false if the benchmark is starting.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool LoadState
+(
+    void
+)
+{
+    FILE* filePtr = fopen(STATE_PATH, "r");
+
+    if (filePtr == NULL)
+    {
+        return false;
+    }
+
+    bool isLoaded = (fread(&State, sizeof(State), 1, filePtr) == 1);
+    fclose(filePtr);
+
+    if ( isLoaded &&
+         (Seconds(le_clk_Sub(le_clk_GetRelativeTime(), State.crashTime)) < STALE_STATE_AGE) )
+    {
+        return true;
+    }
+
+    memset(&State, 0, sizeof(State));
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves the state and crashes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CrashHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    State.crashCount++;
+
+    FILE* filePtr = fopen(STATE_PATH, "w");
+    LE_ASSERT(filePtr != NULL);
+
+    State.crashTime = le_clk_GetRelativeTime();
+    LE_ASSERT(fwrite(&State, sizeof(State), 1, filePtr) == 1);
+    LE_ASSERT(fclose(filePtr) == 0);
+
+    LE_INFO("Crash %d of %d.", State.crashCount, CRASH_COUNT);
+
+    abort();
+}
+
+
+COMPONENT_INIT
+{
+    if (LoadState())
+    {
+        double latency = Seconds(le_clk_Sub(le_clk_GetRelativeTime(), State.crashTime));
+
+        State.totalLatency += latency;
+
+        if (latency > State.maxLatency)
+        {
+            State.maxLatency = latency;
+        }
+
+        LE_INFO("Restarted %.3f s after crash %d.", latency, State.crashCount);
+    }
+    else
+    {
+        LE_INFO("======== Fault capture benchmark ========");
+    }
+
+    if (State.crashCount == CRASH_COUNT)
+    {
+        LE_INFO("%d crashes: average fault-to-restart latency %.3f s, maximum %.3f s",
+                CRASH_COUNT, State.totalLatency / CRASH_COUNT, State.maxLatency);
+
+        unlink(STATE_PATH);
+
+        LE_INFO("======== Fault capture benchmark PASSED ========");
+
+        exit(EXIT_SUCCESS);
+    }
+
+    le_timer_Ref_t timerRef = le_timer_Create("Crash");
+    le_clk_Time_t delay = { CRASH_DELAY, 0 };
+
+    LE_ASSERT(le_timer_SetHandler(timerRef, CrashHandler) == LE_OK);
+    LE_ASSERT(le_timer_SetInterval(timerRef, delay) == LE_OK);
+    LE_ASSERT(le_timer_Start(timerRef) == LE_OK);
+}
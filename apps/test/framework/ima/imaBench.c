@@ -0,0 +1,212 @@
+/**
+ * Benchmark of the IMA signature verification of liblegato.
+ *
+ * A synthetic tree of signed files is created in a local filesystem, then verified twice: the
+ * first verification checks every signature, the second one is served by the verification cache.
+ * Tampered and unsigned files must fail verification.
+ *
+ * The files are signed with the openssl command line tool, and the signatures are written to the
+ * security.ima extended attribute. The test is skipped if either is not available.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "ima.h"
+#include <sys/xattr.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the test files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEST_ROOT           "/tmp/imaBench"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Signed tree.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TREE_PATH           TEST_ROOT "/tree"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Signing key and its certificate.
+ */
+//--------------------------------------------------------------------------------------------------
+#define KEY_PATH            TEST_ROOT "/key.pem"
+#define CERT_PATH           TEST_ROOT "/" PUB_CERT_NAME
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shape of the signed tree.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DIR_COUNT           8
+#define FILES_PER_DIR       32
+#define FILE_BYTES          (16 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Signature header: digital signature v2, SHA-256.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SIG_HDR_BYTES       9
+#define SIG_MAX_BYTES       512
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a file and sign it.
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_UNSUPPORTED if signatures can't be stored on this filesystem
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CreateSignedFile
+(
+    const char* pathPtr,
+    unsigned int seed
+)
+{
+    static uint8_t data[FILE_BYTES];
+    size_t i;
+
+    for (i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (uint8_t)(seed * 31 + i * 7);
+    }
+
+    int fd = open(pathPtr, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(write(fd, data, sizeof(data)) == sizeof(data));
+    close(fd);
+
+    char cmd[PATH_MAX + 128];
+    snprintf(cmd, sizeof(cmd), "openssl dgst -sha256 -sign %s -out %s.sig %s",
+             KEY_PATH, TEST_ROOT "/last", pathPtr);
+    if (system(cmd) != 0)
+    {
+        return LE_FAULT;
+    }
+
+    uint8_t xattr[SIG_HDR_BYTES + SIG_MAX_BYTES] = { 0x03, 0x02, 4 };
+
+    fd = open(TEST_ROOT "/last.sig", O_RDONLY);
+    LE_ASSERT(fd >= 0);
+    ssize_t sigSize = read(fd, xattr + SIG_HDR_BYTES, SIG_MAX_BYTES);
+    close(fd);
+    LE_ASSERT(sigSize > 0);
+
+    xattr[7] = (uint8_t)(sigSize >> 8);
+    xattr[8] = (uint8_t)sigSize;
+
+    if (setxattr(pathPtr, "security.ima", xattr, SIG_HDR_BYTES + sigSize, 0) != 0)
+    {
+        LE_INFO("Could not set security.ima on '%s'. %m.", pathPtr);
+        return (errno == EPERM || errno == ENOTSUP) ? LE_UNSUPPORTED : LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since a start time, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedMs
+(
+    le_clk_Time_t start
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return (uint64_t)elapsed.sec * 1000 + elapsed.usec / 1000;
+}
+
+
+COMPONENT_INIT
+{
+    char path[PATH_MAX];
+    int dirIndex, fileIndex;
+
+    LE_INFO("======== IMA verification benchmark ========");
+
+    if (system("openssl version > /dev/null 2>&1") != 0)
+    {
+        LE_INFO("openssl is not available, skipping the test.");
+        exit(EXIT_SUCCESS);
+    }
+
+    le_dir_RemoveRecursive(TEST_ROOT);
+    LE_ASSERT_OK(le_dir_MakePath(TREE_PATH, S_IRWXU));
+
+    LE_ASSERT(0 == system("openssl req -x509 -newkey rsa:2048 -nodes -sha256 -days 1"
+                          " -subj /CN=imaBench -keyout " KEY_PATH
+                          " -outform DER -out " CERT_PATH " > /dev/null 2>&1"));
+
+    // Create the signed tree.
+    for (dirIndex = 0; dirIndex < DIR_COUNT; dirIndex++)
+    {
+        snprintf(path, sizeof(path), "%s/dir%d", TREE_PATH, dirIndex);
+        LE_ASSERT_OK(le_dir_MakePath(path, S_IRWXU));
+
+        for (fileIndex = 0; fileIndex < FILES_PER_DIR; fileIndex++)
+        {
+            snprintf(path, sizeof(path), "%s/dir%d/file%d", TREE_PATH, dirIndex, fileIndex);
+
+            le_result_t result = CreateSignedFile(path, dirIndex * FILES_PER_DIR + fileIndex);
+            if (result == LE_UNSUPPORTED)
+            {
+                LE_INFO("IMA signatures can't be stored in " TEST_ROOT ", skipping the test.");
+                le_dir_RemoveRecursive(TEST_ROOT);
+                exit(EXIT_SUCCESS);
+            }
+            LE_ASSERT_OK(result);
+        }
+    }
+
+    // First verification checks every signature, the second one hits the cache.
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    LE_ASSERT_OK(ima_VerifyDir(TREE_PATH, CERT_PATH));
+    uint64_t coldMs = GetElapsedMs(start);
+
+    start = le_clk_GetRelativeTime();
+    LE_ASSERT_OK(ima_VerifyDir(TREE_PATH, CERT_PATH));
+    uint64_t warmMs = GetElapsedMs(start);
+
+    LE_INFO("Verified %d files: %" PRIu64 " ms, cached: %" PRIu64 " ms",
+            DIR_COUNT * FILES_PER_DIR, coldMs, warmMs);
+
+    snprintf(path, sizeof(path), "%s/dir0/file0", TREE_PATH);
+    LE_ASSERT_OK(ima_VerifyFile(path, CERT_PATH));
+
+    // A tampered file must be verified again, and fail.
+    snprintf(path, sizeof(path), "%s/dir%d/file%d", TREE_PATH, DIR_COUNT - 1, FILES_PER_DIR / 2);
+    int fd = open(path, O_WRONLY | O_APPEND);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(write(fd, "x", 1) == 1);
+    close(fd);
+
+    LE_ASSERT(LE_FAULT == ima_VerifyFile(path, CERT_PATH));
+    LE_ASSERT(LE_FAULT == ima_VerifyDir(TREE_PATH, CERT_PATH));
+
+    // So must an unsigned file.
+    LE_ASSERT(0 == removexattr(path, "security.ima"));
+    LE_ASSERT(LE_FAULT == ima_VerifyFile(path, CERT_PATH));
+
+    le_dir_RemoveRecursive(TEST_ROOT);
+
+    LE_INFO("======== IMA verification benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,89 @@
+#!/bin/bash
+# --------------------------------------------------------------------------------------------------
+# Benchmark of the lexer of the mk tools on a generated .sdef file of about 50,000 lines.
+#
+# Usage: lexerBench.sh TARGET BUILD_DIR [LINE_COUNT] [RUN_COUNT]
+#
+# The .sdef file is mostly made of what the lexer has to get through without much work for the
+# modeller: comments, whitespace, quoted and unquoted compiler flags and a conditional block that
+# is skipped.  The system has no apps, so the build script generation time is mostly lexing and
+# parsing time.
+#
+# Copyright (C) Sierra Wireless Inc.
+# --------------------------------------------------------------------------------------------------
+
+set -e
+
+TARGET=$1
+BUILD_DIR=$2
+LINE_COUNT=${3:-50000}
+RUN_COUNT=${4:-5}
+
+if [ -z "$TARGET" ] || [ -z "$BUILD_DIR" ]
+then
+    echo "Usage: $0 TARGET BUILD_DIR [LINE_COUNT] [RUN_COUNT]" 1>&2
+    exit 1
+fi
+
+SDEF=$BUILD_DIR/bench.sdef
+
+rm -rf "$BUILD_DIR"
+mkdir -p "$BUILD_DIR"
+
+# Each block of 25 lines has a comment, flags and an inactive conditional section.
+{
+    echo "cflags:"
+    echo "{"
+    for ((i = 0; i < LINE_COUNT / 25; i++))
+    do
+        cat <<SDEF
+    /* Block $i: flags of the benchmark.
+     * The lexer must get through this comment character by character. */
+    -DBENCH_VALUE_$i=$i
+    -DBENCH_NAME_$i="bench_name_$i"
+    '-DBENCH_QUOTED_$i=quoted'
+    -I\${LEGATO_ROOT}/include/bench$i
+    -O2
+
+    // Line comment after the flags of block $i.
+#if \${LEXER_BENCH_NEVER_SET} = yes
+    -DBENCH_SKIPPED_$i
+    "-DBENCH_SKIPPED_QUOTED_$i"
+    /* A comment in a skipped section: #else */
+    // Another one: #endif
+    -DBENCH_SKIPPED_LAST_$i
+#elif \${LEXER_BENCH_NEVER_SET} = no
+    -DBENCH_ALSO_SKIPPED_$i
+#else
+    -DBENCH_ACTIVE_$i
+#endif
+    -Wall
+    -Wextra
+    -DBENCH_ALIGNED_$i=16
+    -DBENCH_PATH_$i=/usr/share/bench/$i
+    -fno-strict-aliasing
+SDEF
+    done
+    echo "}"
+} > "$SDEF"
+
+echo "Lexing $(wc -l < "$SDEF") lines ($(stat -c %s "$SDEF") bytes), $RUN_COUNT runs:"
+
+MKSYS_ARGS="$SDEF -t $TARGET -w $BUILD_DIR/work -o $BUILD_DIR --dont-run-ninja"
+
+best=0
+
+for ((run = 0; run < RUN_COUNT; run++))
+do
+    start=$(date +%s%N)
+    mksys $MKSYS_ARGS > /dev/null
+    end=$(date +%s%N)
+
+    ms=$(( (end - start) / 1000000 ))
+    if [ $run -eq 0 ] || [ $ms -lt $best ]
+    then
+        best=$ms
+    fi
+done
+
+echo "Best build script generation time: $best ms"
@@ -0,0 +1,206 @@
+#!/bin/bash
+# --------------------------------------------------------------------------------------------------
+# Benchmark of cold vs. warm no-op builds of a generated system of many apps.
+#
+# Usage: noopRebuildBench.sh TARGET BUILD_DIR [APP_COUNT]
+#
+# Measures:
+#  - a cold build, then a no-op build with the same arguments (ninja only);
+#  - a no-op build after touching a .adef file, which regenerates the build script;
+#  - the regeneration of the build script alone (parsing, modelling and code generation), cold
+#    and warm.
+# Regenerating must not rewrite any generated file that didn't change, or ninja would rebuild
+# what depends on it.
+#
+# Set GENERATE_ONLY=1 to only measure the regeneration of the build script.
+#
+# Copyright (C) Sierra Wireless Inc.
+# --------------------------------------------------------------------------------------------------
+
+set -e
+
+TARGET=$1
+BUILD_DIR=$2
+APP_COUNT=${3:-80}
+
+if [ -z "$TARGET" ] || [ -z "$BUILD_DIR" ]
+then
+    echo "Usage: $0 TARGET BUILD_DIR [APP_COUNT]" 1>&2
+    exit 1
+fi
+
+SRC_DIR=$BUILD_DIR/src
+WORK_DIR=$BUILD_DIR/work
+STAMP=$BUILD_DIR/stamp
+
+# Generate the system: each app has its own server component, which uses a shared component.
+rm -rf "$BUILD_DIR"
+mkdir -p "$SRC_DIR/apps" "$SRC_DIR/components/benchUtil" "$SRC_DIR/interfaces"
+
+cat > "$SRC_DIR/interfaces/benchTypes.api" <<API
+DEFINE MAX_VALUE = 100;
+API
+
+cat > "$SRC_DIR/interfaces/bench.api" <<API
+USETYPES benchTypes.api;
+
+FUNCTION Ping
+(
+    int32 value IN
+);
+API
+
+cat > "$SRC_DIR/components/benchUtil/Component.cdef" <<CDEF
+sources:
+{
+    benchUtil.c
+}
+CDEF
+
+cat > "$SRC_DIR/components/benchUtil/benchUtil.c" <<C
+#include "legato.h"
+
+int benchUtil_Clamp(int value, int max)
+{
+    return (value > max) ? max : value;
+}
+
+COMPONENT_INIT
+{
+}
+C
+
+echo "apps:" > "$SRC_DIR/bench.sdef"
+echo "{" >> "$SRC_DIR/bench.sdef"
+
+for ((i = 0; i < APP_COUNT; i++))
+do
+    compDir=$SRC_DIR/components/benchComp$i
+    mkdir -p "$compDir"
+
+    cat > "$compDir/Component.cdef" <<CDEF
+provides:
+{
+    api:
+    {
+        bench.api
+    }
+}
+
+requires:
+{
+    component:
+    {
+        benchUtil
+    }
+}
+
+sources:
+{
+    benchComp.c
+}
+CDEF
+
+    cat > "$compDir/benchComp.c" <<C
+#include "legato.h"
+#include "interfaces.h"
+
+int benchUtil_Clamp(int value, int max);
+
+void bench_Ping(int32_t value)
+{
+    LE_INFO("App $i: %d", benchUtil_Clamp(value, BENCH_MAX_VALUE));
+}
+
+COMPONENT_INIT
+{
+}
+C
+
+    cat > "$SRC_DIR/apps/benchApp$i.adef" <<ADEF
+executables:
+{
+    benchExe$i = ( benchComp$i )
+}
+
+processes:
+{
+    run:
+    {
+        ( benchExe$i )
+    }
+}
+ADEF
+
+    echo "    benchApp$i" >> "$SRC_DIR/bench.sdef"
+done
+
+cat >> "$SRC_DIR/bench.sdef" <<SDEF
+}
+
+appSearch:
+{
+    \$CURDIR/apps
+}
+
+componentSearch:
+{
+    \$CURDIR/components
+}
+
+interfaceSearch:
+{
+    \$CURDIR/interfaces
+}
+SDEF
+
+MKSYS_ARGS="$SRC_DIR/bench.sdef -t $TARGET -w $WORK_DIR -o $BUILD_DIR"
+
+# Run a command, printing how long it took.
+function Time()
+{
+    local label=$1
+    shift
+
+    local start=$(date +%s%N)
+    "$@" > /dev/null
+    local end=$(date +%s%N)
+
+    printf "%-40s %6d ms\n" "$label:" $(( (end - start) / 1000000 ))
+}
+
+# Count the files generated in the working dir that were written since the stamp, except for the
+# build script itself and the staging area, which are always rewritten.
+function CountRewritten()
+{
+    find "$WORK_DIR" -type f -newer "$STAMP" \
+         ! -name build.ninja ! -name '.ninja_*' ! -path "$WORK_DIR/staging/*" | wc -l
+}
+
+echo "System of $APP_COUNT apps:"
+
+if [ "$GENERATE_ONLY" != "1" ]
+then
+    Time "Cold build" mksys $MKSYS_ARGS
+    Time "No-op build" mksys $MKSYS_ARGS
+
+    sleep 1
+    touch "$STAMP"
+    touch "$SRC_DIR/apps/benchApp0.adef"
+    Time "No-op build after touching a .adef" mksys $MKSYS_ARGS
+else
+    Time "Cold build script generation" mksys $MKSYS_ARGS --dont-run-ninja
+    sleep 1
+    touch "$STAMP"
+fi
+
+Time "Warm build script generation" mksys $MKSYS_ARGS --dont-run-ninja
+
+rewritten=$(CountRewritten)
+echo "Generated files rewritten by no-op builds: $rewritten"
+
+if [ "$rewritten" -ne 0 ]
+then
+    echo "**ERROR: Regenerating the build script rewrote unchanged files." 1>&2
+    exit 1
+fi
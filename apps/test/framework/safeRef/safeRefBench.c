@@ -0,0 +1,228 @@
+/**
+ * Benchmark of Safe References.
+ *
+ * References are created, looked up in a pseudo-random order and deleted, with 100 and with
+ * 1,000,000 of them live in the map.  The same is done with a hashmap of references to pointers,
+ * which is how the maps used to be implemented, for comparison.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "limit.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of operations timed for each measurement, whatever the number of live references.
+ */
+//--------------------------------------------------------------------------------------------------
+#define OP_COUNT            2000000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Times of the three operations, in nanoseconds per operation.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    double createNs;
+    double lookupNs;
+    double deleteNs;
+}
+Times_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since a start time, in nanoseconds per operation.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetNsPerOp
+(
+    le_clk_Time_t start,
+    size_t opCount
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return ((double)elapsed.sec * 1e9 + (double)elapsed.usec * 1e3) / opCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next index of a pseudo-random walk over live references.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t NextIndex
+(
+    uint32_t* seedPtr,
+    size_t count
+)
+{
+    *seedPtr = *seedPtr * 1103515245 + 12345;
+
+    return ((size_t)(*seedPtr >> 8)) % count;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure a Reference Map holding a number of live references.  Creation and deletion are timed
+ * over all the references, as many times as it takes to do OP_COUNT of them.
+ */
+//--------------------------------------------------------------------------------------------------
+static Times_t MeasureRefMap
+(
+    size_t liveCount
+)
+{
+    Times_t times = { 0 };
+    void** refsPtr = malloc(liveCount * sizeof(void*));
+    LE_ASSERT(refsPtr != NULL);
+
+    size_t roundCount = (OP_COUNT + liveCount - 1) / liveCount;
+    size_t opCount = roundCount * liveCount;
+    uint32_t seed = 1;
+    size_t round;
+    size_t i;
+
+    char name[LIMIT_MAX_MEM_POOL_NAME_BYTES];
+    snprintf(name, sizeof(name), "RefBench%zu", liveCount);
+
+    le_ref_MapRef_t mapRef = le_ref_CreateMap(name, liveCount);
+
+    for (round = 0; round < roundCount; round++)
+    {
+        le_clk_Time_t start = le_clk_GetRelativeTime();
+        for (i = 0; i < liveCount; i++)
+        {
+            refsPtr[i] = le_ref_CreateRef(mapRef, &refsPtr[i]);
+        }
+        times.createNs += GetNsPerOp(start, opCount);
+
+        start = le_clk_GetRelativeTime();
+        for (i = 0; i < liveCount; i++)
+        {
+            size_t index = NextIndex(&seed, liveCount);
+            LE_ASSERT(le_ref_Lookup(mapRef, refsPtr[index]) == &refsPtr[index]);
+        }
+        times.lookupNs += GetNsPerOp(start, opCount);
+
+        start = le_clk_GetRelativeTime();
+        for (i = 0; i < liveCount; i++)
+        {
+            le_ref_DeleteRef(mapRef, refsPtr[i]);
+        }
+        times.deleteNs += GetNsPerOp(start, opCount);
+    }
+
+    // Deleted references must stay invalid.
+    for (i = 0; i < liveCount; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef, refsPtr[i]) == NULL);
+    }
+
+    free(refsPtr);
+
+    return times;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure a hashmap of references to pointers, the way Reference Maps used to be implemented.
+ */
+//--------------------------------------------------------------------------------------------------
+static Times_t MeasureHashmap
+(
+    size_t liveCount
+)
+{
+    Times_t times = { 0 };
+    void** refsPtr = malloc(liveCount * sizeof(void*));
+    LE_ASSERT(refsPtr != NULL);
+
+    size_t roundCount = (OP_COUNT + liveCount - 1) / liveCount;
+    size_t opCount = roundCount * liveCount;
+    uint32_t seed = 1;
+    size_t nextRef = 1;
+    size_t round;
+    size_t i;
+
+    char name[LIMIT_MAX_MEM_POOL_NAME_BYTES];
+    snprintf(name, sizeof(name), "HashBench%zu", liveCount);
+
+    le_hashmap_Ref_t hashmapRef = le_hashmap_Create(name,
+                                                    liveCount,
+                                                    le_hashmap_HashVoidPointer,
+                                                    le_hashmap_EqualsVoidPointer);
+
+    for (round = 0; round < roundCount; round++)
+    {
+        le_clk_Time_t start = le_clk_GetRelativeTime();
+        for (i = 0; i < liveCount; i++)
+        {
+            refsPtr[i] = (void*)nextRef;
+            nextRef = (nextRef + 2) & UINT32_MAX;
+            le_hashmap_Put(hashmapRef, refsPtr[i], &refsPtr[i]);
+        }
+        times.createNs += GetNsPerOp(start, opCount);
+
+        start = le_clk_GetRelativeTime();
+        for (i = 0; i < liveCount; i++)
+        {
+            size_t index = NextIndex(&seed, liveCount);
+            LE_ASSERT(le_hashmap_Get(hashmapRef, refsPtr[index]) == &refsPtr[index]);
+        }
+        times.lookupNs += GetNsPerOp(start, opCount);
+
+        start = le_clk_GetRelativeTime();
+        for (i = 0; i < liveCount; i++)
+        {
+            le_hashmap_Remove(hashmapRef, refsPtr[i]);
+        }
+        times.deleteNs += GetNsPerOp(start, opCount);
+    }
+
+    free(refsPtr);
+
+    return times;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure and report both implementations with a number of live references.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Measure
+(
+    size_t liveCount
+)
+{
+    Times_t refMap = MeasureRefMap(liveCount);
+    Times_t hashmap = MeasureHashmap(liveCount);
+
+    LE_INFO("%zu live references, in ns per operation: "
+            "create %.1f (hashmap %.1f), lookup %.1f (hashmap %.1f), delete %.1f (hashmap %.1f)",
+            liveCount,
+            refMap.createNs, hashmap.createNs,
+            refMap.lookupNs, hashmap.lookupNs,
+            refMap.deleteNs, hashmap.deleteNs);
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== Safe References benchmark ========");
+
+    Measure(100);
+    Measure(1000000);
+
+    LE_INFO("======== Safe References benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,77 @@
+/**
+ * Test that the size of a Reference Map follows the number of live references in it, rather than
+ * the number of references ever created in it.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "safeRef.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of references created and deleted in each map.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CYCLE_COUNT         5000000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create and delete references in a map, keeping a number of them live at any time, and check
+ * that the map doesn't grow past a small multiple of that number.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Churn
+(
+    const char* name,
+    size_t liveCount
+)
+{
+    void** refsPtr = malloc(liveCount * sizeof(void*));
+    LE_ASSERT(refsPtr != NULL);
+
+    le_ref_MapRef_t mapRef = le_ref_CreateMap(name, liveCount);
+    size_t i;
+
+    for (i = 0; i < liveCount; i++)
+    {
+        refsPtr[i] = le_ref_CreateRef(mapRef, &refsPtr[i]);
+    }
+
+    for (i = 0; i < CYCLE_COUNT; i++)
+    {
+        size_t index = i % liveCount;
+
+        le_ref_DeleteRef(mapRef, refsPtr[index]);
+        refsPtr[index] = le_ref_CreateRef(mapRef, &refsPtr[index]);
+    }
+
+    for (i = 0; i < liveCount; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef, refsPtr[i]) == &refsPtr[i]);
+    }
+
+    size_t slotCount = safeRef_GetSlotCount(mapRef);
+
+    LE_INFO("Map '%s': %zu slots for %zu live references after %d cycles.",
+            name, slotCount, liveCount, CYCLE_COUNT);
+
+    LE_ASSERT(slotCount <= 4 * liveCount);
+
+    free(refsPtr);
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== Safe References churn test ========");
+
+    Churn("Churn1", 1);
+    Churn("Churn100", 100);
+
+    LE_INFO("======== Safe References churn test PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
@@ -65,6 +65,79 @@ COMPONENT_INIT
     LE_INFO("Looking up a pointer value failed, as expected");
 
 
+    LE_INFO("Growing the map past its expected size.");
+
+    void* refs[100];
+    int i;
+
+    for (i = 0; i < 100; i++)
+    {
+        refs[i] = le_ref_CreateRef(mapRef1, (void*)(size_t)(0x2000 + i));
+        LE_ASSERT(((size_t)refs[i] & 1) && ((size_t)refs[i] <= UINT32_MAX));
+    }
+    for (i = 0; i < 100; i++)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef1, refs[i]) == (void*)(size_t)(0x2000 + i));
+    }
+    LE_ASSERT(le_ref_Lookup(mapRef1, safeRef4) == (void*)0x1004);
+
+    LE_INFO("Iterating over the map.");
+
+    int count = 0;
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(mapRef1);
+
+    while (le_ref_NextNode(iterRef) == LE_OK)
+    {
+        LE_ASSERT(le_ref_Lookup(mapRef1, (void*)le_ref_GetSafeRef(iterRef)) == le_ref_GetValue(iterRef));
+        count++;
+    }
+    LE_ASSERT(count == 104);
+    LE_ASSERT(le_ref_GetValue(iterRef) == NULL);
+
+    LE_INFO("Checking that stale references stay invalid as slots are reused.");
+
+    for (i = 0; i < 100; i++)
+    {
+        le_ref_DeleteRef(mapRef1, refs[i]);
+    }
+    for (i = 0; i < 1000; i++)
+    {
+        void* newRef = le_ref_CreateRef(mapRef1, (void*)0x3000);
+        int j;
+
+        for (j = 0; j < 100; j++)
+        {
+            LE_ASSERT(newRef != refs[j]);
+            LE_ASSERT(le_ref_Lookup(mapRef1, refs[j]) == NULL);
+        }
+        le_ref_DeleteRef(mapRef1, newRef);
+    }
+
+    LE_INFO("Checking that a stale reference stays invalid while its slot goes through its "
+            "generations.");
+
+    le_ref_MapRef_t mapRef3 = le_ref_CreateMap("Map 3", 1);
+    void* firstRef = le_ref_CreateRef(mapRef3, (void*)0x5000);
+    le_ref_DeleteRef(mapRef3, firstRef);
+
+    for (i = 0; i < 1000; i++)
+    {
+        void* newRef = le_ref_CreateRef(mapRef3, (void*)0x5001);
+
+        LE_ASSERT(newRef != firstRef);
+        LE_ASSERT(le_ref_Lookup(mapRef3, firstRef) == NULL);
+        LE_ASSERT(le_ref_Lookup(mapRef3, newRef) == (void*)0x5001);
+        le_ref_DeleteRef(mapRef3, newRef);
+    }
+
+    LE_INFO("Checking that references from another map are invalid.");
+
+    le_ref_MapRef_t mapRef2 = le_ref_CreateMap("Map 2", 4);
+    void* otherRef = le_ref_CreateRef(mapRef2, (void*)0x4001);
+    LE_ASSERT(le_ref_Lookup(mapRef1, otherRef) == NULL);
+    LE_ASSERT(le_ref_Lookup(mapRef2, otherRef) == (void*)0x4001);
+
+
     LE_INFO("======== SAFE REFERENCES TEST COMPLETE (PASSED) ========");
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,375 @@
+/**
+ * Benchmark of the slowdown of an app traced by sbtrace.
+ *
+ * Runs a system call heavy workload, which mostly makes system calls that don't access files and
+ * sometimes stats and opens a file, as a child process:
+ *  - untraced,
+ *  - traced the way sbtrace does without filters, stopping at the entry and exit of every system
+ *    call, and
+ *  - traced the way sbtrace does with filters, where the child installs a seccomp filter that only
+ *    stops it at the system calls that access files.
+ *
+ * The tracer reads the registers at each stop where sbtrace would, so the cost of the stops is
+ * comparable to sbtrace's.  If the system doesn't allow tracing, or doesn't support seccomp
+ * filters, the affected measurements are skipped.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include <sys/ptrace.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <elf.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of iterations of the workload.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ITERATION_COUNT         20000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of system calls that don't access files made in each iteration.
+ */
+//--------------------------------------------------------------------------------------------------
+#define OTHER_SYS_CALL_COUNT    16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Exit code of the child when it couldn't set itself up to be traced the way it was asked to.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EXIT_NOT_SUPPORTED      2
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ways of running the workload.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    MODE_UNTRACED,
+    MODE_TRACE_ALL,
+    MODE_TRACE_FILTERED
+}
+Mode_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * System calls the filter stops at.  These are the ones the workload uses to access files.
+ */
+//--------------------------------------------------------------------------------------------------
+static const int FilteredSysCalls[] =
+{
+#ifdef __NR_open
+    __NR_open,
+#endif
+#ifdef __NR_openat
+    __NR_openat,
+#endif
+#ifdef __NR_stat
+    __NR_stat,
+#endif
+#ifdef __NR_stat64
+    __NR_stat64,
+#endif
+#ifdef __NR_newfstatat
+    __NR_newfstatat,
+#endif
+#ifdef __NR_fstatat64
+    __NR_fstatat64,
+#endif
+#ifdef __NR_statx
+    __NR_statx,
+#endif
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Installs a seccomp filter in the calling process, that stops it at the system calls in
+ * FilteredSysCalls and allows all others.
+ *
+ * @return LE_OK if successful, LE_NOT_IMPLEMENTED if seccomp filters are not supported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t InstallFilter
+(
+    void
+)
+{
+    const size_t numSysCalls = NUM_ARRAY_MEMBERS(FilteredSysCalls);
+    struct sock_filter filter[numSysCalls + 3];
+    size_t i;
+
+    filter[0] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS,
+                                             offsetof(struct seccomp_data, nr));
+
+    for (i = 0; i < numSysCalls; i++)
+    {
+        // Jump to the last instruction if it matches.
+        filter[i + 1] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+                                                     FilteredSysCalls[i], numSysCalls - i, 0);
+    }
+
+    filter[numSysCalls + 1] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    filter[numSysCalls + 2] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRACE);
+
+    struct sock_fprog prog = { .len = NUM_ARRAY_MEMBERS(filter), .filter = filter };
+
+    if ( (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0) ||
+         (prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog) != 0) )
+    {
+        return LE_NOT_IMPLEMENTED;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the workload in the child process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunChild
+(
+    Mode_t mode
+)
+{
+    if (mode != MODE_UNTRACED)
+    {
+        // Wait for the tracer to set its options.
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0)
+        {
+            _exit(EXIT_NOT_SUPPORTED);
+        }
+
+        raise(SIGSTOP);
+    }
+
+    if ( (mode == MODE_TRACE_FILTERED) && (InstallFilter() != LE_OK) )
+    {
+        _exit(EXIT_NOT_SUPPORTED);
+    }
+
+    int i;
+    for (i = 0; i < ITERATION_COUNT; i++)
+    {
+        int j;
+        for (j = 0; j < OTHER_SYS_CALL_COUNT; j++)
+        {
+            // Not getpid(), as that may not make a system call every time.
+            syscall(SYS_getppid);
+        }
+
+        struct stat statBuf;
+
+        if (stat("/", &statBuf) != 0)
+        {
+            _exit(EXIT_FAILURE);
+        }
+
+        int fd = open("/dev/null", O_RDONLY);
+
+        if (fd < 0)
+        {
+            _exit(EXIT_FAILURE);
+        }
+
+        close(fd);
+    }
+
+    _exit(EXIT_SUCCESS);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the registers of a stopped tracee, as sbtrace does to get the system call.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadRegs
+(
+    pid_t pid
+)
+{
+    unsigned long regs[64];
+    struct iovec regsVec = { .iov_base = regs, .iov_len = sizeof(regs) };
+
+    LE_ASSERT(ptrace(PTRACE_GETREGSET, pid, (void*)NT_PRSTATUS, &regsVec) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Traces the child until it exits.
+ *
+ * @return The child's exit status, as returned by waitpid().
+ */
+//--------------------------------------------------------------------------------------------------
+static int TraceChild
+(
+    pid_t pid,
+    Mode_t mode,
+    size_t* stopCountPtr        ///< [OUT] Number of times the child stopped at a system call.
+)
+{
+    int status;
+    bool inSysCall = false;
+
+    *stopCountPtr = 0;
+
+    // Wait for the child to stop itself.
+    LE_ASSERT(waitpid(pid, &status, 0) == pid);
+
+    if (!WIFSTOPPED(status))
+    {
+        return status;
+    }
+
+    int options = PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL;
+    int restart = PTRACE_SYSCALL;
+
+    if (mode == MODE_TRACE_FILTERED)
+    {
+        options |= PTRACE_O_TRACESECCOMP;
+        restart = PTRACE_CONT;
+    }
+
+    LE_ASSERT(ptrace(PTRACE_SETOPTIONS, pid, NULL, (void*)(intptr_t)options) == 0);
+    LE_ASSERT(ptrace(restart, pid, NULL, NULL) == 0);
+
+    while (1)
+    {
+        LE_ASSERT(waitpid(pid, &status, 0) == pid);
+
+        if (!WIFSTOPPED(status))
+        {
+            return status;
+        }
+
+        int sigToDeliver = 0;
+
+        if ( (status >> 8) == (SIGTRAP | PTRACE_EVENT_SECCOMP << 8) )
+        {
+            ReadRegs(pid);
+            (*stopCountPtr)++;
+        }
+        else if (WSTOPSIG(status) == (SIGTRAP | 0x80))
+        {
+            // sbtrace only looks at the system call when it is entered.
+            if (!inSysCall)
+            {
+                ReadRegs(pid);
+            }
+
+            inSysCall = !inSysCall;
+            (*stopCountPtr)++;
+        }
+        else if (WSTOPSIG(status) != SIGTRAP)
+        {
+            sigToDeliver = WSTOPSIG(status);
+        }
+
+        LE_ASSERT(ptrace(restart, pid, NULL, (void*)(intptr_t)sigToDeliver) == 0);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs the workload in a child process.
+ *
+ * @return The elapsed time in seconds, or a negative value if the mode is not supported.
+ */
+//--------------------------------------------------------------------------------------------------
+static double Measure
+(
+    Mode_t mode,
+    size_t* stopCountPtr        ///< [OUT] Number of times the child stopped at a system call.
+)
+{
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+
+    pid_t pid = fork();
+    LE_ASSERT(pid >= 0);
+
+    if (pid == 0)
+    {
+        RunChild(mode);
+    }
+
+    int status;
+
+    if (mode == MODE_UNTRACED)
+    {
+        *stopCountPtr = 0;
+        LE_ASSERT(waitpid(pid, &status, 0) == pid);
+    }
+    else
+    {
+        status = TraceChild(pid, mode, stopCountPtr);
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    LE_ASSERT(WIFEXITED(status));
+
+    if (WEXITSTATUS(status) == EXIT_NOT_SUPPORTED)
+    {
+        return -1;
+    }
+
+    LE_ASSERT(WEXITSTATUS(status) == EXIT_SUCCESS);
+
+    return (double)elapsed.sec + (double)elapsed.usec / 1e6;
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== sbtrace benchmark ========");
+
+    static const char* const modeNames[] =
+    {
+        "untraced",
+        "stopped at every system call",
+        "stopped at filtered system calls"
+    };
+
+    size_t stopCount;
+    double untracedTime = Measure(MODE_UNTRACED, &stopCount);
+
+    LE_INFO("%d iterations %s: %.3f s", ITERATION_COUNT, modeNames[MODE_UNTRACED], untracedTime);
+
+    Mode_t mode;
+    for (mode = MODE_TRACE_ALL; mode <= MODE_TRACE_FILTERED; mode++)
+    {
+        double time = Measure(mode, &stopCount);
+
+        if (time < 0)
+        {
+            LE_INFO("%s: not supported, skipped", modeNames[mode]);
+            continue;
+        }
+
+        LE_INFO("%d iterations %s: %.3f s, %zu stops, %.1f times slower than untraced",
+                ITERATION_COUNT, modeNames[mode], time, stopCount, time / untracedTime);
+    }
+
+    LE_INFO("======== sbtrace benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,205 @@
+#include "legato.h"
+#include "interfaces.h"
+
+#include <ftw.h>
+
+
+// Number of items written by the benchmark.
+#define NUM_ITEMS           10000
+
+// Size of each item.
+#define ITEM_SIZE           32
+
+// Limit used for the benchmark, large enough for all the items.
+#define BENCH_LIMIT         (NUM_ITEMS * ITEM_SIZE)
+
+// Number of items written by the batching test, fewer than fit in a batch.
+#define NUM_BATCH_ITEMS     16
+
+
+// Number of files found by CountFile().
+static int FileCount;
+
+
+// Prints the time elapsed since the start time for a number of operations.
+static void PrintElapsed
+(
+    const char* namePtr,
+    le_clk_Time_t startTime,
+    int numOps
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    uint64_t usec = (uint64_t)elapsed.sec * 1000000 + elapsed.usec;
+
+    LE_INFO("%s: %d ops in %" PRIu64 " us (%" PRIu64 " ns/op)",
+            namePtr, numOps, usec, (usec * 1000) / numOps);
+}
+
+
+// Builds the name and content of an item.
+static void MakeItem
+(
+    int index,
+    char* namePtr,
+    size_t nameSize,
+    uint8_t* dataPtr
+)
+{
+    snprintf(namePtr, nameSize, "bench/item%d", index);
+    memset(dataPtr, 'a' + (index % 26), ITEM_SIZE);
+    memcpy(dataPtr, &index, sizeof(index));
+}
+
+
+// Write, read back and delete many small items.
+static void BenchSmallItems
+(
+    void
+)
+{
+    LE_INFO("############################################################################################");
+    LE_INFO("#################### BenchSmallItems #######################################################");
+    LE_INFO("############################################################################################");
+
+    char name[LE_SECSTORE_MAX_NAME_BYTES];
+    uint8_t data[ITEM_SIZE];
+    uint8_t outBuffer[ITEM_SIZE];
+    size_t outBufferSize;
+    le_result_t result;
+    le_clk_Time_t startTime;
+    int i;
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < NUM_ITEMS; i++)
+    {
+        MakeItem(i, name, sizeof(name), data);
+        result = le_secStore_Write(name, data, sizeof(data));
+        LE_FATAL_IF(result != LE_OK, "write %d failed: [%s]", i, LE_RESULT_TXT(result));
+    }
+    PrintElapsed("Write", startTime, NUM_ITEMS);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < NUM_ITEMS; i++)
+    {
+        MakeItem(i, name, sizeof(name), data);
+        outBufferSize = sizeof(outBuffer);
+        result = le_secStore_Read(name, outBuffer, &outBufferSize);
+        LE_FATAL_IF(result != LE_OK, "read %d failed: [%s]", i, LE_RESULT_TXT(result));
+        LE_FATAL_IF((outBufferSize != sizeof(data)) || (memcmp(outBuffer, data, sizeof(data)) != 0),
+                    "item %d has unexpected contents", i);
+    }
+    PrintElapsed("Read", startTime, NUM_ITEMS);
+
+    // The storage is full: writing one more byte must fail, overwriting an item must not.
+    result = le_secStore_Write("bench/extra", data, 1);
+    LE_FATAL_IF(result != LE_NO_MEMORY, "write over limit returned [%s]", LE_RESULT_TXT(result));
+
+    MakeItem(0, name, sizeof(name), data);
+    result = le_secStore_Write(name, data, sizeof(data));
+    LE_FATAL_IF(result != LE_OK, "overwrite failed: [%s]", LE_RESULT_TXT(result));
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < NUM_ITEMS; i++)
+    {
+        MakeItem(i, name, sizeof(name), data);
+        result = le_secStore_Delete(name);
+        LE_FATAL_IF(result != LE_OK, "delete %d failed: [%s]", i, LE_RESULT_TXT(result));
+    }
+    PrintElapsed("Delete", startTime, NUM_ITEMS);
+
+    // The space of the deleted items must be available again.
+    result = le_secStore_Write("bench/extra", data, sizeof(data));
+    LE_FATAL_IF(result != LE_OK, "write after delete failed: [%s]", LE_RESULT_TXT(result));
+
+    result = le_secStore_Delete("bench");
+    LE_FATAL_IF(result != LE_OK, "delete failed: [%s]", LE_RESULT_TXT(result));
+
+    LE_INFO("#################### END OF BenchSmallItems ################################################");
+    LE_INFO(" ");
+}
+
+
+// Counts the files of the batching test.
+static int CountFile
+(
+    const char* pathPtr,
+    const struct stat* statPtr,
+    int type,
+    struct FTW* ftwPtr
+)
+{
+    if ( (type == FTW_F) && (strstr(pathPtr, "/batch/") != NULL) )
+    {
+        FileCount++;
+    }
+
+    return 0;
+}
+
+
+// Write a few small items and check that they are not flushed one by one, although the size of
+// each item is checked against the limit before it is written.
+static void TestBatchedWrites
+(
+    void
+)
+{
+    LE_INFO("############################################################################################");
+    LE_INFO("#################### TestBatchedWrites #####################################################");
+    LE_INFO("############################################################################################");
+
+    char name[LE_SECSTORE_MAX_NAME_BYTES];
+    uint8_t data[ITEM_SIZE];
+    uint8_t outBuffer[ITEM_SIZE];
+    size_t outBufferSize;
+    le_result_t result;
+    int i;
+
+    for (i = 0; i < NUM_BATCH_ITEMS; i++)
+    {
+        snprintf(name, sizeof(name), "batch/item%d", i);
+        memset(data, 'a' + i, sizeof(data));
+        result = le_secStore_Write(name, data, sizeof(data));
+        LE_FATAL_IF(result != LE_OK, "write %d failed: [%s]", i, LE_RESULT_TXT(result));
+    }
+
+    // Rewriting a pending item sizes it from memory as well.
+    result = le_secStore_Write("batch/item0", data, sizeof(data));
+    LE_FATAL_IF(result != LE_OK, "rewrite failed: [%s]", LE_RESULT_TXT(result));
+
+    // None of the writes may have been flushed yet, or there was a flush per write.
+    FileCount = 0;
+    LE_FATAL_IF(nftw(STRINGIZE(PA_SECSTORE_FILE_ROOT), CountFile, 16, FTW_PHYS) != 0,
+                "could not walk secure storage: %m");
+    LE_FATAL_IF(FileCount != 0, "%d of %d items were flushed", FileCount, NUM_BATCH_ITEMS);
+
+    outBufferSize = sizeof(outBuffer);
+    result = le_secStore_Read("batch/item0", outBuffer, &outBufferSize);
+    LE_FATAL_IF((result != LE_OK) || (outBufferSize != sizeof(data)) ||
+                (memcmp(outBuffer, data, sizeof(data)) != 0),
+                "read of a pending item failed: [%s]", LE_RESULT_TXT(result));
+
+    result = le_secStore_Delete("batch");
+    LE_FATAL_IF(result != LE_OK, "delete failed: [%s]", LE_RESULT_TXT(result));
+
+    LE_INFO("#################### END OF TestBatchedWrites ##############################################");
+    LE_INFO(" ");
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("=====================================================================");
+    LE_INFO("==================== SecStoreBench BEGIN ============================");
+    LE_INFO("=====================================================================");
+
+    appCfg_SetSecStoreLimitSimu(BENCH_LIMIT);
+
+    BenchSmallItems();
+    TestBatchedWrites();
+
+    LE_INFO("============ SecStoreBench PASSED =============");
+
+    exit(EXIT_SUCCESS);
+}
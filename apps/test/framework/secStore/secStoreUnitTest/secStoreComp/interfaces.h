@@ -5,6 +5,17 @@
 
 #define LE_APPINFO_DEFAULT_APPNAME "secStoreUnitTest"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the Secure Storage limit returned for the apps.  Must be called before the first access to
+ * secure storage, since the limit is only read once.
+ */
+//--------------------------------------------------------------------------------------------------
+void appCfg_SetSecStoreLimitSimu
+(
+    size_t limit                ///< [IN] Limit in bytes
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the client session reference for the current message
@@ -35,6 +46,16 @@ le_msg_ServiceRef_t secStoreAdmin_GetServiceRef
     void
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the server service reference
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t le_secStore_GetServiceRef
+(
+    void
+);
+
 //--------------------------------------------------------------------------------------------------
 /*
  * FIXME: Declaring secStoreGlobal here since I can't seem to be able to include an api as another
@@ -14,6 +14,13 @@
 
 #define DEFAULT_UPDATE_SYSTEM_HASH                  "DEFAULTSYSTEMHASH"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Secure Storage limit returned for the apps.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t SecStoreLimit = DEFAULT_LIMIT_SEC_STORE;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stub the client session reference for the current message for secStoreAdmin
@@ -40,6 +47,19 @@ le_msg_ServiceRef_t secStoreAdmin_GetServiceRef
     return NULL;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the server service reference
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t le_secStore_GetServiceRef
+(
+    void
+)
+{
+    return NULL;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stub the client session reference for the current message for le_secStore
@@ -146,7 +166,21 @@ size_t appCfg_GetSecStoreLimit
     appCfg_Iter_t appIterRef    ///< [IN] Apps iterator
 )
 {
-    return DEFAULT_LIMIT_SEC_STORE;
+    return SecStoreLimit;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the Secure Storage limit returned for the apps.  Must be called before the first access to
+ * secure storage, since the limit is only read once.
+ */
+//--------------------------------------------------------------------------------------------------
+void appCfg_SetSecStoreLimitSimu
+(
+    size_t limit                ///< [IN] Limit in bytes
+)
+{
+    SecStoreLimit = limit;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,209 @@
+/**
+ * Benchmark of mutexes and semaphores.
+ *
+ * Measures the throughput of locks that never have to wait (a single thread locking and unlocking
+ * a mutex, or posting and waiting on a semaphore), and of locks of a mutex shared by several
+ * threads.  The shared counter the threads increment must end up with the right value.
+ *
+ * Run it with LE_MUTEX_PROFILE=1 to measure the cost of contention profiling.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of locks done by the single thread, and by each of the contending threads.
+ */
+//--------------------------------------------------------------------------------------------------
+#define UNCONTENDED_LOCK_COUNT      5000000
+#define CONTENDED_LOCK_COUNT        500000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of contending threads.
+ */
+//--------------------------------------------------------------------------------------------------
+#define THREAD_COUNT                4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex shared by the contending threads, and the counter it protects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mutex_Ref_t SharedMutex;
+static uint64_t SharedCounter;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since a start time, in nanoseconds per operation.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetNsPerOp
+(
+    le_clk_Time_t start,
+    size_t opCount
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return ((double)elapsed.sec * 1e9 + (double)elapsed.usec * 1e3) / opCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lock and unlock a mutex that no other thread uses.
+ *
+ * @return Time per lock and unlock, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double MeasureUncontendedMutex
+(
+    le_mutex_Ref_t mutexRef
+)
+{
+    int i;
+
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+
+    for (i = 0; i < UNCONTENDED_LOCK_COUNT; i++)
+    {
+        le_mutex_Lock(mutexRef);
+        le_mutex_Unlock(mutexRef);
+    }
+
+    return GetNsPerOp(start, UNCONTENDED_LOCK_COUNT);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Post and wait on a semaphore that no other thread uses.
+ *
+ * @return Time per post and wait, in nanoseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double MeasureUncontendedSemaphore
+(
+    void
+)
+{
+    le_sem_Ref_t semRef = le_sem_Create("BenchSem", 0);
+    int i;
+
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+
+    for (i = 0; i < UNCONTENDED_LOCK_COUNT; i++)
+    {
+        le_sem_Post(semRef);
+        le_sem_Wait(semRef);
+    }
+
+    double ns = GetNsPerOp(start, UNCONTENDED_LOCK_COUNT);
+
+    le_sem_Delete(semRef);
+
+    return ns;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Contending thread: increment the shared counter, under the shared mutex.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ContendingThread
+(
+    void* contextPtr
+)
+{
+    int i;
+
+    for (i = 0; i < CONTENDED_LOCK_COUNT; i++)
+    {
+        le_mutex_Lock(SharedMutex);
+        SharedCounter++;
+        le_mutex_Unlock(SharedMutex);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lock and unlock a mutex from several threads at once.
+ *
+ * @return Time per lock and unlock, in nanoseconds, over all threads.
+ */
+//--------------------------------------------------------------------------------------------------
+static double MeasureContendedMutex
+(
+    void
+)
+{
+    le_thread_Ref_t threads[THREAD_COUNT];
+    char name[32];
+    int i;
+
+    SharedMutex = le_mutex_CreateNonRecursive("BenchShared");
+    SharedCounter = 0;
+
+    for (i = 0; i < THREAD_COUNT; i++)
+    {
+        snprintf(name, sizeof(name), "Contender%d", i);
+        threads[i] = le_thread_Create(name, ContendingThread, NULL);
+        le_thread_SetJoinable(threads[i]);
+    }
+
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+
+    for (i = 0; i < THREAD_COUNT; i++)
+    {
+        le_thread_Start(threads[i]);
+    }
+    for (i = 0; i < THREAD_COUNT; i++)
+    {
+        LE_ASSERT_OK(le_thread_Join(threads[i], NULL));
+    }
+
+    double ns = GetNsPerOp(start, THREAD_COUNT * CONTENDED_LOCK_COUNT);
+
+    LE_ASSERT(SharedCounter == (uint64_t)THREAD_COUNT * CONTENDED_LOCK_COUNT);
+
+    le_mutex_Delete(SharedMutex);
+
+    return ns;
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== Mutex and semaphore benchmark ========");
+
+    le_mutex_Ref_t mutexRef = le_mutex_CreateNonRecursive("BenchMutex");
+    le_mutex_Ref_t recursiveRef = le_mutex_CreateRecursive("BenchRecursive");
+
+    LE_INFO("Uncontended, in ns per lock and unlock: mutex %.1f, recursive mutex %.1f, "
+            "semaphore %.1f",
+            MeasureUncontendedMutex(mutexRef),
+            MeasureUncontendedMutex(recursiveRef),
+            MeasureUncontendedSemaphore());
+
+    LE_INFO("Contended by %d threads, in ns per lock and unlock: mutex %.1f",
+            THREAD_COUNT,
+            MeasureContendedMutex());
+
+    le_mutex_Delete(mutexRef);
+    le_mutex_Delete(recursiveRef);
+
+    LE_INFO("======== Mutex and semaphore benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,262 @@
+/**
+ * Benchmark of the delta encoded app updates of the Update Daemon.
+ *
+ * An installed app is simulated by a directory of files, one of which is then changed. The new
+ * app is delivered both as a full app payload and as a delta encoded payload (see delta.h), and
+ * the bytes to transfer and the time to install them are compared. Both must produce the same app.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "delta.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the test files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEST_ROOT           "/tmp/deltaBench"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Installed app, new app, and where the payloads are built and unpacked.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BASE_PATH           TEST_ROOT "/base"
+#define NEW_PATH            TEST_ROOT "/new"
+#define DELTA_PATH          TEST_ROOT "/delta"
+#define FULL_UNPACK_PATH    TEST_ROOT "/fullUnpack"
+#define DELTA_UNPACK_PATH   TEST_ROOT "/deltaUnpack"
+#define FULL_PAYLOAD        TEST_ROOT "/full.tar.bz2"
+#define DELTA_PAYLOAD       TEST_ROOT "/delta.tar.bz2"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shape of the app, and of the change.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FILE_COUNT          16
+#define FILE_BYTES          (512 * 1024)
+#define CHANGED_FILE        5
+#define CHANGE_OFFSET       (FILE_BYTES / 3)
+#define CHANGE_BYTES        64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteFile
+(
+    const char* pathPtr,
+    const void* dataPtr,
+    size_t size
+)
+{
+    int fd = open(pathPtr, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(write(fd, dataPtr, size) == (ssize_t)size);
+    close(fd);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill a buffer with pseudo-random bytes, which don't compress.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillRandom
+(
+    uint8_t* dataPtr,
+    size_t size,
+    uint32_t seed
+)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        dataPtr[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a big endian integer to a buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t* PutInt
+(
+    uint8_t* bufPtr,
+    uint64_t value,
+    size_t numBytes
+)
+{
+    while (numBytes-- > 0)
+    {
+        *bufPtr++ = (uint8_t)(value >> (numBytes * 8));
+    }
+
+    return bufPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a shell command.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Run
+(
+    const char* cmdPtr
+)
+{
+    LE_ASSERT(system(cmdPtr) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the size of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+static off_t GetFileSize
+(
+    const char* pathPtr
+)
+{
+    struct stat st;
+
+    LE_ASSERT(stat(pathPtr, &st) == 0);
+
+    return st.st_size;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since a start time, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedMs
+(
+    le_clk_Time_t start
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return (uint64_t)elapsed.sec * 1000 + elapsed.usec / 1000;
+}
+
+
+COMPONENT_INIT
+{
+    static uint8_t data[FILE_BYTES];
+    uint8_t change[CHANGE_BYTES];
+    char path[PATH_MAX];
+    int i;
+
+    LE_INFO("======== Update delta benchmark ========");
+
+    le_dir_RemoveRecursive(TEST_ROOT);
+    LE_ASSERT_OK(le_dir_MakePath(BASE_PATH "/lib", S_IRWXU));
+    LE_ASSERT_OK(le_dir_MakePath(NEW_PATH "/lib", S_IRWXU));
+    LE_ASSERT_OK(le_dir_MakePath(DELTA_PATH "/lib", S_IRWXU));
+    LE_ASSERT_OK(le_dir_MakePath(FULL_UNPACK_PATH, S_IRWXU));
+    LE_ASSERT_OK(le_dir_MakePath(DELTA_UNPACK_PATH, S_IRWXU));
+
+    FillRandom(change, sizeof(change), 0xdead);
+
+    // Create the installed and the new app, and the manifest of the delta encoded app.
+    FILE* manifestPtr = fopen(DELTA_PATH "/" DELTA_MANIFEST_NAME, "w");
+    LE_ASSERT(manifestPtr != NULL);
+
+    for (i = 0; i < FILE_COUNT; i++)
+    {
+        FillRandom(data, sizeof(data), i + 1);
+
+        snprintf(path, sizeof(path), BASE_PATH "/lib/file%d", i);
+        WriteFile(path, data, sizeof(data));
+
+        if (i == CHANGED_FILE)
+        {
+            memcpy(data + CHANGE_OFFSET, change, sizeof(change));
+            fprintf(manifestPtr, "d lib/file%d\n", i);
+        }
+        else
+        {
+            fprintf(manifestPtr, "= lib/file%d\n", i);
+        }
+
+        snprintf(path, sizeof(path), NEW_PATH "/lib/file%d", i);
+        WriteFile(path, data, sizeof(data));
+    }
+
+    fclose(manifestPtr);
+
+    // Delta of the changed file: copy, add the changed bytes, copy the rest.
+    uint8_t delta[64 + CHANGE_BYTES];
+    uint8_t* deltaPtr = delta;
+
+    memcpy(deltaPtr, DELTA_MAGIC, sizeof(DELTA_MAGIC) - 1);
+    deltaPtr = PutInt(deltaPtr + sizeof(DELTA_MAGIC) - 1, FILE_BYTES, 8);
+    *deltaPtr++ = 'C';
+    deltaPtr = PutInt(PutInt(deltaPtr, 0, 8), CHANGE_OFFSET, 4);
+    *deltaPtr++ = 'A';
+    deltaPtr = PutInt(deltaPtr, CHANGE_BYTES, 4);
+    memcpy(deltaPtr, change, CHANGE_BYTES);
+    deltaPtr += CHANGE_BYTES;
+    *deltaPtr++ = 'C';
+    deltaPtr = PutInt(PutInt(deltaPtr, CHANGE_OFFSET + CHANGE_BYTES, 8),
+                      FILE_BYTES - CHANGE_OFFSET - CHANGE_BYTES,
+                      4);
+    *deltaPtr++ = 'E';
+
+    snprintf(path, sizeof(path), DELTA_PATH "/lib/file%d" DELTA_FILE_SUFFIX, CHANGED_FILE);
+    WriteFile(path, delta, deltaPtr - delta);
+
+    // A broken delta must be rejected.
+    snprintf(path, sizeof(path), TEST_ROOT "/bad" DELTA_FILE_SUFFIX);
+    WriteFile(path, delta, deltaPtr - delta - 1);
+    LE_ASSERT(LE_FORMAT_ERROR == delta_ApplyFile(BASE_PATH "/lib/file0", path, TEST_ROOT "/bad"));
+
+    // Build both payloads the way the update packs carry them.
+    Run("tar cjf " FULL_PAYLOAD " -C " NEW_PATH " .");
+    Run("tar cjf " DELTA_PAYLOAD " -C " DELTA_PATH " .");
+
+    off_t fullBytes = GetFileSize(FULL_PAYLOAD);
+    off_t deltaBytes = GetFileSize(DELTA_PAYLOAD);
+
+    // Install both.
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    Run("tar xjf " FULL_PAYLOAD " -C " FULL_UNPACK_PATH);
+    uint64_t fullMs = GetElapsedMs(start);
+
+    start = le_clk_GetRelativeTime();
+    Run("tar xjf " DELTA_PAYLOAD " -C " DELTA_UNPACK_PATH);
+    LE_ASSERT_OK(delta_ApplyApp(BASE_PATH, DELTA_UNPACK_PATH));
+    uint64_t deltaMs = GetElapsedMs(start);
+
+    LE_INFO("Full update: %jd bytes, installed in %" PRIu64 " ms",
+            (intmax_t)fullBytes, fullMs);
+    LE_INFO("Delta update: %jd bytes, installed in %" PRIu64 " ms",
+            (intmax_t)deltaBytes, deltaMs);
+
+    // Both must give the new app, and the delta must be a small fraction of the full update.
+    Run("diff -r " NEW_PATH " " FULL_UNPACK_PATH);
+    Run("diff -r " NEW_PATH " " DELTA_UNPACK_PATH);
+    LE_ASSERT(deltaBytes * 100 < fullBytes);
+
+    le_dir_RemoveRecursive(TEST_ROOT);
+
+    LE_INFO("======== Update delta benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
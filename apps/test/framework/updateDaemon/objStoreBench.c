@@ -0,0 +1,220 @@
+/**
+ * Benchmark of the object store of the Update Daemon.
+ *
+ * Successive systems, each differing from the first one by a single file, are installed and added
+ * to the object store (see objStore.h). The bytes they occupy are compared with what they would
+ * occupy without sharing, and the old systems are then removed to check that the objects only
+ * they used are garbage collected.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "objStore.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Root of the test files. The object store must be in it (see the CMakeLists.txt).
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEST_ROOT           "/tmp/objStoreBench"
+#define SYSTEMS_PATH        TEST_ROOT "/systems"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shape of the systems.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SYSTEM_COUNT        5
+#define FILE_COUNT          32
+#define FILE_BYTES          (256 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fill a buffer with pseudo-random bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FillRandom
+(
+    uint8_t* dataPtr,
+    size_t size,
+    uint32_t seed
+)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        dataPtr[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Install a system: all its files are those of system 0, except file # systemIndex.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InstallSystem
+(
+    int systemIndex
+)
+{
+    static uint8_t data[FILE_BYTES];
+    char path[PATH_MAX];
+    int i;
+
+    snprintf(path, sizeof(path), SYSTEMS_PATH "/%d/lib", systemIndex);
+    LE_ASSERT_OK(le_dir_MakePath(path, S_IRWXU));
+
+    for (i = 0; i < FILE_COUNT; i++)
+    {
+        FillRandom(data, sizeof(data), ((systemIndex > 0) && (i == systemIndex)) ?
+                                       (1000 + systemIndex) : (i + 1));
+
+        snprintf(path, sizeof(path), SYSTEMS_PATH "/%d/lib/file%d", systemIndex, i);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IRGRP | S_IROTH);
+        LE_ASSERT(fd >= 0);
+        LE_ASSERT(write(fd, data, sizeof(data)) == (ssize_t)sizeof(data));
+        close(fd);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the bytes occupied by the files of a tree, counting each inode once.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetOccupiedBytes
+(
+    const char* dirPath
+)
+{
+    static ino_t inodes[(SYSTEM_COUNT + 1) * FILE_COUNT];
+    size_t inodeCount = 0;
+    char* pathArrayPtr[] = { (char*)dirPath, NULL };
+    uint64_t bytes = 0;
+
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL | FTS_NOCHDIR, NULL);
+    LE_ASSERT(ftsPtr != NULL);
+
+    FTSENT* entPtr;
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        if (entPtr->fts_info == FTS_F)
+        {
+            size_t i;
+
+            for (i = 0; (i < inodeCount) && (inodes[i] != entPtr->fts_statp->st_ino); i++)
+            {
+            }
+
+            if (i == inodeCount)
+            {
+                LE_ASSERT(inodeCount < NUM_ARRAY_MEMBERS(inodes));
+                inodes[inodeCount++] = entPtr->fts_statp->st_ino;
+                bytes += entPtr->fts_statp->st_size;
+            }
+        }
+    }
+
+    fts_close(ftsPtr);
+
+    return bytes;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the time elapsed since a start time, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetElapsedMs
+(
+    le_clk_Time_t start
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return (uint64_t)elapsed.sec * 1000 + elapsed.usec / 1000;
+}
+
+
+COMPONENT_INIT
+{
+    objStore_Stats_t stats;
+    char path[PATH_MAX];
+    uint64_t installMs = 0;
+    uint64_t addMs = 0;
+    int i;
+
+    LE_INFO("======== Object store benchmark ========");
+
+    le_dir_RemoveRecursive(TEST_ROOT);
+
+    for (i = 0; i < SYSTEM_COUNT; i++)
+    {
+        le_clk_Time_t start = le_clk_GetRelativeTime();
+        InstallSystem(i);
+        installMs += GetElapsedMs(start);
+
+        start = le_clk_GetRelativeTime();
+        snprintf(path, sizeof(path), SYSTEMS_PATH "/%d", i);
+        LE_ASSERT_OK(objStore_AddTree(path, &stats));
+        addMs += GetElapsedMs(start);
+
+        // The first system fills the store, the next ones only bring their changed file.
+        LE_ASSERT(stats.fileCount == FILE_COUNT);
+        LE_ASSERT(stats.newCount == ((i == 0) ? FILE_COUNT : 1));
+        LE_ASSERT(stats.linkedCount == ((i == 0) ? 0 : FILE_COUNT - 1));
+
+        // Adding a tree again doesn't change anything.
+        LE_ASSERT_OK(objStore_AddTree(path, &stats));
+        LE_ASSERT((stats.newCount == 0) && (stats.linkedCount == 0));
+    }
+
+    uint64_t plainBytes = (uint64_t)SYSTEM_COUNT * FILE_COUNT * FILE_BYTES;
+    uint64_t sharedBytes = GetOccupiedBytes(TEST_ROOT);
+
+    LE_INFO("%d systems: %" PRIu64 " bytes without sharing, %" PRIu64 " bytes shared",
+            SYSTEM_COUNT, plainBytes, sharedBytes);
+    LE_INFO("Installed in %" PRIu64 " ms, plus %" PRIu64 " ms to share", installMs, addMs);
+
+    LE_ASSERT(sharedBytes == (uint64_t)(FILE_COUNT + SYSTEM_COUNT - 1) * FILE_BYTES);
+
+    // A shared file must still read as before.
+    static uint8_t expected[FILE_BYTES];
+    static uint8_t actual[FILE_BYTES];
+    FillRandom(expected, sizeof(expected), 1);
+    int fd = open(SYSTEMS_PATH "/3/lib/file0", O_RDONLY);
+    LE_ASSERT(fd >= 0);
+    LE_ASSERT(read(fd, actual, sizeof(actual)) == (ssize_t)sizeof(actual));
+    close(fd);
+    LE_ASSERT(memcmp(expected, actual, sizeof(actual)) == 0);
+
+    // Keep the last system only: the changed files of the others, and the file of system 0 that
+    // the last system changed, aren't used anymore.
+    for (i = 0; i < SYSTEM_COUNT - 1; i++)
+    {
+        snprintf(path, sizeof(path), SYSTEMS_PATH "/%d", i);
+        LE_ASSERT_OK(le_dir_RemoveRecursive(path));
+    }
+
+    objStore_CollectGarbage(&stats);
+
+    LE_INFO("Garbage collected %" PRIu64 " bytes", stats.bytesSaved);
+
+    LE_ASSERT(stats.bytesSaved == (uint64_t)(SYSTEM_COUNT - 1) * FILE_BYTES);
+    LE_ASSERT(GetOccupiedBytes(TEST_ROOT) == (uint64_t)FILE_COUNT * FILE_BYTES);
+
+    le_dir_RemoveRecursive(TEST_ROOT);
+
+    LE_INFO("======== Object store benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
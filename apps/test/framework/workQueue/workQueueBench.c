@@ -0,0 +1,280 @@
+/**
+ * Benchmark of the Work Queue API.
+ *
+ * Measures the throughput of small tasks against the number of workers, from one worker up to one
+ * per online CPU:
+ *  - tasks submitted by the main thread and waited for one by one, which the workers have to
+ *    steal from each other's queues as they drain unevenly, and
+ *  - tasks splitting their work into nested sub-tasks, which stay on the queue of the worker that
+ *    created them unless an idle worker steals them.
+ *
+ * It then measures the round trip of tasks whose results are delivered to the main thread's
+ * Event Loop.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of tasks run for each measurement.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TASK_COUNT              200000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Amount of work done by each task, as a number of iterations of a pseudo-random generator.
+ * This is a few microseconds of work, so the cost of the pool shows.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TASK_ITERATIONS         2000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Range of tasks to run, split into nested sub-tasks until it is a single task.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t first;
+    size_t count;
+    uint32_t checksum;
+}
+Range_t;
+
+
+static le_workQueue_PoolRef_t PoolRef;
+static le_workQueue_TaskRef_t TaskRefs[TASK_COUNT];
+static le_clk_Time_t StartTime;
+static size_t HandledCount;
+static uint32_t HandledChecksum;
+static uint32_t ExpectedChecksum;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of operations per second since a start time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double GetOpsPerSec
+(
+    le_clk_Time_t start,
+    size_t opCount
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return opCount / ((double)elapsed.sec + (double)elapsed.usec / 1e6);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Do the work of one task.
+ *
+ * @return A checksum depending on the task's index.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t DoWork
+(
+    size_t index
+)
+{
+    uint32_t value = index;
+    int i;
+
+    for (i = 0; i < TASK_ITERATIONS; i++)
+    {
+        value = value * 1103515245 + 12345;
+    }
+
+    return value;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function of a single task.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* RunTask
+(
+    void* contextPtr
+)
+{
+    return (void*)(size_t)DoWork((size_t)contextPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function of a range of tasks.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* RunRange
+(
+    void* contextPtr
+)
+{
+    Range_t* rangePtr = contextPtr;
+
+    if (rangePtr->count == 1)
+    {
+        rangePtr->checksum = DoWork(rangePtr->first);
+        return NULL;
+    }
+
+    Range_t low = { rangePtr->first, rangePtr->count / 2, 0 };
+    Range_t high = { low.first + low.count, rangePtr->count - low.count, 0 };
+
+    le_workQueue_TaskRef_t highRef = le_workQueue_Submit(PoolRef, RunRange, &high, NULL);
+    RunRange(&low);
+    LE_ASSERT(le_workQueue_Wait(highRef, NULL) == LE_OK);
+
+    rangePtr->checksum = low.checksum ^ high.checksum;
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the checksum all the tasks must add up to.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GetExpectedChecksum
+(
+    void
+)
+{
+    uint32_t checksum = 0;
+    size_t i;
+
+    for (i = 0; i < TASK_COUNT; i++)
+    {
+        checksum ^= DoWork(i);
+    }
+
+    return checksum;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measure a number of workers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Measure
+(
+    size_t workerCount
+)
+{
+    le_workQueue_Stats_t stats;
+    uint32_t checksum = 0;
+    void* resultPtr;
+    size_t i;
+
+    PoolRef = le_workQueue_CreatePool("Bench", workerCount);
+
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    for (i = 0; i < TASK_COUNT; i++)
+    {
+        TaskRefs[i] = le_workQueue_Submit(PoolRef, RunTask, (void*)i, NULL);
+    }
+    for (i = 0; i < TASK_COUNT; i++)
+    {
+        LE_ASSERT(le_workQueue_Wait(TaskRefs[i], &resultPtr) == LE_OK);
+        checksum ^= (uint32_t)(size_t)resultPtr;
+    }
+    double submittedOps = GetOpsPerSec(start, TASK_COUNT);
+    LE_ASSERT(checksum == ExpectedChecksum);
+
+    le_workQueue_GetStats(PoolRef, &stats);
+    uint64_t submittedSteals = stats.stealCount;
+
+    Range_t range = { 0, TASK_COUNT, 0 };
+    start = le_clk_GetRelativeTime();
+    le_workQueue_TaskRef_t rootRef = le_workQueue_Submit(PoolRef, RunRange, &range, NULL);
+    LE_ASSERT(le_workQueue_Wait(rootRef, NULL) == LE_OK);
+    double nestedOps = GetOpsPerSec(start, TASK_COUNT);
+    LE_ASSERT(range.checksum == ExpectedChecksum);
+
+    le_workQueue_GetStats(PoolRef, &stats);
+    LE_ASSERT(stats.completeCount == stats.submitCount);
+
+    LE_INFO("%zu worker(s), in tasks per second: submitted %.0f (%" PRIu64 " stolen), "
+            "nested %.0f (%" PRIu64 " stolen)",
+            workerCount,
+            submittedOps, submittedSteals,
+            nestedOps, stats.stealCount - submittedSteals);
+
+    le_workQueue_DeletePool(PoolRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion handler of the tasks whose results go through the Event Loop.  Ends the benchmark
+ * when the last one is done.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompletionHandler
+(
+    le_workQueue_TaskRef_t taskRef,
+    le_result_t result,
+    void* resultPtr,
+    void* contextPtr
+)
+{
+    LE_ASSERT(result == LE_OK);
+
+    HandledChecksum ^= (uint32_t)(size_t)resultPtr;
+
+    if (++HandledCount < TASK_COUNT)
+    {
+        return;
+    }
+
+    LE_ASSERT(HandledChecksum == ExpectedChecksum);
+
+    LE_INFO("Results delivered to the Event Loop, in tasks per second: %.0f",
+            GetOpsPerSec(StartTime, TASK_COUNT));
+
+    le_workQueue_DeletePool(PoolRef);
+
+    LE_INFO("======== Work Queue benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== Work Queue benchmark ========");
+
+    long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t workerCount;
+
+    ExpectedChecksum = GetExpectedChecksum();
+
+    for (workerCount = 1; workerCount < (size_t)cpuCount; workerCount *= 2)
+    {
+        Measure(workerCount);
+    }
+    Measure(cpuCount > 0 ? cpuCount : 1);
+
+    // The completion handlers run on this thread once this function has returned.
+    PoolRef = le_workQueue_CreatePool("Bench", 0);
+    StartTime = le_clk_GetRelativeTime();
+
+    size_t i;
+    for (i = 0; i < TASK_COUNT; i++)
+    {
+        le_workQueue_Submit(PoolRef, RunTask, (void*)i, CompletionHandler);
+    }
+}
@@ -0,0 +1,277 @@
+/**
+ * Test of the Work Queue API.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of tasks submitted with a completion handler.
+ */
+//--------------------------------------------------------------------------------------------------
+#define HANDLED_TASK_COUNT      100
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ranges of at most this many numbers are summed up without splitting them.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LEAF_RANGE_SIZE         1000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Range of numbers to sum up.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t first;
+    uint64_t last;
+    uint64_t sum;
+}
+Range_t;
+
+
+static le_thread_Ref_t MainThreadRef;
+static le_workQueue_PoolRef_t PoolRef;
+static le_workQueue_PoolRef_t SinglePoolRef;
+static le_sem_Ref_t StartedSemRef;
+static int HandledCount;
+static int TerminatedCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function returning the square of its context.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* Square
+(
+    void* contextPtr
+)
+{
+    size_t value = (size_t)contextPtr;
+
+    return (void*)(value * value);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function summing up a range of numbers, by splitting it into two sub-tasks until it is
+ * small enough.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* Sum
+(
+    void* contextPtr
+)
+{
+    Range_t* rangePtr = contextPtr;
+
+    if (rangePtr->last - rangePtr->first < LEAF_RANGE_SIZE)
+    {
+        uint64_t i;
+
+        rangePtr->sum = 0;
+        for (i = rangePtr->first; i <= rangePtr->last; i++)
+        {
+            rangePtr->sum += i;
+        }
+        return NULL;
+    }
+
+    uint64_t middle = rangePtr->first + (rangePtr->last - rangePtr->first) / 2;
+    Range_t low = { rangePtr->first, middle, 0 };
+    Range_t high = { middle + 1, rangePtr->last, 0 };
+
+    le_workQueue_TaskRef_t lowRef = le_workQueue_Submit(PoolRef, Sum, &low, NULL);
+    le_workQueue_TaskRef_t highRef = le_workQueue_Submit(PoolRef, Sum, &high, NULL);
+
+    LE_ASSERT(le_workQueue_Wait(highRef, NULL) == LE_OK);
+    LE_ASSERT(le_workQueue_Wait(lowRef, NULL) == LE_OK);
+
+    rangePtr->sum = low.sum + high.sum;
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function that runs until it is cancelled.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* RunUntilCancelled
+(
+    void* contextPtr
+)
+{
+    le_sem_Post(StartedSemRef);
+
+    while (!le_workQueue_IsCancelRequested())
+    {
+        usleep(1000);
+    }
+
+    return contextPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Work function that keeps its worker busy for a while.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* Sleep100Ms
+(
+    void* contextPtr
+)
+{
+    le_sem_Post(StartedSemRef);
+
+    usleep(100000);
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion handler of Sleep100Ms() and of the tasks queued behind it when their pool is deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeletedPoolHandler
+(
+    le_workQueue_TaskRef_t taskRef,
+    le_result_t result,
+    void* resultPtr,
+    void* contextPtr
+)
+{
+    LE_ASSERT(le_thread_GetCurrent() == MainThreadRef);
+    LE_ASSERT(resultPtr == NULL);
+
+    if (contextPtr == Sleep100Ms)
+    {
+        LE_ASSERT(result == LE_OK);
+    }
+    else
+    {
+        LE_ASSERT(result == LE_TERMINATED);
+        TerminatedCount++;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion handler of the Square() tasks.  Finishes the test when the last one is done.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SquareHandler
+(
+    le_workQueue_TaskRef_t taskRef,
+    le_result_t result,
+    void* resultPtr,
+    void* contextPtr
+)
+{
+    size_t value = (size_t)contextPtr;
+
+    LE_ASSERT(le_thread_GetCurrent() == MainThreadRef);
+    LE_ASSERT(result == LE_OK);
+    LE_ASSERT((size_t)resultPtr == value * value);
+
+    if (++HandledCount < HANDLED_TASK_COUNT)
+    {
+        return;
+    }
+
+    LE_ASSERT(TerminatedCount == 3);
+
+    le_workQueue_Stats_t stats;
+    le_workQueue_GetStats(PoolRef, &stats);
+
+    LE_INFO("Pool stats: %" PRIu64 " submitted, %" PRIu64 " completed, %" PRIu64 " stolen.",
+            stats.submitCount, stats.completeCount, stats.stealCount);
+    LE_ASSERT(stats.submitCount == stats.completeCount);
+    LE_ASSERT(stats.cancelCount == 0);
+    LE_ASSERT((stats.queuedCount == 0) && (stats.runningCount == 0));
+
+    le_workQueue_DeletePool(PoolRef);
+
+    LE_INFO("======== WORK QUEUE TEST COMPLETE (PASSED) ========");
+    exit(EXIT_SUCCESS);
+}
+
+
+COMPONENT_INIT
+{
+    le_workQueue_Stats_t stats;
+    void* resultPtr;
+    size_t i;
+
+    LE_INFO("======== BEGIN WORK QUEUE TEST ========");
+
+    MainThreadRef = le_thread_GetCurrent();
+    StartedSemRef = le_sem_Create("Started", 0);
+    PoolRef = le_workQueue_CreatePool("Test", 4);
+
+    LE_INFO("Waiting for a task.");
+
+    le_workQueue_TaskRef_t taskRef = le_workQueue_Submit(PoolRef, Square, (void*)7, NULL);
+    LE_ASSERT(le_workQueue_Wait(taskRef, &resultPtr) == LE_OK);
+    LE_ASSERT((size_t)resultPtr == 49);
+
+    LE_INFO("Summing up numbers with nested tasks.");
+
+    Range_t range = { 1, 1000000, 0 };
+    taskRef = le_workQueue_Submit(PoolRef, Sum, &range, NULL);
+    LE_ASSERT(le_workQueue_Wait(taskRef, NULL) == LE_OK);
+    LE_ASSERT(range.sum == (uint64_t)1000000 * 1000001 / 2);
+
+    LE_INFO("Cancelling tasks.");
+
+    SinglePoolRef = le_workQueue_CreatePool("Single", 1);
+
+    le_workQueue_TaskRef_t runningRef =
+        le_workQueue_Submit(SinglePoolRef, RunUntilCancelled, (void*)1, NULL);
+    le_workQueue_TaskRef_t queuedRef = le_workQueue_Submit(SinglePoolRef, Square, (void*)2, NULL);
+    le_sem_Wait(StartedSemRef);
+
+    LE_ASSERT(le_workQueue_Cancel(queuedRef) == LE_OK);
+    LE_ASSERT(le_workQueue_Cancel(queuedRef) == LE_DUPLICATE);
+    LE_ASSERT(le_workQueue_Wait(queuedRef, &resultPtr) == LE_TERMINATED);
+    LE_ASSERT(resultPtr == NULL);
+
+    LE_ASSERT(le_workQueue_Cancel(runningRef) == LE_BUSY);
+    LE_ASSERT(le_workQueue_Wait(runningRef, &resultPtr) == LE_OK);
+    LE_ASSERT(resultPtr == (void*)1);
+
+    le_workQueue_GetStats(SinglePoolRef, &stats);
+    LE_ASSERT((stats.submitCount == 2) && (stats.completeCount == 1) && (stats.cancelCount == 1));
+    LE_ASSERT(stats.workerCount == 1);
+
+    LE_INFO("Deleting a pool with tasks queued.");
+
+    le_workQueue_Submit(SinglePoolRef, Sleep100Ms, Sleep100Ms, DeletedPoolHandler);
+    le_sem_Wait(StartedSemRef);
+    for (i = 0; i < 3; i++)
+    {
+        le_workQueue_Submit(SinglePoolRef, Square, (void*)i, DeletedPoolHandler);
+    }
+    le_workQueue_DeletePool(SinglePoolRef);
+
+    LE_INFO("Getting results through the Event Loop.");
+
+    for (i = 0; i < HANDLED_TASK_COUNT; i++)
+    {
+        le_workQueue_Submit(PoolRef, Square, (void*)i, SquareHandler);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * Benchmark of IPC calls from a C client, to compare with the Python client in PyBench.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of calls made to each function.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CALL_COUNT      10000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the number of seconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double SecondsSince
+(
+    le_clk_Time_t start
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    return (double)elapsed.sec + (double)elapsed.usec / 1e6;
+}
+
+
+COMPONENT_INIT
+{
+    LE_INFO("======== C IPC benchmark ========");
+
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    int i;
+
+    for (i = 0; i < CALL_COUNT; i++)
+    {
+        int32_t outValue;
+
+        ipcTest_EchoSimple(i, &outValue);
+        LE_ASSERT(outValue == i);
+    }
+
+    double time = SecondsSince(start);
+    LE_INFO("%d calls of EchoSimple: %.3f s, %.0f calls/s", CALL_COUNT, time, CALL_COUNT / time);
+
+    static const char inString[] = "Hello, world";
+    char outString[257];
+
+    start = le_clk_GetRelativeTime();
+
+    for (i = 0; i < CALL_COUNT; i++)
+    {
+        ipcTest_EchoString(inString, outString, sizeof(outString));
+        LE_ASSERT(strcmp(outString, inString) == 0);
+    }
+
+    time = SecondsSince(start);
+    LE_INFO("%d calls of EchoString: %.3f s, %.0f calls/s", CALL_COUNT, time, CALL_COUNT / time);
+
+    LE_INFO("======== C IPC benchmark PASSED ========");
+
+    exit(EXIT_SUCCESS);
+}
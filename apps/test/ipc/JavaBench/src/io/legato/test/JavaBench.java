@@ -0,0 +1,66 @@
+/*
+ * Benchmark of IPC calls from a Java client, to compare with the C client in CBench.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+package io.legato.test;
+
+import java.math.BigInteger;
+
+import io.legato.Component;
+import io.legato.Level;
+import io.legato.Ref;
+import io.legato.api.ipcTest;
+
+public class JavaBench extends Component {
+	/**
+	 * Number of calls made to each function.
+	 */
+	private static final int CALL_COUNT = 10000;
+
+	private void report(String name, long startTime) {
+		double time = (System.nanoTime() - startTime) / 1e9;
+
+		getLogger().log(Level.INFO, String.format("%d calls of %s: %.3f s, %.0f calls/s", CALL_COUNT, name,
+				time, CALL_COUNT / time));
+	}
+
+	@Override
+	public void componentInit() {
+		ipcTest ipc = getService(ipcTest.class);
+
+		getLogger().log(Level.INFO, "======== Java IPC benchmark ========");
+
+		Ref<BigInteger> outValue = new Ref<BigInteger>();
+		long startTime = System.nanoTime();
+
+		for (int i = 0; i < CALL_COUNT; i++) {
+			BigInteger inValue = BigInteger.valueOf(i);
+
+			ipc.EchoSimple(inValue, outValue);
+			if (!inValue.equals(outValue.getValue())) {
+				throw new IllegalStateException("EchoSimple returned " + outValue.getValue());
+			}
+		}
+
+		report("EchoSimple", startTime);
+
+		String inString = "Hello, world";
+		Ref<String> outString = new Ref<String>();
+		startTime = System.nanoTime();
+
+		for (int i = 0; i < CALL_COUNT; i++) {
+			ipc.EchoString(inString, outString);
+			if (!inString.equals(outString.getValue())) {
+				throw new IllegalStateException("EchoString returned " + outString.getValue());
+			}
+		}
+
+		report("EchoString", startTime);
+
+		getLogger().log(Level.INFO, "======== Java IPC benchmark PASSED ========");
+
+		System.exit(0);
+	}
+}
@@ -0,0 +1,42 @@
+#
+# Benchmark of IPC calls from a Python client, to compare with the C client in CBench.
+#
+# Copyright (C) Sierra Wireless Inc.
+#
+
+import sys
+import time
+
+import ipcTest
+from liblegato import LE_INFO
+
+# Number of calls made to each function.
+CALL_COUNT = 10000
+
+def report(name, start):
+    elapsed = time.time() - start
+    LE_INFO("%d calls of %s: %.3f s, %.0f calls/s" % (CALL_COUNT, name, elapsed,
+                                                        CALL_COUNT / elapsed))
+
+LE_INFO("======== Python IPC benchmark ========")
+
+start = time.time()
+for i in range(CALL_COUNT):
+    assert ipcTest.EchoSimple(i).OutValue == i
+report("EchoSimple", start)
+
+inString = "Hello, world"
+
+start = time.time()
+for i in range(CALL_COUNT):
+    assert ipcTest.EchoString(inString).OutString == inString
+report("EchoString", start)
+
+start = time.time()
+results = ipcTest.EchoStringBatch([(inString,)] * CALL_COUNT)
+report("EchoStringBatch", start)
+assert all(result.OutString == inString for result in results)
+
+LE_INFO("======== Python IPC benchmark PASSED ========")
+
+sys.exit(0)
@@ -11,6 +11,7 @@
 #include "pa_gnss_simu.h"
 #include "le_gnss_local.h"
 #include "le_log.h"
+#include "gnssSnapshot.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -34,6 +35,14 @@
 // Unknown category
 #define UNKNOWN                         0
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of iterations of the position snapshot benchmark
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+#define SNAPSHOT_BENCHMARK_LOOPS     10000
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the SUPL certificate id
@@ -591,6 +600,145 @@ static void Testle_gnss_GetLastSampleRef
     LE_ASSERT(mypositionSampleRef != NULL);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read one position sample field by field, as a client not using the snapshot API would do.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetPositionFieldByField
+(
+    le_gnss_SampleRef_t positionSampleRef
+)
+{
+    le_gnss_FixState_t state;
+    int32_t latitude, longitude, hAccuracy, altitude, vAccuracy, altitudeOnWgs84;
+    int32_t vSpeed, vSpeedAccuracy, magneticDeviation;
+    uint32_t hSpeed, hSpeedAccuracy, direction, directionAccuracy;
+    uint32_t gpsWeek, gpsTimeOfWeek, timeAccuracy;
+    uint16_t year, month, day, hours, minutes, seconds, milliseconds;
+    uint16_t hdop, vdop, pdop;
+    uint64_t epochTime;
+    uint8_t leapSeconds, satsInViewCount, satsTrackingCount, satsUsedCount;
+
+    le_gnss_GetPositionState(positionSampleRef, &state);
+    le_gnss_GetLocation(positionSampleRef, &latitude, &longitude, &hAccuracy);
+    le_gnss_GetAltitude(positionSampleRef, &altitude, &vAccuracy);
+    le_gnss_GetAltitudeOnWgs84(positionSampleRef, &altitudeOnWgs84);
+    le_gnss_GetDate(positionSampleRef, &year, &month, &day);
+    le_gnss_GetTime(positionSampleRef, &hours, &minutes, &seconds, &milliseconds);
+    le_gnss_GetEpochTime(positionSampleRef, &epochTime);
+    le_gnss_GetGpsTime(positionSampleRef, &gpsWeek, &gpsTimeOfWeek);
+    le_gnss_GetTimeAccuracy(positionSampleRef, &timeAccuracy);
+    le_gnss_GetGpsLeapSeconds(positionSampleRef, &leapSeconds);
+    le_gnss_GetHorizontalSpeed(positionSampleRef, &hSpeed, &hSpeedAccuracy);
+    le_gnss_GetVerticalSpeed(positionSampleRef, &vSpeed, &vSpeedAccuracy);
+    le_gnss_GetDirection(positionSampleRef, &direction, &directionAccuracy);
+    le_gnss_GetMagneticDeviation(positionSampleRef, &magneticDeviation);
+    le_gnss_GetDop(positionSampleRef, &hdop, &vdop, &pdop);
+    le_gnss_GetSatellitesStatus(positionSampleRef, &satsInViewCount, &satsTrackingCount,
+                                &satsUsedCount);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tested API: le_gnss_GetPositionSnapshot(), le_gnss_GetSampleRing()
+ *
+ * Check that the snapshot and the shared sample ring hold the same values as the getters, then
+ * compare the cost of reading a sample field by field, with one snapshot and from the ring.
+ *
+ * @note The position service is linked in this test, so the figures only account for the
+ *       service side processing: on target, each getter call also costs an IPC round trip, the
+ *       snapshot a single one and the ring none.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_gnss_PositionSnapshot
+(
+    void
+)
+{
+    uint8_t buffer[LE_GNSS_POSITION_SNAPSHOT_MAX_BYTES];
+    size_t bufferSize = sizeof(buffer);
+    le_gnssSnapshot_Sample_t snapshot;
+    le_gnssSnapshot_Sample_t ringSample;
+    le_gnssSnapshot_RingRef_t ringRef;
+    int32_t latitude, longitude, hAccuracy;
+    uint16_t year, month, day;
+    uint32_t seq = 0;
+    int ringFd = -1;
+    int i;
+
+    le_gnss_SampleRef_t positionSampleRef = le_gnss_GetLastSampleRef();
+    LE_ASSERT(NULL != positionSampleRef);
+
+    // Snapshot
+    LE_ASSERT_OK(le_gnss_GetPositionSnapshot(positionSampleRef, buffer, &bufferSize));
+    LE_ASSERT(sizeof(le_gnssSnapshot_Sample_t) == bufferSize);
+    LE_ASSERT_OK(le_gnssSnapshot_Decode(buffer, bufferSize, &snapshot));
+    LE_ASSERT(LE_FORMAT_ERROR == le_gnssSnapshot_Decode(buffer, bufferSize - 1, &snapshot));
+
+    bufferSize = sizeof(le_gnssSnapshot_Sample_t) - 1;
+    LE_ASSERT(LE_OVERFLOW == le_gnss_GetPositionSnapshot(positionSampleRef, buffer, &bufferSize));
+    bufferSize = sizeof(buffer);
+    LE_ASSERT(LE_FAULT == le_gnss_GetPositionSnapshot(GnssPositionSampleRef, buffer, &bufferSize));
+
+    LE_ASSERT_OK(le_gnss_GetLocation(positionSampleRef, &latitude, &longitude, &hAccuracy));
+    LE_ASSERT(snapshot.validMask & LE_GNSSSNAPSHOT_LATITUDE);
+    LE_ASSERT(snapshot.validMask & LE_GNSSSNAPSHOT_LONGITUDE);
+    LE_ASSERT(snapshot.validMask & LE_GNSSSNAPSHOT_H_ACCURACY);
+    LE_ASSERT(latitude == snapshot.latitude);
+    LE_ASSERT(longitude == snapshot.longitude);
+    LE_ASSERT(hAccuracy == snapshot.hAccuracy);
+    if (LE_OK == le_gnss_GetDate(positionSampleRef, &year, &month, &day))
+    {
+        LE_ASSERT(snapshot.validMask & LE_GNSSSNAPSHOT_DATE);
+        LE_ASSERT((year == snapshot.year) && (month == snapshot.month) && (day == snapshot.day));
+    }
+
+    // Shared sample ring: the sample reported by Testset_gnss_PositionData() must be the last one
+    LE_ASSERT_OK(le_gnss_GetSampleRing(&ringFd));
+    ringRef = le_gnssSnapshot_MapRing(ringFd);
+    LE_ASSERT(NULL != ringRef);
+    LE_ASSERT_OK(le_gnssSnapshot_ReadLast(ringRef, &ringSample, &seq));
+    LE_ASSERT(0 != seq);
+    LE_ASSERT(LE_NOT_FOUND == le_gnssSnapshot_ReadNext(ringRef, &ringSample, &seq));
+    LE_ASSERT(ringSample.validMask == snapshot.validMask);
+    LE_ASSERT(ringSample.latitude == snapshot.latitude);
+    LE_ASSERT(ringSample.longitude == snapshot.longitude);
+
+    // Benchmark
+    le_clk_Time_t start = le_clk_GetRelativeTime();
+    for (i = 0; i < SNAPSHOT_BENCHMARK_LOOPS; i++)
+    {
+        GetPositionFieldByField(positionSampleRef);
+    }
+    le_clk_Time_t getters = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < SNAPSHOT_BENCHMARK_LOOPS; i++)
+    {
+        bufferSize = sizeof(buffer);
+        le_gnss_GetPositionSnapshot(positionSampleRef, buffer, &bufferSize);
+        le_gnssSnapshot_Decode(buffer, bufferSize, &snapshot);
+    }
+    le_clk_Time_t snapshots = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    start = le_clk_GetRelativeTime();
+    for (i = 0; i < SNAPSHOT_BENCHMARK_LOOPS; i++)
+    {
+        le_gnssSnapshot_ReadLast(ringRef, &ringSample, NULL);
+    }
+    le_clk_Time_t ringReads = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    LE_INFO("%d samples: field by field %ld.%06lds (16 calls/sample), "
+            "snapshot %ld.%06lds (1 call/sample), ring %ld.%06lds (no call)",
+            SNAPSHOT_BENCHMARK_LOOPS,
+            getters.sec, getters.usec, snapshots.sec, snapshots.usec,
+            ringReads.sec, ringReads.usec);
+
+    le_gnssSnapshot_UnmapRing(ringRef);
+    le_gnss_ReleaseSampleRef(positionSampleRef);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Tested API: le_gnss_GetSbasConstellationCategory()
@@ -935,6 +1083,9 @@ COMPONENT_INIT
     LE_INFO("======== GNSS Device Get LastSample ref ========");
     Testle_gnss_GetLastSampleRef();
 
+    LE_INFO("======== GNSS Position Snapshot ========");
+    Testle_gnss_PositionSnapshot();
+
     LE_INFO("======== GNSS Device SuplCertificate ========");
     Testle_gnss_SuplCertificate();
 
@@ -0,0 +1,418 @@
+/**
+ * This module implements the unit tests for the movement filter.
+ *
+ * The movement filter results are compared with a reference implementation evaluating every
+ * handler one by one with the Haversine formula, as the positioning daemon used to do, on a random
+ * walk including long jumps, polar positions and invalid values. The time spent by both
+ * implementations for 1000 movement handlers is then reported.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "movementFilter.h"
+
+#include <math.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test parameters
+ */
+//--------------------------------------------------------------------------------------------------
+#define HANDLER_COUNT           1000
+#define FIX_COUNT               2000
+#define BENCHMARK_FIX_COUNT     1000
+/// Distance to the threshold below which the approximation may disagree with the reference, in
+/// meters.
+#define THRESHOLD_TOLERANCE_M   0.5
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference handler state.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t               horizontalMagnitude;
+    uint32_t               verticalMagnitude;
+    int32_t                lastLat;
+    int32_t                lastLong;
+    int32_t                lastAlt;
+    double                 distance;        ///< Last computed horizontal distance.
+    movementFilter_Entry_t entry;
+}
+Handler_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registered handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static Handler_t Handlers[HANDLER_COUNT];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference distance in meters between two fix points (Haversine formula).
+ */
+//--------------------------------------------------------------------------------------------------
+static double RefComputeDistance
+(
+    int32_t latitude1,
+    int32_t longitude1,
+    int32_t latitude2,
+    int32_t longitude2
+)
+{
+    double dLat = ((double)latitude2 - (double)latitude1) / 1000000.0 * M_PI / 180;
+    double dLon = ((double)longitude2 - (double)longitude1) / 1000000.0 * M_PI / 180;
+    double lat1 = ((double)latitude1) / 1000000.0 * M_PI / 180;
+    double lat2 = ((double)latitude2) / 1000000.0 * M_PI / 180;
+    double a, c;
+
+    a = sin(dLat/2) * sin(dLat/2) + sin(dLon/2) * sin(dLon/2) * cos(lat1) * cos(lat2);
+    c = 2 * atan2(sqrt(a), sqrt(1-a));
+
+    return 6371000.0 * c;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference check of the covered distance against the magnitude.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RefIsBeyondMagnitude
+(
+    uint32_t magnitude,
+    uint32_t move,
+    uint32_t accuracy
+)
+{
+    return ((move > magnitude) && (accuracy <= move) && ((move - accuracy) >= magnitude));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference evaluation of one handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static movementFilter_Result_t RefEvaluate
+(
+    Handler_t*                       handlerPtr,
+    const movementFilter_Position_t* posPtr
+)
+{
+    bool hflag = false;
+    bool vflag = false;
+
+    if (((handlerPtr->horizontalMagnitude != 0) && !posPtr->locationValid) ||
+        ((handlerPtr->verticalMagnitude != 0) && !posPtr->altitudeValid))
+    {
+        return MOVEMENTFILTER_INVALID;
+    }
+
+    if (0 == handlerPtr->lastLat)
+    {
+        handlerPtr->lastLat = posPtr->latitude;
+    }
+    if (0 == handlerPtr->lastLong)
+    {
+        handlerPtr->lastLong = posPtr->longitude;
+    }
+    if (0 == handlerPtr->lastAlt)
+    {
+        handlerPtr->lastAlt = posPtr->altitude;
+    }
+
+    handlerPtr->distance = RefComputeDistance(handlerPtr->lastLat, handlerPtr->lastLong,
+                                              posPtr->latitude, posPtr->longitude);
+    uint32_t verticalMove = abs(posPtr->altitude - handlerPtr->lastAlt);
+
+    if (INT32_MAX != posPtr->vAccuracy)
+    {
+        vflag = RefIsBeyondMagnitude(handlerPtr->verticalMagnitude, verticalMove,
+                                     posPtr->vAccuracy/10);
+    }
+    if (INT32_MAX != posPtr->hAccuracy)
+    {
+        hflag = RefIsBeyondMagnitude(handlerPtr->horizontalMagnitude,
+                                     (uint32_t)handlerPtr->distance,
+                                     posPtr->hAccuracy/100);
+    }
+
+    if (((0 != handlerPtr->verticalMagnitude) && vflag) ||
+        ((0 != handlerPtr->horizontalMagnitude) && hflag) ||
+        ((0 == handlerPtr->verticalMagnitude) && (0 == handlerPtr->horizontalMagnitude)))
+    {
+        return MOVEMENTFILTER_MOVED;
+    }
+
+    return MOVEMENTFILTER_NOT_MOVED;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a disagreement with the reference is due to the approximation: the horizontal
+ * distance must then be close to the horizontal threshold.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsNearThreshold
+(
+    const Handler_t*                 handlerPtr,
+    const movementFilter_Position_t* posPtr
+)
+{
+    double accuracy = posPtr->hAccuracy/100;
+    double threshold = handlerPtr->horizontalMagnitude + ((accuracy < 1) ? 1 : accuracy);
+
+    return (fabs(handlerPtr->distance - threshold) < THRESHOLD_TOLERANCE_M);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the next position of the random walk.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NextPosition
+(
+    movementFilter_Position_t* posPtr
+)
+{
+    int draw = rand() % 100;
+
+    if (draw < 2)
+    {
+        // Long jump, beyond the domain of the approximation.
+        posPtr->latitude += (rand() % 2000000) - 1000000;
+        posPtr->longitude += (rand() % 2000000) - 1000000;
+    }
+    else
+    {
+        // Up to about 2 km.
+        posPtr->latitude += (rand() % 40000) - 20000;
+        posPtr->longitude += (rand() % 40000) - 20000;
+    }
+    posPtr->altitude += (rand() % 200000) - 100000;
+
+    // Stay on the globe.
+    if (posPtr->longitude > 180000000)
+    {
+        posPtr->longitude -= 360000000;
+    }
+    else if (posPtr->longitude < -180000000)
+    {
+        posPtr->longitude += 360000000;
+    }
+    if (abs(posPtr->latitude) > 89900000)
+    {
+        posPtr->latitude = (posPtr->latitude > 0) ? 89900000 : -89900000;
+    }
+
+    posPtr->hAccuracy = (draw == 2) ? INT32_MAX : (rand() % 5000);
+    posPtr->vAccuracy = (draw == 3) ? INT32_MAX : (rand() % 500);
+    posPtr->locationValid = (draw != 4);
+    posPtr->altitudeValid = (draw != 5);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register the handlers, with all the combinations of magnitudes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddHandlers
+(
+    void
+)
+{
+    int i;
+
+    for (i = 0; i < HANDLER_COUNT; i++)
+    {
+        Handler_t* handlerPtr = &Handlers[i];
+
+        memset(handlerPtr, 0, sizeof(Handler_t));
+        handlerPtr->horizontalMagnitude = (i % 4 < 2) ? (rand() % 3000) : 0;
+        handlerPtr->verticalMagnitude = (i % 2) ? (rand() % 300000) : 0;
+        movementFilter_Add(&handlerPtr->entry,
+                           handlerPtr->horizontalMagnitude,
+                           handlerPtr->verticalMagnitude);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveHandlers
+(
+    void
+)
+{
+    int i;
+
+    for (i = 0; i < HANDLER_COUNT; i++)
+    {
+        movementFilter_Remove(&Handlers[i].entry);
+        LE_ASSERT(NULL == Handlers[i].entry.blockPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: compare the movement filter with the reference on a random walk starting at a given
+ * position.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestRandomWalk
+(
+    int32_t latitude,
+    int32_t longitude
+)
+{
+    movementFilter_Position_t pos = { latitude, longitude, 100000, 50, 500, true, true };
+    int moved = 0;
+    int approximated = 0;
+    int fix, i;
+
+    AddHandlers();
+
+    for (fix = 0; fix < FIX_COUNT; fix++)
+    {
+        movementFilter_Evaluate(&pos);
+
+        for (i = 0; i < HANDLER_COUNT; i++)
+        {
+            Handler_t* handlerPtr = &Handlers[i];
+            movementFilter_Result_t refResult = RefEvaluate(handlerPtr, &pos);
+            movementFilter_Result_t result = movementFilter_GetResult(&handlerPtr->entry);
+
+            if (result != refResult)
+            {
+                LE_ASSERT(MOVEMENTFILTER_INVALID != result);
+                LE_ASSERT(MOVEMENTFILTER_INVALID != refResult);
+                LE_ASSERT(IsNearThreshold(handlerPtr, &pos));
+                approximated++;
+            }
+
+            // Follow the reference, so that both implementations keep the same last positions.
+            if (MOVEMENTFILTER_MOVED == refResult)
+            {
+                handlerPtr->lastLat = pos.latitude;
+                handlerPtr->lastLong = pos.longitude;
+                handlerPtr->lastAlt = pos.altitude;
+                movementFilter_SetLastPosition(&handlerPtr->entry, &pos);
+                moved++;
+            }
+        }
+
+        NextPosition(&pos);
+    }
+
+    LE_INFO("Walk from [%d,%d]: %d notifications, %d results at the approximation limit",
+            latitude, longitude, moved, approximated);
+    LE_ASSERT(moved > 0);
+    LE_ASSERT(approximated < (moved / 1000) + 1);
+
+    RemoveHandlers();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark: evaluate 1000 movement handlers per fix, with the reference and with the movement
+ * filter, updating the last position of the notified handlers as the positioning daemon does.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Benchmark
+(
+    void
+)
+{
+    movementFilter_Position_t pos = { 48856600, 2352200, 100000, 50, 500, true, true };
+    movementFilter_Position_t positions[BENCHMARK_FIX_COUNT];
+    le_clk_Time_t start, refDuration, filterDuration;
+    uint32_t refMoved = 0;
+    uint32_t filterMoved = 0;
+    int fix, i;
+
+    for (fix = 0; fix < BENCHMARK_FIX_COUNT; fix++)
+    {
+        positions[fix] = pos;
+        positions[fix].locationValid = true;
+        positions[fix].altitudeValid = true;
+        NextPosition(&pos);
+    }
+
+    AddHandlers();
+
+    start = le_clk_GetRelativeTime();
+    for (fix = 0; fix < BENCHMARK_FIX_COUNT; fix++)
+    {
+        for (i = 0; i < HANDLER_COUNT; i++)
+        {
+            if (MOVEMENTFILTER_MOVED == RefEvaluate(&Handlers[i], &positions[fix]))
+            {
+                Handlers[i].lastLat = positions[fix].latitude;
+                Handlers[i].lastLong = positions[fix].longitude;
+                Handlers[i].lastAlt = positions[fix].altitude;
+                refMoved++;
+            }
+        }
+    }
+    refDuration = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    start = le_clk_GetRelativeTime();
+    for (fix = 0; fix < BENCHMARK_FIX_COUNT; fix++)
+    {
+        movementFilter_Evaluate(&positions[fix]);
+        for (i = 0; i < HANDLER_COUNT; i++)
+        {
+            if (MOVEMENTFILTER_MOVED == movementFilter_GetResult(&Handlers[i].entry))
+            {
+                movementFilter_SetLastPosition(&Handlers[i].entry, &positions[fix]);
+                filterMoved++;
+            }
+        }
+    }
+    filterDuration = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+    LE_INFO("%d handlers x %d fixes: reference %ld.%06lds (%"PRIu32" notifications), "
+            "movement filter %ld.%06lds (%"PRIu32" notifications)",
+            HANDLER_COUNT, BENCHMARK_FIX_COUNT,
+            refDuration.sec, refDuration.usec, refMoved,
+            filterDuration.sec, filterDuration.usec, filterMoved);
+
+    RemoveHandlers();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the test
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    LE_INFO("======== Start movement filter UnitTest ========");
+
+    movementFilter_Init();
+    srand(1);
+
+    LE_INFO("======== Mid latitude ========");
+    TestRandomWalk(48856600, 2352200);
+
+    LE_INFO("======== Southern and western hemispheres ========");
+    TestRandomWalk(-33868800, -70669300);
+
+    LE_INFO("======== Antimeridian ========");
+    TestRandomWalk(-17713400, 179900000);
+
+    LE_INFO("======== Polar region ========");
+    TestRandomWalk(80500000, 15000000);
+
+    LE_INFO("======== Benchmark ========");
+    Benchmark();
+
+    LE_INFO("======== movement filter UnitTest PASSED ========");
+    exit(EXIT_SUCCESS);
+}
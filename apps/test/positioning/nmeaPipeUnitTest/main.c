@@ -0,0 +1,297 @@
+/**
+ * This module implements the unit tests for the NMEA pipe writer.
+ *
+ * A deliberately slow reader drains the NMEA pipe while epochs of sentences are queued at a much
+ * higher rate. The test checks that:
+ * - queuing never blocks the event loop,
+ * - the sentences of an epoch are coalesced in a few write system calls,
+ * - the oldest sentences are dropped under backpressure and accounted for,
+ * - the reader only gets whole sentences, in order.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "nmeaPipe.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test parameters
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_PIPE_PATH              "/tmp/nmeaPipeUnitTest"
+#define SENTENCES_PER_EPOCH         10
+#define EPOCH_PERIOD_MS             5
+#define EPOCH_COUNT                 400
+#define SLOW_READ_BYTES             16
+#define SLOW_READ_PERIOD_US         20000
+/// Longest acceptable time spent in the NMEA pipe writer, in microseconds.
+#define MAX_CALL_DURATION_US        5000
+/// Size of the test sentences, including the null character.
+#define SENTENCE_MAX_BYTES          32
+/// Capacity of the pipe, reduced so that the slow reader quickly applies backpressure.
+#define PIPE_CAPACITY_BYTES         4096
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of epochs and sentences generated so far.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t EpochCount = 0;
+static uint32_t SentenceCount = 0;
+static uint64_t SentenceBytes = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Longest time spent in the NMEA pipe writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_clk_Time_t MaxCallDuration = { 0, 0 };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reader state, shared with the reader thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static volatile bool ReaderIsSlow = true;
+static volatile bool ReaderStop = false;
+static volatile uint32_t ReceivedSentences = 0;
+static le_sem_Ref_t ReaderSem;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timers
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t EpochTimerRef;
+static le_timer_Ref_t DrainTimerRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reader thread: reads the pipe slowly until asked to speed up, and checks that it only gets
+ * whole sentences, in order.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ReaderThread
+(
+    void* contextPtr
+)
+{
+    char sentence[SENTENCE_MAX_BYTES];
+    size_t sentenceLen = 0;
+    int32_t lastIndex = -1;
+    char buffer[1024];
+    int fd;
+
+    // Stay non-blocking, so that the thread can be stopped while the writer keeps the pipe open.
+    fd = open(NMEA_PIPE_PATH, O_RDONLY|O_NONBLOCK);
+    LE_ASSERT(-1 != fd);
+    LE_ASSERT(-1 != fcntl(fd, F_SETPIPE_SZ, PIPE_CAPACITY_BYTES));
+    le_sem_Post(ReaderSem);
+
+    while (!ReaderStop)
+    {
+        ssize_t len = read(fd, buffer, ReaderIsSlow ? SLOW_READ_BYTES : sizeof(buffer));
+        ssize_t i;
+
+        if (len <= 0)
+        {
+            // No writer or nothing to read right now.
+            usleep(1000);
+            continue;
+        }
+
+        for (i = 0; i < len; i++)
+        {
+            LE_ASSERT(sentenceLen < sizeof(sentence));
+            sentence[sentenceLen++] = buffer[i];
+
+            if ('\0' == buffer[i])
+            {
+                int32_t index;
+
+                LE_ASSERT(1 == sscanf(sentence, "$GPTST,%"SCNd32"*00", &index));
+                LE_ASSERT(index > lastIndex);
+                lastIndex = index;
+                ReceivedSentences++;
+                sentenceLen = 0;
+            }
+        }
+
+        if (ReaderIsSlow)
+        {
+            usleep(SLOW_READ_PERIOD_US);
+        }
+    }
+
+    // No partial sentence must be left.
+    LE_ASSERT(0 == sentenceLen);
+    close(fd);
+    le_sem_Post(ReaderSem);
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue one epoch of sentences, keeping track of the time spent in the writer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueueEpoch
+(
+    void
+)
+{
+    char sentence[SENTENCE_MAX_BYTES];
+    int i;
+
+    for (i = 0; i < SENTENCES_PER_EPOCH; i++)
+    {
+        snprintf(sentence, sizeof(sentence), "$GPTST,%06"PRIu32"*00", SentenceCount++);
+        SentenceBytes += strlen(sentence) + 1;
+
+        le_clk_Time_t start = le_clk_GetRelativeTime();
+        nmeaPipe_Write(sentence);
+        le_clk_Time_t duration = le_clk_Sub(le_clk_GetRelativeTime(), start);
+
+        if (le_clk_GreaterThan(duration, MaxCallDuration))
+        {
+            MaxCallDuration = duration;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the statistics once all the sentences have been either written or dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DrainTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    nmeaPipe_Stats_t stats;
+
+    nmeaPipe_GetStats(&stats);
+    if ((stats.writtenBytes + stats.droppedBytes) < SentenceBytes)
+    {
+        // Still draining.
+        return;
+    }
+    le_timer_Stop(timerRef);
+
+    // Let the reader get the last bytes, then stop it.
+    sleep(1);
+    ReaderStop = true;
+    LE_ASSERT_OK(le_sem_WaitWithTimeOut(ReaderSem, (le_clk_Time_t){ 5, 0 }));
+
+    LE_INFO("%"PRIu32" sentences: %"PRIu64" queued, %"PRIu64" writes, %"PRIu64" bytes written, "
+            "%"PRIu64" sentences (%"PRIu64" bytes) dropped, %"PRIu32" received",
+            SentenceCount, stats.sentences, stats.writes, stats.writtenBytes,
+            stats.droppedSentences, stats.droppedBytes, ReceivedSentences);
+    LE_INFO("Longest call: %ld.%06lds", MaxCallDuration.sec, MaxCallDuration.usec);
+
+    // Never blocked.
+    LE_ASSERT(0 == MaxCallDuration.sec);
+    LE_ASSERT(MaxCallDuration.usec < MAX_CALL_DURATION_US);
+
+    // Backpressure dropped sentences, and everything is accounted for.
+    LE_ASSERT(stats.droppedSentences > 0);
+    LE_ASSERT(stats.writtenBytes + stats.droppedBytes == SentenceBytes);
+    LE_ASSERT(ReceivedSentences + stats.droppedSentences == SentenceCount);
+
+    // Sentences were coalesced.
+    LE_ASSERT(stats.writes < (SentenceCount / 2));
+
+    LE_INFO("======== NMEA pipe UnitTest PASSED ========");
+    exit(EXIT_SUCCESS);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate the epochs, then let the reader drain the pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EpochTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    QueueEpoch();
+
+    if (++EpochCount == EPOCH_COUNT)
+    {
+        le_timer_Stop(timerRef);
+
+        ReaderIsSlow = false;
+        nmeaPipe_Flush();
+        le_timer_Start(DrainTimerRef);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: no reader. Sentences are dropped without blocking.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestNoReader
+(
+    void
+)
+{
+    nmeaPipe_Stats_t stats;
+
+    QueueEpoch();
+    nmeaPipe_Flush();
+
+    nmeaPipe_GetStats(&stats);
+    LE_ASSERT(SENTENCES_PER_EPOCH == stats.sentences);
+    LE_ASSERT(SENTENCES_PER_EPOCH == stats.droppedSentences);
+    LE_ASSERT(0 == stats.writtenBytes);
+
+    // Start over for the slow reader test.
+    nmeaPipe_Init(NMEA_PIPE_PATH);
+    SentenceCount = 0;
+    SentenceBytes = 0;
+    MaxCallDuration = (le_clk_Time_t){ 0, 0 };
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the test
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    LE_INFO("======== Start NMEA pipe UnitTest ========");
+
+    // Writes to a pipe whose reader went away must fail instead of killing the process.
+    signal(SIGPIPE, SIG_IGN);
+
+    unlink(NMEA_PIPE_PATH);
+    nmeaPipe_Init(NMEA_PIPE_PATH);
+    nmeaPipe_Create();
+
+    LE_INFO("======== No reader ========");
+    TestNoReader();
+
+    LE_INFO("======== Slow reader ========");
+    ReaderSem = le_sem_Create("ReaderSem", 0);
+    le_thread_Start(le_thread_Create("SlowReader", ReaderThread, NULL));
+    LE_ASSERT_OK(le_sem_WaitWithTimeOut(ReaderSem, (le_clk_Time_t){ 5, 0 }));
+
+    EpochTimerRef = le_timer_Create("Epoch");
+    le_timer_SetMsInterval(EpochTimerRef, EPOCH_PERIOD_MS);
+    le_timer_SetRepeat(EpochTimerRef, 0);
+    le_timer_SetHandler(EpochTimerRef, EpochTimerHandler);
+
+    DrainTimerRef = le_timer_Create("Drain");
+    le_timer_SetMsInterval(DrainTimerRef, 100);
+    le_timer_SetRepeat(DrainTimerRef, 0);
+    le_timer_SetHandler(DrainTimerRef, DrainTimerHandler);
+
+    le_timer_Start(EpochTimerRef);
+}
@@ -0,0 +1,166 @@
+/**
+ * This module implements the unit tests of the power manager wakeup sources.
+ *
+ * The power manager writes to files of a fake sysfs directory instead of /sys/power, and the number
+ * of kernel accesses is compared between the per-source and the aggregated modes.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "pm.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of acquire/release pairs measured
+ */
+//--------------------------------------------------------------------------------------------------
+#define PAIRS_COUNT         10000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release hysteresis used in the aggregated mode, in milliseconds
+ */
+//--------------------------------------------------------------------------------------------------
+#define HYSTERESIS_MS       100
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fake client sessions
+ */
+//--------------------------------------------------------------------------------------------------
+#define CLIENT_SESSION      ((le_msg_SessionRef_t)0x1001)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wakeup sources used by the test
+ */
+//--------------------------------------------------------------------------------------------------
+static le_pm_WakeupSourceRef_t WakeupSourceA;
+static le_pm_WakeupSourceRef_t WakeupSourceB;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kernel accesses before the hysteresis expires
+ */
+//--------------------------------------------------------------------------------------------------
+static pm_Stats_t StatsBeforeRelax;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Acquire and release a wakeup source, and return the number of kernel accesses
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t MeasurePairs
+(
+    const char* modePtr,
+    le_pm_WakeupSourceRef_t wsRef
+)
+{
+    pm_Stats_t before, after;
+    int i;
+
+    pm_GetStats(&before);
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < PAIRS_COUNT; i++)
+    {
+        LE_ASSERT_OK(le_pm_StayAwake(wsRef));
+        LE_ASSERT_OK(le_pm_Relax(wsRef));
+    }
+
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+    pm_GetStats(&after);
+
+    uint32_t accesses = (after.lockCount - before.lockCount) +
+                        (after.unlockCount - before.unlockCount);
+
+    LE_INFO("%s: %d acquire/release pairs, %" PRIu32 " kernel accesses, %ld.%06ld s",
+            modePtr, PAIRS_COUNT, accesses, elapsed.sec, elapsed.usec);
+
+    return accesses;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that the aggregated wakeup source was released once the hysteresis expired, and end the test
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckRelaxed
+(
+    le_timer_Ref_t timerRef
+)
+{
+    pm_Stats_t stats;
+
+    pm_GetStats(&stats);
+    LE_ASSERT(stats.lockCount == StatsBeforeRelax.lockCount);
+    LE_ASSERT(stats.unlockCount == (StatsBeforeRelax.unlockCount + 1));
+
+    // Disconnecting the client releases its wakeup sources
+    LE_ASSERT_OK(le_pm_StayAwake(WakeupSourceA));
+    LE_ASSERT(pm_CheckWakeLock());
+    pmStub_Disconnect(CLIENT_SESSION);
+    LE_ASSERT(!pm_CheckWakeLock());
+
+    LE_INFO("======== powerMgrUnitTest PASSED ========");
+    exit(EXIT_SUCCESS);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * main of the test
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    pm_Stats_t stats;
+
+    LE_INFO("======== powerMgrUnitTest BEGIN ========");
+
+    pmStub_Connect(CLIENT_SESSION);
+    WakeupSourceA = le_pm_NewWakeupSource(0, "testA");
+    LE_ASSERT(WakeupSourceA != NULL);
+    WakeupSourceB = le_pm_NewWakeupSource(LE_PM_REF_COUNT, "testB");
+    LE_ASSERT(WakeupSourceB != NULL);
+
+    // Per-source mode: each pair writes to both wake_lock and wake_unlock
+    LE_ASSERT_OK(pm_SetAggregation(false, 0));
+    LE_ASSERT(MeasurePairs("Per-source", WakeupSourceA) == (2 * PAIRS_COUNT));
+    LE_ASSERT(!pm_CheckWakeLock());
+
+    // Aggregated mode without hysteresis: the kernel wakeup source follows the clients
+    LE_ASSERT_OK(pm_SetAggregation(true, 0));
+    LE_ASSERT(MeasurePairs("Aggregated, no hysteresis", WakeupSourceA) == (2 * PAIRS_COUNT));
+
+    // Aggregated mode with hysteresis: the kernel wakeup source is acquired once and held
+    LE_ASSERT_OK(pm_SetAggregation(true, HYSTERESIS_MS));
+    LE_ASSERT(MeasurePairs("Aggregated", WakeupSourceA) == 1);
+    LE_ASSERT(!pm_CheckWakeLock());
+
+    // The mode cannot change while a wakeup source is held
+    LE_ASSERT_OK(le_pm_StayAwake(WakeupSourceA));
+    LE_ASSERT(pm_SetAggregation(false, 0) == LE_BUSY);
+
+    // Overlapping and reference counted wakeup sources share the kernel wakeup source
+    pm_GetStats(&StatsBeforeRelax);
+    LE_ASSERT_OK(le_pm_StayAwake(WakeupSourceB));
+    LE_ASSERT_OK(le_pm_StayAwake(WakeupSourceB));
+    LE_ASSERT_OK(le_pm_Relax(WakeupSourceA));
+    LE_ASSERT_OK(le_pm_Relax(WakeupSourceB));
+    LE_ASSERT(pm_CheckWakeLock());
+    LE_ASSERT_OK(le_pm_Relax(WakeupSourceB));
+    LE_ASSERT(!pm_CheckWakeLock());
+
+    pm_GetStats(&stats);
+    LE_ASSERT(stats.lockCount == StatsBeforeRelax.lockCount);
+    LE_ASSERT(stats.unlockCount == StatsBeforeRelax.unlockCount);
+
+    // Let the hysteresis expire
+    le_timer_Ref_t timerRef = le_timer_Create("CheckRelaxed");
+    LE_ASSERT_OK(le_timer_SetMsInterval(timerRef, 3 * HYSTERESIS_MS));
+    LE_ASSERT_OK(le_timer_SetHandler(timerRef, CheckRelaxed));
+    LE_ASSERT_OK(le_timer_Start(timerRef));
+}
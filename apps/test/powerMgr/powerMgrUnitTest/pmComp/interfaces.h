@@ -0,0 +1,54 @@
+#include "le_pm_interface.h"
+
+#undef LE_KILL_CLIENT
+#define LE_KILL_CLIENT LE_FATAL
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the server service reference
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t le_pm_GetServiceRef
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the client session reference for the current message
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t le_pm_GetClientSessionRef
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the connection of a client: the session becomes the current client session
+ */
+//--------------------------------------------------------------------------------------------------
+void pmStub_Connect
+(
+    le_msg_SessionRef_t sessionRef
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the disconnection of a client
+ */
+//--------------------------------------------------------------------------------------------------
+void pmStub_Disconnect
+(
+    le_msg_SessionRef_t sessionRef
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the current client session
+ */
+//--------------------------------------------------------------------------------------------------
+void pmStub_SetSession
+(
+    le_msg_SessionRef_t sessionRef
+);
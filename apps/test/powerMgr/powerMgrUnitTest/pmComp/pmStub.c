@@ -0,0 +1,171 @@
+/**
+ * This module implements some stubs for the power manager unit test.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Session of the current client
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_SessionRef_t CurrentSession = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client connection handler registered by the power manager
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_SessionEventHandler_t OpenHandler = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Client disconnection handler registered by the power manager
+ */
+//--------------------------------------------------------------------------------------------------
+static le_msg_SessionEventHandler_t CloseHandler = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the server service reference stub
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_ServiceRef_t le_pm_GetServiceRef
+(
+    void
+)
+{
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the client session reference stub
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionRef_t le_pm_GetClientSessionRef
+(
+    void
+)
+{
+    return CurrentSession;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add service open handler stub
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionEventHandlerRef_t MsgAddServiceOpenHandler
+(
+    le_msg_ServiceRef_t serviceRef,
+    le_msg_SessionEventHandler_t handlerFunc,
+    void *contextPtr
+)
+{
+    OpenHandler = handlerFunc;
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add service close handler stub
+ */
+//--------------------------------------------------------------------------------------------------
+le_msg_SessionEventHandlerRef_t MsgAddServiceCloseHandler
+(
+    le_msg_ServiceRef_t serviceRef,
+    le_msg_SessionEventHandler_t handlerFunc,
+    void *contextPtr
+)
+{
+    CloseHandler = handlerFunc;
+    return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the client process id stub: all the clients are the test process
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t MsgGetClientProcessId
+(
+    le_msg_SessionRef_t sessionRef,
+    pid_t*              processIdPtr
+)
+{
+    *processIdPtr = getpid();
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the connection of a client: the session becomes the current client session
+ */
+//--------------------------------------------------------------------------------------------------
+void pmStub_Connect
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    LE_ASSERT(OpenHandler != NULL);
+    CurrentSession = sessionRef;
+    OpenHandler(sessionRef, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the disconnection of a client
+ */
+//--------------------------------------------------------------------------------------------------
+void pmStub_Disconnect
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    LE_ASSERT(CloseHandler != NULL);
+    CloseHandler(sessionRef, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the current client session
+ */
+//--------------------------------------------------------------------------------------------------
+void pmStub_SetSession
+(
+    le_msg_SessionRef_t sessionRef
+)
+{
+    CurrentSession = sessionRef;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start watchdogs 0..N-1.  Typically this is used in COMPONENT_INIT to start all watchdogs needed
+ * by the process.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_wdogChain_Init
+(
+    uint32_t wdogCount
+)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Begin monitoring the event loop on the current thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_wdogChain_MonitorEventLoop
+(
+    uint32_t watchdog,          ///< Watchdog to use for monitoring
+    le_clk_Time_t watchdogInterval ///< Interval at which to check event loop is functioning
+)
+{
+}
@@ -28,7 +28,7 @@
 #ifdef LEGATO_FEATURE_TIMESERIES
 
 #include "tinycbor/cbor.h"
-#include "zlib.h"
+#include "timeSeries.h"
 
 #endif
 
@@ -60,10 +60,28 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Maximum number of bytes for CBOR encoded time series data
+ * CBOR break byte, closing an indefinite length container.
  */
 //--------------------------------------------------------------------------------------------------
-#define MAX_CBOR_BUFFER_NUMBYTES 1024
+#define CBOR_BREAK_BYTE 0xFF
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes for a LWM2M Object Instance TLV, including the header of up to 6 bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define INSTANCE_TLV_MAX_NUMBYTES 256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Expected number of instances, and of fields, in all assets. These only size the index maps,
+ * which accept more entries at the cost of longer bucket chains.
+ */
+//--------------------------------------------------------------------------------------------------
+#define INSTANCE_MAP_CAPACITY 127
+#define FIELD_MAP_CAPACITY 1021
 
 
 //--------------------------------------------------------------------------------------------------
@@ -138,6 +156,32 @@ typedef struct assetData_AssetData
 AssetData_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key of an instance in InstanceMap, or of a field in FieldMap
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const void* parentPtr;      ///< Asset containing the instance, or instance containing the field
+    int id;                     ///< Instance id or field id
+}
+IdKey_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key of a field in FieldNameMap
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const void* parentPtr;      ///< Instance containing the field
+    const char* namePtr;        ///< Field name
+}
+NameKey_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Data contained in a single asset instance
@@ -149,6 +193,11 @@ typedef struct le_avdata_AssetInstance
     AssetData_t* assetDataPtr;   ///< Back reference to asset data containing this instance
     le_dls_List_t fieldList;     ///< List of fields for this instance
     le_dls_Link_t link;          ///< For adding to the asset instance list
+    IdKey_t key;                 ///< Key in InstanceMap, once the instance is indexed
+    uint8_t* tlvCachePtr;        ///< Object Instance TLV with all readable fields, or NULL
+    size_t tlvCacheNumBytes;     ///< # bytes in tlvCachePtr
+    size_t tlvHeaderNumBytes;    ///< # bytes of the Object Instance TLV header in tlvCachePtr
+    bool isTlvCacheValid;        ///< Does tlvCachePtr match the current field values?
 }
 InstanceData_t;
 
@@ -158,12 +207,11 @@ InstanceData_t;
  * Data contained in time series
  */
 //--------------------------------------------------------------------------------------------------
-typedef struct
+#ifdef LEGATO_FEATURE_TIMESERIES
+typedef struct TimeSeriesData
 {
-    uint8_t* bufferPtr;             ///< Buffer for accumulating history data.
-    size_t bufferSize;              ///< Buffer size of history data.
+    timeSeries_Stream_t stream;     ///< Compressed stream accumulating history data.
 
-#ifdef LEGATO_FEATURE_TIMESERIES
     double timeStampFactor;         ///< Factor of time stamp.
     uint64_t prevTimeStamp;         ///< Time stamp of last data capture, used for delta encoding.
 
@@ -175,13 +223,11 @@ typedef struct
     };
 
     uint32_t numElements;           ///< Number of elements in cbor encoded stream.
-
-    CborEncoder streamRef;          ///< CBOR encoded stream reference.
-    CborEncoder mapRef;             ///< CBOR encoded map reference.
-    CborEncoder sampleRef;          ///< CBOR encoded sample data reference.
-#endif
 }
 TimeSeriesData_t;
+#else
+typedef struct TimeSeriesData TimeSeriesData_t;
+#endif
 
 
 
@@ -211,6 +257,8 @@ typedef struct
     TimeSeriesData_t* timeSeriesPtr;
 
     le_dls_Link_t link;          ///< For adding to the field list
+    IdKey_t key;                 ///< Key in FieldMap, once the instance is indexed
+    NameKey_t nameKey;           ///< Key in FieldNameMap, once the instance is indexed
 }
 FieldData_t;
 
@@ -325,26 +373,50 @@ static le_hashmap_Ref_t AssetMapByName = NULL;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Used to delay reporting REG_UPDATE, so that we don't generate too much message traffic.
+ * Maps (asset, instanceId) to an instance.  Initialized in assetData_Init().
  */
 //--------------------------------------------------------------------------------------------------
-static le_timer_Ref_t RegUpdateTimerRef;
+static le_hashmap_Ref_t InstanceMap = NULL;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Time series data memory pool.  Initialized in assetData_Init().
+ * Maps (instance, fieldId) to a field.  Initialized in assetData_Init().
  */
 //--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t TimeSeriesDataPoolRef = NULL;
+static le_hashmap_Ref_t FieldMap = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maps (instance, field name) to a field.  Initialized in assetData_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t FieldNameMap = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This pool is used for the cached Object Instance TLVs.  Initialized in assetData_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t TlvCachePoolRef = NULL;
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * CBOR buffer memory pool.  Initialized in assetData_Init().
+ * Used to delay reporting REG_UPDATE, so that we don't generate too much message traffic.
  */
 //--------------------------------------------------------------------------------------------------
-static le_mem_PoolRef_t CborBufferPoolRef = NULL;
+static le_timer_Ref_t RegUpdateTimerRef;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time series data memory pool.  Initialized in assetData_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t TimeSeriesDataPoolRef = NULL;
 
 
 //--------------------------------------------------------------------------------------------------
@@ -1105,6 +1177,182 @@ static le_result_t CreateAssetDataFromModelByName
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash a (parent, id) key of InstanceMap or FieldMap
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t HashIdKey
+(
+    const void* keyPtr
+)
+{
+    const IdKey_t* idKeyPtr = keyPtr;
+
+    // Multiplicative hashing, so that both the parent pointer and the id spread over the low bits
+    // used to select the bucket.
+    size_t hash = ((size_t)idKeyPtr->parentPtr >> 3) ^ ((size_t)idKeyPtr->id * 2654435761u);
+
+    return hash ^ (hash >> 16);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two (parent, id) keys of InstanceMap or FieldMap
+ */
+//--------------------------------------------------------------------------------------------------
+static bool EqualsIdKey
+(
+    const void* firstKeyPtr,
+    const void* secondKeyPtr
+)
+{
+    const IdKey_t* firstPtr = firstKeyPtr;
+    const IdKey_t* secondPtr = secondKeyPtr;
+
+    return (firstPtr->parentPtr == secondPtr->parentPtr) && (firstPtr->id == secondPtr->id);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash a (parent, name) key of FieldNameMap
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t HashNameKey
+(
+    const void* keyPtr
+)
+{
+    const NameKey_t* nameKeyPtr = keyPtr;
+
+    return le_hashmap_HashString(nameKeyPtr->namePtr) ^ ((size_t)nameKeyPtr->parentPtr >> 3);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two (parent, name) keys of FieldNameMap
+ */
+//--------------------------------------------------------------------------------------------------
+static bool EqualsNameKey
+(
+    const void* firstKeyPtr,
+    const void* secondKeyPtr
+)
+{
+    const NameKey_t* firstPtr = firstKeyPtr;
+    const NameKey_t* secondPtr = secondKeyPtr;
+
+    return (firstPtr->parentPtr == secondPtr->parentPtr) &&
+           (strcmp(firstPtr->namePtr, secondPtr->namePtr) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an instance and its fields to the index maps.  The instance id and the back reference to the
+ * asset must already be set.
+ *
+ * If ids or names are duplicated, the first one in the list is indexed, which is the one the
+ * lookups used to find when walking the lists.
+ */
+//--------------------------------------------------------------------------------------------------
+static void IndexInstance
+(
+    InstanceData_t* instanceDataPtr     ///< [IN] Instance to index
+)
+{
+    FieldData_t* fieldDataPtr;
+    le_dls_Link_t* linkPtr;
+
+    instanceDataPtr->key.parentPtr = instanceDataPtr->assetDataPtr;
+    instanceDataPtr->key.id = instanceDataPtr->instanceId;
+
+    if ( ! le_hashmap_ContainsKey(InstanceMap, &instanceDataPtr->key) )
+    {
+        le_hashmap_Put(InstanceMap, &instanceDataPtr->key, instanceDataPtr);
+    }
+
+    linkPtr = le_dls_Peek(&instanceDataPtr->fieldList);
+
+    while ( linkPtr != NULL )
+    {
+        fieldDataPtr = CONTAINER_OF(linkPtr, FieldData_t, link);
+
+        fieldDataPtr->key.parentPtr = instanceDataPtr;
+        fieldDataPtr->key.id = fieldDataPtr->fieldId;
+        fieldDataPtr->nameKey.parentPtr = instanceDataPtr;
+        fieldDataPtr->nameKey.namePtr = fieldDataPtr->name;
+
+        if ( ! le_hashmap_ContainsKey(FieldMap, &fieldDataPtr->key) )
+        {
+            le_hashmap_Put(FieldMap, &fieldDataPtr->key, fieldDataPtr);
+        }
+        if ( ! le_hashmap_ContainsKey(FieldNameMap, &fieldDataPtr->nameKey) )
+        {
+            le_hashmap_Put(FieldNameMap, &fieldDataPtr->nameKey, fieldDataPtr);
+        }
+
+        linkPtr = le_dls_PeekNext(&instanceDataPtr->fieldList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a field from the index maps, if it is the one indexed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnindexField
+(
+    FieldData_t* fieldDataPtr       ///< [IN] Field to remove
+)
+{
+    if ( le_hashmap_Get(FieldMap, &fieldDataPtr->key) == fieldDataPtr )
+    {
+        le_hashmap_Remove(FieldMap, &fieldDataPtr->key);
+    }
+    if ( le_hashmap_Get(FieldNameMap, &fieldDataPtr->nameKey) == fieldDataPtr )
+    {
+        le_hashmap_Remove(FieldNameMap, &fieldDataPtr->nameKey);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove an instance from the index maps, if it is the one indexed.  The fields are removed
+ * separately by UnindexField().
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnindexInstance
+(
+    InstanceData_t* instanceDataPtr     ///< [IN] Instance to remove
+)
+{
+    if ( le_hashmap_Get(InstanceMap, &instanceDataPtr->key) == instanceDataPtr )
+    {
+        le_hashmap_Remove(InstanceMap, &instanceDataPtr->key);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark the cached Object Instance TLV as outdated.  Must be called whenever a field value changes.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void InvalidateTLVCache
+(
+    InstanceData_t* instanceDataPtr     ///< [IN] Instance containing the changed field
+)
+{
+    instanceDataPtr->isTlvCacheValid = false;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the specified instance from the given asset data block
@@ -1121,28 +1369,16 @@ static le_result_t GetInstanceFromAssetData
     InstanceData_t** instanceDataPtrPtr   ///< [OUT]
 )
 {
-    InstanceData_t* assetInstancePtr;
-    le_dls_Link_t* linkPtr;
-
-    // Get the start of the instance list
-    linkPtr = le_dls_Peek(&assetDataPtr->instanceList);
+    IdKey_t key = { .parentPtr = assetDataPtr, .id = instanceId };
+    InstanceData_t* assetInstancePtr = le_hashmap_Get(InstanceMap, &key);
 
-    // Loop through the asset instances
-    while ( linkPtr != NULL )
+    if ( assetInstancePtr == NULL )
     {
-        assetInstancePtr = CONTAINER_OF(linkPtr, InstanceData_t, link);
-        //LE_PRINT_VALUE("%i", assetInstancePtr->instanceId);
-
-        if ( assetInstancePtr->instanceId == instanceId )
-        {
-            *instanceDataPtrPtr = assetInstancePtr;
-            return LE_OK;
-        }
-
-        linkPtr = le_dls_PeekNext(&assetDataPtr->instanceList, linkPtr);
+        return LE_NOT_FOUND;
     }
 
-    return LE_NOT_FOUND;
+    *instanceDataPtrPtr = assetInstancePtr;
+    return LE_OK;
 }
 
 
@@ -1162,28 +1398,16 @@ static le_result_t GetFieldFromInstance
     FieldData_t** fieldDataPtrPtr   ///< [OUT]
 )
 {
-    FieldData_t* fieldDataPtr;
-    le_dls_Link_t* fieldLinkPtr;
-
-    // Get the start of the field list
-    fieldLinkPtr = le_dls_Peek(&instanceDataPtr->fieldList);
+    IdKey_t key = { .parentPtr = instanceDataPtr, .id = fieldId };
+    FieldData_t* fieldDataPtr = le_hashmap_Get(FieldMap, &key);
 
-    // Loop through the fields
-    while ( fieldLinkPtr != NULL )
+    if ( fieldDataPtr == NULL )
     {
-        fieldDataPtr = CONTAINER_OF(fieldLinkPtr, FieldData_t, link);
-        //LE_PRINT_VALUE("%i", fieldDataPtr->fieldId);
-
-        if ( fieldDataPtr->fieldId == fieldId )
-        {
-            *fieldDataPtrPtr = fieldDataPtr;
-            return LE_OK;
-        }
-
-        fieldLinkPtr = le_dls_PeekNext(&instanceDataPtr->fieldList, fieldLinkPtr);
+        return LE_NOT_FOUND;
     }
 
-    return LE_NOT_FOUND;
+    *fieldDataPtrPtr = fieldDataPtr;
+    return LE_OK;
 }
 
 
@@ -1309,11 +1533,14 @@ static le_result_t StartTimeSeries
 
     le_result_t result;
     FieldData_t* fieldDataPtr;
-    uint8_t* timeSeriesBufferPtr;
+    TimeSeriesData_t* timeSeriesPtr;
     char headerId[64];
     CborError err;
+    CborEncoder streamRef;
+    CborEncoder mapRef;
     CborEncoder headerArray;
     CborEncoder factorArray;
+    CborEncoder sampleRef;
 
     result = GetFieldFromInstance(instanceRef, fieldId, &fieldDataPtr);
     if ( result != LE_OK )
@@ -1335,32 +1562,38 @@ static le_result_t StartTimeSeries
                  instanceRef->instanceId,
                  fieldId);
 
-    fieldDataPtr->timeSeriesPtr = le_mem_ForceAlloc(TimeSeriesDataPoolRef);
+    timeSeriesPtr = le_mem_ForceAlloc(TimeSeriesDataPoolRef);
 
-    memset(fieldDataPtr->timeSeriesPtr, 0, sizeof(TimeSeriesData_t));
+    memset(timeSeriesPtr, 0, sizeof(TimeSeriesData_t));
 
-    timeSeriesBufferPtr = le_mem_ForceAlloc(CborBufferPoolRef);
-    fieldDataPtr->timeSeriesPtr->bufferPtr = timeSeriesBufferPtr;
+    // Initialize the compressed stream.
+    if (timeSeries_Open(&timeSeriesPtr->stream, TIMESERIES_COMPRESSION_LEVEL) != LE_OK)
+    {
+        le_mem_Release(timeSeriesPtr);
+        return LE_FAULT;
+    }
 
-    fieldDataPtr->timeSeriesPtr->bufferSize = MAX_CBOR_BUFFER_NUMBYTES;
+    fieldDataPtr->timeSeriesPtr = timeSeriesPtr;
 
-    // Initialize CBOR stream.
-    cbor_encoder_init(&fieldDataPtr->timeSeriesPtr->streamRef,
-                      timeSeriesBufferPtr,
-                      MAX_CBOR_BUFFER_NUMBYTES,
-                      0);
+    // Initialize CBOR stream. The samples are added to the stream as separate items, so the
+    // sample array is left open; it is closed when the time series is pushed.
+    result = timeSeries_BeginItem(&timeSeriesPtr->stream, &streamRef);
+    if (result != LE_OK)
+    {
+        return result;
+    }
 
-    err = cbor_encoder_create_map(&fieldDataPtr->timeSeriesPtr->streamRef,
-                                  &fieldDataPtr->timeSeriesPtr->mapRef,
+    err = cbor_encoder_create_map(&streamRef,
+                                  &mapRef,
                                   NUM_TIME_SERIES_MAPS);
     RETURN_IF_CBOR_ERROR(err);
 
     // Create a map and add the header in to the map.
-    err = cbor_encode_text_stringz(&fieldDataPtr->timeSeriesPtr->mapRef, "h");
+    err = cbor_encode_text_stringz(&mapRef, "h");
     RETURN_IF_CBOR_ERROR(err);
 
     // Create an array for the header.
-    err = cbor_encoder_create_array(&fieldDataPtr->timeSeriesPtr->mapRef,
+    err = cbor_encoder_create_array(&mapRef,
                                     &headerArray,
                                     1);
     RETURN_IF_CBOR_ERROR(err);
@@ -1370,16 +1603,16 @@ static le_result_t StartTimeSeries
 
     // Close the heade map i.e done with entering in to header array.
     // e.g. "h" : [/1000/0]  --> map for header.
-    cbor_encoder_close_container(&fieldDataPtr->timeSeriesPtr->mapRef,
+    cbor_encoder_close_container(&mapRef,
                                  &headerArray);
 
     // Create a map for factor.
     // e.g. "f" : [1]  --> map for factor.
-    err = cbor_encode_text_stringz(&fieldDataPtr->timeSeriesPtr->mapRef, "f");
+    err = cbor_encode_text_stringz(&mapRef, "f");
     RETURN_IF_CBOR_ERROR(err);
 
     // Create an array of factors (time stamp factor, data factor)
-    err = cbor_encoder_create_array(&fieldDataPtr->timeSeriesPtr->mapRef,
+    err = cbor_encoder_create_array(&mapRef,
                                     &factorArray,
                                     2);
     RETURN_IF_CBOR_ERROR(err);
@@ -1393,20 +1626,22 @@ static le_result_t StartTimeSeries
     RETURN_IF_CBOR_ERROR(err);
 
     // Close the map i.e done with entering in to factor array.
-    cbor_encoder_close_container(&fieldDataPtr->timeSeriesPtr->mapRef,
+    cbor_encoder_close_container(&mapRef,
                                  &factorArray);
 
     // Create an array for samples. The sample array will have time stamp and data pair.
-    err = cbor_encode_text_stringz(&fieldDataPtr->timeSeriesPtr->mapRef, "s");
+    err = cbor_encode_text_stringz(&mapRef, "s");
     RETURN_IF_CBOR_ERROR(err);
 
-    err = cbor_encoder_create_array(&fieldDataPtr->timeSeriesPtr->mapRef,
-                                    &fieldDataPtr->timeSeriesPtr->sampleRef,
+    err = cbor_encoder_create_array(&mapRef,
+                                    &sampleRef,
                                     CborIndefiniteLength);
     RETURN_IF_CBOR_ERROR(err);
 
-    fieldDataPtr->timeSeriesPtr->factor = factor;
-    fieldDataPtr->timeSeriesPtr->timeStampFactor = timeStampFactor;
+    result = timeSeries_EndItem(&timeSeriesPtr->stream, &sampleRef);
+
+    timeSeriesPtr->factor = factor;
+    timeSeriesPtr->timeStampFactor = timeStampFactor;
 
     return result;
 
@@ -1450,7 +1685,7 @@ static le_result_t StopTimeSeries
         return LE_CLOSED;
     }
 
-    le_mem_Release(fieldDataPtr->timeSeriesPtr->bufferPtr);
+    timeSeries_Close(&fieldDataPtr->timeSeriesPtr->stream);
     le_mem_Release(fieldDataPtr->timeSeriesPtr);
 
     fieldDataPtr->timeSeriesPtr = NULL;
@@ -1488,12 +1723,10 @@ static le_result_t PushTimeSeries
 
     le_result_t result;
     FieldData_t* fieldDataPtr;
-    uint32_t cborStreamSize;
-    unsigned char compressedBuf[MAX_CBOR_BUFFER_NUMBYTES];
-    unsigned long int compressBufLength;
-    z_stream defstream;
+    static const uint8_t breakByte = CBOR_BREAK_BYTE;
+    uint8_t* compressedBufPtr;
+    size_t compressBufLength;
     pa_avc_LWM2MOperationDataRef_t opRef;
-    CborError err;
 
     double dataFactor;
     double timeStampFactor;
@@ -1522,43 +1755,27 @@ static le_result_t PushTimeSeries
     dataFactor = fieldDataPtr->timeSeriesPtr->factor;
     timeStampFactor = fieldDataPtr->timeSeriesPtr->timeStampFactor;
 
-    // Close the map i.e done with entering in to sample array.
-    err = cbor_encoder_close_container_checked(&fieldDataPtr->timeSeriesPtr->mapRef,
-                                               &fieldDataPtr->timeSeriesPtr->sampleRef);
-
-    RETURN_IF_CBOR_ERROR(err);
-
-    // Close the stream.
-    err = cbor_encoder_close_container_checked(&fieldDataPtr->timeSeriesPtr->streamRef,
-                                               &fieldDataPtr->timeSeriesPtr->mapRef);
-    RETURN_IF_CBOR_ERROR(err);
-
-    // Dump CBOR encoded data.
-    cborStreamSize = cbor_encoder_get_buffer_size(&fieldDataPtr->timeSeriesPtr->mapRef,
-                                                  fieldDataPtr->timeSeriesPtr->bufferPtr);
+    // Close the sample array. The map has a definite length and needs no closing.
+    result = timeSeries_Write(&fieldDataPtr->timeSeriesPtr->stream, &breakByte, sizeof(breakByte));
 
-    //LE_DEBUG("cborStreamSize = %d", cborStreamSize);
-    //LE_DUMP(fieldDataPtr->timeSeriesPtr->bufferPtr, cborStreamSize);
-
-    // Compress the cbor encoded data
-    // ToDo: In place compression
-    defstream.zalloc = Z_NULL;
-    defstream.zfree = Z_NULL;
-    defstream.opaque = Z_NULL;
-
-    defstream.avail_in = cborStreamSize;
-    defstream.next_in = (Bytef *)fieldDataPtr->timeSeriesPtr->bufferPtr;
-    defstream.avail_out = (uInt)sizeof(compressedBuf);
-    defstream.next_out = (Bytef *)compressedBuf;
-
-    deflateInit(&defstream, Z_BEST_COMPRESSION);
-    deflate(&defstream, Z_FINISH);
-    deflateEnd(&defstream);
+    // Compress the end of the CBOR encoded data; the rest was compressed as the samples were added.
+    if (result == LE_OK)
+    {
+        result = timeSeries_Finish(&fieldDataPtr->timeSeriesPtr->stream,
+                                   &compressedBufPtr,
+                                   &compressBufLength);
+    }
 
-    compressBufLength = defstream.total_out;
+    if (result != LE_OK)
+    {
+        LE_ERROR("Failed to complete time series on field %d, dropping it.", fieldId);
+        StopTimeSeries(instanceRef, fieldId);
+        return LE_FAULT;
+    }
 
-    //LE_DEBUG("Compressed size is: %lu\n", compressBufLength);
-    //LE_DUMP(compressedBuf, compressBufLength);
+    LE_DEBUG("CBOR stream size %zu, compressed size %zu",
+             timeSeries_GetRawSize(&fieldDataPtr->timeSeriesPtr->stream),
+             compressBufLength);
 
     // Send the delta encoded + CBOR encoded + Zipped data to the server.
     opRef = pa_avc_CreateOpData(instanceRef->assetDataPtr->appName,
@@ -1570,7 +1787,7 @@ static le_result_t PushTimeSeries
                                 fieldDataPtr->token,
                                 fieldDataPtr->tokenLength);
 
-    pa_avc_NotifyChange(opRef, compressedBuf, compressBufLength);
+    pa_avc_NotifyChange(opRef, compressedBufPtr, compressBufLength);
 
     // Stop time series.
     result = StopTimeSeries(instanceRef, fieldId);
@@ -1663,19 +1880,18 @@ static le_result_t TimeSeriesAddEntry
 #ifdef LEGATO_FEATURE_TIMESERIES
 
     CborError err;
+    CborEncoder sampleRef;
     uint64_t timeStamp;
     int intDelta;
     double floatDelta;
     size_t currentSize;
     struct timeval tv;
 
-    // Reserve CBOR_RESERVED_BYTES bytes for closing the container.
-    // The stream has to be flushed it starts getting in to the reserved area.
-    currentSize = cbor_encoder_get_buffer_size(&fieldDataPtr->timeSeriesPtr->sampleRef,
-                                               fieldDataPtr->timeSeriesPtr->bufferPtr);
+    // Reserve TIMESERIES_RESERVED_NUMBYTES bytes for the data not compressed yet and the end of
+    // the stream. The stream has to be flushed it starts getting in to the reserved area.
+    currentSize = timeSeries_GetSize(&fieldDataPtr->timeSeriesPtr->stream);
 
-
-    if (currentSize > (fieldDataPtr->timeSeriesPtr->bufferSize - CBOR_RESERVED_BYTES))
+    if (currentSize > (TIMESERIES_MAX_PAYLOAD_NUMBYTES - TIMESERIES_RESERVED_NUMBYTES))
     {
         LE_WARN("Time series buffer overflow on field %d.", fieldDataPtr->fieldId);
         LE_DEBUG("currentSize = %zd.", currentSize);
@@ -1703,7 +1919,12 @@ static le_result_t TimeSeriesAddEntry
     }
 
     // Add time stamp to sample array.
-    err = cbor_encode_int(&fieldDataPtr->timeSeriesPtr->sampleRef, timeStamp);
+    if (timeSeries_BeginItem(&fieldDataPtr->timeSeriesPtr->stream, &sampleRef) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    err = cbor_encode_int(&sampleRef, timeStamp);
     RETURN_IF_CBOR_ERROR(err);
 
     fieldDataPtr->timeSeriesPtr->prevTimeStamp = utcMilliSec;
@@ -1724,17 +1945,17 @@ static le_result_t TimeSeriesAddEntry
 
             //LE_DEBUG("intDelta = %d", intDelta);
 
-            err = cbor_encode_int(&fieldDataPtr->timeSeriesPtr->sampleRef, intDelta);
+            err = cbor_encode_int(&sampleRef, intDelta);
 
             fieldDataPtr->timeSeriesPtr->prevIntValue = fieldDataPtr->intValue;
             break;
 
         case DATA_TYPE_BOOL:
-            err = cbor_encode_boolean(&fieldDataPtr->timeSeriesPtr->sampleRef, fieldDataPtr->boolValue);
+            err = cbor_encode_boolean(&sampleRef, fieldDataPtr->boolValue);
             break;
 
         case DATA_TYPE_STRING:
-            err = cbor_encode_text_string(&fieldDataPtr->timeSeriesPtr->sampleRef,
+            err = cbor_encode_text_string(&sampleRef,
                                           fieldDataPtr->strValuePtr,
                                           strlen(fieldDataPtr->strValuePtr));
             break;
@@ -1753,12 +1974,12 @@ static le_result_t TimeSeriesAddEntry
 
             if ((uint64_t)fieldDataPtr->timeSeriesPtr->factor == 1)
             {
-                err = cbor_encode_double(&fieldDataPtr->timeSeriesPtr->sampleRef, floatDelta);
+                err = cbor_encode_double(&sampleRef, floatDelta);
             }
             else
             {
                 LE_DEBUG("Float data encoded as integer.");
-                err = cbor_encode_int(&fieldDataPtr->timeSeriesPtr->sampleRef, (int64_t)floatDelta);
+                err = cbor_encode_int(&sampleRef, (int64_t)floatDelta);
             }
 
             fieldDataPtr->timeSeriesPtr->prevFloatValue = fieldDataPtr->floatValue;
@@ -1771,15 +1992,19 @@ static le_result_t TimeSeriesAddEntry
 
     RETURN_IF_CBOR_ERROR(err);
 
+    if (timeSeries_EndItem(&fieldDataPtr->timeSeriesPtr->stream, &sampleRef) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
     fieldDataPtr->timeSeriesPtr->numElements++;
 
 
-    // Reserve CBOR_RESERVED_BYTES bytes for closing the container.
-    // The stream has to be flushed it starts getting in to the reserved area.
-    currentSize = cbor_encoder_get_buffer_size(&fieldDataPtr->timeSeriesPtr->sampleRef,
-                                               fieldDataPtr->timeSeriesPtr->bufferPtr);
+    // Samples are compressed as they are added; check if the compressed stream starts getting
+    // in to the reserved area.
+    currentSize = timeSeries_GetSize(&fieldDataPtr->timeSeriesPtr->stream);
 
-    if (currentSize > (fieldDataPtr->timeSeriesPtr->bufferSize - CBOR_RESERVED_BYTES))
+    if (currentSize > (TIMESERIES_MAX_PAYLOAD_NUMBYTES - TIMESERIES_RESERVED_NUMBYTES))
     {
         LE_WARN("Time series buffer full; flush and restart time series on field %d.",
                  fieldDataPtr->fieldId);
@@ -2175,6 +2400,7 @@ static le_result_t SetInt
     // Remember current value and set new value.
     prevValue = fieldDataPtr->intValue;
     fieldDataPtr->intValue = value;
+    InvalidateTLVCache(instanceRef);
 
     // Call any registered handlers to be notified of write.
     CallFieldActionHandlers( instanceRef, fieldId, ASSET_DATA_ACTION_WRITE, isClient );
@@ -2289,6 +2515,7 @@ static le_result_t SetFloat
     // Remember current value and set new value.
     prevValue = fieldDataPtr->floatValue;
     fieldDataPtr->floatValue = value;
+    InvalidateTLVCache(instanceRef);
 
     // Call any registered handlers to be notified of write.
     CallFieldActionHandlers( instanceRef, fieldId, ASSET_DATA_ACTION_WRITE, isClient );
@@ -2444,6 +2671,7 @@ static le_result_t SetBool
     // Remember current value and set new value.
     prevValue = fieldDataPtr->boolValue;
     fieldDataPtr->boolValue = value;
+    InvalidateTLVCache(instanceRef);
 
     // Call any registered handlers to be notified of write.
     CallFieldActionHandlers( instanceRef, fieldId, ASSET_DATA_ACTION_WRITE, isClient );
@@ -2602,6 +2830,7 @@ static le_result_t SetString
     // Remember current value and set new value.
     result = le_utf8_Copy(prevStr, fieldDataPtr->strValuePtr, STRING_VALUE_NUMBYTES, NULL);
     result = le_utf8_Copy(fieldDataPtr->strValuePtr, strPtr, STRING_VALUE_NUMBYTES, NULL);
+    InvalidateTLVCache(instanceRef);
 
     // Call any registered handlers to be notified of write.
     CallFieldActionHandlers( instanceRef, fieldId, ASSET_DATA_ACTION_WRITE, isClient );
@@ -3063,8 +3292,14 @@ le_result_t assetData_CreateInstanceById
     // Add back reference from instance data to the asset containing the instance
     assetInstPtr->assetDataPtr = assetDataPtr;
 
+    // The TLV cache is only allocated on the first read of the whole instance
+    assetInstPtr->tlvCachePtr = NULL;
+    assetInstPtr->tlvCacheNumBytes = 0;
+    assetInstPtr->tlvHeaderNumBytes = 0;
+    assetInstPtr->isTlvCacheValid = false;
 
     le_dls_Queue(&assetDataPtr->instanceList, &assetInstPtr->link);
+    IndexInstance(assetInstPtr);
 
     // todo: For now, for testing, print it out; add trace support later.
     if ( 0 )
@@ -3191,12 +3426,15 @@ void assetData_DeleteInstance
         if (fieldDataPtr->timeSeriesPtr != NULL)
         {
             LE_DEBUG("Releasing time series resources of %s", fieldDataPtr->name);
-            le_mem_Release(fieldDataPtr->timeSeriesPtr->bufferPtr);
+#ifdef LEGATO_FEATURE_TIMESERIES
+            timeSeries_Close(&fieldDataPtr->timeSeriesPtr->stream);
+#endif
             le_mem_Release(fieldDataPtr->timeSeriesPtr);
         }
 
         // Release the field.
         LE_DEBUG("Deleting field %s", fieldDataPtr->name);
+        UnindexField(fieldDataPtr);
         le_mem_Release(fieldDataPtr);
 
         linkPtr = le_dls_Pop(&instanceRef->fieldList);
@@ -3204,6 +3442,12 @@ void assetData_DeleteInstance
 
     // Remove the instance from the asset instance list
     le_dls_Remove(&instanceRef->assetDataPtr->instanceList, &instanceRef->link);
+    UnindexInstance(instanceRef);
+
+    if ( instanceRef->tlvCachePtr != NULL )
+    {
+        le_mem_Release(instanceRef->tlvCachePtr);
+    }
 
     // Lastly, release the instance data.
     le_mem_Release(instanceRef);
@@ -3550,40 +3794,13 @@ le_result_t assetData_GetFieldIdFromName
     int* fieldIdPtr                             ///< [OUT] The field id
 )
 {
-    /*
-     * NOTE:
-     *   The main use for this function is to get the fieldId that is then passed to the various
-     *   assetData_client_Get* functions.  This is not particularly efficient as it requires
-     *   iterating twice through the field list.  One alternative would be to add a new set of
-     *   assetData_client_Get* functions that take a field name instead of field id.
-     *
-     *   For now, assume that the performance is good enough, but if it becomes an issue then
-     *   this second set of functions may need to be added.  Of course, there might also be some
-     *   other alternative solution that has not yet been considered.
-     */
+    NameKey_t key = { .parentPtr = instanceRef, .namePtr = fieldNamePtr };
+    FieldData_t* fieldDataPtr = le_hashmap_Get(FieldNameMap, &key);
 
-    FieldData_t* fieldDataPtr;
-    le_dls_Link_t* fieldLinkPtr;
-
-    // Get the start of the field list
-    fieldLinkPtr = le_dls_Peek(&instanceRef->fieldList);
-
-    //LE_PRINT_VALUE("%s", instanceRef->assetDataPtr->appName);
-    //LE_PRINT_VALUE("%s", instanceRef->assetDataPtr->assetName);
-
-    // Loop through the fields
-    while ( fieldLinkPtr != NULL )
+    if ( fieldDataPtr != NULL )
     {
-        fieldDataPtr = CONTAINER_OF(fieldLinkPtr, FieldData_t, link);
-        //LE_PRINT_VALUE("%s", fieldDataPtr->name);
-
-        if ( strcmp(fieldDataPtr->name, fieldNamePtr) == 0 )
-        {
-            *fieldIdPtr = fieldDataPtr->fieldId;
-            return LE_OK;
-        }
-
-        fieldLinkPtr = le_dls_PeekNext(&instanceRef->fieldList, fieldLinkPtr);
+        *fieldIdPtr = fieldDataPtr->fieldId;
+        return LE_OK;
     }
 
     return LE_FAULT;
@@ -4313,6 +4530,8 @@ le_result_t assetData_server_SetValue
         return result;
     }
 
+    InvalidateTLVCache(instanceRef);
+
     result = LE_OK;   // result could be changed in the switch statement
     switch ( fieldDataPtr->type )
     {
@@ -4529,11 +4748,14 @@ le_result_t assetData_Init
                                                  sizeof(ActionHandlerData_t));
 
     // Memory pool for time series data.
+#ifdef LEGATO_FEATURE_TIMESERIES
     TimeSeriesDataPoolRef = le_mem_CreatePool("TimeSeries data pool", sizeof(TimeSeriesData_t));
-    CborBufferPoolRef = le_mem_CreatePool("CBOR buffer pool", MAX_CBOR_BUFFER_NUMBYTES);
+    timeSeries_Init();
+#endif
 
     StringValuePoolRef = le_mem_CreatePool("String value pool", STRING_VALUE_NUMBYTES);
     AddressStringPoolRef = le_mem_CreatePool("Address pool", 100);
+    TlvCachePoolRef = le_mem_CreatePool("Instance TLV cache pool", INSTANCE_TLV_MAX_NUMBYTES);
 
     // Create AssetMap that maps (appName, assetId) to an AssetData block.
     AssetMap = le_hashmap_Create("Asset Map", 31, le_hashmap_HashString, le_hashmap_EqualsString);
@@ -4544,6 +4766,16 @@ le_result_t assetData_Init
                                        le_hashmap_HashString,
                                        le_hashmap_EqualsString);
 
+    // Create the maps indexing the instances and fields of all assets.
+    InstanceMap = le_hashmap_Create("Instance Map",
+                                    INSTANCE_MAP_CAPACITY,
+                                    HashIdKey,
+                                    EqualsIdKey);
+    FieldMap = le_hashmap_Create("Field Map", FIELD_MAP_CAPACITY, HashIdKey, EqualsIdKey);
+    FieldNameMap = le_hashmap_Create("Field Name Map",
+                                     FIELD_MAP_CAPACITY,
+                                     HashNameKey,
+                                     EqualsNameKey);
 
     // Use a timer to delay reporting instance creation events to the modem for 15 seconds after
     // the last creation event. This allows us to aggregate multiple registration updates together.
@@ -4867,7 +5099,7 @@ static le_result_t WriteFieldTLV
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Write a list of readable LWM2M Resource TLVs to the given buffer.
+ * Write a list of readable LWM2M Resource TLVs to the given buffer, from the current field values.
  *
  * @return:
  *      - LE_OK on success
@@ -4875,7 +5107,7 @@ static le_result_t WriteFieldTLV
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t assetData_WriteFieldListToTLV
+static le_result_t WriteFieldListTLV
 (
     assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
     uint8_t* bufPtr,                            ///< [OUT] Buffer for writing the TLV list
@@ -4928,7 +5160,7 @@ le_result_t assetData_WriteFieldListToTLV
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Write a LWM2M Object Instance TLV to the given buffer.
+ * Encode a LWM2M Object Instance TLV in the given buffer, from the current field values.
  *
  * @return:
  *      - LE_OK on success
@@ -4936,7 +5168,7 @@ le_result_t assetData_WriteFieldListToTLV
  *      - LE_FAULT on any other error
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t WriteInstanceToTLV
+static le_result_t EncodeInstanceTLV
 (
     assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
     int fieldId,                                ///< [IN] Field to write, or -1 for all fields
@@ -4949,17 +5181,18 @@ static le_result_t WriteInstanceToTLV
     FieldData_t* fieldDataPtr;
     size_t totalNumBytesWritten;
     size_t numBytesWritten;
-    uint8_t tmpBuffer[256-6];  // leave enough space for maximum header size of 6 bytes
+    // leave enough space for maximum header size of 6 bytes
+    uint8_t tmpBuffer[INSTANCE_TLV_MAX_NUMBYTES-6];
 
     // Need to write the field TLVs first, to know how many bytes will be in the instance TLV.
     // Either read all the allowable TLVs, or just the one specified.
     if ( fieldId == -1 )
     {
         // Read all fields that are allowed and write to the TLV.
-        result = assetData_WriteFieldListToTLV(instanceRef,
-                                               tmpBuffer,
-                                               sizeof(tmpBuffer),
-                                               &totalNumBytesWritten);
+        result = WriteFieldListTLV(instanceRef,
+                                   tmpBuffer,
+                                   sizeof(tmpBuffer),
+                                   &totalNumBytesWritten);
         if ( result != LE_OK )
         {
             return result;
@@ -5008,6 +5241,145 @@ static le_result_t WriteInstanceToTLV
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make sure the cached Object Instance TLV with all readable fields is up to date.
+ *
+ * Reading a whole object walks every field of every instance, so the encoded instances are kept
+ * until one of their fields is written.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the fields do not fit in an Object Instance TLV
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t UpdateTLVCache
+(
+    assetData_InstanceDataRef_t instanceRef     ///< [IN] Asset instance to use
+)
+{
+    le_result_t result;
+    size_t numBytesWritten;
+
+    if ( instanceRef->isTlvCacheValid )
+    {
+        return LE_OK;
+    }
+
+    if ( instanceRef->tlvCachePtr == NULL )
+    {
+        instanceRef->tlvCachePtr = le_mem_ForceAlloc(TlvCachePoolRef);
+    }
+
+    result = EncodeInstanceTLV(instanceRef,
+                               -1,
+                               instanceRef->tlvCachePtr,
+                               INSTANCE_TLV_MAX_NUMBYTES,
+                               &numBytesWritten);
+    if ( result != LE_OK )
+    {
+        return result;
+    }
+
+    // The header is followed by the field list, so its size is all that is needed to get the
+    // field list back from the cache. It is the type byte, followed by the id (8 or 16 bits) and
+    // the length field (0 to 3 bytes), as written by WriteTLVHeader().
+    uint8_t typeByte = instanceRef->tlvCachePtr[0];
+
+    instanceRef->tlvCacheNumBytes = numBytesWritten;
+    instanceRef->tlvHeaderNumBytes = 1 + ((typeByte & 0x20) ? 2 : 1) + ((typeByte >> 3) & 0x03);
+    instanceRef->isTlvCacheValid = true;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a list of readable LWM2M Resource TLVs to the given buffer.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the TLV data could not fit in the buffer
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t assetData_WriteFieldListToTLV
+(
+    assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
+    uint8_t* bufPtr,                            ///< [OUT] Buffer for writing the TLV list
+    size_t bufNumBytes,                         ///< [IN] Size of buffer
+    size_t* numBytesWrittenPtr                  ///< [OUT] # bytes written to buffer.
+)
+{
+    size_t fieldListNumBytes;
+
+    // Field lists too long for an Object Instance TLV are not cached, but may still fit the buffer
+    if ( UpdateTLVCache(instanceRef) != LE_OK )
+    {
+        return WriteFieldListTLV(instanceRef, bufPtr, bufNumBytes, numBytesWrittenPtr);
+    }
+
+    fieldListNumBytes = instanceRef->tlvCacheNumBytes - instanceRef->tlvHeaderNumBytes;
+    if ( fieldListNumBytes > bufNumBytes )
+    {
+        LE_WARN("Overflow: oiid=%i", instanceRef->instanceId);
+        *numBytesWrittenPtr = 0;
+        return LE_OVERFLOW;
+    }
+
+    memcpy(bufPtr, instanceRef->tlvCachePtr + instanceRef->tlvHeaderNumBytes, fieldListNumBytes);
+    *numBytesWrittenPtr = fieldListNumBytes;
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a LWM2M Object Instance TLV to the given buffer.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the TLV data could not fit in the buffer
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteInstanceToTLV
+(
+    assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
+    int fieldId,                                ///< [IN] Field to write, or -1 for all fields
+    uint8_t* bufPtr,                            ///< [OUT] Buffer for writing the object instance
+    size_t bufNumBytes,                         ///< [IN] Size of buffer
+    size_t* numBytesWrittenPtr                  ///< [OUT] # bytes written to buffer.
+)
+{
+    le_result_t result;
+
+    if ( fieldId != -1 )
+    {
+        return EncodeInstanceTLV(instanceRef, fieldId, bufPtr, bufNumBytes, numBytesWrittenPtr);
+    }
+
+    result = UpdateTLVCache(instanceRef);
+    if ( result != LE_OK )
+    {
+        return result;
+    }
+
+    if ( instanceRef->tlvCacheNumBytes > bufNumBytes )
+    {
+        LE_WARN("Overflow: oiid=%i, rid=%i", instanceRef->instanceId, fieldId);
+        *numBytesWrittenPtr = 0;
+        return LE_OVERFLOW;
+    }
+
+    memcpy(bufPtr, instanceRef->tlvCachePtr, instanceRef->tlvCacheNumBytes);
+    *numBytesWrittenPtr = instanceRef->tlvCacheNumBytes;
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Write TLV with all instances of the LWM2M Object to the given buffer.
@@ -5218,6 +5590,8 @@ static le_result_t ReadFieldValueFromTLV
     if ( result != LE_OK )
         return result;
 
+    InvalidateTLVCache(instanceRef);
+
     // Update the field value from the TLV; note that result must be LE_OK here.
     switch ( fieldDataPtr->type )
     {
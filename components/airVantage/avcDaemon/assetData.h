@@ -45,15 +45,6 @@
 #define NUM_TIME_SERIES_MAPS 3
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- *  Number of bytes reserved in the CBOR stream. After all the samples are added to CBOR stream few
- *  more bytes are needed to close the sample array and the stream.
- */
-//--------------------------------------------------------------------------------------------------
-#define CBOR_RESERVED_BYTES 32
-
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Actions that can happen on field or asset
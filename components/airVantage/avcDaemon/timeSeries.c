@@ -0,0 +1,487 @@
+/**
+ * @file timeSeries.c
+ *
+ * Implementation of the streaming encoder for time series data.
+ *
+ * The stream is compressed with a reduced window and memory level: a time series is mostly made of
+ * small delta encoded samples, which do not benefit from the 32 KB default window, and the
+ * compressor state is kept for the whole life of the time series.
+ *
+ * <hr>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+#include "timeSeries.h"
+
+#ifdef LEGATO_FEATURE_TIMESERIES
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes of the staging buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STAGING_NUMBYTES 1024
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes of a chunk of compressed data.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CHUNK_NUMBYTES 1024
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compressor window size (log2), i.e. 4 KB window.
+ */
+//--------------------------------------------------------------------------------------------------
+#define WINDOW_BITS 12
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compressor memory level. The compressor buffers up to 2^(MEM_LEVEL + 6) symbols before
+ * producing output, which bounds TIMESERIES_RESERVED_NUMBYTES.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MEM_LEVEL 5
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Chunk of compressed data.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_sls_Link_t link;             ///< For adding to the chunk list
+    uint8_t data[CHUNK_NUMBYTES];   ///< Compressed data
+}
+Chunk_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Staging buffer memory pool.  Initialized in timeSeries_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t StagingPoolRef = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Chunk memory pool.  Initialized in timeSeries_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ChunkPoolRef = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Contiguous payload memory pool, only used if the payload spans several chunks.  Initialized in
+ * timeSeries_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PayloadPoolRef = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compress data into the chunks of the stream.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Compress
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    const uint8_t* dataPtr,                 ///< [IN] Data
+    size_t dataNumBytes,                    ///< [IN] Data size in bytes
+    int flush                               ///< [IN] Z_NO_FLUSH or Z_FINISH
+)
+{
+    z_stream* zStreamPtr = &streamPtr->zStream;
+    int rc;
+
+    zStreamPtr->next_in = (Bytef*)dataPtr;
+    zStreamPtr->avail_in = (uInt)dataNumBytes;
+
+    for (;;)
+    {
+        // Chain a new chunk when the current one is full.
+        if (zStreamPtr->avail_out == 0)
+        {
+            Chunk_t* chunkPtr = le_mem_ForceAlloc(ChunkPoolRef);
+
+            chunkPtr->link = LE_SLS_LINK_INIT;
+            le_sls_Queue(&streamPtr->chunkList, &chunkPtr->link);
+
+            zStreamPtr->next_out = chunkPtr->data;
+            zStreamPtr->avail_out = CHUNK_NUMBYTES;
+        }
+
+        rc = deflate(zStreamPtr, flush);
+        if ((rc == Z_STREAM_ERROR) || (rc == Z_MEM_ERROR))
+        {
+            LE_ERROR("Compression error %d", rc);
+            return LE_FAULT;
+        }
+
+        if (flush == Z_FINISH)
+        {
+            if (rc == Z_STREAM_END)
+            {
+                break;
+            }
+        }
+        else if ((zStreamPtr->avail_in == 0) && (zStreamPtr->avail_out != 0))
+        {
+            // All the input is consumed, and the compressor has nothing more to output for now.
+            break;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compress the staged data.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CompressStaged
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    int flush                               ///< [IN] Z_NO_FLUSH or Z_FINISH
+)
+{
+    le_result_t result = Compress(streamPtr, streamPtr->stagingPtr, streamPtr->stagedNumBytes,
+                                  flush);
+
+    streamPtr->stagedNumBytes = 0;
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the time series encoder. Must be called before any other function.
+ */
+//--------------------------------------------------------------------------------------------------
+void timeSeries_Init
+(
+    void
+)
+{
+    StagingPoolRef = le_mem_CreatePool("TimeSeries staging pool", STAGING_NUMBYTES);
+    ChunkPoolRef = le_mem_CreatePool("TimeSeries chunk pool", sizeof(Chunk_t));
+    PayloadPoolRef = le_mem_CreatePool("TimeSeries payload pool", TIMESERIES_MAX_PAYLOAD_NUMBYTES);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a time series stream.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the compressor could not be initialized
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_Open
+(
+    timeSeries_Stream_t* streamPtr,         ///< [OUT] Stream to open
+    int compressionLevel                    ///< [IN] Compression level (0 to 9)
+)
+{
+    int rc;
+
+    memset(streamPtr, 0, sizeof(timeSeries_Stream_t));
+    streamPtr->chunkList = LE_SLS_LIST_INIT;
+
+    streamPtr->zStream.zalloc = Z_NULL;
+    streamPtr->zStream.zfree = Z_NULL;
+    streamPtr->zStream.opaque = Z_NULL;
+
+    rc = deflateInit2(&streamPtr->zStream,
+                      compressionLevel,
+                      Z_DEFLATED,
+                      WINDOW_BITS,
+                      MEM_LEVEL,
+                      Z_DEFAULT_STRATEGY);
+    if (rc != Z_OK)
+    {
+        LE_ERROR("Failed to initialize compression, level %d: error %d", compressionLevel, rc);
+        return LE_FAULT;
+    }
+
+    streamPtr->stagingPtr = le_mem_ForceAlloc(StagingPoolRef);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a new CBOR item. The item is encoded with the returned encoder, and added to the stream by
+ * timeSeries_EndItem().
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_BeginItem
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    CborEncoder* encoderPtr                 ///< [OUT] Encoder to use for the item
+)
+{
+    if (streamPtr->isFinished)
+    {
+        LE_ERROR("Time series stream already finished.");
+        return LE_FAULT;
+    }
+
+    // Make room for a whole item.
+    if ((STAGING_NUMBYTES - streamPtr->stagedNumBytes) < TIMESERIES_MAX_ITEM_NUMBYTES)
+    {
+        if (CompressStaged(streamPtr, Z_NO_FLUSH) != LE_OK)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    cbor_encoder_init(encoderPtr,
+                      streamPtr->stagingPtr + streamPtr->stagedNumBytes,
+                      STAGING_NUMBYTES - streamPtr->stagedNumBytes,
+                      0);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the CBOR item encoded since timeSeries_BeginItem() to the stream. The encoder can be the one
+ * returned by timeSeries_BeginItem() or any container encoder created from it.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the stream is already finished
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_EndItem
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    const CborEncoder* encoderPtr           ///< [IN] Encoder used for the item
+)
+{
+    size_t stagedNumBytes;
+
+    if (streamPtr->isFinished)
+    {
+        LE_ERROR("Time series stream already finished.");
+        return LE_FAULT;
+    }
+
+    stagedNumBytes = cbor_encoder_get_buffer_size(encoderPtr, streamPtr->stagingPtr);
+    LE_ASSERT(stagedNumBytes <= STAGING_NUMBYTES);
+
+    streamPtr->rawNumBytes += stagedNumBytes - streamPtr->stagedNumBytes;
+    streamPtr->stagedNumBytes = stagedNumBytes;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add raw bytes to the stream.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_Write
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    const uint8_t* dataPtr,                 ///< [IN] Data
+    size_t dataNumBytes                     ///< [IN] Data size in bytes
+)
+{
+    if (streamPtr->isFinished)
+    {
+        LE_ERROR("Time series stream already finished.");
+        return LE_FAULT;
+    }
+
+    streamPtr->rawNumBytes += dataNumBytes;
+
+    if (dataNumBytes <= (STAGING_NUMBYTES - streamPtr->stagedNumBytes))
+    {
+        memcpy(streamPtr->stagingPtr + streamPtr->stagedNumBytes, dataPtr, dataNumBytes);
+        streamPtr->stagedNumBytes += dataNumBytes;
+
+        return LE_OK;
+    }
+
+    if (CompressStaged(streamPtr, Z_NO_FLUSH) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    return Compress(streamPtr, dataPtr, dataNumBytes, Z_NO_FLUSH);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of compressed bytes produced so far. Up to TIMESERIES_RESERVED_NUMBYTES more can
+ * be produced until the stream is finished.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t timeSeries_GetSize
+(
+    const timeSeries_Stream_t* streamPtr    ///< [IN] Stream
+)
+{
+    return streamPtr->zStream.total_out;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of uncompressed bytes added so far.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t timeSeries_GetRawSize
+(
+    const timeSeries_Stream_t* streamPtr    ///< [IN] Stream
+)
+{
+    return streamPtr->rawNumBytes;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete the compressed stream. Nothing can be added to the stream afterwards.
+ *
+ * The payload remains valid until the stream is closed.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the payload exceeds TIMESERIES_MAX_PAYLOAD_NUMBYTES
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_Finish
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    uint8_t** payloadPtrPtr,                ///< [OUT] Compressed payload
+    size_t* payloadNumBytesPtr              ///< [OUT] Compressed payload size in bytes
+)
+{
+    le_sls_Link_t* linkPtr;
+    size_t payloadNumBytes;
+    size_t offset;
+
+    if (streamPtr->isFinished)
+    {
+        LE_ERROR("Time series stream already finished.");
+        return LE_FAULT;
+    }
+    streamPtr->isFinished = true;
+
+    if (CompressStaged(streamPtr, Z_FINISH) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    payloadNumBytes = streamPtr->zStream.total_out;
+    if (payloadNumBytes > TIMESERIES_MAX_PAYLOAD_NUMBYTES)
+    {
+        LE_ERROR("Time series payload too large: %zu bytes.", payloadNumBytes);
+        return LE_OVERFLOW;
+    }
+
+    linkPtr = le_sls_Peek(&streamPtr->chunkList);
+
+    // Small time series fit in a single chunk, which is then used as is.
+    if (payloadNumBytes <= CHUNK_NUMBYTES)
+    {
+        *payloadPtrPtr = CONTAINER_OF(linkPtr, Chunk_t, link)->data;
+        *payloadNumBytesPtr = payloadNumBytes;
+
+        return LE_OK;
+    }
+
+    streamPtr->payloadPtr = le_mem_ForceAlloc(PayloadPoolRef);
+
+    for (offset = 0; offset < payloadNumBytes; offset += CHUNK_NUMBYTES)
+    {
+        size_t chunkNumBytes = payloadNumBytes - offset;
+
+        if (chunkNumBytes > CHUNK_NUMBYTES)
+        {
+            chunkNumBytes = CHUNK_NUMBYTES;
+        }
+
+        memcpy(streamPtr->payloadPtr + offset,
+               CONTAINER_OF(linkPtr, Chunk_t, link)->data,
+               chunkNumBytes);
+
+        linkPtr = le_sls_PeekNext(&streamPtr->chunkList, linkPtr);
+    }
+
+    *payloadPtrPtr = streamPtr->payloadPtr;
+    *payloadNumBytesPtr = payloadNumBytes;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a time series stream and free its resources.
+ */
+//--------------------------------------------------------------------------------------------------
+void timeSeries_Close
+(
+    timeSeries_Stream_t* streamPtr          ///< [IN] Stream
+)
+{
+    le_sls_Link_t* linkPtr;
+
+    deflateEnd(&streamPtr->zStream);
+
+    while ((linkPtr = le_sls_Pop(&streamPtr->chunkList)) != NULL)
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, Chunk_t, link));
+    }
+
+    if (streamPtr->payloadPtr != NULL)
+    {
+        le_mem_Release(streamPtr->payloadPtr);
+        streamPtr->payloadPtr = NULL;
+    }
+
+    le_mem_Release(streamPtr->stagingPtr);
+    streamPtr->stagingPtr = NULL;
+}
+
+#endif // LEGATO_FEATURE_TIMESERIES
@@ -0,0 +1,226 @@
+/**
+ * @file timeSeries.h
+ *
+ * Streaming encoder for time series data.
+ *
+ * The CBOR encoded samples are staged in a small buffer and compressed incrementally as they are
+ * appended, so that pushing a time series only has to flush the end of the stream. The compressed
+ * data is accumulated in a chain of fixed-size chunks, so the length of a time series is not
+ * bounded by a single buffer.
+ *
+ * Usage:
+ *  - timeSeries_Open() a stream.
+ *  - For each CBOR item, timeSeries_BeginItem(), encode the item with tinyCBOR in the returned
+ *    encoder, then timeSeries_EndItem(). Up to TIMESERIES_MAX_ITEM_NUMBYTES can be encoded per item.
+ *  - Raw bytes (e.g. the break byte closing an indefinite length array) are added with
+ *    timeSeries_Write().
+ *  - timeSeries_Finish() completes the compressed stream and returns it as a contiguous payload.
+ *  - timeSeries_Close() frees the resources.
+ *
+ * <hr>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#ifndef LEGATO_TIME_SERIES_INCLUDE_GUARD
+#define LEGATO_TIME_SERIES_INCLUDE_GUARD
+
+#include "legato.h"
+
+#ifdef LEGATO_FEATURE_TIMESERIES
+
+#include "tinycbor/cbor.h"
+#include "zlib.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compression level used for time series data, from Z_BEST_SPEED (1) to Z_BEST_COMPRESSION (9).
+ * Can be overridden at build time.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef TIMESERIES_COMPRESSION_LEVEL
+#define TIMESERIES_COMPRESSION_LEVEL Z_BEST_COMPRESSION
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a compressed time series payload. Can be overridden at build time.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef TIMESERIES_MAX_PAYLOAD_NUMBYTES
+#define TIMESERIES_MAX_PAYLOAD_NUMBYTES (64 * 1024)
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes that can still be produced by a stream on top of timeSeries_GetSize(), i.e. the
+ * staged data and the data buffered by the compressor, plus the end of the stream.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TIMESERIES_RESERVED_NUMBYTES (16 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a single CBOR item.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TIMESERIES_MAX_ITEM_NUMBYTES 512
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time series stream. The content of this structure is private to the time series encoder.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    z_stream zStream;               ///< Compressor state.
+    uint8_t* stagingPtr;            ///< Uncompressed data waiting to be compressed.
+    size_t stagedNumBytes;          ///< Number of bytes in the staging buffer.
+    le_sls_List_t chunkList;        ///< Chunks of compressed data.
+    size_t rawNumBytes;             ///< Total number of uncompressed bytes.
+    uint8_t* payloadPtr;            ///< Contiguous payload, once the stream is finished.
+    bool isFinished;                ///< Has the compressed stream been completed?
+}
+timeSeries_Stream_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the time series encoder. Must be called before any other function.
+ */
+//--------------------------------------------------------------------------------------------------
+void timeSeries_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a time series stream.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the compressor could not be initialized
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_Open
+(
+    timeSeries_Stream_t* streamPtr,         ///< [OUT] Stream to open
+    int compressionLevel                    ///< [IN] Compression level (0 to 9)
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start a new CBOR item. The item is encoded with the returned encoder, and added to the stream by
+ * timeSeries_EndItem().
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_BeginItem
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    CborEncoder* encoderPtr                 ///< [OUT] Encoder to use for the item
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the CBOR item encoded since timeSeries_BeginItem() to the stream. The encoder can be the one
+ * returned by timeSeries_BeginItem() or any container encoder created from it.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the stream is already finished
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_EndItem
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    const CborEncoder* encoderPtr           ///< [IN] Encoder used for the item
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add raw bytes to the stream.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_Write
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    const uint8_t* dataPtr,                 ///< [IN] Data
+    size_t dataNumBytes                     ///< [IN] Data size in bytes
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of compressed bytes produced so far. Up to TIMESERIES_RESERVED_NUMBYTES more can
+ * be produced until the stream is finished.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t timeSeries_GetSize
+(
+    const timeSeries_Stream_t* streamPtr    ///< [IN] Stream
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of uncompressed bytes added so far.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t timeSeries_GetRawSize
+(
+    const timeSeries_Stream_t* streamPtr    ///< [IN] Stream
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete the compressed stream. Nothing can be added to the stream afterwards.
+ *
+ * The payload remains valid until the stream is closed.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the payload exceeds TIMESERIES_MAX_PAYLOAD_NUMBYTES
+ *      - LE_FAULT on compression error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeries_Finish
+(
+    timeSeries_Stream_t* streamPtr,         ///< [IN] Stream
+    uint8_t** payloadPtrPtr,                ///< [OUT] Compressed payload
+    size_t* payloadNumBytesPtr              ///< [OUT] Compressed payload size in bytes
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a time series stream and free its resources.
+ */
+//--------------------------------------------------------------------------------------------------
+void timeSeries_Close
+(
+    timeSeries_Stream_t* streamPtr          ///< [IN] Stream
+);
+
+#endif // LEGATO_FEATURE_TIMESERIES
+
+#endif // LEGATO_TIME_SERIES_INCLUDE_GUARD
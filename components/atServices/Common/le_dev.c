@@ -14,42 +14,25 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Default buffer size for device information and error messages
+ * Default buffer size for error messages
  */
 //--------------------------------------------------------------------------------------------------
 #define DSIZE   256
 
 //--------------------------------------------------------------------------------------------------
 /**
- * String size for the buffer that contains a summary of all the device information available
+ * Maximum number of bytes of a traced buffer, once special characters are expanded. Longer buffers
+ * are truncated in the trace.
  */
 //--------------------------------------------------------------------------------------------------
-#define DSIZE_INFO_STR   1600
+#define TRACE_MAX_BYTES     512
 
 //--------------------------------------------------------------------------------------------------
 /**
- * struct DevInfo contains useful information about the device in use
+ * Maximum number of buffers written by le_dev_WriteVec()
  */
 //--------------------------------------------------------------------------------------------------
-typedef struct
-{
-    int             fd;                         ///< file descriptor in use
-    char            linkName[DSIZE];            ///< device full path
-    char            fdSysPath[DSIZE];           ///< /proc/PID/fd/FD
-    unsigned int    major;                      ///< device's major number
-    unsigned int    minor;                      ///< device's minor number
-    char            uName[DSIZE];               ///< user name
-    char            gName[DSIZE];               ///< group name
-    char            devInfoStr[DSIZE_INFO_STR]; ///< formatted string for all info
-}
-DevInfo_t;
-
-//--------------------------------------------------------------------------------------------------
-/**
- * device information
- */
-//--------------------------------------------------------------------------------------------------
-static DevInfo_t DevInfo;
+#define WRITE_MAX_IOV       64
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -72,150 +55,163 @@ static char* StrError
     return errMsg;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is tracing of the device traffic enabled
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static inline bool IsTraceEnabled
+(
+    void
+)
+{
+    return (le_log_GetFilterLevel() == LE_LOG_DEBUG);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get device information
  *
+ * The information is computed once per file descriptor and cached in the device, as it requires
+ * several system calls and user/group database lookups.
+ *
  * Warning: this function works only on *nix systems
  *
  * @return
-        LE_OK       things went Ok and information is printed
- *      LE_FAULT    something wrong happened, check the logs
+ *      The description of the device, or of its file descriptor if the information is unavailable.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t GetDeviceInformation
+static const char* GetDeviceInformation
 (
-    void
+    Device_t*   devicePtr    ///< device pointer
 )
 {
-    if(le_log_GetFilterLevel() == LE_LOG_DEBUG)
+    char fdSysPath[DSIZE];
+    char linkName[DSIZE];
+    struct stat fdStats;
+    struct passwd* passwd;
+    struct group* group;
+
+    if (devicePtr->hasInfo && (devicePtr->infoFd == devicePtr->fd))
     {
-        struct stat fdStats;
-        struct passwd* passwd;
-        struct group* group;
-
-        // Note: Better use sizeof() operator instead of any macro(i.e. DSIZE), as it is compile
-        //       time operator and gives the code better flexibility.
-
-        memset(DevInfo.fdSysPath, 0, sizeof(DevInfo.fdSysPath));
-        memset(DevInfo.linkName, 0, sizeof(DevInfo.linkName));
-        memset(DevInfo.devInfoStr, 0, sizeof(DevInfo.devInfoStr));
-
-        // build the path to fd
-        snprintf(DevInfo.fdSysPath,
-            sizeof(DevInfo.fdSysPath), "/proc/%d/fd/%d", getpid(), DevInfo.fd);
-
-        int len = readlink(DevInfo.fdSysPath, DevInfo.linkName, sizeof(DevInfo.fdSysPath));
-        // get device path
-        if (len < 0) {
-            LE_ERROR("readlink failed %s", StrError(errno));
-            return LE_FAULT;
-        }
-        else if (len >= sizeof(DevInfo.fdSysPath))
-        {
-            LE_ERROR("Too long path. Max allowed: %zd", sizeof(DevInfo.fdSysPath)-1);
-            return LE_FAULT;
-        }
+        return devicePtr->info;
+    }
 
-        // try to get device stats
-        if (fstat(DevInfo.fd, &fdStats) == -1)
-        {
-            LE_ERROR("fstat failed %s", StrError(errno));
-            return LE_FAULT;
-        }
+    devicePtr->hasInfo = true;
+    devicePtr->infoFd = devicePtr->fd;
+    snprintf(devicePtr->info, sizeof(devicePtr->info), "%d", devicePtr->fd);
 
-        passwd = getpwuid(fdStats.st_uid);
-        group = getgrgid(fdStats.st_gid);
-
-        DevInfo.major = major(fdStats.st_rdev);
-        DevInfo.minor = minor(fdStats.st_rdev);
-        snprintf(DevInfo.uName, sizeof(DevInfo.uName), "%s", passwd->pw_name);
-        snprintf(DevInfo.gName, sizeof(DevInfo.gName), "%s", group->gr_name);
-        snprintf(DevInfo.devInfoStr, sizeof(DevInfo.devInfoStr), "%s, %s [%u, %u], (u: %s, g: %s)",
-            DevInfo.fdSysPath,
-            DevInfo.linkName,
-            DevInfo.major,
-            DevInfo.minor,
-            DevInfo.uName,
-            DevInfo.gName);
+    // build the path to fd
+    snprintf(fdSysPath, sizeof(fdSysPath), "/proc/%d/fd/%d", getpid(), devicePtr->fd);
 
-        return LE_OK;
+    // get device path
+    ssize_t len = readlink(fdSysPath, linkName, sizeof(linkName));
+    if (len < 0)
+    {
+        LE_ERROR("readlink failed %s", StrError(errno));
+        return devicePtr->info;
+    }
+    else if (len >= sizeof(linkName))
+    {
+        LE_ERROR("Too long path. Max allowed: %zd", sizeof(linkName)-1);
+        return devicePtr->info;
+    }
+    linkName[len] = '\0';
+
+    // try to get device stats
+    if (fstat(devicePtr->fd, &fdStats) == -1)
+    {
+        LE_ERROR("fstat failed %s", StrError(errno));
+        return devicePtr->info;
     }
 
-    return LE_FAULT;
+    passwd = getpwuid(fdStats.st_uid);
+    group = getgrgid(fdStats.st_gid);
+
+    snprintf(devicePtr->info, sizeof(devicePtr->info), "%s, %s [%u, %u], (u: %s, g: %s)",
+        fdSysPath,
+        linkName,
+        major(fdStats.st_rdev),
+        minor(fdStats.st_rdev),
+        passwd ? passwd->pw_name : "?",
+        group ? group->gr_name : "?");
+
+    return devicePtr->info;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * This function must be called to print a buffer byte by byte
+ * Trace the data exchanged on a device, with its special characters made visible
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void PrintBuffer
+static void TraceData
 (
-    int32_t   fd,            ///< The file descriptor
-    uint8_t*  bufferPtr,     ///< the buffer to print
-    uint32_t  bufferSize     ///< Number of element to print
+    Device_t*           devicePtr,    ///< device pointer
+    const char*         directionPtr, ///< Direction of the data
+    const struct iovec* iovPtr,       ///< Buffers to trace
+    int                 iovCount,     ///< Number of buffers
+    size_t              size          ///< Number of bytes to trace
 )
 {
-    if(le_log_GetFilterLevel() == LE_LOG_DEBUG)
-    {
-        uint32_t i;
-        uint32_t dataLen = 1;
-        DevInfo.fd = fd;
+    char string[TRACE_MAX_BYTES];
+    size_t len = 0;
+    int i;
 
-        for(i=0;i<bufferSize;i++)
-        {
-            if (bufferPtr[i] == '\r' )
-            {
-                dataLen+=4;
-            }
-            else if (bufferPtr[i] == '\n')
-            {
-                dataLen+=4;
-            }
-            else if (bufferPtr[i] == 0x1A)
-            {
-                dataLen+=8;
-            }
-            else
-            {
-                dataLen+=1;
-            }
-        }
+    for (i = 0; (i < iovCount) && (size > 0); i++)
+    {
+        const uint8_t* bufferPtr = iovPtr[i].iov_base;
+        size_t bufferSize = (iovPtr[i].iov_len < size) ? iovPtr[i].iov_len : size;
+        size_t j;
 
-        char string[dataLen];
-        memset(string, 0, dataLen);
+        size -= bufferSize;
 
-        for(i=0;i<bufferSize;i++)
+        for (j = 0; j < bufferSize; j++)
         {
-            if (bufferPtr[i] == '\r' )
+            const char* tokenPtr;
+            size_t tokenLen;
+
+            switch (bufferPtr[j])
             {
-                snprintf(string+strlen(string), dataLen-strlen(string), "<CR>");
+                case '\r':
+                    tokenPtr = "<CR>";
+                    break;
+                case '\n':
+                    tokenPtr = "<LF>";
+                    break;
+                case 0x1A:
+                    tokenPtr = "<CTRL+Z>";
+                    break;
+                default:
+                    tokenPtr = NULL;
+                    break;
             }
-            else if (bufferPtr[i] == '\n')
+            tokenLen = tokenPtr ? strlen(tokenPtr) : 1;
+
+            // Keep room for the truncation mark and the terminating null character
+            if ((len + tokenLen) > (sizeof(string) - 4))
             {
-                snprintf(string+strlen(string), dataLen-strlen(string), "<LF>");
+                memcpy(string + len, "...", 3);
+                len += 3;
+                goto done;
             }
-            else if (bufferPtr[i] == 0x1A)
+
+            if (tokenPtr)
             {
-                snprintf(string+strlen(string), dataLen-strlen(string), "<CTRL+Z>");
+                memcpy(string + len, tokenPtr, tokenLen);
             }
             else
             {
-                snprintf(string+strlen(string), dataLen-strlen(string), "%c", bufferPtr[i]);
+                string[len] = bufferPtr[j];
             }
-        }
-
-        if (GetDeviceInformation())
-        {
-            LE_DEBUG("'%d' -> %s", fd, string);
-        }
-        else
-        {
-            LE_DEBUG("'%s' -> %s", DevInfo.linkName, string);
+            len += tokenLen;
         }
     }
+
+done:
+    string[len] = '\0';
+    LE_DEBUG("'%s' %s %s", GetDeviceInformation(devicePtr), directionPtr, string);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -287,12 +283,6 @@ ssize_t le_dev_Read
         return -1;
     }
 
-    DevInfo.fd = devicePtr->fd;
-    if (!GetDeviceInformation())
-    {
-        LE_INFO("%s", DevInfo.devInfoStr);
-    }
-
     count = read(devicePtr->fd, rxDataPtr, size);
     if (-1 == count)
     {
@@ -300,7 +290,11 @@ ssize_t le_dev_Read
         return -1;
     }
 
-    PrintBuffer(devicePtr->fd, rxDataPtr, count);
+    if (IsTraceEnabled())
+    {
+        struct iovec iov = { .iov_base = rxDataPtr, .iov_len = count };
+        TraceData(devicePtr, "<-", &iov, 1, count);
+    }
 
     return count;
 }
@@ -320,48 +314,78 @@ int32_t le_dev_Write
     uint32_t    size          ///< size of buffer
 )
 {
-    int32_t amount = 0;
-    size_t currentSize;
-    size_t sizeToWrite;
-    ssize_t sizeWritten;
+    struct iovec iov = { .iov_base = txDataPtr, .iov_len = size };
 
-    DevInfo.fd = devicePtr->fd;
-    if (!GetDeviceInformation())
-    {
-        LE_DEBUG("%s", DevInfo.devInfoStr);
-    }
+    return le_dev_WriteVec(devicePtr, &iov, 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to write several buffers on device (or port) in a single write
+ *
+ * @return written byte number
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t le_dev_WriteVec
+(
+    Device_t*           devicePtr,    ///< device pointer
+    const struct iovec* iovPtr,       ///< Buffers to write
+    int                 iovCount      ///< Number of buffers
+)
+{
+    struct iovec iov[WRITE_MAX_IOV];
+    int iovIndex = 0;
+    size_t currentSize = 0;
+    ssize_t sizeWritten;
 
     LE_FATAL_IF(devicePtr->fd==-1,"Write Handle error\n");
+    LE_FATAL_IF((iovCount < 0) || (iovCount > WRITE_MAX_IOV), "Bad buffer count %d", iovCount);
+
+    // Work on a copy, as partially written buffers are adjusted
+    memcpy(iov, iovPtr, iovCount * sizeof(struct iovec));
 
-    for(currentSize = 0; currentSize < size;)
+    while (iovIndex < iovCount)
     {
-        sizeToWrite = size - currentSize;
+        if (0 == iov[iovIndex].iov_len)
+        {
+            iovIndex++;
+            continue;
+        }
 
-        sizeWritten =
-            write(devicePtr->fd, &txDataPtr[currentSize], sizeToWrite);
+        sizeWritten = writev(devicePtr->fd, &iov[iovIndex], iovCount - iovIndex);
 
         if (sizeWritten < 0)
         {
             if ((errno != EINTR) && (errno != EAGAIN))
             {
                 LE_ERROR("Cannot write on fd: %s", StrError(errno));
-                return currentSize;
+                break;
             }
+            continue;
         }
-        else
+
+        currentSize += sizeWritten;
+
+        // Skip the buffers written entirely, and adjust the one written partially
+        while ((iovIndex < iovCount) && ((size_t)sizeWritten >= iov[iovIndex].iov_len))
         {
-            currentSize += sizeWritten;
+            sizeWritten -= iov[iovIndex].iov_len;
+            iovIndex++;
+        }
+
+        if (iovIndex < iovCount)
+        {
+            iov[iovIndex].iov_base = (uint8_t*)iov[iovIndex].iov_base + sizeWritten;
+            iov[iovIndex].iov_len -= sizeWritten;
         }
     }
 
-    if(currentSize > 0)
+    if (IsTraceEnabled())
     {
-        size  -= currentSize;
-        amount  += currentSize;
+        TraceData(devicePtr, "->", iovPtr, iovCount, currentSize);
     }
 
-    PrintBuffer(devicePtr->fd,txDataPtr,amount);
-
     return currentSize;
 }
 
@@ -382,12 +406,6 @@ le_result_t le_dev_AddFdMonitoring
     char monitorName[64];
     le_fdMonitor_Ref_t fdMonitorRef;
 
-    DevInfo.fd = devicePtr->fd;
-    if (!GetDeviceInformation())
-    {
-        LE_DEBUG("%s", DevInfo.devInfoStr);
-    }
-
     if (devicePtr->fdMonitor)
     {
         LE_WARN("Interface %d already started",devicePtr->fd);
@@ -415,9 +433,11 @@ le_result_t le_dev_AddFdMonitoring
 
     le_fdMonitor_SetContextPtr(fdMonitorRef, contextPtr);
 
-    if (le_log_GetFilterLevel() == LE_LOG_DEBUG)
+    if (IsTraceEnabled())
     {
         char threadName[25];
+
+        LE_DEBUG("%s", GetDeviceInformation(devicePtr));
         le_thread_GetName(le_thread_GetCurrent(), threadName, 25);
         LE_DEBUG("Resume %s with fd(%d)(%p) [%s]",
                  threadName,
@@ -442,12 +462,6 @@ void le_dev_RemoveFdMonitoring
     Device_t*   devicePtr
 )
 {
-    DevInfo.fd = devicePtr->fd;
-    if (!GetDeviceInformation())
-    {
-        LE_DEBUG("%s", DevInfo.devInfoStr);
-    }
-
     if (devicePtr->fdMonitor)
     {
         le_fdMonitor_Delete(devicePtr->fdMonitor);
@@ -8,16 +8,30 @@
 #ifndef LEGATO_LE_DEV_INCLUDE_GUARD
 #define LEGATO_LE_DEV_INCLUDE_GUARD
 
+#include <sys/uio.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the device description used in traces
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_DEV_INFO_MAX_BYTES   320
+
 //--------------------------------------------------------------------------------------------------
 /**
  * device structure
  *
+ * The structure must be zeroed before the fd is set.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct Device
 {
     int32_t            fd;                               ///< The file descriptor.
     le_fdMonitor_Ref_t fdMonitor;                        ///< fd event monitor associated to Handle
+    bool               hasInfo;                          ///< Is info computed for infoFd?
+    int32_t            infoFd;                           ///< fd info was computed for
+    char               info[LE_DEV_INFO_MAX_BYTES];      ///< Description of the device
 }
 Device_t;
 
@@ -49,6 +63,20 @@ int32_t le_dev_Write
     uint32_t    size          ///< size of buffer
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function must be called to write several buffers on device (or port) in a single write
+ *
+ * @return written byte number
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t le_dev_WriteVec
+(
+    Device_t*           devicePtr,    ///< device pointer
+    const struct iovec* iovPtr,       ///< Buffers to write
+    int                 iovCount      ///< Number of buffers
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This function must be called to monitor the specified file descriptor in the calling thread event
@@ -47,6 +47,29 @@
 //--------------------------------------------------------------------------------------------------
 #define RSP_POOL_SIZE       10
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of response lines buffered per device before being written
+ */
+//--------------------------------------------------------------------------------------------------
+#define OUTPUT_MAX_LINES    16
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of buffers of the output: each line is made of a leading CRLF, the response and a
+ * trailing CRLF
+ */
+//--------------------------------------------------------------------------------------------------
+#define OUTPUT_MAX_IOV      (OUTPUT_MAX_LINES * 3)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum delay in milliseconds before buffered intermediate responses are written, if the final
+ * response is not sent in the meantime
+ */
+//--------------------------------------------------------------------------------------------------
+#define OUTPUT_FLUSH_DELAY_MS   20
+
 //--------------------------------------------------------------------------------------------------
 /**
  * User-defined error strings pool size
@@ -688,6 +711,25 @@ typedef struct
 }
 Text_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Output buffer structure.
+ *
+ * Response lines are gathered here and written together, so that a whole response (intermediate
+ * responses and final result code) is sent in a single write. The buffers point to the response
+ * strings, which must stay valid until the output is flushed.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    struct iovec    iov[OUTPUT_MAX_IOV];    ///< Buffers waiting to be written
+    int             iovCount;               ///< Number of buffers waiting to be written
+    le_dls_List_t   rspList;                ///< Responses referenced by iov, released once written
+    le_timer_Ref_t  flushTimer;             ///< Timer writing delayed intermediate responses
+}
+Output_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Device context structure.
@@ -716,6 +758,7 @@ typedef struct
     bool                    suspended;                            ///< is device in data mode
     bool                    echo;                                 ///< is echo enabled
     Text_t                  text;                                 ///< text data
+    Output_t                output;                               ///< buffered output
 }
 DeviceContext_t;
 
@@ -866,10 +909,75 @@ static void AtCmdPoolDestructor
     le_ref_DeleteRef(SubscribedCmdRefMap, cmdPtr->cmdRef);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the buffered responses on the opened device, and release them.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushOutput
+(
+    DeviceContext_t* devPtr
+)
+{
+    Output_t* outputPtr = &devPtr->output;
+    le_dls_Link_t* linkPtr;
+
+    if (outputPtr->flushTimer && le_timer_IsRunning(outputPtr->flushTimer))
+    {
+        le_timer_Stop(outputPtr->flushTimer);
+    }
+
+    if (outputPtr->iovCount)
+    {
+        le_dev_WriteVec(&devPtr->device, outputPtr->iov, outputPtr->iovCount);
+        outputPtr->iovCount = 0;
+    }
+
+    while ((linkPtr = le_dls_Pop(&outputPtr->rspList)) != NULL)
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, RspString_t, link));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the buffered intermediate responses once the flush delay expired.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    FlushOutput((DeviceContext_t*)le_timer_GetContextPtr(timerRef));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a buffer to the output of the device.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void AddOutputBuffer
+(
+    Output_t* outputPtr,
+    const char* bufPtr,
+    size_t size
+)
+{
+    outputPtr->iov[outputPtr->iovCount].iov_base = (void*)bufPtr;
+    outputPtr->iov[outputPtr->iovCount].iov_len = size;
+    outputPtr->iovCount++;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Send a response on the opened device.
  *
+ * The response is buffered: it is written by the next FlushOutput(), and must stay valid until then.
+ *
  */
 //--------------------------------------------------------------------------------------------------
 static void SendRspString
@@ -878,20 +986,39 @@ static void SendRspString
     const char* rspPtr
 )
 {
-    char string[LE_ATDEFS_RESPONSE_MAX_BYTES+4] = {0};
+    static const char crlf[] = "\r\n";
+    Output_t* outputPtr = &devPtr->output;
+
+    if ((outputPtr->iovCount + 3) > OUTPUT_MAX_IOV)
+    {
+        FlushOutput(devPtr);
+    }
 
     if ((devPtr->rspState == AT_RSP_FINAL) || (devPtr->rspState == AT_RSP_UNSOLICITED) ||
         ((devPtr->rspState == AT_RSP_INTERMEDIATE) && devPtr->isFirstIntermediate))
     {
-        snprintf(string, LE_ATDEFS_RESPONSE_MAX_BYTES+4, "\r\n%s\r\n", rspPtr);
+        AddOutputBuffer(outputPtr, crlf, 2);
         devPtr->isFirstIntermediate = false;
     }
-    else
-    {
-        snprintf(string, LE_ATDEFS_RESPONSE_MAX_BYTES+2, "%s\r\n", rspPtr);
-    }
 
-    le_dev_Write(&devPtr->device, (uint8_t*)string, strlen(string));
+    AddOutputBuffer(outputPtr, rspPtr, strnlen(rspPtr, LE_ATDEFS_RESPONSE_MAX_BYTES));
+    AddOutputBuffer(outputPtr, crlf, 2);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a response string on the opened device. The response string is released once written.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendRspStringAndRelease
+(
+    DeviceContext_t* devPtr,
+    RspString_t* rspStringPtr
+)
+{
+    SendRspString(devPtr, rspStringPtr->resp);
+    le_dls_Queue(&devPtr->output.rspList, &rspStringPtr->link);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1103,9 +1230,6 @@ static void SendFinalRsp
 end_processing:
     devPtr->processing = false;
 
-    memset( &devPtr->cmdParser, 0, sizeof(CmdParser_t) );
-    memset( &devPtr->finalRsp, 0, sizeof(FinalRsp_t) );
-
     // Send backup unsolicited responses
     le_dls_Link_t* linkPtr;
 
@@ -1115,9 +1239,14 @@ end_processing:
                                     RspString_t,
                                     link);
 
-        SendRspString(devPtr, rspStringPtr->resp);
-        le_mem_Release(rspStringPtr);
+        SendRspStringAndRelease(devPtr, rspStringPtr);
     }
+
+    // Write the whole response at once, the final response is referenced until then
+    FlushOutput(devPtr);
+
+    memset( &devPtr->cmdParser, 0, sizeof(CmdParser_t) );
+    memset( &devPtr->finalRsp, 0, sizeof(FinalRsp_t) );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1156,8 +1285,13 @@ static void SendIntermediateRsp
         return;
     }
 
-    SendRspString(devPtr, rspStringPtr->resp);
-    le_mem_Release(rspStringPtr);
+    // Intermediate responses are written with the final response, unless it takes too long
+    SendRspStringAndRelease(devPtr, rspStringPtr);
+
+    if (!le_timer_IsRunning(devPtr->output.flushTimer))
+    {
+        le_timer_Start(devPtr->output.flushTimer);
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1189,8 +1323,8 @@ static void SendUnsolRsp
 
     if (!devPtr->processing && !devPtr->suspended)
     {
-        SendRspString(devPtr, rspStringPtr->resp);
-        le_mem_Release(rspStringPtr);
+        SendRspStringAndRelease(devPtr, rspStringPtr);
+        FlushOutput(devPtr);
     }
     else
     {
@@ -2144,6 +2278,7 @@ static void ParseBuffer
                     {
                         LE_ERROR("Command in progress");
                         SendRspString(devPtr, "ERROR");
+                        FlushOutput(devPtr);
                     }
 
                     devPtr->parseIndex=0;
@@ -2173,6 +2308,7 @@ static void ParseBuffer
         devPtr->indexRead = devPtr->parseIndex = 0;
         devPtr->cmdParser.rxState = PARSER_SEARCH_A;
         SendRspString(devPtr, "ERROR");
+        FlushOutput(devPtr);
     }
 }
 
@@ -2209,6 +2345,7 @@ static void ReceiveCmd
     // Echo is activated
     if (devPtr->echo)
     {
+        FlushOutput(devPtr);
         le_dev_Write(&devPtr->device,
                     (uint8_t *)(devPtr->currentCmd + devPtr->indexRead),
                     size);
@@ -2359,6 +2496,9 @@ static void ReceiveText
     char* bufPtr;
     void* ctxPtr;
 
+    // Keep the order of the output
+    FlushOutput(devPtr);
+
     textPtr = &devPtr->text;
     bufPtr = textPtr->buf + textPtr->offset;
     size = LE_ATDEFS_TEXT_MAX_LEN - textPtr->offset;
@@ -2518,6 +2658,8 @@ static le_result_t CloseServer
 
     LE_DEBUG("Stopping device %d", devPtr->device.fd);
 
+    FlushOutput(devPtr);
+
     le_dev_RemoveFdMonitoring(&devPtr->device);
 
     if (close(devPtr->device.fd))
@@ -2551,6 +2693,8 @@ static le_result_t CloseServer
 
     le_ref_DeleteRef(DevicesRefMap, devPtr->ref);
 
+    le_timer_Delete(devPtr->output.flushTimer);
+
     le_mem_Release(devPtr);
 
     return LE_OK;
@@ -2641,6 +2785,9 @@ le_result_t le_atServer_Suspend
         return LE_FAULT;
     }
 
+    // The application takes over the device: write what it expects to be sent already
+    FlushOutput(devPtr);
+
     le_dev_RemoveFdMonitoring(devicePtr);
 
     devPtr->suspended = true;
@@ -2835,6 +2982,12 @@ le_atServer_DeviceRef_t le_atServer_Open
     devPtr->ref = le_ref_CreateRef(DevicesRefMap, devPtr);
     devPtr->suspended = false;
 
+    devPtr->output.rspList = LE_DLS_LIST_INIT;
+    devPtr->output.flushTimer = le_timer_Create("AtServerFlushTimer");
+    le_timer_SetMsInterval(devPtr->output.flushTimer, OUTPUT_FLUSH_DELAY_MS);
+    le_timer_SetHandler(devPtr->output.flushTimer, FlushTimerHandler);
+    le_timer_SetContextPtr(devPtr->output.flushTimer, devPtr);
+
     LE_INFO("created device");
 
     return devPtr->ref;
@@ -3829,6 +3982,7 @@ le_result_t le_atServer_GetTextAsync
     devPtr->text.ctxPtr = ctxPtr;
     devPtr->text.cmdRef = cmdRef;
 
+    FlushOutput(devPtr);
     le_dev_Write(&devPtr->device, (uint8_t *)TEXT_PROMPT, TEXT_PROMPT_LEN);
 
     return LE_OK;
@@ -0,0 +1,1037 @@
+//--------------------------------------------------------------------------------------------------
+/** @file cfgCache.c
+ *
+ * Read transactions served from a local copy of a branch of the configuration tree.
+ *
+ * The copy is a Config Tree snapshot, sent by le_cfg_QuickGetSnapshot().  It is parsed into an
+ * array of nodes where the children of each stem are next to each other, with their names and
+ * values in a single string buffer, and an index of the children of each stem sorted by name so
+ * that paths are looked up with binary searches.
+ *
+ * The copies of the last CACHE_SIZE branches read are kept in a list, most recently used first.
+ * Copies are reference counted: the list holds a reference, and so does every transaction using
+ * the copy, so a copy replaced by a newer one stays valid until its last transaction ends.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "cfgCache.h"
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of branches whose copy is kept once their transactions have ended.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CACHE_SIZE                  8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start of a snapshot, and types of its nodes.  These must match the ones the Config Tree writes,
+ * see treeDb.c.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SNAPSHOT_MAGIC              "\x89" "LECFG1\n"
+#define SNAPSHOT_MAGIC_BYTES        (sizeof(SNAPSHOT_MAGIC) - 1)
+
+typedef enum
+{
+    SNAPSHOT_EMPTY  = 0,    ///< Node without any value.
+    SNAPSHOT_BOOL   = 1,    ///< Boolean value, "t" or "f".
+    SNAPSHOT_INT    = 2,    ///< Signed integer.
+    SNAPSHOT_FLOAT  = 3,    ///< Floating point number.
+    SNAPSHOT_STRING = 4,    ///< UTF-8 text string.
+    SNAPSHOT_STEM   = 5     ///< Node with children.
+}
+SnapshotType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deepest a snapshot can be.  A node deeper than this could not have a path.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_DEPTH                   (LE_CFG_STR_LEN_BYTES / 2)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A node of a copy of a branch.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;            ///< Name of the node.
+    const char* valuePtr;           ///< Value of the node, NULL if it has none.
+    le_cfg_nodeType_t type;         ///< Type of the node.
+    uint32_t firstChild;            ///< Index of the node's first child, if it's a stem.
+    uint32_t childCount;            ///< Number of children of the node.
+}
+Node_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A copy of a branch of the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_dls_Link_t link;                         ///< Link in the cache, if it's in it.
+    char basePath[LE_CFG_STR_LEN_BYTES];        ///< Path to the base of the branch.
+    uint32_t revision;                          ///< Revision of the tree the copy was taken at.
+    Node_t* nodesPtr;                           ///< The nodes, the base node first.
+    uint32_t nodeCount;                         ///< Number of nodes.
+    Node_t** sortedPtr;                         ///< Same as the nodes, except that the children
+                                                ///<   of each stem are sorted by name.
+    char* stringsPtr;                           ///< Names and values of the nodes.
+}
+Snapshot_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A cached read transaction.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct cfgCache_Txn
+{
+    Snapshot_t* snapshotPtr;                    ///< Copy the transaction reads from.
+}
+Txn_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State of the parsing of a snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const uint8_t* dataPtr;                     ///< The snapshot.
+    size_t size;                                ///< Size of the snapshot, in bytes.
+    size_t offset;                              ///< Offset of the next byte to parse.
+    Snapshot_t* snapshotPtr;                    ///< Copy being built.
+    uint32_t nodeCapacity;                      ///< Number of nodes that fit the node array.
+    char* nextStringPtr;                        ///< Where to copy the next name or value.
+}
+Parser_t;
+
+
+static le_mem_PoolRef_t SnapshotPool;
+static le_mem_PoolRef_t TxnPool;
+
+
+/// Copies kept, most recently used first, and how many there are.  Protected by CacheMutex.
+static le_dls_List_t Cache = LE_DLS_LIST_INIT;
+static size_t CacheCount = 0;
+static le_mutex_Ref_t CacheMutex;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor of the copies, called when their last reference is released.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SnapshotDestructor
+(
+    void* objPtr
+)
+{
+    Snapshot_t* snapshotPtr = objPtr;
+
+    free(snapshotPtr->nodesPtr);
+    free(snapshotPtr->sortedPtr);
+    free(snapshotPtr->stringsPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a little endian number from a snapshot.
+ *
+ * @return true if the number was read, false if the snapshot is too short.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadNumber
+(
+    Parser_t* parserPtr,                ///< [IN] Parser.
+    size_t byteCount,                   ///< [IN] Size of the number, in bytes (1 to 4).
+    uint32_t* valuePtr                  ///< [OUT] The number.
+)
+{
+    if (parserPtr->size - parserPtr->offset < byteCount)
+    {
+        return false;
+    }
+
+    *valuePtr = 0;
+
+    for (size_t i = 0; i < byteCount; i++)
+    {
+        *valuePtr |= (uint32_t)parserPtr->dataPtr[parserPtr->offset + i] << (8 * i);
+    }
+
+    parserPtr->offset += byteCount;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a string from a snapshot, and copy it to the copy's string buffer.
+ *
+ * @return The copy of the string, or NULL if it's too long or the snapshot is too short.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* ReadString
+(
+    Parser_t* parserPtr,                ///< [IN] Parser.
+    size_t maxSize                      ///< [IN] Maximum size of the string, with its terminator.
+)
+{
+    uint32_t length;
+
+    if (   (ReadNumber(parserPtr, 2, &length) == false)
+        || (length >= maxSize)
+        || (parserPtr->size - parserPtr->offset < length))
+    {
+        return NULL;
+    }
+
+    // The string buffer is as big as the snapshot, and a string and its terminator are smaller
+    // than the string and its length in the snapshot, so this fits.
+    char* stringPtr = parserPtr->nextStringPtr;
+
+    memcpy(stringPtr, parserPtr->dataPtr + parserPtr->offset, length);
+    stringPtr[length] = '\0';
+
+    parserPtr->offset += length;
+    parserPtr->nextStringPtr += length + 1;
+
+    return stringPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a node of a snapshot, and its children.  The node's name is already set.
+ *
+ * @return true if the node was parsed, false if the snapshot is not valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ParseNode
+(
+    Parser_t* parserPtr,                ///< [IN] Parser.
+    uint32_t index,                     ///< [IN] Index of the node.
+    size_t depth                        ///< [IN] Depth of the node, 0 for the base node.
+)
+{
+    Snapshot_t* snapshotPtr = parserPtr->snapshotPtr;
+    uint32_t type;
+
+    if (   (depth > MAX_DEPTH)
+        || (ReadNumber(parserPtr, 1, &type) == false))
+    {
+        return false;
+    }
+
+    // Node pointers aren't kept across the parsing of the children, because the node array may
+    // move when it grows.
+    Node_t* nodePtr = &snapshotPtr->nodesPtr[index];
+
+    nodePtr->valuePtr = NULL;
+    nodePtr->firstChild = 0;
+    nodePtr->childCount = 0;
+
+    switch (type)
+    {
+        case SNAPSHOT_EMPTY:
+            nodePtr->type = LE_CFG_TYPE_EMPTY;
+            return true;
+
+        case SNAPSHOT_BOOL:
+            nodePtr->type = LE_CFG_TYPE_BOOL;
+            break;
+
+        case SNAPSHOT_INT:
+            nodePtr->type = LE_CFG_TYPE_INT;
+            break;
+
+        case SNAPSHOT_FLOAT:
+            nodePtr->type = LE_CFG_TYPE_FLOAT;
+            break;
+
+        case SNAPSHOT_STRING:
+            nodePtr->type = LE_CFG_TYPE_STRING;
+            break;
+
+        case SNAPSHOT_STEM:
+            {
+                uint32_t childCount;
+
+                nodePtr->type = LE_CFG_TYPE_STEM;
+
+                // Each child takes at least 3 bytes: an empty name and a type.
+                if (   (ReadNumber(parserPtr, 4, &childCount) == false)
+                    || (childCount > (parserPtr->size - parserPtr->offset) / 3))
+                {
+                    return false;
+                }
+
+                uint32_t firstChild = snapshotPtr->nodeCount;
+
+                if (firstChild + childCount > parserPtr->nodeCapacity)
+                {
+                    while (firstChild + childCount > parserPtr->nodeCapacity)
+                    {
+                        parserPtr->nodeCapacity *= 2;
+                    }
+
+                    snapshotPtr->nodesPtr = realloc(snapshotPtr->nodesPtr,
+                                                    parserPtr->nodeCapacity * sizeof(Node_t));
+                    LE_ASSERT(snapshotPtr->nodesPtr != NULL);
+                    nodePtr = &snapshotPtr->nodesPtr[index];
+                }
+
+                nodePtr->firstChild = firstChild;
+                nodePtr->childCount = childCount;
+                snapshotPtr->nodeCount += childCount;
+
+                for (uint32_t i = 0; i < childCount; i++)
+                {
+                    const char* namePtr = ReadString(parserPtr, LE_CFG_NAME_LEN_BYTES);
+
+                    if (namePtr == NULL)
+                    {
+                        return false;
+                    }
+
+                    snapshotPtr->nodesPtr[firstChild + i].namePtr = namePtr;
+
+                    if (ParseNode(parserPtr, firstChild + i, depth + 1) == false)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+
+        default:
+            return false;
+    }
+
+    nodePtr->valuePtr = ReadString(parserPtr, LE_CFG_STR_LEN_BYTES);
+
+    return nodePtr->valuePtr != NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare the names of two nodes, for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareNodeNames
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const Node_t* aNodePtr = *(Node_t* const*)aPtr;
+    const Node_t* bNodePtr = *(Node_t* const*)bPtr;
+
+    return strcmp(aNodePtr->namePtr, bNodePtr->namePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the index of the children of each stem, sorted by name.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SortChildren
+(
+    Snapshot_t* snapshotPtr
+)
+{
+    snapshotPtr->sortedPtr = malloc(snapshotPtr->nodeCount * sizeof(Node_t*));
+    LE_ASSERT(snapshotPtr->sortedPtr != NULL);
+
+    for (uint32_t i = 0; i < snapshotPtr->nodeCount; i++)
+    {
+        snapshotPtr->sortedPtr[i] = &snapshotPtr->nodesPtr[i];
+    }
+
+    for (uint32_t i = 0; i < snapshotPtr->nodeCount; i++)
+    {
+        const Node_t* nodePtr = &snapshotPtr->nodesPtr[i];
+
+        if (nodePtr->childCount > 1)
+        {
+            qsort(&snapshotPtr->sortedPtr[nodePtr->firstChild],
+                  nodePtr->childCount,
+                  sizeof(Node_t*),
+                  CompareNodeNames);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load a copy of a branch from the file it was sent in.
+ *
+ * @return The copy, or NULL if the file is not a valid snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+static Snapshot_t* LoadSnapshot
+(
+    int fd,                             ///< [IN] File holding the snapshot.
+    const char* basePathPtr,            ///< [IN] Path to the base of the branch.
+    uint32_t revision                   ///< [IN] Revision of the tree the copy was taken at.
+)
+{
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat) == -1)
+    {
+        LE_ERROR("Could not read the snapshot of '%s', reason: %m", basePathPtr);
+        return NULL;
+    }
+
+    size_t size = fileStat.st_size;
+
+    if (size < SNAPSHOT_MAGIC_BYTES)
+    {
+        LE_ERROR("The snapshot of '%s' is truncated.", basePathPtr);
+        return NULL;
+    }
+
+    void* mapPtr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("Could not map the snapshot of '%s', reason: %m", basePathPtr);
+        return NULL;
+    }
+
+    Snapshot_t* snapshotPtr = le_mem_ForceAlloc(SnapshotPool);
+
+    memset(snapshotPtr, 0, sizeof(*snapshotPtr));
+    snapshotPtr->link = LE_DLS_LINK_INIT;
+    snapshotPtr->revision = revision;
+    LE_ASSERT(le_utf8_Copy(snapshotPtr->basePath,
+                           basePathPtr,
+                           sizeof(snapshotPtr->basePath),
+                           NULL) == LE_OK);
+
+    Parser_t parser =
+        {
+            .dataPtr = mapPtr,
+            .size = size,
+            .offset = SNAPSHOT_MAGIC_BYTES,
+            .snapshotPtr = snapshotPtr,
+            .nodeCapacity = 64
+        };
+
+    snapshotPtr->nodesPtr = malloc(parser.nodeCapacity * sizeof(Node_t));
+    snapshotPtr->stringsPtr = malloc(size);
+    LE_ASSERT((snapshotPtr->nodesPtr != NULL) && (snapshotPtr->stringsPtr != NULL));
+
+    parser.nextStringPtr = snapshotPtr->stringsPtr;
+
+    snapshotPtr->nodeCount = 1;
+    snapshotPtr->nodesPtr[0].namePtr = "";
+
+    bool isValid =    (memcmp(mapPtr, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_BYTES) == 0)
+                   && ParseNode(&parser, 0, 0)
+                   && (parser.offset == size);
+
+    munmap(mapPtr, size);
+
+    if (!isValid)
+    {
+        LE_ERROR("The snapshot of '%s' is not valid.", basePathPtr);
+        le_mem_Release(snapshotPtr);
+        return NULL;
+    }
+
+    SortChildren(snapshotPtr);
+
+    return snapshotPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the copy of a branch in the cache.  The cache must be locked.
+ *
+ * @return The copy, or NULL if it's not in the cache.
+ */
+//--------------------------------------------------------------------------------------------------
+static Snapshot_t* FindCachedSnapshot
+(
+    const char* basePathPtr
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&Cache);
+
+    while (linkPtr != NULL)
+    {
+        Snapshot_t* snapshotPtr = CONTAINER_OF(linkPtr, Snapshot_t, link);
+
+        if (strcmp(snapshotPtr->basePath, basePathPtr) == 0)
+        {
+            return snapshotPtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&Cache, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a copy from the cache, and release the cache's reference to it.  The cache must be
+ * locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveCachedSnapshot
+(
+    Snapshot_t* snapshotPtr
+)
+{
+    le_dls_Remove(&Cache, &snapshotPtr->link);
+    CacheCount--;
+
+    le_mem_Release(snapshotPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put a new copy at the head of the cache, replacing any older copy of the same branch, and drop
+ * the least recently used copy if the cache is full.  The cache must be locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddCachedSnapshot
+(
+    Snapshot_t* snapshotPtr
+)
+{
+    Snapshot_t* oldSnapshotPtr = FindCachedSnapshot(snapshotPtr->basePath);
+
+    if (oldSnapshotPtr != NULL)
+    {
+        RemoveCachedSnapshot(oldSnapshotPtr);
+    }
+    else if (CacheCount == CACHE_SIZE)
+    {
+        RemoveCachedSnapshot(CONTAINER_OF(le_dls_PeekTail(&Cache), Snapshot_t, link));
+    }
+
+    le_mem_AddRef(snapshotPtr);
+    le_dls_Stack(&Cache, &snapshotPtr->link);
+    CacheCount++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a copy of a branch, the cached one if it's still current, a new one otherwise.
+ *
+ * @return The copy, with a reference for the caller, or NULL if it could not be made.
+ */
+//--------------------------------------------------------------------------------------------------
+static Snapshot_t* GetSnapshot
+(
+    const char* basePathPtr
+)
+{
+    for (;;)
+    {
+        uint32_t knownRevision = 0;
+        uint32_t revision = 0;
+        int fd = -1;
+
+        le_mutex_Lock(CacheMutex);
+
+        Snapshot_t* snapshotPtr = FindCachedSnapshot(basePathPtr);
+
+        if (snapshotPtr != NULL)
+        {
+            knownRevision = snapshotPtr->revision;
+        }
+
+        le_mutex_Unlock(CacheMutex);
+
+        le_result_t result = le_cfg_QuickGetSnapshot(basePathPtr, knownRevision, &revision, &fd);
+
+        if (result == LE_DUPLICATE)
+        {
+            le_mutex_Lock(CacheMutex);
+
+            snapshotPtr = FindCachedSnapshot(basePathPtr);
+
+            if (   (snapshotPtr != NULL)
+                && (snapshotPtr->revision == revision))
+            {
+                le_mem_AddRef(snapshotPtr);
+
+                le_dls_Remove(&Cache, &snapshotPtr->link);
+                le_dls_Stack(&Cache, &snapshotPtr->link);
+            }
+            else
+            {
+                snapshotPtr = NULL;
+            }
+
+            le_mutex_Unlock(CacheMutex);
+
+            if (snapshotPtr != NULL)
+            {
+                return snapshotPtr;
+            }
+
+            // Another thread replaced or dropped the copy in the meantime, so ask for a new one.
+            continue;
+        }
+
+        if (   (result != LE_OK)
+            || (fd < 0))
+        {
+            LE_ERROR("Could not get a copy of '%s', result: %s.", basePathPtr, LE_RESULT_TXT(result));
+
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            return NULL;
+        }
+
+        snapshotPtr = LoadSnapshot(fd, basePathPtr, revision);
+        close(fd);
+
+        if (snapshotPtr != NULL)
+        {
+            le_mutex_Lock(CacheMutex);
+            AddCachedSnapshot(snapshotPtr);
+            le_mutex_Unlock(CacheMutex);
+        }
+
+        return snapshotPtr;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a child of a node by name.
+ *
+ * @return The child, or NULL if the node has no such child.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Node_t* FindChild
+(
+    const Snapshot_t* snapshotPtr,
+    const Node_t* nodePtr,
+    const char* namePtr,                ///< [IN] Name of the child, not terminated.
+    size_t nameLength                   ///< [IN] Length of the name.
+)
+{
+    Node_t* const* childrenPtr = &snapshotPtr->sortedPtr[nodePtr->firstChild];
+    size_t low = 0;
+    size_t high = nodePtr->childCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        const char* middleNamePtr = childrenPtr[middle]->namePtr;
+        int compare = strncmp(middleNamePtr, namePtr, nameLength);
+
+        if (   (compare == 0)
+            && (middleNamePtr[nameLength] != '\0'))
+        {
+            compare = 1;
+        }
+
+        if (compare == 0)
+        {
+            return childrenPtr[middle];
+        }
+        else if (compare < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a node of a transaction's copy.  The process is killed if the path leaves the branch.
+ *
+ * @return The node, or NULL if there is no such node.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Node_t* FindNode
+(
+    cfgCache_TxnRef_t txnRef,
+    const char* pathPtr
+)
+{
+    LE_ASSERT(txnRef != NULL);
+
+    const Snapshot_t* snapshotPtr = txnRef->snapshotPtr;
+    const Node_t* nodePtr = &snapshotPtr->nodesPtr[0];
+
+    LE_FATAL_IF(pathPtr[0] == '/',
+                "Cached read transactions can't read absolute paths, like '%s'.",
+                pathPtr);
+
+    while ((*pathPtr != '\0') && (nodePtr != NULL))
+    {
+        size_t length = strcspn(pathPtr, "/");
+
+        LE_FATAL_IF((length == 2) && (strncmp(pathPtr, "..", 2) == 0),
+                    "Cached read transactions can't read outside of '%s'.",
+                    snapshotPtr->basePath);
+
+        if (   (length > 1)
+            || ((length == 1) && (pathPtr[0] != '.')))
+        {
+            nodePtr = FindChild(snapshotPtr, nodePtr, pathPtr, length);
+        }
+
+        pathPtr += length;
+
+        if (*pathPtr == '/')
+        {
+            pathPtr++;
+        }
+    }
+
+    return nodePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a cached read transaction on a branch of the configuration tree.
+ *
+ * @note
+ *      A base node that is empty and one that doesn't exist can't be told apart, both are
+ *      reported as empty.
+ *
+ * @return
+ *      Reference to the transaction, or NULL if the copy of the branch could not be made.
+ */
+//--------------------------------------------------------------------------------------------------
+cfgCache_TxnRef_t cfgCache_CreateReadTxn
+(
+    const char* basePathPtr             ///< [IN] Path to the base of the branch, with the tree
+                                        ///<      name if it's not the default tree.
+)
+{
+    Snapshot_t* snapshotPtr = GetSnapshot(basePathPtr);
+
+    if (snapshotPtr == NULL)
+    {
+        return NULL;
+    }
+
+    Txn_t* txnPtr = le_mem_ForceAlloc(TxnPool);
+    txnPtr->snapshotPtr = snapshotPtr;
+
+    return txnPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End a cached read transaction.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgCache_CancelTxn
+(
+    cfgCache_TxnRef_t txnRef            ///< [IN] Transaction to end.
+)
+{
+    LE_ASSERT(txnRef != NULL);
+
+    le_mem_Release(txnRef->snapshotPtr);
+    le_mem_Release(txnRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a node.
+ *
+ * @return
+ *      The node's type, or LE_CFG_TYPE_DOESNT_EXIST if there is no such node.
+ */
+//--------------------------------------------------------------------------------------------------
+le_cfg_nodeType_t cfgCache_GetNodeType
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    return (nodePtr != NULL) ? nodePtr->type : LE_CFG_TYPE_DOESNT_EXIST;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a node exists.
+ *
+ * @return
+ *      true if the node exists, false if not.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cfgCache_NodeExists
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+)
+{
+    return FindNode(txnRef, pathPtr) != NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a node has no value.  A stem, or a node that doesn't exist, has no value.
+ *
+ * @return
+ *      true if the node has no value, false if it has one.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cfgCache_IsEmpty
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    return (nodePtr == NULL) || (nodePtr->valuePtr == NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as a string, like le_cfg_GetString().  The default value is used if the node
+ * has no value.
+ *
+ * @return
+ *      - LE_OK if the value was read.
+ *      - LE_OVERFLOW if the value was truncated to fit the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgCache_GetString
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    char* bufferPtr,                    ///< [OUT] Buffer to copy the value into.
+    size_t bufferSize,                  ///< [IN] Size of the buffer, in bytes.
+    const char* defaultValuePtr         ///< [IN] Value to use if the node has no value.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    if (   (nodePtr == NULL)
+        || (nodePtr->valuePtr == NULL))
+    {
+        return le_utf8_Copy(bufferPtr, defaultValuePtr, bufferSize, NULL);
+    }
+
+    return le_utf8_Copy(bufferPtr, nodePtr->valuePtr, bufferSize, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as an integer, like le_cfg_GetInt().  Floating point values are rounded.
+ * The default value is used if the node is neither an integer nor a floating point number.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t cfgCache_GetInt
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    int32_t defaultValue                ///< [IN] Value to use if the node has no number.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    if (nodePtr == NULL)
+    {
+        return defaultValue;
+    }
+
+    switch (nodePtr->type)
+    {
+        case LE_CFG_TYPE_INT:
+            return atoi(nodePtr->valuePtr);
+
+        case LE_CFG_TYPE_FLOAT:
+            {
+                double value = atof(nodePtr->valuePtr);
+                return (int32_t)(value >= 0.0 ? value + 0.5 : value - 0.5);
+            }
+
+        default:
+            return defaultValue;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as a floating point number, like le_cfg_GetFloat().  The default value is
+ * used if the node is neither an integer nor a floating point number.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+double cfgCache_GetFloat
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    double defaultValue                 ///< [IN] Value to use if the node has no number.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    if (nodePtr == NULL)
+    {
+        return defaultValue;
+    }
+
+    switch (nodePtr->type)
+    {
+        case LE_CFG_TYPE_INT:
+            return atoi(nodePtr->valuePtr);
+
+        case LE_CFG_TYPE_FLOAT:
+            return atof(nodePtr->valuePtr);
+
+        default:
+            return defaultValue;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as a boolean, like le_cfg_GetBool().  The default value is used if the node
+ * is not a boolean.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cfgCache_GetBool
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    bool defaultValue                   ///< [IN] Value to use if the node is not a boolean.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    if (   (nodePtr == NULL)
+        || (nodePtr->type != LE_CFG_TYPE_BOOL))
+    {
+        return defaultValue;
+    }
+
+    return strcmp(nodePtr->valuePtr, "f") != 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of children of a node.
+ *
+ * @return
+ *      The number of children, 0 if the node is not a stem.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t cfgCache_GetChildCount
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    return (nodePtr != NULL) ? nodePtr->childCount : 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of a child of a node.  Children are in the order a le_cfg iterator visits them.
+ *
+ * @return
+ *      - LE_OK if the name was read.
+ *      - LE_NOT_FOUND if the node has no child at that index.
+ *      - LE_OVERFLOW if the name doesn't fit the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgCache_GetChildName
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    size_t index,                       ///< [IN] Index of the child, from 0.
+    char* bufferPtr,                    ///< [OUT] Buffer to copy the name into.
+    size_t bufferSize                   ///< [IN] Size of the buffer, in bytes.
+)
+{
+    const Node_t* nodePtr = FindNode(txnRef, pathPtr);
+
+    if (   (nodePtr == NULL)
+        || (index >= nodePtr->childCount))
+    {
+        return LE_NOT_FOUND;
+    }
+
+    const Node_t* childPtr = &txnRef->snapshotPtr->nodesPtr[nodePtr->firstChild + index];
+
+    return le_utf8_Copy(bufferPtr, childPtr->namePtr, bufferSize, NULL);
+}
+
+
+COMPONENT_INIT
+{
+    SnapshotPool = le_mem_CreatePool("CfgCacheSnapshots", sizeof(Snapshot_t));
+    le_mem_SetDestructor(SnapshotPool, SnapshotDestructor);
+
+    TxnPool = le_mem_CreatePool("CfgCacheTxns", sizeof(Txn_t));
+
+    CacheMutex = le_mutex_CreateNonRecursive("CfgCache");
+}
@@ -0,0 +1,221 @@
+//--------------------------------------------------------------------------------------------------
+/** @file cfgCache.h
+ *
+ * Read transactions served from a local copy of a branch of the configuration tree.
+ *
+ * Each get in a le_cfg read transaction is a round trip to the Config Tree.  A cached read
+ * transaction instead gets a copy of the whole branch under its base path in a single message, and
+ * all of its gets are served from that copy.  The copies of the last few branches read are kept,
+ * and the next transaction on the same branch reuses the copy if the tree hasn't changed since,
+ * which the Config Tree tells from the tree's revision.
+ *
+ * Like a le_cfg read transaction, a cached read transaction sees the branch as it was when the
+ * transaction was created.  Unlike one, it doesn't block writes to the tree, and it doesn't time
+ * out.
+ *
+ * Paths given to the gets are relative to the transaction's base path, and can't leave it: "/" at
+ * the start of a path and ".." are not allowed.
+ *
+ * The functions of this API can be called from any thread connected to the le_cfg service.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_CFG_CACHE_INCLUDE_GUARD
+#define LEGATO_CFG_CACHE_INCLUDE_GUARD
+
+#include "legato.h"
+#include "interfaces.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a cached read transaction.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct cfgCache_Txn* cfgCache_TxnRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a cached read transaction on a branch of the configuration tree.
+ *
+ * @note
+ *      A base node that is empty and one that doesn't exist can't be told apart, both are
+ *      reported as empty.
+ *
+ * @return
+ *      Reference to the transaction, or NULL if the copy of the branch could not be made.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED cfgCache_TxnRef_t cfgCache_CreateReadTxn
+(
+    const char* basePathPtr             ///< [IN] Path to the base of the branch, with the tree
+                                        ///<      name if it's not the default tree.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * End a cached read transaction.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void cfgCache_CancelTxn
+(
+    cfgCache_TxnRef_t txnRef            ///< [IN] Transaction to end.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the type of a node.
+ *
+ * @return
+ *      The node's type, or LE_CFG_TYPE_DOESNT_EXIST if there is no such node.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_cfg_nodeType_t cfgCache_GetNodeType
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a node exists.
+ *
+ * @return
+ *      true if the node exists, false if not.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED bool cfgCache_NodeExists
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a node has no value.  A stem, or a node that doesn't exist, has no value.
+ *
+ * @return
+ *      true if the node has no value, false if it has one.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED bool cfgCache_IsEmpty
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as a string, like le_cfg_GetString().  The default value is used if the node
+ * has no value.
+ *
+ * @return
+ *      - LE_OK if the value was read.
+ *      - LE_OVERFLOW if the value was truncated to fit the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t cfgCache_GetString
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    char* bufferPtr,                    ///< [OUT] Buffer to copy the value into.
+    size_t bufferSize,                  ///< [IN] Size of the buffer, in bytes.
+    const char* defaultValuePtr         ///< [IN] Value to use if the node has no value.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as an integer, like le_cfg_GetInt().  Floating point values are rounded.
+ * The default value is used if the node is neither an integer nor a floating point number.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED int32_t cfgCache_GetInt
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    int32_t defaultValue                ///< [IN] Value to use if the node has no number.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as a floating point number, like le_cfg_GetFloat().  The default value is
+ * used if the node is neither an integer nor a floating point number.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED double cfgCache_GetFloat
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    double defaultValue                 ///< [IN] Value to use if the node has no number.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node's value as a boolean, like le_cfg_GetBool().  The default value is used if the node
+ * is not a boolean.
+ *
+ * @return
+ *      The value.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED bool cfgCache_GetBool
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    bool defaultValue                   ///< [IN] Value to use if the node is not a boolean.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of children of a node.
+ *
+ * @return
+ *      The number of children, 0 if the node is not a stem.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED size_t cfgCache_GetChildCount
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr                 ///< [IN] Path to the node, "" for the base node.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the name of a child of a node.  Children are in the order a le_cfg iterator visits them.
+ *
+ * @return
+ *      - LE_OK if the name was read.
+ *      - LE_NOT_FOUND if the node has no child at that index.
+ *      - LE_OVERFLOW if the name doesn't fit the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t cfgCache_GetChildName
+(
+    cfgCache_TxnRef_t txnRef,           ///< [IN] Transaction to read from.
+    const char* pathPtr,                ///< [IN] Path to the node, "" for the base node.
+    size_t index,                       ///< [IN] Index of the child, from 0.
+    char* bufferPtr,                    ///< [OUT] Buffer to copy the name into.
+    size_t bufferSize                   ///< [IN] Size of the buffer, in bytes.
+);
+
+
+#endif // LEGATO_CFG_CACHE_INCLUDE_GUARD
@@ -0,0 +1,331 @@
+//--------------------------------------------------------------------------------------------------
+/** @file gnssSnapshot.c
+ *
+ * Client side helpers to decode GNSS position snapshots and to read the positioning daemon's
+ * shared sample ring.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "gnssSnapshot.h"
+#include <sys/mman.h>
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of times a reader retries to copy a slot that is being written before giving up.
+ */
+//--------------------------------------------------------------------------------------------------
+#define READ_RETRY_MAX          8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mapped shared sample ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_gnssSnapshot_RingMap
+{
+    const le_gnssSnapshot_Ring_t* ringPtr;  ///< Mapped ring.
+    size_t                        mapSize;  ///< Size of the mapping.
+}
+RingMap_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool for the mapped rings.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t RingMapPool = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy one slot using its sequence lock.
+ *
+ * @return
+ *  - LE_OK            The sample was copied.
+ *  - LE_OVERFLOW      The slot does not hold the expected sample anymore.
+ *  - LE_BUSY          The writer kept overwriting the slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadSlot
+(
+    const le_gnssSnapshot_Ring_t* ringPtr,
+    uint32_t seq,
+    le_gnssSnapshot_Sample_t* samplePtr
+)
+{
+    const le_gnssSnapshot_Slot_t* slotPtr = &ringPtr->slots[(seq / 2) % ringPtr->slotCount];
+    int retry;
+
+    for (retry = 0; retry < READ_RETRY_MAX; retry++)
+    {
+        uint32_t before = slotPtr->seq;
+        __sync_synchronize();
+
+        if (before & 1)
+        {
+            // Being written.
+            continue;
+        }
+        if (before != seq)
+        {
+            return LE_OVERFLOW;
+        }
+
+        memcpy(samplePtr, (const void*)&slotPtr->sample, sizeof(*samplePtr));
+
+        __sync_synchronize();
+        if (slotPtr->seq == before)
+        {
+            return LE_OK;
+        }
+    }
+
+    return LE_BUSY;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode a snapshot returned by le_gnss_GetPositionSnapshot().
+ *
+ * @return
+ *  - LE_OK            The snapshot was decoded.
+ *  - LE_FORMAT_ERROR  The buffer does not hold a snapshot of the expected version.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnssSnapshot_Decode
+(
+    const uint8_t* bufferPtr,               ///< [IN] Snapshot buffer.
+    size_t bufferSize,                      ///< [IN] Number of bytes in the buffer.
+    le_gnssSnapshot_Sample_t* samplePtr     ///< [OUT] Decoded sample.
+)
+{
+    if ((NULL == bufferPtr) || (NULL == samplePtr) || (bufferSize != sizeof(*samplePtr)))
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    memcpy(samplePtr, bufferPtr, sizeof(*samplePtr));
+
+    if (LE_GNSSSNAPSHOT_VERSION != samplePtr->version)
+    {
+        LE_ERROR("Unexpected snapshot version %"PRIu32, samplePtr->version);
+        return LE_FORMAT_ERROR;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map the shared sample ring from the file descriptor returned by le_gnss_GetSampleRing().
+ *
+ * The file descriptor is closed by this function, whatever the outcome.
+ *
+ * @return A reference to the mapped ring, or NULL if the file could not be mapped.
+ */
+//--------------------------------------------------------------------------------------------------
+le_gnssSnapshot_RingRef_t le_gnssSnapshot_MapRing
+(
+    int ringFd                              ///< [IN] Ring file descriptor.
+)
+{
+    struct stat ringStat;
+    void* mapPtr;
+
+    if (ringFd < 0)
+    {
+        return NULL;
+    }
+
+    if (fstat(ringFd, &ringStat) != 0)
+    {
+        LE_ERROR("Cannot stat ring. errno.%d (%s)", errno, strerror(errno));
+        close(ringFd);
+        return NULL;
+    }
+
+    if (ringStat.st_size < (off_t)sizeof(le_gnssSnapshot_Ring_t))
+    {
+        LE_ERROR("Ring is too small (%d bytes)", (int)ringStat.st_size);
+        close(ringFd);
+        return NULL;
+    }
+
+    mapPtr = mmap(NULL, ringStat.st_size, PROT_READ, MAP_SHARED, ringFd, 0);
+    close(ringFd);
+
+    if (MAP_FAILED == mapPtr)
+    {
+        LE_ERROR("Cannot map ring. errno.%d (%s)", errno, strerror(errno));
+        return NULL;
+    }
+
+    const le_gnssSnapshot_Ring_t* ringPtr = mapPtr;
+
+    if (   (LE_GNSSSNAPSHOT_RING_MAGIC != ringPtr->magic)
+        || (LE_GNSSSNAPSHOT_VERSION != ringPtr->version)
+        || (sizeof(le_gnssSnapshot_Slot_t) != ringPtr->slotSize)
+        || (0 == ringPtr->slotCount)
+        || ((size_t)ringStat.st_size <
+                sizeof(le_gnssSnapshot_Ring_t) + ringPtr->slotCount * ringPtr->slotSize))
+    {
+        LE_ERROR("Unexpected ring layout");
+        munmap(mapPtr, ringStat.st_size);
+        return NULL;
+    }
+
+    if (NULL == RingMapPool)
+    {
+        RingMapPool = le_mem_CreatePool("GnssSnapshotRing", sizeof(RingMap_t));
+    }
+
+    RingMap_t* ringMapPtr = le_mem_ForceAlloc(RingMapPool);
+    ringMapPtr->ringPtr = ringPtr;
+    ringMapPtr->mapSize = ringStat.st_size;
+
+    return ringMapPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a shared sample ring.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_gnssSnapshot_UnmapRing
+(
+    le_gnssSnapshot_RingRef_t ringRef       ///< [IN] Ring reference.
+)
+{
+    if (NULL == ringRef)
+    {
+        return;
+    }
+
+    munmap((void*)ringRef->ringPtr, ringRef->mapSize);
+    le_mem_Release(ringRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the most recent sample of the shared ring.
+ *
+ * @return
+ *  - LE_OK            The sample was copied.
+ *  - LE_NOT_FOUND     No sample has been published yet.
+ *  - LE_BUSY          The writer kept overwriting the slot, try again later.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnssSnapshot_ReadLast
+(
+    le_gnssSnapshot_RingRef_t ringRef,      ///< [IN] Ring reference.
+    le_gnssSnapshot_Sample_t* samplePtr,    ///< [OUT] Sample.
+    uint32_t* seqPtr                        ///< [OUT] Sample number (can be NULL).
+)
+{
+    int retry;
+
+    LE_ASSERT(ringRef);
+    LE_ASSERT(samplePtr);
+
+    for (retry = 0; retry < READ_RETRY_MAX; retry++)
+    {
+        uint32_t seq = ringRef->ringPtr->lastSeq;
+        __sync_synchronize();
+
+        if (0 == seq)
+        {
+            return LE_NOT_FOUND;
+        }
+
+        // A LE_OVERFLOW here means that the writer lapped us: fetch the new last sample.
+        le_result_t result = ReadSlot(ringRef->ringPtr, seq, samplePtr);
+        if (LE_OK == result)
+        {
+            if (seqPtr)
+            {
+                *seqPtr = seq;
+            }
+            return LE_OK;
+        }
+    }
+
+    return LE_BUSY;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the sample following a given sample number, so that a client polling the ring can process
+ * every sample.
+ *
+ * @return
+ *  - LE_OK            The sample was copied and *seqPtr updated to its number.
+ *  - LE_NOT_FOUND     No newer sample has been published yet.
+ *  - LE_OVERFLOW      The requested sample was overwritten; the oldest sample still available is
+ *                     returned instead and *seqPtr updated to its number.
+ *  - LE_BUSY          The writer kept overwriting the slot, try again later.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnssSnapshot_ReadNext
+(
+    le_gnssSnapshot_RingRef_t ringRef,      ///< [IN] Ring reference.
+    le_gnssSnapshot_Sample_t* samplePtr,    ///< [OUT] Sample.
+    uint32_t* seqPtr                        ///< [IN/OUT] Last processed sample number (0 if none).
+)
+{
+    const le_gnssSnapshot_Ring_t* ringPtr;
+    le_result_t result = LE_OK;
+    int retry;
+
+    LE_ASSERT(ringRef);
+    LE_ASSERT(samplePtr);
+    LE_ASSERT(seqPtr);
+
+    ringPtr = ringRef->ringPtr;
+
+    for (retry = 0; retry < READ_RETRY_MAX; retry++)
+    {
+        uint32_t lastSeq = ringPtr->lastSeq;
+        uint32_t oldestSeq;
+        uint32_t nextSeq = *seqPtr + 2;
+        __sync_synchronize();
+
+        if ((0 == lastSeq) || ((int32_t)(lastSeq - *seqPtr) <= 0))
+        {
+            return LE_NOT_FOUND;
+        }
+
+        // Oldest sample still in the ring.
+        if (lastSeq >= 2 * ringPtr->slotCount)
+        {
+            oldestSeq = lastSeq - 2 * (ringPtr->slotCount - 1);
+        }
+        else
+        {
+            oldestSeq = 2;
+        }
+
+        if ((int32_t)(nextSeq - oldestSeq) < 0)
+        {
+            nextSeq = oldestSeq;
+            result = LE_OVERFLOW;
+        }
+
+        le_result_t readResult = ReadSlot(ringPtr, nextSeq, samplePtr);
+        if (LE_OK == readResult)
+        {
+            *seqPtr = nextSeq;
+            return result;
+        }
+        if (LE_BUSY == readResult)
+        {
+            return LE_BUSY;
+        }
+
+        // The slot was overwritten in the meantime: recompute the oldest available sample.
+        result = LE_OVERFLOW;
+    }
+
+    return LE_BUSY;
+}
@@ -0,0 +1,275 @@
+//--------------------------------------------------------------------------------------------------
+/** @file gnssSnapshot.h
+ *
+ * GNSS position snapshot component.  Defines the layout of a whole position sample, as returned by
+ * le_gnss_GetPositionSnapshot() and published by the positioning daemon in its shared sample
+ * ring, and provides helpers to decode snapshots and read the ring without any IPC.
+ *
+ * This component should be included in an application that wants to read a full position sample
+ * in one go instead of calling each le_gnss getter.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_GNSS_SNAPSHOT_INCLUDE_GUARD
+#define LEGATO_GNSS_SNAPSHOT_INCLUDE_GUARD
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Snapshot layout version.  Must be incremented whenever le_gnssSnapshot_Sample_t or
+ * le_gnssSnapshot_Ring_t changes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_GNSSSNAPSHOT_VERSION             1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic number at the beginning of the shared sample ring ("GNSR").
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_GNSSSNAPSHOT_RING_MAGIC          0x524E5347
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of satellites described in a snapshot.  Same as LE_GNSS_SV_INFO_MAX_LEN.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_GNSSSNAPSHOT_SV_MAX              80
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Validity bits of le_gnssSnapshot_Sample_t.validMask.  A field is only meaningful if its bit is
+ * set.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_GNSSSNAPSHOT_LATITUDE            0x00000001
+#define LE_GNSSSNAPSHOT_LONGITUDE           0x00000002
+#define LE_GNSSSNAPSHOT_H_ACCURACY          0x00000004
+#define LE_GNSSSNAPSHOT_ALTITUDE            0x00000008
+#define LE_GNSSSNAPSHOT_ALTITUDE_ON_WGS84   0x00000010
+#define LE_GNSSSNAPSHOT_V_ACCURACY          0x00000020
+#define LE_GNSSSNAPSHOT_H_SPEED             0x00000040
+#define LE_GNSSSNAPSHOT_H_SPEED_ACCURACY    0x00000080
+#define LE_GNSSSNAPSHOT_V_SPEED             0x00000100
+#define LE_GNSSSNAPSHOT_V_SPEED_ACCURACY    0x00000200
+#define LE_GNSSSNAPSHOT_DIRECTION           0x00000400
+#define LE_GNSSSNAPSHOT_DIRECTION_ACCURACY  0x00000800
+#define LE_GNSSSNAPSHOT_MAGNETIC_DEVIATION  0x00001000
+#define LE_GNSSSNAPSHOT_DATE                0x00002000
+#define LE_GNSSSNAPSHOT_TIME                0x00004000
+#define LE_GNSSSNAPSHOT_GPS_TIME            0x00008000
+#define LE_GNSSSNAPSHOT_TIME_ACCURACY       0x00010000
+#define LE_GNSSSNAPSHOT_LEAP_SECONDS        0x00020000
+#define LE_GNSSSNAPSHOT_POSITION_LATENCY    0x00040000
+#define LE_GNSSSNAPSHOT_HDOP                0x00080000
+#define LE_GNSSSNAPSHOT_VDOP                0x00100000
+#define LE_GNSSSNAPSHOT_PDOP                0x00200000
+#define LE_GNSSSNAPSHOT_GDOP                0x00400000
+#define LE_GNSSSNAPSHOT_TDOP                0x00800000
+#define LE_GNSSSNAPSHOT_SATS_IN_VIEW_COUNT  0x01000000
+#define LE_GNSSSNAPSHOT_SATS_TRACKING_COUNT 0x02000000
+#define LE_GNSSSNAPSHOT_SATS_USED_COUNT     0x04000000
+#define LE_GNSSSNAPSHOT_SAT_INFO            0x08000000
+#define LE_GNSSSNAPSHOT_SAT_MEAS            0x10000000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Satellite flags of le_gnssSnapshot_SvInfo_t.flags.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LE_GNSSSNAPSHOT_SV_USED             0x01
+#define LE_GNSSSNAPSHOT_SV_TRACKED          0x02
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Satellite Vehicle information of a snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint16_t satId;             ///< Satellite in View ID number [PRN].
+    uint16_t satAzim;           ///< Satellite in View Azimuth [degrees]. Range: 0 to 360
+    uint8_t  satConst;          ///< GNSS constellation type (le_gnss_Constellation_t).
+    uint8_t  flags;             ///< LE_GNSSSNAPSHOT_SV_USED and LE_GNSSSNAPSHOT_SV_TRACKED bits.
+    uint8_t  satSnr;            ///< Satellite in View Signal To Noise Ratio [dBHz].
+    uint8_t  satElev;           ///< Satellite in View Elevation [degrees]. Range: 0 to 90
+    int32_t  satLatency;        ///< Satellite latency measurement [milliseconds].
+}
+le_gnssSnapshot_SvInfo_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Whole position sample.  Units and resolutions are the ones of the matching le_gnss getters;
+ * DOP values are always given with 3 decimal places, regardless of le_gnss_SetDopResolution().
+ *
+ * The layout only uses fixed-width types, so that it can be exchanged as is between the
+ * positioning daemon and its clients.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t version;               ///< LE_GNSSSNAPSHOT_VERSION.
+    uint32_t validMask;             ///< LE_GNSSSNAPSHOT_xxx validity bits.
+    int32_t  fixState;              ///< Position fix state (le_gnss_FixState_t).
+    int32_t  latitude;              ///< WGS84 Latitude [resolution 1e-6 degree].
+    int32_t  longitude;             ///< WGS84 Longitude [resolution 1e-6 degree].
+    int32_t  hAccuracy;             ///< Horizontal accuracy [resolution 1e-2 meter].
+    int32_t  altitude;              ///< Altitude above mean sea level [resolution 1e-3 meter].
+    int32_t  altitudeOnWgs84;       ///< Altitude on WGS-84 ellipsoid [resolution 1e-3 meter].
+    int32_t  vAccuracy;             ///< Vertical accuracy [resolution 1e-1 meter].
+    uint32_t hSpeed;                ///< Horizontal speed [resolution 1e-2 meter/second].
+    uint32_t hSpeedAccuracy;        ///< Horizontal speed accuracy [resolution 1e-1 meter/second].
+    int32_t  vSpeed;                ///< Vertical speed [resolution 1e-2 meter/second].
+    int32_t  vSpeedAccuracy;        ///< Vertical speed accuracy [resolution 1e-1 meter/second].
+    uint32_t direction;             ///< Direction [resolution 1e-1 degree].
+    uint32_t directionAccuracy;     ///< Direction accuracy [resolution 1e-1 degree].
+    int32_t  magneticDeviation;     ///< Magnetic deviation [resolution 1e-1 degree].
+    uint16_t year;                  ///< UTC Year A.D. [e.g. 2014].
+    uint16_t month;                 ///< UTC Month into the year [range 1...12].
+    uint16_t day;                   ///< UTC Days into the month [range 1...31].
+    uint16_t hours;                 ///< UTC Hours into the day [range 0..23].
+    uint16_t minutes;               ///< UTC Minutes into the hour [range 0..59].
+    uint16_t seconds;               ///< UTC Seconds into the minute [range 0..59].
+    uint16_t milliseconds;          ///< UTC Milliseconds into the second [range 0..999].
+    uint8_t  leapSeconds;           ///< UTC leap seconds in advance [seconds].
+    uint8_t  satsInViewCount;       ///< Satellites in View count.
+    uint64_t epochTime;             ///< Epoch time in milliseconds since Jan. 1, 1970.
+    uint32_t gpsWeek;               ///< GPS week number from midnight, Jan. 6, 1980.
+    uint32_t gpsTimeOfWeek;         ///< Amount of time in milliseconds into the GPS week.
+    uint32_t timeAccuracy;          ///< Estimated accuracy for time [nanoseconds].
+    uint32_t positionLatency;       ///< Position measurement latency [milliseconds].
+    uint32_t hdop;                  ///< Horizontal dilution of precision [resolution 1e-3].
+    uint32_t vdop;                  ///< Vertical dilution of precision [resolution 1e-3].
+    uint32_t pdop;                  ///< Position dilution of precision [resolution 1e-3].
+    uint32_t gdop;                  ///< Geometric dilution of precision [resolution 1e-3].
+    uint32_t tdop;                  ///< Time dilution of precision [resolution 1e-3].
+    uint8_t  satsTrackingCount;     ///< Tracking satellites in View count.
+    uint8_t  satsUsedCount;         ///< Satellites in View used for Navigation.
+    uint16_t reserved;              ///< Reserved, set to 0.
+    le_gnssSnapshot_SvInfo_t satInfo[LE_GNSSSNAPSHOT_SV_MAX]; ///< Satellites information.
+}
+le_gnssSnapshot_Sample_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * One slot of the shared sample ring.
+ *
+ * The slot is protected by a sequence lock: the writer sets seq to an odd value while it updates
+ * the sample and to the (even) published sequence number once it is done.  A reader must discard
+ * the sample if seq changed while it was copying it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    volatile uint32_t        seq;       ///< Sequence lock word.
+    uint32_t                 reserved;  ///< Reserved, keeps the sample 64-bit aligned.
+    le_gnssSnapshot_Sample_t sample;    ///< Position sample.
+}
+le_gnssSnapshot_Slot_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shared sample ring, as mapped from the file descriptor returned by le_gnss_GetSampleRing().
+ *
+ * Samples are numbered 2, 4, 6... (even numbers, so that odd ones can flag a slot being written).
+ * Sample number n is stored in slots[(n/2) % slotCount].
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t                magic;      ///< LE_GNSSSNAPSHOT_RING_MAGIC.
+    uint32_t                version;    ///< LE_GNSSSNAPSHOT_VERSION.
+    uint32_t                slotSize;   ///< sizeof(le_gnssSnapshot_Slot_t).
+    uint32_t                slotCount;  ///< Number of slots in the ring.
+    volatile uint32_t       lastSeq;    ///< Number of the last published sample, 0 if none.
+    uint32_t                reserved[3];///< Reserved, set to 0.
+    le_gnssSnapshot_Slot_t  slots[];    ///< Ring slots.
+}
+le_gnssSnapshot_Ring_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference type for a mapped shared sample ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_gnssSnapshot_RingMap* le_gnssSnapshot_RingRef_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode a snapshot returned by le_gnss_GetPositionSnapshot().
+ *
+ * @return
+ *  - LE_OK            The snapshot was decoded.
+ *  - LE_FORMAT_ERROR  The buffer does not hold a snapshot of the expected version.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t le_gnssSnapshot_Decode
+(
+    const uint8_t* bufferPtr,               ///< [IN] Snapshot buffer.
+    size_t bufferSize,                      ///< [IN] Number of bytes in the buffer.
+    le_gnssSnapshot_Sample_t* samplePtr     ///< [OUT] Decoded sample.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map the shared sample ring from the file descriptor returned by le_gnss_GetSampleRing().
+ *
+ * The file descriptor is closed by this function, whatever the outcome.
+ *
+ * @return A reference to the mapped ring, or NULL if the file could not be mapped.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_gnssSnapshot_RingRef_t le_gnssSnapshot_MapRing
+(
+    int ringFd                              ///< [IN] Ring file descriptor.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a shared sample ring.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED void le_gnssSnapshot_UnmapRing
+(
+    le_gnssSnapshot_RingRef_t ringRef       ///< [IN] Ring reference.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the most recent sample of the shared ring.
+ *
+ * @return
+ *  - LE_OK            The sample was copied.
+ *  - LE_NOT_FOUND     No sample has been published yet.
+ *  - LE_BUSY          The writer kept overwriting the slot, try again later.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t le_gnssSnapshot_ReadLast
+(
+    le_gnssSnapshot_RingRef_t ringRef,      ///< [IN] Ring reference.
+    le_gnssSnapshot_Sample_t* samplePtr,    ///< [OUT] Sample.
+    uint32_t* seqPtr                        ///< [OUT] Sample number (can be NULL).
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the sample following a given sample number, so that a client polling the ring can process
+ * every sample.
+ *
+ * @return
+ *  - LE_OK            The sample was copied and *seqPtr updated to its number.
+ *  - LE_NOT_FOUND     No newer sample has been published yet.
+ *  - LE_OVERFLOW      The requested sample was overwritten; the oldest sample still available is
+ *                     returned instead and *seqPtr updated to its number.
+ *  - LE_BUSY          The writer kept overwriting the slot, try again later.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t le_gnssSnapshot_ReadNext
+(
+    le_gnssSnapshot_RingRef_t ringRef,      ///< [IN] Ring reference.
+    le_gnssSnapshot_Sample_t* samplePtr,    ///< [OUT] Sample.
+    uint32_t* seqPtr                        ///< [IN/OUT] Last processed sample number (0 if none).
+);
+
+#endif /* LEGATO_GNSS_SNAPSHOT_INCLUDE_GUARD */
@@ -12,6 +12,9 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "pa_gnss.h"
+#include "gnssSnapshot.h"
+#include "nmeaPipe.h"
+#include <sys/mman.h>
 
 
 //--------------------------------------------------------------------------------------------------
@@ -33,6 +36,19 @@
 #define LE_GNSS_NMEA_NODE_PATH                  "/dev/nmea"
 #endif
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Shared sample ring definitions
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef LE_GNSS_SAMPLE_RING_PATH
+#define LE_GNSS_SAMPLE_RING_PATH                "/tmp/gnssSampleRingXXXXXX"
+#endif
+
+/// Number of recent position samples kept in the shared sample ring.
+#define GNSS_SAMPLE_RING_SLOTS                  16
+
 //--------------------------------------------------------------------------------------------------
 /**
  * SV ID definitions corresponding to SBAS constellation categories
@@ -336,10 +352,17 @@ static le_ref_MapRef_t ClientRequestRefMap;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * NMEA pipe file descriptor
+ * Shared sample ring, NULL if it could not be created.
  */
 //--------------------------------------------------------------------------------------------------
-static int NmeaPipeFd = -1;
+static le_gnssSnapshot_Ring_t* SampleRingPtr = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read-only file descriptor of the shared sample ring, handed out to clients.
+ */
+//--------------------------------------------------------------------------------------------------
+static int SampleRingFd = -1;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -419,146 +442,6 @@ static void PositionSampleDestructor
     }
 }
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Create NMEA named pipe (FIFO)
- */
-//--------------------------------------------------------------------------------------------------
-static void CreateNmeaPipe
-(
-    void
-)
-{
-    int result = 0;
-
-    LE_DEBUG("Create %s", LE_GNSS_NMEA_NODE_PATH);
-
-    // Create the node for /dev/nmea device folder
-    umask(0);
-    result = mknod(LE_GNSS_NMEA_NODE_PATH, S_IFIFO|0666, 0);
-
-    LE_ERROR_IF((result != 0)&&(result != EEXIST),
-           "Could not create %s. errno.%d (%s)", LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Open the NMEA pipe
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t OpenNmeaPipe
-(
-    void
-)
-{
-
-    // Check NMEA pipe file descriptor
-    if(NmeaPipeFd != -1)
-    {
-        return LE_DUPLICATE;
-    }
-
-    // Open NMEA pipe
-    do
-    {
-        if (((NmeaPipeFd=open(LE_GNSS_NMEA_NODE_PATH,
-                                O_WRONLY|O_APPEND|O_CLOEXEC|O_NONBLOCK)) == -1)
-            && (errno != EINTR))
-        {
-            LE_WARN_IF(errno != 6, "Open %s failure: errno.%d (%s)",
-                       LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
-            return LE_FAULT;
-        }
-    }while (NmeaPipeFd==-1);
-
-    return LE_OK;
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Close the NMEA pipe
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t CloseNmeaPipe
-(
-    void
-)
-{
-    le_result_t retResult = LE_OK;
-    int result;
-
-    // Check NMEA pipe file descriptor
-    if(NmeaPipeFd == -1)
-    {
-        LE_WARN("Invalid file descriptor. File already closed");
-        return LE_DUPLICATE;
-    }
-
-    // Close NMEA pipe
-    do
-    {
-        result = close(NmeaPipeFd);
-    }
-    while ((result != 0) && (errno == EINTR));
-
-    LE_ERROR_IF(result != 0, "Could not close %s. errno.%d (%s)",
-               LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
-
-    if(result != 0)
-    {
-        retResult = LE_FAULT;
-    }
-    else
-    {
-        // Release the NMEA pipe file descriptor
-        NmeaPipeFd = -1;
-    }
-
-    return retResult;
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Write the NMEA sentence to NMEA pipe
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t WriteNmeaPipe
-(
-    const char*  nmeaStringPtr          ///< [IN] Pointer to the NMEA sentence to write.
-)
-{
-    le_result_t resultNmeaPipe = LE_OK;
-    ssize_t resultWrite = 0;
-    ssize_t written = 0;
-    ssize_t stringSize = 0;
-
-    // Open the NMEA FIFO pipe
-    resultNmeaPipe = OpenNmeaPipe();
-
-    if((resultNmeaPipe == LE_OK)||(resultNmeaPipe == LE_DUPLICATE))
-    {
-        written = 0;
-        stringSize = strlen(nmeaStringPtr)+1;
-        // Write to NMEA pipe
-        while (written < stringSize)
-        {
-            resultWrite = write(NmeaPipeFd, nmeaStringPtr + written, stringSize - written);
-
-            if ((resultWrite < 0) && (errno != EINTR))
-            {
-                LE_ERROR("Could not write to %s (write error, errno.%d (%s))",
-                         LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
-                CloseNmeaPipe();
-                return LE_FAULT;
-            }
-
-            written += resultWrite;
-        }
-    }
-
-    return LE_OK;
-}
-
 //--------------------------------------------------------------------------------------------------
 /**
  * The PA NMEA Handler.
@@ -572,8 +455,8 @@ static void PaNmeaHandler
 {
     LE_DEBUG("Handler Function called with PA NMEA %p", nmeaPtr);
 
-    // Write the NMEA sentence to the /dev/nmea device folder
-    WriteNmeaPipe(nmeaPtr);
+    // Queue the NMEA sentence for the /dev/nmea device folder
+    nmeaPipe_Write(nmeaPtr);
 
     le_mem_Release(nmeaPtr);
 }
@@ -694,6 +577,213 @@ static void GetPosSampleData
     return;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fills in a whole-sample snapshot from a position sample.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetSnapshotData
+(
+    le_gnssSnapshot_Sample_t* snapshotPtr,          // [OUT] Pointer to the snapshot.
+    const le_gnss_PositionSample_t* posSampleDataPtr // [IN] Pointer to the position sample.
+)
+{
+    uint32_t validMask = 0;
+    uint8_t i;
+
+    memset(snapshotPtr, 0, sizeof(*snapshotPtr));
+
+#define SNAPSHOT_COPY(validField, bit, field)              \
+    if (posSampleDataPtr->validField)                      \
+    {                                                      \
+        validMask |= (bit);                                \
+        snapshotPtr->field = posSampleDataPtr->field;      \
+    }
+
+    snapshotPtr->version = LE_GNSSSNAPSHOT_VERSION;
+    snapshotPtr->fixState = posSampleDataPtr->fixState;
+
+    SNAPSHOT_COPY(latitudeValid, LE_GNSSSNAPSHOT_LATITUDE, latitude);
+    SNAPSHOT_COPY(longitudeValid, LE_GNSSSNAPSHOT_LONGITUDE, longitude);
+    SNAPSHOT_COPY(hAccuracyValid, LE_GNSSSNAPSHOT_H_ACCURACY, hAccuracy);
+    SNAPSHOT_COPY(altitudeValid, LE_GNSSSNAPSHOT_ALTITUDE, altitude);
+    SNAPSHOT_COPY(altitudeOnWgs84Valid, LE_GNSSSNAPSHOT_ALTITUDE_ON_WGS84, altitudeOnWgs84);
+    SNAPSHOT_COPY(vAccuracyValid, LE_GNSSSNAPSHOT_V_ACCURACY, vAccuracy);
+    SNAPSHOT_COPY(hSpeedValid, LE_GNSSSNAPSHOT_H_SPEED, hSpeed);
+    SNAPSHOT_COPY(hSpeedAccuracyValid, LE_GNSSSNAPSHOT_H_SPEED_ACCURACY, hSpeedAccuracy);
+    SNAPSHOT_COPY(vSpeedValid, LE_GNSSSNAPSHOT_V_SPEED, vSpeed);
+    SNAPSHOT_COPY(vSpeedAccuracyValid, LE_GNSSSNAPSHOT_V_SPEED_ACCURACY, vSpeedAccuracy);
+    SNAPSHOT_COPY(directionValid, LE_GNSSSNAPSHOT_DIRECTION, direction);
+    SNAPSHOT_COPY(directionAccuracyValid, LE_GNSSSNAPSHOT_DIRECTION_ACCURACY, directionAccuracy);
+    SNAPSHOT_COPY(magneticDeviationValid, LE_GNSSSNAPSHOT_MAGNETIC_DEVIATION, magneticDeviation);
+    SNAPSHOT_COPY(timeAccuracyValid, LE_GNSSSNAPSHOT_TIME_ACCURACY, timeAccuracy);
+    SNAPSHOT_COPY(leapSecondsValid, LE_GNSSSNAPSHOT_LEAP_SECONDS, leapSeconds);
+    SNAPSHOT_COPY(positionLatencyValid, LE_GNSSSNAPSHOT_POSITION_LATENCY, positionLatency);
+    SNAPSHOT_COPY(hdopValid, LE_GNSSSNAPSHOT_HDOP, hdop);
+    SNAPSHOT_COPY(vdopValid, LE_GNSSSNAPSHOT_VDOP, vdop);
+    SNAPSHOT_COPY(pdopValid, LE_GNSSSNAPSHOT_PDOP, pdop);
+    SNAPSHOT_COPY(gdopValid, LE_GNSSSNAPSHOT_GDOP, gdop);
+    SNAPSHOT_COPY(tdopValid, LE_GNSSSNAPSHOT_TDOP, tdop);
+    SNAPSHOT_COPY(satsInViewCountValid, LE_GNSSSNAPSHOT_SATS_IN_VIEW_COUNT, satsInViewCount);
+    SNAPSHOT_COPY(satsTrackingCountValid, LE_GNSSSNAPSHOT_SATS_TRACKING_COUNT, satsTrackingCount);
+    SNAPSHOT_COPY(satsUsedCountValid, LE_GNSSSNAPSHOT_SATS_USED_COUNT, satsUsedCount);
+
+#undef SNAPSHOT_COPY
+
+    if (posSampleDataPtr->dateValid)
+    {
+        validMask |= LE_GNSSSNAPSHOT_DATE;
+        snapshotPtr->year = posSampleDataPtr->year;
+        snapshotPtr->month = posSampleDataPtr->month;
+        snapshotPtr->day = posSampleDataPtr->day;
+    }
+    if (posSampleDataPtr->timeValid)
+    {
+        validMask |= LE_GNSSSNAPSHOT_TIME;
+        snapshotPtr->hours = posSampleDataPtr->hours;
+        snapshotPtr->minutes = posSampleDataPtr->minutes;
+        snapshotPtr->seconds = posSampleDataPtr->seconds;
+        snapshotPtr->milliseconds = posSampleDataPtr->milliseconds;
+    }
+    // Epoch time is valid whenever the date and time are.
+    snapshotPtr->epochTime = posSampleDataPtr->epochTime;
+    if (posSampleDataPtr->gpsTimeValid)
+    {
+        validMask |= LE_GNSSSNAPSHOT_GPS_TIME;
+        snapshotPtr->gpsWeek = posSampleDataPtr->gpsWeek;
+        snapshotPtr->gpsTimeOfWeek = posSampleDataPtr->gpsTimeOfWeek;
+    }
+
+    // Satellites information
+    if (posSampleDataPtr->satInfoValid)
+    {
+        validMask |= LE_GNSSSNAPSHOT_SAT_INFO;
+    }
+    if (posSampleDataPtr->satMeasValid)
+    {
+        validMask |= LE_GNSSSNAPSHOT_SAT_MEAS;
+    }
+    for (i = 0; i < LE_GNSSSNAPSHOT_SV_MAX; i++)
+    {
+        le_gnssSnapshot_SvInfo_t* svPtr = &snapshotPtr->satInfo[i];
+
+        if (posSampleDataPtr->satInfoValid)
+        {
+            svPtr->satId = posSampleDataPtr->satInfo[i].satId;
+            svPtr->satConst = posSampleDataPtr->satInfo[i].satConst;
+            svPtr->flags = (posSampleDataPtr->satInfo[i].satUsed ? LE_GNSSSNAPSHOT_SV_USED : 0)
+                         | (posSampleDataPtr->satInfo[i].satTracked ? LE_GNSSSNAPSHOT_SV_TRACKED : 0);
+            svPtr->satSnr = posSampleDataPtr->satInfo[i].satSnr;
+            svPtr->satAzim = posSampleDataPtr->satInfo[i].satAzim;
+            svPtr->satElev = posSampleDataPtr->satInfo[i].satElev;
+        }
+        if (posSampleDataPtr->satMeasValid)
+        {
+            svPtr->satLatency = posSampleDataPtr->satMeas[i].satLatency;
+        }
+    }
+
+    snapshotPtr->validMask = validMask;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the shared sample ring.
+ *
+ * The ring lives in an unlinked temporary file: the daemon maps it read-write and hands out
+ * read-only file descriptors to the clients, which map it on their side.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CreateSampleRing
+(
+    void
+)
+{
+    char path[] = LE_GNSS_SAMPLE_RING_PATH;
+    char roPath[32];
+    size_t ringSize = sizeof(le_gnssSnapshot_Ring_t)
+                      + GNSS_SAMPLE_RING_SLOTS * sizeof(le_gnssSnapshot_Slot_t);
+    void* mapPtr;
+    int fd;
+
+    fd = mkstemp(path);
+    if (-1 == fd)
+    {
+        LE_ERROR("Could not create %s. errno.%d (%s)", path, errno, strerror(errno));
+        return;
+    }
+    unlink(path);
+
+    if (-1 == ftruncate(fd, ringSize))
+    {
+        LE_ERROR("Could not size the sample ring. errno.%d (%s)", errno, strerror(errno));
+        close(fd);
+        return;
+    }
+
+    mapPtr = mmap(NULL, ringSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == mapPtr)
+    {
+        LE_ERROR("Could not map the sample ring. errno.%d (%s)", errno, strerror(errno));
+        close(fd);
+        return;
+    }
+
+    // Reopen the (unlinked) file read-only, so that clients cannot corrupt the ring.
+    snprintf(roPath, sizeof(roPath), "/proc/self/fd/%d", fd);
+    SampleRingFd = open(roPath, O_RDONLY|O_CLOEXEC);
+    close(fd);
+    if (-1 == SampleRingFd)
+    {
+        LE_ERROR("Could not reopen the sample ring. errno.%d (%s)", errno, strerror(errno));
+        munmap(mapPtr, ringSize);
+        return;
+    }
+
+    SampleRingPtr = mapPtr;
+    SampleRingPtr->magic = LE_GNSSSNAPSHOT_RING_MAGIC;
+    SampleRingPtr->version = LE_GNSSSNAPSHOT_VERSION;
+    SampleRingPtr->slotSize = sizeof(le_gnssSnapshot_Slot_t);
+    SampleRingPtr->slotCount = GNSS_SAMPLE_RING_SLOTS;
+    SampleRingPtr->lastSeq = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Publish a position sample in the shared sample ring.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PublishSample
+(
+    const le_gnss_PositionSample_t* posSampleDataPtr // [IN] Pointer to the position sample.
+)
+{
+    le_gnssSnapshot_Slot_t* slotPtr;
+    uint32_t seq;
+
+    if (NULL == SampleRingPtr)
+    {
+        return;
+    }
+
+    // Sample numbers are even and never 0.
+    seq = SampleRingPtr->lastSeq + 2;
+    if (0 == seq)
+    {
+        seq = 2;
+    }
+    slotPtr = &SampleRingPtr->slots[(seq / 2) % GNSS_SAMPLE_RING_SLOTS];
+
+    // Flag the slot as being written, update it, then publish it.
+    slotPtr->seq = seq - 1;
+    __sync_synchronize();
+    GetSnapshotData(&slotPtr->sample, posSampleDataPtr);
+    __sync_synchronize();
+    slotPtr->seq = seq;
+    __sync_synchronize();
+    SampleRingPtr->lastSeq = seq;
+}
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -859,6 +949,9 @@ static void PaPositionHandler
     // Get the position sample data from the PA position data report
     GetPosSampleData(&LastPositionSample, positionPtr);
 
+    // Publish it in the shared sample ring, for the clients reading it without IPC
+    PublishSample(&LastPositionSample);
+
     if(!NumOfPositionHandlers)
     {
         LE_DEBUG("No positioning handlers, exit Handler Function");
@@ -1140,6 +1233,9 @@ le_result_t gnss_Init
     memset(&LastPositionSample, 0, sizeof(LastPositionSample));
     LastPositionSample.fixState = LE_GNSS_STATE_FIX_NO_POS;
 
+    // Create the shared sample ring
+    CreateSampleRing();
+
     // Subscribe to PA position Data handler
     if ((PaHandlerRef=pa_gnss_AddPositionDataHandler(PaPositionHandler)) == NULL)
     {
@@ -1148,6 +1244,8 @@ le_result_t gnss_Init
     }
 
     // NMEA pipe management
+    nmeaPipe_Init(LE_GNSS_NMEA_NODE_PATH);
+
     // Get information from NMEA device file
     resultStat = stat(LE_GNSS_NMEA_NODE_PATH, &nmeaFileStat);
     // That node is a character device file: it will be managed from the Firmware (Kernel space).
@@ -1168,7 +1266,7 @@ le_result_t gnss_Init
         if ((PaNmeaHandlerRef=pa_gnss_AddNmeaHandler(PaNmeaHandler)) != NULL)
         {
             // Create NMEA device folder
-            CreateNmeaPipe();
+            nmeaPipe_Create();
         }
         else
         {
@@ -2916,6 +3014,105 @@ void le_gnss_ReleaseSampleRef
     le_mem_Release(positionSampleRequestNodePtr);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the whole position sample in one call, instead of calling each getter.
+ *
+ * @return
+ *  - LE_FAULT         Function failed to get the snapshot.
+ *  - LE_OVERFLOW      The snapshot buffer is too small.
+ *  - LE_OK            Function succeeded.
+ *
+ * @note The DOP values of the snapshot are always given with 3 decimal places.
+ *
+ * @note If the caller is passing an invalid Position sample reference into this function,
+ *       it is a fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnss_GetPositionSnapshot
+(
+    le_gnss_SampleRef_t positionSampleRef,
+        ///< [IN] Position sample's reference.
+
+    uint8_t* snapshotPtr,
+        ///< [OUT] Encoded position sample.
+
+    size_t* snapshotSizePtr
+        ///< [INOUT]
+)
+{
+    le_result_t result;
+    le_gnss_PositionSampleRequest_t* positionSampleRequestNodePtr
+                                            = le_ref_Lookup(PositionSampleMap,positionSampleRef);
+
+    // Check input pointers
+    if ((NULL == snapshotPtr) || (NULL == snapshotSizePtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    // Check position sample's reference
+    result = ValidatePositionSamplePtr(positionSampleRequestNodePtr);
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    if (*snapshotSizePtr < sizeof(le_gnssSnapshot_Sample_t))
+    {
+        LE_ERROR("Snapshot buffer too small (%zu bytes)", *snapshotSizePtr);
+        return LE_OVERFLOW;
+    }
+
+    // The snapshot buffer coming from the IPC layer has no alignment guarantee.
+    le_gnssSnapshot_Sample_t snapshot;
+    GetSnapshotData(&snapshot, positionSampleRequestNodePtr->positionSampleNodePtr);
+    memcpy(snapshotPtr, &snapshot, sizeof(snapshot));
+    *snapshotSizePtr = sizeof(snapshot);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a read-only file descriptor on the shared ring of the most recent position samples.
+ *
+ * @return
+ *  - LE_FAULT         The ring is not available.
+ *  - LE_OK            Function succeeded.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnss_GetSampleRing
+(
+    int* ringFdPtr
+        ///< [OUT] Read-only file descriptor of the ring.
+)
+{
+    if (NULL == ringFdPtr)
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    *ringFdPtr = -1;
+
+    if (-1 == SampleRingFd)
+    {
+        return LE_FAULT;
+    }
+
+    // The file descriptor is closed once sent to the client.
+    *ringFdPtr = dup(SampleRingFd);
+    if (-1 == *ringFdPtr)
+    {
+        LE_ERROR("Could not duplicate the sample ring fd. errno.%d (%s)", errno, strerror(errno));
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set the GNSS constellation bit mask
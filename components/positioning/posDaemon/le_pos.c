@@ -14,8 +14,7 @@
 #include "le_gnss_local.h"
 #include "posCfgEntries.h"
 #include "watchdogChain.h"
-
-#include <math.h>
+#include "movementFilter.h"
 
 //--------------------------------------------------------------------------------------------------
 // Symbol and Enum definitions.
@@ -149,12 +148,10 @@ typedef struct le_pos_SampleHandler
                                                       ///  this handler.
     uint32_t                     verticalMagnitude;   ///< The vertical magnitude in meters for this
                                                       ///  handler.
-    int32_t                      lastLat;             ///< The altitude associated with the last
-                                                      ///  handler's notification.
-    int32_t                      lastLong;            ///< The longitude associated with the last
-                                                      ///  handler's notification.
-    int32_t                      lastAlt;             ///< The altitude associated with the last
-                                                      ///  handler's notification.
+    movementFilter_Entry_t       filterEntry;         ///< The handler entry in the movement
+                                                      ///  filter, which holds the position
+                                                      ///  associated with the last handler's
+                                                      ///  notification.
     le_msg_SessionRef_t          sessionRef;          ///< Store message session reference.
     le_dls_Link_t                link;                ///< Object node link
 }
@@ -190,24 +187,6 @@ typedef struct
 }
 PosSampleRequest_t;
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Position structure for move calculation.
- *
- */
-//--------------------------------------------------------------------------------------------------
-typedef struct
-{
-        int32_t  latitude;          ///< Latitude.
-        int32_t  longitude;         ///< Longitude.
-        int32_t  altitude;          ///< Altitude.
-        int32_t  vAccuracy;         ///< Vertical accuracy.
-        int32_t  hAccuracy;         ///< Horizontal accuracy.
-        bool     locationValid;     ///< If true, location is set.
-        bool     altitudeValid;     ///< If true, altitude is set.
-}
-PositionParam_t;
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Safe Reference Map for service activation requests.
@@ -374,6 +353,9 @@ static void PosSampleHandlerDestructor
     le_pos_SampleHandler_t *posSampleHandlerNodePtr;
     le_dls_Link_t          *linkPtr;
 
+    // The handler may not be in the list yet.
+    movementFilter_Remove(&((le_pos_SampleHandler_t*)obj)->filterEntry);
+
     linkPtr = le_dls_Peek(&PosSampleHandlerList);
     if (linkPtr != NULL)
     {
@@ -439,74 +421,6 @@ static uint32_t CalculateAcquisitionRate
     return rate + 2;
 }
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Calculate the distance in meters between two fix points (use Haversine formula).
- *
- */
-//--------------------------------------------------------------------------------------------------
-static uint32_t ComputeDistance
-(
-    uint32_t latitude1,
-    uint32_t longitude1,
-    uint32_t latitude2,
-    uint32_t longitude2
-)
-{
-    // Haversine formula:
-    // a = sin²(Δφ/2) + cos(φ1).cos(φ2).sin²(Δλ/2)
-    // c = 2.atan2(√a, √(1−a))
-    // distance = R.c.1000 (in meters)
-    // where φ is latitude, λ is longitude, R is earth’s radius (mean radius = 6,371km)
-    #define PI 3.14159265
-
-    double R = 6371; // km
-    double dLat = ((double)latitude2-(double)latitude1)/1000000.0*PI/180;
-    double dLon = ((double)longitude2-(double)longitude1)/1000000.0*PI/180;
-    double lat1 = ((double)latitude1)/1000000.0*PI/180;
-    double lat2 = ((double)latitude2)/1000000.0*PI/180;
-    double a, c;
-
-    a = sin(dLat/2) * sin(dLat/2) + sin(dLon/2) * sin(dLon/2) * cos(lat1) * cos(lat2);
-    c = 2 * atan2(sqrt(a), sqrt(1-a));
-
-    LE_DEBUG("Computed distance is %e meters (double)", (double)(R * c * 1000));
-    return (uint32_t)(R * c * 1000);
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Verify if the covered distance is beyond the magnitude.
- *
- */
-//--------------------------------------------------------------------------------------------------
-static bool IsBeyondMagnitude
-(
-    uint32_t magnitude,
-    uint32_t move,
-    uint32_t accuracy
-)
-{
-    if (move > magnitude)
-    {
-        // Check that it doesn't just look like we are beyond the magnitude because of bad accuracy.
-        if ((accuracy > move) || ((move - accuracy) < magnitude))
-        {
-            // Could be beyond the magnitude, but we also could be inside the fence.
-            return false;
-        }
-        else
-        {
-            // Definitely beyond the magnitude!
-            return true;
-        }
-    }
-    else
-    {
-        return false;
-    }
-}
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Calculate the smallest acquisition rate to use for all the registered handlers.
@@ -636,103 +550,140 @@ static uint32_t ConvertDistance
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Compute horizontal and vertical move
+ * Fill a position sample with the parameters of a GNSS position sample.
  *
- * @return LE_FAULT         Function failed.
- * @return LE_OK            Function succeeded.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ComputeMove
+static void FillPosSample
 (
-  le_pos_SampleHandler_t *posSampleHandlerNodePtr,  ///< [IN]  The handler reference.
-  const PositionParam_t  *posParamPtr,              ///< [IN]  The position structure for the move
-                                                    ///        calculation.
-  bool                   *hflagPtr,                 ///< [OUT] True if the horizontal distance is
-                                                    ///        beyond the magnitude.
-  bool                   *vflagPtr                  ///< [OUT] True if the vertical distance is
-)                                                   ///        beyond the magnitude.
+    le_gnss_SampleRef_t              positionSampleRef, ///< [IN]  GNSS position sample.
+    const movementFilter_Position_t* posParamPtr,       ///< [IN]  Position already retrieved.
+    le_pos_Sample_t*                 posSamplePtr       ///< [OUT] Position sample to fill.
+)
 {
-    if (NULL == posSampleHandlerNodePtr)
-    {
-        LE_ERROR("posSampleHandlerNodePtr is Null");
-        return LE_FAULT;
-    }
+    // Horizontal speed
+    uint32_t hSpeed;
+    uint32_t hSpeedAccuracy;
+    // Vertical speed
+    int32_t vSpeed;
+    int32_t vSpeedAccuracy;
+    // Direction
+    uint32_t direction;
+    uint32_t directionAccuracy;
+    // Date parameters
+    uint16_t year;
+    uint16_t month;
+    uint16_t day;
+    // Time parameters
+    uint16_t hours;
+    uint16_t minutes;
+    uint16_t seconds;
+    uint16_t milliseconds;
+    // Leap seconds in advance
+    uint8_t leapSeconds;
+    // the position fix state
+    le_gnss_FixState_t gnssState;
 
-    if ((posSampleHandlerNodePtr->horizontalMagnitude != 0) && !(posParamPtr->locationValid))
-    {
-        LE_ERROR("Longitude or Latitude are not relevant");
-        return LE_FAULT;
-    }
+    posSamplePtr->latitudeValid = CHECK_VALIDITY(posParamPtr->latitude,INT32_MAX);
+    posSamplePtr->latitude = posParamPtr->latitude;
 
-    if (((posSampleHandlerNodePtr->verticalMagnitude != 0) && (!posParamPtr->altitudeValid)))
-    {
-        LE_ERROR("Altitude is not relevant");
-        return LE_FAULT;
-    }
+    posSamplePtr->longitudeValid = CHECK_VALIDITY(posParamPtr->longitude,INT32_MAX);
+    posSamplePtr->longitude = posParamPtr->longitude;
+
+    posSamplePtr->hAccuracyValid = CHECK_VALIDITY(posParamPtr->hAccuracy,INT32_MAX);
+    posSamplePtr->hAccuracy = posParamPtr->hAccuracy;
+
+    posSamplePtr->altitudeValid = CHECK_VALIDITY(posParamPtr->altitude,INT32_MAX);
+    posSamplePtr->altitude = posParamPtr->altitude;
+
+    posSamplePtr->vAccuracyValid = CHECK_VALIDITY(posParamPtr->vAccuracy,INT32_MAX);
+    posSamplePtr->vAccuracy = posParamPtr->vAccuracy;
+
+    // Get horizontal speed
+    le_gnss_GetHorizontalSpeed(positionSampleRef, &hSpeed, &hSpeedAccuracy);
+    posSamplePtr->hSpeedValid = CHECK_VALIDITY(hSpeed,UINT32_MAX);
+    posSamplePtr->hSpeed = hSpeed;
+    posSamplePtr->hSpeedAccuracyValid = CHECK_VALIDITY(hSpeedAccuracy,UINT32_MAX);
+    posSamplePtr->hSpeedAccuracy = hSpeedAccuracy;
+
+    // Get vertical speed
+    le_gnss_GetVerticalSpeed(positionSampleRef, &vSpeed, &vSpeedAccuracy);
+    posSamplePtr->vSpeedValid = CHECK_VALIDITY(vSpeed,INT32_MAX);
+    posSamplePtr->vSpeed = vSpeed;
+    posSamplePtr->vSpeedAccuracyValid = CHECK_VALIDITY(vSpeedAccuracy,INT32_MAX);
+    posSamplePtr->vSpeedAccuracy = vSpeedAccuracy;
+
+    // Heading not supported by GNSS engine
+    posSamplePtr->headingValid = false;
+    posSamplePtr->heading = UINT32_MAX;
+    posSamplePtr->headingAccuracyValid = false;
+    posSamplePtr->headingAccuracy = UINT32_MAX;
 
-    // Compute horizontal and vertical move
-    LE_DEBUG("Last Position lat.%d, long.%d",
-                 posSampleHandlerNodePtr->lastLat, posSampleHandlerNodePtr->lastLong);
+    // Get direction
+    le_gnss_GetDirection(positionSampleRef, &direction, &directionAccuracy);
+    posSamplePtr->directionValid = CHECK_VALIDITY(direction,UINT32_MAX);
+    posSamplePtr->direction = direction;
+    posSamplePtr->directionAccuracyValid = CHECK_VALIDITY(directionAccuracy,UINT32_MAX);
+    posSamplePtr->directionAccuracy = directionAccuracy;
 
-    // Save the current latitude values into lastLat.
-    if (posSampleHandlerNodePtr->lastLat == 0)
+    // Get UTC time
+    if (LE_OK == le_gnss_GetDate(positionSampleRef, &year, &month, &day))
     {
-        posSampleHandlerNodePtr->lastLat = posParamPtr->latitude;
+        posSamplePtr->dateValid = true;
     }
-
-    // Save the current longitude values into lastLong.
-    if (posSampleHandlerNodePtr->lastLong == 0)
+    else
     {
-        posSampleHandlerNodePtr->lastLong = posParamPtr->longitude;
+        posSamplePtr->dateValid = false;
     }
+    posSamplePtr->year = year;
+    posSamplePtr->month = month;
+    posSamplePtr->day = day;
 
-    // Save the current altitude values into lastAlt.
-    if (posSampleHandlerNodePtr->lastAlt == 0)
+    if (LE_OK == le_gnss_GetTime(positionSampleRef, &hours, &minutes, &seconds, &milliseconds))
     {
-        posSampleHandlerNodePtr->lastAlt = posParamPtr->altitude;
+        posSamplePtr->timeValid = true;
     }
+    else
+    {
+        posSamplePtr->timeValid = false;
+    }
+    posSamplePtr->hours = hours;
+    posSamplePtr->minutes = minutes;
+    posSamplePtr->seconds = seconds;
+    posSamplePtr->milliseconds = milliseconds;
 
-    uint32_t horizontalMove = ComputeDistance(posSampleHandlerNodePtr->lastLat,
-                                              posSampleHandlerNodePtr->lastLong,
-                                              posParamPtr->latitude,
-                                              posParamPtr->longitude);
-
-    uint32_t verticalMove = abs(posParamPtr->altitude - posSampleHandlerNodePtr->lastAlt);
-
-    LE_DEBUG("horizontalMove.%d, verticalMove.%d", horizontalMove, verticalMove);
-
-    if (INT32_MAX == posParamPtr->vAccuracy)
+    // Get UTC leap seconds in advance
+    if (LE_OK == le_gnss_GetGpsLeapSeconds(positionSampleRef, &leapSeconds))
     {
-        *vflagPtr = false;
+        posSamplePtr->leapSecondsValid = true;
     }
     else
     {
-        // Vertical accuracy is in meters with 1 decimal place
-        *vflagPtr = IsBeyondMagnitude(posSampleHandlerNodePtr->verticalMagnitude,
-                                   verticalMove,
-                                   posParamPtr->vAccuracy/10);
+        posSamplePtr->leapSecondsValid = false;
     }
+    posSamplePtr->leapSeconds = leapSeconds;
 
-    if (INT32_MAX == posParamPtr->hAccuracy)
+    // Get position fix state
+    if (LE_OK != le_gnss_GetPositionState(positionSampleRef, &gnssState))
     {
-        *hflagPtr = false;
+        posSamplePtr->fixState = LE_POS_STATE_UNKNOWN;
+        LE_ERROR("Failed to get a position fix");
     }
     else
     {
-        // Accuracy is in meters with 2 decimal places
-        *hflagPtr = IsBeyondMagnitude(posSampleHandlerNodePtr->horizontalMagnitude,
-                                   horizontalMove,
-                                   posParamPtr->hAccuracy/100);
+        posSamplePtr->fixState = (le_pos_FixState_t)gnssState;
     }
-    LE_DEBUG("Vertical IsBeyondMagnitude.%d", *vflagPtr);
-    LE_DEBUG("Horizontal IsBeyondMagnitude.%d", *hflagPtr);
-    return LE_OK;
+
+    posSamplePtr->link = LE_DLS_LINK_INIT;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
  * The main position Sample Handler.
  *
+ * All the movement handlers are evaluated at once by the movement filter, and the GNSS position
+ * sample parameters are only retrieved once, when the first handler has to be notified.
+ *
  */
 //--------------------------------------------------------------------------------------------------
 static void PosSampleHandlerfunc
@@ -750,29 +701,10 @@ static void PosSampleHandlerfunc
     bool        altitudeValid = false;
     int32_t     altitude;
     int32_t     vAccuracy;
-    // Horizontal speed
-    uint32_t hSpeed;
-    uint32_t hSpeedAccuracy;
-    // Vertical speed
-    int32_t vSpeed;
-    int32_t vSpeedAccuracy;
-    // Direction
-    uint32_t direction;
-    uint32_t directionAccuracy;
-    // Date parameters
-    uint16_t year;
-    uint16_t month;
-    uint16_t day;
-    // Time parameters
-    uint16_t hours;
-    uint16_t minutes;
-    uint16_t seconds;
-    uint16_t milliseconds;
-    // Leap seconds in advance
-    uint8_t leapSeconds;
-    PositionParam_t posParam;
-    // the position fix state
-    le_gnss_FixState_t gnssState;
+    movementFilter_Position_t posParam;
+    // Position sample reported to the handlers
+    le_pos_Sample_t posSample;
+    bool            posSampleFilled = false;
 
     // Positioning sample parameters
     le_pos_SampleHandler_t* posSampleHandlerNodePtr;
@@ -844,163 +776,70 @@ static void PosSampleHandlerfunc
     posParam.locationValid = locationValid;
     posParam.altitudeValid = altitudeValid;
 
+    // Compute horizontal and vertical moves for all the handlers.
+    movementFilter_Evaluate(&posParam);
+
     do
     {
-        bool hflag, vflag;
         // Get the node from the list
         posSampleHandlerNodePtr = (le_pos_SampleHandler_t*)CONTAINER_OF(linkPtr,
                                                                         le_pos_SampleHandler_t,
                                                                         link);
 
-        if (LE_FAULT == ComputeMove(posSampleHandlerNodePtr, &posParam, &hflag, &vflag))
-        {
-            // Release provided Position sample reference
-            le_gnss_ReleaseSampleRef(positionSampleRef);
-            return;
-        }
-
         // Movement is detected in the following cases:
         // - Vertical distance is beyond the magnitude
         // - Horizontal distance is beyond the magnitude
         // - We don't care about vertical & horizontal distance (magnitudes equal to 0)
         //   therefore that movement handler is called each positioning acquisition rate
-        if (((0 != posSampleHandlerNodePtr->verticalMagnitude) && (vflag)) ||
-             ((0 != posSampleHandlerNodePtr->horizontalMagnitude) && (hflag)) ||
-             ((0 == posSampleHandlerNodePtr->verticalMagnitude)
-             && (0 == posSampleHandlerNodePtr->horizontalMagnitude)))
-        {
-            // Create the position sample node.
-            posSampleRequestPtr = le_mem_ForceAlloc(PosSampleRequestPoolRef);
-            posSampleRequestPtr->posSampleNodePtr
-                                = (le_pos_Sample_t*)le_mem_ForceAlloc(PosSamplePoolRef);
-            posSampleRequestPtr->posSampleNodePtr->latitudeValid
-                                = CHECK_VALIDITY(latitude,INT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->latitude = latitude;
-
-            posSampleRequestPtr->posSampleNodePtr->longitudeValid
-                                = CHECK_VALIDITY(longitude,INT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->longitude = longitude;
-
-            posSampleRequestPtr->posSampleNodePtr->hAccuracyValid
-                                = CHECK_VALIDITY(hAccuracy,INT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->hAccuracy = hAccuracy;
-
-            posSampleRequestPtr->posSampleNodePtr->altitudeValid
-                                = CHECK_VALIDITY(altitude,INT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->altitude = altitude;
-
-            posSampleRequestPtr->posSampleNodePtr->vAccuracyValid
-                                = CHECK_VALIDITY(vAccuracy,INT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->vAccuracy = vAccuracy;
-
-            // Get horizontal speed
-            le_gnss_GetHorizontalSpeed(positionSampleRef, &hSpeed, &hSpeedAccuracy);
-            posSampleRequestPtr->posSampleNodePtr->hSpeedValid
-                                    = CHECK_VALIDITY(hSpeed,UINT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->hSpeed = hSpeed;
-            posSampleRequestPtr->posSampleNodePtr->hSpeedAccuracyValid =
-                                                CHECK_VALIDITY(hSpeedAccuracy,UINT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->hSpeedAccuracy = hSpeedAccuracy;
-
-            // Get vertical speed
-            le_gnss_GetVerticalSpeed(positionSampleRef, &vSpeed, &vSpeedAccuracy);
-            posSampleRequestPtr->posSampleNodePtr->vSpeedValid
-                                = CHECK_VALIDITY(vSpeed,INT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->vSpeed = vSpeed;
-            posSampleRequestPtr->posSampleNodePtr->vSpeedAccuracyValid =
-                                                CHECK_VALIDITY(vSpeedAccuracy,INT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->vSpeedAccuracy = vSpeedAccuracy;
-
-            // Heading not supported by GNSS engine
-            posSampleRequestPtr->posSampleNodePtr->headingValid = false;
-            posSampleRequestPtr->posSampleNodePtr->heading = UINT32_MAX;
-            posSampleRequestPtr->posSampleNodePtr->headingAccuracyValid = false;
-            posSampleRequestPtr->posSampleNodePtr->headingAccuracy = UINT32_MAX;
-
-            // Get direction
-            le_gnss_GetDirection(positionSampleRef, &direction, &directionAccuracy);
-
-            posSampleRequestPtr->posSampleNodePtr->directionValid
-                                = CHECK_VALIDITY(direction,UINT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->direction = direction;
-            posSampleRequestPtr->posSampleNodePtr->directionAccuracyValid =
-                                            CHECK_VALIDITY(directionAccuracy,UINT32_MAX);
-            posSampleRequestPtr->posSampleNodePtr->directionAccuracy = directionAccuracy;
-
-            // Get UTC time
-            if (LE_OK == le_gnss_GetDate(positionSampleRef, &year, &month, &day))
-            {
-                posSampleRequestPtr->posSampleNodePtr->dateValid = true;
-            }
-            else
-            {
-                posSampleRequestPtr->posSampleNodePtr->dateValid = false;
-            }
-            posSampleRequestPtr->posSampleNodePtr->year = year;
-            posSampleRequestPtr->posSampleNodePtr->month = month;
-            posSampleRequestPtr->posSampleNodePtr->day = day;
-
-            if (LE_OK == le_gnss_GetTime(positionSampleRef, &hours, &minutes, &seconds,
-                                         &milliseconds))
-            {
-                posSampleRequestPtr->posSampleNodePtr->timeValid = true;
-            }
-            else
-            {
-                posSampleRequestPtr->posSampleNodePtr->timeValid = false;
-            }
-            posSampleRequestPtr->posSampleNodePtr->hours = hours;
-            posSampleRequestPtr->posSampleNodePtr->minutes = minutes;
-            posSampleRequestPtr->posSampleNodePtr->seconds = seconds;
-            posSampleRequestPtr->posSampleNodePtr->milliseconds = milliseconds;
+        switch (movementFilter_GetResult(&posSampleHandlerNodePtr->filterEntry))
+        {
+            case MOVEMENTFILTER_INVALID:
+                LE_ERROR("Position is not relevant for handler %p",
+                         posSampleHandlerNodePtr->handlerFuncPtr);
+                // Release provided Position sample reference
+                le_gnss_ReleaseSampleRef(positionSampleRef);
+                return;
 
-            // Get UTC leap seconds in advance
-            if (LE_OK == le_gnss_GetGpsLeapSeconds(positionSampleRef, &leapSeconds))
-            {
-               posSampleRequestPtr->posSampleNodePtr->leapSecondsValid = true;
-            }
-            else
-            {
-                posSampleRequestPtr->posSampleNodePtr->leapSecondsValid = false;
-            }
-            posSampleRequestPtr->posSampleNodePtr->leapSeconds = leapSeconds;
+            case MOVEMENTFILTER_NOT_MOVED:
+                break;
 
-            // Get position fix state
-            if (LE_OK != le_gnss_GetPositionState(positionSampleRef, &gnssState))
+            case MOVEMENTFILTER_MOVED:
             {
-                posSampleRequestPtr->posSampleNodePtr->fixState = LE_POS_STATE_UNKNOWN;
-                LE_ERROR("Failed to get a position fix");
-            }
-            else
-            {
-                posSampleRequestPtr->posSampleNodePtr->fixState = (le_pos_FixState_t)gnssState;
-            }
+                if (!posSampleFilled)
+                {
+                    FillPosSample(positionSampleRef, &posParam, &posSample);
+                    posSampleFilled = true;
+                }
 
-            posSampleRequestPtr->posSampleNodePtr->link = LE_DLS_LINK_INIT;
+                // Create the position sample node.
+                posSampleRequestPtr = le_mem_ForceAlloc(PosSampleRequestPoolRef);
+                posSampleRequestPtr->posSampleNodePtr
+                                    = (le_pos_Sample_t*)le_mem_ForceAlloc(PosSamplePoolRef);
+                *posSampleRequestPtr->posSampleNodePtr = posSample;
 
-            // Add the node to the queue of the list by passing in the node's link.
-            le_dls_Queue(&PosSampleList, &(posSampleRequestPtr->posSampleNodePtr->link));
+                // Add the node to the queue of the list by passing in the node's link.
+                le_dls_Queue(&PosSampleList, &(posSampleRequestPtr->posSampleNodePtr->link));
 
-            // Save the information reported to the handler function
-            posSampleHandlerNodePtr->lastLat = latitude;
-            posSampleHandlerNodePtr->lastLong = longitude;
-            posSampleHandlerNodePtr->lastAlt = altitude;
+                // Save the information reported to the handler function
+                movementFilter_SetLastPosition(&posSampleHandlerNodePtr->filterEntry, &posParam);
 
-            LE_DEBUG("Report sample %p to the corresponding handler (handler %p)",
-                     posSampleRequestPtr->posSampleNodePtr,
-                     posSampleHandlerNodePtr->handlerFuncPtr);
+                LE_DEBUG("Report sample %p to the corresponding handler (handler %p)",
+                         posSampleRequestPtr->posSampleNodePtr,
+                         posSampleHandlerNodePtr->handlerFuncPtr);
 
-            le_pos_SampleRef_t reqRef = le_ref_CreateRef(PosSampleMap, posSampleRequestPtr);
+                le_pos_SampleRef_t reqRef = le_ref_CreateRef(PosSampleMap, posSampleRequestPtr);
 
-            // Get the message session reference from handler function
-            posSampleRequestPtr->sessionRef = posSampleHandlerNodePtr->sessionRef;
+                // Get the message session reference from handler function
+                posSampleRequestPtr->sessionRef = posSampleHandlerNodePtr->sessionRef;
 
-            // Store posSample reference which will be used in close session handler
-            posSampleRequestPtr->positionSampleRef = reqRef;
+                // Store posSample reference which will be used in close session handler
+                posSampleRequestPtr->positionSampleRef = reqRef;
 
-            // Call the client's handler
-            posSampleHandlerNodePtr->handlerFuncPtr(reqRef,
-                                            posSampleHandlerNodePtr->handlerContextPtr);
+                // Call the client's handler
+                posSampleHandlerNodePtr->handlerFuncPtr(reqRef,
+                                                posSampleHandlerNodePtr->handlerContextPtr);
+                break;
+            }
         }
 
         // Move to the next node.
@@ -1187,6 +1026,9 @@ COMPONENT_INIT
     NumOfHandlers = 0;
     GnssHandlerRef = NULL;
 
+    // Initialize the movement filter of the position sample handlers.
+    movementFilter_Init();
+
     // Create safe reference map for request references. The size of the map should be based on
     // the expected number of simultaneous data requests, so take a reasonable guess.
     ActivationRequestRefMap = le_ref_CreateMap("Positioning Client", POSITIONING_ACTIVATION_MAX);
@@ -1359,10 +1201,10 @@ le_pos_MovementHandlerRef_t le_pos_AddMovementHandler
     posSampleHandlerNodePtr->horizontalMagnitude = horizontalMagnitude;
     posSampleHandlerNodePtr->verticalMagnitude = verticalMagnitude;
 
-    // Initialization of lastLat, lastLong and lastAlt.
-    posSampleHandlerNodePtr->lastLat = 0;
-    posSampleHandlerNodePtr->lastLong = 0;
-    posSampleHandlerNodePtr->lastAlt = 0;
+    // The last position is initialized by the first evaluation.
+    movementFilter_Add(&posSampleHandlerNodePtr->filterEntry,
+                       horizontalMagnitude,
+                       verticalMagnitude);
 
     // Start acquisition
     if (0 == NumOfHandlers)
@@ -0,0 +1,478 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file movementFilter.c
+ *
+ * This file contains the source code of the movement filter.
+ *
+ * The parameters of the movement handlers are stored in blocks of contiguous 32-bit arrays. For
+ * every fix, the trigonometry of the new position is computed once, then all the handlers of a
+ * block are evaluated in a single branch-free loop the compiler can vectorize (the component is
+ * built with -fno-trapping-math so that the float comparisons can be if-converted). The horizontal
+ * distance is approximated with the equirectangular projection on the coordinate differences, and
+ * compared squared against the thresholds so that no square root is needed. The few handlers for
+ * which the approximation is not accurate enough (long distances, polar regions) are evaluated
+ * again with the Haversine formula.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "movementFilter.h"
+
+#include <math.h>
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of handlers per block. Must not exceed the number of bits of the block masks.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FILTER_BLOCK_SIZE           64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mean earth radius, in meters.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EARTH_RADIUS_M              6371000.0
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Conversion from the API angle unit (degrees with 6 decimal places) to radians.
+ */
+//--------------------------------------------------------------------------------------------------
+#define POS_TO_RAD(_pos_)           (((double)(_pos_)) / 1000000.0 * M_PI / 180.0)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Length of an arc of one API angle unit on the earth surface, in meters.
+ */
+//--------------------------------------------------------------------------------------------------
+#define METERS_PER_POS_UNIT         ((float)(EARTH_RADIUS_M * M_PI / 180.0 / 1000000.0))
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Domain of the equirectangular approximation: below this distance and latitude, its error is
+ * below one centimeter.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EQUIRECT_MAX_DISTANCE_M     10000.0f
+#define EQUIRECT_MAX_LATITUDE       80000000
+
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+// Data structures.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Block of movement handlers, stored as one array per parameter.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct movementFilter_Block
+{
+    uint64_t      usedMask;                         ///< Entries in use.
+    uint64_t      pendingMask;                      ///< Entries with an unset last position value.
+    int32_t       lastLat[FILTER_BLOCK_SIZE];       ///< Last reported latitude.
+    int32_t       lastLong[FILTER_BLOCK_SIZE];      ///< Last reported longitude.
+    int32_t       lastAlt[FILTER_BLOCK_SIZE];       ///< Last reported altitude.
+    float         lastCosLat[FILTER_BLOCK_SIZE];    ///< Cosine of the last reported latitude.
+    float         hMagnitude[FILTER_BLOCK_SIZE];    ///< Horizontal magnitude, in meters.
+    float         vMagnitude[FILTER_BLOCK_SIZE];    ///< Vertical magnitude.
+    int32_t       needLocation[FILTER_BLOCK_SIZE];  ///< 1 if the horizontal magnitude is not 0.
+    int32_t       needAltitude[FILTER_BLOCK_SIZE];  ///< 1 if the vertical magnitude is not 0.
+    int32_t       dontCare[FILTER_BLOCK_SIZE];      ///< 1 if both magnitudes are 0.
+    int32_t       needExact[FILTER_BLOCK_SIZE];     ///< 1 if the approximation must be checked.
+    int32_t       vBeyond[FILTER_BLOCK_SIZE];       ///< 1 if the vertical move is beyond.
+    int32_t       result[FILTER_BLOCK_SIZE];        ///< Result of the last evaluation.
+    le_dls_Link_t link;                             ///< Link in the block list.
+}
+Block_t;
+
+//--------------------------------------------------------------------------------------------------
+// Static declarations.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of handler blocks.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t BlockPoolRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of handler blocks.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t BlockList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Calculate the distance in meters between two fix points (use Haversine formula).
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t ComputeDistance
+(
+    int32_t latitude1,
+    int32_t longitude1,
+    int32_t latitude2,
+    int32_t longitude2
+)
+{
+    // Haversine formula:
+    // a = sin²(Δφ/2) + cos(φ1).cos(φ2).sin²(Δλ/2)
+    // c = 2.atan2(√a, √(1−a))
+    // distance = R.c (in meters)
+    // where φ is latitude, λ is longitude, R is earth’s radius (mean radius = 6,371km)
+    double dLat = POS_TO_RAD((double)latitude2 - (double)latitude1);
+    double dLon = POS_TO_RAD((double)longitude2 - (double)longitude1);
+    double lat1 = POS_TO_RAD(latitude1);
+    double lat2 = POS_TO_RAD(latitude2);
+    double a, c;
+
+    a = sin(dLat/2) * sin(dLat/2) + sin(dLon/2) * sin(dLon/2) * cos(lat1) * cos(lat2);
+    c = 2 * atan2(sqrt(a), sqrt(1-a));
+
+    LE_DEBUG("Computed distance is %e meters (double)", EARTH_RADIUS_M * c);
+    return (uint32_t)(EARTH_RADIUS_M * c);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Verify if the covered distance is beyond the magnitude.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsBeyondMagnitude
+(
+    uint32_t magnitude,
+    uint32_t move,
+    uint32_t accuracy
+)
+{
+    if (move > magnitude)
+    {
+        // Check that it doesn't just look like we are beyond the magnitude because of bad accuracy.
+        if ((accuracy > move) || ((move - accuracy) < magnitude))
+        {
+            // Could be beyond the magnitude, but we also could be inside the fence.
+            return false;
+        }
+        else
+        {
+            // Definitely beyond the magnitude!
+            return true;
+        }
+    }
+    else
+    {
+        return false;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the cached trigonometry of the last reported position of a handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateLastPosition
+(
+    Block_t* blockPtr,
+    uint32_t index
+)
+{
+    blockPtr->lastCosLat[index] = (float)cos(POS_TO_RAD(blockPtr->lastLat[index]));
+
+    if ((0 == blockPtr->lastLat[index]) ||
+        (0 == blockPtr->lastLong[index]) ||
+        (0 == blockPtr->lastAlt[index]))
+    {
+        blockPtr->pendingMask |= ((uint64_t)1 << index);
+    }
+    else
+    {
+        blockPtr->pendingMask &= ~((uint64_t)1 << index);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a position lacks a value required by a handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsInvalid
+(
+    const Block_t*                   blockPtr,
+    uint32_t                         index,
+    const movementFilter_Position_t* posPtr
+)
+{
+    return ((blockPtr->needLocation[index] && !posPtr->locationValid) ||
+            (blockPtr->needAltitude[index] && !posPtr->altitudeValid));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluate the handlers of a block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EvaluateBlock
+(
+    Block_t*                         blockPtr,
+    const movementFilter_Position_t* posPtr,
+    float                            cosLat,    ///< Cosine of the latitude of the position.
+    float                            hAccTerm,  ///< Horizontal accuracy term of the thresholds.
+    float                            vAccTerm   ///< Vertical accuracy term of the thresholds.
+)
+{
+    const float exactDist2 = EQUIRECT_MAX_DISTANCE_M * EQUIRECT_MAX_DISTANCE_M;
+    const int32_t forceExact = (abs(posPtr->latitude) > EQUIRECT_MAX_LATITUDE);
+    const int32_t locationInvalid = !posPtr->locationValid;
+    const int32_t altitudeInvalid = !posPtr->altitudeValid;
+    const uint32_t latitude = posPtr->latitude;
+    const uint32_t longitude = posPtr->longitude;
+    const uint32_t altitude = posPtr->altitude;
+    uint64_t mask;
+    uint32_t i;
+
+    // The last position of new handlers is the first position they are evaluated with.
+    mask = blockPtr->pendingMask & blockPtr->usedMask;
+    while (mask)
+    {
+        i = __builtin_ctzll(mask);
+        mask &= mask - 1;
+
+        if (IsInvalid(blockPtr, i, posPtr))
+        {
+            continue;
+        }
+        if (0 == blockPtr->lastLat[i])
+        {
+            blockPtr->lastLat[i] = posPtr->latitude;
+        }
+        if (0 == blockPtr->lastLong[i])
+        {
+            blockPtr->lastLong[i] = posPtr->longitude;
+        }
+        if (0 == blockPtr->lastAlt[i])
+        {
+            blockPtr->lastAlt[i] = posPtr->altitude;
+        }
+        UpdateLastPosition(blockPtr, i);
+    }
+
+    // A move is beyond a magnitude when move >= magnitude + max(1, accuracy), see
+    // IsBeyondMagnitude(). The coordinate differences are computed on integers, where they are
+    // exact, before being scaled to meters.
+    for (i = 0; i < FILTER_BLOCK_SIZE; i++)
+    {
+        float y = (float)(int32_t)(latitude - blockPtr->lastLat[i]) * METERS_PER_POS_UNIT;
+        float x = (float)(int32_t)(longitude - blockPtr->lastLong[i]) * METERS_PER_POS_UNIT *
+                  0.5f * (cosLat + blockPtr->lastCosLat[i]);
+        float dist2 = (x * x) + (y * y);
+        float hThreshold = blockPtr->hMagnitude[i] + hAccTerm;
+        int32_t vMove = (int32_t)(altitude - blockPtr->lastAlt[i]);
+        vMove = (vMove < 0) ? -vMove : vMove;
+
+        int32_t hBeyond = (dist2 >= (hThreshold * hThreshold));
+        int32_t vBeyond = ((float)vMove >= (blockPtr->vMagnitude[i] + vAccTerm));
+        int32_t far = (dist2 >= exactDist2);
+        int32_t invalid = (blockPtr->needLocation[i] & locationInvalid) |
+                          (blockPtr->needAltitude[i] & altitudeInvalid);
+        int32_t moved = (blockPtr->needLocation[i] & hBeyond) |
+                        (blockPtr->needAltitude[i] & vBeyond) |
+                        blockPtr->dontCare[i];
+
+        blockPtr->vBeyond[i] = vBeyond;
+        blockPtr->needExact[i] = blockPtr->needLocation[i] & (1 - invalid) & (far | forceExact);
+        blockPtr->result[i] = invalid ? MOVEMENTFILTER_INVALID : moved;
+    }
+
+    // Check the long distances with the exact formula.
+    for (i = 0; i < FILTER_BLOCK_SIZE; i++)
+    {
+        if (blockPtr->needExact[i] && (blockPtr->usedMask & ((uint64_t)1 << i)))
+        {
+            uint32_t move = ComputeDistance(blockPtr->lastLat[i], blockPtr->lastLong[i],
+                                            posPtr->latitude, posPtr->longitude);
+            bool hBeyond = (INT32_MAX != posPtr->hAccuracy) &&
+                           IsBeyondMagnitude((uint32_t)blockPtr->hMagnitude[i],
+                                             move,
+                                             posPtr->hAccuracy/100);
+            blockPtr->result[i] = (hBeyond || (blockPtr->needAltitude[i] & blockPtr->vBeyond[i])) ?
+                                  MOVEMENTFILTER_MOVED
+                                  : MOVEMENTFILTER_NOT_MOVED;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the movement filter.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Init
+(
+    void
+)
+{
+    BlockPoolRef = le_mem_CreatePool("MovementFilterBlock", sizeof(Block_t));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a movement handler to the movement filter. Its last position is unknown until the first
+ * evaluation.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Add
+(
+    movementFilter_Entry_t* entryPtr,       ///< [OUT] Entry of the handler.
+    uint32_t                horizontalMagnitude, ///< [IN] The horizontal magnitude in meters.
+    uint32_t                verticalMagnitude    ///< [IN] The vertical magnitude.
+)
+{
+    Block_t*       blockPtr = NULL;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&BlockList);
+    uint32_t       i;
+
+    // Look for a free entry in the existing blocks.
+    while (linkPtr)
+    {
+        blockPtr = CONTAINER_OF(linkPtr, Block_t, link);
+        if (UINT64_MAX != blockPtr->usedMask)
+        {
+            break;
+        }
+        blockPtr = NULL;
+        linkPtr = le_dls_PeekNext(&BlockList, linkPtr);
+    }
+
+    if (NULL == blockPtr)
+    {
+        blockPtr = le_mem_ForceAlloc(BlockPoolRef);
+        memset(blockPtr, 0, sizeof(Block_t));
+        blockPtr->link = LE_DLS_LINK_INIT;
+        le_dls_Queue(&BlockList, &blockPtr->link);
+    }
+
+    i = __builtin_ctzll(~blockPtr->usedMask);
+    blockPtr->usedMask |= ((uint64_t)1 << i);
+
+    blockPtr->lastLat[i] = 0;
+    blockPtr->lastLong[i] = 0;
+    blockPtr->lastAlt[i] = 0;
+    UpdateLastPosition(blockPtr, i);
+
+    blockPtr->hMagnitude[i] = horizontalMagnitude;
+    blockPtr->vMagnitude[i] = verticalMagnitude;
+    blockPtr->needLocation[i] = (0 != horizontalMagnitude);
+    blockPtr->needAltitude[i] = (0 != verticalMagnitude);
+    blockPtr->dontCare[i] = ((0 == horizontalMagnitude) && (0 == verticalMagnitude));
+    blockPtr->result[i] = MOVEMENTFILTER_NOT_MOVED;
+
+    entryPtr->blockPtr = blockPtr;
+    entryPtr->index = i;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a movement handler from the movement filter.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Remove
+(
+    movementFilter_Entry_t* entryPtr        ///< [IN] Entry of the handler.
+)
+{
+    Block_t* blockPtr = entryPtr->blockPtr;
+
+    if (NULL == blockPtr)
+    {
+        return;
+    }
+
+    blockPtr->usedMask &= ~((uint64_t)1 << entryPtr->index);
+    blockPtr->pendingMask &= ~((uint64_t)1 << entryPtr->index);
+
+    if (0 == blockPtr->usedMask)
+    {
+        le_dls_Remove(&BlockList, &blockPtr->link);
+        le_mem_Release(blockPtr);
+    }
+
+    entryPtr->blockPtr = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluate all the movement handlers against a new position. The results are then retrieved with
+ * movementFilter_GetResult().
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Evaluate
+(
+    const movementFilter_Position_t* posPtr ///< [IN] The new position.
+)
+{
+    le_dls_Link_t* linkPtr;
+    float          cosLat = (float)cos(POS_TO_RAD(posPtr->latitude));
+    float          hAccTerm = INFINITY;
+    float          vAccTerm = INFINITY;
+
+    // Horizontal accuracy is in meters with 2 decimal places.
+    if ((INT32_MAX != posPtr->hAccuracy) && (posPtr->hAccuracy/100 >= 0))
+    {
+        hAccTerm = (posPtr->hAccuracy/100 < 1) ? 1 : posPtr->hAccuracy/100;
+    }
+
+    // Vertical accuracy is in meters with 1 decimal place.
+    if ((INT32_MAX != posPtr->vAccuracy) && (posPtr->vAccuracy/10 >= 0))
+    {
+        vAccTerm = (posPtr->vAccuracy/10 < 1) ? 1 : posPtr->vAccuracy/10;
+    }
+
+    for (linkPtr = le_dls_Peek(&BlockList);
+         NULL != linkPtr;
+         linkPtr = le_dls_PeekNext(&BlockList, linkPtr))
+    {
+        EvaluateBlock(CONTAINER_OF(linkPtr, Block_t, link),
+                      posPtr, cosLat, hAccTerm, vAccTerm);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the result of the last evaluation for a movement handler.
+ */
+//--------------------------------------------------------------------------------------------------
+movementFilter_Result_t movementFilter_GetResult
+(
+    const movementFilter_Entry_t* entryPtr  ///< [IN] Entry of the handler.
+)
+{
+    return (movementFilter_Result_t)entryPtr->blockPtr->result[entryPtr->index];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the position last reported to a movement handler.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_SetLastPosition
+(
+    const movementFilter_Entry_t*    entryPtr,  ///< [IN] Entry of the handler.
+    const movementFilter_Position_t* posPtr     ///< [IN] The reported position.
+)
+{
+    Block_t* blockPtr = entryPtr->blockPtr;
+
+    blockPtr->lastLat[entryPtr->index] = posPtr->latitude;
+    blockPtr->lastLong[entryPtr->index] = posPtr->longitude;
+    blockPtr->lastAlt[entryPtr->index] = posPtr->altitude;
+    UpdateLastPosition(blockPtr, entryPtr->index);
+}
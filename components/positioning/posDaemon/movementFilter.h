@@ -0,0 +1,126 @@
+/**
+ * @file movementFilter.h
+ *
+ * Movement filter interface.
+ *
+ * The movement filter decides, for every registered movement handler, whether a new position is
+ * far enough from the position last reported to that handler. The handler parameters are stored
+ * in blocks of contiguous arrays so that all the handlers are evaluated in a single pass per fix.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_MOVEMENT_FILTER_INCLUDE_GUARD
+#define LEGATO_MOVEMENT_FILTER_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Result of the evaluation of a movement handler.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    MOVEMENTFILTER_NOT_MOVED = 0,   ///< Movement is below the handler magnitudes.
+    MOVEMENTFILTER_MOVED,           ///< Movement is beyond one of the handler magnitudes, or the
+                                    ///  handler does not care about the magnitudes.
+    MOVEMENTFILTER_INVALID          ///< The position lacks a value required by the handler.
+}
+movementFilter_Result_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position used for the move calculation.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int32_t  latitude;          ///< Latitude, in degrees with 6 decimal places.
+    int32_t  longitude;         ///< Longitude, in degrees with 6 decimal places.
+    int32_t  altitude;          ///< Altitude.
+    int32_t  vAccuracy;         ///< Vertical accuracy, in meters with 1 decimal place.
+    int32_t  hAccuracy;         ///< Horizontal accuracy, in meters with 2 decimal places.
+    bool     locationValid;     ///< If true, location is set.
+    bool     altitudeValid;     ///< If true, altitude is set.
+}
+movementFilter_Position_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of a movement handler in the movement filter.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    struct movementFilter_Block* blockPtr;  ///< Block holding the handler parameters.
+    uint32_t                     index;     ///< Index of the handler in the block.
+}
+movementFilter_Entry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the movement filter.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a movement handler to the movement filter. Its last position is unknown until the first
+ * evaluation.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Add
+(
+    movementFilter_Entry_t* entryPtr,       ///< [OUT] Entry of the handler.
+    uint32_t                horizontalMagnitude, ///< [IN] The horizontal magnitude in meters.
+    uint32_t                verticalMagnitude    ///< [IN] The vertical magnitude.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a movement handler from the movement filter.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Remove
+(
+    movementFilter_Entry_t* entryPtr        ///< [IN] Entry of the handler.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Evaluate all the movement handlers against a new position. The results are then retrieved with
+ * movementFilter_GetResult().
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_Evaluate
+(
+    const movementFilter_Position_t* posPtr ///< [IN] The new position.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the result of the last evaluation for a movement handler.
+ */
+//--------------------------------------------------------------------------------------------------
+movementFilter_Result_t movementFilter_GetResult
+(
+    const movementFilter_Entry_t* entryPtr  ///< [IN] Entry of the handler.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the position last reported to a movement handler.
+ */
+//--------------------------------------------------------------------------------------------------
+void movementFilter_SetLastPosition
+(
+    const movementFilter_Entry_t*    entryPtr,  ///< [IN] Entry of the handler.
+    const movementFilter_Position_t* posPtr     ///< [IN] The reported position.
+);
+
+#endif // LEGATO_MOVEMENT_FILTER_INCLUDE_GUARD
@@ -0,0 +1,501 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file nmeaPipe.c
+ *
+ * This file contains the source code of the NMEA pipe writer.
+ *
+ * The sentences reported by the PA during an epoch are appended to a bounded buffer, which is
+ * written to the pipe in a single system call once the epoch is over. The pipe is opened in
+ * non-blocking mode: whatever the reader does not consume stays in the buffer and is written when
+ * the pipe becomes writable again. When the buffer is full, the oldest complete sentences are
+ * dropped, so that the reader only gets whole sentences.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "nmeaPipe.h"
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the NMEA buffer. Must hold at least all the sentences of one epoch.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef LE_GNSS_NMEA_BUFFER_BYTES
+#define LE_GNSS_NMEA_BUFFER_BYTES               8192
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time to wait after the first sentence of an epoch before writing the buffer, in milliseconds.
+ * The PA reports the sentences of an epoch in a burst, well below the shortest acquisition rate.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef LE_GNSS_NMEA_FLUSH_DELAY_MS
+#define LE_GNSS_NMEA_FLUSH_DELAY_MS             20
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer filling level above which the buffer is written without waiting for the end of the
+ * epoch.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_BUFFER_HIGH_WATERMARK              ((LE_GNSS_NMEA_BUFFER_BYTES * 3) / 4)
+
+//--------------------------------------------------------------------------------------------------
+// Static declarations.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA pipe path
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* PipePathPtr = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA pipe file descriptor
+ */
+//--------------------------------------------------------------------------------------------------
+static int PipeFd = -1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Monitor of the NMEA pipe, used to resume writing when the pipe becomes writable.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_fdMonitor_Ref_t PipeMonitorRef = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer used to write the buffer at the end of the epoch.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t FlushTimerRef = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA buffer. Holds the pending sentences, each one terminated by its null character as the
+ * reader expects them.
+ */
+//--------------------------------------------------------------------------------------------------
+static char Buffer[LE_GNSS_NMEA_BUFFER_BYTES];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes pending in the NMEA buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t BufferLen = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes of the first pending sentence already written to the pipe. That sentence must
+ * be completed and cannot be dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t HeadWrittenLen = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics
+ */
+//--------------------------------------------------------------------------------------------------
+static nmeaPipe_Stats_t Stats;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the sentences in a part of the buffer.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t CountSentences
+(
+    const char* dataPtr,
+    size_t len
+)
+{
+    uint32_t count = 0;
+    const char* endPtr = dataPtr + len;
+
+    while ((dataPtr < endPtr) && (NULL != (dataPtr = memchr(dataPtr, '\0', endPtr - dataPtr))))
+    {
+        count++;
+        dataPtr++;
+    }
+
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drop all the pending sentences.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DropAll
+(
+    void
+)
+{
+    if (BufferLen)
+    {
+        Stats.droppedSentences += CountSentences(Buffer, BufferLen);
+        Stats.droppedBytes += BufferLen;
+    }
+
+    BufferLen = 0;
+    HeadWrittenLen = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drop the oldest complete sentence that has not been written at all.
+ *
+ * @return
+ *      true if a sentence was dropped, false if there was nothing to drop.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DropOldest
+(
+    void
+)
+{
+    size_t start = 0;
+    char* endPtr;
+
+    if (HeadWrittenLen)
+    {
+        // Skip the sentence being written.
+        endPtr = memchr(Buffer, '\0', BufferLen);
+        if (NULL == endPtr)
+        {
+            return false;
+        }
+        start = endPtr - Buffer + 1;
+    }
+
+    if (start >= BufferLen)
+    {
+        return false;
+    }
+
+    endPtr = memchr(Buffer + start, '\0', BufferLen - start);
+    if (NULL == endPtr)
+    {
+        return false;
+    }
+
+    size_t len = endPtr - (Buffer + start) + 1;
+    memmove(Buffer + start, Buffer + start + len, BufferLen - start - len);
+    BufferLen -= len;
+
+    Stats.droppedSentences++;
+    Stats.droppedBytes += len;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the NMEA pipe
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClosePipe
+(
+    void
+)
+{
+    int result;
+
+    if (-1 == PipeFd)
+    {
+        return;
+    }
+
+    if (PipeMonitorRef)
+    {
+        le_fdMonitor_Delete(PipeMonitorRef);
+        PipeMonitorRef = NULL;
+    }
+
+    do
+    {
+        result = close(PipeFd);
+    }
+    while ((result != 0) && (errno == EINTR));
+
+    LE_ERROR_IF(result != 0, "Could not close %s. errno.%d (%s)",
+                PipePathPtr, errno, strerror(errno));
+
+    PipeFd = -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler called when the NMEA pipe becomes writable, or when its reader went away.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PipeMonitorHandler
+(
+    int fd,
+    short events
+)
+{
+    if (events & (POLLERR | POLLHUP | POLLRDHUP))
+    {
+        LE_DEBUG("Reader of %s went away", PipePathPtr);
+        ClosePipe();
+        DropAll();
+        return;
+    }
+
+    if (events & POLLOUT)
+    {
+        nmeaPipe_Flush();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the NMEA pipe
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the pipe could not be opened, e.g. because nobody is reading it.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t OpenPipe
+(
+    void
+)
+{
+    if (-1 != PipeFd)
+    {
+        return LE_OK;
+    }
+
+    do
+    {
+        PipeFd = open(PipePathPtr, O_WRONLY|O_APPEND|O_CLOEXEC|O_NONBLOCK);
+    }
+    while ((-1 == PipeFd) && (EINTR == errno));
+
+    if (-1 == PipeFd)
+    {
+        // ENXIO: no reader.
+        LE_WARN_IF(errno != ENXIO, "Open %s failure: errno.%d (%s)",
+                   PipePathPtr, errno, strerror(errno));
+        return LE_FAULT;
+    }
+
+    // Only watch for errors until some data is pending.
+    PipeMonitorRef = le_fdMonitor_Create("NmeaPipe", PipeFd, PipeMonitorHandler, 0);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler of the end of epoch timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    nmeaPipe_Flush();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the NMEA pipe writer. Must be called from the thread whose event loop will write to
+ * the pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Init
+(
+    const char* pathPtr         ///< [IN] Path of the NMEA pipe.
+)
+{
+    PipePathPtr = pathPtr;
+
+    memset(&Stats, 0, sizeof(Stats));
+    BufferLen = 0;
+    HeadWrittenLen = 0;
+
+    if (NULL == FlushTimerRef)
+    {
+        FlushTimerRef = le_timer_Create("NmeaFlush");
+        LE_ASSERT_OK(le_timer_SetMsInterval(FlushTimerRef, LE_GNSS_NMEA_FLUSH_DELAY_MS));
+        LE_ASSERT_OK(le_timer_SetHandler(FlushTimerRef, FlushTimerHandler));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the NMEA named pipe (FIFO).
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Create
+(
+    void
+)
+{
+    int result = 0;
+
+    LE_DEBUG("Create %s", PipePathPtr);
+
+    // Create the node for /dev/nmea device folder
+    umask(0);
+    result = mknod(PipePathPtr, S_IFIFO|0666, 0);
+
+    LE_ERROR_IF((result != 0)&&(errno != EEXIST),
+                "Could not create %s. errno.%d (%s)", PipePathPtr, errno, strerror(errno));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a NMEA sentence. The sentences of an epoch are written together once the epoch is over,
+ * or as soon as the buffer is filling up.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Write
+(
+    const char* nmeaStringPtr   ///< [IN] NMEA sentence.
+)
+{
+    size_t len = strlen(nmeaStringPtr) + 1;
+
+    if (len > sizeof(Buffer))
+    {
+        LE_ERROR("NMEA sentence too long (%zu bytes)", len);
+        Stats.droppedSentences++;
+        Stats.droppedBytes += len;
+        return;
+    }
+
+    // Make room by dropping the oldest sentences, or this one if the buffer only holds a sentence
+    // being written.
+    while ((BufferLen + len) > sizeof(Buffer))
+    {
+        if (!DropOldest())
+        {
+            Stats.droppedSentences++;
+            Stats.droppedBytes += len;
+            return;
+        }
+    }
+
+    memcpy(Buffer + BufferLen, nmeaStringPtr, len);
+    BufferLen += len;
+    Stats.sentences++;
+
+    if (BufferLen >= NMEA_BUFFER_HIGH_WATERMARK)
+    {
+        nmeaPipe_Flush();
+    }
+    else if (!le_timer_IsRunning(FlushTimerRef))
+    {
+        le_timer_Start(FlushTimerRef);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the queued sentences without waiting for the end of the epoch. Never blocks: what the pipe
+ * cannot accept now is written when the pipe becomes writable again.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Flush
+(
+    void
+)
+{
+    ssize_t written;
+
+    if (le_timer_IsRunning(FlushTimerRef))
+    {
+        le_timer_Stop(FlushTimerRef);
+    }
+
+    if (0 == BufferLen)
+    {
+        return;
+    }
+
+    if (LE_OK != OpenPipe())
+    {
+        DropAll();
+        return;
+    }
+
+    do
+    {
+        written = write(PipeFd, Buffer, BufferLen);
+        Stats.writes++;
+    }
+    while ((-1 == written) && (EINTR == errno));
+
+    if (-1 == written)
+    {
+        if (EAGAIN == errno)
+        {
+            // The reader is late: keep the data and wait until the pipe is writable.
+            le_fdMonitor_Enable(PipeMonitorRef, POLLOUT);
+            return;
+        }
+
+        LE_ERROR("Could not write to %s (write error, errno.%d (%s))",
+                 PipePathPtr, errno, strerror(errno));
+        ClosePipe();
+        DropAll();
+        return;
+    }
+
+    Stats.writtenBytes += written;
+
+    // Keep track of the sentence that has been partially written, if any.
+    char* lastEndPtr = memrchr(Buffer, '\0', written);
+    if (lastEndPtr)
+    {
+        HeadWrittenLen = written - (lastEndPtr - Buffer + 1);
+    }
+    else
+    {
+        HeadWrittenLen += written;
+    }
+
+    memmove(Buffer, Buffer + written, BufferLen - written);
+    BufferLen -= written;
+
+    if (BufferLen)
+    {
+        le_fdMonitor_Enable(PipeMonitorRef, POLLOUT);
+    }
+    else
+    {
+        le_fdMonitor_Disable(PipeMonitorRef, POLLOUT);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the NMEA pipe writer statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_GetStats
+(
+    nmeaPipe_Stats_t* statsPtr  ///< [OUT] Statistics.
+)
+{
+    LE_ASSERT(statsPtr);
+
+    *statsPtr = Stats;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file nmeaPipe.h
+ *
+ * NMEA pipe writer interface.
+ *
+ * NMEA sentences are buffered per epoch and written to the NMEA pipe in one system call, without
+ * ever blocking the event loop: when the reader is slow or absent, the oldest sentences are dropped.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_NMEA_PIPE_INCLUDE_GUARD
+#define LEGATO_NMEA_PIPE_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA pipe writer statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t sentences;         ///< Number of sentences queued.
+    uint64_t writes;            ///< Number of write system calls.
+    uint64_t writtenBytes;      ///< Number of bytes written to the pipe.
+    uint64_t droppedSentences;  ///< Number of sentences dropped (no reader or backpressure).
+    uint64_t droppedBytes;      ///< Number of bytes dropped.
+}
+nmeaPipe_Stats_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the NMEA pipe writer. Must be called from the thread whose event loop will write to
+ * the pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Init
+(
+    const char* pathPtr         ///< [IN] Path of the NMEA pipe.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create the NMEA named pipe (FIFO).
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Create
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a NMEA sentence. The sentences of an epoch are written together once the epoch is over,
+ * or as soon as the buffer is filling up.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Write
+(
+    const char* nmeaStringPtr   ///< [IN] NMEA sentence.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the queued sentences without waiting for the end of the epoch. Never blocks: what the pipe
+ * cannot accept now is written when the pipe becomes writable again.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_Flush
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the NMEA pipe writer statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+void nmeaPipe_GetStats
+(
+    nmeaPipe_Stats_t* statsPtr  ///< [OUT] Statistics.
+);
+
+#endif // LEGATO_NMEA_PIPE_INCLUDE_GUARD
@@ -17,16 +17,51 @@
 // Symbol and Enum definitions.
 //--------------------------------------------------------------------------------------------------
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Power Management sysfs directory. Can be overridden at build time.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef PM_SYSFS_DIR
+#define PM_SYSFS_DIR        /sys/power
+#endif
+
 ///@{
 //--------------------------------------------------------------------------------------------------
 /**
  * Power Management sysfs interface files
  */
 //--------------------------------------------------------------------------------------------------
-#define WAKE_LOCK_FILE      "/sys/power/wake_lock"
-#define WAKE_UNLOCK_FILE    "/sys/power/wake_unlock"
+#define WAKE_LOCK_FILE      STRINGIZE(PM_SYSFS_DIR) "/wake_lock"
+#define WAKE_UNLOCK_FILE    STRINGIZE(PM_SYSFS_DIR) "/wake_unlock"
 ///@}
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Aggregate the wakeup sources of all clients into a single kernel wakeup source. Can be overridden
+ * at build time.
+ *
+ * When aggregation is enabled, the kernel wakeup source is held as long as any client wakeup source
+ * is held, and released PM_RELAX_HYSTERESIS_MS after the last one is released.  Clients that
+ * acquire and release wakeup sources around short operations then cost no kernel access, and do
+ * not let the system suspend and resume in between.  The client wakeup sources are still accounted
+ * for, but are not visible in the kernel.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef PM_AGGREGATE_WAKEUP_SOURCES
+#define PM_AGGREGATE_WAKEUP_SOURCES 0
+#endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delay in milliseconds before the aggregated kernel wakeup source is released, once no client
+ * wakeup source is held. Can be overridden at build time.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef PM_RELAX_HYSTERESIS_MS
+#define PM_RELAX_HYSTERESIS_MS      100
+#endif
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Legato's prefix for wakeup source names
@@ -52,6 +87,13 @@
 #define LEGATO_WS_NAME_LEN (sizeof(LEGATO_TAG_PREFIX) + LE_PM_TAG_LEN + LEGATO_WS_PROCNAME_LEN + 3)
 ///@}
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the kernel wakeup source held on behalf of all clients when aggregation is enabled
+ */
+//--------------------------------------------------------------------------------------------------
+#define LEGATO_AGGREGATE_WS_NAME LEGATO_TAG_PREFIX"_powerMgr"
+
 //--------------------------------------------------------------------------------------------------
 /**
  * The timer interval to kick the watchdog chain.
@@ -82,6 +124,9 @@ typedef struct
     pid_t         pid;      // client pid of wakeup source owner
     void          *wsref;   // back-pointer to safe reference
     bool          isRef;     // true if reference counted, false if not
+    uint32_t      acquireCount; // number of times the wakeup source was acquired
+    le_clk_Time_t acquireTime;  // time the wakeup source was last acquired
+    le_clk_Time_t heldTime;     // total time the wakeup source was held
 }
 WakeupSource_t;
 #define PM_WAKEUP_SOURCE_COOKIE 0xa1f6337b
@@ -116,8 +161,15 @@ static struct
     le_mem_PoolRef_t    cpool;   // memory pool for client records
     le_hashmap_Ref_t    clients; // table of client records
     bool                isFull;  // le_pm_StayAwke() fails with LE_NO_MEMORY
+    bool                isAggregated; // client wakeup sources aggregated in the kernel
+    uint32_t            hysteresisMs; // delay before releasing the aggregated wakeup source
+    uint32_t            awakeCount;   // number of client wakeup sources held
+    bool                isKernelAwake;// aggregated kernel wakeup source held
+    le_timer_Ref_t      relaxTimer;   // timer releasing the aggregated wakeup source
+    pm_Stats_t          stats;        // kernel accesses
 }
-PowerManager = {-1, -1, NULL, NULL, NULL, NULL, NULL, false};
+PowerManager = {-1, -1, NULL, NULL, NULL, NULL, NULL, false,
+                PM_AGGREGATE_WAKEUP_SOURCES, PM_RELAX_HYSTERESIS_MS, 0, false, NULL, {0}};
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -171,6 +223,194 @@ static inline Client_t *to_Client_t
 #define to_Client_t(c) ((Client_t*)c)
 #endif
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Acquire a kernel wakeup source
+ *
+ * @return
+ *     - LE_OK          if the wakeup source is acquired
+ *     - LE_NO_MEMORY   if the wakeup sources limit is reached
+ *     - LE_FAULT       for other errors
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t KernelWakeLock
+(
+    const char *name
+)
+{
+    PowerManager.stats.lockCount++;
+
+    // Write to /sys/power/wake_lock
+    if (0 > write(PowerManager.wl, name, strlen(name)))
+    {
+        if (ENOSPC == errno)
+        {
+            LE_ERROR("Too many wakeup source: Cannot acquire '%s'.", name);
+            PowerManager.isFull = true;
+            return LE_NO_MEMORY;
+        }
+        else if (EBADF == errno)
+        {
+            LE_FATAL("Error acquiring wakeup source '%s'. Invalid file descriptor %d.",
+                     name, PowerManager.wl);
+        }
+        else
+        {
+            LE_CRIT("Error acquiring wakeup source '%s': %m", name);
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release a kernel wakeup source
+ *
+ * @return
+ *     - LE_OK          if the wakeup source is released
+ *     - LE_NOT_FOUND   if the wakeup source was not currently acquired
+ *     - LE_FAULT       for other errors
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t KernelWakeUnlock
+(
+    const char *name
+)
+{
+    PowerManager.stats.unlockCount++;
+
+    // write to /sys/power/wake_unlock
+    if (0 > write(PowerManager.wu, name, strlen(name)))
+    {
+        if (EINVAL == errno)
+        {
+            LE_ERROR("Wakeup source '%s' is not locked.", name);
+            return LE_NOT_FOUND;
+        }
+        else if (EBADF == errno)
+        {
+            LE_FATAL("Error releasing wakeup source '%s'. Invalid file descriptor %d.",
+                     name, PowerManager.wu);
+        }
+        else
+        {
+            LE_CRIT("Error releasing wakeup source '%s': %m", name);
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release the aggregated kernel wakeup source once the hysteresis delay has expired
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void RelaxTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    if ((0 == PowerManager.awakeCount) && PowerManager.isKernelAwake)
+    {
+        PowerManager.isKernelAwake = false;
+        KernelWakeUnlock(LEGATO_AGGREGATE_WS_NAME);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that a client wakeup source is acquired, and keep the system awake
+ *
+ * @return
+ *     - LE_OK          if the wakeup source is acquired
+ *     - LE_NO_MEMORY   if the wakeup sources limit is reached
+ *     - LE_FAULT       for other errors
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AcquireWakeupSource
+(
+    WakeupSource_t *ws
+)
+{
+    ws->acquireCount++;
+    ws->acquireTime = le_clk_GetRelativeTime();
+
+    if (!PowerManager.isAggregated)
+    {
+        return KernelWakeLock(ws->name);
+    }
+
+    PowerManager.awakeCount++;
+
+    // Still held from a recent release: no kernel access
+    if (le_timer_IsRunning(PowerManager.relaxTimer))
+    {
+        le_timer_Stop(PowerManager.relaxTimer);
+    }
+
+    if (!PowerManager.isKernelAwake)
+    {
+        le_result_t result = KernelWakeLock(LEGATO_AGGREGATE_WS_NAME);
+        if (LE_OK != result)
+        {
+            return result;
+        }
+        PowerManager.isKernelAwake = true;
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record that a client wakeup source is released, and let the system suspend if it was the last
+ * one held
+ *
+ * @return
+ *     - LE_OK          if the wakeup source is released
+ *     - LE_NOT_FOUND   if the wakeup source was not currently acquired
+ *     - LE_FAULT       for other errors
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReleaseWakeupSource
+(
+    WakeupSource_t *ws
+)
+{
+    ws->heldTime = le_clk_Add(ws->heldTime,
+                              le_clk_Sub(le_clk_GetRelativeTime(), ws->acquireTime));
+
+    if (!PowerManager.isAggregated)
+    {
+        return KernelWakeUnlock(ws->name);
+    }
+
+    if (0 == PowerManager.awakeCount)
+    {
+        LE_ERROR("Wakeup source '%s' is not locked.", ws->name);
+        return LE_NOT_FOUND;
+    }
+
+    if (0 == --PowerManager.awakeCount)
+    {
+        if (0 == PowerManager.hysteresisMs)
+        {
+            RelaxTimerHandler(PowerManager.relaxTimer);
+        }
+        else
+        {
+            le_timer_Start(PowerManager.relaxTimer);
+        }
+    }
+
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Client connect callback
@@ -273,8 +513,9 @@ static void OnClientDisconnect
         }
 
         // Delete wakeup source record, free memory
-        LE_INFO("Deleting wakeup source '%s' on behalf of pid %d.",
-                ws->name, ws->pid);
+        LE_INFO("Deleting wakeup source '%s' on behalf of pid %d "
+                "(acquired %" PRIu32 " times, held %ld.%06ld s).",
+                ws->name, ws->pid, ws->acquireCount, ws->heldTime.sec, ws->heldTime.usec);
         le_hashmap_Remove(PowerManager.locks, ws->name);
         le_ref_DeleteRef(PowerManager.refs, ws->wsref);
         le_mem_Release(ws);
@@ -352,6 +593,11 @@ COMPONENT_INIT
         LE_FATAL("Failed to create client hashmap");
     }
 
+    // Create the timer releasing the aggregated wakeup source
+    PowerManager.relaxTimer = le_timer_Create("PM Relax Timer");
+    le_timer_SetMsInterval(PowerManager.relaxTimer, PowerManager.hysteresisMs);
+    le_timer_SetHandler(PowerManager.relaxTimer, RelaxTimerHandler);
+
     // Register client connect/disconnect handlers
     le_msg_AddServiceOpenHandler(le_pm_GetServiceRef(), OnClientConnect, NULL);
     le_msg_AddServiceCloseHandler(le_pm_GetServiceRef(), OnClientDisconnect, NULL);
@@ -451,6 +697,9 @@ le_pm_WakeupSourceRef_t le_pm_NewWakeupSource
     ws->taken = 0;
     ws->pid = cl->pid;
     ws->isRef = (opts & LE_PM_REF_COUNT ? true : false);
+    ws->acquireCount = 0;
+    ws->acquireTime = (le_clk_Time_t){ 0, 0 };
+    ws->heldTime = (le_clk_Time_t){ 0, 0 };
 
     ws->wsref = le_ref_CreateRef(PowerManager.refs, ws);
 
@@ -515,28 +764,7 @@ le_result_t le_pm_StayAwake
         return LE_OK;
     }
 
-    // Write to /sys/power/wake_lock
-    if (0 > write(PowerManager.wl, entry->name, strlen(entry->name)))
-    {
-        if (ENOSPC == errno)
-        {
-            LE_ERROR("Too many wakeup source: Cannot acquire '%s'.", entry->name);
-            PowerManager.isFull = true;
-            return LE_NO_MEMORY;
-        }
-        else if (EBADF == errno)
-        {
-            LE_FATAL("Error acquiring wakeup source '%s'. Invalid file descriptor %d.",
-                     entry->name, PowerManager.wl);
-        }
-        else
-        {
-            LE_CRIT("Error acquiring wakeup source '%s': %m", entry->name);
-            return LE_FAULT;
-        }
-    }
-
-    return LE_OK;
+    return AcquireWakeupSource(entry);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -597,27 +825,7 @@ le_result_t le_pm_Relax
         entry->taken = 0;
     }
 
-    // write to /sys/power/wake_unlock
-    if (0 > write(PowerManager.wu, entry->name, strlen(entry->name)))
-    {
-        if (EINVAL == errno)
-        {
-            LE_ERROR("Wakeup source '%s' is not locked.", entry->name);
-            return LE_NOT_FOUND;
-        }
-        else if (EBADF == errno)
-        {
-            LE_FATAL("Error releasing wakeup source '%s'. Invalid file descriptor %d.",
-                     entry->name, PowerManager.wu);
-        }
-        else
-        {
-            LE_CRIT("Error releasing wakeup source '%s': %m", entry->name);
-            return LE_FAULT;
-        }
-    }
-
-    return LE_OK;
+    return ReleaseWakeupSource(entry);
 }
 
 
@@ -699,3 +907,55 @@ le_result_t le_pm_ForceRelaxAndDestroyAllWakeupSource
 
     return LE_OK;
 }
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable or disable the aggregation of the client wakeup sources into a single kernel wakeup source
+ *
+ * @return
+ *     - LE_OK      if the mode is changed
+ *     - LE_BUSY    if a wakeup source is currently held
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pm_SetAggregation
+(
+    bool     isAggregated,  ///< [IN] Aggregate the client wakeup sources
+    uint32_t hysteresisMs   ///< [IN] Delay before releasing the aggregated wakeup source
+)
+{
+    if (pm_CheckWakeLock())
+    {
+        return LE_BUSY;
+    }
+
+    // Release the aggregated wakeup source still held by the hysteresis
+    if (le_timer_IsRunning(PowerManager.relaxTimer))
+    {
+        le_timer_Stop(PowerManager.relaxTimer);
+    }
+    RelaxTimerHandler(PowerManager.relaxTimer);
+
+    PowerManager.isAggregated = isAggregated;
+    PowerManager.hysteresisMs = hysteresisMs;
+    if (hysteresisMs)
+    {
+        le_timer_SetMsInterval(PowerManager.relaxTimer, hysteresisMs);
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of kernel wakeup source accesses
+ */
+//--------------------------------------------------------------------------------------------------
+void pm_GetStats
+(
+    pm_Stats_t *statsPtr    ///< [OUT] Kernel accesses
+)
+{
+    *statsPtr = PowerManager.stats;
+}
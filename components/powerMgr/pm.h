@@ -9,6 +9,17 @@
 #ifndef COMPONENTS_POWERMGR_PM_H_
 #define COMPONENTS_POWERMGR_PM_H_
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kernel wakeup source accesses
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t lockCount;     ///< Number of writes to the wake_lock file
+    uint32_t unlockCount;   ///< Number of writes to the wake_unlock file
+}
+pm_Stats_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -25,4 +36,29 @@ bool pm_CheckWakeLock
     void
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Enable or disable the aggregation of the client wakeup sources into a single kernel wakeup source
+ *
+ * @return
+ *     - LE_OK      if the mode is changed
+ *     - LE_BUSY    if a wakeup source is currently held
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pm_SetAggregation
+(
+    bool     isAggregated,  ///< [IN] Aggregate the client wakeup sources
+    uint32_t hysteresisMs   ///< [IN] Delay before releasing the aggregated wakeup source
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of kernel wakeup source accesses
+ */
+//--------------------------------------------------------------------------------------------------
+void pm_GetStats
+(
+    pm_Stats_t *statsPtr    ///< [OUT] Kernel accesses
+);
+
 #endif /* COMPONENTS_POWERMGR_PM_H_ */
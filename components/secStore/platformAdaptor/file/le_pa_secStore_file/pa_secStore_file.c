@@ -0,0 +1,1026 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file pa_secStore_file.c
+ *
+ * File based implementation of @ref c_pa_secStore interface.
+ *
+ * Each item is stored in a file under PA_SECSTORE_FILE_ROOT, with the same path as the item.  The
+ * data is not encrypted, so this implementation is meant as a reference and for testing on
+ * platforms without a secure storage.
+ *
+ * Writes of small items are batched: they are kept in memory and written to the file system
+ * together, either when the batch is full or after a short delay.  Each batch is made durable with
+ * two file system syncs instead of one per item: the new contents are written to temporary files
+ * and synced, then renamed over the items and synced again, so that an item is either entirely old
+ * or entirely new after a power loss.  Reads and size queries are answered from the pending writes,
+ * and any other access flushes them first, so batching is not visible to the caller.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "pa_secStore.h"
+#include "limit.h"
+#include "file.h"
+#include "fileDescriptor.h"
+
+#include <fts.h>
+#include <sys/statvfs.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory containing the items.  Can be overridden at build time.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef PA_SECSTORE_FILE_ROOT
+#define PA_SECSTORE_FILE_ROOT   /data/le_fs/secStore
+#endif
+
+#define ROOT_PATH               STRINGIZE(PA_SECSTORE_FILE_ROOT)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of writes in a batch.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_BATCH_WRITES        64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of an item whose write is batched.  Larger items are written immediately.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_BATCH_ITEM_BYTES    256
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum delay, in milliseconds, before a batch of writes is flushed to the file system.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BATCH_DELAY_MS          200
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suffix of the temporary files used while flushing writes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TMP_SUFFIX              ".~tmp"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A write waiting to be flushed to the file system.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char filePath[LIMIT_MAX_PATH_BYTES];        ///< Path of the item's file.
+    uint8_t data[MAX_BATCH_ITEM_BYTES];         ///< Data of the item.
+    size_t dataSize;                            ///< Size, in bytes, of the data.
+    bool isWritten;                             ///< Has the data been written to the temporary
+                                                ///  file by the current flush?
+    le_dls_Link_t link;                         ///< Link in PendingWriteList.
+}
+PendingWrite_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of pending writes.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PendingWritePool = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes waiting to be flushed, in the order they were made.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t PendingWriteList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of writes in PendingWriteList.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t PendingWriteCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer flushing the pending writes after BATCH_DELAY_MS.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t FlushTimer = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory containing the items, opened to sync the file system.
+ */
+//--------------------------------------------------------------------------------------------------
+static int RootFd = -1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of the file storing an item.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_BAD_PARAMETER if the path is too long.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetFilePath
+(
+    const char* pathPtr,            ///< [IN] Path of the item.
+    char* bufPtr,                   ///< [OUT] Path of the file.
+    size_t bufSize                  ///< [IN] Size of the buffer.
+)
+{
+    bufPtr[0] = '\0';
+
+    if (le_path_Concat("/", bufPtr, bufSize, ROOT_PATH, pathPtr, NULL) != LE_OK)
+    {
+        LE_ERROR("Path '%s' is too long.", pathPtr);
+        return LE_BAD_PARAMETER;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of the temporary file used to replace a file.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetTmpPath
+(
+    const char* filePathPtr,        ///< [IN] Path of the file.
+    char* bufPtr,                   ///< [OUT] Path of the temporary file.
+    size_t bufSize                  ///< [IN] Size of the buffer.
+)
+{
+    if (snprintf(bufPtr, bufSize, "%s" TMP_SUFFIX, filePathPtr) >= bufSize)
+    {
+        LE_ERROR("Path '%s' is too long.", filePathPtr);
+        return LE_BAD_PARAMETER;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes data to a file, replacing its content.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteFile
+(
+    const char* filePathPtr,        ///< [IN] Path of the file.
+    const uint8_t* bufPtr,          ///< [IN] Data to write.
+    size_t bufSize,                 ///< [IN] Size of the data.
+    bool isSync                     ///< [IN] true to sync the data to the storage.
+)
+{
+    int fd = open(filePathPtr, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Could not open '%s'.  %m.", filePathPtr);
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_OK;
+
+    if ( (fd_WriteSize(fd, (void*)bufPtr, bufSize) != bufSize) ||
+         (isSync && (fsync(fd) != 0)) )
+    {
+        LE_ERROR("Could not write '%s'.  %m.", filePathPtr);
+        result = LE_FAULT;
+    }
+
+    fd_Close(fd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flushes the pending writes to the file system.
+ *
+ * The writes have already been reported as successful, so the ones that fail are kept pending, to
+ * be retried when the flush timer expires again or by the next flush.
+ *
+ * @return
+ *      LE_OK if all the pending writes were flushed.
+ *      LE_FAULT if some of them are still pending.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FlushPendingWrites
+(
+    void
+)
+{
+    char tmpPath[LIMIT_MAX_PATH_BYTES];
+    le_dls_Link_t* linkPtr;
+
+    if (PendingWriteCount == 0)
+    {
+        return LE_OK;
+    }
+
+    if (le_timer_IsRunning(FlushTimer))
+    {
+        le_timer_Stop(FlushTimer);
+    }
+
+    // Write all the new contents, then make them durable at once.
+    linkPtr = le_dls_Peek(&PendingWriteList);
+
+    while (linkPtr != NULL)
+    {
+        PendingWrite_t* writePtr = CONTAINER_OF(linkPtr, PendingWrite_t, link);
+
+        writePtr->isWritten = false;
+
+        if (GetTmpPath(writePtr->filePath, tmpPath, sizeof(tmpPath)) == LE_OK)
+        {
+            if (WriteFile(tmpPath, writePtr->data, writePtr->dataSize, false) == LE_OK)
+            {
+                writePtr->isWritten = true;
+            }
+            else
+            {
+                unlink(tmpPath);
+            }
+        }
+
+        linkPtr = le_dls_PeekNext(&PendingWriteList, linkPtr);
+    }
+
+    if (syncfs(RootFd) != 0)
+    {
+        LE_ERROR("Could not sync secure storage.  %m.");
+    }
+
+    // Replace the items that were written, then make the new names durable at once.  The others
+    // stay pending, in order.
+    linkPtr = le_dls_Peek(&PendingWriteList);
+
+    while (linkPtr != NULL)
+    {
+        PendingWrite_t* writePtr = CONTAINER_OF(linkPtr, PendingWrite_t, link);
+
+        linkPtr = le_dls_PeekNext(&PendingWriteList, linkPtr);
+
+        if (!writePtr->isWritten)
+        {
+            continue;
+        }
+
+        // The path of the temporary file was already checked by the first pass.
+        GetTmpPath(writePtr->filePath, tmpPath, sizeof(tmpPath));
+
+        if (rename(tmpPath, writePtr->filePath) != 0)
+        {
+            LE_ERROR("Could not write '%s'.  %m.", writePtr->filePath);
+            unlink(tmpPath);
+            continue;
+        }
+
+        le_dls_Remove(&PendingWriteList, &writePtr->link);
+        le_mem_Release(writePtr);
+        PendingWriteCount--;
+    }
+
+    if (syncfs(RootFd) != 0)
+    {
+        LE_ERROR("Could not sync secure storage.  %m.");
+    }
+
+    if (PendingWriteCount != 0)
+    {
+        LE_ERROR("%zu writes to secure storage are still pending.", PendingWriteCount);
+        le_timer_Start(FlushTimer);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flushes the pending writes when the batch delay expires.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FlushTimerHandler
+(
+    le_timer_Ref_t timerRef         ///< [IN] Flush timer.
+)
+{
+    FlushPendingWrites();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the pending write of a file.
+ *
+ * @return
+ *      The pending write, or NULL if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static PendingWrite_t* FindPendingWrite
+(
+    const char* filePathPtr         ///< [IN] Path of the file.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&PendingWriteList);
+
+    while (linkPtr != NULL)
+    {
+        PendingWrite_t* writePtr = CONTAINER_OF(linkPtr, PendingWrite_t, link);
+
+        if (strcmp(writePtr->filePath, filePathPtr) == 0)
+        {
+            return writePtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&PendingWriteList, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the total size of the pending writes of the files under a directory.
+ *
+ * @return
+ *      The size in bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetPendingDirSize
+(
+    const char* dirPathPtr          ///< [IN] Path of the directory.
+)
+{
+    size_t dirPathLen = strlen(dirPathPtr);
+    bool hasSeparator = (dirPathLen > 0) && (dirPathPtr[dirPathLen - 1] == '/');
+    size_t totalSize = 0;
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&PendingWriteList);
+
+    while (linkPtr != NULL)
+    {
+        PendingWrite_t* writePtr = CONTAINER_OF(linkPtr, PendingWrite_t, link);
+
+        if (   (strncmp(writePtr->filePath, dirPathPtr, dirPathLen) == 0)
+            && (hasSeparator || (writePtr->filePath[dirPathLen] == '/')) )
+        {
+            totalSize += writePtr->dataSize;
+        }
+
+        linkPtr = le_dls_PeekNext(&PendingWriteList, linkPtr);
+    }
+
+    return totalSize;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes sure that a file can be created at the specified path, i.e. that it is not a directory and
+ * that all its parent directories exist.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_BAD_PARAMETER if the path is a directory or one of its parents is a file.
+ *      LE_FAULT if the pending writes could not be flushed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t PrepareFilePath
+(
+    const char* filePathPtr         ///< [IN] Path of the file.
+)
+{
+    char dirPath[LIMIT_MAX_PATH_BYTES];
+    struct stat st;
+
+    if ( (stat(filePathPtr, &st) == 0) && S_ISDIR(st.st_mode) )
+    {
+        LE_ERROR("'%s' is a directory.", filePathPtr);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (le_path_GetDir(filePathPtr, "/", dirPath, sizeof(dirPath)) != LE_OK)
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    if ( (stat(dirPath, &st) == 0) && S_ISDIR(st.st_mode) )
+    {
+        return LE_OK;
+    }
+
+    // A pending write may be creating a file in place of one of the directories.
+    if (FlushPendingWrites() != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (le_dir_MakePath(dirPath, S_IRWXU) != LE_OK)
+    {
+        LE_ERROR("Could not create directory '%s'.", dirPath);
+        return LE_BAD_PARAMETER;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes the data in the buffer to the specified path in secure storage replacing any previously
+ * written data at the same path.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NO_MEMORY if there is not enough memory to store the data.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_BAD_PARAMETER if the path cannot be written to because it is a directory or it would
+ *                       result in an invalid path.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_Write
+(
+    const char* pathPtr,            ///< [IN] Path to write to.
+    const uint8_t* bufPtr,          ///< [IN] Buffer containing the data to write.
+    size_t bufSize                  ///< [IN] Size of the buffer.
+)
+{
+    char filePath[LIMIT_MAX_PATH_BYTES];
+
+    le_result_t result = GetFilePath(pathPtr, filePath, sizeof(filePath));
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    PendingWrite_t* writePtr = FindPendingWrite(filePath);
+
+    if (bufSize > MAX_BATCH_ITEM_BYTES)
+    {
+        // Too large to be batched: keep the writes in order and write it now.
+        char tmpPath[LIMIT_MAX_PATH_BYTES];
+
+        if (FlushPendingWrites() != LE_OK)
+        {
+            return LE_FAULT;
+        }
+
+        result = PrepareFilePath(filePath);
+
+        if (result == LE_OK)
+        {
+            result = GetTmpPath(filePath, tmpPath, sizeof(tmpPath));
+        }
+
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        result = WriteFile(tmpPath, bufPtr, bufSize, true);
+
+        if ( (result == LE_OK) && (rename(tmpPath, filePath) != 0) )
+        {
+            LE_ERROR("Could not write '%s'.  %m.", filePath);
+            result = LE_FAULT;
+        }
+
+        if (result != LE_OK)
+        {
+            unlink(tmpPath);
+        }
+
+        return result;
+    }
+
+    if (writePtr == NULL)
+    {
+        result = PrepareFilePath(filePath);
+
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        // Preparing the path may have flushed the batch.
+        if ( (PendingWriteCount >= MAX_BATCH_WRITES) && (FlushPendingWrites() != LE_OK) )
+        {
+            return LE_FAULT;
+        }
+
+        writePtr = le_mem_ForceAlloc(PendingWritePool);
+
+        LE_ASSERT(le_utf8_Copy(writePtr->filePath, filePath, sizeof(writePtr->filePath), NULL)
+                  == LE_OK);
+        writePtr->isWritten = false;
+        writePtr->link = LE_DLS_LINK_INIT;
+
+        le_dls_Queue(&PendingWriteList, &writePtr->link);
+        PendingWriteCount++;
+    }
+
+    // Only the last write of an item in the batch is kept.
+    memcpy(writePtr->data, bufPtr, bufSize);
+    writePtr->dataSize = bufSize;
+
+    if (!le_timer_IsRunning(FlushTimer))
+    {
+        le_timer_Start(FlushTimer);
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads data from the specified path in secure storage.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the buffer is too small to hold all the data.  No data will be written to the
+ *                  buffer in this case.
+ *      LE_NOT_FOUND if the path is empty.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_Read
+(
+    const char* pathPtr,            ///< [IN] Path to read from.
+    uint8_t* bufPtr,                ///< [OUT] Buffer to store the data in.
+    size_t* bufSizePtr              ///< [IN/OUT] Size of buffer when this function is called.
+                                    ///          Number of bytes read when this function returns.
+)
+{
+    char filePath[LIMIT_MAX_PATH_BYTES];
+
+    if (GetFilePath(pathPtr, filePath, sizeof(filePath)) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    // Items written in the current batch are read from memory.
+    PendingWrite_t* writePtr = FindPendingWrite(filePath);
+
+    if (writePtr != NULL)
+    {
+        if (writePtr->dataSize > *bufSizePtr)
+        {
+            return LE_OVERFLOW;
+        }
+
+        memcpy(bufPtr, writePtr->data, writePtr->dataSize);
+        *bufSizePtr = writePtr->dataSize;
+        return LE_OK;
+    }
+
+    int fd = open(filePath, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            return LE_NOT_FOUND;
+        }
+
+        LE_ERROR("Could not open '%s'.  %m.", filePath);
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_OK;
+    struct stat st;
+
+    if ( (fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) )
+    {
+        LE_ERROR("'%s' is not a file.", filePath);
+        result = LE_FAULT;
+    }
+    else if (st.st_size > *bufSizePtr)
+    {
+        result = LE_OVERFLOW;
+    }
+    else if (fd_ReadSize(fd, bufPtr, st.st_size) != st.st_size)
+    {
+        LE_ERROR("Could not read '%s'.  %m.", filePath);
+        result = LE_FAULT;
+    }
+    else
+    {
+        *bufSizePtr = st.st_size;
+    }
+
+    fd_Close(fd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy the meta file to the specified path.  There is no meta file in this implementation.
+ *
+ * @return
+ *      LE_NOT_FOUND since the meta file does not exist.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_CopyMetaTo
+(
+    const char* pathPtr             ///< [IN] Destination path of meta file copy.
+)
+{
+    return LE_NOT_FOUND;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the specified path and everything under it.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the path does not exist.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_Delete
+(
+    const char* pathPtr             ///< [IN] Path to delete.
+)
+{
+    char filePath[LIMIT_MAX_PATH_BYTES];
+    struct stat st;
+
+    if (GetFilePath(pathPtr, filePath, sizeof(filePath)) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (FlushPendingWrites() != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (lstat(filePath, &st) != 0)
+    {
+        return (errno == ENOENT) ? LE_NOT_FOUND : LE_FAULT;
+    }
+
+    if (S_ISDIR(st.st_mode))
+    {
+        return le_dir_RemoveRecursive(filePath);
+    }
+
+    if (unlink(filePath) != 0)
+    {
+        LE_ERROR("Could not delete '%s'.  %m.", filePath);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the size, in bytes, of the data at the specified path and everything under it.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the path does not exist.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_GetSize
+(
+    const char* pathPtr,            ///< [IN] Path.
+    size_t* sizePtr                 ///< [OUT] Size in bytes of all items in the path.
+)
+{
+    char filePath[LIMIT_MAX_PATH_BYTES];
+    struct stat st;
+
+    if (GetFilePath(pathPtr, filePath, sizeof(filePath)) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    // This is called before each write to check the client's limit, so the pending writes are
+    // taken into account rather than flushed.  Their parent directories already exist.
+    PendingWrite_t* writePtr = FindPendingWrite(filePath);
+
+    if (writePtr != NULL)
+    {
+        *sizePtr = writePtr->dataSize;
+        return LE_OK;
+    }
+
+    if (lstat(filePath, &st) != 0)
+    {
+        return (errno == ENOENT) ? LE_NOT_FOUND : LE_FAULT;
+    }
+
+    if (!S_ISDIR(st.st_mode))
+    {
+        *sizePtr = st.st_size;
+        return LE_OK;
+    }
+
+    // Add up the sizes of all the files under the directory, replacing those with a pending write
+    // by their new size.
+    char* pathArrayPtr[] = {filePath, NULL};
+    size_t totalSize = 0;
+
+    errno = 0;
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL, NULL);
+
+    if (ftsPtr == NULL)
+    {
+        LE_ERROR("Could not open '%s'.  %m.", filePath);
+        return LE_FAULT;
+    }
+
+    FTSENT* entPtr;
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        if ( (entPtr->fts_info == FTS_F) && (FindPendingWrite(entPtr->fts_path) == NULL) )
+        {
+            totalSize += entPtr->fts_statp->st_size;
+        }
+    }
+
+    int lastErrno = errno;
+    fts_close(ftsPtr);
+
+    if (lastErrno != 0)
+    {
+        LE_ERROR("Could not read '%s'.  %s.", filePath, strerror(lastErrno));
+        return LE_FAULT;
+    }
+
+    *sizePtr = totalSize + GetPendingDirSize(filePath);
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterates over all entries under the specified path (non-recursive), calling the supplied callback
+ * with each entry name.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_GetEntries
+(
+    const char* pathPtr,                    ///< [IN] Path.
+    pa_secStore_GetEntry_t getEntryFunc,    ///< [IN] Callback function to call with each entry.
+    void* contextPtr                        ///< [IN] Context to be supplied to the callback.
+)
+{
+    char filePath[LIMIT_MAX_PATH_BYTES];
+
+    if (GetFilePath(pathPtr, filePath, sizeof(filePath)) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (FlushPendingWrites() != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    DIR* dirPtr = opendir(filePath);
+
+    if (dirPtr == NULL)
+    {
+        // Nothing has been stored under this path yet.
+        return (errno == ENOENT) ? LE_OK : LE_FAULT;
+    }
+
+    struct dirent* entryPtr;
+    size_t suffixLen = sizeof(TMP_SUFFIX) - 1;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        size_t nameLen = strlen(entryPtr->d_name);
+
+        if ( (strcmp(entryPtr->d_name, ".") == 0) ||
+             (strcmp(entryPtr->d_name, "..") == 0) ||
+             ( (nameLen > suffixLen) &&
+               (strcmp(entryPtr->d_name + nameLen - suffixLen, TMP_SUFFIX) == 0) ) )
+        {
+            continue;
+        }
+
+        getEntryFunc(entryPtr->d_name, (entryPtr->d_type == DT_DIR), contextPtr);
+    }
+
+    closedir(dirPtr);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the total space and the available free space in secure storage.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_GetTotalSpace
+(
+    size_t* totalSpacePtr,                  ///< [OUT] Total size, in bytes, of secure storage.
+    size_t* freeSizePtr                     ///< [OUT] Free space, in bytes, in secure storage.
+)
+{
+    struct statvfs st;
+
+    if (FlushPendingWrites() != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (fstatvfs(RootFd, &st) != 0)
+    {
+        LE_ERROR("Could not get the size of secure storage.  %m.");
+        return LE_FAULT;
+    }
+
+    *totalSpacePtr = st.f_blocks * st.f_frsize;
+    *freeSizePtr = st.f_bavail * st.f_frsize;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies all the data from source path to destination path.  The destination path must be empty.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_Copy
+(
+    const char* destPathPtr,                ///< [IN] Destination path.
+    const char* srcPathPtr                  ///< [IN] Source path.
+)
+{
+    char destFilePath[LIMIT_MAX_PATH_BYTES];
+    char srcFilePath[LIMIT_MAX_PATH_BYTES];
+
+    if ( (GetFilePath(destPathPtr, destFilePath, sizeof(destFilePath)) != LE_OK) ||
+         (GetFilePath(srcPathPtr, srcFilePath, sizeof(srcFilePath)) != LE_OK) )
+    {
+        return LE_FAULT;
+    }
+
+    if (FlushPendingWrites() != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (!le_dir_IsDir(srcFilePath))
+    {
+        // Nothing to copy.
+        return LE_OK;
+    }
+
+    if (le_dir_MakePath(destFilePath, S_IRWXU) != LE_OK)
+    {
+        LE_ERROR("Could not create directory '%s'.", destFilePath);
+        return LE_FAULT;
+    }
+
+    if (file_CopyRecursive(srcFilePath, destFilePath, NULL) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    return (syncfs(RootFd) == 0) ? LE_OK : LE_FAULT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves all the data from source path to destination path.  The destination path must be empty.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t pa_secStore_Move
+(
+    const char* destPathPtr,                ///< [IN] Destination path.
+    const char* srcPathPtr                  ///< [IN] Source path.
+)
+{
+    char destFilePath[LIMIT_MAX_PATH_BYTES];
+    char srcFilePath[LIMIT_MAX_PATH_BYTES];
+    char destDirPath[LIMIT_MAX_PATH_BYTES];
+
+    if ( (GetFilePath(destPathPtr, destFilePath, sizeof(destFilePath)) != LE_OK) ||
+         (GetFilePath(srcPathPtr, srcFilePath, sizeof(srcFilePath)) != LE_OK) ||
+         (le_path_GetDir(destFilePath, "/", destDirPath, sizeof(destDirPath)) != LE_OK) )
+    {
+        return LE_FAULT;
+    }
+
+    if (FlushPendingWrites() != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (!le_dir_IsDir(srcFilePath))
+    {
+        // Nothing to move.
+        return LE_OK;
+    }
+
+    if (le_dir_MakePath(destDirPath, S_IRWXU) != LE_OK)
+    {
+        LE_ERROR("Could not create directory '%s'.", destDirPath);
+        return LE_FAULT;
+    }
+
+    // The destination is empty, but may exist.
+    rmdir(destFilePath);
+
+    if (rename(srcFilePath, destFilePath) != 0)
+    {
+        LE_ERROR("Could not move '%s' to '%s'.  %m.", srcFilePath, destFilePath);
+        return LE_FAULT;
+    }
+
+    return (syncfs(RootFd) == 0) ? LE_OK : LE_FAULT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Init this component
+ */
+//--------------------------------------------------------------------------------------------------
+COMPONENT_INIT
+{
+    PendingWritePool = le_mem_CreatePool("PendingWritePool", sizeof(PendingWrite_t));
+
+    FlushTimer = le_timer_Create("SecStoreFlushTimer");
+    LE_ASSERT_OK(le_timer_SetMsInterval(FlushTimer, BATCH_DELAY_MS));
+    LE_ASSERT_OK(le_timer_SetHandler(FlushTimer, FlushTimerHandler));
+
+    LE_FATAL_IF(le_dir_MakePath(ROOT_PATH, S_IRWXU) != LE_OK,
+                "Could not create secure storage directory '%s'.", ROOT_PATH);
+
+    RootFd = open(ROOT_PATH, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    LE_FATAL_IF(RootFd < 0, "Could not open secure storage directory '%s'.  %m.", ROOT_PATH);
+}
@@ -169,6 +169,38 @@ Entry_t;
 static le_mem_PoolRef_t EntryPool = NULL;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Space accounting for a client's area of secure storage.  The limit and the used space are read
+ * on the first write by the client, then updated by its writes and deletes, so that checking the
+ * limit does not require the size of the whole area on each write.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char path[SECSTOREADMIN_MAX_PATH_BYTES]; ///< Path to the client's area.  Key in ClientUsageMap.
+    size_t limit;                            ///< Secure storage limit of the client, in bytes.
+    size_t usedSpace;                        ///< Space used in the client's area, in bytes.
+}
+ClientUsage_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of client usage objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t ClientUsagePool = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map of the path to a client's area to its usage object.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t ClientUsageMap = NULL;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Checks if the specified system index is in the list.
@@ -671,24 +703,29 @@ static void GetClientPath
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Checks if there is enough space in the client's area of secure storage for the client to write
- * the item.
+ * Gets the usage object for the client's area of secure storage, creating it if needed.
  *
  * @return
- *      LE_OK if the item would fit in the client's area of secure storage.
- *      LE_NO_MEMORY if there is not enough memory to store the item.
+ *      LE_OK if successful.
  *      LE_UNAVAILABLE if the secure storage is currently unavailable.
  *      LE_FAULT if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t CheckClientLimit
+static le_result_t GetClientUsage
 (
     const char* clientNamePtr,              ///< [IN] Name of the client.
     const char* clientPathPtr,              ///< [IN] Path to the client's area in secure storage.
-    const char* itemNamePtr,                ///< [IN] Name of the item.
-    size_t itemSize                         ///< [IN] Size, in bytes, of the item.
+    ClientUsage_t** usagePtrPtr             ///< [OUT] Usage of the client's area.
 )
 {
+    ClientUsage_t* usagePtr = le_hashmap_Get(ClientUsageMap, clientPathPtr);
+
+    if (usagePtr != NULL)
+    {
+        *usagePtrPtr = usagePtr;
+        return LE_OK;
+    }
+
     // Get the secure storage limit for the client.
     appCfg_Iter_t iter = appCfg_FindApp(clientNamePtr);
     if (!iter)
@@ -708,22 +745,122 @@ static le_result_t CheckClientLimit
         return result;
     }
 
-    // Get the size of the item in the secure storage if it already exists.
-    char itemPath[SECSTOREADMIN_MAX_PATH_BYTES] = "";
+    usagePtr = le_mem_ForceAlloc(ClientUsagePool);
+
+    LE_FATAL_IF(le_utf8_Copy(usagePtr->path, clientPathPtr, sizeof(usagePtr->path), NULL) != LE_OK,
+                "Client %s's path is too long.", clientNamePtr);
+    usagePtr->limit = secStoreLimit;
+    usagePtr->usedSpace = usedSpace;
+
+    le_hashmap_Put(ClientUsageMap, usagePtr->path, usagePtr);
+
+    *usagePtrPtr = usagePtr;
+    return LE_OK;
+}
+
 
-    LE_FATAL_IF(le_path_Concat("/", itemPath, sizeof(itemPath), clientPathPtr, itemNamePtr, NULL) != LE_OK,
-                "Client %s's path for item %s is too long.", clientNamePtr, itemNamePtr);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forgets the usage of a client's area, so that it is read again on the next access.  Used when
+ * the outcome of an operation on the client's area is unknown.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DropClientUsage
+(
+    ClientUsage_t* usagePtr                 ///< [IN] Usage to forget.
+)
+{
+    le_hashmap_Remove(ClientUsageMap, usagePtr->path);
+    le_mem_Release(usagePtr);
+}
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases a client usage object.  Called for each entry of ClientUsageMap before emptying it.
+ *
+ * @return
+ *      true to continue the iteration.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReleaseClientUsage
+(
+    const void* keyPtr,                     ///< [IN] Path to the client's area.
+    const void* valuePtr,                   ///< [IN] Usage of the client's area.
+    void* contextPtr                        ///< [IN] Not used.
+)
+{
+    le_mem_Release((void*)valuePtr);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Forgets the usage of all clients' areas.  Used when secure storage is modified outside of the
+ * clients' accesses, or when clients go away and their limits may change.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClearClientUsage
+(
+    void
+)
+{
+    le_hashmap_ForEach(ClientUsageMap, ReleaseClientUsage, NULL);
+    le_hashmap_RemoveAll(ClientUsageMap);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler called when a client of le_secStore disconnects.  The app may be reinstalled with a
+ * different limit, so the cached limits are dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClientCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,
+    void*               contextPtr
+)
+{
+    ClearClientUsage();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks if there is enough space in the client's area of secure storage for the client to write
+ * the item.
+ *
+ * @return
+ *      LE_OK if the item would fit in the client's area of secure storage.
+ *      LE_NO_MEMORY if there is not enough memory to store the item.
+ *      LE_UNAVAILABLE if the secure storage is currently unavailable.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CheckClientLimit
+(
+    const ClientUsage_t* usagePtr,          ///< [IN] Usage of the client's area.
+    const char* itemPathPtr,                ///< [IN] Path to the item in secure storage.
+    size_t itemSize,                        ///< [IN] Size, in bytes, of the item.
+    size_t* origItemSizePtr                 ///< [OUT] Size, in bytes, of the item being replaced.
+)
+{
+    // Get the size of the item in the secure storage if it already exists.
     size_t origItemSize = 0;
-    result = pa_secStore_GetSize(itemPath, &origItemSize);
+    le_result_t result = pa_secStore_GetSize(itemPathPtr, &origItemSize);
 
     if ( (result != LE_OK) && (result != LE_NOT_FOUND) )
     {
         return result;
     }
 
+    *origItemSizePtr = origItemSize;
+
     // Calculate if replacing the item would fit within the limit.
-    if (((ssize_t)(secStoreLimit - usedSpace + origItemSize - itemSize)) >= 0)
+    if (((ssize_t)(usagePtr->limit - usagePtr->usedSpace + origItemSize - itemSize)) >= 0)
     {
         return LE_OK;
     }
@@ -822,6 +959,8 @@ static le_result_t Write
 
     char path[SECSTOREADMIN_MAX_PATH_BYTES] = {0};
     le_result_t result;
+    ClientUsage_t* usagePtr = NULL;
+    size_t origItemSize = 0;
 
     if(isGlobal)
     {
@@ -841,11 +980,10 @@ static le_result_t Write
             return LE_FAULT;
         }
 
-        // Get the path to the client's secure storage area.
+        // Get the path to the client's secure storage area, and the space used in it.
         GetClientPath(clientName, isApp, path, sizeof(path));
 
-        // Check the available limit for the client.
-        result = CheckClientLimit(clientName, path, name, bufNumElements);
+        result = GetClientUsage(clientName, path, &usagePtr);
 
         if (result != LE_OK)
         {
@@ -855,11 +993,32 @@ static le_result_t Write
         // Append item name to client path.
         LE_FATAL_IF(le_path_Concat("/", path, sizeof(path), name, NULL) != LE_OK,
                     "Client %s's path for item %s is too long.", clientName, name);
+
+        // Check the available limit for the client.
+        result = CheckClientLimit(usagePtr, path, bufNumElements, &origItemSize);
+
+        if (result != LE_OK)
+        {
+            return result;
+        }
     }
 
     // Write the item to the secure storage.
     result = pa_secStore_Write(path, bufPtr, bufNumElements);
 
+    if (usagePtr != NULL)
+    {
+        if (result == LE_OK)
+        {
+            usagePtr->usedSpace = usagePtr->usedSpace - origItemSize + bufNumElements;
+        }
+        else
+        {
+            // The item may have been partially written.
+            DropClientUsage(usagePtr);
+        }
+    }
+
     if (result == LE_BAD_PARAMETER)
     {
         return LE_FAULT;
@@ -1083,6 +1242,7 @@ le_result_t Delete
     }
 
     char path[SECSTOREADMIN_MAX_PATH_BYTES] = {0};
+    ClientUsage_t* usagePtr = NULL;
 
     if(isGlobal)
     {
@@ -1105,13 +1265,44 @@ le_result_t Delete
         // Get the path to the client's secure storage area.
         GetClientPath(clientName, isApp, path, sizeof(path));
 
+        usagePtr = le_hashmap_Get(ClientUsageMap, path);
+
         // Append item name to client path.
         LE_FATAL_IF(le_path_Concat("/", path, sizeof(path), name, NULL) != LE_OK,
                     "Client %s's path for item %s is too long.", clientName, name);
     }
 
+    // If the usage of the client's area is known, get the space freed by the delete.
+    le_result_t result;
+    size_t itemSize = 0;
+
+    if (usagePtr != NULL)
+    {
+        result = pa_secStore_GetSize(path, &itemSize);
+
+        if ( (result != LE_OK) && (result != LE_NOT_FOUND) )
+        {
+            DropClientUsage(usagePtr);
+            usagePtr = NULL;
+        }
+    }
+
     // Delete the item from the secure storage.
-    return pa_secStore_Delete(path);
+    result = pa_secStore_Delete(path);
+
+    if (usagePtr != NULL)
+    {
+        if (result == LE_OK)
+        {
+            usagePtr->usedSpace -= itemSize;
+        }
+        else if (result != LE_NOT_FOUND)
+        {
+            DropClientUsage(usagePtr);
+        }
+    }
+
+    return result;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1578,6 +1769,9 @@ le_result_t secStoreAdmin_Write
         return LE_FAULT;
     }
 
+    // The item may be in any client's area.
+    ClearClientUsage();
+
     // Write the item to the secure storage.
     return pa_secStore_Write(path, bufPtr, bufNumElements);
 
@@ -1695,6 +1889,9 @@ le_result_t secStoreAdmin_Delete
         return LE_FAULT;
     }
 
+    // The path may be in, or contain, any client's area.
+    ClearClientUsage();
+
     // Delete the item from the secure storage.
     return pa_secStore_Delete(path);
 #else
@@ -1808,10 +2005,19 @@ COMPONENT_INIT
 
     SystemIndexPool = le_mem_CreatePool("SystemIndexPool", sizeof(SystemsIndex_t));
 
+    ClientUsagePool = le_mem_CreatePool("ClientUsagePool", sizeof(ClientUsage_t));
+    ClientUsageMap = le_hashmap_Create("ClientUsageMap",
+                                       31,
+                                       le_hashmap_HashString,
+                                       le_hashmap_EqualsString);
+
     // Register a handler that will clean up client specific data when clients disconnect.
     le_msg_AddServiceCloseHandler(secStoreAdmin_GetServiceRef(),
                                   CleanupClientIterators,
                                   NULL);
+    le_msg_AddServiceCloseHandler(le_secStore_GetServiceRef(),
+                                  ClientCloseHandler,
+                                  NULL);
 
     // Try to kick a couple of times before each timeout.
     le_clk_Time_t watchdogInterval = { .sec = MS_WDOG_INTERVAL };
@@ -90,6 +90,9 @@ COMPONENT_INIT
 {
     LE_DEBUG("** Config Tree, begin init.");
 
+    // A client that closes its end of a streamed file early must not kill the configTree.
+    le_sig_Block(SIGPIPE);
+
     // Initilize our internal subsystems.
     dstr_Init();   // Dynamic strings.
     rq_Init();     // Request queue.
@@ -235,6 +235,211 @@ void le_cfgAdmin_ExportTree
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Close a file descriptor received from a client.
+ */
+// -------------------------------------------------------------------------------------------------
+static void CloseStream
+(
+    int fd  ///< [IN] The file descriptor to close.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    int retVal = -1;
+
+    do
+    {
+        retVal = close(fd);
+    }
+    while ((retVal == -1) && (errno == EINTR));
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check that a file descriptor received from a client is a regular file.  Pipes, FIFOs, sockets
+ *  and terminals are refused, as a slow or stalled reader or writer on the other end would block
+ *  the whole configTree.
+ *
+ *  @return True if the file is a regular file, false if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool IsRegularFile
+(
+    int fd  ///< [IN] The file descriptor to check.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat) != 0)
+    {
+        LE_ERROR("Could not stat streamed file: %m.");
+        return false;
+    }
+
+    if (S_ISREG(fileStat.st_mode) == false)
+    {
+        LE_ERROR("Streamed file is not a regular file.");
+        return false;
+    }
+
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a subset of the configuration tree from a file opened by the client.  In text format that
+ *  tree then overwrites the node at the given nodePath, in JSON format it is merged into the node.
+ *
+ *  \b Responds \b With:
+ *
+ *  Responds with one of the following values:
+ *
+ *          - LE_OK            - Import was completed successfully.
+ *          - LE_BAD_PARAMETER - The file is not a regular file.
+ *          - LE_FAULT         - An I/O error occurred while reading the data.
+ *          - LE_FORMAT_ERROR  - Configuration data being imported appears corrupted.
+ *          - LE_NOT_POSSIBLE  - JSON data conflicts with the existing contents of the node.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfgAdmin_ImportTreeStream
+(
+    le_cfgAdmin_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                            ///<      request.
+    le_cfg_IteratorRef_t externalRef,       ///< [IN] Write iterator that is being used for the
+                                            ///<      import.
+    int fd,                                 ///< [IN] Import the tree data from this file.
+    const char* nodePathPtr,                ///< [IN] Where in the tree should this import happen?
+                                            ///<      Leave as an empty string to use the iterator's
+                                            ///<      current node.
+    le_cfgAdmin_format_t dataFormat         ///< [IN] Format of the tree data.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Importing a tree streamed onto node '%s', using iterator, '%p'.",
+             nodePathPtr, externalRef);
+
+    if (fd < 0)
+    {
+        le_cfgAdmin_ImportTreeStreamRespond(commandRef, LE_FAULT);
+        return;
+    }
+
+    if (IsRegularFile(fd) == false)
+    {
+        CloseStream(fd);
+        le_cfgAdmin_ImportTreeStreamRespond(commandRef, LE_BAD_PARAMETER);
+        return;
+    }
+
+    ni_IteratorRef_t iteratorRef = GetIteratorFromRef(externalRef);
+    le_result_t result = LE_OK;
+
+    if (iteratorRef != NULL)
+    {
+        tdb_NodeRef_t nodeRef = ni_TryCreateNode(iteratorRef, nodePathPtr);
+
+        if (nodeRef == NULL)
+        {
+            result = LE_NOT_FOUND;
+        }
+        else if (dataFormat == LE_CFGADMIN_FORMAT_JSON)
+        {
+            result = tdb_ReadTreeNodeJson(nodeRef, fd);
+        }
+        else
+        {
+            result = tdb_ReadTreeNode(nodeRef, fd) ? LE_OK : LE_FORMAT_ERROR;
+        }
+    }
+
+    CloseStream(fd);
+
+    le_cfgAdmin_ImportTreeStreamRespond(commandRef, result);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Take a node given from nodePath and stream it and it's children to a file opened by the client.
+ *
+ *  \b Responds \b With:
+ *
+ *  Responds with one of the following values:
+ *
+ *          - LE_OK            - Export was completed successfully.
+ *          - LE_BAD_PARAMETER - The file is not a regular file.
+ *          - LE_FAULT         - An I/O error occurred while writing the data.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfgAdmin_ExportTreeStream
+(
+    le_cfgAdmin_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                            ///<      request.
+    le_cfg_IteratorRef_t externalRef,       ///< [IN] Iterator that is being used for the export.
+    int fd,                                 ///< [IN] Export the tree data to this file.
+    const char* nodePathPtr,                ///< [IN] Where in the tree should this export happen?
+                                            ///<      Leave as an empty string to use the iterator's
+                                            ///<      current node.
+    le_cfgAdmin_format_t dataFormat         ///< [IN] Format of the tree data.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Exporting a tree streamed from node '%s', using iterator, '%p'.",
+             nodePathPtr, externalRef);
+
+    if (fd < 0)
+    {
+        le_cfgAdmin_ExportTreeStreamRespond(commandRef, LE_FAULT);
+        return;
+    }
+
+    if (IsRegularFile(fd) == false)
+    {
+        CloseStream(fd);
+        le_cfgAdmin_ExportTreeStreamRespond(commandRef, LE_BAD_PARAMETER);
+        return;
+    }
+
+    ni_IteratorRef_t iteratorRef = GetIteratorFromRef(externalRef);
+    le_result_t result = LE_OK;
+
+    if (iteratorRef != NULL)
+    {
+        tdb_NodeRef_t nodeRef = ni_GetNode(iteratorRef, nodePathPtr);
+
+        if (dataFormat == LE_CFGADMIN_FORMAT_JSON)
+        {
+            result = tdb_WriteTreeNodeJson(nodeRef, fd);
+        }
+        else
+        {
+            result = tdb_WriteTreeNode(nodeRef, fd);
+        }
+
+        if (result != LE_OK)
+        {
+            result = LE_FAULT;
+        }
+    }
+
+    CloseStream(fd);
+
+    le_cfgAdmin_ExportTreeStreamRespond(commandRef, result);
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 //  Tree maintenance.
 // -------------------------------------------------------------------------------------------------
@@ -720,6 +720,69 @@ void le_cfg_RemoveChangeHandler
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Register a call back on a given node object, to be given the paths of the nodes that changed
+ *  at or under it.
+ *
+ *  @return A handle to the event registration.
+ */
+// -------------------------------------------------------------------------------------------------
+le_cfg_ChangedPathsHandlerRef_t le_cfg_AddChangedPathsHandler
+(
+    const char* newPathPtr,                       ///< [IN] Path to the object to watch.
+    le_cfg_ChangedPathsHandlerFunc_t handlerPtr,  ///< [IN] Function to call back.
+    void* contextPtr                              ///< [IN] Context to give the function when
+                                                  ///<      called.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tu_UserRef_t userRef = tu_GetCurrentConfigUserInfo();
+    le_cfg_ChangedPathsHandlerRef_t handlerRef = NULL;
+
+    if (userRef != NULL)
+    {
+        tdb_TreeRef_t treeRef = tu_GetRequestedTree(userRef, TU_TREE_READ, newPathPtr);
+
+        if (treeRef != NULL)
+        {
+            handlerRef = tdb_AddChangedPathsHandler(treeRef,
+                                                    le_cfg_GetClientSessionRef(),
+                                                    newPathPtr,
+                                                    handlerPtr,
+                                                    contextPtr);
+        }
+    }
+
+    if (handlerRef == NULL)
+    {
+        tu_TerminateConfigClient(le_cfg_GetClientSessionRef(),
+                                 "Change handler registration failed.");
+    }
+
+    return handlerRef;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function removes a changed paths handler.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_cfg_RemoveChangedPathsHandler
+(
+    le_cfg_ChangedPathsHandlerRef_t handlerRef  ///< [IN] Previously registered handler to remove.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_RemoveChangedPathsHandler(handlerRef, le_cfg_GetClientSessionRef());
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 //  Transactional reading/writing, creation/deletion.
 // -------------------------------------------------------------------------------------------------
@@ -1551,3 +1614,36 @@ void le_cfg_QuickSetBool
                               value);
     }
 }
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get a copy of a branch of the configuration tree, unless the caller's copy is still current.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfg_QuickGetSnapshot
+(
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                       ///<      request.
+    const char* pathPtr,               ///< [IN] Path to the node to copy.
+    uint32_t knownRevision             ///< [IN] Revision of the caller's copy, 0 if it has none.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Quick get snapshot at \"%s\".", pathPtr);
+
+    tu_UserRef_t userRef = tu_GetCurrentConfigUserInfo();
+    tdb_TreeRef_t treeRef = QuickGetTree(userRef, TU_TREE_READ, pathPtr);
+
+    if (treeRef != NULL)
+    {
+        rq_HandleQuickGetSnapshot(le_cfg_GetClientSessionRef(),
+                                  commandRef,
+                                  userRef,
+                                  treeRef,
+                                  tp_GetPathOnly(pathPtr),
+                                  knownRevision);
+    }
+}
@@ -212,6 +212,37 @@ static le_result_t CloneAndAppendPath
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Called for each iterator before a tree changes.  If the iterator is a reader of that tree, it is
+ *  moved to the version of the tree taken before the change, so that it keeps reading what was in
+ *  the tree when it was created.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MoveReaderToVersion
+(
+    ni_ConstIteratorRef_t constIteratorRef,  ///< [IN] The iterator pointer.
+    void* contextPtr                         ///< [IN] The version of the tree.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ni_IteratorRef_t iteratorRef = (ni_IteratorRef_t)constIteratorRef;
+    tdb_TreeRef_t versionRef = contextPtr;
+
+    if (   (iteratorRef->type != NI_READ)
+        || (tdb_MoveReader(iteratorRef->treeRef, versionRef) == false))
+    {
+        return;
+    }
+
+    iteratorRef->treeRef = versionRef;
+    iteratorRef->currentNodeRef = tdb_GetNode(tdb_GetRootNode(versionRef),
+                                              iteratorRef->pathIterRef);
+}
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Init the node iterator subsystem and get it ready for use by the other subsystems in this
@@ -380,6 +411,9 @@ ni_IteratorRef_t ni_InternalRefFromExternalRef
 //--------------------------------------------------------------------------------------------------
 /**
  *  Commit the changes introduced by an iterator to the config tree.
+ *
+ *  The commit doesn't wait for the readers of the tree.  They are moved to a frozen version of the
+ *  tree, which is freed once the last of them is released.
  */
 //--------------------------------------------------------------------------------------------------
 void ni_Commit
@@ -390,6 +424,14 @@ void ni_Commit
 {
     if (iteratorRef->type == NI_WRITE)
     {
+        if (tdb_HasActiveReaders(iteratorRef->treeRef))
+        {
+            tdb_TreeRef_t versionRef = tdb_CreateVersion(iteratorRef->treeRef);
+
+            ni_ForEachIter(MoveReaderToVersion, versionRef);
+            tdb_ReleaseTree(versionRef);
+        }
+
         tdb_MergeTree(iteratorRef->treeRef);
     }
 }
@@ -43,7 +43,6 @@ typedef enum
     RQ_INVALID,
 
     RQ_CREATE_WRITE_TXN,
-    RQ_COMMIT_WRITE_TXN,
     RQ_CREATE_READ_TXN,
     RQ_DELETE_TXN,
 
@@ -84,12 +83,6 @@ typedef struct UpdateRequest
         }
         createTxn;                               ///< Create new transaction info.
 
-        struct
-        {
-            ni_IteratorRef_t iteratorRef;        ///< Ptr to the iterator to commit.
-        }
-        commitTxn;
-
         struct
         {
             ni_IteratorRef_t iteratorRef;        ///< Ptr to the iterator to commit.
@@ -329,16 +322,6 @@ static void ProcessRequestQueue
                                               requestPtr->data.createTxn.pathPtr);
                     break;
 
-                case RQ_COMMIT_WRITE_TXN:
-                    LE_DEBUG("Committing deferred write txn for user %u (%s) on tree '%s'.",
-                             tu_GetUserId(requestPtr->userRef),
-                             tu_GetUserName(requestPtr->userRef),
-                             tdb_GetTreeName(requestPtr->treeRef));
-
-                    rq_HandleCommitTxnRequest(requestPtr->commandRef,
-                                              requestPtr->data.commitTxn.iteratorRef);
-                    break;
-
                case RQ_CREATE_READ_TXN:
                     LE_DEBUG("Starting deferred read txn for user %u (%s) on tree '%s'.",
                              tu_GetUserId(requestPtr->userRef),
@@ -471,14 +454,9 @@ static bool CanQuickSet
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // If there are active readers or writers on the tree then a quick write should be defered.
-    if (   (tdb_HasActiveReaders(treeRef) == false)
-        && (tdb_GetActiveWriteIter(treeRef) == NULL))
-    {
-        return true;
-    }
-
-    return false;
+    // If there is an active writer on the tree then a quick write should be defered.  Readers don't
+    // matter, as they keep reading the tree as it was when they started.
+    return tdb_GetActiveWriteIter(treeRef) == NULL;
 }
 
 
@@ -573,14 +551,10 @@ void rq_HandleCreateTxnRequest
 {
     ni_IteratorRef_t writeIteratorRef = tdb_GetActiveWriteIter(treeRef);
 
-    if (   (iterType == NI_READ)
-        && (writeIteratorRef != NULL)
-        && (ni_IsClosed(writeIteratorRef)))
-    {
-        QueueCreateTxnRequest(userRef, treeRef, sessionRef, commandRef, iterType, pathPtr);
-    }
-    else if (   (iterType == NI_WRITE)
-             && (writeIteratorRef != NULL))
+    // Reads can always start, as commits are never left waiting with a closed write iterator on
+    // the tree.
+    if (   (iterType == NI_WRITE)
+        && (writeIteratorRef != NULL))
     {
         QueueCreateTxnRequest(userRef, treeRef, sessionRef, commandRef, iterType, pathPtr);
     }
@@ -623,34 +597,25 @@ void rq_HandleCommitTxnRequest
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // The iterator may be the last reader of a version of the tree, which goes away with it, so
+    // get the tree's queue first.
+    le_sls_List_t* requestQueuePtr = tdb_GetRequestQueue(ni_GetTree(iteratorRef));
+
     if (ni_IsWriteable(iteratorRef) == false)
     {
         // Kill the iterator but do not try to comit it.
         ni_Release(iteratorRef);
-
-        le_cfg_CommitTxnRespond(commandRef);
-        ProcessRequestQueue(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), NULL);
     }
-    else if (tdb_HasActiveReaders(ni_GetTree(iteratorRef)) == false)
+    else
     {
+        // Readers on the tree don't hold up the commit, see ni_Commit().
         ni_Close(iteratorRef);
         ni_Commit(iteratorRef);
         ni_Release(iteratorRef);
-
-        le_cfg_CommitTxnRespond(commandRef);
-        ProcessRequestQueue(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), NULL);
     }
-    else
-    {
-        UpdateRequest_t* requestPtr = NewRequestBlock(RQ_COMMIT_WRITE_TXN,
-                                                      ni_GetUser(iteratorRef),
-                                                      ni_GetTree(iteratorRef),
-                                                      ni_GetSession(iteratorRef),
-                                                      commandRef);
 
-        requestPtr->data.commitTxn.iteratorRef = iteratorRef;
-        QueueRequest(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), requestPtr);
-    }
+    le_cfg_CommitTxnRespond(commandRef);
+    ProcessRequestQueue(requestQueuePtr, NULL);
 }
 
 
@@ -668,6 +633,9 @@ void rq_HandleCancelTxnRequest
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // Get the tree's queue before the iterator, and any version of the tree it was reading, is gone.
+    le_sls_List_t* requestQueuePtr = tdb_GetRequestQueue(ni_GetTree(iteratorRef));
+
     // Kill the iterator but do not try to comit it.
     ni_Release(iteratorRef);
 
@@ -680,7 +648,7 @@ void rq_HandleCancelTxnRequest
     }
 
     // Try to handle the tree's request backlog.  (If any.)
-    ProcessRequestQueue(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), NULL);
+    ProcessRequestQueue(requestQueuePtr, NULL);
 }
 
 
@@ -1133,3 +1101,106 @@ void rq_HandleQuickSetBool
         le_cfg_QuickSetBoolRespond(commandRef);
     }
 }
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Create an anonymous file to write a tree snapshot into.  A memfd is used where the kernel has
+ *  them, an unlinked file in /tmp otherwise.
+ *
+ *  @return The file descriptor, or -1 on failure.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CreateSnapshotFile
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd;
+
+#ifdef SYS_memfd_create
+    fd = syscall(SYS_memfd_create, "configSnapshot", 1 /* MFD_CLOEXEC */);
+
+    if (fd != -1)
+    {
+        return fd;
+    }
+#endif
+
+    char pathStr[] = "/tmp/configSnapshotXXXXXX";
+
+    fd = mkostemp(pathStr, O_CLOEXEC);
+
+    if (fd == -1)
+    {
+        LE_ERROR("Could not create snapshot file, reason: %s", strerror(errno));
+        return -1;
+    }
+
+    unlink(pathStr);
+
+    return fd;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Send a copy of a branch of the tree to the client, unless the client's copy is still current.
+ */
+//--------------------------------------------------------------------------------------------------
+void rq_HandleQuickGetSnapshot
+(
+    le_msg_SessionRef_t sessionRef,    ///< [IN] The session this request occured on.
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] This handle is used to generate the reply for this
+                                       ///<      message.
+    tu_UserRef_t userRef,              ///< [IN] The user that's requesting the action.
+    tdb_TreeRef_t treeRef,             ///< [IN] The tree that we're peforming the action on.
+    const char* pathPtr,               ///< [IN] The path to the node to copy.
+    uint32_t knownRevision             ///< [IN] Revision of the client's copy, 0 if it has none.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t revision = tdb_GetChangeRevision(treeRef);
+
+    if (revision == knownRevision)
+    {
+        le_cfg_QuickGetSnapshotRespond(commandRef, LE_DUPLICATE, revision, -1);
+        return;
+    }
+
+    int fd = CreateSnapshotFile();
+
+    if (fd == -1)
+    {
+        le_cfg_QuickGetSnapshotRespond(commandRef, LE_FAULT, revision, -1);
+        return;
+    }
+
+    ni_IteratorRef_t iteratorRef = ni_CreateIterator(sessionRef,
+                                                     userRef,
+                                                     treeRef,
+                                                     NI_READ,
+                                                     pathPtr);
+
+    le_result_t result = tdb_WriteTreeSnapshot(ni_GetNode(iteratorRef, NULL), fd);
+
+    ni_Release(iteratorRef);
+
+    if (   (result != LE_OK)
+        || (lseek(fd, 0, SEEK_SET) == -1))
+    {
+        LE_ERROR("Could not write the snapshot of '%s'.", pathPtr);
+
+        close(fd);
+        le_cfg_QuickGetSnapshotRespond(commandRef, LE_FAULT, revision, -1);
+        return;
+    }
+
+    // The messaging layer closes the descriptor once it's sent.
+    le_cfg_QuickGetSnapshotRespond(commandRef, LE_OK, revision, fd);
+}
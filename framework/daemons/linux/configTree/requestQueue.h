@@ -281,4 +281,23 @@ void rq_HandleQuickSetBool
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Send a copy of a branch of the tree to the client, unless the client's copy is still current.
+ */
+// -------------------------------------------------------------------------------------------------
+void rq_HandleQuickGetSnapshot
+(
+    le_msg_SessionRef_t sessionRef,    ///< [IN] The session this request occured on.
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] This handle is used to generate the reply for this
+                                       ///<      message.
+    tu_UserRef_t userRef,              ///< [IN] The user that's requesting the action.
+    tdb_TreeRef_t treeRef,             ///< [IN] The tree that we're peforming the action on.
+    const char* pathPtr,               ///< [IN] The path to the node to copy.
+    uint32_t knownRevision             ///< [IN] Revision of the client's copy, 0 if it has none.
+);
+
+
+
+
 #endif
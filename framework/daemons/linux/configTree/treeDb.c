@@ -126,6 +126,7 @@
 // -------------------------------------------------------------------------------------------------
 
 #include "legato.h"
+#include <sys/mman.h>
 #include "limit.h"
 #include "interfaces.h"
 #include "dynamicString.h"
@@ -159,7 +160,16 @@ typedef struct Registration
     char registrationPath[CFG_MAX_PATH_SIZE];  ///< Path to the node being watched.  This *must*
                                                ///<   also include the tree name.
     bool triggered;                            ///< Has this registration been triggered for
-                                               ///<   callback?
+                                               ///<   callback by the merge in progress?
+    bool pending;                              ///< Are this registration's client handlers waiting
+                                               ///<   to be notified?
+    le_dls_Link_t triggeredLink;               ///< Link into the TriggeredList, when triggered.
+    le_dls_Link_t pendingLink;                 ///< Link into the PendingList, when pending.
+
+    size_t pathsHandlerCount;                  ///< Number of handlers that want the changed paths.
+    char changedPaths[LE_CFG_STR_LEN_BYTES];   ///< Paths changed since the last notification,
+                                               ///<   relative to the registration path and
+                                               ///<   separated by new lines.
 
     union
     {
@@ -191,7 +201,10 @@ typedef struct Handler
 
     le_msg_SessionRef_t sessionRef;         ///< Session that this handler was registered on.
 
-    le_cfg_ChangeHandlerFunc_t handlerPtr;  ///< Function to call back.
+    le_cfg_ChangeHandlerFunc_t handlerPtr;  ///< Function to call back, or NULL if this handler
+                                            ///<   wants the changed paths.
+    le_cfg_ChangedPathsHandlerFunc_t pathsHandlerPtr;  ///< Function to call back with the changed
+                                                       ///<   paths, or NULL.
     void* contextPtr;                       ///< Context to give the function when called.
 
     Registration_t* registrationPtr;        ///< The registration object this handler is attached
@@ -289,7 +302,10 @@ typedef struct Tree
                                           ///<   it is set to false, the tree is left alone.
 
     struct Tree* originalTreeRef;         ///< If non-NULL then this points back to the original
-                                          ///<   tree this one is shadowing.
+                                          ///<   tree this one is shadowing, or is a version of.
+
+    bool isVersion;                       ///< Is this a frozen version of the original tree, kept
+                                          ///<   for the readers that were on it when it changed?
 
     char name[MAX_TREE_NAME_BYTES];       ///< The name of this tree.
 
@@ -297,10 +313,16 @@ typedef struct Tree
                                           ///<   0 - Unknonwn.
                                           ///<   1, 2, 3 is one of the rock, paper, scissors revs.
 
+    uint32_t changeRevision;              ///< Value of LastChangeRevision when the tree was
+                                          ///<   created or last changed.  Clients compare it
+                                          ///<   with the one of their copy of the tree.
+
     Node_t* rootNodeRef;                  ///< The root node of this tree.
 
     ssize_t activeReadCount;              ///< Count of reads that are currently active on
                                           ///<   this tree.
+    ssize_t versionReadCount;             ///< Count of reads that have been moved to versions of
+                                          ///<   this tree.
     ni_IteratorRef_t activeWriteIterRef;  ///< The parent write iterator that's active on
                                           ///<   this tree.  NULL if there are no writes
                                           ///<   pending.
@@ -332,6 +354,78 @@ TokenType_t;
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tree files written by the Config Tree itself are binary snapshots, so that they can be loaded by
+ * walking a mapping of the file rather than by tokenizing text.  The text format is still read
+ * (tree files written by older versions, imports) and is what exports produce.
+ *
+ * A snapshot is SNAPSHOT_MAGIC, which can't start a text file, followed by the root node.  A node
+ * is a SnapshotType_t byte followed by:
+ *
+ *  - nothing, for an empty node;
+ *  - for a value, its text (as given by tdb_GetValueAsString()) as a string;
+ *  - for a stem, its number of children as a 32 bit number, then the name of each child as a
+ *    string, followed by the child node.
+ *
+ * A string is its length in bytes as a 16 bit number, followed by its bytes (not terminated).
+ * Numbers are little-endian.
+ *
+ * The mk tools also write snapshots (see configSnapshot.cpp), for read-only systems.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define SNAPSHOT_MAGIC "\x89" "LECFG1\n"
+#define SNAPSHOT_MAGIC_BYTES (sizeof(SNAPSHOT_MAGIC) - 1)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of the nodes in a snapshot.  These values are stored in files, so they must not change.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    SNAPSHOT_EMPTY  = 0,    ///< Node without any value.
+    SNAPSHOT_BOOL   = 1,    ///< Boolean value, "t" or "f".
+    SNAPSHOT_INT    = 2,    ///< Signed integer.
+    SNAPSHOT_FLOAT  = 3,    ///< Floating point number.
+    SNAPSHOT_STRING = 4,    ///< UTF-8 text string.
+    SNAPSHOT_STEM   = 5     ///< Node with children.
+}
+SnapshotType_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position of the reader in a mapped snapshot.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const uint8_t* dataPtr;  ///< Next byte to read.
+    size_t remaining;        ///< Number of bytes left to read.
+}
+SnapshotCursor_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Nodes can also be imported and exported as JSON, in the format of the config tool.  A node is an
+ * object with its "name" and "type" (one of "string", "bool", "int", "float", or "stem"), and either
+ * its "value" or, for a stem, its "children" as an array of nodes.  Empty nodes are stems without
+ * children.  The root of a tree has an empty name and the type "tree", and a node that doesn't
+ * exist is an empty object.
+ *
+ * JSON documents are parsed as they are read, so the nesting of the objects is limited to what
+ * paths in the tree can hold.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define JSON_MAX_DEPTH (LE_CFG_STR_LEN / 2)
+
+
+
 
 /// The memory pool responsible for tree nodes.
 static le_mem_PoolRef_t NodePoolRef = NULL;
@@ -388,6 +482,25 @@ static le_mem_PoolRef_t RegistrationPool = NULL;
 
 
 
+/// Registrations triggered by the merge in progress.
+static le_dls_List_t TriggeredList = LE_DLS_LIST_INIT;
+
+/// Registrations whose client handlers are waiting to be notified, once commits are acknowledged.
+static le_dls_List_t PendingList = LE_DLS_LIST_INIT;
+
+/// Has the delivery of the pending notifications been queued to the event loop?
+static bool IsDeliveryQueued = false;
+
+/// Number of handlers, on all registrations, that want the changed paths.  While there are none,
+/// merges don't keep track of them.
+static size_t PathsHandlerCount = 0;
+
+/// Last change revision given to a tree.  Revisions are unique across trees, so that a tree that
+/// is deleted and created again doesn't reuse the revision of a copy a client still has.
+static uint32_t LastChangeRevision = 0;
+
+
+
 
 // -------------------------------------------------------------------------------------------------
 /**
@@ -811,6 +924,41 @@ static tdb_NodeRef_t GetRootParentNode
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check that a name is one a node can have.
+ *
+ *  @return LE_OK if the name is valid.  LE_FORMAT_ERROR if the name contains illegal characters,
+ *          or otherwise would not work as a node name.  LE_OVERFLOW if the name is too long.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t CheckNodeName
+(
+    const char* stringPtr  ///< [IN] The name to check.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (   (stringPtr == NULL)
+        || (strcmp(stringPtr, "") == 0)
+        || (strcmp(stringPtr, ".") == 0)
+        || (strcmp(stringPtr, "..") == 0)
+        || (strchr(stringPtr, '/') != NULL)
+        || (strchr(stringPtr, ':') != NULL))
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    if (strlen(stringPtr) > LE_CFG_NAME_LEN)
+    {
+        return LE_OVERFLOW;
+    }
+
+    return LE_OK;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Called to look for a named child in a given node's child collection.
@@ -1011,6 +1159,58 @@ static void PropagateValue
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Make a copy of a node and all of its children.
+ *
+ *  @return The copy.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t CopyNode
+(
+    tdb_NodeRef_t nodeRef,   ///< [IN] The node to copy.
+    tdb_NodeRef_t parentRef  ///< [IN] The copy of the node's parent, or NULL if it has none.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t copyRef = NewNode();
+
+    copyRef->type = nodeRef->type;
+    copyRef->flags = nodeRef->flags;
+
+    if (nodeRef->nameRef != NULL)
+    {
+        copyRef->nameRef = dstr_NewFromDstr(nodeRef->nameRef);
+    }
+
+    if (parentRef != NULL)
+    {
+        copyRef->parentRef = parentRef;
+        le_dls_Queue(&parentRef->info.children, &copyRef->siblingList);
+    }
+
+    if (nodeRef->type == LE_CFG_TYPE_STEM)
+    {
+        tdb_NodeRef_t childRef = tdb_GetFirstChildNode(nodeRef);
+
+        while (childRef != NULL)
+        {
+            CopyNode(childRef, copyRef);
+            childRef = tdb_GetNextSiblingNode(childRef);
+        }
+    }
+    else if (   (IsStringType(nodeRef) == true)
+             && (nodeRef->info.valueRef != NULL))
+    {
+        copyRef->info.valueRef = dstr_NewFromDstr(nodeRef->info.valueRef);
+    }
+
+    return copyRef;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Merge a shadow node with the original it represents.
@@ -1152,55 +1352,42 @@ static void TriggerCallbacks
     // the merge is complete.
     Registration_t* foundRegistrationPtr = le_hashmap_Get(HandlerRegistrationMap, pathBuffer);
 
-    if (foundRegistrationPtr != NULL)
+    if (   (foundRegistrationPtr != NULL)
+        && (foundRegistrationPtr->triggered == false))
     {
         foundRegistrationPtr->triggered = true;
+        le_dls_Queue(&TriggeredList, &foundRegistrationPtr->triggeredLink);
     }
 }
 
 
 
 
-
 // -------------------------------------------------------------------------------------------------
 /**
- *  Go through all of the registered event callbacks, and fire the call backs for each of the
- *  registrations that has been makred as triggered.
+ *  Check if a path is the same as, or under, another one.  Both paths are relative to the same
+ *  node, and "/" is that node.
  *
- *  Once this is done, the triggered flag is cleared for next time.
+ *  @return True if the path is covered by the base path.  False if not.
  */
 // -------------------------------------------------------------------------------------------------
-static void FireTriggeredCallbacks
+static bool IsPathCovered
 (
-    void
+    const char* pathPtr,  ///< [IN] The path to check.
+    size_t pathLen,       ///< [IN] Its length.
+    const char* basePtr,  ///< [IN] The base path.
+    size_t baseLen        ///< [IN] Its length.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // Go through the registration map.
-    le_hashmap_It_Ref_t handlerIterRef = le_hashmap_GetIterator(HandlerRegistrationMap);
-
-    while (le_hashmap_NextNode(handlerIterRef) == LE_OK)
+    if ((baseLen == 1) && (basePtr[0] == '/'))
     {
-        // For each registration, check to see if it was triggered.
-        Registration_t* registrationPtr = (Registration_t*)le_hashmap_GetValue(handlerIterRef);
-
-        if (registrationPtr->triggered)
-        {
-            // This registration has been triggered, so call all of the handlers attached to it.
-            le_dls_Link_t* linkPtr = le_dls_Peek(&registrationPtr->handlerList);
-
-            while (linkPtr != NULL)
-            {
-                Handler_t* handlerObjectPtr = CONTAINER_OF(linkPtr, Handler_t, link);
-
-                handlerObjectPtr->handlerPtr(handlerObjectPtr->contextPtr);
-                linkPtr = le_dls_PeekNext(&registrationPtr->handlerList, linkPtr);
-            }
-
-            // Now that that's done, clear the triggered flag.
-            registrationPtr->triggered = false;
-        }
+        return true;
     }
+
+    return    (pathLen >= baseLen)
+           && (memcmp(pathPtr, basePtr, baseLen) == 0)
+           && ((pathLen == baseLen) || (pathPtr[baseLen] == '/'));
 }
 
 
@@ -1208,39 +1395,67 @@ static void FireTriggeredCallbacks
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Check the given node to see if it was renamed.
- *
- *  @return True if the node was renamed within this transaction.  False if not.
+ *  Add a path to the list of changed paths of a registration.  The list is kept compact: the path
+ *  isn't added if an entry already covers it, and the entries it covers are dropped.  If the list
+ *  would overflow, it is replaced by "/", the registered node itself.
  */
 // -------------------------------------------------------------------------------------------------
-static bool WasRenamed
+static void AddChangedPath
 (
-    tdb_NodeRef_t nodeRef  ///< [IN] Check this node to see if it was renamed in this transaction.
+    Registration_t* registrationPtr,  ///< [IN] The registration to update.
+    const char* relativePathPtr       ///< [IN] Path of the changed node, relative to the
+                                      ///<      registered node.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    if (IsModified(nodeRef) == false)
+    char newList[LE_CFG_STR_LEN_BYTES] = "";
+    size_t newLen = 0;
+    size_t relativeLen = strlen(relativePathPtr);
+    const char* entryPtr = registrationPtr->changedPaths;
+
+    while (*entryPtr != '\0')
     {
-        // The node wasn't even modified, so it can not have been renamed.
-        return false;
+        size_t entryLen = strcspn(entryPtr, "\n");
+
+        if (IsPathCovered(relativePathPtr, relativeLen, entryPtr, entryLen))
+        {
+            return;
+        }
+
+        // Keep the entries the new path doesn't cover.  They fit, as they did in the old list.
+        if (IsPathCovered(entryPtr, entryLen, relativePathPtr, relativeLen) == false)
+        {
+            if (newLen > 0)
+            {
+                newList[newLen++] = '\n';
+            }
+
+            memcpy(newList + newLen, entryPtr, entryLen);
+            newLen += entryLen;
+        }
+
+        entryPtr += entryLen;
+
+        if (*entryPtr == '\n')
+        {
+            entryPtr++;
+        }
     }
 
-    if (nodeRef->shadowRef == NULL)
+    if ((newLen + 1 + relativeLen) >= sizeof(newList))
     {
-        // If the node doesn't have a shadow reference, then most likely this is a new node and not
-        // a rename of an existing one.
-        return false;
+        LE_DEBUG("Too many changes under '%s' to list.", registrationPtr->registrationPath);
+        le_utf8_Copy(registrationPtr->changedPaths, "/", sizeof(registrationPtr->changedPaths), NULL);
+        return;
     }
 
-    if (nodeRef->nameRef == NULL)
+    if (newLen > 0)
     {
-        // The shadow node does not have a local copy of a name, so it can not have been renamed.
-        // It must have been modified for other reasons.
-        return false;
+        newList[newLen++] = '\n';
     }
 
-    // Looks like the node has a new name.
-    return true;
+    memcpy(newList + newLen, relativePathPtr, relativeLen + 1);
+    memcpy(registrationPtr->changedPaths, newList, newLen + relativeLen + 1);
 }
 
 
@@ -1248,54 +1463,69 @@ static bool WasRenamed
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Check the original non-shadow node to see if it will need to be cleared during the merge.
+ *  Record that the node at the given path changed, for the handlers that want the changed paths
+ *  of the node or of any of its parents.
  *
- *  @return True if the merge will clear out the original value.  False if not.
+ *  Only the top of a changed branch needs to be recorded, as its children are covered by it.
  */
 // -------------------------------------------------------------------------------------------------
-static bool OriginalToBeCleared
+static void RecordChangedPath
 (
-    tdb_NodeRef_t nodeRef  ///< [IN] The shadow node to check.
+    le_pathIter_Ref_t pathRef  ///< [IN] Path to the node that changed.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    le_cfg_nodeType_t nodeType = tdb_GetNodeType(nodeRef);
+    if (PathsHandlerCount == 0)
+    {
+        return;
+    }
 
-    if (   (nodeType == LE_CFG_TYPE_EMPTY)
-        || (nodeType != tdb_GetNodeType(nodeRef->shadowRef)))
+    char pathBuffer[CFG_MAX_PATH_SIZE] = { 0 };
+    if (le_pathIter_GetPath(pathRef, pathBuffer, sizeof(pathBuffer)) != LE_OK)
     {
-        return true;
+        LE_ERROR("Callback path buffer overflow.");
+        return;
     }
 
-    return false;
-}
+    // Paths are of the form "tree:/a/b", and the root of the tree is "tree:".
+    const char* separatorPtr = strchr(pathBuffer, ':');
 
+    if (separatorPtr == NULL)
+    {
+        return;
+    }
 
+    size_t rootLen = (separatorPtr - pathBuffer) + 1;
+    size_t prefixLen = strlen(pathBuffer);
 
+    // Look for registrations on the node and each of its parents, up to the root.
+    for (;;)
+    {
+        char savedChar = pathBuffer[prefixLen];
 
-// -------------------------------------------------------------------------------------------------
-/**
- *  Append the name of a node onto the end of a path object.
- */
-// -------------------------------------------------------------------------------------------------
-static void AppendNodeName
-(
-    le_pathIter_Ref_t pathRef,  ///< [IN] The path we're appending to.
-    tdb_NodeRef_t nodeRef       ///< [IN] The node we're appending.
-)
-// -------------------------------------------------------------------------------------------------
-{
-    char nodeName[LE_CFG_NAME_LEN_BYTES] = "";
+        pathBuffer[prefixLen] = '\0';
+        Registration_t* registrationPtr = le_hashmap_Get(HandlerRegistrationMap, pathBuffer);
+        pathBuffer[prefixLen] = savedChar;
 
-    LE_ASSERT(tdb_GetNodeName(nodeRef, nodeName, sizeof(nodeName)) == LE_OK);
-    le_result_t result = le_pathIter_Append(pathRef, nodeName);
+        if (   (registrationPtr != NULL)
+            && (registrationPtr->pathsHandlerCount > 0))
+        {
+            const char* relativePathPtr = pathBuffer + prefixLen;
 
-    LE_WARN_IF(result != LE_OK,
-               "Could not append node '%s' onto the update callback tracking path.  "
-               "Reason: %d, '%s'.",
-               nodeName,
-               result,
-               LE_RESULT_TXT(result));
+            AddChangedPath(registrationPtr, (*relativePathPtr == '\0') ? "/" : relativePathPtr);
+        }
+
+        if (prefixLen <= rootLen)
+        {
+            break;
+        }
+
+        do
+        {
+            prefixLen--;
+        }
+        while (pathBuffer[prefixLen] != '/');
+    }
 }
 
 
@@ -1303,21 +1533,65 @@ static void AppendNodeName
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Create a new config path for the tree name given.
- *
- *  @return A new config path, rooted on the given tree.
+ *  Deliver the pending notifications to the client handlers.  This is queued to the event loop by
+ *  FireTriggeredCallbacks(), so that it runs once the commits that triggered them have been
+ *  acknowledged, and so that the changes of all the commits made in the meantime are reported
+ *  together.
  */
 // -------------------------------------------------------------------------------------------------
-static le_pathIter_Ref_t CreateBasePath
+static void DeliverPendingCallbacks
 (
-    const char* treeNamePtr  ///< [IN] The tree name to use for the new path object.
+    void* param1Ptr,  ///< [IN] Not used.
+    void* param2Ptr   ///< [IN] Not used.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    char basePath[CFG_MAX_PATH_SIZE] = { 0 };
+    le_dls_Link_t* registrationLinkPtr = NULL;
 
-    snprintf(basePath, sizeof(basePath), "%s:/", treeNamePtr);
-    return le_pathIter_CreateForUnix(basePath);
+    IsDeliveryQueued = false;
+
+    while ((registrationLinkPtr = le_dls_Pop(&PendingList)) != NULL)
+    {
+        Registration_t* registrationPtr = CONTAINER_OF(registrationLinkPtr,
+                                                       Registration_t,
+                                                       pendingLink);
+
+        registrationPtr->pending = false;
+
+        // The registered node may have been in a branch that changed as a whole.
+        if (registrationPtr->changedPaths[0] == '\0')
+        {
+            le_utf8_Copy(registrationPtr->changedPaths,
+                         "/",
+                         sizeof(registrationPtr->changedPaths),
+                         NULL);
+        }
+
+        le_dls_Link_t* linkPtr = le_dls_Peek(&registrationPtr->handlerList);
+
+        while (linkPtr != NULL)
+        {
+            Handler_t* handlerObjectPtr = CONTAINER_OF(linkPtr, Handler_t, link);
+
+            // Handlers internal to the config tree were called when the merge completed.
+            if (handlerObjectPtr->sessionRef != NULL)
+            {
+                if (handlerObjectPtr->pathsHandlerPtr != NULL)
+                {
+                    handlerObjectPtr->pathsHandlerPtr(registrationPtr->changedPaths,
+                                                      handlerObjectPtr->contextPtr);
+                }
+                else
+                {
+                    handlerObjectPtr->handlerPtr(handlerObjectPtr->contextPtr);
+                }
+            }
+
+            linkPtr = le_dls_PeekNext(&registrationPtr->handlerList, linkPtr);
+        }
+
+        registrationPtr->changedPaths[0] = '\0';
+    }
 }
 
 
@@ -1325,24 +1599,205 @@ static le_pathIter_Ref_t CreateBasePath
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Generate a config path to the given node.
+ *  Go through the registrations triggered by the merge that just completed.  The handlers internal
+ *  to the config tree are called right away, so that the daemon's own state follows the tree.  The
+ *  client handlers are notified later, by DeliverPendingCallbacks(), so that the merge isn't held
+ *  up by sending notifications.
+ *
+ *  Once this is done, the triggered flags are cleared for next time.
  */
 // -------------------------------------------------------------------------------------------------
-static void GeneratePath
+static void FireTriggeredCallbacks
 (
-    le_pathIter_Ref_t pathRef,  ///< [IN] The path object we're updating.
-    tdb_NodeRef_t nodeRef       ///< [IN] The node we're creating a path for.
+    void
 )
 // -------------------------------------------------------------------------------------------------
 {
-    if (nodeRef == NULL)
+    le_dls_Link_t* registrationLinkPtr = NULL;
+
+    while ((registrationLinkPtr = le_dls_Pop(&TriggeredList)) != NULL)
     {
-        return;
-    }
+        Registration_t* registrationPtr = CONTAINER_OF(registrationLinkPtr,
+                                                       Registration_t,
+                                                       triggeredLink);
+        bool hasClientHandlers = false;
+        le_dls_Link_t* linkPtr = le_dls_Peek(&registrationPtr->handlerList);
 
-    GeneratePath(pathRef, nodeRef->parentRef);
-    AppendNodeName(pathRef, nodeRef);
-}
+        while (linkPtr != NULL)
+        {
+            Handler_t* handlerObjectPtr = CONTAINER_OF(linkPtr, Handler_t, link);
+
+            if (handlerObjectPtr->sessionRef == NULL)
+            {
+                handlerObjectPtr->handlerPtr(handlerObjectPtr->contextPtr);
+            }
+            else
+            {
+                hasClientHandlers = true;
+            }
+
+            linkPtr = le_dls_PeekNext(&registrationPtr->handlerList, linkPtr);
+        }
+
+        // Now that that's done, clear the triggered flag.
+        registrationPtr->triggered = false;
+
+        if (   hasClientHandlers
+            && (registrationPtr->pending == false))
+        {
+            registrationPtr->pending = true;
+            le_dls_Queue(&PendingList, &registrationPtr->pendingLink);
+        }
+    }
+
+    if (   (IsDeliveryQueued == false)
+        && (le_dls_IsEmpty(&PendingList) == false))
+    {
+        IsDeliveryQueued = true;
+        le_event_QueueFunction(DeliverPendingCallbacks, NULL, NULL);
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check the given node to see if it was renamed.
+ *
+ *  @return True if the node was renamed within this transaction.  False if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool WasRenamed
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] Check this node to see if it was renamed in this transaction.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (IsModified(nodeRef) == false)
+    {
+        // The node wasn't even modified, so it can not have been renamed.
+        return false;
+    }
+
+    if (nodeRef->shadowRef == NULL)
+    {
+        // If the node doesn't have a shadow reference, then most likely this is a new node and not
+        // a rename of an existing one.
+        return false;
+    }
+
+    if (nodeRef->nameRef == NULL)
+    {
+        // The shadow node does not have a local copy of a name, so it can not have been renamed.
+        // It must have been modified for other reasons.
+        return false;
+    }
+
+    // Looks like the node has a new name.
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check the original non-shadow node to see if it will need to be cleared during the merge.
+ *
+ *  @return True if the merge will clear out the original value.  False if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool OriginalToBeCleared
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The shadow node to check.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_cfg_nodeType_t nodeType = tdb_GetNodeType(nodeRef);
+
+    if (   (nodeType == LE_CFG_TYPE_EMPTY)
+        || (nodeType != tdb_GetNodeType(nodeRef->shadowRef)))
+    {
+        return true;
+    }
+
+    return false;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Append the name of a node onto the end of a path object.
+ */
+// -------------------------------------------------------------------------------------------------
+static void AppendNodeName
+(
+    le_pathIter_Ref_t pathRef,  ///< [IN] The path we're appending to.
+    tdb_NodeRef_t nodeRef       ///< [IN] The node we're appending.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char nodeName[LE_CFG_NAME_LEN_BYTES] = "";
+
+    LE_ASSERT(tdb_GetNodeName(nodeRef, nodeName, sizeof(nodeName)) == LE_OK);
+    le_result_t result = le_pathIter_Append(pathRef, nodeName);
+
+    LE_WARN_IF(result != LE_OK,
+               "Could not append node '%s' onto the update callback tracking path.  "
+               "Reason: %d, '%s'.",
+               nodeName,
+               result,
+               LE_RESULT_TXT(result));
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Create a new config path for the tree name given.
+ *
+ *  @return A new config path, rooted on the given tree.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_pathIter_Ref_t CreateBasePath
+(
+    const char* treeNamePtr  ///< [IN] The tree name to use for the new path object.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char basePath[CFG_MAX_PATH_SIZE] = { 0 };
+
+    snprintf(basePath, sizeof(basePath), "%s:/", treeNamePtr);
+    return le_pathIter_CreateForUnix(basePath);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Generate a config path to the given node.
+ */
+// -------------------------------------------------------------------------------------------------
+static void GeneratePath
+(
+    le_pathIter_Ref_t pathRef,  ///< [IN] The path object we're updating.
+    tdb_NodeRef_t nodeRef       ///< [IN] The node we're creating a path for.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (nodeRef == NULL)
+    {
+        return;
+    }
+
+    GeneratePath(pathRef, nodeRef->parentRef);
+    AppendNodeName(pathRef, nodeRef);
+}
 
 
 
@@ -1355,13 +1810,20 @@ static void GeneratePath
 static void FireAllChildren
 (
     le_pathIter_Ref_t pathRef,  ///< [IN] Path to the parent of the current node.
-    tdb_NodeRef_t nodeRef       ///< [IN] Node and any children to merge.
+    tdb_NodeRef_t nodeRef,      ///< [IN] Node and any children to merge.
+    bool isTop                  ///< [IN] Is this the top of the branch being fired?
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // Add this node to the path we're using to find registered callbacks.
+    // Add this node to the path we're using to find registered callbacks.  The top of the branch
+    // is the path that changed, for the handlers that want it.
     AppendNodeName(pathRef, nodeRef);
 
+    if (isTop)
+    {
+        RecordChangedPath(pathRef);
+    }
+
     // If the node is a stem then traverse it's children and try to trigger callbacks for them.  If
     // there are no callbacks registered for those nodes, then nothing will happen.
     if (nodeRef->type == LE_CFG_TYPE_STEM)
@@ -1370,7 +1832,7 @@ static void FireAllChildren
 
         while (childRef != NULL)
         {
-            FireAllChildren(pathRef, childRef);
+            FireAllChildren(pathRef, childRef, false);
             childRef = tdb_GetNextSiblingNode(childRef);
         }
     }
@@ -1456,7 +1918,7 @@ static void FireLostChildren
     {
         if (IsDeleted(originalChildRef) == true)
         {
-            FireAllChildren(pathRef, originalChildRef);
+            FireAllChildren(pathRef, originalChildRef, true);
             ClearDeletedFlag(originalChildRef);
         }
 
@@ -1502,7 +1964,7 @@ static bool InternalMergeTree
         if (nodeRef->shadowRef != NULL)
         {
             GeneratePath(originalPathRef, nodeRef->shadowRef->parentRef);
-            FireAllChildren(originalPathRef, nodeRef->shadowRef);
+            FireAllChildren(originalPathRef, nodeRef->shadowRef, true);
         }
 
         le_pathIter_Delete(originalPathRef);
@@ -1520,6 +1982,18 @@ static bool InternalMergeTree
 
     AppendNodeName(pathRef, nodeRef);
 
+    // A modified value, or a stem that is new or replaced as a whole, is a change of the node
+    // itself.  The changes of a stem that is otherwise modified are found among its children.
+    if (   (isModified == true)
+        && (   (nodeRef->type != LE_CFG_TYPE_STEM)
+            || (renamed == true)
+            || (nodeRef->shadowRef == NULL)
+            || (IsDeleted(nodeRef) == true)
+            || (OriginalToBeCleared(nodeRef) == true)))
+    {
+        RecordChangedPath(pathRef);
+    }
+
     // IF this node is modified, mearge it.  If this node is a stem, then merge it's children.  Keep
     // track of whether any of those children have been modified as well.
     if (isModified)
@@ -1561,6 +2035,32 @@ static bool InternalMergeTree
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get a new change revision for a tree.  0 is never given out, it means "no revision" to clients.
+ *
+ *  @return The new revision.
+ */
+// -------------------------------------------------------------------------------------------------
+static uint32_t NextChangeRevision
+(
+    void
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LastChangeRevision++;
+
+    if (LastChangeRevision == 0)
+    {
+        LastChangeRevision++;
+    }
+
+    return LastChangeRevision;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Create a new tree object and set it to default values.
@@ -1581,9 +2081,12 @@ tdb_TreeRef_t NewTree
 
     treeRef->isDeletePending = false;
     treeRef->originalTreeRef = NULL;
+    treeRef->isVersion = false;
     treeRef->revisionId = 0;
+    treeRef->changeRevision = NextChangeRevision();
     treeRef->rootNodeRef = (rootNodeRef != NULL) ? rootNodeRef : NewNode();
     treeRef->activeReadCount = 0;
+    treeRef->versionReadCount = 0;
     treeRef->activeWriteIterRef = NULL;
     treeRef->requestList = LE_SLS_LIST_INIT;
 
@@ -1612,6 +2115,7 @@ static void TreeDestructor
 
     // Sanity check, is the tree actually ready to clean up?
     LE_ASSERT(treeRef->activeReadCount == 0);
+    LE_ASSERT(treeRef->versionReadCount == 0);
     LE_ASSERT(treeRef->activeWriteIterRef == NULL);
     LE_ASSERT(le_sls_IsEmpty(&treeRef->requestList) == true);
 }
@@ -2402,33 +2906,37 @@ static le_result_t InternalWriteNode
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Calculate the number of bytes required to store a node path, including seperators and a trailing
- *  NULL.
+ *  Read a little-endian number from a snapshot.
  *
- *  @return The amount of bytes required to store the whole path string.
+ *  @return LE_OK if the number is read.
+ *          LE_FORMAT_ERROR if the snapshot is truncated.
  */
 // -------------------------------------------------------------------------------------------------
-static size_t ComputePathLength
+static le_result_t ReadSnapshotNumber
 (
-    tdb_NodeRef_t nodeRef  ///< [IN] Compute a path for this node.
+    SnapshotCursor_t* cursorPtr,  ///< [IN]  The snapshot being read.
+    size_t byteCount,             ///< [IN]  Size of the number, in bytes (1 to 4).
+    uint32_t* valuePtr            ///< [OUT] The number read.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    size_t pathLen = 0;
-    char nodeName[LE_CFG_NAME_LEN_BYTES] = "";
-
-    while (nodeRef != NULL)
+    if (cursorPtr->remaining < byteCount)
     {
-        LE_ASSERT(tdb_GetNodeName(nodeRef, nodeName, sizeof(nodeName)) == LE_OK);
+        LE_ERROR("Unexpected end of snapshot.");
+        return LE_FORMAT_ERROR;
+    }
 
-        // Add this path segment's length to our running total, along with the required path
-        // seperator.
-        pathLen += 1 + le_utf8_NumBytes(nodeName);
-        nodeRef = tdb_GetNodeParent(nodeRef);
+    *valuePtr = 0;
+
+    for (size_t i = 0; i < byteCount; i++)
+    {
+        *valuePtr |= (uint32_t)cursorPtr->dataPtr[i] << (8 * i);
     }
 
-    // Don't forget to include a spot for the trailing NULL.
-    return pathLen + 1;
+    cursorPtr->dataPtr += byteCount;
+    cursorPtr->remaining -= byteCount;
+
+    return LE_OK;
 }
 
 
@@ -2436,21 +2944,46 @@ static size_t ComputePathLength
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Bump up the version id of this tree.
+ *  Read a string from a snapshot.
+ *
+ *  @return LE_OK if the string is read.
+ *          LE_FORMAT_ERROR if the snapshot is truncated or the string is too large.
  */
 // -------------------------------------------------------------------------------------------------
-static void IncrementRevision
+static le_result_t ReadSnapshotString
 (
-    tdb_TreeRef_t treeRef  ///< [IN] Increment the revision of this tree.
+    SnapshotCursor_t* cursorPtr,  ///< [IN]  The snapshot being read.
+    char* stringPtr,              ///< [OUT] String buffer to hold the string read.
+    size_t stringSize             ///< [IN]  How big is the supplied string buffer?
 )
 // -------------------------------------------------------------------------------------------------
 {
-    treeRef->revisionId++;
+    uint32_t length;
 
-    if (treeRef->revisionId > 3)
+    if (ReadSnapshotNumber(cursorPtr, 2, &length) != LE_OK)
     {
-        treeRef->revisionId = 1;
+        return LE_FORMAT_ERROR;
+    }
+
+    if (length >= stringSize)
+    {
+        LE_ERROR("String too large in snapshot.  (%" PRIu32 "/%zd)", length, stringSize);
+        return LE_FORMAT_ERROR;
+    }
+
+    if (cursorPtr->remaining < length)
+    {
+        LE_ERROR("Unexpected end of snapshot.");
+        return LE_FORMAT_ERROR;
     }
+
+    memcpy(stringPtr, cursorPtr->dataPtr, length);
+    stringPtr[length] = 0;
+
+    cursorPtr->dataPtr += length;
+    cursorPtr->remaining -= length;
+
+    return LE_OK;
 }
 
 
@@ -2458,39 +2991,1368 @@ static void IncrementRevision
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Attempt to load a configuration tree from a config file.  This function will look for the latest
- *  valid version of the config file and load that one.
+ *  Read a node from a snapshot.  If the node is a collection, then read in its children too.
+ *  This has the same effect on the tree as InternalReadNode() reading the same node as text.
+ *
+ *  @return LE_OK if the read is successful.
+ *          LE_FORMAT_ERROR if the snapshot is truncated or corrupted.
  */
 // -------------------------------------------------------------------------------------------------
-static void LoadTree
+static le_result_t InternalReadSnapshotNode
 (
-    tdb_TreeRef_t treeRef  ///< [IN] The tree object to load from the filesystem.
+    tdb_NodeRef_t nodeRef,        ///< [IN] The node we're reading a value for.
+    SnapshotCursor_t* cursorPtr,  ///< [IN] The snapshot we're reading the value from.
+    size_t pathLen                ///< [IN] The length of the path including nodeRef.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // If we don't know the revision then hunt it out from the filesystem.
-    if (treeRef->revisionId == 0)
-    {
-        UpdateRevision(treeRef);
-    }
+    static char stringBuffer[LE_CFG_STR_LEN_BYTES] = "";
 
-    // If this tree has no root, create it now.
-    if (treeRef->rootNodeRef == NULL)
-    {
-        treeRef->rootNodeRef = NewNode();
-    }
+    uint32_t type;
 
-    // Ok, if we found a valid revision of the tree in the fs, try to load it now.
-    if (treeRef->revisionId != 0)
+    if (ReadSnapshotNumber(cursorPtr, 1, &type) != LE_OK)
     {
-        char pathPtr[LE_CFG_STR_LEN_BYTES] = "";
-        GetTreePath(treeRef->name, treeRef->revisionId, pathPtr, sizeof(pathPtr));
-
-        LE_DEBUG("** Loading configuration tree from '%s'.", pathPtr);
+        return LE_FORMAT_ERROR;
+    }
 
-        int fileRef = -1;
+    tdb_SetEmpty(nodeRef);
 
-        do
+    switch (type)
+    {
+        case SNAPSHOT_BOOL:
+            if (   (ReadSnapshotString(cursorPtr, stringBuffer, sizeof(stringBuffer)) != LE_OK)
+                || (   (strcmp(stringBuffer, "t") != 0)
+                    && (strcmp(stringBuffer, "f") != 0)))
+            {
+                LE_ERROR("Bad boolean value in snapshot.");
+                return LE_FORMAT_ERROR;
+            }
+            tdb_SetValueAsString(nodeRef, stringBuffer);
+            nodeRef->type = LE_CFG_TYPE_BOOL;
+            break;
+
+        case SNAPSHOT_INT:
+        case SNAPSHOT_FLOAT:
+        case SNAPSHOT_STRING:
+            if (ReadSnapshotString(cursorPtr, stringBuffer, sizeof(stringBuffer)) != LE_OK)
+            {
+                return LE_FORMAT_ERROR;
+            }
+            tdb_SetValueAsString(nodeRef, stringBuffer);
+
+            if (type == SNAPSHOT_INT)
+            {
+                nodeRef->type = LE_CFG_TYPE_INT;
+            }
+            else if (type == SNAPSHOT_FLOAT)
+            {
+                nodeRef->type = LE_CFG_TYPE_FLOAT;
+            }
+            break;
+
+        case SNAPSHOT_EMPTY:
+            // The node has already been cleared, so there's nothing left to do but make sure that
+            // the node exists.
+            ClearDeletedFlag(nodeRef);
+            break;
+
+        case SNAPSHOT_STEM:
+            {
+                uint32_t childCount;
+
+                if (ReadSnapshotNumber(cursorPtr, 4, &childCount) != LE_OK)
+                {
+                    return LE_FORMAT_ERROR;
+                }
+
+                for (uint32_t i = 0; i < childCount; i++)
+                {
+                    if (ReadSnapshotString(cursorPtr, stringBuffer, sizeof(stringBuffer)) != LE_OK)
+                    {
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    size_t strLen = le_utf8_NumBytes(stringBuffer);
+                    size_t newPathLen = pathLen + 1 + strLen;
+
+                    if (newPathLen > LE_CFG_STR_LEN)
+                    {
+                        LE_ERROR("New path length for node '%s' is too long.  %zu of %zu bytes.",
+                                 stringBuffer,
+                                 strLen,
+                                 (size_t)LE_CFG_STR_LEN);
+
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    // The names in a snapshot were written from a tree, so they are unique in
+                    // their collection.  Unlike the text reader, don't search the collection for
+                    // them, which makes loading large collections quadratic.
+                    if (CheckNodeName(stringBuffer) != LE_OK)
+                    {
+                        LE_ERROR("Bad node name, '%s'.", stringBuffer);
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    tdb_NodeRef_t childRef = NewChildNode(nodeRef);
+                    childRef->nameRef = dstr_NewFromCstr(stringBuffer);
+
+                    tdb_EnsureExists(childRef);
+
+                    le_result_t result = InternalReadSnapshotNode(childRef, cursorPtr, newPathLen);
+
+                    if (result != LE_OK)
+                    {
+                        return result;
+                    }
+                }
+            }
+            break;
+
+        default:
+            LE_ERROR("Unexpected node type, %" PRIu32 ", in snapshot.", type);
+            return LE_FORMAT_ERROR;
+    }
+
+    if (IsShadow(nodeRef) == false)
+    {
+        ClearModifiedFlag(nodeRef);
+    }
+    else
+    {
+        SetModifiedFlag(nodeRef);
+    }
+
+    tdb_EnsureExists(nodeRef);
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Map a tree file, if it is a snapshot.
+ *
+ *  @return The address of the mapping, or NULL if the file isn't a snapshot (or can't be mapped,
+ *          in which case it is read as text, and rejected).
+ */
+// -------------------------------------------------------------------------------------------------
+static void* MapSnapshot
+(
+    int descriptor,   ///< [IN]  The file to map.
+    size_t* sizePtr   ///< [OUT] The size of the mapping.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+    char magic[SNAPSHOT_MAGIC_BYTES];
+
+    // Pipes and such can't be mapped, nor can they hold a snapshot.
+    if (   (fstat(descriptor, &fileStat) != 0)
+        || (S_ISREG(fileStat.st_mode) == false)
+        || (fileStat.st_size < (off_t)SNAPSHOT_MAGIC_BYTES)
+        || (pread(descriptor, magic, sizeof(magic), 0) != (ssize_t)sizeof(magic))
+        || (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0))
+    {
+        return NULL;
+    }
+
+    void* mapPtr = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    if (mapPtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map config tree snapshot (%m).");
+        return NULL;
+    }
+
+    *sizePtr = fileStat.st_size;
+
+    return mapPtr;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a little-endian number to a snapshot.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteSnapshotNumber
+(
+    FILE* filePtr,     ///< [IN] The file being written to.
+    size_t byteCount,  ///< [IN] Size of the number, in bytes (1 to 4).
+    uint32_t value     ///< [IN] The number to write.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    uint8_t bytes[4];
+
+    for (size_t i = 0; i < byteCount; i++)
+    {
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    }
+
+    return WriteFile(filePtr, bytes, byteCount);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a string to a snapshot.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteSnapshotString
+(
+    FILE* filePtr,         ///< [IN] The file being written to.
+    const char* stringPtr  ///< [IN] The string to write.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t length = strlen(stringPtr);
+
+    LE_ASSERT(length <= UINT16_MAX);
+
+    le_result_t result = WriteSnapshotNumber(filePtr, 2, length);
+
+    if (result == LE_OK)
+    {
+        result = WriteFile(filePtr, stringPtr, length);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children to a snapshot.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t InternalWriteSnapshotNode
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node being written.
+    FILE* filePtr           ///< [IN] The file being written to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // If there is no node to write, or if the node is marked as having been deleted...  Then write
+    // a blank node.
+    if (   (nodeRef == NULL)
+        || (IsDeleted(nodeRef) == true))
+    {
+        return WriteSnapshotNumber(filePtr, 1, SNAPSHOT_EMPTY);
+    }
+
+    static char stringBuffer[LE_CFG_STR_LEN_BYTES] = "";
+    SnapshotType_t type = SNAPSHOT_EMPTY;
+
+    switch (nodeRef->type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+        case LE_CFG_TYPE_DOESNT_EXIST:
+            return WriteSnapshotNumber(filePtr, 1, SNAPSHOT_EMPTY);
+
+        case LE_CFG_TYPE_BOOL:
+            type = SNAPSHOT_BOOL;
+            break;
+
+        case LE_CFG_TYPE_STRING:
+            type = SNAPSHOT_STRING;
+            break;
+
+        case LE_CFG_TYPE_INT:
+            type = SNAPSHOT_INT;
+            break;
+
+        case LE_CFG_TYPE_FLOAT:
+            type = SNAPSHOT_FLOAT;
+            break;
+
+        // Looks like this node is a collection, so write out it's child nodes now.
+        case LE_CFG_TYPE_STEM:
+            {
+                uint32_t childCount = 0;
+                tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (childRef != NULL)
+                {
+                    childCount++;
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+                }
+
+                le_result_t result = WriteSnapshotNumber(filePtr, 1, SNAPSHOT_STEM);
+
+                if (result == LE_OK)
+                {
+                    result = WriteSnapshotNumber(filePtr, 4, childCount);
+                }
+
+                childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (   (childRef != NULL)
+                       && (result == LE_OK))
+                {
+                    tdb_GetNodeName(childRef, stringBuffer, sizeof(stringBuffer));
+                    result = WriteSnapshotString(filePtr, stringBuffer);
+
+                    if (result == LE_OK)
+                    {
+                        result = InternalWriteSnapshotNode(childRef, filePtr);
+                    }
+
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+                }
+
+                return result;
+            }
+    }
+
+    tdb_GetValueAsString(nodeRef, stringBuffer, sizeof(stringBuffer), "");
+
+    le_result_t result = WriteSnapshotNumber(filePtr, 1, type);
+
+    if (result == LE_OK)
+    {
+        result = WriteSnapshotString(filePtr, stringBuffer);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write text to a JSON document.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJsonText
+(
+    FILE* filePtr,       ///< [IN] The file being written to.
+    const char* textPtr  ///< [IN] The text to write, as is.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    return WriteFile(filePtr, textPtr, strlen(textPtr));
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a string to a JSON document, quoted and with its special characters escaped.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteJsonString
+(
+    FILE* filePtr,         ///< [IN] The file being written to.
+    const char* stringPtr  ///< [IN] The string to write.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_result_t result = WriteFile(filePtr, "\"", 1);
+
+    while (   (*stringPtr != 0)
+           && (result == LE_OK))
+    {
+        // Write the characters that don't need escaping in one go.
+        size_t plainBytes = strcspn(stringPtr, "\"\\\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b"
+                                               "\x0c\x0d\x0e\x0f\x10\x11\x12\x13\x14\x15\x16\x17"
+                                               "\x18\x19\x1a\x1b\x1c\x1d\x1e\x1f");
+
+        if (plainBytes > 0)
+        {
+            result = WriteFile(filePtr, stringPtr, plainBytes);
+            stringPtr += plainBytes;
+            continue;
+        }
+
+        char escape[8];
+
+        switch (*stringPtr)
+        {
+            case '\"': strcpy(escape, "\\\"");  break;
+            case '\\': strcpy(escape, "\\\\");  break;
+            case '\n': strcpy(escape, "\\n");   break;
+            case '\r': strcpy(escape, "\\r");   break;
+            case '\t': strcpy(escape, "\\t");   break;
+            default:
+                snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)*stringPtr);
+                break;
+        }
+
+        result = WriteJsonText(filePtr, escape);
+        stringPtr++;
+    }
+
+    if (result == LE_OK)
+    {
+        result = WriteFile(filePtr, "\"", 1);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children as a JSON object.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t InternalWriteJsonNode
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node being written.
+    FILE* filePtr           ///< [IN] The file being written to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Only the node being exported can be missing, children that don't exist aren't listed.
+    if (   (nodeRef == NULL)
+        || (IsDeleted(nodeRef) == true))
+    {
+        return WriteJsonText(filePtr, "{}");
+    }
+
+    static char stringBuffer[LE_CFG_STR_LEN_BYTES] = "";
+
+    tdb_GetNodeName(nodeRef, stringBuffer, sizeof(stringBuffer));
+
+    le_result_t result = WriteJsonText(filePtr, "{\"name\":");
+
+    if (result == LE_OK)
+    {
+        result = WriteJsonString(filePtr, stringBuffer);
+    }
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    switch (nodeRef->type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+        case LE_CFG_TYPE_DOESNT_EXIST:
+            return WriteJsonText(filePtr, ",\"type\":\"stem\",\"children\":[]}");
+
+        case LE_CFG_TYPE_BOOL:
+            return WriteJsonText(filePtr,
+                                 tdb_GetValueAsBool(nodeRef, false)
+                                     ? ",\"type\":\"bool\",\"value\":true}"
+                                     : ",\"type\":\"bool\",\"value\":false}");
+
+        case LE_CFG_TYPE_STRING:
+            tdb_GetValueAsString(nodeRef, stringBuffer, sizeof(stringBuffer), "");
+
+            result = WriteJsonText(filePtr, ",\"type\":\"string\",\"value\":");
+
+            if (result == LE_OK)
+            {
+                result = WriteJsonString(filePtr, stringBuffer);
+            }
+            break;
+
+        case LE_CFG_TYPE_INT:
+            snprintf(stringBuffer,
+                     sizeof(stringBuffer),
+                     ",\"type\":\"int\",\"value\":%" PRId32,
+                     tdb_GetValueAsInt(nodeRef, 0));
+
+            result = WriteJsonText(filePtr, stringBuffer);
+            break;
+
+        case LE_CFG_TYPE_FLOAT:
+            {
+                // Write enough digits to read the same number back, and make sure that it doesn't
+                // read back as an integer.
+                double value = tdb_GetValueAsFloat(nodeRef, 0.0);
+
+                if (isfinite(value))
+                {
+                    snprintf(stringBuffer, sizeof(stringBuffer), "%.17g", value);
+
+                    if (strpbrk(stringBuffer, ".e") == NULL)
+                    {
+                        strcat(stringBuffer, ".0");
+                    }
+                }
+                else
+                {
+                    strcpy(stringBuffer, "null");
+                }
+
+                result = WriteJsonText(filePtr, ",\"type\":\"float\",\"value\":");
+
+                if (result == LE_OK)
+                {
+                    result = WriteJsonText(filePtr, stringBuffer);
+                }
+            }
+            break;
+
+        // The root of a tree is the only stem without a name.
+        case LE_CFG_TYPE_STEM:
+            {
+                result = WriteJsonText(filePtr,
+                                       stringBuffer[0] == 0
+                                           ? ",\"type\":\"tree\",\"children\":["
+                                           : ",\"type\":\"stem\",\"children\":[");
+
+                tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (   (childRef != NULL)
+                       && (result == LE_OK))
+                {
+                    result = InternalWriteJsonNode(childRef, filePtr);
+
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+
+                    if (   (childRef != NULL)
+                        && (result == LE_OK))
+                    {
+                        result = WriteFile(filePtr, ",", 1);
+                    }
+                }
+
+                if (result == LE_OK)
+                {
+                    result = WriteFile(filePtr, "]", 1);
+                }
+            }
+            break;
+    }
+
+    if (result == LE_OK)
+    {
+        result = WriteFile(filePtr, "}", 1);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Skip the white space in a JSON document.
+ *
+ *  @return The next character of the document, which is left to be read, or EOF.
+ */
+// -------------------------------------------------------------------------------------------------
+static int PeekJsonChar
+(
+    FILE* filePtr  ///< [IN] The file we're reading from.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    int next;
+
+    do
+    {
+        next = fgetc(filePtr);
+    }
+    while (   (next == ' ')
+           || (next == '\t')
+           || (next == '\n')
+           || (next == '\r'));
+
+    if (next != EOF)
+    {
+        ungetc(next, filePtr);
+    }
+
+    return next;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a given character from a JSON document, after any white space.
+ *
+ *  @return True if the character was next, and has been read.  False if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool ReadJsonChar
+(
+    FILE* filePtr,  ///< [IN] The file we're reading from.
+    int expected    ///< [IN] The character to read.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (PeekJsonChar(filePtr) != expected)
+    {
+        return false;
+    }
+
+    fgetc(filePtr);
+
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read the four hexadecimal digits of a \\u escape in a JSON string.
+ *
+ *  @return LE_OK if the digits were read, LE_FORMAT_ERROR if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ReadJsonHexDigits
+(
+    FILE* filePtr,         ///< [IN]  The file we're reading from.
+    uint32_t* codePointPtr ///< [OUT] The value of the digits.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    *codePointPtr = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        int next = fgetc(filePtr);
+
+        if (isxdigit(next) == 0)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        *codePointPtr <<= 4;
+        *codePointPtr |= isdigit(next) ? next - '0' : (next | 0x20) - 'a' + 10;
+    }
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a string from a JSON document, and unescape it.
+ *
+ *  @return LE_OK if the string was read.
+ *          LE_OVERFLOW if the string doesn't fit into the buffer.
+ *          LE_FORMAT_ERROR if there is no valid string to read.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ReadJsonString
+(
+    FILE* filePtr,     ///< [IN]  The file we're reading from.
+    char* stringPtr,   ///< [OUT] String buffer to hold the string.
+    size_t stringSize  ///< [IN]  How big is the supplied string buffer?
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (ReadJsonChar(filePtr, '\"') == false)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    size_t length = 0;
+
+    while (true)
+    {
+        int next = fgetc(filePtr);
+        uint32_t codePoint;
+
+        if (next == EOF)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        if (next == '\"')
+        {
+            break;
+        }
+
+        if (next != '\\')
+        {
+            if (length + 1 >= stringSize)
+            {
+                return LE_OVERFLOW;
+            }
+
+            stringPtr[length++] = next;
+            continue;
+        }
+
+        switch (next = fgetc(filePtr))
+        {
+            case '\"':
+            case '\\':
+            case '/':  codePoint = next;  break;
+            case 'b':  codePoint = '\b';  break;
+            case 'f':  codePoint = '\f';  break;
+            case 'n':  codePoint = '\n';  break;
+            case 'r':  codePoint = '\r';  break;
+            case 't':  codePoint = '\t';  break;
+
+            case 'u':
+                if (ReadJsonHexDigits(filePtr, &codePoint) != LE_OK)
+                {
+                    return LE_FORMAT_ERROR;
+                }
+
+                // Characters outside of the basic plane are escaped as a pair of surrogates.
+                if ((codePoint >= 0xd800) && (codePoint < 0xdc00))
+                {
+                    uint32_t lowSurrogate;
+
+                    if (   (fgetc(filePtr) != '\\')
+                        || (fgetc(filePtr) != 'u')
+                        || (ReadJsonHexDigits(filePtr, &lowSurrogate) != LE_OK)
+                        || (lowSurrogate < 0xdc00)
+                        || (lowSurrogate > 0xdfff))
+                    {
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (lowSurrogate - 0xdc00);
+                }
+                else if (   (codePoint == 0)
+                         || ((codePoint >= 0xdc00) && (codePoint <= 0xdfff)))
+                {
+                    return LE_FORMAT_ERROR;
+                }
+                break;
+
+            default:
+                return LE_FORMAT_ERROR;
+        }
+
+        // Store the character as UTF-8.
+        size_t byteCount = (codePoint < 0x80) ? 1 : (codePoint < 0x800) ? 2 :
+                           (codePoint < 0x10000) ? 3 : 4;
+
+        if (length + byteCount >= stringSize)
+        {
+            return LE_OVERFLOW;
+        }
+
+        if (byteCount == 1)
+        {
+            stringPtr[length++] = codePoint;
+        }
+        else
+        {
+            static const uint8_t LeadBits[] = { 0, 0, 0xc0, 0xe0, 0xf0 };
+
+            for (size_t i = byteCount - 1; i > 0; i--)
+            {
+                stringPtr[length + i] = 0x80 | (codePoint & 0x3f);
+                codePoint >>= 6;
+            }
+
+            stringPtr[length] = LeadBits[byteCount] | codePoint;
+            length += byteCount;
+        }
+    }
+
+    stringPtr[length] = 0;
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a literal from a JSON document: a number, true, false, or null.
+ *
+ *  @return LE_OK if the literal was read.
+ *          LE_OVERFLOW if the literal doesn't fit into the buffer.
+ *          LE_FORMAT_ERROR if there is no literal to read.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ReadJsonLiteral
+(
+    FILE* filePtr,     ///< [IN]  The file we're reading from.
+    char* stringPtr,   ///< [OUT] String buffer to hold the literal.
+    size_t stringSize  ///< [IN]  How big is the supplied string buffer?
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t length = 0;
+
+    PeekJsonChar(filePtr);
+    int next = fgetc(filePtr);
+
+    while (   (isalnum(next))
+           || (next == '-')
+           || (next == '+')
+           || (next == '.'))
+    {
+        if (length + 1 >= stringSize)
+        {
+            return LE_OVERFLOW;
+        }
+
+        stringPtr[length++] = next;
+        next = fgetc(filePtr);
+    }
+
+    if (next != EOF)
+    {
+        ungetc(next, filePtr);
+    }
+
+    stringPtr[length] = 0;
+
+    return (length > 0) ? LE_OK : LE_FORMAT_ERROR;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Skip a value of a JSON document, of any type.  Used for the members of the node objects that
+ *  aren't known.
+ *
+ *  @return LE_OK if the value was skipped, LE_FORMAT_ERROR if it isn't valid.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t SkipJsonValue
+(
+    FILE* filePtr,  ///< [IN] The file we're reading from.
+    size_t depth    ///< [IN] The nesting depth of the value.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    static char stringBuffer[LE_CFG_STR_LEN_BYTES] = "";
+
+    if (depth > JSON_MAX_DEPTH)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    int next = PeekJsonChar(filePtr);
+
+    if (next == '\"')
+    {
+        return ReadJsonString(filePtr, stringBuffer, sizeof(stringBuffer));
+    }
+
+    if (   (next != '{')
+        && (next != '['))
+    {
+        return ReadJsonLiteral(filePtr, stringBuffer, sizeof(stringBuffer));
+    }
+
+    int closeChar = (next == '{') ? '}' : ']';
+
+    fgetc(filePtr);
+
+    if (ReadJsonChar(filePtr, closeChar))
+    {
+        return LE_OK;
+    }
+
+    do
+    {
+        if (   (closeChar == '}')
+            && (   (ReadJsonString(filePtr, stringBuffer, sizeof(stringBuffer)) != LE_OK)
+                || (ReadJsonChar(filePtr, ':') == false)))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        if (SkipJsonValue(filePtr, depth + 1) != LE_OK)
+        {
+            return LE_FORMAT_ERROR;
+        }
+    }
+    while (ReadJsonChar(filePtr, ','));
+
+    return ReadJsonChar(filePtr, closeChar) ? LE_OK : LE_FORMAT_ERROR;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Set the value read for a node from a JSON document, according to the node's type.
+ *
+ *  @return LE_OK if the value was set, LE_FORMAT_ERROR if it doesn't match the type.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t SetJsonValue
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node to set.
+    const char* typePtr,    ///< [IN] The type of the node.
+    const char* valuePtr,   ///< [IN] The value of the node.
+    bool isString           ///< [IN] Was the value a string, rather than a literal?
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char* endPtr = NULL;
+
+    if (strcmp(typePtr, "string") == 0)
+    {
+        if (isString == false)
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        tdb_SetValueAsString(nodeRef, valuePtr);
+    }
+    else if (isString == true)
+    {
+        return LE_FORMAT_ERROR;
+    }
+    else if (strcmp(typePtr, "bool") == 0)
+    {
+        if (   (strcmp(valuePtr, "true") != 0)
+            && (strcmp(valuePtr, "false") != 0))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        tdb_SetValueAsBool(nodeRef, valuePtr[0] == 't');
+    }
+    else if (strcmp(typePtr, "int") == 0)
+    {
+        errno = 0;
+        long long value = strtoll(valuePtr, &endPtr, 10);
+
+        if (   (*endPtr != 0)
+            || (errno != 0)
+            || (value < INT32_MIN)
+            || (value > INT32_MAX))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        tdb_SetValueAsInt(nodeRef, (int)value);
+    }
+    else if (strcmp(typePtr, "float") == 0)
+    {
+        double value = strtod(valuePtr, &endPtr);
+
+        if (   (*endPtr != 0)
+            || (isfinite(value) == false)
+            || (isalpha(valuePtr[0])))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        tdb_SetValueAsFloat(nodeRef, value);
+    }
+    else
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a node from a JSON document.  If the node is a stem, then read in its children too.
+ *
+ *  The members of the node's object can come in any order, so the node is only named and given its
+ *  value once the whole object has been read.
+ *
+ *  @return LE_OK if the read is successful.
+ *          LE_FORMAT_ERROR if parse errors are encountered.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t InternalReadJsonNode
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN]  The node we're reading, already empty.
+    FILE* filePtr,          ///< [IN]  The file we're reading the node from.
+    size_t depth,           ///< [IN]  How deep the node is under the node being imported.
+    size_t* pathLenPtr      ///< [OUT] Length of the longest path from the node's parent into the
+                            ///<       node's children.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char name[LE_CFG_NAME_LEN_BYTES] = "";
+    char type[SMALL_STR] = "";
+    char value[LE_CFG_STR_LEN_BYTES] = "";
+    bool hasName = false;
+    bool hasValue = false;
+    bool isString = false;
+    bool hasChildren = false;
+    size_t childPathLen = 0;
+
+    if (depth > JSON_MAX_DEPTH)
+    {
+        LE_ERROR("JSON nodes nested too deeply.");
+        return LE_FORMAT_ERROR;
+    }
+
+    if (ReadJsonChar(filePtr, '{') == false)
+    {
+        LE_ERROR("Expected a JSON object for a node.");
+        return LE_FORMAT_ERROR;
+    }
+
+    // An empty object is a node that doesn't exist, which can only be the one being imported.  It
+    // is imported as an empty node.
+    if (ReadJsonChar(filePtr, '}'))
+    {
+        if (depth > 0)
+        {
+            LE_ERROR("Empty JSON object for a child node.");
+            return LE_FORMAT_ERROR;
+        }
+
+        *pathLenPtr = 0;
+        return LE_OK;
+    }
+
+    do
+    {
+        char member[SMALL_STR] = "";
+        le_result_t result = ReadJsonString(filePtr, member, sizeof(member));
+
+        if (   (result == LE_OK)
+            && (ReadJsonChar(filePtr, ':') == false))
+        {
+            result = LE_FORMAT_ERROR;
+        }
+
+        if (result != LE_OK)
+        {
+            // Members with names this long aren't ones we know, but they can't be skipped either.
+            LE_ERROR("Bad member in JSON object.");
+            return LE_FORMAT_ERROR;
+        }
+
+        if (strcmp(member, "name") == 0)
+        {
+            result = ReadJsonString(filePtr, name, sizeof(name));
+            hasName = true;
+        }
+        else if (strcmp(member, "type") == 0)
+        {
+            result = ReadJsonString(filePtr, type, sizeof(type));
+        }
+        else if (strcmp(member, "value") == 0)
+        {
+            isString = (PeekJsonChar(filePtr) == '\"');
+            result = isString ? ReadJsonString(filePtr, value, sizeof(value))
+                              : ReadJsonLiteral(filePtr, value, sizeof(value));
+            hasValue = true;
+        }
+        else if (strcmp(member, "children") == 0)
+        {
+            hasChildren = true;
+
+            if (ReadJsonChar(filePtr, '[') == false)
+            {
+                result = LE_FORMAT_ERROR;
+            }
+            else if (ReadJsonChar(filePtr, ']') == false)
+            {
+                do
+                {
+                    tdb_NodeRef_t childRef = NewChildNode(nodeRef);
+                    size_t pathLen = 0;
+
+                    tdb_EnsureExists(childRef);
+                    result = InternalReadJsonNode(childRef, filePtr, depth + 1, &pathLen);
+
+                    if (pathLen > childPathLen)
+                    {
+                        childPathLen = pathLen;
+                    }
+                }
+                while (   (result == LE_OK)
+                       && (ReadJsonChar(filePtr, ',')));
+
+                // A child that failed to load has already said why.
+                if (result != LE_OK)
+                {
+                    return LE_FORMAT_ERROR;
+                }
+
+                if (ReadJsonChar(filePtr, ']') == false)
+                {
+                    result = LE_FORMAT_ERROR;
+                }
+            }
+        }
+        else
+        {
+            result = SkipJsonValue(filePtr, depth + 1);
+        }
+
+        if (result != LE_OK)
+        {
+            LE_ERROR("Bad value for member '%s' in JSON object.", member);
+            return LE_FORMAT_ERROR;
+        }
+    }
+    while (ReadJsonChar(filePtr, ','));
+
+    if (ReadJsonChar(filePtr, '}') == false)
+    {
+        LE_ERROR("Unexpected character found while looking for '}'.");
+        return LE_FORMAT_ERROR;
+    }
+
+    // The name of the node being imported is left as it is.
+    if (depth > 0)
+    {
+        if (   (hasName == false)
+            || (tdb_SetNodeName(nodeRef, name) != LE_OK))
+        {
+            LE_ERROR("Bad or duplicate node name, '%s'.", name);
+            return LE_FORMAT_ERROR;
+        }
+    }
+
+    *pathLenPtr = ((depth > 0) ? 1 + strlen(name) : 0) + childPathLen;
+
+    // Stems without children are left empty.
+    if (   (strcmp(type, "stem") == 0)
+        || (   (strcmp(type, "tree") == 0)
+            && (depth == 0)))
+    {
+        if (hasValue)
+        {
+            LE_ERROR("Stem node '%s' has a value.", name);
+            return LE_FORMAT_ERROR;
+        }
+    }
+    else if (   (hasChildren)
+             || (hasValue == false)
+             || (SetJsonValue(nodeRef, type, value, isString) != LE_OK))
+    {
+        LE_ERROR("Bad value for node '%s' of type '%s'.", name, type);
+        return LE_FORMAT_ERROR;
+    }
+
+    if (IsShadow(nodeRef) == false)
+    {
+        ClearModifiedFlag(nodeRef);
+    }
+    else
+    {
+        SetModifiedFlag(nodeRef);
+    }
+
+    tdb_EnsureExists(nodeRef);
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Merge a node read from a JSON document into a node of the tree.  Leaf values overwrite the
+ *  node's value, and the children of stems are merged into the children of the same name.  Children
+ *  that are not in the document are left alone.
+ *
+ *  @return LE_OK if the merge is successful.
+ *          LE_NOT_POSSIBLE if a stem in the document has a child with the same name as an existing
+ *          node that has a value.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t MergeJsonNode
+(
+    tdb_NodeRef_t nodeRef,   ///< [IN] The node to merge into.
+    tdb_NodeRef_t importRef  ///< [IN] The node read from the document.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char stringBuffer[LE_CFG_STR_LEN_BYTES] = "";
+
+    switch (importRef->type)
+    {
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            // Copy the value over as it was read, so that it isn't reformatted along the way.
+            dstr_CopyToCstr(stringBuffer, sizeof(stringBuffer), importRef->info.valueRef, NULL);
+            tdb_SetValueAsString(nodeRef, stringBuffer);
+            nodeRef->type = importRef->type;
+            break;
+
+        case LE_CFG_TYPE_STEM:
+            {
+                tdb_NodeRef_t childRef = tdb_GetFirstChildNode(importRef);
+
+                while (childRef != NULL)
+                {
+                    tdb_GetNodeName(childRef, stringBuffer, sizeof(stringBuffer));
+
+                    tdb_NodeRef_t targetRef = GetNamedChild(nodeRef, stringBuffer);
+
+                    switch (tdb_GetNodeType(targetRef))
+                    {
+                        case LE_CFG_TYPE_DOESNT_EXIST:
+                        case LE_CFG_TYPE_STEM:
+                        case LE_CFG_TYPE_EMPTY:
+                            break;
+
+                        default:
+                            LE_ERROR("Node conflict when importing, at node '%s'.", stringBuffer);
+                            return LE_NOT_POSSIBLE;
+                    }
+
+                    if (targetRef == NULL)
+                    {
+                        targetRef = CreateNamedChild(nodeRef, stringBuffer);
+
+                        if (targetRef == NULL)
+                        {
+                            LE_ERROR("Could not create node '%s' when importing.", stringBuffer);
+                            return LE_NOT_POSSIBLE;
+                        }
+                    }
+
+                    le_result_t result = MergeJsonNode(targetRef, childRef);
+
+                    if (result != LE_OK)
+                    {
+                        return result;
+                    }
+
+                    childRef = tdb_GetNextSiblingNode(childRef);
+                }
+            }
+            break;
+
+        default:
+            // Empty stems add nothing to the tree.
+            break;
+    }
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Calculate the number of bytes required to store a node path, including seperators and a trailing
+ *  NULL.
+ *
+ *  @return The amount of bytes required to store the whole path string.
+ */
+// -------------------------------------------------------------------------------------------------
+static size_t ComputePathLength
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] Compute a path for this node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t pathLen = 0;
+    char nodeName[LE_CFG_NAME_LEN_BYTES] = "";
+
+    while (nodeRef != NULL)
+    {
+        LE_ASSERT(tdb_GetNodeName(nodeRef, nodeName, sizeof(nodeName)) == LE_OK);
+
+        // Add this path segment's length to our running total, along with the required path
+        // seperator.
+        pathLen += 1 + le_utf8_NumBytes(nodeName);
+        nodeRef = tdb_GetNodeParent(nodeRef);
+    }
+
+    // Don't forget to include a spot for the trailing NULL.
+    return pathLen + 1;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Bump up the version id of this tree.
+ */
+// -------------------------------------------------------------------------------------------------
+static void IncrementRevision
+(
+    tdb_TreeRef_t treeRef  ///< [IN] Increment the revision of this tree.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    treeRef->revisionId++;
+
+    if (treeRef->revisionId > 3)
+    {
+        treeRef->revisionId = 1;
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Attempt to load a configuration tree from a config file.  This function will look for the latest
+ *  valid version of the config file and load that one.
+ */
+// -------------------------------------------------------------------------------------------------
+static void LoadTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree object to load from the filesystem.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // If we don't know the revision then hunt it out from the filesystem.
+    if (treeRef->revisionId == 0)
+    {
+        UpdateRevision(treeRef);
+    }
+
+    // If this tree has no root, create it now.
+    if (treeRef->rootNodeRef == NULL)
+    {
+        treeRef->rootNodeRef = NewNode();
+    }
+
+    // Ok, if we found a valid revision of the tree in the fs, try to load it now.
+    if (treeRef->revisionId != 0)
+    {
+        char pathPtr[LE_CFG_STR_LEN_BYTES] = "";
+        GetTreePath(treeRef->name, treeRef->revisionId, pathPtr, sizeof(pathPtr));
+
+        LE_DEBUG("** Loading configuration tree from '%s'.", pathPtr);
+
+        int fileRef = -1;
+
+        do
         {
             fileRef = open(pathPtr, O_RDONLY);
         }
@@ -2543,6 +4405,12 @@ static void RemoveHandler
     le_ref_DeleteRef(HandlerSafeRefMap, handlerPtr->safeRef);
     le_dls_Remove(&registrationPtr->handlerList, &handlerPtr->link);
 
+    if (handlerPtr->pathsHandlerPtr != NULL)
+    {
+        registrationPtr->pathsHandlerCount--;
+        PathsHandlerCount--;
+    }
+
     // Clear out the link data, just to be safe.
     handlerPtr->link = LE_DLS_LINK_INIT;
     handlerPtr->sessionRef = NULL;
@@ -2556,6 +4424,31 @@ static void RemoveHandler
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Remove a registration object that no longer has any handlers from the registration map, and
+ *  from the pending notifications, then free it.
+ */
+// -------------------------------------------------------------------------------------------------
+static void ReleaseRegistration
+(
+    Registration_t* registrationPtr  ///< [IN] The registration object to free.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_hashmap_Remove(HandlerRegistrationMap, registrationPtr->registrationPath);
+
+    if (registrationPtr->pending)
+    {
+        le_dls_Remove(&PendingList, &registrationPtr->pendingLink);
+    }
+
+    le_mem_Release(registrationPtr);
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  This function is called by the hash map ForEach function, which is invoked when a session closed
@@ -2849,6 +4742,7 @@ void tdb_DeleteTree
     // tree for deletion for now.
     if (   (tdb_GetActiveWriteIter(treeRef) == NULL)
         && (tdb_HasActiveReaders(treeRef) == 0)
+        && (treeRef->versionReadCount == 0)
         && (le_sls_IsEmpty(&treeRef->requestList)))
     {
         // Looks like there's no one on the tree, so delete any tree files that may exist.  Then
@@ -2924,6 +4818,106 @@ tdb_TreeRef_t tdb_ShadowTree
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Freeze the current contents of a tree into a version of it.  The readers of the tree are moved
+ *  to the version with tdb_MoveReader(), and keep reading it while the tree changes.  The version
+ *  is freed once they are all done with it.
+ *
+ *  @return The new version.  The caller holds a reference to it, that it releases with
+ *          tdb_ReleaseTree() once it has moved the readers.
+ */
+// -------------------------------------------------------------------------------------------------
+tdb_TreeRef_t tdb_CreateVersion
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to freeze, or a shadow of it.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (treeRef->originalTreeRef != NULL)
+    {
+        treeRef = treeRef->originalTreeRef;
+    }
+
+    LE_ASSERT(treeRef->isVersion == false);
+
+    tdb_TreeRef_t versionRef = NewTree(treeRef->name, CopyNode(treeRef->rootNodeRef, NULL));
+
+    versionRef->originalTreeRef = treeRef;
+    versionRef->isVersion = true;
+    versionRef->changeRevision = treeRef->changeRevision;
+
+    return versionRef;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Move the registration of a read iterator from a tree to a version of the tree.  The iterator
+ *  must then read the version's nodes instead of the tree's.
+ *
+ *  @return True if the iterator was on the version's tree and has been moved.  False if it's on
+ *          another tree, or on a version, and has been left alone.
+ */
+// -------------------------------------------------------------------------------------------------
+bool tdb_MoveReader
+(
+    tdb_TreeRef_t treeRef,    ///< [IN] The tree the reader is on.
+    tdb_TreeRef_t versionRef  ///< [IN] The version to move the reader to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(versionRef->isVersion);
+
+    if (treeRef != versionRef->originalTreeRef)
+    {
+        return false;
+    }
+
+    // The tree still counts the reader, so that it isn't deleted before the reader is done.
+    treeRef->activeReadCount--;
+    LE_ASSERT(treeRef->activeReadCount >= 0);
+    treeRef->versionReadCount++;
+
+    // Each reader holds a reference to the version, released along with the reader.
+    versionRef->activeReadCount++;
+    le_mem_AddRef(versionRef);
+
+    return true;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get the change revision of a tree, which changes every time changes are merged into the tree.
+ *
+ *  @return The tree's change revision.
+ */
+// -------------------------------------------------------------------------------------------------
+uint32_t tdb_GetChangeRevision
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree object to read.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(treeRef != NULL);
+
+    if (   (treeRef->originalTreeRef != NULL)
+        && (treeRef->isVersion == false))
+    {
+        treeRef = treeRef->originalTreeRef;
+    }
+
+    return treeRef->changeRevision;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Called to create a new tree that shadows an existing one.
@@ -3067,26 +5061,41 @@ void tdb_UnregisterIterator
     LE_ASSERT(treeRef != NULL);
     LE_ASSERT(iteratorRef != NULL);
 
-    if (treeRef->originalTreeRef != NULL)
+    if (treeRef->isVersion)
     {
-        treeRef = treeRef->originalTreeRef;
-    }
+        // Readers moved to a version are counted by both the version and its tree.
+        LE_ASSERT(ni_IsWriteable(iteratorRef) == false);
 
-    if (ni_IsWriteable(iteratorRef))
-    {
-        LE_FATAL_IF(treeRef->activeWriteIterRef != iteratorRef,
-                    "Internal error, unregistering write iterator <%p>, "
-                    "but tree had write iterator <%p> registered on tree <%p>.",
-                    iteratorRef,
-                    treeRef->activeWriteIterRef,
-                    treeRef);
+        treeRef->activeReadCount--;
+        LE_ASSERT(treeRef->activeReadCount >= 0);
 
-        treeRef->activeWriteIterRef = NULL;
+        treeRef = treeRef->originalTreeRef;
+        treeRef->versionReadCount--;
+        LE_ASSERT(treeRef->versionReadCount >= 0);
     }
     else
     {
-        treeRef->activeReadCount--;
-        LE_ASSERT(treeRef->activeReadCount >= 0);
+        if (treeRef->originalTreeRef != NULL)
+        {
+            treeRef = treeRef->originalTreeRef;
+        }
+
+        if (ni_IsWriteable(iteratorRef))
+        {
+            LE_FATAL_IF(treeRef->activeWriteIterRef != iteratorRef,
+                        "Internal error, unregistering write iterator <%p>, "
+                        "but tree had write iterator <%p> registered on tree <%p>.",
+                        iteratorRef,
+                        treeRef->activeWriteIterRef,
+                        treeRef);
+
+            treeRef->activeWriteIterRef = NULL;
+        }
+        else
+        {
+            treeRef->activeReadCount--;
+            LE_ASSERT(treeRef->activeReadCount >= 0);
+        }
     }
 
     if (treeRef->isDeletePending)
@@ -3128,6 +5137,9 @@ le_sls_List_t* tdb_GetRequestQueue
 /**
  *  Merge a shadow tree into the original tree it was created from.  Once the change is merged the
  *  updated tree is serialized to the filesystem.
+ *
+ *  The change handlers of clients are not called from here, but from the event loop, after the
+ *  caller has had the chance to acknowledge the commit.
  */
 // -------------------------------------------------------------------------------------------------
 void tdb_MergeTree
@@ -3144,7 +5156,10 @@ void tdb_MergeTree
     InternalMergeTree(shadowTreeRef->originalTreeRef->name, pathRef, nodeRef, false);
     le_pathIter_Delete(pathRef);
 
-    // Now, go through and call the triggered callbacks.
+    shadowTreeRef->originalTreeRef->changeRevision = NextChangeRevision();
+
+    // Now, go through and call the triggered callbacks.  Clients are notified once the commit has
+    // been acknowledged.
     FireTriggeredCallbacks();
 
     // Now increment revision of the tree and open a tree file for writing.
@@ -3182,7 +5197,8 @@ void tdb_MergeTree
     }
 
     // We have a tree file to write to, so stream the new tree to it then close the output file.
-    le_result_t writeResult = tdb_WriteTreeNode(originalTreeRef->rootNodeRef, fileRef);
+    // Tree files are snapshots, which load faster than text.
+    le_result_t writeResult = tdb_WriteTreeSnapshot(originalTreeRef->rootNodeRef, fileRef);
     int retVal = -1;
 
     do
@@ -3242,10 +5258,11 @@ void tdb_ReleaseTree
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Read a configuration tree node's contents from the file system.
+ *  Read a configuration tree node's contents from the file system.  The file can either be text or
+ *  a snapshot.
  *
- *  @note On exit the descriptor's file pointer will be at EOF.  If the function fails, then the
- *        file pointer will be somewhere in the middle of the file.
+ *  @note On exit the descriptor's file pointer will be at EOF, for a text file.  If the function
+ *        fails, then the file pointer will be somewhere in the middle of the file.
  *
  *  @return True if the read is successful, or false if not.
  */
@@ -3264,40 +5281,66 @@ bool tdb_ReadTreeNode
     tdb_SetEmpty(nodeRef);
     tdb_EnsureExists(nodeRef);
 
-    // Convert to a C style file pointer.
-    FILE* filePtr = OpenFilePtr(descriptor, "r");
+    // Compute starting point, how big is the path so far??
+    // Must already be less than, LE_CFG_STR_LEN.
+    size_t pathLen = ComputePathLength(nodeRef);
 
-    if (filePtr == NULL)
+    if (pathLen >= LE_CFG_STR_LEN)
     {
         return false;
     }
 
-    // Ok read the specified node from the file object.  If the read fails, report it and clear out
-    // the node.  We shouldn't be leaving the node in a half initialized state.
+    // Ok read the specified node from the file.  If the read fails, report it and clear out the
+    // node.  We shouldn't be leaving the node in a half initialized state.
     bool result = true;
 
-    // Compute starting point, how big is the path so far??
-    // Must already be less than, LE_CFG_STR_LEN.
-    size_t pathLen = ComputePathLength(nodeRef);
+    // A snapshot is read straight from a mapping of the file.
+    size_t snapshotSize = 0;
+    void* snapshotPtr = MapSnapshot(descriptor, &snapshotSize);
 
-    if (pathLen >= LE_CFG_STR_LEN)
-    {
-        result = false;
-    }
-    else
+    if (snapshotPtr != NULL)
     {
-        if (InternalReadNode(nodeRef, filePtr, pathLen) != LE_OK)
+        SnapshotCursor_t cursor =
+            {
+                .dataPtr = (const uint8_t*)snapshotPtr + SNAPSHOT_MAGIC_BYTES,
+                .remaining = snapshotSize - SNAPSHOT_MAGIC_BYTES
+            };
+
+        if (InternalReadSnapshotNode(nodeRef, &cursor, pathLen) != LE_OK)
         {
             tdb_SetEmpty(nodeRef);
             result = false;
         }
-
-        // Make sure that there aren't any unexpected tokens left in the file.
-        if (SkipWhiteSpace(filePtr) != LE_OUT_OF_RANGE)
+        else if (cursor.remaining != 0)
         {
-            LE_ERROR("Unexpected token in file.");
+            LE_ERROR("Unexpected data at the end of the snapshot.");
             result = false;
         }
+
+        munmap(snapshotPtr, snapshotSize);
+
+        return result;
+    }
+
+    // Text is read through a C style file pointer.
+    FILE* filePtr = OpenFilePtr(descriptor, "r");
+
+    if (filePtr == NULL)
+    {
+        return false;
+    }
+
+    if (InternalReadNode(nodeRef, filePtr, pathLen) != LE_OK)
+    {
+        tdb_SetEmpty(nodeRef);
+        result = false;
+    }
+
+    // Make sure that there aren't any unexpected tokens left in the file.
+    if (SkipWhiteSpace(filePtr) != LE_OUT_OF_RANGE)
+    {
+        LE_ERROR("Unexpected token in file.");
+        result = false;
     }
 
     // Finally close our file object and return the result.
@@ -3341,6 +5384,142 @@ le_result_t tdb_WriteTreeNode
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children to a file in the filesystem, as a snapshot.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+le_result_t tdb_WriteTreeSnapshot
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] Write the contents of this node to a file descriptor.
+    int descriptor          ///< [IN] The file descriptor to write to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Go from a file descriptor to a C style file pointer.
+    FILE* filePtr = OpenFilePtr(descriptor, "w");
+
+    if (filePtr == NULL)
+    {
+        return LE_IO_ERROR;
+    }
+
+    // Write the data, then close up the file.
+    le_result_t result = WriteFile(filePtr, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_BYTES);
+
+    if (result == LE_OK)
+    {
+        result = InternalWriteSnapshotNode(nodeRef, filePtr);
+    }
+
+    CloseFilePtr(filePtr);
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Merge the contents of a JSON document into a configuration tree node.
+ *
+ *  The whole document is read and checked before any of it is merged, so a malformed document
+ *  leaves the node as it was.
+ *
+ *  @return LE_OK if the read is successful.
+ *          LE_FORMAT_ERROR if the document could not be read or parsed.
+ *          LE_NOT_POSSIBLE if the document conflicts with the existing contents of the node.
+ */
+// -------------------------------------------------------------------------------------------------
+le_result_t tdb_ReadTreeNodeJson
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node to merge the new data into.
+    int descriptor          ///< [IN] The file to read from.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(nodeRef != NULL);
+    LE_ASSERT(descriptor != -1);
+
+    size_t pathLen = ComputePathLength(nodeRef);
+
+    if (pathLen >= LE_CFG_STR_LEN)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    FILE* filePtr = OpenFilePtr(descriptor, "r");
+
+    if (filePtr == NULL)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    // Read the document into a node of its own, outside of any tree, then merge that in.
+    tdb_NodeRef_t importRef = NewNode();
+    le_result_t result = LE_FORMAT_ERROR;
+    size_t childPathLen = 0;
+
+    if (InternalReadJsonNode(importRef, filePtr, 0, &childPathLen) != LE_OK)
+    {
+        LE_ERROR("Failed to read JSON document, at offset %ld.", ftell(filePtr));
+    }
+    else if (pathLen + childPathLen > LE_CFG_STR_LEN)
+    {
+        LE_ERROR("Paths in JSON document are too long, by %zu bytes.",
+                 pathLen + childPathLen - LE_CFG_STR_LEN);
+    }
+    else if (PeekJsonChar(filePtr) != EOF)
+    {
+        LE_ERROR("Unexpected data at the end of JSON document.");
+    }
+    else
+    {
+        result = MergeJsonNode(nodeRef, importRef);
+    }
+
+    le_mem_Release(importRef);
+    CloseFilePtr(filePtr);
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children to a file, as a JSON document.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+le_result_t tdb_WriteTreeNodeJson
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] Write the contents of this node to a file descriptor.
+    int descriptor          ///< [IN] The file descriptor to write to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    FILE* filePtr = OpenFilePtr(descriptor, "w");
+
+    if (filePtr == NULL)
+    {
+        return LE_IO_ERROR;
+    }
+
+    le_result_t result = InternalWriteJsonNode(nodeRef, filePtr);
+    CloseFilePtr(filePtr);
+
+    return result;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Given a base node and a path, find another node in the tree.
@@ -3544,14 +5723,11 @@ le_result_t tdb_SetNodeName
 {
     LE_ASSERT(nodeRef != NULL);
 
-    if (   (stringPtr == NULL)
-        || (strcmp(stringPtr, "") == 0)
-        || (strcmp(stringPtr, ".") == 0)
-        || (strcmp(stringPtr, "..") == 0)
-        || (strchr(stringPtr, '/') != NULL)
-        || (strchr(stringPtr, ':') != NULL))
+    le_result_t result = CheckNodeName(stringPtr);
+
+    if (result != LE_OK)
     {
-        return LE_FORMAT_ERROR;
+        return result;
     }
 
     // You can't change the name of the root node.
@@ -3560,11 +5736,6 @@ le_result_t tdb_SetNodeName
         return LE_FORMAT_ERROR;
     }
 
-    if (strlen(stringPtr) > LE_CFG_NAME_LEN)
-    {
-        return LE_OVERFLOW;
-    }
-
     // Check for a duplicate name in this collection.
     if (   (nodeRef->parentRef != NULL)
         && (NodeExists(nodeRef->parentRef, stringPtr) == true))
@@ -4252,17 +6423,17 @@ void tdb_SetValueAsFloat
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Registers a handler function to be called when a node at or below a given path changes.
+ *  Create a handler object, attached to the registration object for the given path.  The caller
+ *  sets the function to call back.
  *
- *  @return A new safe ref backed object, or NULL if the creation failed.
+ *  @return The new handler object, or NULL if the creation failed.
  */
 //--------------------------------------------------------------------------------------------------
-le_cfg_ChangeHandlerRef_t tdb_AddChangeHandler
+static Handler_t* NewHandler
 (
     tdb_TreeRef_t treeRef,                  ///< [IN] The tree to register the handler on.
     le_msg_SessionRef_t sessionRef,         ///< [IN] The session that the request came in on.
     const char* pathPtr,                    ///< [IN] Path of the node to watch.
-    le_cfg_ChangeHandlerFunc_t handlerPtr,  ///< [IN] Function to call back.
     void* contextPtr                        ///< [IN] Opaque value to pass to the function when
                                             ///<      called.
 )
@@ -4311,6 +6482,11 @@ le_cfg_ChangeHandlerRef_t tdb_AddChangeHandler
         foundRegistrationPtr = le_mem_ForceAlloc(RegistrationPool);
 
         foundRegistrationPtr->triggered = false;
+        foundRegistrationPtr->pending = false;
+        foundRegistrationPtr->triggeredLink = LE_DLS_LINK_INIT;
+        foundRegistrationPtr->pendingLink = LE_DLS_LINK_INIT;
+        foundRegistrationPtr->pathsHandlerCount = 0;
+        foundRegistrationPtr->changedPaths[0] = '\0';
 
         foundRegistrationPtr->handlerList = LE_DLS_LIST_INIT;
         le_utf8_Copy(foundRegistrationPtr->registrationPath,
@@ -4328,14 +6504,15 @@ le_cfg_ChangeHandlerRef_t tdb_AddChangeHandler
 
     handlerObjectPtr->link = LE_DLS_LINK_INIT;
     handlerObjectPtr->sessionRef = sessionRef;
-    handlerObjectPtr->handlerPtr = handlerPtr;
+    handlerObjectPtr->handlerPtr = NULL;
+    handlerObjectPtr->pathsHandlerPtr = NULL;
     handlerObjectPtr->contextPtr = contextPtr;
     handlerObjectPtr->registrationPtr = foundRegistrationPtr;
     handlerObjectPtr->safeRef = le_ref_CreateRef(HandlerSafeRefMap, handlerObjectPtr);
 
     le_dls_Queue(&foundRegistrationPtr->handlerList, &handlerObjectPtr->link);
 
-    return handlerObjectPtr->safeRef;
+    return handlerObjectPtr;
 }
 
 
@@ -4343,13 +6520,14 @@ le_cfg_ChangeHandlerRef_t tdb_AddChangeHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Deregisters a handler function that was registered using tdb_AddChangeHandler().
+ *  Deregisters a handler object, if it belongs to the given session and is of the expected kind.
  */
 //--------------------------------------------------------------------------------------------------
-void tdb_RemoveChangeHandler
+static void DeleteHandler
 (
-    le_cfg_ChangeHandlerRef_t handlerRef,  ///< [IN] Reference returned by tdb_AddChangeHandler().
-    le_msg_SessionRef_t sessionRef         ///< [IN] The session of the user making this request.
+    void* handlerRef,                ///< [IN] Reference to the handler object.
+    le_msg_SessionRef_t sessionRef,  ///< [IN] The session of the user making this request.
+    bool wantsPaths                  ///< [IN] Is the handler expected to want the changed paths?
 )
 //--------------------------------------------------------------------------------------------------
 {
@@ -4358,7 +6536,8 @@ void tdb_RemoveChangeHandler
     Handler_t* handlerObjectPtr = le_ref_Lookup(HandlerSafeRefMap, handlerRef);
 
     if (   (handlerObjectPtr != NULL)
-        && (handlerObjectPtr->sessionRef == sessionRef))
+        && (handlerObjectPtr->sessionRef == sessionRef)
+        && ((handlerObjectPtr->pathsHandlerPtr != NULL) == wantsPaths))
     {
         Registration_t* registrationPtr = handlerObjectPtr->registrationPtr;
 
@@ -4368,8 +6547,7 @@ void tdb_RemoveChangeHandler
         // If there are no more handlers in this registration object, kill the object.
         if (le_dls_IsEmpty(&registrationPtr->handlerList))
         {
-            le_hashmap_Remove(HandlerRegistrationMap, registrationPtr->registrationPath);
-            le_mem_Release(registrationPtr);
+            ReleaseRegistration(registrationPtr);
         }
     }
 }
@@ -4377,6 +6555,116 @@ void tdb_RemoveChangeHandler
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Registers a handler function to be called when a node at or below a given path changes.
+ *
+ *  @return A new safe ref backed object, or NULL if the creation failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_cfg_ChangeHandlerRef_t tdb_AddChangeHandler
+(
+    tdb_TreeRef_t treeRef,                  ///< [IN] The tree to register the handler on.
+    le_msg_SessionRef_t sessionRef,         ///< [IN] The session that the request came in on.
+    const char* pathPtr,                    ///< [IN] Path of the node to watch.
+    le_cfg_ChangeHandlerFunc_t handlerPtr,  ///< [IN] Function to call back.
+    void* contextPtr                        ///< [IN] Opaque value to pass to the function when
+                                            ///<      called.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Handler_t* handlerObjectPtr = NewHandler(treeRef, sessionRef, pathPtr, contextPtr);
+
+    if (handlerObjectPtr == NULL)
+    {
+        return NULL;
+    }
+
+    handlerObjectPtr->handlerPtr = handlerPtr;
+
+    return handlerObjectPtr->safeRef;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Registers a handler function to be called, with the paths of the nodes that changed, when a
+ *  node at or below a given path changes.  Only clients can register such handlers.
+ *
+ *  @return A new safe ref backed object, or NULL if the creation failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_cfg_ChangedPathsHandlerRef_t tdb_AddChangedPathsHandler
+(
+    tdb_TreeRef_t treeRef,                        ///< [IN] The tree to register the handler on.
+    le_msg_SessionRef_t sessionRef,               ///< [IN] The session that the request came in
+                                                  ///<      on.
+    const char* pathPtr,                          ///< [IN] Path of the node to watch.
+    le_cfg_ChangedPathsHandlerFunc_t handlerPtr,  ///< [IN] Function to call back.
+    void* contextPtr                              ///< [IN] Opaque value to pass to the function
+                                                  ///<      when called.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(sessionRef != NULL);
+
+    Handler_t* handlerObjectPtr = NewHandler(treeRef, sessionRef, pathPtr, contextPtr);
+
+    if (handlerObjectPtr == NULL)
+    {
+        return NULL;
+    }
+
+    handlerObjectPtr->pathsHandlerPtr = handlerPtr;
+    handlerObjectPtr->registrationPtr->pathsHandlerCount++;
+    PathsHandlerCount++;
+
+    return (le_cfg_ChangedPathsHandlerRef_t)handlerObjectPtr->safeRef;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Deregisters a handler function that was registered using tdb_AddChangeHandler().
+ */
+//--------------------------------------------------------------------------------------------------
+void tdb_RemoveChangeHandler
+(
+    le_cfg_ChangeHandlerRef_t handlerRef,  ///< [IN] Reference returned by tdb_AddChangeHandler().
+    le_msg_SessionRef_t sessionRef         ///< [IN] The session of the user making this request.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DeleteHandler(handlerRef, sessionRef, false);
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Deregisters a handler function that was registered using tdb_AddChangedPathsHandler().
+ */
+//--------------------------------------------------------------------------------------------------
+void tdb_RemoveChangedPathsHandler
+(
+    le_cfg_ChangedPathsHandlerRef_t handlerRef,  ///< [IN] Reference returned by
+                                                 ///<      tdb_AddChangedPathsHandler().
+    le_msg_SessionRef_t sessionRef               ///< [IN] The session of the user making this
+                                                 ///<      request.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    DeleteHandler(handlerRef, sessionRef, true);
+}
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Clean out any event handlers registered on the given session.
@@ -4402,7 +6690,6 @@ void tdb_CleanUpHandlers
     {
         Registration_t* registrationPtr = CONTAINER_OF(linkPtr, Registration_t, link);
 
-        le_hashmap_Remove(HandlerRegistrationMap, registrationPtr->registrationPath);
-        le_mem_Release(registrationPtr);
+        ReleaseRegistration(registrationPtr);
     }
 }
@@ -121,6 +121,57 @@ tdb_TreeRef_t tdb_ShadowTree
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Freeze the current contents of a tree into a version of it.  The readers of the tree are moved
+ *  to the version with tdb_MoveReader(), and keep reading it while the tree changes.  The version
+ *  is freed once they are all done with it.
+ *
+ *  @return The new version.  The caller holds a reference to it, that it releases with
+ *          tdb_ReleaseTree() once it has moved the readers.
+ */
+// -------------------------------------------------------------------------------------------------
+tdb_TreeRef_t tdb_CreateVersion
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to freeze, or a shadow of it.
+);
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Move the registration of a read iterator from a tree to a version of the tree.  The iterator
+ *  must then read the version's nodes instead of the tree's.
+ *
+ *  @return True if the iterator was on the version's tree and has been moved.  False if it's on
+ *          another tree, or on a version, and has been left alone.
+ */
+// -------------------------------------------------------------------------------------------------
+bool tdb_MoveReader
+(
+    tdb_TreeRef_t treeRef,    ///< [IN] The tree the reader is on.
+    tdb_TreeRef_t versionRef  ///< [IN] The version to move the reader to.
+);
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get the change revision of a tree, which changes every time changes are merged into the tree.
+ *
+ *  @return The tree's change revision.
+ */
+// -------------------------------------------------------------------------------------------------
+uint32_t tdb_GetChangeRevision
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree object to read.
+);
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Called to create a new tree that shadows an existing one.
@@ -229,6 +280,9 @@ le_sls_List_t* tdb_GetRequestQueue
 /**
  *  Merge a shadow tree into the original tree it was created from.  Once the change is merged the
  *  updated tree is serialized to the filesystem.
+ *
+ *  The change handlers of clients are not called from here, but from the event loop, after the
+ *  caller has had the chance to acknowledge the commit.
  */
 // -------------------------------------------------------------------------------------------------
 void tdb_MergeTree
@@ -254,10 +308,11 @@ void tdb_ReleaseTree
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Read a configuration tree node's contents from the file system.
+ *  Read a configuration tree node's contents from the file system.  The file can either be text or
+ *  a snapshot.
  *
- *  @note On exit the descriptor's file pointer will be at EOF.  If the function fails, then the
- *        file pointer will be somewhere in the middle of the file.
+ *  @note On exit the descriptor's file pointer will be at EOF, for a text file.  If the function
+ *        fails, then the file pointer will be somewhere in the middle of the file.
  *
  *  @return True if the read is successful, or false if not.
  */
@@ -287,6 +342,59 @@ le_result_t tdb_WriteTreeNode
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children to a file in the filesystem, as a snapshot.  Snapshots
+ *  load faster than text, but are only meant to be read back by tdb_ReadTreeNode().
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+le_result_t tdb_WriteTreeSnapshot
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] Write the contents of this node to a file descriptor.
+    int descriptor          ///< [IN] The file descriptor to write to.
+);
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Merge the contents of a JSON document, in the format of the config tool, into a configuration
+ *  tree node.
+ *
+ *  @return LE_OK if the read is successful.
+ *          LE_FORMAT_ERROR if the document could not be read or parsed.
+ *          LE_NOT_POSSIBLE if the document conflicts with the existing contents of the node.
+ */
+// -------------------------------------------------------------------------------------------------
+le_result_t tdb_ReadTreeNodeJson
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] The node to merge the new data into.
+    int descriptor          ///< [IN] The file to read from.
+);
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children to a file, as a JSON document in the format of the
+ *  config tool.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+le_result_t tdb_WriteTreeNodeJson
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] Write the contents of this node to a file descriptor.
+    int descriptor          ///< [IN] The file descriptor to write to.
+);
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Given a base node and a path, find another node in the tree.
@@ -656,6 +764,28 @@ le_cfg_ChangeHandlerRef_t tdb_AddChangeHandler
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Registers a handler function to be called, with the paths of the nodes that changed, when a
+ *  node at or below a given path changes.  Only clients can register such handlers.
+ *
+ *  @return A new safe ref backed object, or NULL if the creation failed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_cfg_ChangedPathsHandlerRef_t tdb_AddChangedPathsHandler
+(
+    tdb_TreeRef_t treeRef,                        ///< [IN] The tree to register the handler on.
+    le_msg_SessionRef_t sessionRef,               ///< [IN] The session that the request came in
+                                                  ///<      on.
+    const char* pathPtr,                          ///< [IN] Path of the node to watch.
+    le_cfg_ChangedPathsHandlerFunc_t handlerPtr,  ///< [IN] Function to call back.
+    void* contextPtr                              ///< [IN] Opaque value to pass to the function
+                                                  ///<      when called.
+);
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Deregisters a handler function that was registered using tdb_AddChangeHandler().
@@ -670,6 +800,22 @@ void tdb_RemoveChangeHandler
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Deregisters a handler function that was registered using tdb_AddChangedPathsHandler().
+ */
+//--------------------------------------------------------------------------------------------------
+void tdb_RemoveChangedPathsHandler
+(
+    le_cfg_ChangedPathsHandlerRef_t handlerRef,  ///< [IN] Reference returned by
+                                                 ///<      tdb_AddChangedPathsHandler().
+    le_msg_SessionRef_t sessionRef               ///< [IN] The session of the user making this
+                                                 ///<      request.
+);
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Clean out any event handlers registered on the given session.
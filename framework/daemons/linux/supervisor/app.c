@@ -4055,6 +4055,52 @@ void app_SetBlockCallback
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the system calls that stop each app process when it is traced.  This only applies to the
+ * processes blocked on startup for a block callback.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_IMPLEMENTED if system call filters are not supported on this system.
+ *      LE_OVERFLOW if there are too many system calls.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t app_SetTraceSysCalls
+(
+    app_Ref_t appRef,                           ///< [IN] App reference.
+    const int32_t* sysCallsPtr,                 ///< [IN] System call numbers.
+    size_t numSysCalls                          ///< [IN] Number of system calls.  0 to stop on
+                                                ///       every system call.
+)
+{
+    le_dls_List_t* procListPtrs[] = { &(appRef->procs), &(appRef->auxProcs) };
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(procListPtrs); i++)
+    {
+        le_dls_Link_t* procLinkPtr = le_dls_Peek(procListPtrs[i]);
+
+        while (procLinkPtr != NULL)
+        {
+            ProcContainer_t* procContainerPtr = CONTAINER_OF(procLinkPtr, ProcContainer_t, link);
+
+            le_result_t result = proc_SetTraceSysCalls(procContainerPtr->procRef,
+                                                       sysCallsPtr,
+                                                       numSysCalls);
+            if (result != LE_OK)
+            {
+                return result;
+            }
+
+            procLinkPtr = le_dls_PeekNext(procListPtrs[i], procLinkPtr);
+        }
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Unblocks a process that was blocked on startup.
@@ -659,6 +659,26 @@ void app_SetBlockCallback
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the system calls that stop each app process when it is traced.  This only applies to the
+ * processes blocked on startup for a block callback.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_IMPLEMENTED if system call filters are not supported on this system.
+ *      LE_OVERFLOW if there are too many system calls.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t app_SetTraceSysCalls
+(
+    app_Ref_t appRef,                           ///< [IN] App reference.
+    const int32_t* sysCallsPtr,                 ///< [IN] System call numbers.
+    size_t numSysCalls                          ///< [IN] Number of system calls.  0 to stop on
+                                                ///       every system call.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Unblocks a process that was blocked on startup.
@@ -1157,6 +1157,7 @@ static void ReleaseAppRef
     app_SetRunForAllProcs(appContainerPtr->appRef, true);
     app_RemoveAllLinks(appContainerPtr->appRef);
     app_SetBlockCallback(appContainerPtr->appRef, NULL, NULL);
+    app_SetTraceSysCalls(appContainerPtr->appRef, NULL, 0);
 
     // Remove the safe ref.
     le_ref_DeleteRef(AppMap, appSafeRef);
@@ -1933,6 +1934,7 @@ void le_appCtrl_RemoveTraceAttachHandler
         le_ref_DeleteRef(AppAttachHandlerMap, addHandlerRef);
 
         app_SetBlockCallback(appContainerPtr->appRef, NULL, NULL);
+        app_SetTraceSysCalls(appContainerPtr->appRef, NULL, 0);
         appContainerPtr->traceAttachHandler = NULL;
         appContainerPtr->traceAttachContextPtr = NULL;
     }
@@ -1969,6 +1971,47 @@ void le_appCtrl_TraceUnblock
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the system calls that stop the app's processes when they are traced.  The processes install
+ * a seccomp filter stopping them on these system calls only, when they are unblocked.
+ *
+ * @note If the caller is passing an invalid reference to the application, it is a fatal error,
+ *       the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_appCtrl_SetTraceSysCalls
+(
+    le_appCtrl_ServerCmdRef_t _cmdRef,
+    le_appCtrl_AppRef_t appRef,
+    const int32_t* sysCallsPtr,
+    size_t sysCallsSize
+)
+{
+    AppContainer_t* appContainerPtr = le_ref_Lookup(AppMap, appRef);
+
+    if (appContainerPtr == NULL)
+    {
+        LE_KILL_CLIENT("Invalid application reference.");
+        return;
+    }
+
+    le_result_t result = app_SetTraceSysCalls(appContainerPtr->appRef, sysCallsPtr, sysCallsSize);
+
+    if (result != LE_OK)
+    {
+        LE_ERROR("Could not set the traced system calls of app '%s'.  %s.",
+                 app_GetName(appContainerPtr->appRef),
+                 LE_RESULT_TXT(result));
+
+        // Don't leave some of the processes filtered.
+        app_SetTraceSysCalls(appContainerPtr->appRef, NULL, 0);
+    }
+
+    le_appCtrl_SetTraceSysCallsRespond(_cmdRef, result);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Starts an app.  This function is called by the event loop when a separate process requests to
@@ -0,0 +1,1119 @@
+//--------------------------------------------------------------------------------------------------
+/** @file supervisor/debugData.c
+ *
+ * Captures the system log and core files of processes that fault.
+ *
+ * Each capture reads the system log from logread into a bounded ring buffer, so that only the end
+ * of the log is kept, and writes it to the log directory along with the faulted process's latest
+ * core file.  Older core files of the process are deleted.  The log directory is then rotated,
+ * keeping only the most recent files of each kind within a total size limit.
+ *
+ * On targets that build with LEGATO_FEATURE_COMPRESSED_CAPTURES, the captured files are gzip
+ * compressed, which needs zlib.  On other targets they are written as they are.
+ *
+ * Captures are done one at a time by a child process, so that the Supervisor can restart the
+ * process without waiting for them while staying single-threaded.  They are rate limited so that a
+ * crash looping app doesn't keep the CPU and the file system busy.  When the system is going to be
+ * rebooted, the capture is done right away into flash, after backing up the previous captures from
+ * RAM.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "debugData.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include "wait.h"
+#include <dirent.h>
+#include <spawn.h>
+
+#ifdef LEGATO_FEATURE_COMPRESSED_CAPTURES
+#include <zlib.h>
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory the captures are saved in.  It's on the RAM file system to spare the flash.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RAM_LOG_DIR                 "/tmp/legato_logs"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory the captures are saved in when the system is going to be rebooted, so that they
+ * survive the reboot.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FLASH_LOG_DIR               "/mnt/flash/legato_logs"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Program that dumps the system log to its standard output.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_READER_PATH             "/sbin/logread"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory holding the apps' writeable files, where their core files are dumped.  The
+ * framework's core files are dumped in the root directory.
+ */
+//--------------------------------------------------------------------------------------------------
+#define APPS_WRITEABLE_DIR          "/legato/systems/current/appsWriteable"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of system log snapshots, and of core files, kept in a log directory.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_FILES_PER_KIND          4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum total size of the files in a log directory.  The latest system log snapshot and core
+ * file are always kept, even if they are larger than this.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_LOG_DIR_BYTES           (4 * 1024 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the ring buffer holding the end of the system log.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_RING_BYTES              (128 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer used to copy and capture files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define COPY_BUFFER_BYTES           (32 * 1024)
+
+
+#ifdef LEGATO_FEATURE_COMPRESSED_CAPTURES
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mode the compressed files are opened with.  Compression is kept fast, since captures are
+ * usually done while an app is crash looping.
+ */
+//--------------------------------------------------------------------------------------------------
+#define GZ_WRITE_MODE               "wb1"
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A captured file being written, the value it has when it could not be opened, and the suffix of
+ * the captured files' names.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifdef LEGATO_FEATURE_COMPRESSED_CAPTURES
+typedef gzFile CaptureFile_t;
+#define NO_CAPTURE_FILE             NULL
+#define CAPTURE_SUFFIX              ".gz"
+#else
+typedef int CaptureFile_t;
+#define NO_CAPTURE_FILE             -1
+#define CAPTURE_SUFFIX              ""
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * At most CAPTURE_LIMIT_COUNT captures are done in CAPTURE_LIMIT_INTERVAL seconds.  Faults that
+ * happen beyond that are not captured.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CAPTURE_LIMIT_COUNT         4
+#define CAPTURE_LIMIT_INTERVAL      60
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Capture requests.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char appName[LIMIT_MAX_APP_NAME_BYTES];         ///< Name of the app, or "framework".
+    char procName[LIMIT_MAX_PROCESS_NAME_BYTES];    ///< Name of the process that faulted.
+    time_t faultTime;                               ///< Time of the fault, in the file names.
+    le_sls_Link_t link;                             ///< Link in the list of pending captures.
+}
+CaptureRequest_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Files found in a log directory when rotating it.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const char* namePtr;        ///< Name of the file.
+    struct timespec modTime;    ///< Time of last modification.
+    off_t size;                 ///< Size in bytes.
+    bool isCore;                ///< true if it's a core file, false if it's a system log snapshot.
+}
+LogFile_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of capture requests.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t CaptureRequestPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Background captures waiting for the current one to finish.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sls_List_t PendingCaptures = LE_SLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pid of the child process doing the current background capture, or -1 if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static pid_t CapturePid = -1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring buffer holding the end of the system log.
+ */
+//--------------------------------------------------------------------------------------------------
+static char LogRing[LOG_RING_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer used to copy and capture files.
+ */
+//--------------------------------------------------------------------------------------------------
+static char CopyBuffer[COPY_BUFFER_BYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Times of the most recent background captures, in seconds of relative time, and where the next
+ * one goes.
+ */
+//--------------------------------------------------------------------------------------------------
+static time_t RecentCaptureTimes[CAPTURE_LIMIT_COUNT];
+static size_t RecentCaptureCount = 0;
+static size_t NextCaptureIndex = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of faults that were not captured because of the rate limit.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t DroppedCaptureCount = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Formats a path into a buffer.
+ *
+ * @return LE_OK if successful, LE_OVERFLOW if the buffer is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FormatPath
+(
+    char* bufPtr,                   ///< [OUT] Buffer for the path.
+    size_t bufSize,                 ///< [IN] Size of the buffer.
+    const char* formatPtr,          ///< [IN] Format of the path.
+    ...
+)
+{
+    va_list args;
+
+    va_start(args, formatPtr);
+    int n = vsnprintf(bufPtr, bufSize, formatPtr, args);
+    va_end(args);
+
+    if ( (n < 0) || (n >= bufSize) )
+    {
+        LE_ERROR("Path '%s...' is too long.", bufPtr);
+        return LE_OVERFLOW;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a captured file.
+ *
+ * @return The file, or NO_CAPTURE_FILE on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static CaptureFile_t OpenCapture
+(
+    const char* pathPtr             ///< [IN] Path of the file.
+)
+{
+#ifdef LEGATO_FEATURE_COMPRESSED_CAPTURES
+    CaptureFile_t file = gzopen(pathPtr, GZ_WRITE_MODE);
+#else
+    CaptureFile_t file = open(pathPtr, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                              S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+#endif
+
+    if (file == NO_CAPTURE_FILE)
+    {
+        LE_ERROR("Could not open '%s'. %m.", pathPtr);
+    }
+
+    return file;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes data to a captured file.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteCapture
+(
+    CaptureFile_t file,             ///< [IN] Captured file.
+    const char* pathPtr,            ///< [IN] Path of the file, for error messages.
+    const void* bufPtr,             ///< [IN] Data to write.
+    size_t size                     ///< [IN] Number of bytes to write.
+)
+{
+    if (size == 0)
+    {
+        return LE_OK;
+    }
+
+#ifdef LEGATO_FEATURE_COMPRESSED_CAPTURES
+    if (gzwrite(file, bufPtr, size) != (int)size)
+    {
+        int errNum;
+        LE_ERROR("Could not write to '%s': %s.", pathPtr, gzerror(file, &errNum));
+        return LE_FAULT;
+    }
+#else
+    if (fd_WriteSize(file, (void*)bufPtr, size) != (ssize_t)size)
+    {
+        LE_ERROR("Could not write to '%s'. %m.", pathPtr);
+        return LE_FAULT;
+    }
+#endif
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes a captured file, and deletes it if writing it failed.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CloseCapture
+(
+    CaptureFile_t file,             ///< [IN] Captured file.
+    const char* pathPtr,            ///< [IN] Path of the file.
+    le_result_t result              ///< [IN] Result of writing the file.
+)
+{
+#ifdef LEGATO_FEATURE_COMPRESSED_CAPTURES
+    if (gzclose(file) != Z_OK)
+    {
+        LE_ERROR("Could not write to '%s'.", pathPtr);
+        result = LE_FAULT;
+    }
+#else
+    if (close(file) != 0)
+    {
+        LE_ERROR("Could not write to '%s'. %m.", pathPtr);
+        result = LE_FAULT;
+    }
+#endif
+
+    if (result != LE_OK)
+    {
+        unlink(pathPtr);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts the log reader, with its standard output going to a pipe.
+ *
+ * @return The read end of the pipe, or -1 on error.
+ */
+//--------------------------------------------------------------------------------------------------
+static int StartLogReader
+(
+    pid_t* pidPtr                   ///< [OUT] Pid of the log reader.
+)
+{
+    int pipeFds[2];
+
+    if (pipe2(pipeFds, O_CLOEXEC) != 0)
+    {
+        LE_ERROR("Could not create pipe. %m.");
+        return -1;
+    }
+
+    // The Supervisor blocks signals, so give the log reader the default signal mask and
+    // dispositions.
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sigSet;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    sigemptyset(&sigSet);
+    posix_spawnattr_setsigmask(&attr, &sigSet);
+    sigaddset(&sigSet, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &sigSet);
+
+    char* const argv[] = { LOG_READER_PATH, NULL };
+    extern char** environ;
+
+    int r = posix_spawn(pidPtr, LOG_READER_PATH, &actions, &attr, argv, environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    fd_Close(pipeFds[1]);
+
+    if (r != 0)
+    {
+        LE_ERROR("Could not start '%s'. %s.", LOG_READER_PATH, strerror(r));
+        fd_Close(pipeFds[0]);
+        return -1;
+    }
+
+    return pipeFds[0];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves a snapshot of the end of the system log.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SaveLog
+(
+    const char* logDirPtr,                  ///< [IN] Directory to save the snapshot in.
+    const CaptureRequest_t* requestPtr      ///< [IN] The capture.
+)
+{
+    char path[LIMIT_MAX_PATH_BYTES];
+
+    if (FormatPath(path, sizeof(path), "%s/syslog-%s-%s-%ld" CAPTURE_SUFFIX, logDirPtr, requestPtr->appName,
+                   requestPtr->procName, (long)requestPtr->faultTime) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    pid_t pid;
+    int fd = StartLogReader(&pid);
+
+    if (fd < 0)
+    {
+        return LE_FAULT;
+    }
+
+    // Read the whole log, wrapping around the ring so that only its end is kept.
+    size_t ringPos = 0;
+    bool hasWrapped = false;
+    ssize_t n;
+
+    do
+    {
+        n = fd_ReadSize(fd, LogRing + ringPos, sizeof(LogRing) - ringPos);
+
+        if (n > 0)
+        {
+            ringPos += n;
+
+            if (ringPos == sizeof(LogRing))
+            {
+                ringPos = 0;
+                hasWrapped = true;
+            }
+        }
+    }
+    while (n > 0);
+
+    fd_Close(fd);
+
+    while ( (waitpid(pid, NULL, 0) < 0) && (errno == EINTR) );
+
+    if (n < 0)
+    {
+        LE_ERROR("Could not read the system log.");
+        return LE_FAULT;
+    }
+
+    CaptureFile_t file = OpenCapture(path);
+
+    if (file == NO_CAPTURE_FILE)
+    {
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_OK;
+
+    if (hasWrapped)
+    {
+        // The oldest data starts at the current position, with a partial line that is dropped.
+        const char* startPtr = memchr(LogRing + ringPos, '\n', sizeof(LogRing) - ringPos);
+        startPtr = (startPtr == NULL) ? LogRing + ringPos : startPtr + 1;
+
+        result = WriteCapture(file, path, startPtr, LogRing + sizeof(LogRing) - startPtr);
+    }
+
+    if (result == LE_OK)
+    {
+        result = WriteCapture(file, path, LogRing, ringPos);
+    }
+
+    return CloseCapture(file, path, result);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Captures a file.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CaptureFile
+(
+    const char* srcPathPtr,         ///< [IN] File to capture.
+    const char* destPathPtr         ///< [IN] Captured file to create.
+)
+{
+    int fd = open(srcPathPtr, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Could not open '%s'. %m.", srcPathPtr);
+        return LE_FAULT;
+    }
+
+    CaptureFile_t file = OpenCapture(destPathPtr);
+
+    if (file == NO_CAPTURE_FILE)
+    {
+        fd_Close(fd);
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_OK;
+    ssize_t n;
+
+    do
+    {
+        n = fd_ReadSize(fd, CopyBuffer, sizeof(CopyBuffer));
+
+        if (n < 0)
+        {
+            LE_ERROR("Could not read '%s'.", srcPathPtr);
+            result = LE_FAULT;
+        }
+        else
+        {
+            result = WriteCapture(file, destPathPtr, CopyBuffer, n);
+        }
+    }
+    while ( (n == sizeof(CopyBuffer)) && (result == LE_OK) );
+
+    fd_Close(fd);
+
+    return CloseCapture(file, destPathPtr, result);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves the latest core file of the faulted process, and deletes its core files.
+ *
+ * @return LE_OK if successful or if there are no core files, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SaveCore
+(
+    const char* logDirPtr,                  ///< [IN] Directory to save the core file in.
+    const CaptureRequest_t* requestPtr      ///< [IN] The capture.
+)
+{
+    char homeDir[LIMIT_MAX_PATH_BYTES];
+    char prefix[LIMIT_MAX_PROCESS_NAME_BYTES + 8];
+
+    if (strcmp(requestPtr->appName, "framework") == 0)
+    {
+        LE_ASSERT(le_utf8_Copy(homeDir, "/", sizeof(homeDir), NULL) == LE_OK);
+    }
+    else if (FormatPath(homeDir, sizeof(homeDir), "%s/%s",
+                        APPS_WRITEABLE_DIR, requestPtr->appName) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    LE_ASSERT(FormatPath(prefix, sizeof(prefix), "core-%s-", requestPtr->procName) == LE_OK);
+
+    DIR* dirPtr = opendir(homeDir);
+
+    if (dirPtr == NULL)
+    {
+        return (errno == ENOENT) ? LE_OK : LE_FAULT;
+    }
+
+    // Keep the latest core file, and delete the others as they are found.
+    char corePath[LIMIT_MAX_PATH_BYTES] = "";
+    time_t coreTime = 0;
+    size_t prefixLen = strlen(prefix);
+    struct dirent* entryPtr;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        char path[LIMIT_MAX_PATH_BYTES];
+        struct stat statBuf;
+
+        if ( (strncmp(entryPtr->d_name, prefix, prefixLen) != 0) ||
+             (FormatPath(path, sizeof(path), "%s/%s", homeDir, entryPtr->d_name) != LE_OK) ||
+             (lstat(path, &statBuf) != 0) ||
+             !S_ISREG(statBuf.st_mode) )
+        {
+            continue;
+        }
+
+        if ( (corePath[0] == '\0') || (statBuf.st_mtime > coreTime) )
+        {
+            if (corePath[0] != '\0')
+            {
+                unlink(corePath);
+            }
+
+            LE_ASSERT(le_utf8_Copy(corePath, path, sizeof(corePath), NULL) == LE_OK);
+            coreTime = statBuf.st_mtime;
+        }
+        else
+        {
+            unlink(path);
+        }
+    }
+
+    closedir(dirPtr);
+
+    if (corePath[0] == '\0')
+    {
+        return LE_OK;
+    }
+
+    char destPath[LIMIT_MAX_PATH_BYTES];
+
+    if ( (FormatPath(destPath, sizeof(destPath), "%s/core-%s-%s-%ld" CAPTURE_SUFFIX, logDirPtr,
+                     requestPtr->appName, requestPtr->procName,
+                     (long)requestPtr->faultTime) != LE_OK) ||
+         (CaptureFile(corePath, destPath) != LE_OK) )
+    {
+        return LE_FAULT;
+    }
+
+    unlink(corePath);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Selects the system log snapshots and core files when scanning a log directory.
+ */
+//--------------------------------------------------------------------------------------------------
+static int IsLogFile
+(
+    const struct dirent* entryPtr
+)
+{
+    return (strncmp(entryPtr->d_name, "core-", 5) == 0) ||
+           (strncmp(entryPtr->d_name, "syslog-", 7) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Orders log files from the newest to the oldest.
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareLogFiles
+(
+    const void* aPtr,
+    const void* bPtr
+)
+{
+    const LogFile_t* aFilePtr = aPtr;
+    const LogFile_t* bFilePtr = bPtr;
+
+    if (aFilePtr->modTime.tv_sec != bFilePtr->modTime.tv_sec)
+    {
+        return (aFilePtr->modTime.tv_sec > bFilePtr->modTime.tv_sec) ? -1 : 1;
+    }
+
+    if (aFilePtr->modTime.tv_nsec != bFilePtr->modTime.tv_nsec)
+    {
+        return (aFilePtr->modTime.tv_nsec > bFilePtr->modTime.tv_nsec) ? -1 : 1;
+    }
+
+    return strcmp(bFilePtr->namePtr, aFilePtr->namePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the oldest files of a log directory, keeping at most MAX_FILES_PER_KIND files of each
+ * kind, and MAX_LOG_DIR_BYTES in total.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RotateLogDir
+(
+    const char* logDirPtr           ///< [IN] The log directory.
+)
+{
+    struct dirent** entriesPtr;
+    int count = scandir(logDirPtr, &entriesPtr, IsLogFile, NULL);
+
+    if (count < 0)
+    {
+        LE_ERROR("Could not read directory '%s'. %m.", logDirPtr);
+        return;
+    }
+
+    LogFile_t* filesPtr = calloc(count ? count : 1, sizeof(LogFile_t));
+    LE_ASSERT(filesPtr != NULL);
+
+    size_t fileCount = 0;
+    int i;
+
+    for (i = 0; i < count; i++)
+    {
+        char path[LIMIT_MAX_PATH_BYTES];
+        struct stat statBuf;
+
+        if ( (FormatPath(path, sizeof(path), "%s/%s", logDirPtr, entriesPtr[i]->d_name) == LE_OK)
+             && (lstat(path, &statBuf) == 0) && S_ISREG(statBuf.st_mode) )
+        {
+            filesPtr[fileCount].namePtr = entriesPtr[i]->d_name;
+            filesPtr[fileCount].modTime = statBuf.st_mtim;
+            filesPtr[fileCount].size = statBuf.st_size;
+            filesPtr[fileCount].isCore = (entriesPtr[i]->d_name[0] == 'c');
+            fileCount++;
+        }
+    }
+
+    qsort(filesPtr, fileCount, sizeof(LogFile_t), CompareLogFiles);
+
+    size_t kindCounts[2] = { 0, 0 };
+    off_t totalSize = 0;
+    size_t j;
+
+    for (j = 0; j < fileCount; j++)
+    {
+        size_t kindCount = ++kindCounts[filesPtr[j].isCore];
+
+        // The newest file of each kind is always kept.
+        if ( (kindCount == 1) ||
+             ( (kindCount <= MAX_FILES_PER_KIND) &&
+               (totalSize + filesPtr[j].size <= MAX_LOG_DIR_BYTES) ) )
+        {
+            totalSize += filesPtr[j].size;
+            continue;
+        }
+
+        char path[LIMIT_MAX_PATH_BYTES];
+
+        if ( (FormatPath(path, sizeof(path), "%s/%s", logDirPtr, filesPtr[j].namePtr) == LE_OK)
+             && (unlink(path) != 0) )
+        {
+            LE_ERROR("Could not delete '%s'. %m.", path);
+        }
+    }
+
+    free(filesPtr);
+
+    for (i = 0; i < count; i++)
+    {
+        free(entriesPtr[i]);
+    }
+
+    free(entriesPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copies a file, keeping its modification time so that the copy is rotated like the original.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyFile
+(
+    const char* srcPathPtr,         ///< [IN] File to copy.
+    const char* destPathPtr         ///< [IN] Copy to create.
+)
+{
+    int srcFd = open(srcPathPtr, O_RDONLY | O_CLOEXEC);
+
+    if (srcFd < 0)
+    {
+        LE_ERROR("Could not open '%s'. %m.", srcPathPtr);
+        return LE_FAULT;
+    }
+
+    int destFd = open(destPathPtr, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    if (destFd < 0)
+    {
+        LE_ERROR("Could not create '%s'. %m.", destPathPtr);
+        fd_Close(srcFd);
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_OK;
+    ssize_t n;
+
+    do
+    {
+        n = fd_ReadSize(srcFd, CopyBuffer, sizeof(CopyBuffer));
+
+        if ( (n < 0) || (fd_WriteSize(destFd, CopyBuffer, n) != n) )
+        {
+            LE_ERROR("Could not copy '%s' to '%s'.", srcPathPtr, destPathPtr);
+            result = LE_FAULT;
+        }
+    }
+    while ( (n == sizeof(CopyBuffer)) && (result == LE_OK) );
+
+    struct stat statBuf;
+
+    if ( (result == LE_OK) && (fstat(srcFd, &statBuf) == 0) )
+    {
+        struct timespec times[2] = { statBuf.st_atim, statBuf.st_mtim };
+        futimens(destFd, times);
+    }
+
+    fd_Close(srcFd);
+    fd_Close(destFd);
+
+    if (result != LE_OK)
+    {
+        unlink(destPathPtr);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replaces the captures in flash by the ones in RAM, which would otherwise be lost on reboot.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BackupToFlash
+(
+    void
+)
+{
+    if ( (le_dir_RemoveRecursive(FLASH_LOG_DIR) != LE_OK) ||
+         (le_dir_MakePath(FLASH_LOG_DIR, S_IRWXU | S_IRWXG | S_IRWXO) != LE_OK) )
+    {
+        LE_ERROR("Could not clear directory '%s'.", FLASH_LOG_DIR);
+        return;
+    }
+
+    DIR* dirPtr = opendir(RAM_LOG_DIR);
+
+    if (dirPtr == NULL)
+    {
+        return;
+    }
+
+    struct dirent* entryPtr;
+
+    while ((entryPtr = readdir(dirPtr)) != NULL)
+    {
+        char srcPath[LIMIT_MAX_PATH_BYTES];
+        char destPath[LIMIT_MAX_PATH_BYTES];
+        struct stat statBuf;
+
+        if ( (FormatPath(srcPath, sizeof(srcPath), "%s/%s", RAM_LOG_DIR, entryPtr->d_name) == LE_OK)
+             && (FormatPath(destPath, sizeof(destPath), "%s/%s",
+                            FLASH_LOG_DIR, entryPtr->d_name) == LE_OK)
+             && (lstat(srcPath, &statBuf) == 0) && S_ISREG(statBuf.st_mode) )
+        {
+            CopyFile(srcPath, destPath);
+        }
+    }
+
+    closedir(dirPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Captures the system log and core file of a faulted process into a log directory.
+ *
+ * @return LE_OK if successful, LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t Capture
+(
+    const char* logDirPtr,                  ///< [IN] Directory to save the capture in.
+    const CaptureRequest_t* requestPtr      ///< [IN] The capture.
+)
+{
+    if (le_dir_MakePath(logDirPtr, S_IRWXU | S_IRWXG | S_IRWXO) != LE_OK)
+    {
+        LE_ERROR("Could not create directory '%s'.", logDirPtr);
+        return LE_FAULT;
+    }
+
+    le_result_t logResult = SaveLog(logDirPtr, requestPtr);
+    le_result_t coreResult = SaveCore(logDirPtr, requestPtr);
+
+    RotateLogDir(logDirPtr);
+
+    if ( (logResult != LE_OK) || (coreResult != LE_OK) )
+    {
+        LE_ERROR("Could not save log and core file of process '%s' of app '%s'.",
+                 requestPtr->procName, requestPtr->appName);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts a child process doing the next pending background capture, unless one is running.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartNextCapture
+(
+    void
+)
+{
+    le_sls_Link_t* linkPtr;
+
+    while ( (CapturePid == -1) && ((linkPtr = le_sls_Pop(&PendingCaptures)) != NULL) )
+    {
+        CaptureRequest_t* requestPtr = CONTAINER_OF(linkPtr, CaptureRequest_t, link);
+
+        pid_t pid = fork();
+
+        if (pid < 0)
+        {
+            LE_ERROR("Could not fork the capture process of process '%s' of app '%s'. %m.",
+                     requestPtr->procName, requestPtr->appName);
+        }
+        else if (pid == 0)
+        {
+            _exit(Capture(RAM_LOG_DIR, requestPtr) == LE_OK ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        else
+        {
+            CapturePid = pid;
+        }
+
+        le_mem_Release(requestPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Waits for the current background capture, if any, to finish.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WaitForCapture
+(
+    void
+)
+{
+    if (CapturePid != -1)
+    {
+        while ( (waitpid(CapturePid, NULL, 0) < 0) && (errno == EINTR) );
+
+        CapturePid = -1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether another background capture can be done now, and records it if so.
+ *
+ * @return true if it can, false if the rate limit is reached.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool TakeCaptureSlot
+(
+    void
+)
+{
+    time_t now = le_clk_GetRelativeTime().sec;
+
+    // The next slot holds the oldest of the most recent captures.
+    if ( (RecentCaptureCount == CAPTURE_LIMIT_COUNT) &&
+         (now - RecentCaptureTimes[NextCaptureIndex] < CAPTURE_LIMIT_INTERVAL) )
+    {
+        return false;
+    }
+
+    RecentCaptureTimes[NextCaptureIndex] = now;
+    NextCaptureIndex = (NextCaptureIndex + 1) % CAPTURE_LIMIT_COUNT;
+
+    if (RecentCaptureCount < CAPTURE_LIMIT_COUNT)
+    {
+        RecentCaptureCount++;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the debug data capture.  Must be called before the other functions of this API.
+ */
+//--------------------------------------------------------------------------------------------------
+void debugData_Init
+(
+    void
+)
+{
+    CaptureRequestPool = le_mem_CreatePool("DebugDataCaptures", sizeof(CaptureRequest_t));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Capture a snapshot of the system log and the process's latest core file, if any.
+ *
+ * Unless the system is going to be rebooted, the capture is done in the background and this
+ * function returns right away.  Captures that come too close together are dropped.
+ *
+ * If the system is going to be rebooted, the previous captures are backed up to flash and this
+ * capture is saved to flash before this function returns.
+ */
+//--------------------------------------------------------------------------------------------------
+void debugData_Capture
+(
+    const char* appNamePtr,         ///< [IN] Name of the app, or "framework".
+    const char* procNamePtr,        ///< [IN] Name of the process that faulted.
+    bool isRebooting                ///< [IN] Is the supervisor going to reboot the system?
+)
+{
+    if (!isRebooting && !TakeCaptureSlot())
+    {
+        DroppedCaptureCount++;
+        LE_WARN("Too many faults, not capturing debug data of process '%s' of app '%s' "
+                "(%zu faults not captured so far).", procNamePtr, appNamePtr, DroppedCaptureCount);
+        return;
+    }
+
+    CaptureRequest_t* requestPtr = le_mem_ForceAlloc(CaptureRequestPool);
+
+    if ( (le_utf8_Copy(requestPtr->appName, appNamePtr, sizeof(requestPtr->appName), NULL)
+          != LE_OK) ||
+         (le_utf8_Copy(requestPtr->procName, procNamePtr, sizeof(requestPtr->procName), NULL)
+          != LE_OK) )
+    {
+        LE_ERROR("App name '%s' or process name '%s' is too long.", appNamePtr, procNamePtr);
+        le_mem_Release(requestPtr);
+        return;
+    }
+
+    requestPtr->faultTime = time(NULL);
+    requestPtr->link = LE_SLS_LINK_INIT;
+
+    if (isRebooting)
+    {
+        // Let the current background capture finish before backing up its directory.
+        WaitForCapture();
+        BackupToFlash();
+        Capture(FLASH_LOG_DIR, requestPtr);
+
+        le_mem_Release(requestPtr);
+    }
+    else
+    {
+        le_sls_Queue(&PendingCaptures, &requestPtr->link);
+        StartNextCapture();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * SIGCHLD handler for the child processes doing the background captures.  Reaps the child if it
+ * is the capture process, and starts the next pending capture.
+ *
+ * @return
+ *      LE_OK if the child was the capture process.
+ *      LE_NOT_FOUND otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t debugData_SigChildHandler
+(
+    pid_t pid                       ///< [IN] Pid of the child process.
+)
+{
+    if ( (CapturePid == -1) || (pid != CapturePid) )
+    {
+        return LE_NOT_FOUND;
+    }
+
+    int status = wait_ReapChild(pid);
+    CapturePid = -1;
+
+    if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+    {
+        LE_ERROR("Capture process %d failed.", pid);
+    }
+
+    StartNextCapture();
+
+    return LE_OK;
+}
@@ -0,0 +1,59 @@
+//--------------------------------------------------------------------------------------------------
+/** @file supervisor/debugData.h
+ *
+ * API for capturing the system log and core files of processes that fault, to help diagnose the
+ * fault later.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#ifndef LEGATO_SRC_DEBUG_DATA_INCLUDE_GUARD
+#define LEGATO_SRC_DEBUG_DATA_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the debug data capture.  Must be called before the other functions of this API.
+ */
+//--------------------------------------------------------------------------------------------------
+void debugData_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Capture a snapshot of the system log and the process's latest core file, if any.
+ *
+ * Unless the system is going to be rebooted, the capture is done in the background and this
+ * function returns right away.  Captures that come too close together are dropped.
+ *
+ * If the system is going to be rebooted, the previous captures are backed up to flash and this
+ * capture is saved to flash before this function returns.
+ */
+//--------------------------------------------------------------------------------------------------
+void debugData_Capture
+(
+    const char* appNamePtr,         ///< [IN] Name of the app, or "framework".
+    const char* procNamePtr,        ///< [IN] Name of the process that faulted.
+    bool isRebooting                ///< [IN] Is the supervisor going to reboot the system?
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * SIGCHLD handler for the child processes doing the background captures.  Reaps the child if it
+ * is the capture process, and starts the next pending capture.
+ *
+ * @return
+ *      LE_OK if the child was the capture process.
+ *      LE_NOT_FOUND otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t debugData_SigChildHandler
+(
+    pid_t pid                       ///< [IN] Pid of the child process.
+);
+
+
+#endif // LEGATO_SRC_DEBUG_DATA_INCLUDE_GUARD
@@ -24,6 +24,29 @@
 #include "killProc.h"
 #include "interfaces.h"
 #include "sysStatus.h"
+#include "debugData.h"
+#include <sys/prctl.h>
+#include <linux/audit.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Audit architecture of the system calls made by the processes, which a seccomp filter must check
+ * before looking at a system call number.  Left undefined on architectures where system call
+ * filters for tracing are not supported.
+ */
+//--------------------------------------------------------------------------------------------------
+#if defined(__x86_64__)
+#   define TRACE_FILTER_ARCH                        AUDIT_ARCH_X86_64
+#elif defined(__i386__)
+#   define TRACE_FILTER_ARCH                        AUDIT_ARCH_I386
+#elif defined(__aarch64__)
+#   define TRACE_FILTER_ARCH                        AUDIT_ARCH_AARCH64
+#elif defined(__arm__) && !defined(__ARMEB__)
+#   define TRACE_FILTER_ARCH                        AUDIT_ARCH_ARM
+#endif
 
 
 //--------------------------------------------------------------------------------------------------
@@ -164,10 +187,25 @@ typedef struct proc_Ref
     proc_BlockCallback_t  blockCallback;  ///< Callback function to indicate when the process is
                                           ///  has been blocked after the fork but before the exec.
     void* blockContextPtr;          ///< Context pointer for the blockCallback.
+    struct TraceSysCalls* traceSysCallsPtr; ///< System calls the process stops on when it is
+                                            ///  traced.  NULL to stop on every system call.
 }
 Process_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * System calls a traced process stops on.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct TraceSysCalls
+{
+    size_t  numSysCalls;                                    ///< Number of system calls.
+    int32_t sysCalls[LE_APPCTRL_MAX_TRACE_SYS_CALLS];       ///< System call numbers.
+}
+TraceSysCalls_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Argument object.
@@ -213,6 +251,14 @@ static le_mem_PoolRef_t PriorityPool;
 static le_mem_PoolRef_t ArgsPool;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The memory pool for lists of traced system calls.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t TraceSysCallsPool;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Nice level definitions for the different Legato priority levels.
@@ -383,6 +429,7 @@ void proc_Init
     PathPool = le_mem_CreatePool("Paths", LIMIT_MAX_PATH_BYTES);
     PriorityPool = le_mem_CreatePool("Priority", LIMIT_MAX_PRIORITY_NAME_BYTES);
     ArgsPool = le_mem_CreatePool("Args", sizeof(Arg_t));
+    TraceSysCallsPool = le_mem_CreatePool("TraceSysCalls", sizeof(TraceSysCalls_t));
 }
 
 
@@ -466,6 +513,7 @@ proc_Ref_t proc_Create
     procPtr->blockPipe = -1;
     procPtr->blockCallback = NULL;
     procPtr->blockContextPtr = NULL;
+    procPtr->traceSysCallsPtr = NULL;
 
     // Get watchdog action & fault action from config tree now, if this process has a config
     // tree entry.
@@ -546,6 +594,12 @@ void proc_Delete
         le_mem_Release(procRef->priorityPtr);
     }
 
+    // Delete the traced system calls.
+    if (procRef->traceSysCallsPtr != NULL)
+    {
+        le_mem_Release(procRef->traceSysCallsPtr);
+    }
+
     // Delete executable override path.
     if (procRef->execPathPtr != NULL)
     {
@@ -1205,6 +1259,76 @@ static void BlockOnPipe
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Installs a seccomp filter in the calling process, stopping it for its tracer on the given system
+ * calls only.  Every other system call is let through without the tracer being involved.
+ *
+ * The filter is built as:
+ *
+ *      load the architecture, and allow the call if it is not ours
+ *      load the system call number
+ *      for each traced system call: jump to the trace return if the number matches
+ *      return allow
+ *      return trace
+ *
+ * @note Must only be called in the child process, just before the exec.  Sets the no_new_privs
+ *       flag of the process, as it does not have the privileges needed to install a filter
+ *       otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static void InstallTraceFilter
+(
+    const TraceSysCalls_t* traceSysCallsPtr     ///< [IN] System calls to stop on.
+)
+{
+#ifdef TRACE_FILTER_ARCH
+    struct sock_filter filter[LE_APPCTRL_MAX_TRACE_SYS_CALLS + 5];
+    size_t numSysCalls = traceSysCallsPtr->numSysCalls;
+    size_t i;
+
+    LE_ASSERT(numSysCalls <= LE_APPCTRL_MAX_TRACE_SYS_CALLS);
+
+    struct sock_filter head[] =
+    {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, TRACE_FILTER_ARCH, 0, numSysCalls + 1),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)),
+    };
+
+    memcpy(filter, head, sizeof(head));
+
+    for (i = 0; i < numSysCalls; i++)
+    {
+        struct sock_filter check =
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, traceSysCallsPtr->sysCalls[i], numSysCalls - i, 0);
+
+        filter[NUM_ARRAY_MEMBERS(head) + i] = check;
+    }
+
+    struct sock_filter allow = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW);
+    struct sock_filter trace = BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_TRACE);
+
+    filter[NUM_ARRAY_MEMBERS(head) + numSysCalls] = allow;
+    filter[NUM_ARRAY_MEMBERS(head) + numSysCalls + 1] = trace;
+
+    struct sock_fprog prog =
+    {
+        .len = NUM_ARRAY_MEMBERS(head) + numSysCalls + 2,
+        .filter = filter,
+    };
+
+    LE_FATAL_IF(prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == -1,
+                "Could not set the no_new_privs flag.  %m.");
+
+    LE_FATAL_IF(prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog) == -1,
+                "Could not install the system call trace filter.  %m.");
+#else
+    LE_FATAL("System call trace filters are not supported on this architecture.");
+#endif
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Starts a process.  If the process belongs to a sandboxed app the process will run in its sandbox,
@@ -1348,6 +1472,12 @@ le_result_t proc_Start
             procRef->blockCallback(getpid(), procRef->namePtr, procRef->blockContextPtr);
 
             BlockOnPipe(blockPipeFd);
+
+            // The tracer has attached by now, so the filter can stop us on the traced calls.
+            if (procRef->traceSysCallsPtr != NULL)
+            {
+                InstallTraceFilter(procRef->traceSysCallsPtr);
+            }
         }
 
         // Launch the child program.  This should not return unless there was an error.
@@ -1859,6 +1989,63 @@ void proc_SetBlockCallback
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the system calls the process stops on when it is traced.  This only applies if the process
+ * blocks on startup, the filter being installed once it is unblocked.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_IMPLEMENTED if system call filters are not supported on this system.
+ *      LE_OVERFLOW if there are too many system calls.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t proc_SetTraceSysCalls
+(
+    proc_Ref_t procRef,                     ///< [IN] The process reference.
+    const int32_t* sysCallsPtr,             ///< [IN] System call numbers.
+    size_t numSysCalls                      ///< [IN] Number of system calls.  0 to stop on every
+                                            ///       system call.
+)
+{
+    if (numSysCalls == 0)
+    {
+        if (procRef->traceSysCallsPtr != NULL)
+        {
+            le_mem_Release(procRef->traceSysCallsPtr);
+            procRef->traceSysCallsPtr = NULL;
+        }
+
+        return LE_OK;
+    }
+
+    if (numSysCalls > LE_APPCTRL_MAX_TRACE_SYS_CALLS)
+    {
+        return LE_OVERFLOW;
+    }
+
+#ifdef TRACE_FILTER_ARCH
+    // Ask for a filter with no program.  Kernels supporting filters fail on the program's address.
+    if ( (prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, NULL) != -1) || (errno != EFAULT) )
+    {
+        return LE_NOT_IMPLEMENTED;
+    }
+#else
+    return LE_NOT_IMPLEMENTED;
+#endif
+
+    if (procRef->traceSysCallsPtr == NULL)
+    {
+        procRef->traceSysCallsPtr = le_mem_ForceAlloc(TraceSysCallsPool);
+    }
+
+    memcpy(procRef->traceSysCallsPtr->sysCalls, sysCallsPtr, numSysCalls * sizeof(int32_t));
+    procRef->traceSysCallsPtr->numSysCalls = numSysCalls;
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Unblocks a process that was blocked on startup.
@@ -1892,45 +2079,6 @@ void proc_SetRun
 }
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Called to capture any extra data that may help indicate what contributed to the fault that caused
- * the given process to fail.
- *
- * This function calls a shell script that will save a dump of the system log and any core files
- * that have been generated into a known location.
- */
-//--------------------------------------------------------------------------------------------------
-static void CaptureDebugData
-(
-    proc_Ref_t procRef,             ///< [IN] The process reference.
-    bool isRebooting                ///< [IN] Is the supervisor going to reboot the system?
-)
-{
-    char command[LIMIT_MAX_PATH_BYTES];
-    int s = snprintf(command,
-                     sizeof(command),
-                     "/legato/systems/current/bin/saveLogs %s %s %s",
-                     app_GetName(procRef->appRef),
-                     procRef->namePtr,
-                     isRebooting ? "REBOOT" : "");
-
-    if (s >= sizeof(command))
-    {
-        LE_FATAL("Could not create command, buffer is too small.  "
-                 "Buffer is %zd bytes but needs to be %d bytes.",
-                 sizeof(command),
-                 s);
-    }
-
-    int r = system(command);
-
-    if (!WIFEXITED(r) || (WEXITSTATUS(r) != EXIT_SUCCESS))
-    {
-        LE_ERROR("Could not save log and core file.");
-    }
-}
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the watchdog action for this process.
@@ -2086,7 +2234,7 @@ FaultAction_t proc_SigChildHandler
         // Check if we're rebooting.  If we are, this data needs to be saved in a more permanent
         // location.
         bool isRebooting = (faultAction == FAULT_ACTION_REBOOT);
-        CaptureDebugData(procRef, isRebooting);
+        debugData_Capture(app_GetName(procRef->appRef), procRef->namePtr, isRebooting);
     }
 
     return faultAction;
@@ -368,6 +368,26 @@ void proc_SetBlockCallback
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the system calls the process stops on when it is traced.  This only applies if the process
+ * blocks on startup, the filter being installed once it is unblocked.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_IMPLEMENTED if system call filters are not supported on this system.
+ *      LE_OVERFLOW if there are too many system calls.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t proc_SetTraceSysCalls
+(
+    proc_Ref_t procRef,                     ///< [IN] The process reference.
+    const int32_t* sysCallsPtr,             ///< [IN] System call numbers.
+    size_t numSysCalls                      ///< [IN] Number of system calls.  0 to stop on every
+                                            ///       system call.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Unblocks a process that was blocked on startup.
@@ -212,6 +212,7 @@
 #include "daemon.h"
 #include "apps.h"
 #include "wait.h"
+#include "debugData.h"
 #include "fileSystem.h"
 #include "sysStatus.h"
 #include "fileDescriptor.h"
@@ -694,29 +695,6 @@ void framework_Reboot
 }
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Called to capture any extra data that may help indicate what contributed to the fault that
- * caused the framework to fail.
- *
- * This function calls a shell script that will save a dump of the system log and any core files
- * that have been generated into a known location.
- */
-//--------------------------------------------------------------------------------------------------
-static void CaptureDebugData
-(
-    void
-)
-{
-    int r = system("/legato/systems/current/bin/saveLogs framework unknown REBOOT");
-
-    if (!WIFEXITED(r) || (WEXITSTATUS(r) != EXIT_SUCCESS))
-    {
-        LE_ERROR("Could not save log and core file.");
-    }
-}
-
-
 //--------------------------------------------------------------------------------------------------
 /**
  * The signal event handler function for SIGCHLD called from the Legato event loop.
@@ -771,13 +749,13 @@ static void SigChildHandler
 
             if (r == LE_FAULT)
             {
-                CaptureDebugData();
+                debugData_Capture("framework", "unknown", true);
                 framework_Reboot();
             }
-            else if (r == LE_NOT_FOUND)
+            else if ( (r == LE_NOT_FOUND) && (debugData_SigChildHandler(pid) == LE_NOT_FOUND) )
             {
-                // The child is neither an application process nor a framework daemon.
-                // Reap the child now.
+                // The child is neither an application process, a framework daemon nor a debug
+                // data capture process.  Reap the child now.
                 LE_INFO("Reaping unconfigured child process %d.", pid);
 
                 wait_ReapChild(pid);
@@ -1021,6 +999,7 @@ COMPONENT_INIT
     user_Init();
     kernelModules_Init();
     smack_Init();
+    debugData_Init();
 
     // Set correct smack permissions for syslog
     smack_SetRule("_", "rw", "syslog");
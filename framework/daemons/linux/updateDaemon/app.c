@@ -40,6 +40,7 @@
 #include "sysPaths.h"
 #include "fileSystem.h"
 #include "ima.h"
+#include "objStore.h"
 
 
 static const char* InstallHookScriptPath = "/legato/systems/current/bin/install-hook";
@@ -329,6 +330,25 @@ static le_result_t SetSmackPermReadOnlyDir
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Share the files of an installed app with the other installed apps and systems, once its files
+ * have their final permissions.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddAppToObjStore
+(
+    const char* appMd5Ptr   ///< [IN] Hash ID of the application.
+)
+{
+    char appPath[LIMIT_MAX_PATH_BYTES] = "";
+
+    LE_ASSERT(snprintf(appPath, sizeof(appPath), "/legato/apps/%s", appMd5Ptr) < sizeof(appPath));
+
+    objStore_AddTree(appPath, NULL);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Recursively sets the SMACK permissions for directories under apps writeable directory.
@@ -426,6 +446,8 @@ static le_result_t PerformAppUpgrade
     // Set smackfs file permission for installed files
     SetSmackPermReadOnlyDir(appMd5Ptr, appNamePtr);
 
+    AddAppToObjStore(appMd5Ptr);
+
     // Update non-writeable files dir symlink to point to the new version of the app
     system_SymlinkApp("current", appMd5Ptr, appNamePtr);
 
@@ -458,6 +480,8 @@ static le_result_t PerformAppInstall
     // Set smackfs file permission for installed files
     SetSmackPermReadOnlyDir(appMd5Ptr, appNamePtr);
 
+    AddAppToObjStore(appMd5Ptr);
+
     // Create a non-writeable files dir symlink pointing to the app's installed files.
     system_SymlinkApp("current", appMd5Ptr, appNamePtr);
 
@@ -0,0 +1,630 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file delta.c
+ *
+ * Implementation of the Update Daemon's "delta" module, which rebuilds delta encoded apps.
+ * See delta.h for the format of delta encoded apps.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "file.h"
+#include "fileDescriptor.h"
+#include "delta.h"
+#include <sys/mman.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the delta file header: magic string and size of the new file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DELTA_HEADER_BYTES  (sizeof(DELTA_MAGIC) - 1 + 8)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer used to write rebuilt files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define WRITE_BUFFER_BYTES  (64 * 1024)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read-only mapping of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const uint8_t* dataPtr;     ///< File content, NULL if the file is empty.
+    size_t size;                ///< File size.
+    mode_t mode;                ///< File mode.
+}
+Mapping_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffered output file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int fd;
+    size_t size;                        ///< Number of bytes written so far.
+    size_t used;                        ///< Number of bytes in the buffer.
+    uint8_t buffer[WRITE_BUFFER_BYTES];
+}
+Output_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Map a file in memory.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t MapFile
+(
+    const char* path,
+    Mapping_t* mappingPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to open '%s' (%m).", path);
+        return LE_FAULT;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        LE_ERROR("Failed to stat '%s' (%m).", path);
+        fd_Close(fd);
+        return LE_FAULT;
+    }
+
+    mappingPtr->dataPtr = NULL;
+    mappingPtr->size = fileStat.st_size;
+    mappingPtr->mode = fileStat.st_mode;
+
+    if (mappingPtr->size > 0)
+    {
+        void* dataPtr = mmap(NULL, mappingPtr->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (dataPtr == MAP_FAILED)
+        {
+            LE_ERROR("Failed to map '%s' (%m).", path);
+            fd_Close(fd);
+            return LE_FAULT;
+        }
+        mappingPtr->dataPtr = dataPtr;
+    }
+
+    fd_Close(fd);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unmap a file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnmapFile
+(
+    Mapping_t* mappingPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (mappingPtr->dataPtr != NULL)
+    {
+        munmap((void*)mappingPtr->dataPtr, mappingPtr->size);
+        mappingPtr->dataPtr = NULL;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the buffered bytes of an output file.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t FlushOutput
+(
+    Output_t* outputPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((outputPtr->used > 0) && (fd_WriteSize(outputPtr->fd, outputPtr->buffer, outputPtr->used)
+                                  != (ssize_t)outputPtr->used))
+    {
+        LE_ERROR("Failed to write rebuilt file (%m).");
+        return LE_FAULT;
+    }
+
+    outputPtr->used = 0;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add bytes to an output file.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteOutput
+(
+    Output_t* outputPtr,
+    const uint8_t* dataPtr,
+    size_t size
+)
+//--------------------------------------------------------------------------------------------------
+{
+    outputPtr->size += size;
+
+    // Large chunks are written directly.
+    if (size >= sizeof(outputPtr->buffer))
+    {
+        if (   (FlushOutput(outputPtr) != LE_OK)
+            || (fd_WriteSize(outputPtr->fd, (void*)dataPtr, size) != (ssize_t)size))
+        {
+            LE_ERROR("Failed to write rebuilt file (%m).");
+            return LE_FAULT;
+        }
+        return LE_OK;
+    }
+
+    if (outputPtr->used + size > sizeof(outputPtr->buffer))
+    {
+        if (FlushOutput(outputPtr) != LE_OK)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    memcpy(outputPtr->buffer + outputPtr->used, dataPtr, size);
+    outputPtr->used += size;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a big endian integer from a delta.
+ *
+ * @return
+ *      - true on success.
+ *      - false if the delta is truncated.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadInt
+(
+    const Mapping_t* deltaPtr,
+    size_t* offsetPtr,
+    size_t numBytes,
+    uint64_t* valuePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (deltaPtr->size - *offsetPtr < numBytes)
+    {
+        return false;
+    }
+
+    *valuePtr = 0;
+    while (numBytes-- > 0)
+    {
+        *valuePtr = (*valuePtr << 8) | deltaPtr->dataPtr[(*offsetPtr)++];
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run the records of a delta.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FORMAT_ERROR if the delta is malformed or doesn't match the base file.
+ *      - LE_FAULT on any other error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RunDelta
+(
+    const Mapping_t* basePtr,
+    const Mapping_t* deltaPtr,
+    Output_t* outputPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint64_t newSize;
+    size_t offset = sizeof(DELTA_MAGIC) - 1;
+
+    if (   (deltaPtr->size < DELTA_HEADER_BYTES)
+        || (memcmp(deltaPtr->dataPtr, DELTA_MAGIC, sizeof(DELTA_MAGIC) - 1) != 0)
+        || !ReadInt(deltaPtr, &offset, 8, &newSize))
+    {
+        LE_ERROR("Not a delta file.");
+        return LE_FORMAT_ERROR;
+    }
+
+    while (offset < deltaPtr->size)
+    {
+        uint8_t op = deltaPtr->dataPtr[offset++];
+        uint64_t copyOffset;
+        uint64_t size;
+
+        switch (op)
+        {
+            case 'C':
+                if (   !ReadInt(deltaPtr, &offset, 8, &copyOffset)
+                    || !ReadInt(deltaPtr, &offset, 4, &size)
+                    || (copyOffset > basePtr->size)
+                    || (size > basePtr->size - copyOffset))
+                {
+                    LE_ERROR("Invalid copy record at offset %zu.", offset);
+                    return LE_FORMAT_ERROR;
+                }
+                if (   (size > 0)
+                    && (WriteOutput(outputPtr, basePtr->dataPtr + copyOffset, size) != LE_OK))
+                {
+                    return LE_FAULT;
+                }
+                break;
+
+            case 'A':
+                if (   !ReadInt(deltaPtr, &offset, 4, &size)
+                    || (size > deltaPtr->size - offset))
+                {
+                    LE_ERROR("Invalid add record at offset %zu.", offset);
+                    return LE_FORMAT_ERROR;
+                }
+                if (   (size > 0)
+                    && (WriteOutput(outputPtr, deltaPtr->dataPtr + offset, size) != LE_OK))
+                {
+                    return LE_FAULT;
+                }
+                offset += size;
+                break;
+
+            case 'E':
+                if (outputPtr->size != newSize)
+                {
+                    LE_ERROR("Rebuilt file size %zu doesn't match expected size %" PRIu64 ".",
+                             outputPtr->size,
+                             newSize);
+                    return LE_FORMAT_ERROR;
+                }
+                return FlushOutput(outputPtr);
+
+            default:
+                LE_ERROR("Unknown record type 0x%02x at offset %zu.", op, offset - 1);
+                return LE_FORMAT_ERROR;
+        }
+    }
+
+    LE_ERROR("Truncated delta.");
+    return LE_FORMAT_ERROR;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild a file from a base file and a delta file.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FORMAT_ERROR if the delta is malformed or doesn't match the base file.
+ *      - LE_FAULT on any other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_ApplyFile
+(
+    const char* basePath,       ///< [IN] Path of the base file.
+    const char* deltaPath,      ///< [IN] Path of the delta file.
+    const char* outPath         ///< [IN] Path of the file to create.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Mapping_t base;
+    Mapping_t delta;
+
+    if (MapFile(basePath, &base) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    if (MapFile(deltaPath, &delta) != LE_OK)
+    {
+        UnmapFile(&base);
+        return LE_FAULT;
+    }
+
+    le_result_t result = LE_FAULT;
+
+    // The output is allocated on the heap rather than the stack, as it holds the write buffer.
+    Output_t* outputPtr = malloc(sizeof(Output_t));
+    LE_ASSERT(outputPtr != NULL);
+
+    outputPtr->size = 0;
+    outputPtr->used = 0;
+    outputPtr->fd = open(outPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, delta.mode & 07777);
+
+    if (outputPtr->fd < 0)
+    {
+        LE_ERROR("Failed to create '%s' (%m).", outPath);
+    }
+    else
+    {
+        result = RunDelta(&base, &delta, outputPtr);
+
+        // Give the rebuilt file the mode of the delta, which is the mode of the new file.
+        if ((result == LE_OK) && (fchmod(outputPtr->fd, delta.mode & 07777) != 0))
+        {
+            LE_ERROR("Failed to set mode of '%s' (%m).", outPath);
+            result = LE_FAULT;
+        }
+
+        fd_Close(outputPtr->fd);
+
+        if (result != LE_OK)
+        {
+            LE_ERROR("Failed to rebuild '%s' from '%s'.", outPath, basePath);
+            unlink(outPath);
+        }
+    }
+
+    free(outputPtr);
+    UnmapFile(&delta);
+    UnmapFile(&base);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a path from a manifest stays inside the app.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsValidManifestPath
+(
+    const char* path
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((path[0] == '\0') || (path[0] == '/'))
+    {
+        return false;
+    }
+
+    // Reject any ".." component.
+    const char* componentPtr = path;
+    while (componentPtr != NULL)
+    {
+        if (   (strncmp(componentPtr, "..", 2) == 0)
+            && ((componentPtr[2] == '/') || (componentPtr[2] == '\0')))
+        {
+            return false;
+        }
+
+        componentPtr = strchr(componentPtr, '/');
+        if (componentPtr != NULL)
+        {
+            componentPtr++;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Bring a file of the base app over to the new app unchanged. Regular files are hard linked, as
+ * installed apps are never modified in place, and copied if that fails. Symlinks are recreated.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t KeepFile
+(
+    const char* basePath,
+    const char* newPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat baseStat;
+
+    if (lstat(basePath, &baseStat) != 0)
+    {
+        LE_ERROR("Base file '%s' is missing (%m).", basePath);
+        return LE_FAULT;
+    }
+
+    if (S_ISLNK(baseStat.st_mode))
+    {
+        char target[PATH_MAX];
+        ssize_t targetSize = readlink(basePath, target, sizeof(target) - 1);
+
+        if (targetSize < 0)
+        {
+            LE_ERROR("Failed to read link '%s' (%m).", basePath);
+            return LE_FAULT;
+        }
+        target[targetSize] = '\0';
+
+        if (symlink(target, newPath) != 0)
+        {
+            LE_ERROR("Failed to create link '%s' (%m).", newPath);
+            return LE_FAULT;
+        }
+        return LE_OK;
+    }
+
+    if (!S_ISREG(baseStat.st_mode))
+    {
+        LE_ERROR("Base file '%s' is not a regular file.", basePath);
+        return LE_FAULT;
+    }
+
+    if (link(basePath, newPath) == 0)
+    {
+        return LE_OK;
+    }
+
+    LE_DEBUG("Failed to link '%s' (%m), copying it.", basePath);
+
+    return (file_Copy(basePath, newPath, NULL) == LE_OK) ? LE_OK : LE_FAULT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete an unpacked delta encoded app, using an installed version of the app as base. On
+ * success, the unpack directory holds the new app and the manifest and delta files are removed.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FORMAT_ERROR if the manifest or a delta is malformed.
+ *      - LE_FAULT on any other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_ApplyApp
+(
+    const char* baseDirPath,    ///< [IN] Directory of the base app, e.g. /legato/apps/<md5>.
+    const char* unpackDirPath   ///< [IN] Directory the delta encoded app was unpacked into.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char manifestPath[PATH_MAX] = "";
+
+    if (le_path_Concat("/", manifestPath, sizeof(manifestPath), unpackDirPath,
+                       DELTA_MANIFEST_NAME, NULL) != LE_OK)
+    {
+        LE_ERROR("Manifest path too long.");
+        return LE_FAULT;
+    }
+
+    FILE* manifestPtr = fopen(manifestPath, "r");
+    if (manifestPtr == NULL)
+    {
+        LE_ERROR("Failed to open delta manifest '%s' (%m).", manifestPath);
+        return LE_FORMAT_ERROR;
+    }
+
+    le_result_t result = LE_OK;
+    size_t keptCount = 0;
+    size_t rebuiltCount = 0;
+    char line[LIMIT_MAX_PATH_BYTES + 3];
+
+    while ((result == LE_OK) && (fgets(line, sizeof(line), manifestPtr) != NULL))
+    {
+        size_t lineLen = strlen(line);
+
+        if ((lineLen > 0) && (line[lineLen - 1] == '\n'))
+        {
+            line[--lineLen] = '\0';
+        }
+        if (lineLen == 0)
+        {
+            continue;
+        }
+
+        const char* relPath = line + 2;
+
+        if ((lineLen < 3) || (line[1] != ' ') || !IsValidManifestPath(relPath))
+        {
+            LE_ERROR("Malformed delta manifest line '%s'.", line);
+            result = LE_FORMAT_ERROR;
+            break;
+        }
+
+        char basePath[PATH_MAX] = "";
+        char newPath[PATH_MAX] = "";
+        char deltaPath[PATH_MAX] = "";
+
+        if (   (le_path_Concat("/", basePath, sizeof(basePath), baseDirPath, relPath, NULL)
+                != LE_OK)
+            || (le_path_Concat("/", newPath, sizeof(newPath), unpackDirPath, relPath, NULL)
+                != LE_OK)
+            || (snprintf(deltaPath, sizeof(deltaPath), "%s" DELTA_FILE_SUFFIX, newPath)
+                >= sizeof(deltaPath)))
+        {
+            LE_ERROR("Path too long for '%s'.", relPath);
+            result = LE_FAULT;
+            break;
+        }
+
+        // Files are listed before the directories holding them may have been created.
+        char dirPath[PATH_MAX] = "";
+        if (   (le_path_GetDir(newPath, "/", dirPath, sizeof(dirPath)) != LE_OK)
+            || (le_dir_MakePath(dirPath, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) != LE_OK))
+        {
+            LE_ERROR("Failed to create directory for '%s'.", newPath);
+            result = LE_FAULT;
+            break;
+        }
+
+        switch (line[0])
+        {
+            case '=':
+                result = KeepFile(basePath, newPath);
+                keptCount++;
+                break;
+
+            case 'd':
+                result = delta_ApplyFile(basePath, deltaPath, newPath);
+                if (result == LE_OK)
+                {
+                    unlink(deltaPath);
+                }
+                rebuiltCount++;
+                break;
+
+            default:
+                LE_ERROR("Unknown delta manifest operation '%c'.", line[0]);
+                result = LE_FORMAT_ERROR;
+                break;
+        }
+    }
+
+    fclose(manifestPtr);
+
+    if (result == LE_OK)
+    {
+        unlink(manifestPath);
+
+        LE_INFO("Rebuilt app in '%s' from '%s': %zu files kept, %zu files patched.",
+                unpackDirPath,
+                baseDirPath,
+                keptCount,
+                rebuiltCount);
+    }
+
+    return result;
+}
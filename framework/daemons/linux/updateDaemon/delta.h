@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file delta.h
+ *
+ * Functions exported by the Update Daemon's "delta" module, which rebuilds an app from the
+ * per-file binary deltas of an "updateAppDelta" update pack section and an installed version of
+ * the same app.
+ *
+ * The payload of an "updateAppDelta" section unpacks into a directory containing:
+ *  - a manifest (DELTA_MANIFEST_NAME), listing one file per line as "<op> <path>", where op is:
+ *      - '=' if the file is the same as in the base app,
+ *      - 'd' if the file is rebuilt from the base app's file and "<path>" DELTA_FILE_SUFFIX;
+ *  - the delta files;
+ *  - the new and changed files that are not delta encoded, and the directories, as in an app.
+ *
+ * Files of the base app that are not in the manifest nor in the payload are not part of the new
+ * app.
+ *
+ * A delta file starts with the DELTA_MAGIC string, followed by the size of the new file (64 bits,
+ * big endian), and then a series of records:
+ *  - 'C' <offset (64 bits)> <size (32 bits)>: copy size bytes from the base file at offset,
+ *  - 'A' <size (32 bits)> <data>: add size bytes of data,
+ *  - 'E': end of the delta.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_UPDATE_DAEMON_DELTA_H_INCLUDE_GUARD
+#define LEGATO_UPDATE_DAEMON_DELTA_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the manifest of a delta encoded app.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DELTA_MANIFEST_NAME     "delta.manifest"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suffix of the delta files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DELTA_FILE_SUFFIX       ".ldelta"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic string at the start of a delta file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DELTA_MAGIC             "LEDELTA1"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Rebuild a file from a base file and a delta file.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FORMAT_ERROR if the delta is malformed or doesn't match the base file.
+ *      - LE_FAULT on any other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_ApplyFile
+(
+    const char* basePath,       ///< [IN] Path of the base file.
+    const char* deltaPath,      ///< [IN] Path of the delta file.
+    const char* outPath         ///< [IN] Path of the file to create.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Complete an unpacked delta encoded app, using an installed version of the app as base. On
+ * success, the unpack directory holds the new app and the manifest and delta files are removed.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FORMAT_ERROR if the manifest or a delta is malformed.
+ *      - LE_FAULT on any other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t delta_ApplyApp
+(
+    const char* baseDirPath,    ///< [IN] Directory of the base app, e.g. /legato/apps/<md5>.
+    const char* unpackDirPath   ///< [IN] Directory the delta encoded app was unpacked into.
+);
+
+
+#endif // LEGATO_UPDATE_DAEMON_DELTA_H_INCLUDE_GUARD
@@ -0,0 +1,544 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file objStore.c
+ *
+ * Implementation of the Update Daemon's content-addressed object store. See objStore.h.
+ *
+ * Objects are looked up by a CRC of their content and of their attributes, then compared byte for
+ * byte before being shared, so a CRC collision never shares different files. Colliding objects
+ * get a numbered suffix.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "fileDescriptor.h"
+#include "objStore.h"
+#include <sys/mman.h>
+#include <sys/xattr.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of objects with the same key.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_COLLISIONS          4
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum size of the attributes of a file, and of the list of its extended attribute names.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_ATTRS_BYTES         2048
+#define MAX_XATTR_LIST_BYTES    1024
+#define MAX_XATTR_COUNT         32
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Suffix of the temporary link used to replace a file by an object.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TEMP_LINK_SUFFIX        ".objstore~"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A file open for comparison: its status, contents and attributes.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    int fd;                             ///< File descriptor.
+    struct stat st;                     ///< Status.
+    const uint8_t* dataPtr;             ///< Contents, mapped in memory.
+    uint8_t attrs[MAX_ATTRS_BYTES];     ///< Owner, permissions and extended attributes.
+    size_t attrsSize;                   ///< # of bytes of attrs used.
+}
+File_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two extended attribute names, for qsort().
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareNames
+(
+    const void* aPtr,
+    const void* bPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return strcmp(*(const char* const*)aPtr, *(const char* const*)bPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append bytes to the attributes of a file.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_OVERFLOW if the attributes are too large.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AppendAttr
+(
+    File_t* filePtr,
+    const void* dataPtr,
+    size_t size
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (size > sizeof(filePtr->attrs) - filePtr->attrsSize)
+    {
+        return LE_OVERFLOW;
+    }
+
+    memcpy(filePtr->attrs + filePtr->attrsSize, dataPtr, size);
+    filePtr->attrsSize += size;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the attributes that hard links share: permissions, owner, and the extended attributes
+ * sorted by name, so that identical files have identical attributes.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT on error, or if the attributes are too large to be compared.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadAttrs
+(
+    File_t* filePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t ids[3] = { filePtr->st.st_mode, filePtr->st.st_uid, filePtr->st.st_gid };
+    char list[MAX_XATTR_LIST_BYTES];
+    const char* names[MAX_XATTR_COUNT];
+    size_t nameCount = 0;
+
+    filePtr->attrsSize = 0;
+    AppendAttr(filePtr, ids, sizeof(ids));
+
+    ssize_t listSize = flistxattr(filePtr->fd, list, sizeof(list));
+    if (listSize < 0)
+    {
+        if (errno == ENOTSUP)
+        {
+            return LE_OK;
+        }
+        LE_ERROR("Failed to list extended attributes (%m).");
+        return LE_FAULT;
+    }
+
+    const char* namePtr = list;
+    while (namePtr < list + listSize)
+    {
+        if (nameCount >= NUM_ARRAY_MEMBERS(names))
+        {
+            return LE_FAULT;
+        }
+        names[nameCount++] = namePtr;
+        namePtr += strlen(namePtr) + 1;
+    }
+
+    qsort(names, nameCount, sizeof(names[0]), CompareNames);
+
+    size_t i;
+    for (i = 0; i < nameCount; i++)
+    {
+        uint8_t value[512];
+
+        ssize_t valueSize = fgetxattr(filePtr->fd, names[i], value, sizeof(value));
+        if (   (valueSize < 0)
+            || (AppendAttr(filePtr, names[i], strlen(names[i]) + 1) != LE_OK)
+            || (AppendAttr(filePtr, &valueSize, sizeof(valueSize)) != LE_OK)
+            || (AppendAttr(filePtr, value, valueSize) != LE_OK))
+        {
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a file and map it in memory.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NOT_FOUND if the file doesn't exist.
+ *      - LE_FAULT on any other error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t OpenFile
+(
+    const char* pathPtr,
+    File_t* filePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    filePtr->dataPtr = NULL;
+
+    filePtr->fd = open(pathPtr, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (filePtr->fd < 0)
+    {
+        return (errno == ENOENT) ? LE_NOT_FOUND : LE_FAULT;
+    }
+
+    if (   (fstat(filePtr->fd, &filePtr->st) != 0)
+        || !S_ISREG(filePtr->st.st_mode)
+        || (filePtr->st.st_size == 0)
+        || (ReadAttrs(filePtr) != LE_OK))
+    {
+        fd_Close(filePtr->fd);
+        return LE_FAULT;
+    }
+
+    void* dataPtr = mmap(NULL, filePtr->st.st_size, PROT_READ, MAP_PRIVATE, filePtr->fd, 0);
+    if (dataPtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map '%s' (%m).", pathPtr);
+        fd_Close(filePtr->fd);
+        return LE_FAULT;
+    }
+
+    filePtr->dataPtr = dataPtr;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a file opened by OpenFile().
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseFile
+(
+    File_t* filePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    munmap((void*)filePtr->dataPtr, filePtr->st.st_size);
+    fd_Close(filePtr->fd);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Are two files identical, so that one can be replaced by a hard link to the other?
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSameFile
+(
+    const File_t* aPtr,
+    const File_t* bPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (aPtr->st.st_size == bPtr->st.st_size)
+           && (aPtr->attrsSize == bPtr->attrsSize)
+           && (memcmp(aPtr->attrs, bPtr->attrs, aPtr->attrsSize) == 0)
+           && (memcmp(aPtr->dataPtr, bPtr->dataPtr, aPtr->st.st_size) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the path of the object a file would be, for a given collision index.
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetObjectPath
+(
+    const File_t* filePtr,
+    uint32_t contentCrc,
+    int collisionIndex,
+    char* pathPtr,
+    size_t pathSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t attrsCrc = le_crc_Crc32((uint8_t*)filePtr->attrs,
+                                     filePtr->attrsSize,
+                                     LE_CRC_START_CRC32);
+
+    int len = snprintf(pathPtr, pathSize, OBJSTORE_PATH "/%02x/%jx-%08x-%08x",
+                       (unsigned int)(contentCrc >> 24),
+                       (uintmax_t)filePtr->st.st_size,
+                       (unsigned int)contentCrc,
+                       (unsigned int)attrsCrc);
+
+    if (collisionIndex > 0)
+    {
+        snprintf(pathPtr + len, pathSize - len, ".%d", collisionIndex);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replace a file by a hard link to an object, atomically.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT on error. The file is left as it was.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t LinkToObject
+(
+    const char* objPath,
+    const char* filePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char tempPath[PATH_MAX];
+
+    if (snprintf(tempPath, sizeof(tempPath), "%s" TEMP_LINK_SUFFIX, filePath) >= sizeof(tempPath))
+    {
+        return LE_FAULT;
+    }
+
+    (void)unlink(tempPath);
+
+    if (link(objPath, tempPath) != 0)
+    {
+        // E.g., the object has reached the maximum number of links.
+        LE_DEBUG("Failed to link '%s' to '%s' (%m).", tempPath, objPath);
+        return LE_FAULT;
+    }
+
+    if (rename(tempPath, filePath) != 0)
+    {
+        LE_ERROR("Failed to rename '%s' to '%s' (%m).", tempPath, filePath);
+        (void)unlink(tempPath);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a file to the object store.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddFile
+(
+    const char* filePath,
+    objStore_Stats_t* statsPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static File_t file;
+    static File_t object;
+
+    if (OpenFile(filePath, &file) != LE_OK)
+    {
+        return;
+    }
+
+    uint32_t contentCrc = le_crc_Crc32((uint8_t*)file.dataPtr,
+                                       file.st.st_size,
+                                       LE_CRC_START_CRC32);
+    int i;
+
+    for (i = 0; i < MAX_COLLISIONS; i++)
+    {
+        char objPath[PATH_MAX];
+
+        GetObjectPath(&file, contentCrc, i, objPath, sizeof(objPath));
+
+        le_result_t result = OpenFile(objPath, &object);
+
+        if (result == LE_NOT_FOUND)
+        {
+            // First of its kind.
+            char dirPath[PATH_MAX];
+
+            if (   (le_path_GetDir(objPath, "/", dirPath, sizeof(dirPath)) == LE_OK)
+                && (le_dir_MakePath(dirPath, S_IRWXU) == LE_OK)
+                && (link(filePath, objPath) == 0))
+            {
+                statsPtr->newCount++;
+            }
+            else
+            {
+                LE_WARN("Failed to add '%s' to the object store as '%s' (%m).", filePath, objPath);
+            }
+            break;
+        }
+        else if (result == LE_OK)
+        {
+            bool isSame = IsSameFile(&file, &object);
+            bool isLinked = (file.st.st_ino == object.st.st_ino)
+                            && (file.st.st_dev == object.st.st_dev);
+
+            CloseFile(&object);
+
+            if (isLinked)
+            {
+                break;
+            }
+
+            if (isSame)
+            {
+                if (LinkToObject(objPath, filePath) == LE_OK)
+                {
+                    statsPtr->linkedCount++;
+                    statsPtr->bytesSaved += file.st.st_size;
+                }
+                break;
+            }
+
+            // Collision, try the next index.
+        }
+        else
+        {
+            LE_WARN("Failed to open object '%s'.", objPath);
+            break;
+        }
+    }
+
+    CloseFile(&file);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the files of a tree to the object store, sharing the files that are already in it.
+ *
+ * Failing to share a file isn't an error: the file is left as is.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the tree couldn't be walked.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t objStore_AddTree
+(
+    const char* dirPath,            ///< [IN] Root of the tree.
+    objStore_Stats_t* statsPtr      ///< [OUT] Statistics (can be NULL).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    objStore_Stats_t stats = { 0 };
+    char* pathArrayPtr[] = { (char*)dirPath, NULL };
+
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL | FTS_NOCHDIR, NULL);
+    if (ftsPtr == NULL)
+    {
+        LE_ERROR("Could not access dir '%s'. %m.", dirPath);
+        return LE_FAULT;
+    }
+
+    FTSENT* entPtr;
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        // Files that already have other links are either already shared, or hard linked on
+        // purpose.
+        if (   (entPtr->fts_info == FTS_F)
+            && (entPtr->fts_statp->st_nlink == 1)
+            && (entPtr->fts_statp->st_size > 0))
+        {
+            stats.fileCount++;
+            AddFile(entPtr->fts_path, &stats);
+        }
+    }
+
+    fts_close(ftsPtr);
+
+    LE_INFO("Added '%s' to the object store: %zu files, %zu shared, %zu new, %" PRIu64
+            " bytes saved.",
+            dirPath,
+            stats.fileCount,
+            stats.linkedCount,
+            stats.newCount,
+            stats.bytesSaved);
+
+    if (statsPtr != NULL)
+    {
+        *statsPtr = stats;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the objects that aren't used by any installed file anymore.
+ */
+//--------------------------------------------------------------------------------------------------
+void objStore_CollectGarbage
+(
+    objStore_Stats_t* statsPtr      ///< [OUT] Statistics (can be NULL).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    objStore_Stats_t stats = { 0 };
+    char* pathArrayPtr[] = { OBJSTORE_PATH, NULL };
+
+    if (!le_dir_IsDir(OBJSTORE_PATH))
+    {
+        return;
+    }
+
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL | FTS_NOCHDIR, NULL);
+    if (ftsPtr == NULL)
+    {
+        LE_ERROR("Could not access dir '%s'. %m.", OBJSTORE_PATH);
+        return;
+    }
+
+    FTSENT* entPtr;
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        if (entPtr->fts_info == FTS_F)
+        {
+            stats.fileCount++;
+
+            if (entPtr->fts_statp->st_nlink == 1)
+            {
+                if (unlink(entPtr->fts_path) == 0)
+                {
+                    stats.bytesSaved += entPtr->fts_statp->st_size;
+                }
+                else
+                {
+                    LE_ERROR("Failed to remove object '%s' (%m).", entPtr->fts_path);
+                }
+            }
+        }
+        else if ((entPtr->fts_info == FTS_DP) && (entPtr->fts_level == 1))
+        {
+            // Fails if the directory still has objects.
+            (void)rmdir(entPtr->fts_path);
+        }
+    }
+
+    fts_close(ftsPtr);
+
+    LE_INFO("Object store garbage collected: %zu objects, %" PRIu64 " bytes freed.",
+            stats.fileCount,
+            stats.bytesSaved);
+
+    if (statsPtr != NULL)
+    {
+        *statsPtr = stats;
+    }
+}
@@ -0,0 +1,83 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file objStore.h
+ *
+ * Functions exported by the Update Daemon's "object store" module, which keeps a single copy of
+ * identical files across the installed apps and systems.
+ *
+ * The store is a directory of hard links, named after the content of the files they point to
+ * (OBJSTORE_PATH/<xx>/<size>-<content CRC>-<attributes CRC>). When a tree is added to the store,
+ * each of its files that is identical to an object, including its permissions, owner and extended
+ * attributes (e.g., SMACK label, IMA signature), is replaced by a hard link to that object. The
+ * other files become new objects.
+ *
+ * The link count of an object is the number of installed files sharing it, plus one for the store
+ * itself. Once the apps and systems using an object are removed, only the store's link is left and
+ * the object is garbage collected.
+ *
+ * @warning Only trees that are never modified once installed may be added to the store, since
+ *          their files are shared.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_UPDATE_DAEMON_OBJ_STORE_H_INCLUDE_GUARD
+#define LEGATO_UPDATE_DAEMON_OBJ_STORE_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory of the object store. It must be in the same file system as the apps and systems.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef OBJSTORE_PATH
+#define OBJSTORE_PATH   "/legato/objects"
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics of an object store operation.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t fileCount;       ///< # of files looked at.
+    size_t linkedCount;     ///< # of files replaced by a link to an existing object.
+    size_t newCount;        ///< # of files that became new objects.
+    uint64_t bytesSaved;    ///< # of bytes freed by sharing or removing objects.
+}
+objStore_Stats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add the files of a tree to the object store, sharing the files that are already in it.
+ *
+ * Failing to share a file isn't an error: the file is left as is.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the tree couldn't be walked.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t objStore_AddTree
+(
+    const char* dirPath,            ///< [IN] Root of the tree.
+    objStore_Stats_t* statsPtr      ///< [OUT] Statistics (can be NULL).
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove the objects that aren't used by any installed file anymore.
+ */
+//--------------------------------------------------------------------------------------------------
+void objStore_CollectGarbage
+(
+    objStore_Stats_t* statsPtr      ///< [OUT] Statistics (can be NULL).
+);
+
+
+#endif // LEGATO_UPDATE_DAEMON_OBJ_STORE_H_INCLUDE_GUARD
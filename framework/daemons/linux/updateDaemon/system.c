@@ -23,6 +23,7 @@
 #include "sysPaths.h"
 #include "sysStatus.h"
 #include "smack.h"
+#include "objStore.h"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -114,6 +115,15 @@ const char* system_CurrentAppsDir = CURRENT_SYSTEM_PATH "/apps";
 static const char* CurrentAppsWriteableDir = CURRENT_SYSTEM_PATH "/appsWriteable";
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directories of a system that are never modified once it is installed, so their files can be
+ * shared with other systems.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const char* ReadOnlySystemDirs[] = { "bin", "lib" };
+
+
 // People should really use the const variables, so undefine the macros.
 #undef UNPACK_BASE_PATH
 
@@ -282,6 +292,33 @@ static void SetSystemFilesPermissions
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Share the read-only files of a system with the other installed systems, once its files have
+ * their final permissions.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddSystemToObjStore
+(
+    const char* systemPath          ///< [IN] Path to the system.
+)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(ReadOnlySystemDirs); i++)
+    {
+        char path[LIMIT_MAX_PATH_BYTES] = "";
+
+        if (   (le_path_Concat("/", path, sizeof(path), systemPath, ReadOnlySystemDirs[i], NULL)
+                == LE_OK)
+            && le_dir_IsDir(path))
+        {
+            objStore_AddTree(path, NULL);
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a given system's index.
@@ -744,6 +781,8 @@ le_result_t system_FinishUpdate
     // path to some index.
     SetSystemFilesPermissions(system_UnpackPath);
 
+    AddSystemToObjStore(system_UnpackPath);
+
     // Now, move the unpacked system into its index.
     char newSystemPath[100] = "";
     snprintf(newSystemPath, sizeof(newSystemPath), "%s/%d", SystemPath, currentIndex);
@@ -866,6 +905,9 @@ le_result_t system_Snapshot
         return LE_FAULT;
     }
 
+    // The snapshot's copies of the current system's files can share its objects.
+    AddSystemToObjStore(system_UnpackPath);
+
     // Atomically rename the work dir to the proper index
     char newSystemPath[100] = "";
     snprintf(newSystemPath, sizeof(newSystemPath), "%s/%d", SystemPath, currentIndex);
@@ -1057,6 +1099,9 @@ void system_RemoveUnusedApps
     }
 
     fts_close(ftsPtr);
+
+    // Now that the unused apps (and systems) are gone, so are the only users of some objects.
+    objStore_CollectGarbage(NULL);
 }
 
 
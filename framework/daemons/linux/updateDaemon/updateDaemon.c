@@ -53,6 +53,7 @@
 #include "fsSys.h"
 #include "ima.h"
 #include "file.h"
+#include "objStore.h"
 
 // Default probation period.
 #ifndef PROBATION_PERIOD
@@ -544,6 +545,9 @@ static le_result_t InstallSystemApps
                                 appMd5Hash);
                         return LE_FAULT;
                     }
+
+                    // Share its files with the other apps and systems.
+                    objStore_AddTree(appPath, NULL);
                     // We don't need to go into this directory.
                     fts_set(ftsPtr, entPtr, FTS_SKIP);
                 }
@@ -1948,18 +1952,20 @@ void le_update_RemoveProgressHandler
 
 //-------------------------------------------------------------------------------------------------
 /**
- * Starts an update.
+ * Starts a new update, or resumes an interrupted one.
  *
  * @return
  *      - LE_OK if accepted.
  *      - LE_BUSY if another update is in progress.
  *      - LE_UNSUPPORTED if Legato system is R/O.
  *      - LE_UNAVAILABLE if updates are deferred.
+ *      - LE_NOT_FOUND if resuming and there is no update to resume.
  */
 //-------------------------------------------------------------------------------------------------
-le_result_t le_update_Start
+static le_result_t StartUpdate
 (
-    int clientFd                ///<[IN] Open file descriptor from which the update can be read.
+    int clientFd,               ///<[IN] Open file descriptor from which the update can be read.
+    bool isResume               ///<[IN] true to resume an interrupted update.
 )
 {
     if (IsReadOnly)
@@ -1977,6 +1983,7 @@ le_result_t le_update_Start
     }
 
     le_result_t result;
+    uint64_t resumeOffset;
 
     // Reject updates unless IDLE.
     switch (State)
@@ -1994,6 +2001,11 @@ le_result_t le_update_Start
                 LE_WARN("Updates are deferred. Request denied.");
                 result = LE_UNAVAILABLE;
             }
+            else if (isResume && (updateUnpack_GetResumeOffset(&resumeOffset) != LE_OK))
+            {
+                LE_WARN("No interrupted update to resume. Request denied.");
+                result = LE_NOT_FOUND;
+            }
             else
             {
                 LE_INFO("Update request accepted.");
@@ -2027,15 +2039,88 @@ le_result_t le_update_Start
     fd_Close(clientFd);
 
     // Pass the readFd to the updateUnpacker module.
-    LE_DEBUG("Starting unpack");
-    updateUnpack_Start(readFd, HandleUpdateProgress);
-
     State = STATE_UNPACKING;
 
+    if (isResume)
+    {
+        LE_DEBUG("Resuming unpack from offset %" PRIu64, resumeOffset);
+        LE_ASSERT_OK(updateUnpack_Resume(readFd, HandleUpdateProgress));
+    }
+    else
+    {
+        LE_DEBUG("Starting unpack");
+        updateUnpack_Start(readFd, HandleUpdateProgress);
+    }
+
     return LE_OK;
 }
 
 
+//-------------------------------------------------------------------------------------------------
+/**
+ * Starts an update.
+ *
+ * @return
+ *      - LE_OK if accepted.
+ *      - LE_BUSY if another update is in progress.
+ *      - LE_UNSUPPORTED if Legato system is R/O.
+ *      - LE_UNAVAILABLE if updates are deferred.
+ */
+//-------------------------------------------------------------------------------------------------
+le_result_t le_update_Start
+(
+    int clientFd                ///<[IN] Open file descriptor from which the update can be read.
+)
+{
+    return StartUpdate(clientFd, false);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Resumes an interrupted update.
+ *
+ * @return
+ *      - LE_OK if accepted.
+ *      - LE_BUSY if another update is in progress.
+ *      - LE_UNSUPPORTED if Legato system is R/O.
+ *      - LE_UNAVAILABLE if updates are deferred.
+ *      - LE_NOT_FOUND if there is no update to resume.
+ */
+//-------------------------------------------------------------------------------------------------
+le_result_t le_update_Resume
+(
+    int clientFd                ///<[IN] Open file descriptor from which the rest of the update can
+                                ///<     be read.
+)
+{
+    return StartUpdate(clientFd, true);
+}
+
+
+//-------------------------------------------------------------------------------------------------
+/**
+ * Gets the offset in the update pack from which an interrupted update can be resumed.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NOT_FOUND if there is no update to resume.
+ */
+//-------------------------------------------------------------------------------------------------
+le_result_t le_update_GetResumeOffset
+(
+    uint64_t* offsetPtr         ///<[OUT] Offset of the first byte of the update pack to provide.
+)
+{
+    if (State != STATE_IDLE)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    return updateUnpack_GetResumeOffset(offsetPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function to get error code when update fails.
@@ -7,6 +7,11 @@
  *
  * This is single-threaded, event-driven code that shares the main thread's event loop.
  *
+ * Payloads are staged in a file before being unpacked, and the progress through the update pack
+ * is checkpointed as the payloads are staged and the sections are unpacked. If the update is
+ * interrupted, it can be resumed from the last checkpoint (see updateUnpack_Resume()), without
+ * reading again what was already staged.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 //--------------------------------------------------------------------------------------------------
@@ -19,11 +24,29 @@
 #include "fileDescriptor.h"
 #include "system.h"
 #include "app.h"
+#include "delta.h"
 
 
 /// An MD5 hash string is 32 characters long, plus a null terminator.
 #define MD5_STRING_BYTES 33
 
+/// Directory where the payloads are staged, and the checkpoint is kept. It must be persistent.
+#ifndef UPDATE_STAGING_PATH
+#define UPDATE_STAGING_PATH "/legato/updateStaging"
+#endif
+
+/// File the payload being received is staged in.
+#define STAGE_FILE_PATH UPDATE_STAGING_PATH "/payload"
+
+/// File holding the last checkpoint.
+#define CHECKPOINT_FILE_PATH UPDATE_STAGING_PATH "/checkpoint"
+
+/// # of payload bytes staged between checkpoints.
+#define STAGE_CHECKPOINT_BYTES (256 * 1024)
+
+/// Value identifying a checkpoint file.
+#define CHECKPOINT_MAGIC 0x55504b31
+
 /// File descriptor to read the update pack from.
 static int InputFd = -1;
 
@@ -37,8 +60,8 @@ static le_fdMonitor_Ref_t InputFdMonitor = NULL;
 /// Reference to an unpack pipeline (NULL if not unpacking).
 static pipeline_Ref_t Pipeline = NULL;
 
-/// File descriptor connected to the input of a pipeline (-1 if not unpacking)
-static int PipelineFd = -1;
+/// File descriptor of the staged payload (-1 if not staging).
+static int StageFd = -1;
 
 /// Function to be called to report progress.
 static updateUnpack_ProgressHandler_t ProgressFunc = NULL;
@@ -55,12 +78,30 @@ static char AppName[LIMIT_MAX_APP_NAME_BYTES];
 /// The MD5 hash obtained from a JSON header.
 static char Md5[MD5_STRING_BYTES]; ///< The system's MD5 hash.
 
+/// The MD5 hash of the app a delta encoded app is based on.
+static char BaseMd5[MD5_STRING_BYTES];
+
+/// Directory the current payload is unpacked into.
+static char UnpackDir[LIMIT_MAX_PATH_BYTES];
+
 /// # of bytes of payload following the JSON.
 static size_t PayloadSize;
 
-/// # of bytes of payload that have been copied to the unpack pipeline.
+/// # of bytes of payload that have been staged (or discarded).
 static size_t PayloadBytesCopied;
 
+/// # of bytes of payload that were staged at the last checkpoint.
+static size_t CheckpointedBytes;
+
+/// # of bytes of the update pack read so far, including those read before an update was resumed.
+static uint64_t PackOffset;
+
+/// # of app sections of a system update pack that have been unpacked.
+static uint32_t AppsUnpacked;
+
+/// true if the staging of the current payload is being resumed.
+static bool IsResuming;
+
 /// Percentage complete on current task.
 static unsigned int PercentDone;
 
@@ -123,6 +164,27 @@ State = STATE_IDLE;
 static le_json_ParsingSessionRef_t ParsingSession = NULL;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checkpoint of an update, from which it can be resumed.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;                             ///< CHECKPOINT_MAGIC.
+    uint32_t type;                              ///< Type of update pack.
+    uint64_t packOffset;                        ///< Offset to resume the update pack from.
+    uint64_t payloadSize;                       ///< Size of the payload being staged, or 0.
+    uint64_t stagedBytes;                       ///< # of bytes of the payload staged.
+    uint32_t appsUnpacked;                      ///< # of app sections of a system unpacked.
+    char command[32];                           ///< Section header fields.
+    char appName[LIMIT_MAX_APP_NAME_BYTES];
+    char md5[MD5_STRING_BYTES];
+    char baseMd5[MD5_STRING_BYTES];
+}
+Checkpoint_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Delete the FD Monitor object.
@@ -176,10 +238,10 @@ static void Reset
 
         InputFd = -1;
     }
-    if (PipelineFd != -1)
+    if (StageFd != -1)
     {
-        fd_Close(PipelineFd);
-        PipelineFd = -1;
+        fd_Close(StageFd);
+        StageFd = -1;
     }
 
     // Delete the pipeline.
@@ -191,6 +253,168 @@ static void Reset
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is the current section a delta encoded app?
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsDeltaSection
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (strcmp(Command, "updateAppDelta") == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record the progress through the update pack, so that the update can be resumed from there.
+ *
+ * If a payload is being staged, the update resumes in the middle of this payload. Otherwise, it
+ * resumes at the start of the next section.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteCheckpoint
+(
+    bool inPayload  ///< true if a payload is being staged.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Checkpoint_t checkpoint;
+
+    memset(&checkpoint, 0, sizeof(checkpoint));
+    checkpoint.magic = CHECKPOINT_MAGIC;
+    checkpoint.type = Type;
+    checkpoint.packOffset = PackOffset;
+    checkpoint.appsUnpacked = AppsUnpacked;
+
+    if (inPayload)
+    {
+        checkpoint.payloadSize = PayloadSize;
+        checkpoint.stagedBytes = CheckpointedBytes;
+        checkpoint.packOffset = PackOffset - (PayloadBytesCopied - CheckpointedBytes);
+        le_utf8_Copy(checkpoint.command, Command, sizeof(checkpoint.command), NULL);
+        le_utf8_Copy(checkpoint.appName, AppName, sizeof(checkpoint.appName), NULL);
+        le_utf8_Copy(checkpoint.md5, Md5, sizeof(checkpoint.md5), NULL);
+        le_utf8_Copy(checkpoint.baseMd5, BaseMd5, sizeof(checkpoint.baseMd5), NULL);
+    }
+
+    int fd = le_atomFile_Create(CHECKPOINT_FILE_PATH,
+                                LE_FLOCK_WRITE,
+                                LE_FLOCK_REPLACE_IF_EXIST,
+                                S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        LE_WARN("Failed to create update checkpoint. The update won't be resumable.");
+        return;
+    }
+
+    if (fd_WriteSize(fd, &checkpoint, sizeof(checkpoint)) != sizeof(checkpoint))
+    {
+        LE_WARN("Failed to write update checkpoint (%m).");
+        le_atomFile_Cancel(fd);
+        return;
+    }
+
+    if (le_atomFile_Close(fd) != LE_OK)
+    {
+        LE_WARN("Failed to commit update checkpoint.");
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the checkpoint of an interrupted update.
+ *
+ * @return
+ *      - LE_OK if the update can be resumed from the checkpoint.
+ *      - LE_NOT_FOUND otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadCheckpoint
+(
+    Checkpoint_t* checkpointPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(CHECKPOINT_FILE_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    ssize_t size = fd_ReadSize(fd, checkpointPtr, sizeof(*checkpointPtr));
+    fd_Close(fd);
+
+    if (   (size != sizeof(*checkpointPtr))
+        || (checkpointPtr->magic != CHECKPOINT_MAGIC)
+        || (checkpointPtr->stagedBytes > checkpointPtr->payloadSize)
+        || (checkpointPtr->command[sizeof(checkpointPtr->command) - 1] != '\0')
+        || (checkpointPtr->appName[sizeof(checkpointPtr->appName) - 1] != '\0')
+        || (checkpointPtr->md5[sizeof(checkpointPtr->md5) - 1] != '\0')
+        || (checkpointPtr->baseMd5[sizeof(checkpointPtr->baseMd5) - 1] != '\0'))
+    {
+        LE_WARN("Ignoring invalid update checkpoint.");
+        return LE_NOT_FOUND;
+    }
+
+    // What was unpacked before the checkpoint must still be there.
+    if (checkpointPtr->type == TYPE_SYSTEM_UPDATE)
+    {
+        bool inSystemPayload = (checkpointPtr->payloadSize > 0)
+                               && (strcmp(checkpointPtr->command, "updateSystem") == 0);
+
+        if (   (!inSystemPayload && !le_dir_IsDir(system_UnpackPath))
+            || ((checkpointPtr->appsUnpacked > 0) && !le_dir_IsDir(app_UnpackPath)))
+        {
+            LE_WARN("Unpacked update was removed, it can't be resumed.");
+            return LE_NOT_FOUND;
+        }
+    }
+
+    // So must the staged payload.
+    if (checkpointPtr->stagedBytes > 0)
+    {
+        struct stat stageStat;
+
+        if (   (stat(STAGE_FILE_PATH, &stageStat) != 0)
+            || ((uint64_t)stageStat.st_size < checkpointPtr->stagedBytes))
+        {
+            LE_WARN("Staged payload is missing, the update can't be resumed.");
+            return LE_NOT_FOUND;
+        }
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the checkpoint and the staged payload, if any. The update can't be resumed anymore.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteCheckpoint
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((unlink(CHECKPOINT_FILE_PATH) != 0) && (errno != ENOENT))
+    {
+        LE_ERROR("Failed to delete '%s' (%m).", CHECKPOINT_FILE_PATH);
+    }
+
+    if ((unlink(STAGE_FILE_PATH) != 0) && (errno != ENOENT))
+    {
+        LE_ERROR("Failed to delete '%s' (%m).", STAGE_FILE_PATH);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Report progress.
@@ -238,6 +462,9 @@ static void HandleFormatError
 {
     Reset();
 
+    // There's no point resuming a bad update pack.
+    DeleteCheckpoint();
+
     // Report the error back to the client and terminate the update.
     ProgressFunc(UPDATE_UNPACK_STATUS_BAD_PACKAGE, PercentDone);
 }
@@ -283,6 +510,7 @@ static void AppUnpackDone
     {
         PercentDone = 100;
         ReportProgress();
+        DeleteCheckpoint();
         // As we allow single app, notify that unpack is done.
         ProgressFunc(UPDATE_UNPACK_STATUS_DONE, 100);
         Reset();
@@ -325,6 +553,8 @@ static void JsonErrorHandler
             // system update.
             else if (Type == TYPE_SYSTEM_UPDATE)
             {
+                DeleteCheckpoint();
+
                 ProgressFunc(UPDATE_UNPACK_STATUS_DONE, 100);
 
                 Reset();
@@ -358,6 +588,7 @@ static void StartParsing
     Command[0] = '\0';
     AppName[0] = '\0';
     Md5[0] = '\0';
+    BaseMd5[0] = '\0';
     PayloadSize = 0;
 
     // Set the state
@@ -402,6 +633,33 @@ static void UntarDone
         return;
     }
 
+    // The staged payload isn't needed anymore.
+    if ((unlink(STAGE_FILE_PATH) != 0) && (errno != ENOENT))
+    {
+        LE_WARN("Failed to delete '%s' (%m).", STAGE_FILE_PATH);
+    }
+
+    // Rebuild a delta encoded app from the installed app it is based on.
+    if (IsDeltaSection())
+    {
+        char basePath[LIMIT_MAX_PATH_BYTES] = "";
+
+        le_path_Concat("/", basePath, sizeof(basePath), "/legato/apps", BaseMd5, NULL);
+
+        le_result_t result = delta_ApplyApp(basePath, UnpackDir);
+        if (result == LE_FORMAT_ERROR)
+        {
+            LE_ERROR("Malformed update pack (invalid delta for app with MD5 sum %s).", Md5);
+            HandleFormatError();
+            return;
+        }
+        else if (result != LE_OK)
+        {
+            HandleInternalError();
+            return;
+        }
+    }
+
     // If this update pack contains changes to individual apps,
     if (Type == TYPE_APP_UPDATE)
     {
@@ -425,10 +683,15 @@ static void UntarDone
         // of the same app in the previous system.
         else
         {
+            AppsUnpacked++;
+
             PercentDone = 100;
             ReportProgress();
         }
 
+        // The update can now be resumed from the next section.
+        WriteCheckpoint(false);
+
         // There could be more after this payload, so look for another JSON header.
         StartParsing();
     }
@@ -458,6 +721,8 @@ static void SkipForwardDone
     }
     else if (Type == TYPE_SYSTEM_UPDATE)
     {
+        WriteCheckpoint(false);
+
         // There could be more after this payload, so look for another JSON header.
         StartParsing();
     }
@@ -472,17 +737,106 @@ static void SkipForwardDone
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Copy bytes from the input fd to the pipeline's input fd until the input fd's read buffer is
+ * Function that runs in the unpack pipeline's "tar" process.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int Untar
+(
+    void* param
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* unpackDir = param;
+
+    // Close all open file descriptors except for stdin, stdout, and stderr.
+    // This ensures that we don't keep copies of things like the staged payload open.
+    fd_CloseAllNonStd();
+
+    // Try bsdtar first.  If that fails, fallback to tar.
+    execl("/usr/bin/bsdtar", "bsdtar", "xjmop", "-f", "-", "-C", unpackDir, (char*)NULL);
+    execl("/bin/tar", "tar", "xjop", "-C", unpackDir, (char*)NULL);
+
+    LE_FATAL("Failed to exec tar (%m)");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flush the staged bytes to storage and record a checkpoint.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_FAULT if the staged bytes couldn't be flushed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CheckpointStage
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (fdatasync(StageFd) != 0)
+    {
+        LE_ERROR("Failed to flush staged payload (%m).");
+        return LE_FAULT;
+    }
+
+    CheckpointedBytes = PayloadBytesCopied;
+    WriteCheckpoint(true);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack the staged payload, once it is complete.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StagingDone
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CheckpointStage() != LE_OK)
+    {
+        HandleInternalError();
+        return;
+    }
+
+    if (lseek(StageFd, 0, SEEK_SET) != 0)
+    {
+        LE_ERROR("Failed to rewind staged payload (%m).");
+        HandleInternalError();
+        return;
+    }
+
+    // Create a pipeline: staged payload -> tar
+    Pipeline = pipeline_Create();
+    pipeline_SetInput(Pipeline, StageFd);
+    pipeline_Append(Pipeline, Untar, UnpackDir);
+    pipeline_Start(Pipeline, UntarDone);
+
+    // The pipeline has its own copy of the fd.
+    fd_Close(StageFd);
+    StageFd = -1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy bytes from the input fd to the staged payload until the input fd's read buffer is
  * empty or we have copied all the payload bytes.
  */
 //--------------------------------------------------------------------------------------------------
-static void CopyBytesToPipeline
+static void CopyBytesToStage
 (
     void
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char buffer[1024];
+    char buffer[4096];
 
     // Keep copying as much as we can until we've copied all the payload.
     while (PayloadBytesCopied < PayloadSize)
@@ -532,7 +886,7 @@ static void CopyBytesToPipeline
         ssize_t writeResult;
         do
         {
-            writeResult = write(PipelineFd, buffer + bytesWritten, readResult - bytesWritten);
+            writeResult = write(StageFd, buffer + bytesWritten, readResult - bytesWritten);
 
             // If some bytes were written, remember how many bytes, so we don't try to write the
             // same bytes again if we have more to write.
@@ -553,20 +907,26 @@ static void CopyBytesToPipeline
 
         // Update the static progress variables and report progress to the client.
         PayloadBytesCopied += readResult;
+        PackOffset += readResult;
         PercentDone = (100 * PayloadBytesCopied) / PayloadSize;
         ReportProgress();
+
+        if (   (PayloadBytesCopied < PayloadSize)
+            && (PayloadBytesCopied - CheckpointedBytes >= STAGE_CHECKPOINT_BYTES)
+            && (CheckpointStage() != LE_OK))
+        {
+            goto error;
+        }
     }
 
-    // If we have copied all the payload bytes to the pipeline's input, then we can stop
-    // monitoring the input fd now, close the pipeline input write pipe, and wait for the pipeline
-    // completion callback (UntarDone()).
-    LE_INFO("Payload copied: %zu/%zu", PayloadBytesCopied, PayloadSize);
+    // If we have staged all the payload bytes, then we can stop monitoring the input fd now,
+    // and unpack the staged payload. The pipeline completion callback is UntarDone().
+    LE_INFO("Payload staged: %zu/%zu", PayloadBytesCopied, PayloadSize);
     LE_ASSERT(PayloadBytesCopied <= PayloadSize);
     if (PayloadBytesCopied == PayloadSize)
     {
         DeleteFdMonitor();
-        fd_Close(PipelineFd);
-        PipelineFd = -1;
+        StagingDone();
     }
     return;
 
@@ -636,6 +996,7 @@ static void DiscardPayloadBytes
 
         // Update the static progress variables and report progress to the client.
         PayloadBytesCopied += readResult;
+        PackOffset += readResult;
         PercentDone = (100 * PayloadBytesCopied) / PayloadSize;
         ReportProgress();
     }
@@ -668,7 +1029,7 @@ static void InputFdEventHandler
     {
         if (State == STATE_UNPACKING_PAYLOAD)
         {
-            CopyBytesToPipeline();
+            CopyBytesToStage();
         }
         else if (State == STATE_SKIPPING_PAYLOAD)
         {
@@ -689,49 +1050,49 @@ static void InputFdEventHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Function that runs in the unpack pipeline's "tar" process.
- **/
+ * Start staging a payload, to unpack it once it is complete.
+ */
 //--------------------------------------------------------------------------------------------------
-static int Untar
+static void StartStaging
 (
-    void* param
+    const char* dirPath ///< Path to the directory to unpack the payload into.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    const char* unpackDir = param;
-
-    // Close all open file descriptors except for stdin, stdout, and stderr.
-    // This ensures that we don't keep copies of things like the pipeline input write pipe open.
-    fd_CloseAllNonStd();
-
-    // Try bsdtar first.  If that fails, fallback to tar.
-    execl("/usr/bin/bsdtar", "bsdtar", "xjmop", "-f", "-", "-C", unpackDir, (char*)NULL);
-    execl("/bin/tar", "tar", "xjop", "-C", unpackDir, (char*)NULL);
+    State = STATE_UNPACKING_PAYLOAD;
 
-    LE_FATAL("Failed to exec tar (%m)");
-}
+    le_utf8_Copy(UnpackDir, dirPath, sizeof(UnpackDir), NULL);
 
+    // When resuming, keep what was staged before the checkpoint.
+    if (!IsResuming)
+    {
+        CheckpointedBytes = 0;
+    }
+    IsResuming = false;
+    PayloadBytesCopied = CheckpointedBytes;
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Start unpacking a tarball.
- */
-//--------------------------------------------------------------------------------------------------
-static void StartUntar
-(
-    const char* dirPath ///< Path to the directory to unpack the tarball into.
-)
-//--------------------------------------------------------------------------------------------------
-{
-    State = STATE_UNPACKING_PAYLOAD;
+    StageFd = open(STAGE_FILE_PATH, O_WRONLY | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (StageFd < 0)
+    {
+        LE_ERROR("Failed to open '%s' (%m).", STAGE_FILE_PATH);
+        HandleInternalError();
+        return;
+    }
 
-    PayloadBytesCopied = 0;
+    if (   (ftruncate(StageFd, CheckpointedBytes) != 0)
+        || (lseek(StageFd, CheckpointedBytes, SEEK_SET) != (off_t)CheckpointedBytes))
+    {
+        LE_ERROR("Failed to prepare '%s' (%m).", STAGE_FILE_PATH);
+        HandleInternalError();
+        return;
+    }
 
-    // Create a pipeline: PipelineFd -> tar
-    Pipeline = pipeline_Create();
-    PipelineFd = pipeline_CreateInputPipe(Pipeline);
-    pipeline_Append(Pipeline, Untar, (void*)dirPath);
-    pipeline_Start(Pipeline, UntarDone);
+    // The payload could have been fully staged before the update was interrupted.
+    if (PayloadBytesCopied == PayloadSize)
+    {
+        StagingDone();
+        return;
+    }
 
     fd_SetNonBlocking(InputFd);
 
@@ -753,7 +1114,15 @@ static void StartSkipForward
 {
     State = STATE_SKIPPING_PAYLOAD;
 
-    PayloadBytesCopied = 0;
+    // When resuming, the input starts after what was staged before the checkpoint.
+    PayloadBytesCopied = (IsResuming ? CheckpointedBytes : 0);
+    IsResuming = false;
+
+    if (PayloadBytesCopied == PayloadSize)
+    {
+        SkipForwardDone();
+        return;
+    }
 
     fd_SetNonBlocking(InputFd);
 
@@ -844,12 +1213,12 @@ static void JsonDone
             // Delete any old unpack junk from previous incomplete/failed updates.
             system_PrepUnpackDir();
 
-            // Unpack the system tarball.
+            // Stage and unpack the system tarball.
             // This is asynchronous and will call UntarDone() when finished.
-            StartUntar(system_UnpackPath);
+            StartStaging(system_UnpackPath);
         }
     }
-    else if (strcmp(Command, "updateApp") == 0)
+    else if ((strcmp(Command, "updateApp") == 0) || IsDeltaSection())
     {
         if (Type == TYPE_FIRMWARE_UPDATE)
         {
@@ -872,6 +1241,16 @@ static void JsonDone
             LE_ERROR("Malformed update pack (app update payload missing)");
             HandleFormatError();
         }
+        else if (IsDeltaSection() && (BaseMd5[0] == '\0'))
+        {
+            LE_ERROR("Malformed update pack (base app's MD5 hash missing from app delta section)");
+            HandleFormatError();
+        }
+        else if (IsDeltaSection() && !app_Exists(Md5) && !app_Exists(BaseMd5))
+        {
+            LE_ERROR("Malformed update pack (base app with MD5 sum %s isn't installed)", BaseMd5);
+            HandleFormatError();
+        }
         else
         {
             if (Type == TYPE_UNKNOWN)
@@ -896,9 +1275,9 @@ static void JsonDone
                     // UnpackPath = appUnpack_Path
                     // Prepare the directory to unpack into.
                     app_PrepUnpackDir();
-                    // Unpack the app tarball.
+                    // Stage and unpack the app tarball.
                     // This is asynchronous and will call UntarDone() when finished.
-                    StartUntar(app_UnpackPath);
+                    StartStaging(app_UnpackPath);
                 }
                 else
                 {
@@ -912,8 +1291,8 @@ static void JsonDone
                     LE_FATAL_IF(LE_OK != le_dir_MakePath(unpackPath, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH),
                                 "Failed to create directory '%s'.",
                                 unpackPath);
-                    // Untar the app tarball. Will call UntarDone() when finished.
-                    StartUntar(unpackPath);
+                    // Stage and untar the app tarball. Will call UntarDone() when finished.
+                    StartStaging(unpackPath);
                 }
 
             }
@@ -1068,6 +1447,21 @@ static void Md5EventHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * "base" member parsing event function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BaseMd5EventHandler
+(
+    le_json_Event_t event
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StringMemberEventHandler(event, BaseMd5, sizeof(BaseMd5), "base MD5 hash");
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * "version" member parsing event function.
@@ -1163,6 +1557,9 @@ static void JsonEventHandler
 
         case LE_JSON_DOC_END:
 
+            // Keep track of where the payload starts in the update pack.
+            PackOffset += le_json_GetBytesRead(le_json_GetSession());
+
             // Confirm we have everything we need and move to the APPLYING state.
             JsonDone();
             break;
@@ -1183,6 +1580,10 @@ static void JsonEventHandler
             {
                 le_json_SetEventHandler(NameEventHandler);
             }
+            else if (strcmp(memberName, "base") == 0)
+            {
+                le_json_SetEventHandler(BaseMd5EventHandler);
+            }
             else if (strcmp(memberName, "version") == 0)
             {
                 le_json_SetEventHandler(VersionEventHandler);
@@ -1241,11 +1642,120 @@ void updateUnpack_Start
     ProgressFunc(UPDATE_UNPACK_STATUS_UNPACKING, 0);
 
     Type = TYPE_UNKNOWN;
+    PackOffset = 0;
+    AppsUnpacked = 0;
+    IsResuming = false;
+
+    // A new update replaces any interrupted one.
+    if (le_dir_MakePath(UPDATE_STAGING_PATH, S_IRWXU) != LE_OK)
+    {
+        LE_WARN("Failed to create '%s'. The update won't be resumable.", UPDATE_STAGING_PATH);
+    }
+    DeleteCheckpoint();
 
     StartParsing();
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the offset in the update pack an interrupted update can be resumed from.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NOT_FOUND if there is no update to resume.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t updateUnpack_GetResumeOffset
+(
+    uint64_t* offsetPtr     ///< [OUT] Offset of the first byte of the update pack to provide.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Checkpoint_t checkpoint;
+
+    if ((State != STATE_IDLE) || (ReadCheckpoint(&checkpoint) != LE_OK))
+    {
+        return LE_NOT_FOUND;
+    }
+
+    *offsetPtr = checkpoint.packOffset;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resume an interrupted update.
+ *
+ * Reads the rest of the update pack, starting from the offset returned by
+ * updateUnpack_GetResumeOffset(), from a given file descriptor.
+ *
+ * Calls a callback function to report progress.
+ *
+ * @return
+ *      - LE_OK if the update is resumed.
+ *      - LE_NOT_FOUND if there is no update to resume. The fd isn't used.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t updateUnpack_Resume
+(
+    int fd,             ///< File descriptor to read the rest of the update pack from.
+    updateUnpack_ProgressHandler_t progressFunc  ///< Progress reporting callback.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(State == STATE_IDLE);
+
+    Checkpoint_t checkpoint;
+
+    if (ReadCheckpoint(&checkpoint) != LE_OK)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    InputFd = fd;
+    InputFdClosed = false;
+    ProgressFunc = progressFunc;
+    PercentDone = 0;
+
+    ProgressFunc(UPDATE_UNPACK_STATUS_UNPACKING, 0);
+
+    Type = (updateUnpack_Type_t)checkpoint.type;
+    PackOffset = checkpoint.packOffset;
+    AppsUnpacked = checkpoint.appsUnpacked;
+
+    LE_INFO("Resuming update from offset %" PRIu64 ".", PackOffset);
+
+    if (checkpoint.payloadSize == 0)
+    {
+        // Resume at the start of the next section.
+        StartParsing();
+        return LE_OK;
+    }
+
+    // Resume in the middle of a payload, as if its section header had just been parsed.
+    le_utf8_Copy(Command, checkpoint.command, sizeof(Command), NULL);
+    le_utf8_Copy(AppName, checkpoint.appName, sizeof(AppName), NULL);
+    le_utf8_Copy(Md5, checkpoint.md5, sizeof(Md5), NULL);
+    le_utf8_Copy(BaseMd5, checkpoint.baseMd5, sizeof(BaseMd5), NULL);
+    PayloadSize = checkpoint.payloadSize;
+    CheckpointedBytes = checkpoint.stagedBytes;
+    IsResuming = true;
+
+    // The first section of a pack sets its type.
+    if ((Type != TYPE_SYSTEM_UPDATE) || (strcmp(Command, "updateSystem") == 0))
+    {
+        Type = TYPE_UNKNOWN;
+    }
+
+    JsonDone();
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the type of the update pack (available when 100% done).
@@ -71,6 +71,38 @@ void updateUnpack_Start
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the offset in the update pack an interrupted update can be resumed from.
+ *
+ * @return
+ *      - LE_OK on success.
+ *      - LE_NOT_FOUND if there is no update to resume.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t updateUnpack_GetResumeOffset
+(
+    uint64_t* offsetPtr     ///< [OUT] Offset of the first byte of the update pack to provide.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resume an interrupted update, reading the rest of the update pack from a given file descriptor,
+ * starting at the offset returned by updateUnpack_GetResumeOffset().
+ *
+ * @return
+ *      - LE_OK if the update is resumed.
+ *      - LE_NOT_FOUND if there is no update to resume. The fd isn't used.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t updateUnpack_Resume
+(
+    int fd,             ///< File descriptor to read the rest of the update pack from.
+    updateUnpack_ProgressHandler_t progressHandler  ///< Progress reporting callback.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the type of the update pack (available when 100% done).
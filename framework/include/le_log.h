@@ -314,8 +314,9 @@ Jan  3 02:37:56  INFO  | processName[pid]/componentName T=threadName | fileName.
  *
  * @section c_log_debugFiles App Crash Logs
 
-* When a process within an app faults or exits in error, a copy of the current syslog buffer
-* is captured along with a core file of the process crash (if generated).
+* When a process within an app faults or exits in error, the Supervisor saves a copy of the end of
+* the current syslog buffer along with a core file of the process crash (if generated).  This is
+* done in the background, so the process is restarted without waiting for it.
 
 * The core file maximum size is determined by the process settings @c maxCoreDumpFileBytes and
 * @c maxFileBytes found in the processes section of your app's @c .adef file.  By default, the
@@ -331,11 +332,17 @@ Jan  3 02:37:56  INFO  | processName[pid]/componentName T=threadName | fileName.
 * The files in that directory look like this:
 
  @verbatim
- core-myProc-1418694851
- syslog-myApp-myProc-1418694851
+ core-myApp-myProc-1418694851.gz
+ syslog-myApp-myProc-1418694851.gz
  @endverbatim
 
-* To save on RAM space, only the most recent 4 copies of each file are preserved.
+* They are gzip compressed on targets that build with @c LEGATO_FEATURE_COMPRESSED_CAPTURES (which
+* needs zlib), and have no @c .gz suffix on other targets.
+
+* To save on RAM space, only the most recent 4 copies of each file are preserved, and older copies
+* are deleted when the files take up more than 4 MB.  The latest copy of each file is always
+* preserved.  If an app keeps crashing, crashes that happen more than 4 times a minute are not
+* captured.
 
 * If the fault action for that app's process is to reboot the target, the output location is changed to
 * this (and the most recent files in RAM space are preserved across reboots):
@@ -70,6 +70,18 @@
  * that currently exist inside a given process.  The state of each mutex can be
  * seen, including a list of any threads that might be waiting for that mutex.
  *
+ * @section c_mutex_profiling Contention Profiling
+ *
+ * If the environment variable @c LE_MUTEX_PROFILE is set to @c 1 when a process starts, every
+ * mutex of that process counts how many times it is locked, and how many of those times the
+ * lock had to be waited for.  A histogram of the wait times is kept too, along with the name of
+ * the thread that last held the mutex while other threads were waiting for it.
+ *
+ * These profiles are shown by @ref toolsTarget_inspect "inspect locks".
+ *
+ * Profiling makes every unlock take an extra internal lock, so it should only be enabled while
+ * investigating contention.
+ *
  * <HR>
  *
  * Copyright (C) Sierra Wireless Inc.
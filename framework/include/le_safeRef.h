@@ -54,7 +54,9 @@
  * A <b> Reference Map </b> object can be used to create Safe References and keep track of the
  * mappings from Safe References to pointers.  At start-up, a Reference Map is
  * created by calling @c le_ref_CreateMap().  It takes a single argument, the maximum number
- * of mappings expected to track of at any time.
+ * of mappings expected to track of at any time.  The map grows if more are needed.
+ *
+ * Creating, looking up and deleting a Safe Reference take constant time.
  *
  * @section c_safeRef_multithreading Multithreading
  *
@@ -265,7 +267,7 @@ void le_ref_DeleteRef
  * per map, and calling this function resets the iterator position to the start of the map.  The
  * iterator is not ready for data access until le_ref_NextNode() has been called at least once.
  *
- * @return  Returns A reference to a hashmap iterator which is ready for le_hashmap_NextNode() to be
+ * @return  Returns A reference to the map's iterator, which is ready for le_ref_NextNode() to be
  *          called on it.
  */
 //--------------------------------------------------------------------------------------------------
@@ -279,9 +281,11 @@ le_ref_IterRef_t le_ref_GetIterator
 /**
  * Moves the iterator to the next key/value pair in the map.
  *
+ * References may be created and deleted while iterating: the ones created may or may not be
+ * visited, and the ones deleted are not visited.
+ *
  * @return  Returns LE_OK unless you go past the end of the map, then returns LE_NOT_FOUND.
- *          If the iterator has been invalidated by the map changing or you have previously
- *          received a LE_NOT_FOUND then this returns LE_FAULT.
+ *          If you have previously received a LE_NOT_FOUND then this returns LE_FAULT.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t le_ref_NextNode
@@ -293,8 +297,8 @@ le_result_t le_ref_NextNode
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves a pointer to the safe ref iterator is currently pointing at.  If the iterator has just
- * been initialized and le_hashmap_NextNode() has not been called, or if the iterator has been
- * invalidated then this will return NULL.
+ * been initialized and le_ref_NextNode() has not been called, or if the reference has been
+ * deleted since, then this will return NULL.
  *
  * @return  A pointer to the current key, or NULL if the iterator has been invalidated or is not ready.
  *
@@ -309,8 +313,8 @@ const void* le_ref_GetSafeRef
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves a pointer to the value which the iterator is currently pointing at.  If the iterator
- * has just been initialized and le_ref_NextNode() has not been called, or if the iterator has been
- * invalidated then this will return NULL.
+ * has just been initialized and le_ref_NextNode() has not been called, or if the reference has
+ * been deleted since, then this will return NULL.
  *
  * @return  A pointer to the current value, or NULL if the iterator has been invalidated or is not
  *          ready.
@@ -0,0 +1,284 @@
+/**
+ * @page c_workQueue Work Queue API
+ *
+ * @ref le_workQueue.h "API Reference"
+ *
+ * <HR>
+ *
+ * This API runs short pieces of work in parallel on a pool of worker threads, and hands their
+ * results back to the thread that asked for them through that thread's @ref c_eventLoop.  It
+ * replaces the thread, semaphore and queue plumbing that would otherwise have to be written each
+ * time some work has to be taken off a thread that must stay responsive.
+ *
+ * @section c_workQueue_pools Worker Pools
+ *
+ * le_workQueue_CreatePool() creates a named pool of worker threads.  A worker count of zero gives
+ * one worker per online CPU.  le_workQueue_DeletePool() stops the workers and deletes the pool.
+ *
+ * Each worker has its own queue of tasks.  Tasks submitted by a worker (i.e., by a work function)
+ * go on that worker's queue, where they are likely to find their data still in the CPU's cache.
+ * Tasks submitted by other threads are spread over the workers' queues.  A worker that runs out
+ * of tasks takes the oldest task from the queue of another worker, so no worker stays idle while
+ * there is work queued.
+ *
+ * @section c_workQueue_tasks Tasks
+ *
+ * le_workQueue_Submit() queues a work function and its context pointer, and returns a reference
+ * to the task.  The work function runs on one of the workers, and its return value is the task's
+ * result.
+ *
+ * If a completion handler is given, it is called with the task's result by the Event Loop of the
+ * thread that submitted the task, so that thread must be running its Event Loop.  The task
+ * reference stays valid until the completion handler returns.
+ *
+ * @code
+ * static void* ChecksumFile(void* contextPtr)
+ * {
+ *     const char* pathPtr = contextPtr;
+ *
+ *     // Slow work, run by a worker thread.
+ *     ...
+ *     return checksumPtr;
+ * }
+ *
+ * static void ChecksumDone
+ * (
+ *     le_workQueue_TaskRef_t taskRef,
+ *     le_result_t result,
+ *     void* resultPtr,
+ *     void* contextPtr
+ * )
+ * {
+ *     // Called by this thread's Event Loop.
+ *     if (result == LE_OK)
+ *     {
+ *         ...
+ *     }
+ * }
+ *
+ * COMPONENT_INIT
+ * {
+ *     PoolRef = le_workQueue_CreatePool("Checksum", 0);
+ *
+ *     le_workQueue_Submit(PoolRef, ChecksumFile, "/tmp/image", ChecksumDone);
+ * }
+ * @endcode
+ *
+ * If no completion handler is given, the task's result must be fetched by calling
+ * le_workQueue_Wait(), which blocks until the task is done and releases the task.  Work
+ * functions that split their work into sub-tasks must do it this way, since workers don't run an
+ * Event Loop.  A worker waiting for a task runs other queued tasks in the meantime, so it is safe
+ * for tasks to wait for each other.
+ *
+ * @section c_workQueue_cancel Cancellation
+ *
+ * le_workQueue_Cancel() removes a task from its queue if it hasn't started running yet.  Its
+ * completion handler (or le_workQueue_Wait()) then gets the result @c LE_TERMINATED.  A task that
+ * is already running can't be stopped, but it is flagged, and long running work functions can
+ * call le_workQueue_IsCancelRequested() from time to time and return early.
+ *
+ * @section c_workQueue_stats Statistics
+ *
+ * le_workQueue_GetStats() gets a pool's counts of submitted, completed, cancelled and stolen
+ * tasks, and of the tasks currently queued and running.
+ *
+ * <HR>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+//--------------------------------------------------------------------------------------------------
+/** @file le_workQueue.h
+ *
+ * Legato @ref c_workQueue include file.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_WORK_QUEUE_INCLUDE_GUARD
+#define LEGATO_WORK_QUEUE_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a pool of worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_workQueue_Pool* le_workQueue_PoolRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a task submitted to a pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_workQueue_Task* le_workQueue_TaskRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prototype of work functions, run by the pool's workers.
+ *
+ * @return The task's result, handed to the completion handler or to le_workQueue_Wait().
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void* (*le_workQueue_WorkFunc_t)
+(
+    void* contextPtr        ///< [IN] Context pointer given to le_workQueue_Submit().
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prototype of completion handlers, called by the Event Loop of the thread that submitted the
+ * task.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*le_workQueue_CompletionHandler_t)
+(
+    le_workQueue_TaskRef_t taskRef, ///< [IN] The task, which is released when the handler returns.
+    le_result_t result,             ///< [IN] LE_OK if the work function ran, LE_TERMINATED if the
+                                    ///       task was cancelled before it started.
+    void* resultPtr,                ///< [IN] Value returned by the work function, or NULL.
+    void* contextPtr                ///< [IN] Context pointer given to le_workQueue_Submit().
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics of a pool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t submitCount;           ///< Number of tasks submitted.
+    uint64_t completeCount;         ///< Number of tasks whose work function has run.
+    uint64_t cancelCount;           ///< Number of tasks cancelled before they started.
+    uint64_t stealCount;            ///< Number of tasks run by a worker other than the one they
+                                    ///  were queued on.
+    size_t queuedCount;             ///< Number of tasks currently waiting to run.
+    size_t runningCount;            ///< Number of tasks currently running.
+    size_t workerCount;             ///< Number of worker threads.
+}
+le_workQueue_Stats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a pool of worker threads.
+ *
+ * @return Reference to the pool.
+ *
+ * @note Terminates the process on failure, no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_workQueue_PoolRef_t le_workQueue_CreatePool
+(
+    const char* name,       ///< [IN] Name of the pool, also used to name its worker threads.
+    size_t workerCount      ///< [IN] Number of worker threads, or 0 for one per online CPU.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a pool of worker threads.
+ *
+ * Tasks still queued are cancelled, the tasks that are running are waited for, and the workers
+ * are stopped.
+ *
+ * @warning Must not be called by one of the pool's workers.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_workQueue_DeletePool
+(
+    le_workQueue_PoolRef_t poolRef  ///< [IN] The pool.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Submit a task to a pool.
+ *
+ * @return Reference to the task.
+ *
+ * @note If completionHandler is NULL, le_workQueue_Wait() must be called to release the task.
+ *
+ * @note Terminates the process on failure, no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_workQueue_TaskRef_t le_workQueue_Submit
+(
+    le_workQueue_PoolRef_t poolRef,                     ///< [IN] The pool.
+    le_workQueue_WorkFunc_t workFunc,                   ///< [IN] Function to run on a worker.
+    void* contextPtr,                                   ///< [IN] Passed to the work function and
+                                                        ///       to the completion handler.
+    le_workQueue_CompletionHandler_t completionHandler  ///< [IN] Handler called by the calling
+                                                        ///       thread's Event Loop when the
+                                                        ///       task is done, or NULL.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cancel a task.
+ *
+ * @return
+ *  - LE_OK if the task hadn't started, and won't run.
+ *  - LE_BUSY if the task is running.  le_workQueue_IsCancelRequested() will return true in its
+ *    work function.
+ *  - LE_DUPLICATE if the task is already done.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_workQueue_Cancel
+(
+    le_workQueue_TaskRef_t taskRef  ///< [IN] The task.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the task being run by the calling worker has been cancelled.
+ *
+ * @return true if le_workQueue_Cancel() has been called for the task, false otherwise or if the
+ *         calling thread isn't running a task.
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_workQueue_IsCancelRequested
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for a task submitted without a completion handler to be done, and release it.
+ *
+ * When called by a worker, other queued tasks are run while waiting.
+ *
+ * @return
+ *  - LE_OK if the work function ran.
+ *  - LE_TERMINATED if the task was cancelled before it started.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_workQueue_Wait
+(
+    le_workQueue_TaskRef_t taskRef, ///< [IN] The task.  It is no longer valid after this returns.
+    void** resultPtrPtr             ///< [OUT] Value returned by the work function, or NULL if the
+                                    ///        task was cancelled.  Can be NULL if not needed.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the statistics of a pool.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_workQueue_GetStats
+(
+    le_workQueue_PoolRef_t poolRef,     ///< [IN] The pool.
+    le_workQueue_Stats_t* statsPtr      ///< [OUT] The pool's statistics.
+);
+
+
+#endif // LEGATO_WORK_QUEUE_INCLUDE_GUARD
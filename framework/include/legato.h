@@ -42,6 +42,7 @@
  * @subpage c_timer <br>
  * @subpage c_test <br>
  * @subpage c_utf8 <br>
+ * @subpage c_workQueue <br>
  * @subpage c_tty
  *
  * @section cApiOverview Overview
@@ -224,6 +225,7 @@ extern "C" {
 #include "le_crc.h"
 #include "le_fs.h"
 #include "le_rand.h"
+#include "le_workQueue.h"
 
 #ifdef __cplusplus
 }
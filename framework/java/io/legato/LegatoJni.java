@@ -11,6 +11,7 @@
 package io.legato;
 
 import java.io.FileDescriptor;
+import java.nio.ByteBuffer;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -104,6 +105,8 @@ class LegatoJni {
 
 	public static native long GetSession(long messageRef);
 
+	public static native ByteBuffer GetPayloadBuffer(long messageRef);
+
 	public static native FileDescriptor GetMessageFd(long messageRef);
 
 	public static native void SetMessageFd(long messageRef, FileDescriptor fd);
@@ -10,6 +10,9 @@
 
 package io.legato;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This class represents a Legato message.
@@ -22,6 +25,11 @@ public class Message implements AutoCloseable {
 	 */
 	private long messageRef;
 
+	/**
+	 * View of the message payload, used by the buffers of this message.
+	 */
+	private ByteBuffer payload;
+
 	// ----------------------------------------------------------------------------------------------
 	/**
 	 * Package private way to construct a Message from a native reference.
@@ -43,10 +51,21 @@ public class Message implements AutoCloseable {
 	public void close() {
 		if (messageRef != 0) {
 			LegatoJni.ReleaseMessage(messageRef);
-			messageRef = 0;
+			handOff();
 		}
 	}
 
+	// ----------------------------------------------------------------------------------------------
+	/**
+	 * Forget the native message, once it has been handed over to the messaging
+	 * system, which deletes it when it's done with it.
+	 */
+	// ----------------------------------------------------------------------------------------------
+	private void handOff() {
+		messageRef = 0;
+		payload = null;
+	}
+
 	// ----------------------------------------------------------------------------------------------
 	/**
 	 * Close and free the message object and its data.
@@ -61,32 +80,39 @@ public class Message implements AutoCloseable {
 	// ----------------------------------------------------------------------------------------------
 	/**
 	 * Send this message out across the attached session. Do not wait for a
-	 * response.
+	 * response. The message can't be used afterwards.
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void send() {
 		LegatoJni.Send(messageRef);
+		handOff();
 	}
 
 	// ----------------------------------------------------------------------------------------------
 	/**
 	 * Send this message out across the attached session. This will not return until
-	 * a response has been received from the other side.
+	 * a response has been received from the other side. This message can't be
+	 * used afterwards.
 	 *
 	 * @return A message object that holds the other side's response.
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public Message requestResponse() {
-		return new Message(LegatoJni.RequestSyncResponse(messageRef));
+		long responseRef = LegatoJni.RequestSyncResponse(messageRef);
+		handOff();
+
+		return new Message(responseRef);
 	}
 
 	// ----------------------------------------------------------------------------------------------
 	/**
-	 * Reuse this message object to respond to the original query.
+	 * Reuse this message object to respond to the original query. The message
+	 * can't be used afterwards.
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void respond() {
 		LegatoJni.Respond(messageRef);
+		handOff();
 	}
 
 	// ----------------------------------------------------------------------------------------------
@@ -144,6 +170,25 @@ public class Message implements AutoCloseable {
 		return new MessageBuffer(this);
 	}
 
+	// ----------------------------------------------------------------------------------------------
+	/**
+	 * Package internal method used by the message buffers to access the payload
+	 * directly. The view is shared with later messages that use the same payload
+	 * memory, so only its absolute get and put methods should be used, or its
+	 * position set before using the relative ones.
+	 *
+	 * @return A direct byte buffer over the message payload, in the native byte
+	 *         order.
+	 */
+	// ----------------------------------------------------------------------------------------------
+	ByteBuffer getPayload() {
+		if (payload == null) {
+			payload = LegatoJni.GetPayloadBuffer(messageRef).order(ByteOrder.nativeOrder());
+		}
+
+		return payload;
+	}
+
 	// ----------------------------------------------------------------------------------------------
 	/**
 	 * Internal method, this is used to get the native reference for the underlying
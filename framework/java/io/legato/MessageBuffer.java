@@ -12,6 +12,8 @@ package io.legato;
 
 import java.io.FileDescriptor;
 import java.math.BigInteger;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -19,6 +21,9 @@ import java.math.BigInteger;
  *
  * The get and set methods act as a streaming operation. The buffer maintains an
  * internal pointer that is updated as values are read and written.
+ *
+ * The values are read and written directly in the payload memory of the message,
+ * through a direct byte buffer, rather than through a native call for each value.
  */
 // --------------------------------------------------------------------------------------------------
 public class MessageBuffer implements AutoCloseable {
@@ -27,6 +32,11 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	private Message hostMessage;
 
+	/**
+	 * View of the payload of the message.
+	 */
+	private ByteBuffer payload;
+
 	/**
 	 * The current buffer insertion location. Reads and writes start from and update
 	 * this location.
@@ -77,6 +87,7 @@ public class MessageBuffer implements AutoCloseable {
 	// ----------------------------------------------------------------------------------------------
 	MessageBuffer(Message message) {
 		hostMessage = message;
+		payload = message.getPayload();
 		location = 0;
 	}
 
@@ -88,6 +99,7 @@ public class MessageBuffer implements AutoCloseable {
 	@Override
 	public void close() {
 		hostMessage = null;
+		payload = null;
 		location = 0;
 	}
 
@@ -108,7 +120,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public boolean readBool() {
-		boolean result = LegatoJni.GetMessageBool(hostMessage.getRef(), location);
+		boolean result = payload.get(location) != 0;
 		location += 1;
 
 		return result;
@@ -123,7 +135,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void writeBool(boolean newValue) {
-		LegatoJni.SetMessageBool(hostMessage.getRef(), location, newValue);
+		payload.put(location, (byte) (newValue ? 1 : 0));
 		location += 1;
 	}
 
@@ -158,7 +170,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public byte readByte() {
-		byte result = LegatoJni.GetMessageByte(hostMessage.getRef(), location);
+		byte result = payload.get(location);
 		location += 1;
 
 		return result;
@@ -173,7 +185,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void writeByte(byte newValue) {
-		LegatoJni.SetMessageByte(hostMessage.getRef(), location, newValue);
+		payload.put(location, newValue);
 		location += 1;
 	}
 
@@ -185,7 +197,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public short readShort() {
-		short result = LegatoJni.GetMessageShort(hostMessage.getRef(), location);
+		short result = payload.getShort(location);
 		location += 2;
 
 		return result;
@@ -200,7 +212,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void writeShort(Short newValue) {
-		LegatoJni.SetMessageShort(hostMessage.getRef(), location, newValue);
+		payload.putShort(location, newValue);
 		location += 2;
 	}
 
@@ -212,7 +224,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public int readInt() {
-		int result = LegatoJni.GetMessageInt(hostMessage.getRef(), location);
+		int result = payload.getInt(location);
 		location += 4;
 
 		return result;
@@ -227,7 +239,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void writeInt(int newValue) {
-		LegatoJni.SetMessageInt(hostMessage.getRef(), location, newValue);
+		payload.putInt(location, newValue);
 		location += 4;
 	}
 
@@ -239,7 +251,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public long readLong() {
-		long result = LegatoJni.GetMessageLong(hostMessage.getRef(), location);
+		long result = payload.getLong(location);
 		location += 8;
 
 		return result;
@@ -254,7 +266,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void writeLong(long newValue) {
-		LegatoJni.SetMessageLong(hostMessage.getRef(), location, newValue);
+		payload.putLong(location, newValue);
 		location += 8;
 	}
 
@@ -266,7 +278,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public double readDouble() {
-		double result = LegatoJni.GetMessageDouble(hostMessage.getRef(), location);
+		double result = payload.getDouble(location);
 		location += 8;
 
 		return result;
@@ -281,7 +293,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void writeDouble(double newValue) {
-		LegatoJni.SetMessageDouble(hostMessage.getRef(), location, newValue);
+		payload.putDouble(location, newValue);
 		location += 8;
 	}
 
@@ -294,10 +306,14 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public String readString() {
-		LocationValue result = LegatoJni.GetMessageString(hostMessage.getRef(), location);
+		byte[] bytes = new byte[payload.getInt(location)];
 
-		location += result.bytesUsed;
-		return (String) result.value;
+		// The string is preceded by its size.
+		payload.position(location + 4);
+		payload.get(bytes);
+
+		location += 4 + bytes.length;
+		return new String(bytes, StandardCharsets.UTF_8);
 	}
 
 	// ----------------------------------------------------------------------------------------------
@@ -309,7 +325,14 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public void writeString(String strValue, int maxSize) {
-		location += LegatoJni.SetMessageString(hostMessage.getRef(), location, strValue, maxSize);
+		byte[] bytes = strValue.getBytes(StandardCharsets.UTF_8);
+
+		// Always pack the string size first, and then the string itself.
+		payload.putInt(location, bytes.length);
+		payload.position(location + 4);
+		payload.put(bytes);
+
+		location += 4 + bytes.length;
 	}
 
 	// ----------------------------------------------------------------------------------------------
@@ -320,7 +343,7 @@ public class MessageBuffer implements AutoCloseable {
 	 */
 	// ----------------------------------------------------------------------------------------------
 	public long readLongRef() {
-		long result = Integer.toUnsignedLong(LegatoJni.GetMessageInt(hostMessage.getRef(), location));
+		long result = Integer.toUnsignedLong(payload.getInt(location));
 		location += 4;
 
 		return result;
@@ -339,7 +362,7 @@ public class MessageBuffer implements AutoCloseable {
 			throw new IllegalArgumentException("Illegal reference");
 		}
 
-		LegatoJni.SetMessageInt(hostMessage.getRef(), location, (int) longRef);
+		payload.putInt(location, (int) longRef);
 		location += 4;
 	}
 
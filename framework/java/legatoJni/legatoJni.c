@@ -59,46 +59,114 @@ void _HexDump
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Construct a Java object to hold onto the active connection to the logging system.
+ *  Java classes, constructors, methods and fields used by this library.  Looking these up is much
+ *  slower than using them, so they are looked up once, when the library is initialized.  The
+ *  classes that objects are created from are held as global references, as local references are
+ *  only valid until the JNI function that got them returns.
+ */
+//--------------------------------------------------------------------------------------------------
+static jclass LogHandleClassPtr;
+static jmethodID LogHandleConstructorPtr;
+static jclass SessionClassPtr;
+static jmethodID SessionConstructorPtr;
+static jclass MessageClassPtr;
+static jmethodID MessageConstructorPtr;
+static jclass FileDescriptorClassPtr;
+static jmethodID FileDescriptorConstructorPtr;
+static jfieldID FileDescriptorFdFieldPtr;
+static jclass LocationValueClassPtr;
+static jmethodID LocationValueConstructorPtr;
+static jmethodID ComponentInitMethodPtr;
+static jmethodID SessionEventHandleMethodPtr;
+static jmethodID MessageEventHandleMethodPtr;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Direct byte buffer giving Java access to the payload memory of messages.  Message payloads are
+ *  allocated from memory pools, so the same payload memory is used by message after message, and
+ *  the buffer created for one message can be reused by every later message using that memory.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    jobject bufferPtr;  ///< Global reference to the direct byte buffer.
+    size_t size;        ///< Size of the payload memory covered by the buffer.
+}
+PayloadView_t;
+
+
+/// Pool the payload views are allocated from.
+static le_mem_PoolRef_t PayloadViewPool;
+
+/// Payload views, by the address of the payload memory they cover.
+static le_hashmap_Ref_t PayloadViewMap;
+
+/// Mutex protecting the payload views, as any Java thread can get the payload of a message.
+static pthread_mutex_t PayloadViewMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Look up a Java class, and get a global reference to it that stays valid for the life of the
+ *  library.
  *
- *  @return: A new instance of a log handle object.
+ *  @return The global reference to the class.
  */
 //--------------------------------------------------------------------------------------------------
-static jobject NewLogHandle
+static jclass GetClassRef
 (
-    JNIEnv* envPtr,                    ///< [IN] The Java environment to work out of.
-    le_log_SessionRef_t logSession,    ///< [IN] The Legato log session to report on.
-    le_log_Level_t* logLevelFilterPtr  ///< [IN] THe current filter level for the logs.
+    JNIEnv* envPtr,          ///< [IN] The Java environment to work out of.
+    const char* classNamePtr ///< [IN] The name of the class to look up.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    jclass classPtr = (*envPtr)->FindClass(envPtr, "io/legato/LogHandler$LogHandle");
+    jclass localClassPtr = (*envPtr)->FindClass(envPtr, classNamePtr);
 
-    if (classPtr == NULL)
+    if (localClassPtr == NULL)
     {
         (*envPtr)->ExceptionDescribe(envPtr);
-        (*envPtr)->ExceptionClear(envPtr);
-        return NULL;
+        LE_FATAL("Java class '%s' not found.", classNamePtr);
     }
 
-    jmethodID constructorPtr = (*envPtr)->GetMethodID(envPtr,
-                                                      classPtr,
-                                                      "<init>",
-                                                      "(Lio/legato/LogHandler;JJ)V");
+    jclass classPtr = (*envPtr)->NewGlobalRef(envPtr, localClassPtr);
+    (*envPtr)->DeleteLocalRef(envPtr, localClassPtr);
 
-    if (constructorPtr == NULL)
+    return classPtr;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Look up a method of a Java class.
+ *
+ *  @return The ID of the method.
+ */
+//--------------------------------------------------------------------------------------------------
+static jmethodID GetMethodId
+(
+    JNIEnv* envPtr,          ///< [IN] The Java environment to work out of.
+    jclass classPtr,         ///< [IN] The class the method belongs to.
+    const char* namePtr,     ///< [IN] The name of the method.
+    const char* signaturePtr ///< [IN] Signature of the method.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    jmethodID methodPtr = (*envPtr)->GetMethodID(envPtr, classPtr, namePtr, signaturePtr);
+
+    if (methodPtr == NULL)
     {
         (*envPtr)->ExceptionDescribe(envPtr);
-        (*envPtr)->ExceptionClear(envPtr);
-        return NULL;
+        LE_FATAL("Java method '%s%s' not found.", namePtr, signaturePtr);
     }
 
-    return (*envPtr)->NewObject(envPtr,
-                                classPtr,
-                                constructorPtr,
-                                NULL,
-                                (jlong)(intptr_t)logSession,
-                                (jlong)(intptr_t)logLevelFilterPtr);
+    return methodPtr;
 }
 
 
@@ -106,40 +174,55 @@ static jobject NewLogHandle
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Construct a new object instance of the named Java class.  This function looks for a constructor
- *  that can take a single long parameter.  If this function fails then  an exception will be raised
- *  in the Java VM on exit from the JNI code.
+ *  Look up the method of a Java interface or abstract class, that is called on the objects
+ *  implementing it.
  *
- *  @return A new pointer to a Java object if successful, NULL if the construction fails.
+ *  @return The ID of the method.
  */
 //--------------------------------------------------------------------------------------------------
-static jobject ConstructObjectFromHandle
+static jmethodID GetInterfaceMethodId
 (
-    JNIEnv* envPtr,         ///< [IN] The Java environment to work out of.
-    const char* className,  ///< [IN] The name of the class to construct an object from.
-    jlong ref               ///< [IN] The "native" object handle to construct the class around.
+    JNIEnv* envPtr,           ///< [IN] The Java environment to work out of.
+    const char* classNamePtr, ///< [IN] The name of the interface.
+    const char* namePtr,      ///< [IN] The name of the method.
+    const char* signaturePtr  ///< [IN] Signature of the method.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // First, try to find the named class.
-    jclass classPtr = (*envPtr)->FindClass(envPtr, className);
-    if (classPtr == NULL)
-    {
-        // An exception will have been thrown now.
-        return NULL;
-    }
+    // The method ID stays valid as long as the class is loaded, and the interfaces used here can't
+    // be unloaded before this library is, so there's no need to hold on to the class.
+    jclass classPtr = GetClassRef(envPtr, classNamePtr);
+    jmethodID methodPtr = GetMethodId(envPtr, classPtr, namePtr, signaturePtr);
 
-    // Now try to find the constructor.  This will fail if the class in question does not have one
-    // that matches our requirements.
-    jmethodID constructorPtr = (*envPtr)->GetMethodID(envPtr, classPtr, "<init>", "(J)V");
-    if (constructorPtr == NULL)
-    {
-        // An exception will have been thrown now.
-        return NULL;
-    }
+    (*envPtr)->DeleteGlobalRef(envPtr, classPtr);
 
-    // Finally, create and return the new object.
-    return (*envPtr)->NewObject(envPtr, classPtr, constructorPtr, ref);
+    return methodPtr;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Construct a Java object to hold onto the active connection to the logging system.
+ *
+ *  @return: A new instance of a log handle object.
+ */
+//--------------------------------------------------------------------------------------------------
+static jobject NewLogHandle
+(
+    JNIEnv* envPtr,                    ///< [IN] The Java environment to work out of.
+    le_log_SessionRef_t logSession,    ///< [IN] The Legato log session to report on.
+    le_log_Level_t* logLevelFilterPtr  ///< [IN] THe current filter level for the logs.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (*envPtr)->NewObject(envPtr,
+                                LogHandleClassPtr,
+                                LogHandleConstructorPtr,
+                                NULL,
+                                (jlong)(intptr_t)logSession,
+                                (jlong)(intptr_t)logLevelFilterPtr);
 }
 
 
@@ -159,21 +242,7 @@ static jobject CreateFileDescriptor
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Find the java class.
-    jclass descriptorClassPtr = (*envPtr)->FindClass(envPtr, "java/io/FileDescriptor");
-    if (descriptorClassPtr == NULL)
-    {
-        return NULL;
-    }
-
-    // Look for and invoke the constructor that can take a descriptor.
-    jmethodID constructorPtr = (*envPtr)->GetMethodID(envPtr, descriptorClassPtr, "<init>", "(I)V");
-    if (constructorPtr == NULL)
-    {
-        return NULL;
-    }
-
-    return (*envPtr)->NewObject(envPtr, descriptorClassPtr, constructorPtr, fd);
+    return (*envPtr)->NewObject(envPtr, FileDescriptorClassPtr, FileDescriptorConstructorPtr, fd);
 }
 
 
@@ -193,17 +262,7 @@ static int ExtractFd
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Get the class for the descriptor and lookup the fd field.  Once that's done, read the field
-    // and return the value to the caller.
-    jclass descriptorClassPtr = (*envPtr)->GetObjectClass(envPtr, fileDescriptorPtr);
-
-    jfieldID fdFieldPtr = (*envPtr)->GetFieldID(envPtr, descriptorClassPtr, "fd", "I");
-    if (fdFieldPtr == NULL)
-    {
-        return -1;
-    }
-
-    return (*envPtr)->GetIntField(envPtr, fileDescriptorPtr, fdFieldPtr);
+    return (*envPtr)->GetIntField(envPtr, fileDescriptorPtr, FileDescriptorFdFieldPtr);
 }
 
 
@@ -211,38 +270,27 @@ static int ExtractFd
 
 //--------------------------------------------------------------------------------------------------
 /**
- *  Function used on event callback objects.  This will take the given Java object and lookup it's
- *  "handle" method.  Once that's done, it'll take the given object parameter and pass it along to
- *  the Java method on the object.
+ *  Function used on event callback objects.  This will call the given "handle" method of the given
+ *  Java object, passing it the given object parameter.
  */
 //--------------------------------------------------------------------------------------------------
 static void CallHandleMethod
 (
-    JNIEnv* envPtr,               ///< [IN] The Java environment to work out of.
-    jobject objectPtr,            ///< [IN] The object we're calling a method on.
-    const char* methodSignature,  ///< [IN] Signature of the method we're about to lookup.
-    jobject parameterPtr          ///< [IN] The parameter we're passing to the object.
+    JNIEnv* envPtr,         ///< [IN] The Java environment to work out of.
+    jobject objectPtr,      ///< [IN] The object we're calling a method on.
+    jmethodID handlerIdPtr, ///< [IN] The handle method of the interface the object implements.
+    jobject parameterPtr    ///< [IN] The parameter we're passing to the object.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    jclass eventClass = (*envPtr)->GetObjectClass(envPtr, objectPtr);
-    if (eventClass == NULL)
-    {
-        (*envPtr)->ExceptionDescribe(envPtr);
-        return;
-    }
+    (*envPtr)->CallVoidMethod(envPtr, objectPtr, handlerIdPtr, parameterPtr);
 
-    jmethodID handerIdPtr = (*envPtr)->GetMethodID(envPtr,
-                                                   eventClass,
-                                                   "handle",
-                                                   methodSignature);
-    if (handerIdPtr == NULL)
+    // Don't let an exception thrown by the handler stay pending while we go back to the event loop.
+    if ((*envPtr)->ExceptionOccurred(envPtr) != NULL)
     {
         (*envPtr)->ExceptionDescribe(envPtr);
-        return;
+        (*envPtr)->ExceptionClear(envPtr);
     }
-
-    (*envPtr)->CallVoidMethod(envPtr, objectPtr, handerIdPtr, parameterPtr);
 }
 
 
@@ -266,19 +314,33 @@ static void SessionEventHandler
     jint rs = (*JvmPtr)->AttachCurrentThread(JvmPtr, (void**)&envPtr, NULL);
     LE_ASSERT(rs == JNI_OK);
 
+    // The event loop runs inside a native method that doesn't return, so the local references
+    // created here have to be freed explicitly, or they would pile up for the life of the program.
+    if ((*envPtr)->PushLocalFrame(envPtr, 1) != 0)
+    {
+        (*envPtr)->ExceptionDescribe(envPtr);
+        (*envPtr)->ExceptionClear(envPtr);
+        return;
+    }
+
     // Now, construct a session object from the reference.
-    jobject sessionPtr = ConstructObjectFromHandle(envPtr,
-                                                   "io/legato/Session",
-                                                   (jlong)(intptr_t)sessionRef);
+    jobject sessionPtr = (*envPtr)->NewObject(envPtr,
+                                              SessionClassPtr,
+                                              SessionConstructorPtr,
+                                              (jlong)(intptr_t)sessionRef);
     if (sessionPtr == NULL)
     {
         (*envPtr)->ExceptionDescribe(envPtr);
-        return;
+        (*envPtr)->ExceptionClear(envPtr);
+    }
+    else
+    {
+        // Finally pass the new session object to the handler object's handle method.
+        jobject handlerObjPtr = (jobject)contextPtr;
+        CallHandleMethod(envPtr, handlerObjPtr, SessionEventHandleMethodPtr, sessionPtr);
     }
 
-    // Finally pass the new session object to the handler object's handle method.
-    jobject handlerObjPtr = (jobject)contextPtr;
-    CallHandleMethod(envPtr, handlerObjPtr, "(Ljava/lang/Object;)V", sessionPtr);
+    (*envPtr)->PopLocalFrame(envPtr, NULL);
 }
 
 
@@ -302,19 +364,32 @@ static void SessionReceiveHandler
     jint rs = (*JvmPtr)->AttachCurrentThread(JvmPtr, (void**)&envPtr, NULL);
     LE_ASSERT(rs == JNI_OK);
 
+    // As in SessionEventHandler(), free the local references once the handler is done.
+    if ((*envPtr)->PushLocalFrame(envPtr, 1) != 0)
+    {
+        (*envPtr)->ExceptionDescribe(envPtr);
+        (*envPtr)->ExceptionClear(envPtr);
+        return;
+    }
+
     // Construct a Java message object wrapper for the handle we received.
-    jobject messagePtr = ConstructObjectFromHandle(envPtr,
-                                                   "io/legato/Message",
-                                                   (jlong)(intptr_t)msgRef);
+    jobject messagePtr = (*envPtr)->NewObject(envPtr,
+                                              MessageClassPtr,
+                                              MessageConstructorPtr,
+                                              (jlong)(intptr_t)msgRef);
     if (messagePtr == NULL)
     {
         (*envPtr)->ExceptionDescribe(envPtr);
-        return;
+        (*envPtr)->ExceptionClear(envPtr);
+    }
+    else
+    {
+        // Now call the handle method with this message object.
+        jobject handlerObjPtr = (jobject)contextPtr;
+        CallHandleMethod(envPtr, handlerObjPtr, MessageEventHandleMethodPtr, messagePtr);
     }
 
-    // Now call the handle method with this message object.
-    jobject handlerObjPtr = (jobject)contextPtr;
-    CallHandleMethod(envPtr, handlerObjPtr, "(Lio/legato/Message;)V", messagePtr);
+    (*envPtr)->PopLocalFrame(envPtr, NULL);
 }
 
 
@@ -338,34 +413,8 @@ static void InternalComponentInit
     jint rs = (*JvmPtr)->AttachCurrentThread(JvmPtr, (void**)&envPtr, NULL);
     LE_ASSERT(rs == JNI_OK);
 
-    // Find the component interface.
-    jclass componentInterfacePtr = (*envPtr)->FindClass(envPtr, "io/legato/Component");
-    if (componentInterfacePtr == NULL)
-    {
-        // TODO: Log exception.
-        (*envPtr)->ExceptionDescribe(envPtr);
-        (*envPtr)->ExceptionClear(envPtr);
-        (*envPtr)->DeleteGlobalRef(envPtr, componentPtr);
-        return;
-    }
-
-    // Find the init method on the component interface.
-    jmethodID initMethodPtr = (*envPtr)->GetMethodID(envPtr,
-                                                     componentInterfacePtr,
-                                                     "componentInit",
-                                                     "()V");
-
-    if (initMethodPtr == NULL)
-    {
-        // TODO: Log exception.
-        (*envPtr)->ExceptionDescribe(envPtr);
-        (*envPtr)->ExceptionClear(envPtr);
-        (*envPtr)->DeleteGlobalRef(envPtr, componentPtr);
-        return;
-    }
-
-    // Finally call the init method, and free our reference to the object.
-    (*envPtr)->CallVoidMethod(envPtr, componentPtr, initMethodPtr);
+    // Call the init method, and free our reference to the object.
+    (*envPtr)->CallVoidMethod(envPtr, componentPtr, ComponentInitMethodPtr);
 
     if ((*envPtr)->ExceptionOccurred(envPtr) != NULL)
     {
@@ -394,29 +443,12 @@ static jobject NewLocationValue
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Look up the class info, and find it's constructor.
-    jclass classPtr = (*envPtr)->FindClass(envPtr, "io/legato/MessageBuffer$LocationValue");
-    if (classPtr == NULL)
-    {
-        (*envPtr)->ExceptionDescribe(envPtr);
-        (*envPtr)->ExceptionClear(envPtr);
-        return NULL;
-    }
-
-    jmethodID constructorPtr =
-                          (*envPtr)->GetMethodID(envPtr,
-                                                 classPtr,
-                                                 "<init>",
-                                                 "(Lio/legato/MessageBuffer;ILjava/lang/Object;)V");
-    if (constructorPtr == NULL)
-    {
-        (*envPtr)->ExceptionDescribe(envPtr);
-        (*envPtr)->ExceptionClear(envPtr);
-        return NULL;
-    }
-
-    // Now construct the new object, and call the constructor we picked out.
-    return (*envPtr)->NewObject(envPtr, classPtr, constructorPtr, parentPtr, byteSize, valuePtr);
+    return (*envPtr)->NewObject(envPtr,
+                                LocationValueClassPtr,
+                                LocationValueConstructorPtr,
+                                parentPtr,
+                                byteSize,
+                                valuePtr);
 }
 
 
@@ -439,8 +471,50 @@ JNIEXPORT void JNICALL Java_io_legato_LegatoJni_Init
     jint rs = (*envPtr)->GetJavaVM(envPtr, &JvmPtr);
     LE_ASSERT(rs == JNI_OK);
 
-    // TODO: Cache required Java method IDs so that the various functions that need to call Java
-    //       methods can be faster.
+    // Look up the Java classes and methods used by the library.  This is done here, rather than
+    // in the callbacks, also because it's called from Java, so FindClass() uses the class loader
+    // that loaded the Legato classes.
+    LogHandleClassPtr = GetClassRef(envPtr, "io/legato/LogHandler$LogHandle");
+    LogHandleConstructorPtr = GetMethodId(envPtr,
+                                          LogHandleClassPtr,
+                                          "<init>",
+                                          "(Lio/legato/LogHandler;JJ)V");
+
+    SessionClassPtr = GetClassRef(envPtr, "io/legato/Session");
+    SessionConstructorPtr = GetMethodId(envPtr, SessionClassPtr, "<init>", "(J)V");
+
+    MessageClassPtr = GetClassRef(envPtr, "io/legato/Message");
+    MessageConstructorPtr = GetMethodId(envPtr, MessageClassPtr, "<init>", "(J)V");
+
+    FileDescriptorClassPtr = GetClassRef(envPtr, "java/io/FileDescriptor");
+    FileDescriptorConstructorPtr = GetMethodId(envPtr, FileDescriptorClassPtr, "<init>", "(I)V");
+    FileDescriptorFdFieldPtr = (*envPtr)->GetFieldID(envPtr, FileDescriptorClassPtr, "fd", "I");
+    LE_FATAL_IF(FileDescriptorFdFieldPtr == NULL, "Java field 'FileDescriptor.fd' not found.");
+
+    LocationValueClassPtr = GetClassRef(envPtr, "io/legato/MessageBuffer$LocationValue");
+    LocationValueConstructorPtr = GetMethodId(envPtr,
+                                              LocationValueClassPtr,
+                                              "<init>",
+                                              "(Lio/legato/MessageBuffer;ILjava/lang/Object;)V");
+
+    ComponentInitMethodPtr = GetInterfaceMethodId(envPtr,
+                                                  "io/legato/Component",
+                                                  "componentInit",
+                                                  "()V");
+    SessionEventHandleMethodPtr = GetInterfaceMethodId(envPtr,
+                                                       "io/legato/SessionEvent",
+                                                       "handle",
+                                                       "(Ljava/lang/Object;)V");
+    MessageEventHandleMethodPtr = GetInterfaceMethodId(envPtr,
+                                                       "io/legato/MessageEvent",
+                                                       "handle",
+                                                       "(Lio/legato/Message;)V");
+
+    PayloadViewPool = le_mem_CreatePool("PayloadView", sizeof(PayloadView_t));
+    PayloadViewMap = le_hashmap_Create("PayloadViews",
+                                       31,
+                                       le_hashmap_HashVoidPointer,
+                                       le_hashmap_EqualsVoidPointer);
 
     // TODO: Convert to a JNI_OnUnload method?
 }
@@ -1335,6 +1409,75 @@ JNIEXPORT jlong JNICALL Java_io_legato_LegatoJni_GetSession
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a direct byte buffer over the payload of a message, so the payload can be read and written
+ * from Java without calling into this library for every value.
+ *
+ * The buffers are kept and reused for later messages that use the same payload memory.  Only the
+ * absolute get and put methods of a buffer should be used, or its position set before using the
+ * relative ones, as the buffer is shared with those messages.
+ *
+ * @return The byte buffer, or NULL and a raised exception if it couldn't be created.
+ */
+//--------------------------------------------------------------------------------------------------
+JNIEXPORT jobject JNICALL Java_io_legato_LegatoJni_GetPayloadBuffer
+(
+    JNIEnv* envPtr,       ///< [IN] The Java environment to work out of.
+    jclass callClassPtr,  ///< [IN] The java class that called this function.
+    jlong messageRef      ///< [IN] Reference to the message.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_msg_MessageRef_t nRef = (le_msg_MessageRef_t)(intptr_t)messageRef;
+    void* payloadPtr = le_msg_GetPayloadPtr(nRef);
+    size_t payloadSize = le_msg_GetMaxPayloadSize(nRef);
+    jobject bufferPtr = NULL;
+
+    LE_ASSERT(pthread_mutex_lock(&PayloadViewMutex) == 0);
+
+    PayloadView_t* viewPtr = le_hashmap_Get(PayloadViewMap, payloadPtr);
+
+    if (viewPtr == NULL)
+    {
+        viewPtr = le_mem_ForceAlloc(PayloadViewPool);
+        viewPtr->bufferPtr = NULL;
+        viewPtr->size = 0;
+
+        le_hashmap_Put(PayloadViewMap, payloadPtr, viewPtr);
+    }
+
+    // The memory may have been given to messages of a different size since the buffer was made.
+    if ((viewPtr->bufferPtr == NULL) || (viewPtr->size != payloadSize))
+    {
+        jobject newBufferPtr = (*envPtr)->NewDirectByteBuffer(envPtr, payloadPtr, payloadSize);
+
+        if (newBufferPtr != NULL)
+        {
+            if (viewPtr->bufferPtr != NULL)
+            {
+                (*envPtr)->DeleteGlobalRef(envPtr, viewPtr->bufferPtr);
+            }
+
+            viewPtr->bufferPtr = (*envPtr)->NewGlobalRef(envPtr, newBufferPtr);
+            viewPtr->size = payloadSize;
+
+            bufferPtr = newBufferPtr;
+        }
+    }
+    else
+    {
+        bufferPtr = (*envPtr)->NewLocalRef(envPtr, viewPtr->bufferPtr);
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&PayloadViewMutex) == 0);
+
+    return bufferPtr;
+}
+
+
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetches a received file descriptor from the message.
@@ -1435,7 +1578,7 @@ JNIEXPORT void JNICALL Java_io_legato_LegatoJni_SetMessageBool
     le_msg_MessageRef_t nRef = (le_msg_MessageRef_t)(intptr_t)messageRef;
     uint8_t* msgBufferPtr = (uint8_t*)le_msg_GetPayloadPtr(nRef);
 
-    *((jshort*)&msgBufferPtr[bufferPosition]) = value == JNI_FALSE ? false : true;
+    *((bool*)&msgBufferPtr[bufferPosition]) = value == JNI_FALSE ? false : true;
 }
 
 
@@ -1781,6 +1924,8 @@ JNIEXPORT jint JNICALL Java_io_legato_LegatoJni_SetMessageString
 
     memcpy(msgBufferPtr, rawStrPtr, strSize);
 
+    (*envPtr)->ReleaseStringUTFChars(envPtr, value, rawStrPtr);
+
     return sizeOfStrSize + strSize;
 }
 
@@ -10,6 +10,8 @@
 //--------------------------------------------------------------------------------------------------
 
 #include <sys/sendfile.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 #include "legato.h"
 #include "smack.h"
 #include "fileDescriptor.h"
@@ -618,10 +620,23 @@ le_result_t file_Copy
         return result;
     }
 
+    result = LE_OK;
+
+#ifdef FICLONE
+    // On file systems that support it, share the source's data blocks instead of writing a copy
+    // of them. They are copied on write.
+    if (ioctl(writeFd, FICLONE, readFd) == 0)
+    {
+        fd_Close(readFd);
+        fd_Close(writeFd);
+
+        return result;
+    }
+#endif
+
     // Get the kernel to copy the data over.  It may or may not happen in one go, so keep trying
     // until the whole file has been written or we error out.
     ssize_t sizeWritten = 0;
-    result = LE_OK;
     off_t fileOffset = 0;
 
     while (sizeWritten < sourceStatus.st_size)
@@ -5,46 +5,669 @@
  * This file implements functions that can be used to import IMA keys (into the kernel keyring) and
  * verify IMA signatures.
  *
+ * Signatures are verified in-process: the security.ima extended attribute of the file is parsed
+ * and the digital signature (version 2) is checked against the public certificate using libcrypto.
+ * libcrypto is loaded at run-time, so that liblegato doesn't depend on it; when it is not
+ * available, or when the signature or key type is not supported in-process, the verification is
+ * delegated to evmctl as before.
+ *
+ * Successful verifications are cached, keyed by the file inode, size, modification and status
+ * change times (the latter changes when the security.ima attribute is rewritten) and by the
+ * certificate, so a file that didn't change is not verified twice against the same certificate.
+ *
+ * Directory trees are verified by a small pool of worker threads.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 //--------------------------------------------------------------------------------------------------
 
-#include "legato.h"
-#include "limit.h"
-#include "file.h"
-#include "fileDescriptor.h"
-#include "sysPaths.h"
-#include "ima.h"
-#include "file.h"
+#include "legato.h"
+#include "limit.h"
+#include "file.h"
+#include "fileDescriptor.h"
+#include "sysPaths.h"
+#include "ima.h"
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/xattr.h>
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Max size of IMA command
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_CMD_BYTES   4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Path to evmctl tool. It can be used for producing and verifying IMA signatures. It can be also
+ * used to import keys into the kernel keyring.
+ */
+//--------------------------------------------------------------------------------------------------
+#define EVMCTL_PATH   "/usr/bin/evmctl"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Name of the extended attribute holding the IMA signature of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_XATTR_NAME          "security.ima"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the buffer the kernel command line is read into.  This is a page, which is at least the
+ * size of the largest command line of the supported kernels (COMMAND_LINE_SIZE).
+ */
+//--------------------------------------------------------------------------------------------------
+#define CMDLINE_BUFFER_BYTES    4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Type and version of the signatures that can be verified in-process
+ * (EVM_IMA_XATTR_DIGSIG, DIGSIG_VERSION_2).
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_XATTR_DIGSIG        0x03
+#define IMA_DIGSIG_VERSION_2    2
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the signature header: type, version, hash algorithm, key id (4 bytes) and signature
+ * size (2 bytes, big endian).
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_DIGSIG_HDR_BYTES    9
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Max size of the security.ima extended attribute.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_XATTR_MAX_BYTES     1024
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Max size of a file digest.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_DIGEST_MAX_BYTES    64
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Max size of a public certificate.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_CERT_MAX_BYTES      8192
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of entries of the verification cache. Can be overridden at build time.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef IMA_VERIFY_CACHE_SIZE
+#define IMA_VERIFY_CACHE_SIZE   1024
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of public certificates kept loaded.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_CERT_CACHE_SIZE     8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Max number of threads verifying a directory tree. Can be overridden at build time.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef IMA_VERIFY_MAX_THREADS
+#define IMA_VERIFY_MAX_THREADS  4
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Min number of files handled by each thread verifying a directory tree.
+ */
+//--------------------------------------------------------------------------------------------------
+#define IMA_VERIFY_FILES_PER_THREAD 8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash algorithms that can be referenced by a signature, indexed by the kernel hash_algo value.
+ */
+//--------------------------------------------------------------------------------------------------
+static const struct
+{
+    const char* namePtr;    ///< libcrypto digest name.
+    int nid;                ///< libcrypto object identifier.
+}
+HashAlgos[] =
+{
+    { "md4",        257 },
+    { "md5",        4   },
+    { "sha1",       64  },
+    { "ripemd160",  117 },
+    { "sha256",     672 },
+    { "sha384",     673 },
+    { "sha512",     674 },
+    { "sha224",     675 },
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * libcrypto functions used to verify signatures. The libcrypto types are opaque here.
+ */
+//--------------------------------------------------------------------------------------------------
+static struct
+{
+    bool isLoaded;
+    void* (*bioNewMemBuf)(const void*, int);
+    int (*bioFree)(void*);
+    void* (*pemReadBioX509)(void*, void**, void*, void*);
+    void* (*d2iX509)(void**, const unsigned char**, long);
+    void (*x509Free)(void*);
+    void* (*x509GetPubkey)(void*);
+    void* (*evpPkeyGet1Rsa)(void*);
+    void (*evpPkeyFree)(void*);
+    void (*rsaFree)(void*);
+    int (*rsaVerify)(int, const unsigned char*, unsigned int, const unsigned char*, unsigned int,
+                     void*);
+    const void* (*evpGetDigestByName)(const char*);
+    int (*evpDigest)(const void*, size_t, unsigned char*, unsigned int*, const void*, void*);
+}
+Crypto;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Public key loaded from a certificate.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char path[LIMIT_MAX_PATH_BYTES];    ///< Certificate path.
+    struct stat certStat;               ///< Certificate status when it was loaded.
+    uint32_t id;                        ///< Unique id, used to tag the cached verifications.
+    void* rsaPtr;                       ///< RSA key, or NULL if it can't be used in-process.
+}
+PubKey_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Successful verification of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    struct timespec ctime;
+    uint32_t keyId;                     ///< Id of the public key, 0 if the entry is unused.
+}
+VerifyCacheEntry_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Verification of a directory tree, shared by the worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char** pathArrayPtr;                ///< Files to verify.
+    size_t pathCount;                   ///< Number of files to verify.
+    size_t nextIndex;                   ///< Index of the next file to verify.
+    bool hasFailed;                     ///< Set as soon as a file fails verification.
+    PubKey_t* keyPtr;                   ///< Public key.
+    const char* certPath;               ///< Public certificate path.
+}
+DirVerification_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of public keys.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PubKeyPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Public keys currently loaded. Each holds a reference on its key.
+ */
+//--------------------------------------------------------------------------------------------------
+static PubKey_t* PubKeyCache[IMA_CERT_CACHE_SIZE];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Next public key id.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t NextKeyId = 1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cache of successful verifications, indexed by inode.
+ */
+//--------------------------------------------------------------------------------------------------
+static VerifyCacheEntry_t VerifyCache[IMA_VERIFY_CACHE_SIZE];
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mutex protecting the public key and verification caches.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_mutex_t Mutex = PTHREAD_MUTEX_INITIALIZER;   // POSIX "Fast" mutex.
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Used to initialize this module once.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_once_t InitOnce = PTHREAD_ONCE_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Used to check whether IMA is enabled only once.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_once_t IsEnabledOnce = PTHREAD_ONCE_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Whether IMA is enabled in the running kernel.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsEnabled;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor of public keys.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PubKeyDestructor
+(
+    void* objPtr
+)
+{
+    PubKey_t* keyPtr = objPtr;
+
+    if (keyPtr->rsaPtr != NULL)
+    {
+        Crypto.rsaFree(keyPtr->rsaPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load libcrypto, if available.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadCrypto
+(
+    void
+)
+{
+    static const char* libNames[] =
+    {
+        "libcrypto.so.3", "libcrypto.so.1.1", "libcrypto.so.1.0.0", "libcrypto.so"
+    };
+    void* libPtr = NULL;
+    size_t i;
+
+    for (i = 0; (i < NUM_ARRAY_MEMBERS(libNames)) && (libPtr == NULL); i++)
+    {
+        libPtr = dlopen(libNames[i], RTLD_NOW | RTLD_LOCAL);
+    }
+
+    if (libPtr == NULL)
+    {
+        LE_INFO("libcrypto not available, IMA signatures are verified by evmctl.");
+        return;
+    }
+
+    Crypto.bioNewMemBuf = dlsym(libPtr, "BIO_new_mem_buf");
+    Crypto.bioFree = dlsym(libPtr, "BIO_free");
+    Crypto.pemReadBioX509 = dlsym(libPtr, "PEM_read_bio_X509");
+    Crypto.d2iX509 = dlsym(libPtr, "d2i_X509");
+    Crypto.x509Free = dlsym(libPtr, "X509_free");
+    Crypto.x509GetPubkey = dlsym(libPtr, "X509_get_pubkey");
+    Crypto.evpPkeyGet1Rsa = dlsym(libPtr, "EVP_PKEY_get1_RSA");
+    Crypto.evpPkeyFree = dlsym(libPtr, "EVP_PKEY_free");
+    Crypto.rsaFree = dlsym(libPtr, "RSA_free");
+    Crypto.rsaVerify = dlsym(libPtr, "RSA_verify");
+    Crypto.evpGetDigestByName = dlsym(libPtr, "EVP_get_digestbyname");
+    Crypto.evpDigest = dlsym(libPtr, "EVP_Digest");
+
+    if (   (Crypto.bioNewMemBuf == NULL) || (Crypto.bioFree == NULL)
+        || (Crypto.pemReadBioX509 == NULL) || (Crypto.d2iX509 == NULL)
+        || (Crypto.x509Free == NULL) || (Crypto.x509GetPubkey == NULL)
+        || (Crypto.evpPkeyGet1Rsa == NULL) || (Crypto.evpPkeyFree == NULL)
+        || (Crypto.rsaFree == NULL) || (Crypto.rsaVerify == NULL)
+        || (Crypto.evpGetDigestByName == NULL) || (Crypto.evpDigest == NULL))
+    {
+        LE_WARN("Unsupported libcrypto, IMA signatures are verified by evmctl.");
+        dlclose(libPtr);
+        return;
+    }
+
+    // Versions before 1.1 don't register the digests by themselves.
+    void (*addAllDigests)(void) = dlsym(libPtr, "OpenSSL_add_all_digests");
+    if (addAllDigests != NULL)
+    {
+        addAllDigests();
+    }
+
+    Crypto.isLoaded = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize this module.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Init
+(
+    void
+)
+{
+    PubKeyPool = le_mem_CreatePool("ImaPubKey", sizeof(PubKey_t));
+    le_mem_SetDestructor(PubKeyPool, PubKeyDestructor);
+
+    LoadCrypto();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the RSA public key of a certificate, in DER or PEM format.
+ *
+ * @return
+ *      The key, or NULL if it can't be used in-process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* LoadRsaKey
+(
+    int certFd,
+    const char * certPath
+)
+{
+    uint8_t cert[IMA_CERT_MAX_BYTES];
+
+    ssize_t certSize = fd_ReadSize(certFd, cert, sizeof(cert));
+    if ((certSize <= 0) || (certSize == sizeof(cert)))
+    {
+        LE_WARN("Could not read certificate '%s'.", certPath);
+        return NULL;
+    }
+
+    const unsigned char* derPtr = cert;
+    void* x509Ptr = Crypto.d2iX509(NULL, &derPtr, certSize);
+
+    if (x509Ptr == NULL)
+    {
+        void* bioPtr = Crypto.bioNewMemBuf(cert, certSize);
+        if (bioPtr != NULL)
+        {
+            x509Ptr = Crypto.pemReadBioX509(bioPtr, NULL, NULL, NULL);
+            Crypto.bioFree(bioPtr);
+        }
+    }
+
+    if (x509Ptr == NULL)
+    {
+        LE_WARN("Could not parse certificate '%s'.", certPath);
+        return NULL;
+    }
+
+    void* rsaPtr = NULL;
+    void* pkeyPtr = Crypto.x509GetPubkey(x509Ptr);
+    if (pkeyPtr != NULL)
+    {
+        rsaPtr = Crypto.evpPkeyGet1Rsa(pkeyPtr);
+        Crypto.evpPkeyFree(pkeyPtr);
+    }
+    Crypto.x509Free(x509Ptr);
+
+    if (rsaPtr == NULL)
+    {
+        LE_WARN("Certificate '%s' doesn't hold an RSA key.", certPath);
+    }
+
+    return rsaPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the public key of a certificate, loading it if it is not cached or if the certificate
+ * changed.
+ *
+ * @return
+ *      The key, to be released with le_mem_Release(), or NULL if the certificate can't be accessed.
+ */
+//--------------------------------------------------------------------------------------------------
+static PubKey_t* GetPubKey
+(
+    const char * certPath
+)
+{
+    int certFd = open(certPath, O_RDONLY | O_CLOEXEC);
+    if (certFd < 0)
+    {
+        LE_ERROR("Could not open certificate '%s'. %m.", certPath);
+        return NULL;
+    }
+
+    struct stat certStat;
+    if (fstat(certFd, &certStat) != 0)
+    {
+        LE_ERROR("Could not stat certificate '%s'. %m.", certPath);
+        fd_Close(certFd);
+        return NULL;
+    }
+
+    PubKey_t* keyPtr = NULL;
+    size_t i;
+
+    pthread_mutex_lock(&Mutex);
+
+    for (i = 0; i < IMA_CERT_CACHE_SIZE; i++)
+    {
+        PubKey_t* cachedPtr = PubKeyCache[i];
+
+        if (   (cachedPtr != NULL)
+            && (cachedPtr->certStat.st_dev == certStat.st_dev)
+            && (cachedPtr->certStat.st_ino == certStat.st_ino)
+            && (cachedPtr->certStat.st_size == certStat.st_size)
+            && (cachedPtr->certStat.st_mtim.tv_sec == certStat.st_mtim.tv_sec)
+            && (cachedPtr->certStat.st_mtim.tv_nsec == certStat.st_mtim.tv_nsec)
+            && (strcmp(cachedPtr->path, certPath) == 0))
+        {
+            keyPtr = cachedPtr;
+            le_mem_AddRef(keyPtr);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&Mutex);
+
+    if (keyPtr != NULL)
+    {
+        fd_Close(certFd);
+        return keyPtr;
+    }
+
+    keyPtr = le_mem_ForceAlloc(PubKeyPool);
+    memset(keyPtr, 0, sizeof(*keyPtr));
+
+    if (LE_OK != le_utf8_Copy(keyPtr->path, certPath, sizeof(keyPtr->path), NULL))
+    {
+        LE_ERROR("Certificate path '%s' is too long.", certPath);
+        fd_Close(certFd);
+        le_mem_Release(keyPtr);
+        return NULL;
+    }
+    keyPtr->certStat = certStat;
+
+    if (Crypto.isLoaded)
+    {
+        keyPtr->rsaPtr = LoadRsaKey(certFd, certPath);
+    }
+    fd_Close(certFd);
+
+    // Replace the entry of this certificate, or the oldest one.
+    pthread_mutex_lock(&Mutex);
+
+    keyPtr->id = NextKeyId++;
+    if (NextKeyId == 0)
+    {
+        NextKeyId = 1;
+    }
+
+    size_t slot = 0;
+    for (i = 0; i < IMA_CERT_CACHE_SIZE; i++)
+    {
+        if (   (PubKeyCache[i] == NULL)
+            || (strcmp(PubKeyCache[i]->path, certPath) == 0))
+        {
+            slot = i;
+            break;
+        }
+        if (PubKeyCache[i]->id < PubKeyCache[slot]->id)
+        {
+            slot = i;
+        }
+    }
+
+    PubKey_t* oldKeyPtr = PubKeyCache[slot];
+    PubKeyCache[slot] = keyPtr;
+    le_mem_AddRef(keyPtr);
+
+    pthread_mutex_unlock(&Mutex);
+
+    if (oldKeyPtr != NULL)
+    {
+        le_mem_Release(oldKeyPtr);
+    }
+
+    return keyPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the verification cache entry of a file.
+ */
+//--------------------------------------------------------------------------------------------------
+static VerifyCacheEntry_t* GetCacheEntry
+(
+    const struct stat* fileStatPtr
+)
+{
+    uint64_t hash = ((uint64_t)fileStatPtr->st_ino * 0x9E3779B97F4A7C15ULL)
+                    ^ (uint64_t)fileStatPtr->st_dev;
+
+    return &VerifyCache[(hash >> 32) % IMA_VERIFY_CACHE_SIZE];
+}
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Max size of IMA command
+ * Check whether a file was already verified against a key.
  */
 //--------------------------------------------------------------------------------------------------
-#define MAX_CMD_BYTES   4096
+static bool IsVerified
+(
+    const struct stat* fileStatPtr,
+    const PubKey_t* keyPtr
+)
+{
+    bool isVerified;
+
+    pthread_mutex_lock(&Mutex);
+
+    VerifyCacheEntry_t* entryPtr = GetCacheEntry(fileStatPtr);
+
+    isVerified = (entryPtr->keyId == keyPtr->id)
+                 && (entryPtr->dev == fileStatPtr->st_dev)
+                 && (entryPtr->ino == fileStatPtr->st_ino)
+                 && (entryPtr->size == fileStatPtr->st_size)
+                 && (entryPtr->mtime.tv_sec == fileStatPtr->st_mtim.tv_sec)
+                 && (entryPtr->mtime.tv_nsec == fileStatPtr->st_mtim.tv_nsec)
+                 && (entryPtr->ctime.tv_sec == fileStatPtr->st_ctim.tv_sec)
+                 && (entryPtr->ctime.tv_nsec == fileStatPtr->st_ctim.tv_nsec);
+
+    pthread_mutex_unlock(&Mutex);
+
+    return isVerified;
+}
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Path to evmctl tool. It can be used for producing and verifying IMA signatures. It can be also
- * used to import keys into the kernel keyring.
+ * Record that a file was verified against a key.
  */
 //--------------------------------------------------------------------------------------------------
-#define EVMCTL_PATH   "/usr/bin/evmctl"
+static void SetVerified
+(
+    const struct stat* fileStatPtr,
+    const PubKey_t* keyPtr
+)
+{
+    pthread_mutex_lock(&Mutex);
+
+    VerifyCacheEntry_t* entryPtr = GetCacheEntry(fileStatPtr);
+
+    entryPtr->dev = fileStatPtr->st_dev;
+    entryPtr->ino = fileStatPtr->st_ino;
+    entryPtr->size = fileStatPtr->st_size;
+    entryPtr->mtime = fileStatPtr->st_mtim;
+    entryPtr->ctime = fileStatPtr->st_ctim;
+    entryPtr->keyId = keyPtr->id;
+
+    pthread_mutex_unlock(&Mutex);
+}
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Verify a file IMA signature against provided public certificate path
+ * Verify a file IMA signature with evmctl
  *
  * @return
  *      - LE_OK on success
  *      - LE_FAULT otherwise
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t VerifyFile
+static le_result_t VerifyFileWithEvmctl
 (
     const char * filePath,
     const char * certPath
@@ -60,15 +683,231 @@ static le_result_t VerifyFile
 
     if (WIFEXITED(exitCode) && (0 == WEXITSTATUS(exitCode)))
     {
-        LE_DEBUG("Verified file: '%s' successfully", filePath);
         return LE_OK;
     }
+
+    LE_ERROR("Failed to verify file '%s' with certificate '%s', exitCode: %d",
+             filePath, certPath, WEXITSTATUS(exitCode));
+    return LE_FAULT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Verify the IMA signature of an open file against an RSA key.
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT if the signature doesn't match
+ *      - LE_UNSUPPORTED if the signature can't be verified in-process
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t VerifyFileSignature
+(
+    int fd,
+    const struct stat* fileStatPtr,
+    const char * filePath,
+    void* rsaPtr
+)
+{
+    uint8_t xattr[IMA_XATTR_MAX_BYTES];
+
+    ssize_t xattrSize = fgetxattr(fd, IMA_XATTR_NAME, xattr, sizeof(xattr));
+    if (xattrSize < 0)
+    {
+        if ((errno == ENODATA) || (errno == ENOTSUP))
+        {
+            LE_ERROR("File '%s' is not signed.", filePath);
+            return LE_FAULT;
+        }
+        LE_WARN("Could not read IMA signature of '%s'. %m.", filePath);
+        return LE_UNSUPPORTED;
+    }
+
+    if (   (xattrSize < IMA_DIGSIG_HDR_BYTES)
+        || (xattr[0] != IMA_XATTR_DIGSIG)
+        || (xattr[1] != IMA_DIGSIG_VERSION_2)
+        || (xattr[2] >= NUM_ARRAY_MEMBERS(HashAlgos)))
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    size_t sigSize = ((size_t)xattr[7] << 8) | xattr[8];
+    if (sigSize != (size_t)xattrSize - IMA_DIGSIG_HDR_BYTES)
+    {
+        LE_ERROR("Malformed IMA signature on '%s'.", filePath);
+        return LE_FAULT;
+    }
+
+    const void* mdPtr = Crypto.evpGetDigestByName(HashAlgos[xattr[2]].namePtr);
+    if (mdPtr == NULL)
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    // Hash the file.
+    void* dataPtr = NULL;
+    if (fileStatPtr->st_size > 0)
+    {
+        dataPtr = mmap(NULL, fileStatPtr->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (dataPtr == MAP_FAILED)
+        {
+            LE_WARN("Could not map '%s'. %m.", filePath);
+            return LE_UNSUPPORTED;
+        }
+    }
+
+    unsigned char digest[IMA_DIGEST_MAX_BYTES];
+    unsigned int digestSize = 0;
+    int hashed = Crypto.evpDigest(dataPtr, fileStatPtr->st_size, digest, &digestSize, mdPtr, NULL);
+
+    if (dataPtr != NULL)
+    {
+        munmap(dataPtr, fileStatPtr->st_size);
+    }
+
+    if (!hashed)
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    if (!Crypto.rsaVerify(HashAlgos[xattr[2]].nid, digest, digestSize,
+                          xattr + IMA_DIGSIG_HDR_BYTES, sigSize, rsaPtr))
+    {
+        LE_ERROR("IMA signature of '%s' doesn't match.", filePath);
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Verify a file IMA signature against a public key
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT otherwise
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t VerifyFileWithKey
+(
+    const char * filePath,
+    PubKey_t* keyPtr
+)
+{
+    int fd = open(filePath, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0)
+    {
+        LE_ERROR("Could not open '%s'. %m.", filePath);
+        return LE_FAULT;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0)
+    {
+        LE_ERROR("Could not stat '%s'. %m.", filePath);
+        fd_Close(fd);
+        return LE_FAULT;
+    }
+
+    if (IsVerified(&fileStat, keyPtr))
+    {
+        fd_Close(fd);
+        return LE_OK;
+    }
+
+    le_result_t result = LE_UNSUPPORTED;
+
+    if (keyPtr->rsaPtr != NULL)
+    {
+        result = VerifyFileSignature(fd, &fileStat, filePath, keyPtr->rsaPtr);
+    }
+
+    fd_Close(fd);
+
+    if (result == LE_UNSUPPORTED)
+    {
+        result = VerifyFileWithEvmctl(filePath, keyPtr->path);
+    }
+
+    if (result == LE_OK)
+    {
+        LE_DEBUG("Verified file: '%s' successfully", filePath);
+        SetVerified(&fileStat, keyPtr);
+    }
     else
     {
-        LE_ERROR("Failed to verify file '%s' with certificate '%s', exitCode: %d",
-                 filePath, certPath, WEXITSTATUS(exitCode));
+        result = LE_FAULT;
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Verify a file IMA signature against provided public certificate path
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT otherwise
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t VerifyFile
+(
+    const char * filePath,
+    const char * certPath
+)
+{
+    pthread_once(&InitOnce, Init);
+
+    PubKey_t* keyPtr = GetPubKey(certPath);
+    if (keyPtr == NULL)
+    {
         return LE_FAULT;
     }
+
+    le_result_t result = VerifyFileWithKey(filePath, keyPtr);
+
+    le_mem_Release(keyPtr);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Verify the files of a directory tree until all are verified or one fails. Run by each thread
+ * verifying the tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* VerifyDirWorker
+(
+    void* contextPtr
+)
+{
+    DirVerification_t* verifPtr = contextPtr;
+
+    while (!__atomic_load_n(&verifPtr->hasFailed, __ATOMIC_RELAXED))
+    {
+        size_t index = __atomic_fetch_add(&verifPtr->nextIndex, 1, __ATOMIC_RELAXED);
+        if (index >= verifPtr->pathCount)
+        {
+            break;
+        }
+
+        if (LE_OK != VerifyFileWithKey(verifPtr->pathArrayPtr[index], verifPtr->keyPtr))
+        {
+            LE_CRIT("Failed to verify file '%s' with public certificate '%s'",
+                    verifPtr->pathArrayPtr[index],
+                    verifPtr->certPath);
+            __atomic_store_n(&verifPtr->hasFailed, true, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
 }
 
 
@@ -91,9 +930,11 @@ static le_result_t VerifyDir
     char* pathArrayPtr[] = {(char *)dirPath,
                                     NULL};
 
+    pthread_once(&InitOnce, Init);
+
     // Open the directory tree to traverse.
     FTS* ftsPtr = fts_open(pathArrayPtr,
-                           FTS_PHYSICAL,
+                           FTS_PHYSICAL | FTS_NOCHDIR,
                            NULL);
 
     if (NULL == ftsPtr)
@@ -102,7 +943,11 @@ static le_result_t VerifyDir
         return LE_FAULT;
     }
 
-    // Traverse through the directory tree.
+    DirVerification_t verif = { .certPath = certPath };
+    size_t pathCapacity = 0;
+    le_result_t result = LE_OK;
+
+    // Traverse through the directory tree, collecting the files to verify.
     FTSENT* entPtr;
     while (NULL != (entPtr = fts_read(ftsPtr)))
     {
@@ -111,34 +956,131 @@ static le_result_t VerifyDir
                                 entPtr->fts_path,
                                 entPtr->fts_info);
 
-        switch (entPtr->fts_info)
+        if ((entPtr->fts_info != FTS_F) || (0 == strcmp(entPtr->fts_name, PUB_CERT_NAME)))
         {
-            case FTS_SL:
-            case FTS_SLNONE:
-                break;
+            continue;
+        }
 
-            case FTS_F:
-                if (0 != strcmp(entPtr->fts_name, PUB_CERT_NAME ))
-                {
-                    if (LE_OK != VerifyFile(entPtr->fts_accpath, certPath))
-                    {
-                        LE_CRIT("Failed to verify file '%s' with public certificate '%s'",
-                                entPtr->fts_accpath,
-                                certPath);
-                        fts_close(ftsPtr);
-                        return LE_FAULT;
-                    }
-                }
-                break;
+        if (verif.pathCount == pathCapacity)
+        {
+            pathCapacity = (pathCapacity == 0) ? 64 : pathCapacity * 2;
+            char** newArrayPtr = realloc(verif.pathArrayPtr, pathCapacity * sizeof(char*));
+            LE_ASSERT(newArrayPtr != NULL);
+            verif.pathArrayPtr = newArrayPtr;
         }
 
+        verif.pathArrayPtr[verif.pathCount] = strdup(entPtr->fts_path);
+        LE_ASSERT(verif.pathArrayPtr[verif.pathCount] != NULL);
+        verif.pathCount++;
     }
 
     fts_close(ftsPtr);
 
-    return LE_OK;
+    if (verif.pathCount > 0)
+    {
+        verif.keyPtr = GetPubKey(certPath);
+        if (verif.keyPtr == NULL)
+        {
+            result = LE_FAULT;
+        }
+    }
+
+    if (verif.keyPtr != NULL)
+    {
+        // Verify the files on up to IMA_VERIFY_MAX_THREADS threads, including this one.
+        pthread_t threads[IMA_VERIFY_MAX_THREADS - 1];
+        size_t threadCount = 0;
+        long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+        size_t maxThreadCount = verif.pathCount / IMA_VERIFY_FILES_PER_THREAD;
+
+        if ((cpuCount > 0) && ((size_t)cpuCount < maxThreadCount))
+        {
+            maxThreadCount = cpuCount;
+        }
+        if (maxThreadCount > IMA_VERIFY_MAX_THREADS)
+        {
+            maxThreadCount = IMA_VERIFY_MAX_THREADS;
+        }
+
+        while (threadCount + 1 < maxThreadCount)
+        {
+            if (pthread_create(&threads[threadCount], NULL, VerifyDirWorker, &verif) != 0)
+            {
+                LE_WARN("Could not create IMA verification thread.");
+                break;
+            }
+            threadCount++;
+        }
+
+        VerifyDirWorker(&verif);
+
+        while (threadCount > 0)
+        {
+            pthread_join(threads[--threadCount], NULL);
+        }
+
+        if (verif.hasFailed)
+        {
+            result = LE_FAULT;
+        }
+
+        le_mem_Release(verif.keyPtr);
+    }
+
+    while (verif.pathCount > 0)
+    {
+        free(verif.pathArrayPtr[--verif.pathCount]);
+    }
+    free(verif.pathArrayPtr);
+
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether IMA appraisal is enforced by the running kernel. The kernel command line is read
+ * first, so that the kernel configuration only has to be uncompressed when it matters.  If the
+ * command line can't be read whole, IMA is taken as enabled, so that signatures are still checked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckIsEnabled
+(
+    void
+)
+{
+    char cmdline[CMDLINE_BUFFER_BYTES];
+
+    int fd = open("/proc/cmdline", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LE_ERROR("Could not open /proc/cmdline, assuming IMA is enabled. %m.");
+        IsEnabled = true;
+        return;
+    }
+
+    // Filling the buffer means the command line may have been truncated.
+    ssize_t size = fd_ReadSize(fd, cmdline, sizeof(cmdline));
+    fd_Close(fd);
+
+    if ((size <= 0) || ((size_t)size >= sizeof(cmdline)))
+    {
+        LE_ERROR("Could not read /proc/cmdline, assuming IMA is enabled.");
+        IsEnabled = true;
+        return;
+    }
+    cmdline[size] = '\0';
+
+    if (NULL == strstr(cmdline, "ima_appraise=enforce"))
+    {
+        return;
+    }
+
+    int exitCode = system("zcat /proc/config.gz | grep -q CONFIG_IMA=y");
+
+    IsEnabled = WIFEXITED(exitCode) && (0 == WEXITSTATUS(exitCode));
 }
 
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Import IMA public certificate to linux keyring. Public certificate must be signed by system
@@ -219,7 +1161,8 @@ le_result_t ima_VerifyDir
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Check whether current linux kernel is IMA-enabled or not.
+ * Check whether current linux kernel is IMA-enabled or not. The check is only done once per
+ * process.
  *
  * @return
  *      - true if IMA is enabled.
@@ -231,11 +1174,9 @@ bool ima_IsEnabled
     void
 )
 {
+    pthread_once(&IsEnabledOnce, CheckIsEnabled);
 
-    int exitCode = system("(zcat /proc/config.gz | grep CONFIG_IMA=y) &&"
-                          " (cat /proc/cmdline | grep \"ima_appraise=enforce\")");
-
-    return WIFEXITED(exitCode) && (0 == WEXITSTATUS(exitCode));
+    return IsEnabled;
 }
 
 
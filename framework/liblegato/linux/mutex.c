@@ -28,6 +28,14 @@
  *  -# What type of mutex is a given mutex? (recursive?)
  *    - Stored in each Mutex object as a boolean flag.
  *
+ * Keeping the waiting lists costs two extra locks per lock, so a lock is first attempted without
+ * waiting, and a thread only goes on a waiting list if the mutex is held by another thread.
+ *
+ * If the LE_MUTEX_PROFILE environment variable is set to 1 when the process starts, each Mutex
+ * object also keeps a contention profile (see mutex_Profile_t): how many times it was locked, how
+ * many of those had to wait and for how long, and which thread last made others wait.  The
+ * profiles of all the mutexes of a process can be seen with "inspect locks".
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 
@@ -55,6 +63,23 @@ static size_t MutexListChangeCount = 0;
 static size_t* MutexListChangeCountRef = &MutexListChangeCount;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * A counter that increments every time a mutex is created or deleted.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t MutexCreateDeleteCount = 0;
+static size_t* MutexCreateDeleteCountRef = &MutexCreateDeleteCount;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * true if the contention profiles of the mutexes are kept up to date.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsProfiling = false;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mutex Pool.
@@ -130,6 +155,7 @@ le_mutex_Ref_t CreateMutex
     pthread_mutex_init(&mutexPtr->waitingListMutex, NULL);  // Default attributes = Fast mutex.
     mutexPtr->isRecursive = isRecursive;
     mutexPtr->lockCount = 0;
+    memset(&mutexPtr->profile, 0, sizeof(mutexPtr->profile));
     if (le_utf8_Copy(mutexPtr->name, nameStr, sizeof(mutexPtr->name), NULL) == LE_OVERFLOW)
     {
         LE_WARN("Mutex name '%s' truncated to '%s'.", nameStr, mutexPtr->name);
@@ -158,6 +184,7 @@ le_mutex_Ref_t CreateMutex
     // Add the mutex to the process's Mutex List.
     LOCK_MUTEX_LIST();
     le_dls_Queue(&MutexList, &mutexPtr->mutexListLink);
+    MutexCreateDeleteCount++;
     UNLOCK_MUTEX_LIST();
 
     return mutexPtr;
@@ -208,6 +235,79 @@ static void RemoveFromWaitingList
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a wait for the lock of a mutex to its contention profile.
+ *
+ * @warning Assumes that the calling thread holds the pthreads mutex lock.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordWait
+(
+    Mutex_t*        mutexPtr,   ///< [in] Pointer to the Mutex object that was waited for.
+    le_clk_Time_t   waitTime    ///< [in] Time spent waiting.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    mutex_Profile_t* profilePtr = &mutexPtr->profile;
+    uint64_t waitUsec = (uint64_t)waitTime.sec * 1000000 + waitTime.usec;
+    uint64_t bucketLimit = 10;
+    int bucket = 0;
+
+    while ((bucket < MUTEX_WAIT_BUCKET_COUNT - 1) && (waitUsec >= bucketLimit))
+    {
+        bucket++;
+        bucketLimit *= 10;
+    }
+
+    profilePtr->contendedCount++;
+    profilePtr->totalWaitUsec += waitUsec;
+    profilePtr->waitBuckets[bucket]++;
+
+    if (waitUsec > profilePtr->maxWaitUsec)
+    {
+        profilePtr->maxWaitUsec = (waitUsec > UINT32_MAX) ? UINT32_MAX : (uint32_t)waitUsec;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Lock a mutex that is held by another thread, or that is already held by the calling thread and
+ * isn't recursive.  The thread is on the mutex's waiting list while it waits.
+ *
+ * @return  The result of pthread_mutex_lock().
+ */
+//--------------------------------------------------------------------------------------------------
+static int LockContended
+(
+    mutex_ThreadRec_t*  perThreadRecPtr,    ///< [in] Pointer to the thread's mutex info record.
+    Mutex_t*            mutexPtr            ///< [in] Pointer to the Mutex object to lock.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_clk_Time_t startTime = { 0, 0 };
+
+    if (IsProfiling)
+    {
+        startTime = le_clk_GetRelativeTime();
+    }
+
+    AddToWaitingList(mutexPtr, perThreadRecPtr);
+
+    int result = pthread_mutex_lock(&mutexPtr->mutex);
+
+    RemoveFromWaitingList(mutexPtr, perThreadRecPtr);
+
+    if (IsProfiling && (result == 0))
+    {
+        RecordWait(mutexPtr, le_clk_Sub(le_clk_GetRelativeTime(), startTime));
+    }
+
+    return result;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mark a mutex "locked".
@@ -318,6 +418,35 @@ size_t** mutex_GetMutexListChgCntRef
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Exposing the list of all the mutexes of the process; mainly for the Inspect tool.
+ */
+//--------------------------------------------------------------------------------------------------
+le_dls_List_t* mutex_GetMutexList
+(
+    void
+)
+{
+    return (&MutexList);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Exposing the counter of creations and deletions of mutexes, which are the only changes to the
+ * list of all the mutexes of the process; mainly for the Inspect tool.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t** mutex_GetMutexCreateDeleteCntRef
+(
+    void
+)
+{
+    return (&MutexCreateDeleteCountRef);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the Mutex module.
@@ -334,6 +463,10 @@ void mutex_Init
 {
     MutexPoolRef = le_mem_CreatePool("mutex", sizeof(Mutex_t));
     le_mem_ExpandPool(MutexPoolRef, DEFAULT_POOL_SIZE);
+
+    const char* envStrPtr = getenv("LE_MUTEX_PROFILE");
+
+    IsProfiling = ((envStrPtr != NULL) && (strcmp(envStrPtr, "1") == 0));
 }
 
 
@@ -418,6 +551,7 @@ void le_mutex_Delete
     // Remove the Mutex object from the Mutex List.
     LOCK_MUTEX_LIST();
     le_dls_Remove(&MutexList, &mutexRef->mutexListLink);
+    MutexCreateDeleteCount++;
     UNLOCK_MUTEX_LIST();
 
     if (mutexRef->lockingThreadRef != NULL)
@@ -448,15 +582,15 @@ void le_mutex_Lock
 )
 //--------------------------------------------------------------------------------------------------
 {
-    int result;
-
     mutex_ThreadRec_t* perThreadRecPtr = thread_GetMutexRecPtr();
 
-    AddToWaitingList(mutexRef, perThreadRecPtr);
-
-    result = pthread_mutex_lock(&mutexRef->mutex);
+    // Only go through the waiting list if the lock can't be taken right away.
+    int result = pthread_mutex_trylock(&mutexRef->mutex);
 
-    RemoveFromWaitingList(mutexRef, perThreadRecPtr);
+    if (result == EBUSY)
+    {
+        result = LockContended(perThreadRecPtr, mutexRef);
+    }
 
     if (result == 0)
     {
@@ -474,6 +608,11 @@ void le_mutex_Lock
 
         // Update the lock count.
         mutexRef->lockCount++;
+
+        if (IsProfiling)
+        {
+            mutexRef->profile.acquireCount++;
+        }
     }
     else
     {
@@ -529,6 +668,11 @@ le_result_t le_mutex_TryLock
 
         // Update the lock count.
         mutexRef->lockCount++;
+
+        if (IsProfiling)
+        {
+            mutexRef->profile.acquireCount++;
+        }
     }
     else if (result == EBUSY)
     {
@@ -589,6 +733,22 @@ void le_mutex_Unlock
     if (mutexRef->lockCount == 0)
     {
         MarkUnlocked(mutexRef);
+
+        // Remember who made other threads wait.
+        if (IsProfiling)
+        {
+            LOCK_WAITING_LIST(mutexRef);
+
+            if (!le_dls_IsEmpty(&mutexRef->waitingList))
+            {
+                le_utf8_Copy(mutexRef->profile.holderName,
+                             le_thread_GetMyName(),
+                             sizeof(mutexRef->profile.holderName),
+                             NULL);
+            }
+
+            UNLOCK_WAITING_LIST(mutexRef);
+        }
     }
 
     // Warning!  If the lock count is now zero, then as soon as we call this function another
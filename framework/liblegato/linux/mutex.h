@@ -9,9 +9,35 @@
 #ifndef LEGATO_SRC_MUTEX_H_INCLUDE_GUARD
 #define LEGATO_SRC_MUTEX_H_INCLUDE_GUARD
 
+#include "limit.h"
+
 /// Maximum number of bytes in a mutex name (including null terminator).
 #define MAX_NAME_BYTES 24
 
+/// Number of buckets in the wait time histogram of a mutex.  Bucket i counts the waits shorter
+/// than 10^(i+1) microseconds, except the last one, which counts all the longer waits.
+#define MUTEX_WAIT_BUCKET_COUNT 7
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Contention profile of a mutex.  Only kept up to date if profiling is enabled for the process,
+ * by setting the LE_MUTEX_PROFILE environment variable to 1.
+ *
+ * It is protected by the mutex itself.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t    acquireCount;       ///< Number of times the mutex was locked.
+    uint64_t    contendedCount;     ///< Number of those times the lock had to be waited for.
+    uint64_t    totalWaitUsec;      ///< Total time spent waiting for the lock, in microseconds.
+    uint32_t    maxWaitUsec;        ///< Longest time spent waiting for the lock, in microseconds.
+    uint32_t    waitBuckets[MUTEX_WAIT_BUCKET_COUNT];   ///< Histogram of the wait times.
+    char        holderName[LIMIT_MAX_THREAD_NAME_BYTES]; ///< Last thread to have released the
+                                                         ///  mutex while other threads waited.
+}
+mutex_Profile_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Mutex object.
@@ -28,6 +54,7 @@ typedef struct le_mutex
     int                 lockCount;      ///< Number of lock calls not yet matched by unlock calls.
     pthread_mutex_t     mutex;          ///< Pthreads mutex that does the real work. :)
     char                name[MAX_NAME_BYTES]; ///< The name of the mutex (UTF8 string).
+    mutex_Profile_t     profile;        ///< Contention profile.
 }
 Mutex_t;
 
@@ -64,6 +91,29 @@ size_t** mutex_GetMutexListChgCntRef
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Exposing the list of all the mutexes of the process; mainly for the Inspect tool.
+ */
+//--------------------------------------------------------------------------------------------------
+le_dls_List_t* mutex_GetMutexList
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Exposing the counter of creations and deletions of mutexes, which are the only changes to the
+ * list of all the mutexes of the process; mainly for the Inspect tool.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t** mutex_GetMutexCreateDeleteCntRef
+(
+    void
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initialize the Mutex module.
@@ -15,6 +15,7 @@
 #include "legato.h"
 
 #include "limit.h"
+#include "safeRef.h"
 
 // =============================================
 //  PRIVATE DATA
@@ -29,17 +30,86 @@
 /// Name used for diagnostics.
 static const char ModuleName[] = "ref";
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Layout of a Safe Reference, which always fits in 32 bits as IPC requires (see le_pack.h): bit 0
+ * is always set (see the note at the top of this file), the next GENERATION_BITS bits hold the
+ * generation of the slot, and the remaining bits hold the index of the slot.
+ *
+ * The generation of a slot changes each time the reference it holds is deleted, so a stale
+ * reference is detected as long as the slot's generation doesn't come back around.  Once a slot
+ * has been through all 2^GENERATION_BITS generations, it is retired instead of being reused.
+ * Retired slots are put back in use when the map runs out of free slots and at least half of its
+ * slots are retired (or it can't grow any more), so that the size of a map follows the number of
+ * live references in it rather than the number ever created.  A stale reference can then become
+ * valid again, but only after its slot has been through all its generations again, that is after
+ * at least 2^GENERATION_BITS references have been created in the map.
+ */
+//--------------------------------------------------------------------------------------------------
+#define GENERATION_BITS 10
+#define GENERATION_MASK ((1u << GENERATION_BITS) - 1)
+#define INDEX_SHIFT     (1 + GENERATION_BITS)
+
+/// Maximum number of slots in a map, limited by the bits left for the index in a reference.
+#define MAX_SLOT_COUNT  ((size_t)1 << (32 - INDEX_SHIFT))
+
+/// Value of a slot's next link while the slot holds a reference.
+#define SLOT_IN_USE     (UINT32_MAX - 1)
+
+/// Value of a slot's next link while the slot is retired.
+#define SLOT_RETIRED    (UINT32_MAX - 2)
+
+/// Value of a next link at the end of the free list.
+#define NO_SLOT         UINT32_MAX
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A slot of a Reference Map.  It either holds a reference, or is on the map's free list.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    void*       ptr;            ///< Pointer the reference maps to, when in use.
+    uint32_t    generation;     ///< Generation of the reference held, or to be held, by the slot.
+    uint32_t    next;           ///< SLOT_IN_USE, SLOT_RETIRED, or the next slot on the free
+                                ///  list.
+}
+Slot_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Iterator over the references of a Reference Map.  There is one per map.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_ref_Iter
+{
+    struct le_ref_Map*  mapPtr;         ///< The map iterated over.
+    ssize_t             index;          ///< Index of the current slot, or -1 before the first.
+    bool                isValueValid;   ///< true = the current slot holds a reference.
+}
+Iter_t;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Reference Map object, which stores mappings from Safe References to pointers.
- * The actual mapping is held in a hashmap.
+ * The actual mapping is held in a growable array of slots, indexed by the references.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct le_ref_Map
 {
-    uint32_t             nextRefNum;     ///< The next Safe Reference value to be assigned.
+    Slot_t*       slotsPtr;             ///< Array of slots.
+    size_t        slotCount;            ///< Number of slots in the array.
+
+    uint32_t      freeHead;             ///< First slot of the free list, or NO_SLOT.
+    uint32_t      freeTail;             ///< Last slot of the free list, or NO_SLOT.
 
-    le_hashmap_Ref_t    referenceMap;    ///< HashMap of Mapping objects.
+    size_t        retiredCount;         ///< Number of retired slots.
+
+    uint32_t      firstGeneration;      ///< Generation of new slots, which differs between maps
+                                        ///  so that using a reference from another map is likely
+                                        ///  to be detected.
+
+    Iter_t        iterator;             ///< The map's iterator.
 
     char          name[MAX_NAME_BYTES]; ///< The name of the map (for diagnostics).
 }
@@ -53,44 +123,152 @@ Map_t;
 //--------------------------------------------------------------------------------------------------
 static le_mem_PoolRef_t MapPool;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of maps created so far, used to vary the first generation of their slots.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t MapCount;
+
 // =============================================
 //  PRIVATE FUNCTIONS
 // =============================================
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SafeRef hashing function.
+ * Build the Safe Reference held by a slot.
  *
- * @return  Returns the SafeRef itself as it can used as a hash
+ * @return  The Safe Reference.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void* MakeRef
+(
+    size_t      index,      ///< [in] Index of the slot.
+    uint32_t    generation  ///< [in] Generation of the slot.
+)
+{
+    return (void*)(((uintptr_t)index << INDEX_SHIFT) | ((uintptr_t)generation << 1) | 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the slot holding a Safe Reference.
  *
+ * @return  The slot, or NULL if the reference isn't held by the map.
  */
 //--------------------------------------------------------------------------------------------------
+static inline Slot_t* GetSlot
+(
+    Map_t*  mapPtr,     ///< [in] The map.
+    void*   safeRef     ///< [in] The Safe Reference.
+)
+{
+    uintptr_t ref = (uintptr_t)safeRef;
+    uintptr_t index = ref >> INDEX_SHIFT;
+
+    if (((ref & 1) == 0) || (index >= mapPtr->slotCount))
+    {
+        return NULL;
+    }
+
+    Slot_t* slotPtr = &mapPtr->slotsPtr[index];
 
-size_t hashSafeRef
+    if (   (slotPtr->next != SLOT_IN_USE)
+        || (slotPtr->generation != ((ref >> 1) & GENERATION_MASK)))
+    {
+        return NULL;
+    }
+
+    return slotPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a slot at the end of the free list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FreeSlot
 (
-    const void* safeRefPtr    ///< [in] Safe Ref to be hashed
+    Map_t*      mapPtr,     ///< [in] The map.
+    uint32_t    index       ///< [in] Index of the slot.
 )
 {
-    // Return the key value itself.
-    return (size_t) safeRefPtr;
+    mapPtr->slotsPtr[index].ptr = NULL;
+    mapPtr->slotsPtr[index].next = NO_SLOT;
+
+    if (mapPtr->freeTail == NO_SLOT)
+    {
+        mapPtr->freeHead = index;
+    }
+    else
+    {
+        mapPtr->slotsPtr[mapPtr->freeTail].next = index;
+    }
+
+    mapPtr->freeTail = index;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SafeRef equality function.
- *
- * @return  Returns true if the integers are equal, false otherwise
- *
+ * Grow the array of slots of a map, and put the new slots on the free list.
  */
 //--------------------------------------------------------------------------------------------------
+static void AddSlots
+(
+    Map_t*  mapPtr,     ///< [in] The map.
+    size_t  newCount    ///< [in] Number of slots the array must have.
+)
+{
+    if (newCount > MAX_SLOT_COUNT)
+    {
+        newCount = MAX_SLOT_COUNT;
+    }
+
+    // It is ok to use realloc here, as the array is only indexed, never pointed into.
+    Slot_t* slotsPtr = realloc(mapPtr->slotsPtr, newCount * sizeof(Slot_t));
+    LE_ASSERT(slotsPtr != NULL);
 
-bool equalsSafeRef
+    mapPtr->slotsPtr = slotsPtr;
+
+    size_t i;
+
+    for (i = mapPtr->slotCount; i < newCount; i++)
+    {
+        mapPtr->slotsPtr[i].generation = mapPtr->firstGeneration;
+        FreeSlot(mapPtr, i);
+    }
+
+    mapPtr->slotCount = newCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Put the retired slots of a map back on its free list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecycleSlots
 (
-    const void* firstSafeRef,    ///< [in] First SafeRef for comparing.
-    const void* secondSafeRef    ///< [in] Second SafeRef for comparing.
+    Map_t*  mapPtr      ///< [in] The map.
 )
 {
-    return firstSafeRef == secondSafeRef;
+    LE_FATAL_IF(mapPtr->retiredCount == 0,
+                "Too many Safe References in Map '%s' (%zu).",
+                mapPtr->name,
+                mapPtr->slotCount);
+
+    LE_DEBUG("Reusing %zu retired slots of Map '%s'.", mapPtr->retiredCount, mapPtr->name);
+
+    size_t i;
+
+    for (i = 0; i < mapPtr->slotCount; i++)
+    {
+        if (mapPtr->slotsPtr[i].next == SLOT_RETIRED)
+        {
+            FreeSlot(mapPtr, i);
+        }
+    }
+
+    mapPtr->retiredCount = 0;
 }
 
 // =============================================
@@ -117,6 +295,23 @@ void safeRef_Init
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of slots of a Reference Map, whether they hold a reference or not.
+ *
+ * @return  The number of slots.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t safeRef_GetSlotCount
+(
+    le_ref_MapRef_t mapRef  ///< [in] The Reference Map.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return mapRef->slotCount;
+}
+
+
 // =============================================
 //  PUBLIC API FUNCTIONS
 // =============================================
@@ -149,15 +344,22 @@ le_ref_MapRef_t le_ref_CreateMap
         LE_WARN("Map name '%s%s' truncated to '%s'.", ModuleName, name, mapPtr->name);
     }
 
-    /// @todo Make this a random number so that using a reference from another Map is unlikely to
-    ///       get by undetected.
-    mapPtr->nextRefNum = 0x10000001; // Use only odd numbers.
+    mapPtr->slotsPtr = NULL;
+    mapPtr->slotCount = 0;
+    mapPtr->freeHead = NO_SLOT;
+    mapPtr->freeTail = NO_SLOT;
+    mapPtr->retiredCount = 0;
+
+    // Maps may be created by several threads at once.
+    uint32_t mapNum = __atomic_fetch_add(&MapCount, 1, __ATOMIC_RELAXED);
+    mapPtr->firstGeneration = (mapNum * 0x9E3779B9) & GENERATION_MASK;
+
+    mapPtr->iterator.mapPtr = mapPtr;
+    mapPtr->iterator.index = -1;
+    mapPtr->iterator.isValueValid = false;
 
-    mapPtr->referenceMap = le_hashmap_Create(mapPtr->name,
-                                             maxRefs,
-                                             hashSafeRef,
-                                             equalsSafeRef
-                                            );
+    // The map grows as needed, but start with room for the expected number of references.
+    AddSlots(mapPtr, (maxRefs < 1) ? 1 : maxRefs);
 
     return mapPtr;
 }
@@ -178,13 +380,35 @@ void* le_ref_CreateRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    ssize_t thisRef = mapRef->nextRefNum;
+    if (mapRef->freeHead == NO_SLOT)
+    {
+        // With no free slot, all the slots that aren't retired hold live references, so only grow
+        // the map if most of its slots are live.
+        if (   ((mapRef->retiredCount > 0) && (mapRef->retiredCount >= mapRef->slotCount / 2))
+            || (mapRef->slotCount >= MAX_SLOT_COUNT))
+        {
+            RecycleSlots(mapRef);
+        }
+        else
+        {
+            AddSlots(mapRef, mapRef->slotCount * 2);
+        }
+    }
 
-    le_hashmap_Put(mapRef->referenceMap, (const void*)(thisRef), ptr);
+    uint32_t index = mapRef->freeHead;
+    Slot_t* slotPtr = &mapRef->slotsPtr[index];
+
+    mapRef->freeHead = slotPtr->next;
+
+    if (mapRef->freeHead == NO_SLOT)
+    {
+        mapRef->freeTail = NO_SLOT;
+    }
 
-    mapRef->nextRefNum += 2; // Increment the reference number for next time, keeping it odd.
+    slotPtr->ptr = ptr;
+    slotPtr->next = SLOT_IN_USE;
 
-    return (void *)thisRef;
+    return MakeRef(index, slotPtr->generation);
 }
 
 
@@ -204,7 +428,9 @@ void* le_ref_Lookup
 )
 //--------------------------------------------------------------------------------------------------
 {
-    return le_hashmap_Get(mapRef->referenceMap, safeRef);
+    Slot_t* slotPtr = GetSlot(mapRef, safeRef);
+
+    return (slotPtr == NULL) ? NULL : slotPtr->ptr;
 }
 
 
@@ -220,9 +446,27 @@ void le_ref_DeleteRef
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (le_hashmap_Remove(mapRef->referenceMap, safeRef) == NULL)
+    Slot_t* slotPtr = GetSlot(mapRef, safeRef);
+
+    if (slotPtr == NULL)
     {
         LE_ERROR("Deleting non-existent Safe Reference %p from Map '%s'.", safeRef, mapRef->name);
+        return;
+    }
+
+    // Invalidate the reference, then make the slot available again, unless it has been through all
+    // of its generations, in which case reusing it could make one of its stale references valid.
+    slotPtr->generation = (slotPtr->generation + 1) & GENERATION_MASK;
+
+    if (slotPtr->generation == mapRef->firstGeneration)
+    {
+        slotPtr->ptr = NULL;
+        slotPtr->next = SLOT_RETIRED;
+        mapRef->retiredCount++;
+    }
+    else
+    {
+        FreeSlot(mapRef, (uint32_t)(slotPtr - mapRef->slotsPtr));
     }
 }
 
@@ -234,7 +478,7 @@ void le_ref_DeleteRef
  * per map, and calling this function resets the iterator position to the start of the map.  The
  * iterator is not ready for data access until le_ref_NextNode() has been called at least once.
  *
- * @return  Returns A reference to a hashmap iterator which is ready for le_hashmap_NextNode() to be
+ * @return  Returns A reference to the map's iterator, which is ready for le_ref_NextNode() to be
  *          called on it.
  */
 //--------------------------------------------------------------------------------------------------
@@ -243,7 +487,10 @@ le_ref_IterRef_t le_ref_GetIterator
     le_ref_MapRef_t mapRef ///< [in] Reference to the map.
 )
 {
-    return (le_ref_IterRef_t)le_hashmap_GetIterator(mapRef->referenceMap);
+    mapRef->iterator.index = -1;
+    mapRef->iterator.isValueValid = false;
+
+    return &mapRef->iterator;
 }
 
 
@@ -251,9 +498,11 @@ le_ref_IterRef_t le_ref_GetIterator
 /**
  * Moves the iterator to the next key/value pair in the map.
  *
+ * References may be created and deleted while iterating: the ones created may or may not be
+ * visited, and the ones deleted are not visited.
+ *
  * @return  Returns LE_OK unless you go past the end of the map, then returns LE_NOT_FOUND.
- *          If the iterator has been invalidated by the map changing or you have previously
- *          received a LE_NOT_FOUND then this returns LE_FAULT.
+ *          If you have previously received a LE_NOT_FOUND then this returns LE_FAULT.
  */
 //--------------------------------------------------------------------------------------------------
 le_result_t le_ref_NextNode
@@ -261,15 +510,34 @@ le_result_t le_ref_NextNode
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_NextNode((le_hashmap_It_Ref_t)iteratorRef);
+    Map_t* mapPtr = iteratorRef->mapPtr;
+
+    if (iteratorRef->index >= (ssize_t)MAX_SLOT_COUNT)
+    {
+        return LE_FAULT;
+    }
+
+    for (iteratorRef->index++; iteratorRef->index < (ssize_t)mapPtr->slotCount; iteratorRef->index++)
+    {
+        if (mapPtr->slotsPtr[iteratorRef->index].next == SLOT_IN_USE)
+        {
+            iteratorRef->isValueValid = true;
+            return LE_OK;
+        }
+    }
+
+    // Stay past the end, even if the map grows.
+    iteratorRef->index = MAX_SLOT_COUNT;
+    iteratorRef->isValueValid = false;
+    return LE_NOT_FOUND;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves a pointer to the safe ref iterator is currently pointing at.  If the iterator has just
- * been initialized and le_hashmap_NextNode() has not been called, or if the iterator has been
- * invalidated then this will return NULL.
+ * been initialized and le_ref_NextNode() has not been called, or if the reference has been
+ * deleted since, then this will return NULL.
  *
  * @return  A pointer to the current key, or NULL if the iterator has been invalidated or is not ready.
  *
@@ -280,15 +548,24 @@ const void* le_ref_GetSafeRef
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_GetKey((le_hashmap_It_Ref_t)iteratorRef);
+    // The current reference may have been deleted since the iterator moved to it.
+    if (!iteratorRef->isValueValid ||
+        (iteratorRef->mapPtr->slotsPtr[iteratorRef->index].next != SLOT_IN_USE))
+    {
+        return NULL;
+    }
+
+    Slot_t* slotPtr = &iteratorRef->mapPtr->slotsPtr[iteratorRef->index];
+
+    return MakeRef(iteratorRef->index, slotPtr->generation);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieves a pointer to the value which the iterator is currently pointing at.  If the iterator
- * has just been initialized and le_ref_NextNode() has not been called, or if the iterator has been
- * invalidated then this will return NULL.
+ * has just been initialized and le_ref_NextNode() has not been called, or if the reference has
+ * been deleted since, then this will return NULL.
  *
  * @return  A pointer to the current value, or NULL if the iterator has been invalidated or is not
  *          ready.
@@ -299,5 +576,11 @@ void* le_ref_GetValue
     le_ref_IterRef_t iteratorRef ///< [IN] Reference to the iterator.
 )
 {
-    return le_hashmap_GetValue((le_hashmap_It_Ref_t)iteratorRef);
+    if (!iteratorRef->isValueValid ||
+        (iteratorRef->mapPtr->slotsPtr[iteratorRef->index].next != SLOT_IN_USE))
+    {
+        return NULL;
+    }
+
+    return iteratorRef->mapPtr->slotsPtr[iteratorRef->index].ptr;
 }
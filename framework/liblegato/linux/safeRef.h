@@ -23,4 +23,16 @@ void safeRef_Init
     void
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of slots of a Reference Map, whether they hold a reference or not.
+ *
+ * @return  The number of slots.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t safeRef_GetSlotCount
+(
+    le_ref_MapRef_t mapRef  ///< [in] The Reference Map.
+);
+
 #endif // LEGATO_SRC_SAFEREF_H_INCLUDE_GUARD
@@ -22,6 +22,9 @@
  *  -# What threads, if any, are currently waiting on a given semaphore?
  *    - Each Semaphore object has a list of Per-Thread Semaphore Records for this.
  *
+ * A thread only goes on a waiting list if the semaphore can't be decremented right away, so that
+ * waits that don't block cost no more than sem_trywait().
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 
@@ -340,6 +343,12 @@ void le_sem_Wait
 {
     int result;
 
+    // Only go through the waiting list if the semaphore can't be decremented right away.
+    if (sem_trywait(&semaphorePtr->semaphore) == 0)
+    {
+        return;
+    }
+
     sem_ThreadRec_t* perThreadRecPtr = thread_GetSemaphoreRecPtr();
 
     SemaphoreListChangeCount++;
@@ -414,6 +423,12 @@ le_result_t le_sem_WaitWithTimeOut
     struct timespec timeOut;
     int result;
 
+    // Only go through the waiting list if the semaphore can't be decremented right away.
+    if (sem_trywait(&semaphorePtr->semaphore) == 0)
+    {
+        return LE_OK;
+    }
+
     // Prepare the timer
     le_clk_Time_t currentUtcTime = le_clk_GetAbsoluteTime();
     le_clk_Time_t wakeUpTime = le_clk_Add(currentUtcTime,timeToWait);
@@ -0,0 +1,861 @@
+//--------------------------------------------------------------------------------------------------
+/** @file workQueue.c
+ *
+ * Legato @ref c_workQueue implementation.
+ *
+ * Each worker of a pool has its own double-ended queue of tasks, protected by its own mutex so
+ * workers rarely compete for a lock.  A worker pushes the tasks it submits on the tail of its
+ * queue and takes its next task from the tail, so recently queued sub-tasks run first.  Tasks
+ * submitted by other threads are pushed on the head, so a worker runs them in the order they were
+ * submitted.  A worker whose queue is empty steals the task at the head of another worker's queue,
+ * which is a task from another thread or else the oldest, and usually largest, sub-task there.
+ *
+ * Workers with nothing to do sleep on the pool's condition variable.  The number of queued tasks
+ * and the number of sleeping workers are atomic counters, so submitting a task only takes the
+ * pool's mutex when a worker has to be woken up.  A sleeping worker increments the sleeper count
+ * before it checks the queued count one last time, and a submitter increments the queued count
+ * before it checks the sleeper count, so at least one of them sees the other.
+ *
+ * A task's state changes from queued to running (or cancelled) under the mutex of the queue it is
+ * on, and it becomes done under the pool's mutex.  Completion handlers are queued to the
+ * submitting thread's Event Loop, which releases the task once the handler has returned.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "limit.h"
+#include "workQueue.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Where a task is in its life.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    TASK_QUEUED,            ///< On a worker's queue.
+    TASK_RUNNING,           ///< Taken off its queue by a worker, to be run.
+    TASK_CANCELLED          ///< Taken off its queue by le_workQueue_Cancel(), won't be run.
+}
+TaskState_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Who, if anyone, is blocked in le_workQueue_Wait() for a task.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    WAITER_NONE,            ///< Nobody.
+    WAITER_THREAD,          ///< A thread that isn't a worker, sleeping on the pool's doneCond.
+    WAITER_WORKER           ///< A worker, sleeping on the pool's workCond between other tasks.
+}
+Waiter_t;
+
+
+struct Worker;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_workQueue_Pool
+{
+    char name[LIMIT_MAX_THREAD_NAME_BYTES];     ///< Name of the pool.
+    struct Worker* workersPtr;                  ///< Array of workers.
+    size_t workerCount;                         ///< Number of workers.
+    pthread_mutex_t mutex;                      ///< Protects sleeping and tasks becoming done.
+    pthread_cond_t workCond;                    ///< Signalled when a task is queued.
+    pthread_cond_t doneCond;                    ///< Signalled when a task a thread waits for
+                                                ///  is done.
+    bool isStopping;                            ///< Pool is being deleted.  Protected by mutex.
+    size_t sleeperCount;                        ///< Number of workers sleeping on workCond.
+    size_t queuedCount;                         ///< Number of tasks on the workers' queues.
+    size_t runningCount;                        ///< Number of tasks being run.
+    size_t nextWorker;                          ///< Worker to queue the next external task on.
+    uint64_t submitCount;                       ///< Statistics, see le_workQueue_Stats_t.
+    uint64_t completeCount;
+    uint64_t cancelCount;
+    uint64_t stealCount;
+}
+Pool_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker thread, and its queue of tasks.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct Worker
+{
+    Pool_t* poolPtr;                            ///< Pool the worker belongs to.
+    le_thread_Ref_t threadRef;                  ///< Worker thread.
+    pthread_mutex_t mutex;                      ///< Protects the queue.
+    le_dls_List_t queue;                        ///< Queued tasks.  See the top of this file.
+    uint32_t seed;                              ///< For picking the first worker to steal from.
+    struct le_workQueue_Task* currentTaskPtr;   ///< Task being run, or NULL.
+}
+Worker_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Task.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct le_workQueue_Task
+{
+    le_dls_Link_t link;                         ///< Link in the queue of a worker.
+    Pool_t* poolPtr;                            ///< Pool the task was submitted to.
+    Worker_t* workerPtr;                        ///< Worker the task was queued on.
+    le_workQueue_WorkFunc_t workFunc;           ///< Work function.
+    void* contextPtr;                           ///< Context pointer of the work function.
+    le_workQueue_CompletionHandler_t handler;   ///< Completion handler, or NULL.
+    le_thread_Ref_t submitterRef;               ///< Thread that submitted the task.
+    TaskState_t state;                          ///< Protected by the worker's mutex.
+    bool isCancelRequested;                     ///< le_workQueue_Cancel() was called.  Atomic.
+    bool isDone;                                ///< Result is set.  Protected by pool's mutex.
+    Waiter_t waiter;                            ///< Protected by the pool's mutex.
+    le_result_t result;                         ///< LE_OK or LE_TERMINATED.
+    void* resultPtr;                            ///< Value returned by the work function.
+}
+Task_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory pools for pools and tasks.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t PoolPool;
+static le_mem_PoolRef_t TaskPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The thread local data's key for the worker record of worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+static pthread_key_t WorkerKey;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the worker record of the calling thread.
+ *
+ * @return The worker, or NULL if the calling thread isn't a worker.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline Worker_t* GetCurrentWorker
+(
+    void
+)
+{
+    return pthread_getspecific(WorkerKey);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a task off a worker's queue.
+ *
+ * @return The task, in the running state, or NULL if the queue is empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static Task_t* TakeTask
+(
+    Worker_t* workerPtr,
+    bool isFromTail             ///< true to take the newest task, false the oldest.
+)
+{
+    Task_t* taskPtr = NULL;
+
+    LE_ASSERT(pthread_mutex_lock(&workerPtr->mutex) == 0);
+
+    le_dls_Link_t* linkPtr = isFromTail ? le_dls_PopTail(&workerPtr->queue)
+                                        : le_dls_Pop(&workerPtr->queue);
+    if (linkPtr != NULL)
+    {
+        taskPtr = CONTAINER_OF(linkPtr, Task_t, link);
+        taskPtr->state = TASK_RUNNING;
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&workerPtr->mutex) == 0);
+
+    if (taskPtr != NULL)
+    {
+        __atomic_sub_fetch(&workerPtr->poolPtr->queuedCount, 1, __ATOMIC_SEQ_CST);
+    }
+
+    return taskPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find a task for a worker to run: the newest task on its own queue or, failing that, the oldest
+ * task on another worker's queue.
+ *
+ * @return The task, in the running state, or NULL if all the queues are empty.
+ */
+//--------------------------------------------------------------------------------------------------
+static Task_t* FindTask
+(
+    Worker_t* workerPtr
+)
+{
+    Pool_t* poolPtr = workerPtr->poolPtr;
+
+    Task_t* taskPtr = TakeTask(workerPtr, true);
+    if (taskPtr != NULL)
+    {
+        return taskPtr;
+    }
+
+    if (__atomic_load_n(&poolPtr->queuedCount, __ATOMIC_SEQ_CST) == 0)
+    {
+        return NULL;
+    }
+
+    // Start at a pseudo-random victim, so thieves don't all compete for the same queue.
+    workerPtr->seed = workerPtr->seed * 1103515245 + 12345;
+    size_t start = (workerPtr->seed >> 8) % poolPtr->workerCount;
+    size_t i;
+
+    for (i = 0; i < poolPtr->workerCount; i++)
+    {
+        Worker_t* victimPtr = &poolPtr->workersPtr[(start + i) % poolPtr->workerCount];
+
+        if (victimPtr != workerPtr)
+        {
+            taskPtr = TakeTask(victimPtr, false);
+            if (taskPtr != NULL)
+            {
+                __atomic_add_fetch(&poolPtr->stealCount, 1, __ATOMIC_RELAXED);
+                return taskPtr;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called by the submitting thread's Event Loop to run a task's completion handler and release
+ * the task.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeliverCompletion
+(
+    void* taskPtr,
+    void* unusedPtr
+)
+{
+    Task_t* tPtr = taskPtr;
+
+    tPtr->handler(tPtr, tPtr->result, tPtr->resultPtr, tPtr->contextPtr);
+
+    le_mem_Release(tPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set the result of a task, and hand it to its completion handler or to whoever waits for it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CompleteTask
+(
+    Task_t* taskPtr,
+    le_result_t result,
+    void* resultPtr
+)
+{
+    Pool_t* poolPtr = taskPtr->poolPtr;
+
+    // A task without a handler can be released by its waiter as soon as it is done.
+    bool hasHandler = (taskPtr->handler != NULL);
+
+    LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+
+    taskPtr->result = result;
+    taskPtr->resultPtr = resultPtr;
+    taskPtr->isDone = true;
+
+    if (taskPtr->waiter == WAITER_WORKER)
+    {
+        LE_ASSERT(pthread_cond_broadcast(&poolPtr->workCond) == 0);
+    }
+    else if (taskPtr->waiter == WAITER_THREAD)
+    {
+        LE_ASSERT(pthread_cond_broadcast(&poolPtr->doneCond) == 0);
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+
+    if (hasHandler)
+    {
+        le_event_QueueFunctionToThread(taskPtr->submitterRef, DeliverCompletion, taskPtr, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run a task taken off a queue by a worker.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunTask
+(
+    Worker_t* workerPtr,
+    Task_t* taskPtr
+)
+{
+    Pool_t* poolPtr = workerPtr->poolPtr;
+
+    // A worker waiting for a task runs other tasks, so tasks can be nested.
+    Task_t* outerTaskPtr = workerPtr->currentTaskPtr;
+    workerPtr->currentTaskPtr = taskPtr;
+
+    __atomic_add_fetch(&poolPtr->runningCount, 1, __ATOMIC_RELAXED);
+
+    void* resultPtr = taskPtr->workFunc(taskPtr->contextPtr);
+
+    __atomic_sub_fetch(&poolPtr->runningCount, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&poolPtr->completeCount, 1, __ATOMIC_RELAXED);
+
+    workerPtr->currentTaskPtr = outerTaskPtr;
+
+    CompleteTask(taskPtr, LE_OK, resultPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make a worker sleep until a task is queued, or until the pool's workCond is broadcast for some
+ * other reason.  Does nothing if there are tasks queued.
+ *
+ * Must be called with the pool's mutex locked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Sleep
+(
+    Pool_t* poolPtr
+)
+{
+    __atomic_add_fetch(&poolPtr->sleeperCount, 1, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&poolPtr->queuedCount, __ATOMIC_SEQ_CST) == 0)
+    {
+        LE_ASSERT(pthread_cond_wait(&poolPtr->workCond, &poolPtr->mutex) == 0);
+    }
+
+    __atomic_sub_fetch(&poolPtr->sleeperCount, 1, __ATOMIC_SEQ_CST);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WorkerMain
+(
+    void* contextPtr
+)
+{
+    Worker_t* workerPtr = contextPtr;
+    Pool_t* poolPtr = workerPtr->poolPtr;
+
+    LE_ASSERT(pthread_setspecific(WorkerKey, workerPtr) == 0);
+
+    for (;;)
+    {
+        Task_t* taskPtr = FindTask(workerPtr);
+
+        if (taskPtr != NULL)
+        {
+            RunTask(workerPtr, taskPtr);
+            continue;
+        }
+
+        LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+
+        bool isStopping = poolPtr->isStopping;
+        if (!isStopping)
+        {
+            Sleep(poolPtr);
+        }
+
+        LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+
+        // Tasks queued by tasks that were still running when the pool was stopped are run.
+        if (isStopping && (__atomic_load_n(&poolPtr->queuedCount, __ATOMIC_SEQ_CST) == 0))
+        {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a task on a worker, and wake a sleeping worker up if there is one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueueTask
+(
+    Worker_t* workerPtr,
+    Task_t* taskPtr,
+    bool isSubTask              ///< true if submitted by the worker itself.
+)
+{
+    Pool_t* poolPtr = workerPtr->poolPtr;
+
+    taskPtr->workerPtr = workerPtr;
+
+    LE_ASSERT(pthread_mutex_lock(&workerPtr->mutex) == 0);
+    if (isSubTask)
+    {
+        le_dls_Queue(&workerPtr->queue, &taskPtr->link);
+    }
+    else
+    {
+        le_dls_Stack(&workerPtr->queue, &taskPtr->link);
+    }
+    LE_ASSERT(pthread_mutex_unlock(&workerPtr->mutex) == 0);
+
+    __atomic_add_fetch(&poolPtr->queuedCount, 1, __ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&poolPtr->sleeperCount, __ATOMIC_SEQ_CST) != 0)
+    {
+        LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+        LE_ASSERT(pthread_cond_signal(&poolPtr->workCond) == 0);
+        LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Take a task off its queue, so it won't run.
+ *
+ * @return true if the task was queued, false if it had already been taken off.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool DequeueTask
+(
+    Task_t* taskPtr
+)
+{
+    Worker_t* workerPtr = taskPtr->workerPtr;
+    bool isQueued;
+
+    LE_ASSERT(pthread_mutex_lock(&workerPtr->mutex) == 0);
+
+    isQueued = (taskPtr->state == TASK_QUEUED);
+    if (isQueued)
+    {
+        le_dls_Remove(&workerPtr->queue, &taskPtr->link);
+        taskPtr->state = TASK_CANCELLED;
+    }
+
+    LE_ASSERT(pthread_mutex_unlock(&workerPtr->mutex) == 0);
+
+    if (isQueued)
+    {
+        __atomic_sub_fetch(&workerPtr->poolPtr->queuedCount, 1, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&workerPtr->poolPtr->cancelCount, 1, __ATOMIC_RELAXED);
+    }
+
+    return isQueued;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cancel all the tasks on a worker's queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CancelQueuedTasks
+(
+    Worker_t* workerPtr
+)
+{
+    for (;;)
+    {
+        Task_t* taskPtr = NULL;
+
+        LE_ASSERT(pthread_mutex_lock(&workerPtr->mutex) == 0);
+
+        le_dls_Link_t* linkPtr = le_dls_Pop(&workerPtr->queue);
+        if (linkPtr != NULL)
+        {
+            taskPtr = CONTAINER_OF(linkPtr, Task_t, link);
+            taskPtr->state = TASK_CANCELLED;
+        }
+
+        LE_ASSERT(pthread_mutex_unlock(&workerPtr->mutex) == 0);
+
+        if (taskPtr == NULL)
+        {
+            return;
+        }
+
+        __atomic_sub_fetch(&workerPtr->poolPtr->queuedCount, 1, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&workerPtr->poolPtr->cancelCount, 1, __ATOMIC_RELAXED);
+
+        CompleteTask(taskPtr, LE_TERMINATED, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a pool of worker threads.
+ *
+ * @return Reference to the pool.
+ *
+ * @note Terminates the process on failure, no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_workQueue_PoolRef_t le_workQueue_CreatePool
+(
+    const char* name,       ///< [IN] Name of the pool, also used to name its worker threads.
+    size_t workerCount      ///< [IN] Number of worker threads, or 0 for one per online CPU.
+)
+{
+    if (workerCount == 0)
+    {
+        long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+        workerCount = (cpuCount > 0) ? (size_t)cpuCount : 1;
+    }
+
+    Pool_t* poolPtr = le_mem_ForceAlloc(PoolPool);
+    memset(poolPtr, 0, sizeof(*poolPtr));
+
+    if (le_utf8_Copy(poolPtr->name, name, sizeof(poolPtr->name), NULL) == LE_OVERFLOW)
+    {
+        LE_WARN("Work queue pool name '%s' truncated to '%s'.", name, poolPtr->name);
+    }
+
+    LE_ASSERT(pthread_mutex_init(&poolPtr->mutex, NULL) == 0);
+    LE_ASSERT(pthread_cond_init(&poolPtr->workCond, NULL) == 0);
+    LE_ASSERT(pthread_cond_init(&poolPtr->doneCond, NULL) == 0);
+
+    poolPtr->workerCount = workerCount;
+    poolPtr->workersPtr = calloc(workerCount, sizeof(Worker_t));
+    LE_ASSERT(poolPtr->workersPtr != NULL);
+
+    size_t i;
+
+    for (i = 0; i < workerCount; i++)
+    {
+        Worker_t* workerPtr = &poolPtr->workersPtr[i];
+        char threadName[LIMIT_MAX_THREAD_NAME_BYTES];
+
+        workerPtr->poolPtr = poolPtr;
+        workerPtr->queue = LE_DLS_LIST_INIT;
+        workerPtr->seed = i + 1;
+        LE_ASSERT(pthread_mutex_init(&workerPtr->mutex, NULL) == 0);
+
+        snprintf(threadName, sizeof(threadName), "%s-%zu", poolPtr->name, i);
+        workerPtr->threadRef = le_thread_Create(threadName, WorkerMain, workerPtr);
+        le_thread_SetJoinable(workerPtr->threadRef);
+    }
+
+    for (i = 0; i < workerCount; i++)
+    {
+        le_thread_Start(poolPtr->workersPtr[i].threadRef);
+    }
+
+    return poolPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a pool of worker threads.
+ *
+ * Tasks still queued are cancelled, the tasks that are running are waited for, and the workers
+ * are stopped.
+ *
+ * @warning Must not be called by one of the pool's workers.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_workQueue_DeletePool
+(
+    le_workQueue_PoolRef_t poolRef  ///< [IN] The pool.
+)
+{
+    Worker_t* currentWorkerPtr = GetCurrentWorker();
+    size_t i;
+
+    LE_FATAL_IF((currentWorkerPtr != NULL) && (currentWorkerPtr->poolPtr == poolRef),
+                "Work queue pool '%s' deleted by one of its workers.",
+                poolRef->name);
+
+    LE_ASSERT(pthread_mutex_lock(&poolRef->mutex) == 0);
+    poolRef->isStopping = true;
+    LE_ASSERT(pthread_cond_broadcast(&poolRef->workCond) == 0);
+    LE_ASSERT(pthread_mutex_unlock(&poolRef->mutex) == 0);
+
+    for (i = 0; i < poolRef->workerCount; i++)
+    {
+        CancelQueuedTasks(&poolRef->workersPtr[i]);
+    }
+
+    for (i = 0; i < poolRef->workerCount; i++)
+    {
+        LE_ASSERT(le_thread_Join(poolRef->workersPtr[i].threadRef, NULL) == LE_OK);
+        LE_ASSERT(pthread_mutex_destroy(&poolRef->workersPtr[i].mutex) == 0);
+    }
+
+    LE_ASSERT(pthread_cond_destroy(&poolRef->doneCond) == 0);
+    LE_ASSERT(pthread_cond_destroy(&poolRef->workCond) == 0);
+    LE_ASSERT(pthread_mutex_destroy(&poolRef->mutex) == 0);
+
+    free(poolRef->workersPtr);
+    le_mem_Release(poolRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Submit a task to a pool.
+ *
+ * @return Reference to the task.
+ *
+ * @note If completionHandler is NULL, le_workQueue_Wait() must be called to release the task.
+ *
+ * @note Terminates the process on failure, no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_workQueue_TaskRef_t le_workQueue_Submit
+(
+    le_workQueue_PoolRef_t poolRef,                     ///< [IN] The pool.
+    le_workQueue_WorkFunc_t workFunc,                   ///< [IN] Function to run on a worker.
+    void* contextPtr,                                   ///< [IN] Passed to the work function and
+                                                        ///       to the completion handler.
+    le_workQueue_CompletionHandler_t completionHandler  ///< [IN] Handler called by the calling
+                                                        ///       thread's Event Loop when the
+                                                        ///       task is done, or NULL.
+)
+{
+    Worker_t* currentWorkerPtr = GetCurrentWorker();
+    Worker_t* workerPtr;
+
+    LE_FATAL_IF((currentWorkerPtr != NULL) && (completionHandler != NULL),
+                "Tasks submitted by workers can't have a completion handler.");
+
+    Task_t* taskPtr = le_mem_ForceAlloc(TaskPool);
+
+    taskPtr->link = LE_DLS_LINK_INIT;
+    taskPtr->poolPtr = poolRef;
+    taskPtr->workFunc = workFunc;
+    taskPtr->contextPtr = contextPtr;
+    taskPtr->handler = completionHandler;
+    taskPtr->submitterRef = le_thread_GetCurrent();
+    taskPtr->state = TASK_QUEUED;
+    taskPtr->isCancelRequested = false;
+    taskPtr->isDone = false;
+    taskPtr->waiter = WAITER_NONE;
+    taskPtr->result = LE_OK;
+    taskPtr->resultPtr = NULL;
+
+    __atomic_add_fetch(&poolRef->submitCount, 1, __ATOMIC_RELAXED);
+
+    if ((currentWorkerPtr != NULL) && (currentWorkerPtr->poolPtr == poolRef))
+    {
+        workerPtr = currentWorkerPtr;
+    }
+    else
+    {
+        size_t next = __atomic_fetch_add(&poolRef->nextWorker, 1, __ATOMIC_RELAXED);
+        workerPtr = &poolRef->workersPtr[next % poolRef->workerCount];
+    }
+
+    QueueTask(workerPtr, taskPtr, (workerPtr == currentWorkerPtr));
+
+    return taskPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cancel a task.
+ *
+ * @return
+ *  - LE_OK if the task hadn't started, and won't run.
+ *  - LE_BUSY if the task is running.  le_workQueue_IsCancelRequested() will return true in its
+ *    work function.
+ *  - LE_DUPLICATE if the task is already done.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_workQueue_Cancel
+(
+    le_workQueue_TaskRef_t taskRef  ///< [IN] The task.
+)
+{
+    if (DequeueTask(taskRef))
+    {
+        CompleteTask(taskRef, LE_TERMINATED, NULL);
+        return LE_OK;
+    }
+
+    __atomic_store_n(&taskRef->isCancelRequested, true, __ATOMIC_RELAXED);
+
+    LE_ASSERT(pthread_mutex_lock(&taskRef->poolPtr->mutex) == 0);
+    bool isDone = taskRef->isDone;
+    LE_ASSERT(pthread_mutex_unlock(&taskRef->poolPtr->mutex) == 0);
+
+    return isDone ? LE_DUPLICATE : LE_BUSY;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether the task being run by the calling worker has been cancelled.
+ *
+ * @return true if le_workQueue_Cancel() has been called for the task, false otherwise or if the
+ *         calling thread isn't running a task.
+ */
+//--------------------------------------------------------------------------------------------------
+bool le_workQueue_IsCancelRequested
+(
+    void
+)
+{
+    Worker_t* workerPtr = GetCurrentWorker();
+
+    if ((workerPtr == NULL) || (workerPtr->currentTaskPtr == NULL))
+    {
+        return false;
+    }
+
+    return __atomic_load_n(&workerPtr->currentTaskPtr->isCancelRequested, __ATOMIC_RELAXED);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait for a task submitted without a completion handler to be done, and release it.
+ *
+ * When called by a worker, other queued tasks are run while waiting.
+ *
+ * @return
+ *  - LE_OK if the work function ran.
+ *  - LE_TERMINATED if the task was cancelled before it started.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_workQueue_Wait
+(
+    le_workQueue_TaskRef_t taskRef, ///< [IN] The task.  It is no longer valid after this returns.
+    void** resultPtrPtr             ///< [OUT] Value returned by the work function, or NULL if the
+                                    ///        task was cancelled.  Can be NULL if not needed.
+)
+{
+    Pool_t* poolPtr = taskRef->poolPtr;
+    Worker_t* workerPtr = GetCurrentWorker();
+
+    LE_FATAL_IF(taskRef->handler != NULL, "Waiting for a task that has a completion handler.");
+
+    if ((workerPtr != NULL) && (workerPtr->poolPtr == poolPtr))
+    {
+        LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+
+        while (!taskRef->isDone)
+        {
+            LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+
+            Task_t* otherTaskPtr = FindTask(workerPtr);
+            if (otherTaskPtr != NULL)
+            {
+                RunTask(workerPtr, otherTaskPtr);
+                LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+            }
+            else
+            {
+                LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+                if (!taskRef->isDone)
+                {
+                    taskRef->waiter = WAITER_WORKER;
+                    Sleep(poolPtr);
+                }
+            }
+        }
+
+        LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+    }
+    else
+    {
+        LE_ASSERT(pthread_mutex_lock(&poolPtr->mutex) == 0);
+
+        taskRef->waiter = WAITER_THREAD;
+        while (!taskRef->isDone)
+        {
+            LE_ASSERT(pthread_cond_wait(&poolPtr->doneCond, &poolPtr->mutex) == 0);
+        }
+
+        LE_ASSERT(pthread_mutex_unlock(&poolPtr->mutex) == 0);
+    }
+
+    le_result_t result = taskRef->result;
+    if (resultPtrPtr != NULL)
+    {
+        *resultPtrPtr = taskRef->resultPtr;
+    }
+
+    le_mem_Release(taskRef);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the statistics of a pool.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_workQueue_GetStats
+(
+    le_workQueue_PoolRef_t poolRef,     ///< [IN] The pool.
+    le_workQueue_Stats_t* statsPtr      ///< [OUT] The pool's statistics.
+)
+{
+    statsPtr->submitCount = __atomic_load_n(&poolRef->submitCount, __ATOMIC_RELAXED);
+    statsPtr->completeCount = __atomic_load_n(&poolRef->completeCount, __ATOMIC_RELAXED);
+    statsPtr->cancelCount = __atomic_load_n(&poolRef->cancelCount, __ATOMIC_RELAXED);
+    statsPtr->stealCount = __atomic_load_n(&poolRef->stealCount, __ATOMIC_RELAXED);
+    statsPtr->queuedCount = __atomic_load_n(&poolRef->queuedCount, __ATOMIC_RELAXED);
+    statsPtr->runningCount = __atomic_load_n(&poolRef->runningCount, __ATOMIC_RELAXED);
+    statsPtr->workerCount = poolRef->workerCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the work queue module.  This function is meant to be called from Legato's internal
+ * init.
+ */
+//--------------------------------------------------------------------------------------------------
+void workQueue_Init
+(
+    void
+)
+{
+    PoolPool = le_mem_CreatePool("WorkQueuePool", sizeof(Pool_t));
+    TaskPool = le_mem_CreatePool("WorkQueueTask", sizeof(Task_t));
+
+    LE_ASSERT(pthread_key_create(&WorkerKey, NULL) == 0);
+}
@@ -11,44 +11,65 @@ from functools import wraps
 
 __copyright__ = 'Copyright (C) Sierra Wireless Inc.'
 
-def convert_to_py(obj):
+# Converters of ffi CData objects to python, by ffi type.  Working out how to convert a type is
+# much slower than converting, so it's only done once for each type.
+_py_converters = {}
+
+def _leave_as_is(obj):
+    return obj
+
+def _get_py_converter(type):
     """
-    Convert a ffi CData object to a python representation
+    Get the function converting ffi CData objects of a type to a python representation
     """
-    if not isinstance(obj, ffi.CData):
-        return obj
-    type=ffi.typeof(obj)
     if type.kind == 'primitive':
         if 'char' in type.cname: # includes wchar, etc
-            return ffi.string(obj)
-        return int(obj)
+            return ffi.string
+        return int
     elif type.kind == 'pointer':
         if type.item.cname == 'char':
-            return ffi.string(obj)
+            return ffi.string
         else:
             # if it's not a char*, then it's an opaque reference that we shouldn't touch
-            return obj
+            return _leave_as_is
     elif type.kind == 'array':
-            return [ convert_to_py(obj[i]) for i in range(type.length) ]
+        return lambda obj: [ convert_to_py(obj[i]) for i in range(len(obj)) ]
     else:
         print("convert_to_py() can't convert: ")
         print(type.kind)
         print(type)
         print(type.cname)
+        return _leave_as_is
+
+def convert_to_py(obj):
+    """
+    Convert a ffi CData object to a python representation
+    """
+    if not isinstance(obj, ffi.CData):
         return obj
+    type = ffi.typeof(obj)
+    try:
+        converter = _py_converters[type]
+    except KeyError:
+        converter = _py_converters[type] = _get_py_converter(type)
+    return converter(obj)
+
+# Python types that are passed to C functions as they are.  These are the most common arguments,
+# so they are checked for first.
+_c_types = (int, long, float, bool)
 
 def convert_to_c(obj):
     """
     Convert a python object to ffi CData
     """
-    if isinstance(obj, ffi.CData):
+    if isinstance(obj, _c_types) or isinstance(obj, ffi.CData):
         return obj
     if obj is None:
         return ffi.NULL
     if isinstance(obj, basestring):
         return ffi.new("char[]", obj)
-    if obj is list or obj is tuple:
-        return [ convert_to_c[x] for x in obj ]
+    if isinstance(obj, (list, tuple)):
+        return [ convert_to_c(x) for x in obj ]
     if isinstance(obj, Enum):
         return obj.value
     return obj
@@ -119,10 +140,10 @@ sys.stdout = Unbuffered(sys.stdout)
 def convert_args_decorator(f):
     @wraps(f)
     def wrapper(*args, **kwargs):
-        for k, v in kwargs.iteritems():
-            kwargs[k] = convert_to_c(v)
-        args = map(convert_to_c, args)
-        return convert_to_py(f(*args, **kwargs))
+        if kwargs:
+            for k, v in kwargs.iteritems():
+                kwargs[k] = convert_to_c(v)
+        return convert_to_py(f(*map(convert_to_c, args), **kwargs))
     return wrapper
 
 current_module = __import__(__name__)
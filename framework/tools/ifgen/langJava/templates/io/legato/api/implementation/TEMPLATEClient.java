@@ -143,6 +143,7 @@ public class {{apiName}}Client implements AutoCloseable, {{apiName}} {
 		buffer = response.getBuffer();
 
 		mapper.serverRef = buffer.readLongRef();
+		response.close();
 
 		return newRef;
 		{%- elif function is RemoveHandlerFunction %}
@@ -151,7 +152,7 @@ public class {{apiName}}Client implements AutoCloseable, {{apiName}} {
 		buffer.writeLongRef(handler.serverRef);
 		handlerMap.remove(_{{function.parameters[0].name}});
 
-		message.requestResponse();
+		message.requestResponse().close();
 		{%- else %}
 		{%- for parameter in function.parameters %}
 		{%- if parameter is InParameter %}
@@ -174,8 +175,10 @@ public class {{apiName}}Client implements AutoCloseable, {{apiName}} {
 		{%- set hasOuts = (function.returnType or any(function.parameters, "OutParameter")) %}
 
 		{% if hasOuts -%}
-		Message response = {% endif -%}
-		message.requestResponse();
+		Message response = message.requestResponse();
+		{%- else -%}
+		message.requestResponse().close();
+		{%- endif %}
 		{%- if hasOuts %}
 		buffer = response.getBuffer();
 		buffer.readInt();
@@ -210,6 +213,10 @@ public class {{apiName}}Client implements AutoCloseable, {{apiName}} {
 			{%- endif %}
 		}
 		{%- endfor %}
+		{%- if hasOuts %}
+
+		response.close();
+		{%- endif %}
 		{%- if function.returnType %}
 
 		return result;
@@ -15,6 +15,7 @@ Filters = {
             'DecoratorNameForEvent' : codeGenHelpers.DecoratorNameForEvent,
             'HandlerParamsForEvent' : codeGenHelpers.HandlerParamsForEvent,
             'CDataToPython'         : codeGenHelpers.CDataToPython,
+            'OutputToPython'        : codeGenHelpers.OutputToPython,
             'FormatHeaderComment': langC.codeGenHelpers.FormatHeaderComment,
             'FormatDirection':     langC.codeGenHelpers.FormatDirection,
             'FormatType':          langC.codeGenHelpers.FormatType,
@@ -30,7 +31,8 @@ Filters = {
             }
 
 
-Tests = { 'SizeParameter':         langC.codeGenHelpers.IsSizeParameter }
+Tests = { 'SizeParameter':         langC.codeGenHelpers.IsSizeParameter,
+          'ByteArray':             codeGenHelpers.IsByteArray }
 
 Globals = langC.Globals.copy()
 Globals.update({
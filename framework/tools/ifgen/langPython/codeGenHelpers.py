@@ -62,3 +62,34 @@ def CDataToPython(var):
             (var.name, var.apiType.name))
         return "# No rule for converting %s (%s) to Python type."
     return var.name + " = " + cast
+
+def IsByteArray(parameter):
+    """
+    Is the parameter an array of bytes, which can be passed as a bytes-like object rather than as a
+    list?
+    """
+    return (isinstance(parameter, interfaceIR.ArrayParameter) and
+            parameter.apiType in [interfaceIR.UINT8_TYPE, interfaceIR.INT8_TYPE,
+                                  interfaceIR.CHAR_TYPE])
+
+def OutputToPython(var):
+    """
+    Convert an output parameter from the cffi buffer it was returned in.  The buffers are reused for
+    every call, so the Python value must not refer to them.
+    """
+    buf = var.name + "_buf"
+    if isinstance(var, interfaceIR.StringParameter):
+        return "ffi.string(%s)" % buf
+    elif IsByteArray(var):
+        return "ffi.buffer(%s, %s_size[0])[:]" % (buf, var.name)
+    elif isinstance(var, interfaceIR.ArrayParameter):
+        return "ffi.unpack(%s, %s_size[0])" % (buf, var.name)
+    elif isinstance(var.apiType, interfaceIR.BitmaskType):
+        return "%s(%s[0])" % (var.apiType.name, buf)
+    elif isinstance(var.apiType, interfaceIR.EnumType):
+        return "_%sValues[%s[0]]" % (var.apiType.name, buf)
+    elif var.apiType == interfaceIR.RESULT_TYPE:
+        return "_ResultValues[%s[0]]" % buf
+    else:
+        # cffi already returns numbers, bools and references as Python objects.
+        return "%s[0]" % buf
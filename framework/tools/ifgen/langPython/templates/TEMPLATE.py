@@ -18,6 +18,7 @@ from {{apiName}}_native import ffi, lib
 from enum import Enum, IntEnum
 from collections import namedtuple
 import sys
+import threading
 
 # IntEnum allows it to be compared with liblegato.Result
 class Result(IntEnum):
@@ -45,6 +46,9 @@ class Result(IntEnum):
     LE_UNAVAILABLE = -21
     LE_TERMINATED = -22
 
+# Looking up the members by value is much faster than calling the Enum class.
+_ResultValues = dict((member.value, member) for member in Result)
+
 {%- for definition in definitions %}
 {{definition.comment|PyFormatHeaderComment}}
 {% if definition.value is number %}
@@ -69,6 +73,10 @@ class {{type.name}}(Enum):
     {%- for element in type.elements %}
     {{element.name}} = {{element.value}}
     {%- endfor %}
+{%- if type is EnumType %}
+
+_{{type.name}}Values = dict((member.value, member) for member in {{type.name}})
+{%- endif %}
 {%- elif type is HandlerType -%}
 {#- No need for exposing the handler type. Handled below in functions #}
 {%- endif %}
@@ -77,15 +85,93 @@ class {{type.name}}(Enum):
 _handler_reg_queue = []
 _connected = False
 
+# Buffers for the output parameters, allocated once per thread.
+_buffers = threading.local()
+
+{#- Names of the buffers that the outputs of a function are returned in. #}
+{%- macro output_buffers(outputs) -%}
+{%- for parameter in outputs -%}
+{{parameter.name}}_buf{% if parameter is ArrayParameter %}, {{parameter.name}}_size{% endif %}
+{%- if not loop.last %}, {% endif %}
+{%- endfor %}
+{%- if outputs|length == 1 and outputs[0] is not ArrayParameter %},{% endif %}
+{%- endmacro %}
+
+{#- Convert the inputs of a function to what the C function takes. #}
+{%- macro convert_inputs(inputs) %}
+{%- for parameter in inputs %}
+    {%- if parameter is ByteArray %}
+    {{parameter.name}}_ptr = ffi.new("{{parameter.apiType|FormatType}}[]", {{parameter.name}}) if isinstance({{parameter.name}}, (list, tuple)) else ffi.cast("{{parameter.apiType|FormatType}} *", ffi.from_buffer({{parameter.name}}))
+    {%- elif parameter.apiType is BitMaskType %}
+    {#- The C function needs an integer #}
+    {{parameter.name}} = {{parameter.name}}.value
+    {%- endif %}
+{%- endfor %}
+{%- endmacro %}
+
+{#- Arguments of the C function. #}
+{%- macro c_arguments(function) -%}
+{%- for parameter in function.parameters -%}
+    {%- if parameter is OutParameter and parameter is StringParameter -%}
+    {{parameter.name}}_buf, len({{parameter.name}}_buf)
+    {%- elif parameter is OutParameter and parameter is ArrayParameter -%}
+    {{parameter.name}}_buf, {{parameter.name}}_size
+    {%- elif parameter is OutParameter -%}
+    {{parameter.name}}_buf
+    {%- elif parameter is ByteArray -%}
+    {{parameter.name}}_ptr, len({{parameter.name}})
+    {%- elif parameter is ArrayParameter -%}
+    {{parameter.name}}, len({{parameter.name}})
+    {%- else -%}
+    {{parameter.name}}
+    {%- endif %}
+    {%- if not loop.last %}, {% endif %}
+{%- endfor %}
+{%- endmacro %}
+
+{#- Convert the C function's return value. #}
+{%- macro convert_result(function) %}
+    {%- if function.returnType|FormatType == 'le_result_t' %}
+    result = _ResultValues[result]
+    {%- elif function.returnType is EnumType %}
+    result = _{{function.returnType.name}}Values[result]
+    {%- elif function.returnType is BasicType and function.returnType.name == 'bool' %}
+    result = bool(result)
+    {%- endif %}
+{%- endmacro %}
+
 {%- for function in functions %}
 
 
 {{function.comment|PyFormatHeaderComment}}
 {%- if function is not EventFunction %}
+{%- set outputs = function.parameters|select("OutParameter")|list %}
+{%- set inputs = function.parameters|select("InParameter")|list %}
 
 {{function.name}}ReturnTuple = namedtuple('{{function.name}}ReturnTuple','result
-    {%- for parameter in function.parameters if parameter.direction == 2 %} {{parameter.name}}
+    {%- for parameter in outputs %} {{parameter.name}}
 {%- endfor %}')
+{%- if outputs %}
+
+def _{{function.name}}Buffers():
+    {#- The output buffers are allocated once per thread, rather than on every call. #}
+    try:
+        return _buffers.{{function.name}}
+    except AttributeError:
+        _buffers.{{function.name}} = (
+        {%- for parameter in outputs %}
+            {%- if parameter is StringParameter %}
+            ffi.new("char[]", {{parameter.maxCount + 1}}),
+            {%- elif parameter is ArrayParameter %}
+            ffi.new("{{parameter.apiType|FormatType}}[]", {{parameter.maxCount}}),
+            ffi.new("size_t *"),
+            {%- else %}
+            ffi.new("{{parameter.apiType|FormatType}} *"),
+            {%- endif %}
+        {%- endfor %}
+        )
+        return _buffers.{{function.name}}
+{%- endif %}
 
 def {{function.name}}(
 {% set add_default = False %}
@@ -96,51 +182,59 @@ def {{function.name}}(
     {%- endif %}
     {%- if not loop.last %}, {% endif %}
 {%- endfor %}):
-    {% set add_default = False %}
-    {%- for parameter in function.parameters %}
-        {%- if parameter.direction == 2 %}
-            {#- do only output parameters need to be converted to pointers? probably. #}
-            {%- if parameter.apiType|FormatType == 'char*' %}
-    {{parameter.name}}_ptr = ffi.new("char[]", {{parameter.name}} if {{parameter.name}} is not None else 256)
-    {#- i.e. default to blank char[256] if no string or length provided #}
-            {%- else %}
-    {{parameter.name}}_ptr = ffi.new("{{parameter.apiType|FormatType}} *")
+    {%- if outputs %}
+    {{ output_buffers(outputs) }} = _{{function.name}}Buffers()
+    {%- endif %}
+    {%- for parameter in outputs %}
+        {#- Outputs passed by the caller are initial values, string sizes, or buffers for byte
+            arrays, as they were before the buffers were reused. #}
+        {%- if parameter is StringParameter %}
     if {{parameter.name}} is not None:
-        {{parameter.name}}_ptr[0] = {{parameter.name}}
-    {#- TODO does this work for all types? might need more complex conversion #}
-            {%- endif %}
-    {{parameter.name}} = {{parameter.name}}_ptr
-        {%- elif parameter.direction == 1 %}
-            {%- if "BitMask" in parameter.apiType|FormatType %}
-            {#- The C function needs an integer #}
-    {{parameter.name}} = {{parameter.name}}.value
-            {%- endif %}
+        {{parameter.name}}_buf = ffi.new("char[]", {{parameter.name}})
+        {%- elif parameter is ByteArray %}
+    if {{parameter.name}} is None:
+        {{parameter.name}}_size[0] = {{parameter.maxCount}}
+    else:
+        {{parameter.name}}_buf = ffi.cast("{{parameter.apiType|FormatType}} *", ffi.from_buffer({{parameter.name}}))
+        {{parameter.name}}_size[0] = min(len({{parameter.name}}), {{parameter.maxCount}})
+        {%- elif parameter is ArrayParameter %}
+    {{parameter.name}}_size[0] = {{parameter.maxCount}}
+        {%- else %}
+    if {{parameter.name}} is not None:
+        {{parameter.name}}_buf[0] = {{parameter.name}}
         {%- endif %}
     {%- endfor %}
-    result = lib.{{apiName}}_{{function.name}}(
-        {%- for parameter in function.parameters %}{{parameter.name}}
-        {#- If it's an output char*, fill out the size parameter #}
-        {%- if parameter.apiType|FormatType == 'char*' and parameter.direction == 2 %}, ffi.sizeof({{parameter.name}}) {%- endif -%}
-        {%- if not loop.last %}, {% endif %}
-        {%- endfor %})
-    {#- Casting back to python types #}
-    {%- for parameter in function.parameters if parameter.direction == 2 %}
-    {{parameter|CDataToPython}}
+    {{- convert_inputs(inputs) }}
+    result = lib.{{apiName}}_{{function.name}}({{ c_arguments(function) }})
+    {{- convert_result(function) }}
+    {%- for parameter in outputs %}
+        {%- if parameter is ByteArray %}
+    {{parameter.name}} = {{parameter|OutputToPython}} if {{parameter.name}} is None else memoryview({{parameter.name}})[:{{parameter.name}}_size[0]]
+        {%- endif %}
     {%- endfor %}
-    {%- if function.returnType|FormatType == 'le_result_t' %}
-    result = Result(result)
-    {%- elif function.returnType is EnumType %}
-    result = {{function.returnType.name}}(result)
-    {%- elif function.returnType is BasicType and function.returnType.name == 'bool' %}
-    result = bool(result)
-    {%- else %}
-    # Not sure how to convert returnType = {{function.returnType}}
-    {%- endif %}
-    return {{function.name}}ReturnTuple(result=result{%- for parameter in function.parameters if parameter.direction == 2 %}, {{parameter.name}}={{parameter.name}}{%- endfor %})
-
-
-
+    return {{function.name}}ReturnTuple(result{% for parameter in outputs %}, {% if parameter is ByteArray %}{{parameter.name}}{% else %}{{parameter|OutputToPython}}{% endif %}{% endfor %})
 
+def {{function.name}}Batch(calls):
+    '''
+    Call {{function.name}}() once for each tuple of input arguments in calls, and return the list of
+    {{function.name}}ReturnTuple results.  This saves looking up the function and the output buffers
+    on every call.
+    '''
+    {%- if outputs %}
+    {{ output_buffers(outputs) }} = _{{function.name}}Buffers()
+    {%- endif %}
+    call = lib.{{apiName}}_{{function.name}}
+    results = []
+    append = results.append
+    for {% for parameter in inputs %}{{parameter.name}}, {% else %}_ {% endfor %}in calls:
+        {%- for parameter in outputs if parameter is ArrayParameter %}
+        {{parameter.name}}_size[0] = {{parameter.maxCount}}
+        {%- endfor %}
+        {{- convert_inputs(inputs)|indent(4) }}
+        result = call({{ c_arguments(function) }})
+        {{- convert_result(function)|indent(4) }}
+        append({{function.name}}ReturnTuple(result{% for parameter in outputs %}, {{parameter|OutputToPython}}{% endfor %}))
+    return results
 
 {%-else%}
 
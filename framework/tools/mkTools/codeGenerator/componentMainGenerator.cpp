@@ -15,7 +15,7 @@
 //--------------------------------------------------------------------------------------------------
 static void DefineServiceNameVars
 (
-    std::ofstream& fileStream,      ///< File stream to write to.
+    std::ostream& fileStream,       ///< File stream to write to.
     const model::ApiRef_t* interfacePtr,  ///< Ptr to client or server interface.
     bool isStandAlone   ///< true = fully resolve all interface name variables.
 )
@@ -87,15 +87,9 @@ void GenerateCLangComponentMainFile
                   << std::endl;
     }
 
-    // Open the .c file for writing.
+    // Generate the .c file.  It is only written if it changed.
     file::MakeDir(outputDir);
-    std::ofstream fileStream(filePath, std::ofstream::trunc);
-    if (!fileStream.is_open())
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Failed to open file '%s' for writing."), filePath)
-        );
-    }
+    file::GeneratedFile_t fileStream(filePath);
 
     // Generate file header and #include directives.
     fileStream << "/*\n"
@@ -214,6 +208,8 @@ void GenerateCLangComponentMainFile
                   "#ifdef __cplusplus\n"
                   "}\n"
                   "#endif\n";
+
+    fileStream.Close();
 }
 
 
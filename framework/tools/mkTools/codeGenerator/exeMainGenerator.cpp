@@ -43,15 +43,9 @@ void GenerateCLangExeMain
                   << std::endl;
     }
 
-    // Open the file as an output stream.
+    // Open the file as an output stream.  It is only written if it changed.
     file::MakeDir(path::GetContainingDir(sourceFile));
-    std::ofstream outputFile(sourceFile);
-    if (outputFile.is_open() == false)
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Could not open '%s' for writing."), sourceFile)
-        );
-    }
+    file::GeneratedFile_t outputFile(sourceFile);
 
     // Generate the file header comment and #include directives.
     outputFile << "\n"
@@ -205,7 +199,7 @@ void GenerateCLangExeMain
                   "    LE_FATAL(\"== SHOULDN'T GET HERE! ==\");\n"
                   "}\n";
 
-    outputFile.close();
+    outputFile.Close();
 }
 
 
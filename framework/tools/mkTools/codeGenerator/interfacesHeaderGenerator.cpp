@@ -40,14 +40,8 @@ void GenerateCLangInterfacesHeader
     // Make sure the working file output directory exists.
     file::MakeDir(outputDir);
 
-    // Open the interfaces.h file for writing.
-    std::ofstream fileStream(filePath, std::ofstream::trunc);
-    if (!fileStream.is_open())
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Failed to open file '%s' for writing."), filePath)
-        );
-    }
+    // Generate the interfaces.h file.  It is only written if it changed.
+    file::GeneratedFile_t fileStream(filePath);
 
     std::string includeGuardName = "__" + componentPtr->name
                                         + "_COMPONENT_INTERFACE_H_INCLUDE_GUARD";
@@ -102,6 +96,8 @@ void GenerateCLangInterfacesHeader
                   "#endif\n"
                   "\n"
                   "#endif // " << includeGuardName << "\n";
+
+    fileStream.Close();
 }
 
 
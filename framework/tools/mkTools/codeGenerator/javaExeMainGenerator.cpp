@@ -28,15 +28,9 @@ void GenerateJavaExeMain
     // Compute the path to the file to be generated.
     auto sourceFile = exePtr->MainObjectFile().sourceFilePath;
 
-    // Open the file as an output stream.
+    // Open the file as an output stream.  It is only written if it changed.
     file::MakeDir(path::GetContainingDir(sourceFile));
-    std::ofstream outputFile(sourceFile);
-    if (outputFile.is_open() == false)
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Could not open '%s' for writing."), sourceFile)
-        );
-    }
+    file::GeneratedFile_t outputFile(sourceFile);
 
     auto& exeName = exePtr->name;
     auto& appName = exePtr->appPtr->name;
@@ -116,6 +110,8 @@ void GenerateJavaExeMain
                   "        }\n"
                   "    }\n"
                   "}\n";
+
+    outputFile.Close();
 }
 
 
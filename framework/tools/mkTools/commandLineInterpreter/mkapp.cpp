@@ -377,8 +377,14 @@ void MakeApp
         envVars::Save(BuildParams);
     }
 
-    // Construct a model of the application.
-    model::App_t* appPtr = modeller::GetApp(AdefFilePath, BuildParams);
+    // Construct a model of the application, parsing the .cdef files of its components ahead.
+    model::App_t* appPtr;
+    {
+        parser::ParseAhead_t parseAhead(BuildParams);
+
+        parseAhead.AddAdef(AdefFilePath);
+        appPtr = modeller::GetApp(AdefFilePath, BuildParams);
+    }
 
     // Append a "." and the VersionSuffix if the user provides a
     // "--append or -a" argument in the command line.
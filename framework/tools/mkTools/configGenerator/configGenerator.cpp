@@ -18,7 +18,7 @@ namespace config
 //--------------------------------------------------------------------------------------------------
 static void GenerateAppVersionConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     const model::App_t* appPtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -37,7 +37,7 @@ static void GenerateAppVersionConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateAppLimitsConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     const model::App_t* appPtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -93,7 +93,7 @@ static void GenerateAppLimitsConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateGroupsConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     const model::App_t* appPtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -128,7 +128,7 @@ static void GenerateGroupsConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateSingleFileMappingConfig
 (
-    std::ofstream& cfgStream,   ///< Stream to send the configuration to.
+    std::ostream& cfgStream,    ///< Stream to send the configuration to.
     size_t          index,      ///< The index of the file in the files list in the configuration.
     const model::FileSystemObject_t* mappingPtr  ///< The file mapping.
 )
@@ -163,7 +163,7 @@ static void GenerateSingleFileMappingConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateBundledObjectMappingConfig
 (
-    std::ofstream& cfgStream,   ///< Stream to send the configuration to.
+    std::ostream& cfgStream,    ///< Stream to send the configuration to.
     size_t          index,      ///< Index of the mapping in the files list in the configuration.
     const model::FileSystemObject_t* mappingPtr  ///< The mapping.
 )
@@ -220,7 +220,7 @@ static void GenerateBundledObjectMappingConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateFileMappingConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     const model::App_t* appPtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -400,7 +400,7 @@ static void GenerateFileMappingConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateProcessEnvVarsConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     const model::App_t* appPtr,
     const model::ProcessEnv_t* procEnvPtr
 )
@@ -492,7 +492,7 @@ static std::string GenerateClassPath
 //--------------------------------------------------------------------------------------------------
 static void GenerateProcessConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     const model::App_t* appPtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -609,7 +609,7 @@ static void GenerateProcessConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateSingleApiBindingToUser
 (
-    std::ofstream& cfgStream,           ///< Stream to send the configuration to.
+    std::ostream& cfgStream,            ///< Stream to send the configuration to.
     const std::string& clientInterface, ///< Client interface name.
     const std::string& serverUserName,  ///< User name of the server.
     const std::string& serviceName      ///< Service instance name the server will advertise.
@@ -631,7 +631,7 @@ static void GenerateSingleApiBindingToUser
 //--------------------------------------------------------------------------------------------------
 static void GenerateSingleApiBindingToApp
 (
-    std::ofstream& cfgStream,           ///< Stream to send the configuration to.
+    std::ostream& cfgStream,            ///< Stream to send the configuration to.
     const std::string& clientInterface, ///< Client interface name.
     const std::string& serverAppName,   ///< Name of the application running the server.
     const std::string& serviceName      ///< Service instance name the server will advertise.
@@ -653,7 +653,7 @@ static void GenerateSingleApiBindingToApp
 //--------------------------------------------------------------------------------------------------
 static void GenerateBindingConfig
 (
-    std::ofstream& cfgStream,       ///< Stream to send the configuration to.
+    std::ostream& cfgStream,        ///< Stream to send the configuration to.
     const model::Binding_t* bindingPtr  ///< Binding to internal exe.component.interface.
 )
 //--------------------------------------------------------------------------------------------------
@@ -688,7 +688,7 @@ static void GenerateBindingConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateBindingsConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     model::App_t* appPtr,
     const mk::BuildParams_t& buildParams
 )
@@ -749,7 +749,7 @@ static void GenerateBindingsConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateConfigTreeAclConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     model::App_t* appPtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -790,7 +790,7 @@ static void GenerateConfigTreeAclConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateAppWatchdogConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     model::App_t* appPtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -839,14 +839,8 @@ void Generate
                   << std::endl;
     }
 
-    std::ofstream cfgStream(filePath, std::ofstream::trunc);
-
-    if (cfgStream.is_open() == false)
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Could not open '%s' for writing."), filePath)
-        );
-    }
+    // The file is only written if it changed.
+    file::GeneratedFile_t cfgStream(filePath);
 
     cfgStream << "{" << std::endl;
 
@@ -867,6 +861,8 @@ void Generate
     GenerateAppWatchdogConfig(cfgStream, appPtr);
 
     cfgStream << "}" << std::endl;
+
+    cfgStream.Close();
 }
 
 
@@ -879,7 +875,7 @@ static void GenerateConfigEachModuleFile
 (
     model::System_t* systemPtr,
     model::Module_t* modulePtr,
-    std::ofstream& cfgStream
+    std::ostream& cfgStream
 )
 {
     cfgStream << "  {\n";
@@ -940,9 +936,11 @@ static void GenerateConfigEachModuleFile
 /**
  * Generate kernel module configuration in a file called config/modules.cfg under
  * the system's staging directory.
+ *
+ * @return The content of the file.
  */
 //--------------------------------------------------------------------------------------------------
-static void GenerateModulesConfig
+static std::string GenerateModulesConfig
 (
     model::System_t* systemPtr,
     const mk::BuildParams_t& buildParams
@@ -958,14 +956,8 @@ static void GenerateModulesConfig
                   << std::endl;
     }
 
-    std::ofstream cfgStream(filePath, std::ofstream::trunc);
-
-    if (cfgStream.is_open() == false)
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Could not open '%s' for writing."), filePath)
-        );
-    }
+    // The file is only written if it changed.
+    file::GeneratedFile_t cfgStream(filePath);
 
     cfgStream << "{\n";
 
@@ -990,6 +982,10 @@ static void GenerateModulesConfig
     }
 
     cfgStream << "}\n";
+
+    cfgStream.Close();
+
+    return cfgStream.str();
 }
 
 
@@ -997,9 +993,11 @@ static void GenerateModulesConfig
 /**
  * Generate user binding configuration for non-app users in a file called config/users.cfg under
  * the system's staging directory.
+ *
+ * @return The content of the file.
  */
 //--------------------------------------------------------------------------------------------------
-static void GenerateUsersConfig
+static std::string GenerateUsersConfig
 (
     model::System_t* systemPtr,
     const mk::BuildParams_t& buildParams
@@ -1015,14 +1013,8 @@ static void GenerateUsersConfig
                   << std::endl;
     }
 
-    std::ofstream cfgStream(filePath, std::ofstream::trunc);
-
-    if (cfgStream.is_open() == false)
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Could not open '%s' for writing."), filePath)
-        );
-    }
+    // The file is only written if it changed.
+    file::GeneratedFile_t cfgStream(filePath);
 
     cfgStream << "{\n";
 
@@ -1047,6 +1039,10 @@ static void GenerateUsersConfig
     }
 
     cfgStream << "}\n";
+
+    cfgStream.Close();
+
+    return cfgStream.str();
 }
 
 
@@ -1059,7 +1055,7 @@ static void GenerateUsersConfig
 //--------------------------------------------------------------------------------------------------
 static void AddAppConfig
 (
-    std::ofstream& cfgStream,    ///< The configuration file being written to.
+    std::ostream& cfgStream,     ///< The configuration file being written to.
     model::App_t* appPtr,
     const mk::BuildParams_t& buildParams
 )
@@ -1090,9 +1086,11 @@ static void AddAppConfig
 /**
  * Generate the application configuration settings file "apps.cfg" in the "config" directory
  * of the system's staging directory.
+ *
+ * @return The content of the file.
  */
 //--------------------------------------------------------------------------------------------------
-static void GenerateAppsConfig
+static std::string GenerateAppsConfig
 (
     model::System_t* systemPtr,     ///< The system to generate the configuration for.
     const mk::BuildParams_t& buildParams
@@ -1108,14 +1106,8 @@ static void GenerateAppsConfig
                   << std::endl;
     }
 
-    std::ofstream cfgStream(filePath, std::ofstream::trunc);
-
-    if (cfgStream.is_open() == false)
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Could not open '%s' for writing."), filePath)
-        );
-    }
+    // The file is only written if it changed.
+    file::GeneratedFile_t cfgStream(filePath);
 
     cfgStream << "{\n";
 
@@ -1129,6 +1121,10 @@ static void GenerateAppsConfig
     }
 
     cfgStream << "}\n";
+
+    cfgStream.Close();
+
+    return cfgStream.str();
 }
 
 
@@ -1139,7 +1135,7 @@ static void GenerateAppsConfig
 //--------------------------------------------------------------------------------------------------
 static void GenerateExternalWatchdogKickConfig
 (
-    std::ofstream& cfgStream,
+    std::ostream& cfgStream,
     const model::System_t* systemPtr
 )
 {
@@ -1154,9 +1150,11 @@ static void GenerateExternalWatchdogKickConfig
 /**
  * Generate the framework watchdog configuration settings file "framework.cfg" in the "config"
  * directory of the system's staging directory.
+ *
+ * @return The content of the file.
  */
 //--------------------------------------------------------------------------------------------------
-static void GenerateFrameworkConfig
+static std::string GenerateFrameworkConfig
 (
     model::System_t* systemPtr,     ///< The system to generate the configuration for.
     const mk::BuildParams_t& buildParams
@@ -1173,20 +1171,69 @@ static void GenerateFrameworkConfig
     }
 
 
-    std::ofstream cfgStream(filePath, std::ofstream::trunc);
-
-    if (cfgStream.is_open() == false)
-    {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Could not open '%s' for writing."), filePath)
-        );
-    }
+    // The file is only written if it changed.
+    file::GeneratedFile_t cfgStream(filePath);
 
     cfgStream << "{" << std::endl;
 
     GenerateExternalWatchdogKickConfig(cfgStream, systemPtr);
 
     cfgStream << "}" << std::endl;
+
+    cfgStream.Close();
+
+    return cfgStream.str();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Generate a snapshot of the system configuration tree in a file called "system.snap" in the
+ * "config" directory of the system's staging directory.  A read-only system uses it as its system
+ * tree, which loads faster than the text files (see mklegatotreero).
+ *
+ * If the Config Tree couldn't load the configuration, no snapshot is generated, and a read-only
+ * system falls back to the text files.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void GenerateSystemSnapshot
+(
+    const std::string& systemConfig,    ///< The system configuration tree, in text form.
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string filePath = path::Combine(buildParams.workingDir, "staging/config/system.snap");
+
+    if (buildParams.beVerbose)
+    {
+        std::cout << mk::format(LE_I18N("Generating system configuration snapshot in file '%s'."),
+                                filePath)
+                  << std::endl;
+    }
+
+    std::ostringstream snapStream;
+
+    try
+    {
+        WriteSnapshot(systemConfig, snapStream);
+    }
+    catch (mk::Exception_t& e)
+    {
+        std::cerr << mk::format(LE_I18N("** WARNING: No system configuration snapshot: %s"),
+                                e.what())
+                  << std::endl;
+
+        file::DeleteFile(filePath);
+        return;
+    }
+
+    // The file is only written if it changed.
+    file::GeneratedFile_t fileStream(filePath);
+
+    fileStream << snapStream.str();
+
+    fileStream.Close();
 }
 
 
@@ -1210,13 +1257,21 @@ void Generate
 {
     file::MakeDir(path::Combine(buildParams.workingDir, "staging/config"));
 
-    GenerateModulesConfig(systemPtr, buildParams);
+    auto modulesConfig = GenerateModulesConfig(systemPtr, buildParams);
+
+    auto usersConfig = GenerateUsersConfig(systemPtr, buildParams);
 
-    GenerateUsersConfig(systemPtr, buildParams);
+    auto appsConfig = GenerateAppsConfig(systemPtr, buildParams);
 
-    GenerateAppsConfig(systemPtr, buildParams);
+    auto frameworkConfig = GenerateFrameworkConfig(systemPtr, buildParams);
 
-    GenerateFrameworkConfig(systemPtr, buildParams);
+    // Combine them into the system tree, the way mklegatotreero does for read-only systems.
+    GenerateSystemSnapshot("{ \"users\" " + usersConfig +
+                           " \"apps\" " + appsConfig +
+                           " \"modules\" " + modulesConfig +
+                           " \"framework\" " + frameworkConfig +
+                           " }",
+                           buildParams);
 }
 
 
@@ -46,6 +46,20 @@ void Generate
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert configuration data from its text form to a snapshot, which the Config Tree loads faster.
+ *
+ * @throw mk::Exception_t if the text isn't something the Config Tree can load.
+ **/
+//--------------------------------------------------------------------------------------------------
+void WriteSnapshot
+(
+    const std::string& text,    ///< Configuration data, in text form.
+    std::ostream& snapStream    ///< Stream to write the snapshot to.
+);
+
+
 } // namespace config
 
 #endif // LEGATO_MKTOOLS_CONFIG_GENERATOR_H_INCLUDE_GUARD
@@ -0,0 +1,419 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file configSnapshot.cpp  Conversion of configuration data to Config Tree snapshots.
+ *
+ * A snapshot is a binary form of a configuration tree, that the Config Tree loads by walking a
+ * mapping of the file rather than by tokenizing text.  The format is described in the Config
+ * Tree's treeDb.c, and the constants here must match the ones there.
+ *
+ * The text is read the way the Config Tree reads it, so that loading the snapshot gives the same
+ * tree as loading the text.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "mkTools.h"
+
+namespace config
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Magic number a snapshot starts with.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char SnapshotMagic[] = "\x89" "LECFG1\n";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Types of the nodes in a snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+enum SnapshotType_t
+{
+    SNAPSHOT_EMPTY  = 0,
+    SNAPSHOT_BOOL   = 1,
+    SNAPSHOT_INT    = 2,
+    SNAPSHOT_FLOAT  = 3,
+    SNAPSHOT_STRING = 4,
+    SNAPSHOT_STEM   = 5
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Limits of the Config Tree (see le_cfg.api).
+ */
+//--------------------------------------------------------------------------------------------------
+static const size_t MaxStringLen = 511;
+static const size_t MaxNameLen = 127;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A node of a configuration tree.
+ */
+//--------------------------------------------------------------------------------------------------
+struct SnapshotNode_t
+{
+    SnapshotType_t type = SNAPSHOT_EMPTY;
+    std::string name;
+    std::string value;                                      ///< Text of the value, if any.
+    std::vector<std::unique_ptr<SnapshotNode_t>> children;  ///< Children, in order, if a stem.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a character is white space, for the Config Tree.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsWhiteSpace
+(
+    char c
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (c == '\n') || (c == '\r') || (c == '\t') || (c == ' ');
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reader of configuration data in text form.
+ */
+//--------------------------------------------------------------------------------------------------
+class TextReader_t
+{
+    public:
+
+        TextReader_t(const std::string& text) : text(text), pos(0) {}
+
+        void ReadNode(SnapshotNode_t& node, size_t pathLen);
+        void ReadEnd();
+
+    private:
+
+        char ReadTokenStart();
+        std::string ReadLiteral(char terminal);
+
+        const std::string& text;
+        size_t pos;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Skip white space and read the first character of a token.
+ *
+ * @throw mk::Exception_t at the end of the text.
+ */
+//--------------------------------------------------------------------------------------------------
+char TextReader_t::ReadTokenStart
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while ((pos < text.size()) && IsWhiteSpace(text[pos]))
+    {
+        pos++;
+    }
+
+    if (pos >= text.size())
+    {
+        throw mk::Exception_t(LE_I18N("Unexpected end of configuration data."));
+    }
+
+    return text[pos++];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the rest of a literal, up to its terminal character.
+ *
+ * @throw mk::Exception_t if the literal is unterminated or too long.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string TextReader_t::ReadLiteral
+(
+    char terminal
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string literal;
+
+    for (;;)
+    {
+        if (pos >= text.size())
+        {
+            throw mk::Exception_t(LE_I18N("Unterminated literal in configuration data."));
+        }
+
+        char next = text[pos++];
+
+        if (next == terminal)
+        {
+            return literal;
+        }
+
+        if (next == '\\')
+        {
+            if (pos >= text.size())
+            {
+                throw mk::Exception_t(LE_I18N("Unterminated literal in configuration data."));
+            }
+
+            next = text[pos++];
+        }
+
+        literal.push_back(next);
+
+        // The Config Tree reads literals into a buffer of MaxStringLen + 1 bytes, and rejects the
+        // ones that don't leave two bytes free.
+        if (literal.size() >= MaxStringLen)
+        {
+            throw mk::Exception_t(
+                mk::format(LE_I18N("Literal '%s' too long in configuration data."), literal)
+            );
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a node, and its children if it is a collection.  A child that appears more than once is
+ * replaced in place, as the Config Tree does.
+ *
+ * @throw mk::Exception_t if the text isn't valid.
+ */
+//--------------------------------------------------------------------------------------------------
+void TextReader_t::ReadNode
+(
+    SnapshotNode_t& node,
+    size_t pathLen          ///< Length of the path of the node.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    node.type = SNAPSHOT_EMPTY;
+    node.value.clear();
+    node.children.clear();
+
+    switch (ReadTokenStart())
+    {
+        case '~':
+            break;
+
+        case '!':
+            if ((pos >= text.size()) || ((text[pos] != 't') && (text[pos] != 'f')))
+            {
+                throw mk::Exception_t(LE_I18N("Bad boolean value in configuration data."));
+            }
+            node.type = SNAPSHOT_BOOL;
+            node.value = text.substr(pos++, 1);
+            break;
+
+        case '[':
+            node.type = SNAPSHOT_INT;
+            node.value = ReadLiteral(']');
+            break;
+
+        case '(':
+            node.type = SNAPSHOT_FLOAT;
+            node.value = ReadLiteral(')');
+            break;
+
+        case '"':
+            node.type = SNAPSHOT_STRING;
+            node.value = ReadLiteral('"');
+            break;
+
+        case '{':
+            for (;;)
+            {
+                char next = ReadTokenStart();
+
+                if (next == '}')
+                {
+                    break;
+                }
+
+                if (next != '"')
+                {
+                    throw mk::Exception_t(LE_I18N("Unexpected token in configuration data while "
+                                                  "looking for '}'."));
+                }
+
+                auto name = ReadLiteral('"');
+
+                if (   name.empty() || (name == ".") || (name == "..")
+                    || (name.find_first_of("/:") != std::string::npos)
+                    || (name.size() > MaxNameLen))
+                {
+                    throw mk::Exception_t(
+                        mk::format(LE_I18N("Bad node name '%s' in configuration data."), name)
+                    );
+                }
+
+                size_t childPathLen = pathLen + 1 + name.size();
+
+                if (childPathLen > MaxStringLen)
+                {
+                    throw mk::Exception_t(
+                        mk::format(LE_I18N("Path of node '%s' too long in configuration data."),
+                                   name)
+                    );
+                }
+
+                SnapshotNode_t* childPtr = NULL;
+
+                for (auto& existingPtr : node.children)
+                {
+                    if (existingPtr->name == name)
+                    {
+                        childPtr = existingPtr.get();
+                    }
+                }
+
+                if (childPtr == NULL)
+                {
+                    node.children.emplace_back(new SnapshotNode_t());
+                    childPtr = node.children.back().get();
+                    childPtr->name = name;
+                }
+
+                ReadNode(*childPtr, childPathLen);
+
+                node.type = SNAPSHOT_STEM;
+            }
+            break;
+
+        default:
+            throw mk::Exception_t(LE_I18N("Unexpected character in configuration data."));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that nothing but white space is left.
+ *
+ * @throw mk::Exception_t if something is.
+ */
+//--------------------------------------------------------------------------------------------------
+void TextReader_t::ReadEnd
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while ((pos < text.size()) && IsWhiteSpace(text[pos]))
+    {
+        pos++;
+    }
+
+    if (pos < text.size())
+    {
+        throw mk::Exception_t(LE_I18N("Unexpected token at the end of configuration data."));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a little-endian number.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteNumber
+(
+    std::ostream& snapStream,
+    size_t byteCount,
+    uint32_t value
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (size_t i = 0; i < byteCount; i++)
+    {
+        snapStream.put(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a string, preceded by its length.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteString
+(
+    std::ostream& snapStream,
+    const std::string& string
+)
+//--------------------------------------------------------------------------------------------------
+{
+    WriteNumber(snapStream, 2, string.size());
+    snapStream << string;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a node, and its children.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteNode
+(
+    std::ostream& snapStream,
+    const SnapshotNode_t& node
+)
+//--------------------------------------------------------------------------------------------------
+{
+    WriteNumber(snapStream, 1, node.type);
+
+    if (node.type == SNAPSHOT_STEM)
+    {
+        WriteNumber(snapStream, 4, node.children.size());
+
+        for (auto& childPtr : node.children)
+        {
+            WriteString(snapStream, childPtr->name);
+            WriteNode(snapStream, *childPtr);
+        }
+    }
+    else if (node.type != SNAPSHOT_EMPTY)
+    {
+        WriteString(snapStream, node.value);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert configuration data from its text form to a snapshot.
+ *
+ * @throw mk::Exception_t if the text isn't something the Config Tree can load.
+ */
+//--------------------------------------------------------------------------------------------------
+void WriteSnapshot
+(
+    const std::string& text,    ///< Configuration data, in text form.
+    std::ostream& snapStream    ///< Stream to write the snapshot to.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    SnapshotNode_t root;
+    TextReader_t reader(text);
+
+    // The path of the root node is a separator, plus the terminator.
+    reader.ReadNode(root, 2);
+    reader.ReadEnd();
+
+    snapStream.write(SnapshotMagic, sizeof(SnapshotMagic) - 1);
+    WriteNode(snapStream, root);
+}
+
+
+} // namespace config
@@ -19,6 +19,14 @@ namespace envVars
 {
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Variables overridden for the calling thread only (see SetForThread()), by name.
+ */
+//--------------------------------------------------------------------------------------------------
+static thread_local std::map<std::string, std::string> ThreadOverrides;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetch the value of a given optional environment variable.
@@ -32,6 +40,12 @@ std::string Get
 )
 //--------------------------------------------------------------------------------------------------
 {
+    auto overrideIter = ThreadOverrides.find(name);
+    if (overrideIter != ThreadOverrides.end())
+    {
+        return overrideIter->second;
+    }
+
     const char* value = getenv(name.c_str());
 
     if (value == nullptr)
@@ -93,6 +107,26 @@ void Set
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Override the value of a given environment variable for the calling thread only, without
+ * changing the process's environment.  Get() returns the overridden value from then on.
+ *
+ * This is used for variables whose value depends on the file being parsed (e.g., CURDIR), so
+ * that several files can be parsed at the same time.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetForThread
+(
+    const std::string& name,  ///< The name of the environment variable.
+    const std::string& value  ///< The value of the environment variable.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ThreadOverrides[name] = value;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Set compiler, linker, etc. environment variables according to the target device type, if they're
@@ -56,6 +56,22 @@ void Set
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Override the value of a given environment variable for the calling thread only, without
+ * changing the process's environment.  Get() returns the overridden value from then on.
+ *
+ * This is used for variables whose value depends on the file being parsed (e.g., CURDIR), so
+ * that several files can be parsed at the same time.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetForThread
+(
+    const std::string& name,  ///< The name of the environment variable.
+    const std::string& value  ///< The value of the environment variable.
+);
+
+
 //----------------------------------------------------------------------------------------------
 /**
  * Adds target-specific environment variables (e.g., LEGATO_TARGET) to the process's environment.
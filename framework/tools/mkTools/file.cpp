@@ -437,4 +437,97 @@ void DeleteFile
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.  Nothing is written until Close() is called.
+ **/
+//--------------------------------------------------------------------------------------------------
+GeneratedFile_t::GeneratedFile_t
+(
+    const std::string& path     ///< Path of the file.
+)
+//--------------------------------------------------------------------------------------------------
+:   path(path),
+    isClosed(false)
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor.  Closes the file if Close() wasn't called.  Exceptions can't be thrown from here,
+ * so errors are reported to the standard error stream.
+ **/
+//--------------------------------------------------------------------------------------------------
+GeneratedFile_t::~GeneratedFile_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!isClosed)
+    {
+        try
+        {
+            Close();
+        }
+        catch (mk::Exception_t& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the file, unless it already has this content.
+ *
+ * @throw mk::Exception_t if the file can't be written.
+ **/
+//--------------------------------------------------------------------------------------------------
+void GeneratedFile_t::Close
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    isClosed = true;
+
+    const std::string content = str();
+    struct stat statBuffer;
+
+    // Only read the old file if it can possibly be the same.
+    if (   (stat(path.c_str(), &statBuffer) == 0)
+        && S_ISREG(statBuffer.st_mode)
+        && (static_cast<size_t>(statBuffer.st_size) == content.size()))
+    {
+        std::ifstream oldFile(path, std::ifstream::binary);
+        std::string oldContent((std::istreambuf_iterator<char>(oldFile)),
+                               std::istreambuf_iterator<char>());
+
+        if (!oldFile.bad() && (oldContent == content))
+        {
+            return;
+        }
+    }
+
+    std::ofstream newFile(path, std::ofstream::trunc | std::ofstream::binary);
+    if (!newFile.is_open())
+    {
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to open file '%s' for writing."), path)
+        );
+    }
+
+    newFile << content;
+
+    newFile.close();
+    if (newFile.fail())
+    {
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to write file '%s'."), path)
+        );
+    }
+}
+
+
 } // namespace file
@@ -173,6 +173,36 @@ void DeleteFile
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Output stream for a generated file, which only writes the file if its content changed.
+ *
+ * This keeps the modification time of a regenerated file (and so, of everything built from it)
+ * unchanged when regenerating it doesn't change it.  The content is kept in memory until Close()
+ * is called.
+ **/
+//--------------------------------------------------------------------------------------------------
+class GeneratedFile_t : public std::ostringstream
+{
+    public:
+
+        // Constructor.  Nothing is written until Close() is called.
+        GeneratedFile_t(const std::string& path);
+
+        // Destructor.  Closes the file if Close() wasn't called, reporting errors to stderr.
+        ~GeneratedFile_t();
+
+        // Write the file, unless it already has this content.
+        void Close();
+
+        const std::string path;     ///< Path of the file.
+
+    private:
+
+        bool isClosed;              ///< true once Close() has been called.
+};
+
+
 } // namespace file
 
 #endif // LEGATO_MKTOOLS_FILE_H_INCLUDE_GUARD
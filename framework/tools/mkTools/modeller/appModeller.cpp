@@ -1747,7 +1747,7 @@ model::App_t* GetApp
 //--------------------------------------------------------------------------------------------------
 {
     // Parse the .adef file.
-    const auto adefFilePtr = parser::adef::Parse(adefPath, buildParams.beVerbose);
+    const auto adefFilePtr = parser::ParseAhead_t::GetAdef(adefPath, buildParams.beVerbose);
 
     // Create a new App_t object for this app.
     auto appPtr = new model::App_t(adefFilePtr);
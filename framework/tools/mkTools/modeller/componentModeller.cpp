@@ -1069,7 +1069,7 @@ model::Component_t* GetComponent
 
     // Parse the .cdef file.
     auto cdefFilePath = path::Combine(componentDir, "Component.cdef");
-    auto cdefFilePtr = parser::cdef::Parse(cdefFilePath, buildParams.beVerbose);
+    auto cdefFilePtr = parser::ParseAhead_t::GetCdef(cdefFilePath, buildParams.beVerbose);
 
     // Create a new object for this component.
     // By default, it will be built in a sub-directory called "component/<compName>" under the
@@ -217,24 +217,21 @@ static std::string FindBinAppAdef
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Creates an App_t object for a given app's subsection within an "apps:" section.
+ * Find the app name and the .adef or .app file of an app specification (the name of an app or a
+ * .adef/.app file path).
+ *
+ * @return true if the app is a binary app (.app file), false if not.
  */
 //--------------------------------------------------------------------------------------------------
-static void ModelApp
+static bool FindAppFile
 (
-    model::System_t* systemPtr,
-    const parseTree::App_t* sectionPtr,
-    const mk::BuildParams_t& buildParams
+    const std::string& appSpec,
+    const mk::BuildParams_t& buildParams,
+    std::string& appName,       ///< [OUT] Name of the app.
+    std::string& filePath       ///< [OUT] Path of the .adef/.app file ("" if not found).
 )
 //--------------------------------------------------------------------------------------------------
 {
-    std::string appName;
-    std::string filePath;
-
-    // The first token in the app subsection could be the name of an app or a .adef/.app file path.
-    // Find the app name and .adef/.app file.
-    const auto appSpec = path::Unquote(DoSubstitution(sectionPtr->firstTokenPtr));
-
     // Build a proper .app suffix that includes the target that the app was built against.
     const std::string appSuffix = "." + buildParams.target + ".app";
     bool isBinApp = false;
@@ -262,6 +259,34 @@ static void ModelApp
         }
     }
 
+    return isBinApp;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an App_t object for a given app's subsection within an "apps:" section.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ModelApp
+(
+    model::System_t* systemPtr,
+    const parseTree::App_t* sectionPtr,
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string appName;
+    std::string filePath;
+
+    // The first token in the app subsection could be the name of an app or a .adef/.app file path.
+    // Find the app name and .adef/.app file.
+    const auto appSpec = path::Unquote(DoSubstitution(sectionPtr->firstTokenPtr));
+
+    // Build a proper .app suffix that includes the target that the app was built against.
+    const std::string appSuffix = "." + buildParams.target + ".app";
+    bool isBinApp = FindAppFile(appSpec, buildParams, appName, filePath);
+
     // If neither adef nor app file has been found, report the error now.
     if (filePath.empty())
     {
@@ -707,6 +732,34 @@ static void ModelApps
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // Parse the apps' .adef files, and the .cdef files of their components, ahead of modelling.
+    parser::ParseAhead_t parseAhead(buildParams);
+
+    for (auto sectionPtr : appsSections)
+    {
+        auto appsSectionPtr = dynamic_cast<const parseTree::CompoundItemList_t*>(sectionPtr);
+
+        for (auto itemPtr : appsSectionPtr->Contents())
+        {
+            std::string appName;
+            std::string filePath;
+
+            // Errors are reported when the app is modelled.
+            try
+            {
+                auto appSpec = path::Unquote(DoSubstitution(itemPtr->firstTokenPtr));
+
+                if (!FindAppFile(appSpec, buildParams, appName, filePath) && !filePath.empty())
+                {
+                    parseAhead.AddAdef(filePath);
+                }
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
     for (auto sectionPtr : appsSections)
     {
         ModelAppsSection(systemPtr, sectionPtr, buildParams);
@@ -300,18 +300,19 @@ std::string DoSubstitution
     {
         // Currently we only populate CURDIR.  However in the future we may add other variables based on
         // where the fragment where the text came from.
+        // Only this thread sees it, as other threads may be parsing other files.
         oldDir = envVars::Get("CURDIR");
-        envVars::Set("CURDIR",
-                     path::MakeAbsolute(path::GetContainingDir(contentPtr->filePtr->path)));
+        envVars::SetForThread("CURDIR",
+                              path::MakeAbsolute(path::GetContainingDir(contentPtr->filePtr->path)));
     }
 
     // Actually subsitute any variables in the string now.
     auto result = DoSubstitution(originalString, usedVarsPtr);
 
-    // Restore the old value of CURDIR if we had changed it before.
+    // Restore the old value of CURDIR if we had changed it before, as this may be a nested parse.
     if (contentPtr != NULL)
     {
-        envVars::Set("CURDIR", oldDir);
+        envVars::SetForThread("CURDIR", oldDir);
     }
 
     return result;
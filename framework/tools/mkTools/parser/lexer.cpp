@@ -9,6 +9,14 @@
  */
 //--------------------------------------------------------------------------------------------------
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
 #include "mkTools.h"
 
 
@@ -18,7 +26,9 @@ namespace parser
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Constructor
+ * Constructor.  Maps the file into memory, so that tokens can be matched without copying the file
+ * through a stream one character at a time.  Files that can't be mapped (e.g., empty files) are
+ * read into a buffer instead.
  */
 //--------------------------------------------------------------------------------------------------
 Lexer_t::LexerContext_t::LexerContext_t
@@ -27,7 +37,10 @@ Lexer_t::LexerContext_t::LexerContext_t
 )
 //--------------------------------------------------------------------------------------------------
 :   filePtr(filePtr),
-    inputStream(filePtr->path),
+    dataPtr(NULL),
+    size(0),
+    pos(0),
+    isMapped(false),
     line(1),
     column(0),
     ifNestDepth(0)
@@ -40,38 +53,116 @@ Lexer_t::LexerContext_t::LexerContext_t
             mk::format(LE_I18N("File not found: '%s'."), filePtr->path)
         );
     }
-    if (!inputStream.is_open())
+
+    int fd = open(filePtr->path.c_str(), O_RDONLY);
+    if (fd < 0)
     {
         throw mk::Exception_t(
             mk::format(LE_I18N("Failed to open file '%s' for reading."), filePtr->path)
         );
     }
 
-    // Read in the first characters.
-    Buffer(2);
+    struct stat fileStat;
+    if ((fstat(fd, &fileStat) == 0) && S_ISREG(fileStat.st_mode) && (fileStat.st_size > 0))
+    {
+        void* mapPtr = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
 
-    if (inputStream.bad())
+        if (mapPtr != MAP_FAILED)
+        {
+            dataPtr = static_cast<const char*>(mapPtr);
+            size = fileStat.st_size;
+            isMapped = true;
+        }
+    }
+
+    if (!isMapped)
     {
-        throw mk::Exception_t(
-            mk::format(LE_I18N("Failed to read from file '%s'."), filePtr->path)
-        );
+        char readBuffer[4096];
+        ssize_t readCount;
+
+        while ((readCount = read(fd, readBuffer, sizeof(readBuffer))) != 0)
+        {
+            if (readCount < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                close(fd);
+
+                throw mk::Exception_t(
+                    mk::format(LE_I18N("Failed to read from file '%s'."), filePtr->path)
+                );
+            }
+
+            buffer.append(readBuffer, readCount);
+        }
+
+        dataPtr = buffer.data();
+        size = buffer.size();
     }
+
+    close(fd);
 }
 
+
 //--------------------------------------------------------------------------------------------------
 /**
- * Ensure at least n elements are present in the lookahead character buffer
+ * Destructor.  Unmaps the file.  Tokens hold copies of their text, so they remain valid.
  */
 //--------------------------------------------------------------------------------------------------
-void Lexer_t::LexerContext_t::Buffer
+Lexer_t::LexerContext_t::~LexerContext_t
 (
-    size_t n
 )
+//--------------------------------------------------------------------------------------------------
+{
+    if (isMapped)
+    {
+        munmap(const_cast<char*>(dataPtr), size);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look ahead in the file without consuming anything.
+ *
+ * @return The character n characters after the next one to be consumed, or EOF if that is past
+ *         the end of the file.
+ */
+//--------------------------------------------------------------------------------------------------
+inline int Lexer_t::LexerContext_t::Peek
+(
+    size_t n
+) const
+//--------------------------------------------------------------------------------------------------
 {
-    while (inputStream.good() && (nextChars.size() < n))
+    if (pos + n < size)
     {
-        nextChars.push_back(inputStream.get());
+        return static_cast<unsigned char>(dataPtr[pos + n]);
     }
+
+    return EOF;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if the next characters to be consumed are a given string.
+ *
+ * @return true if they are, false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+bool Lexer_t::LexerContext_t::IsNext
+(
+    const char* string
+) const
+//--------------------------------------------------------------------------------------------------
+{
+    size_t length = strlen(string);
+
+    return ((size - pos) >= length) && (memcmp(dataPtr + pos, string, length) == 0);
 }
 
 
@@ -199,42 +290,42 @@ bool Lexer_t::IsMatch
     switch (type)
     {
         case parseTree::Token_t::END_OF_FILE:
-            return (context.top().nextChars[0] == EOF);
+            return (context.top().Peek(0) == EOF);
 
         case parseTree::Token_t::OPEN_CURLY:
-            return (context.top().nextChars[0] == '{');
+            return (context.top().Peek(0) == '{');
 
         case parseTree::Token_t::CLOSE_CURLY:
-            return (context.top().nextChars[0] == '}');
+            return (context.top().Peek(0) == '}');
 
         case parseTree::Token_t::OPEN_PARENTHESIS:
-            return (context.top().nextChars[0] == '(');
+            return (context.top().Peek(0) == '(');
 
         case parseTree::Token_t::CLOSE_PARENTHESIS:
-            return (context.top().nextChars[0] == ')');
+            return (context.top().Peek(0) == ')');
 
         case parseTree::Token_t::COLON:
-            return (context.top().nextChars[0] == ':');
+            return (context.top().Peek(0) == ':');
 
         case parseTree::Token_t::EQUALS:
-            return (context.top().nextChars[0] == '=');
+            return (context.top().Peek(0) == '=');
 
         case parseTree::Token_t::DOT:
-            return (context.top().nextChars[0] == '.');
+            return (context.top().Peek(0) == '.');
 
         case parseTree::Token_t::STAR:
-            return (context.top().nextChars[0] == '*');
+            return (context.top().Peek(0) == '*');
 
         case parseTree::Token_t::ARROW:
-            return ((context.top().nextChars[0] == '-') && (context.top().nextChars[1] == '>'));
+            return ((context.top().Peek(0) == '-') && (context.top().Peek(1) == '>'));
 
         case parseTree::Token_t::WHITESPACE:
-            return IsWhitespace(context.top().nextChars[0]);
+            return IsWhitespace(context.top().Peek(0));
 
         case parseTree::Token_t::COMMENT:
-            if (context.top().nextChars[0] == '/')
+            if (context.top().Peek(0) == '/')
             {
-                int secondChar = context.top().nextChars[1];
+                int secondChar = context.top().Peek(1);
                 return ((secondChar == '/') || (secondChar == '*'));
             }
             else
@@ -245,11 +336,11 @@ bool Lexer_t::IsMatch
         case parseTree::Token_t::FILE_PERMISSIONS:
         case parseTree::Token_t::SERVER_IPC_OPTION:
         case parseTree::Token_t::CLIENT_IPC_OPTION:
-            return (context.top().nextChars[0] == '[');
+            return (context.top().Peek(0) == '[');
 
         case parseTree::Token_t::ARG:
             // Can be anything in a FILE_PATH, plus the equals sign (=).
-            if (context.top().nextChars[0] == '=')
+            if (context.top().Peek(0) == '=')
             {
                 return true;
             }
@@ -258,22 +349,22 @@ bool Lexer_t::IsMatch
         case parseTree::Token_t::FILE_PATH:
             // Can be anything in a FILE_NAME, plus the forward slash (/).
             // If it starts with a slash, it could be a comment or a file path.
-            if (context.top().nextChars[0] == '/')
+            if (context.top().Peek(0) == '/')
             {
                 // If it's not a comment, then it's a file path.
-                int secondChar = context.top().nextChars[1];
+                int secondChar = context.top().Peek(1);
                 return ((secondChar != '/') && (secondChar != '*'));
             }
             // *** FALL THROUGH ***
 
         case parseTree::Token_t::FILE_NAME:
-            return (   IsFileNameChar(context.top().nextChars[0])
-                       || (context.top().nextChars[0] == '\'')   // Could be in single-quotes.
-                       || (context.top().nextChars[0] == '"') ); // Could be in quotes.
+            return (   IsFileNameChar(context.top().Peek(0))
+                       || (context.top().Peek(0) == '\'')   // Could be in single-quotes.
+                       || (context.top().Peek(0) == '"') ); // Could be in quotes.
 
         case parseTree::Token_t::IPC_AGENT:
             // Can start with the same characters as a NAME or GROUP_NAME, plus '<'.
-            if (context.top().nextChars[0] == '<')
+            if (context.top().Peek(0) == '<')
             {
                 return true;
             }
@@ -282,17 +373,17 @@ bool Lexer_t::IsMatch
         case parseTree::Token_t::NAME:
         case parseTree::Token_t::GROUP_NAME:
         case parseTree::Token_t::DOTTED_NAME:
-            return (   islower(context.top().nextChars[0])
-                       || isupper(context.top().nextChars[0])
-                       || (context.top().nextChars[0] == '_') );
+            return (   islower(context.top().Peek(0))
+                       || isupper(context.top().Peek(0))
+                       || (context.top().Peek(0) == '_') );
 
         case parseTree::Token_t::INTEGER:
-            return (isdigit(context.top().nextChars[0]));
+            return (isdigit(context.top().Peek(0)));
 
         case parseTree::Token_t::SIGNED_INTEGER:
-            return (   (context.top().nextChars[0] == '+')
-                       || (context.top().nextChars[0] == '-')
-                       || isdigit(context.top().nextChars[0]));
+            return (   (context.top().Peek(0) == '+')
+                       || (context.top().Peek(0) == '-')
+                       || isdigit(context.top().Peek(0)));
 
         case parseTree::Token_t::BOOLEAN:
             return IsMatchBoolean();
@@ -304,10 +395,10 @@ bool Lexer_t::IsMatch
             throw mk::Exception_t(LE_I18N("Internal error: STRING lookahead not implemented."));
 
         case parseTree::Token_t::MD5_HASH:
-            return isxdigit(context.top().nextChars[0]);
+            return isxdigit(context.top().Peek(0));
 
         case parseTree::Token_t::DIRECTIVE:
-            return context.top().nextChars[0] == '#';
+            return context.top().Peek(0) == '#';
     }
 
     throw mk::Exception_t(LE_I18N("Internal error: IsMatch(): Invalid token type requested."));
@@ -336,18 +427,25 @@ void Lexer_t::SkipToNextDirective
                                                                context.top().filePtr,
                                                                context.top().line,
                                                                context.top().column);
+    size_t startPos = context.top().pos;
 
     while (true)
     {
-        switch (context.top().nextChars[0])
+        switch (context.top().Peek(0))
         {
             case '#':
                 // Found a directive
+                CopyText(phonyTokenPtr, startPos);
+                return;
+
+            case EOF:
+                // Let the caller report the missing directive.
+                CopyText(phonyTokenPtr, startPos);
                 return;
 
             case '/':
             {
-                int secondChar = context.top().nextChars[1];
+                int secondChar = context.top().Peek(1);
                 if (secondChar == '/' ||
                     secondChar == '*')
                 {
@@ -357,7 +455,7 @@ void Lexer_t::SkipToNextDirective
                 }
                 else
                 {
-                    AdvanceOneCharacter(phonyTokenPtr);
+                    AdvanceOneCharacter();
                 }
 
                 break;
@@ -367,11 +465,11 @@ void Lexer_t::SkipToNextDirective
             case '\'':
                 // Found a quoted string.  Pull the whole thing as it may contain embedded
                 // directives that should be ignored.
-                PullQuoted(phonyTokenPtr, context.top().nextChars[0]);
+                PullQuoted(phonyTokenPtr, context.top().Peek(0));
                 break;
 
             default:
-                AdvanceOneCharacter(phonyTokenPtr);
+                AdvanceOneCharacter();
                 break;
         }
     }
@@ -390,16 +488,17 @@ parseTree::Token_t* Lexer_t::PullRaw
 {
     parseTree::Token_t* tokenPtr = new parseTree::Token_t(type, context.top().filePtr,
                                                           context.top().line, context.top().column);
+    size_t startPos = context.top().pos;
 
     switch (type)
     {
         case parseTree::Token_t::END_OF_FILE:
 
-            if (context.top().nextChars[0] != EOF)
+            if (context.top().Peek(0) != EOF)
             {
                 ThrowException(
                     mk::format(LE_I18N("Expected end-of-file, but found '%c'."),
-                               (char)context.top().nextChars[0])
+                               (char)context.top().Peek(0))
                 );
             }
             break;
@@ -545,6 +644,8 @@ parseTree::Token_t* Lexer_t::PullRaw
             break;
     }
 
+    CopyText(tokenPtr, startPos);
+
     return tokenPtr;
 }
 
@@ -697,10 +798,8 @@ void Lexer_t::ResetTo(parseTree::Token_t* resetTokenPtr)
                                                   "across file boundary"));
         }
 
-        // Re-add the text to the buffer
-        context.top().nextChars.insert(context.top().nextChars.begin(),
-                                       lastTokenPtr->text.begin(),
-                                       lastTokenPtr->text.end());
+        // Move back over the text, which is exactly what was consumed from the file.
+        context.top().pos -= lastTokenPtr->text.size();
 
         // Reset column & line numbers
         context.top().line = lastTokenPtr->line;
@@ -1190,21 +1289,10 @@ bool Lexer_t::IsMatchBoolean
 )
 //--------------------------------------------------------------------------------------------------
 {
-    static const char true_string[] = "true",
-        false_string[] = "false",
-        on_string[] = "on",
-        off_string[] = "off";
-
-    // Need at most 5 characters (for false)
-    context.top().Buffer(5);
-    return std::equal(true_string, true_string + sizeof(true_string) - 1,
-                      context.top().nextChars.begin()) ||
-        std::equal(false_string, false_string + sizeof(false_string) - 1,
-                   context.top().nextChars.begin()) ||
-        std::equal(on_string, on_string + sizeof(on_string) - 1,
-                   context.top().nextChars.begin()) ||
-        std::equal(off_string, off_string + sizeof(off_string) - 1,
-                   context.top().nextChars.begin());
+    return (   context.top().IsNext("true")
+            || context.top().IsNext("false")
+            || context.top().IsNext("on")
+            || context.top().IsNext("off") );
 }
 
 
@@ -1226,13 +1314,13 @@ void Lexer_t::PullConstString
 
     while (*charPtr != '\0')
     {
-        if (context.top().nextChars[0] != *charPtr)
+        if (context.top().Peek(0) != *charPtr)
         {
             UnexpectedChar(mk::format(LE_I18N("Unexpected character %%s. Expected '%s'"),
                                       tokenString));
         }
 
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
         charPtr++;
     }
 }
@@ -1253,9 +1341,9 @@ void Lexer_t::PullWhitespace
     size_t start_line = context.top().line,
         start_column = context.top().column;
 
-    while (IsWhitespace(context.top().nextChars[0]))
+    while (IsWhitespace(context.top().Peek(0)))
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 
     if ((start_line == context.top().line) &&
@@ -1278,42 +1366,42 @@ void Lexer_t::PullComment
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (context.top().nextChars[0] != '/')
+    if (context.top().Peek(0) != '/')
     {
         ThrowException(LE_I18N("Expected '/' at start of comment."));
     }
 
     // Eat the leading '/'.
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
 
     // Figure out which kind of comment it is.
-    if (context.top().nextChars[0] == '/')
+    if (context.top().Peek(0) == '/')
     {
         // C++ style comment, terminated by either new-line or end-of-file.
-        AdvanceOneCharacter(tokenPtr);
-        while ((context.top().nextChars[0] != '\n') && (context.top().nextChars[0] != EOF))
+        AdvanceOneCharacter();
+        while ((context.top().Peek(0) != '\n') && (context.top().Peek(0) != EOF))
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
     }
-    else if (context.top().nextChars[0] == '*')
+    else if (context.top().Peek(0) == '*')
     {
         // C style comment, terminated by "*/" digraph.
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
         for (;;)
         {
-            if (context.top().nextChars[0] == '*')
+            if (context.top().Peek(0) == '*')
             {
-                AdvanceOneCharacter(tokenPtr);
+                AdvanceOneCharacter();
 
-                if (context.top().nextChars[0] == '/')
+                if (context.top().Peek(0) == '/')
                 {
-                    AdvanceOneCharacter(tokenPtr);
+                    AdvanceOneCharacter();
 
                     break;
                 }
             }
-            else if (context.top().nextChars[0] == EOF)
+            else if (context.top().Peek(0) == EOF)
             {
                 ThrowException(
                     mk::format(LE_I18N("Unexpected end-of-file before end of comment.\n"
@@ -1322,7 +1410,7 @@ void Lexer_t::PullComment
             }
             else
             {
-                AdvanceOneCharacter(tokenPtr);
+                AdvanceOneCharacter();
             }
         }
     }
@@ -1344,19 +1432,19 @@ void Lexer_t::PullInteger
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (!isdigit(context.top().nextChars[0]))
+    if (!isdigit(context.top().Peek(0)))
     {
         UnexpectedChar(LE_I18N("Unexpected character %s at beginning of integer."));
     }
 
-    while (isdigit(context.top().nextChars[0]))
+    while (isdigit(context.top().Peek(0)))
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 
-    if (context.top().nextChars[0] == 'K')
+    if (context.top().Peek(0) == 'K')
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 }
 
@@ -1372,10 +1460,10 @@ void Lexer_t::PullSignedInteger
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (   (context.top().nextChars[0] == '-')
-           || (context.top().nextChars[0] == '+'))
+    if (   (context.top().Peek(0) == '-')
+           || (context.top().Peek(0) == '+'))
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 
     PullInteger(tokenPtr);
@@ -1393,33 +1481,33 @@ void Lexer_t::PullBoolean
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (context.top().nextChars[0] == 't')
+    if (context.top().Peek(0) == 't')
     {
         PullConstString(tokenPtr, "true");
     }
-    else if (context.top().nextChars[0] == 'f')
+    else if (context.top().Peek(0) == 'f')
     {
         PullConstString(tokenPtr, "false");
     }
-    else if (context.top().nextChars[0] == 'o')
+    else if (context.top().Peek(0) == 'o')
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-        if (context.top().nextChars[0] == 'n')
+        if (context.top().Peek(0) == 'n')
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
-        else if (context.top().nextChars[0] == 'f')
+        else if (context.top().Peek(0) == 'f')
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
 
-            if (context.top().nextChars[0] != 'f')
+            if (context.top().Peek(0) != 'f')
             {
                 ThrowException(LE_I18N("Unexpected boolean value.  Only 'true', 'false', "
                                        "'on', or 'off' allowed."));
             }
 
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
     }
     else
@@ -1441,48 +1529,48 @@ void Lexer_t::PullFloat
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (   (isdigit(context.top().nextChars[0]) == false)
-           && (context.top().nextChars[0] != '+')
-           && (context.top().nextChars[0] != '-'))
+    if (   (isdigit(context.top().Peek(0)) == false)
+           && (context.top().Peek(0) != '+')
+           && (context.top().Peek(0) != '-'))
     {
         UnexpectedChar(LE_I18N("Unexpected character %s at beginning of floating point value."));
     }
 
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
 
-    while (isdigit(context.top().nextChars[0]))
+    while (isdigit(context.top().Peek(0)))
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 
-    if (context.top().nextChars[0] == '.')
+    if (context.top().Peek(0) == '.')
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-        while (isdigit(context.top().nextChars[0]))
+        while (isdigit(context.top().Peek(0)))
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
     }
 
-    if (   (context.top().nextChars[0] == 'e')
-           || (context.top().nextChars[0] == 'E'))
+    if (   (context.top().Peek(0) == 'e')
+           || (context.top().Peek(0) == 'E'))
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-        if (   (isdigit(context.top().nextChars[0]) == false)
-               && (context.top().nextChars[0] != '+')
-               && (context.top().nextChars[0] != '-'))
+        if (   (isdigit(context.top().Peek(0)) == false)
+               && (context.top().Peek(0) != '+')
+               && (context.top().Peek(0) != '-'))
         {
             UnexpectedChar(LE_I18N("Unexpected character %s in exponent part of"
                                    " floating point value."));
         }
 
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-        while (isdigit(context.top().nextChars[0]))
+        while (isdigit(context.top().Peek(0)))
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
     }
 }
@@ -1499,10 +1587,10 @@ void Lexer_t::PullString
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (   (context.top().nextChars[0] == '"')
-           || (context.top().nextChars[0] == '\''))
+    if (   (context.top().Peek(0) == '"')
+           || (context.top().Peek(0) == '\''))
     {
-        PullQuoted(tokenPtr, context.top().nextChars[0]);
+        PullQuoted(tokenPtr, context.top().Peek(0));
     }
     else
     {
@@ -1522,16 +1610,16 @@ void Lexer_t::PullFilePermissions
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (context.top().nextChars[0] != '[')
+    if (context.top().Peek(0) != '[')
     {
         ThrowException(LE_I18N("Expected '[' at start of file permissions."));
     }
 
     // Eat the leading '['.
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
 
     // Must be something between the square brackets.
-    if (context.top().nextChars[0] == ']')
+    if (context.top().Peek(0) == ']')
     {
         ThrowException(LE_I18N("Empty file permissions."));
     }
@@ -1540,21 +1628,21 @@ void Lexer_t::PullFilePermissions
     do
     {
         // Check for end-of-file or illegal character in file permissions.
-        if (context.top().nextChars[0] == EOF)
+        if (context.top().Peek(0) == EOF)
         {
             ThrowException(LE_I18N("Unexpected end-of-file before end of file permissions."));
         }
-        else if ((context.top().nextChars[0] != 'r') && (context.top().nextChars[0] != 'w') && (context.top().nextChars[0] != 'x'))
+        else if ((context.top().Peek(0) != 'r') && (context.top().Peek(0) != 'w') && (context.top().Peek(0) != 'x'))
         {
             UnexpectedChar(LE_I18N("Unexpected character %s inside file permissions."));
         }
 
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-    } while (context.top().nextChars[0] != ']');
+    } while (context.top().Peek(0) != ']');
 
     // Eat the trailing ']'.
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
 }
 
 
@@ -1618,16 +1706,18 @@ void Lexer_t::PullIpcOption
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (context.top().nextChars[0] != '[')
+    size_t startPos = context.top().pos;
+
+    if (context.top().Peek(0) != '[')
     {
         ThrowException(LE_I18N("Expected '[' at start of IPC option."));
     }
 
     // Eat the leading '['.
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
 
     // Must be something between the square brackets.
-    if (context.top().nextChars[0] == ']')
+    if (context.top().Peek(0) == ']')
     {
         ThrowException(LE_I18N("Empty IPC option."));
     }
@@ -1636,21 +1726,24 @@ void Lexer_t::PullIpcOption
     do
     {
         // Check for end-of-file or illegal character in option.
-        if (context.top().nextChars[0] == EOF)
+        if (context.top().Peek(0) == EOF)
         {
             ThrowException(LE_I18N("Unexpected end-of-file before end of IPC option."));
         }
-        else if ((context.top().nextChars[0] != '-') && !islower(context.top().nextChars[0]))
+        else if ((context.top().Peek(0) != '-') && !islower(context.top().Peek(0)))
         {
             UnexpectedChar(LE_I18N("Unexpected character %s inside option."));
         }
 
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-    } while (context.top().nextChars[0] != ']');
+    } while (context.top().Peek(0) != ']');
 
     // Eat the trailing ']'.
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
+
+    // The caller checks the option before the token is complete, so it needs the text now.
+    CopyText(tokenPtr, startPos);
 }
 
 
@@ -1667,11 +1760,11 @@ void Lexer_t::PullArg
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (context.top().nextChars[0] == '"')
+    if (context.top().Peek(0) == '"')
     {
         PullQuoted(tokenPtr, '"');
     }
-    else if (context.top().nextChars[0] == '\'')
+    else if (context.top().Peek(0) == '\'')
     {
         PullQuoted(tokenPtr, '\'');
     }
@@ -1680,25 +1773,25 @@ void Lexer_t::PullArg
         size_t start_line = context.top().line;
         size_t start_column = context.top().column;
 
-        while (IsArgChar(context.top().nextChars[0]))
+        while (IsArgChar(context.top().Peek(0)))
         {
-            if (context.top().nextChars[0] == '$')
+            if (context.top().Peek(0) == '$')
             {
                 PullEnvVar(tokenPtr);
             }
             else
             {
-                if (context.top().nextChars[0] == '/')
+                if (context.top().Peek(0) == '/')
                 {
                     // Check for comment start.
-                    int secondChar = context.top().nextChars[1];
+                    int secondChar = context.top().Peek(1);
                     if ((secondChar == '/') || (secondChar == '*'))
                     {
                         break;
                     }
                 }
 
-                AdvanceOneCharacter(tokenPtr);
+                AdvanceOneCharacter();
             }
         }
 
@@ -1707,11 +1800,11 @@ void Lexer_t::PullArg
         if ((start_line == context.top().line) &&
             (start_column == context.top().column))
         {
-            if (isprint(context.top().nextChars[0]))
+            if (isprint(context.top().Peek(0)))
             {
                 ThrowException(
                     mk::format(LE_I18N("Invalid character '%c' in argument."),
-                               (char)context.top().nextChars[0])
+                               (char)context.top().Peek(0))
                 );
             }
             else
@@ -1736,11 +1829,11 @@ void Lexer_t::PullFilePath
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (context.top().nextChars[0] == '"')
+    if (context.top().Peek(0) == '"')
     {
         PullQuoted(tokenPtr, '"');
     }
-    else if (context.top().nextChars[0] == '\'')
+    else if (context.top().Peek(0) == '\'')
     {
         PullQuoted(tokenPtr, '\'');
     }
@@ -1749,25 +1842,25 @@ void Lexer_t::PullFilePath
         size_t start_line = context.top().line,
             start_column = context.top().column;
 
-        while (IsFilePathChar(context.top().nextChars[0]))
+        while (IsFilePathChar(context.top().Peek(0)))
         {
-            if (context.top().nextChars[0] == '$')
+            if (context.top().Peek(0) == '$')
             {
                 PullEnvVar(tokenPtr);
             }
             else
             {
-                if (context.top().nextChars[0] == '/')
+                if (context.top().Peek(0) == '/')
                 {
                     // Check for comment start.
-                    int secondChar = context.top().nextChars[1];
+                    int secondChar = context.top().Peek(1);
                     if ((secondChar == '/') || (secondChar == '*'))
                     {
                         break;
                     }
                 }
 
-                AdvanceOneCharacter(tokenPtr);
+                AdvanceOneCharacter();
             }
         }
 
@@ -1776,11 +1869,11 @@ void Lexer_t::PullFilePath
         if (start_line == context.top().line &&
             start_column == context.top().column)
         {
-            if (isprint(context.top().nextChars[0]))
+            if (isprint(context.top().Peek(0)))
             {
                 ThrowException(
                     mk::format(LE_I18N("Invalid character '%c' in file path."),
-                               (char)context.top().nextChars[0])
+                               (char)context.top().Peek(0))
                 );
             }
             else
@@ -1805,11 +1898,11 @@ void Lexer_t::PullFileName
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (context.top().nextChars[0] == '"')
+    if (context.top().Peek(0) == '"')
     {
         PullQuoted(tokenPtr, '"');
     }
-    else if (context.top().nextChars[0] == '\'')
+    else if (context.top().Peek(0) == '\'')
     {
         PullQuoted(tokenPtr, '\'');
     }
@@ -1818,15 +1911,15 @@ void Lexer_t::PullFileName
         size_t start_line = context.top().line,
             start_column = context.top().column;
 
-        while (IsFileNameChar(context.top().nextChars[0]))
+        while (IsFileNameChar(context.top().Peek(0)))
         {
-            if (context.top().nextChars[0] == '$')
+            if (context.top().Peek(0) == '$')
             {
                 PullEnvVar(tokenPtr);
             }
             else
             {
-                AdvanceOneCharacter(tokenPtr);
+                AdvanceOneCharacter();
             }
         }
 
@@ -1835,11 +1928,11 @@ void Lexer_t::PullFileName
         if ((start_line == context.top().line) &&
             (start_column == context.top().column))
         {
-            if (isprint(context.top().nextChars[0]))
+            if (isprint(context.top().Peek(0)))
             {
                 ThrowException(
                     mk::format(LE_I18N("Invalid character '%c' in name."),
-                               (char)context.top().nextChars[0])
+                               (char)context.top().Peek(0))
                 );
             }
             else
@@ -1862,11 +1955,11 @@ void Lexer_t::PullName
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (   islower(context.top().nextChars[0])
-           || isupper(context.top().nextChars[0])
-           || (context.top().nextChars[0] == '_') )
+    if (   islower(context.top().Peek(0))
+           || isupper(context.top().Peek(0))
+           || (context.top().Peek(0) == '_') )
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
     else
     {
@@ -1875,12 +1968,12 @@ void Lexer_t::PullName
                                " or an underscore ('_')."));
     }
 
-    while (   islower(context.top().nextChars[0])
-              || isupper(context.top().nextChars[0])
-              || isdigit(context.top().nextChars[0])
-              || (context.top().nextChars[0] == '_') )
+    while (   islower(context.top().Peek(0))
+              || isupper(context.top().Peek(0))
+              || isdigit(context.top().Peek(0))
+              || (context.top().Peek(0) == '_') )
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 }
 
@@ -1900,14 +1993,14 @@ void Lexer_t::PullDottedName
     {
         PullName(tokenPtr);
 
-        if (context.top().nextChars[0] == '.')
+        if (context.top().Peek(0) == '.')
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
     }
-    while (   islower(context.top().nextChars[0])
-              || isupper(context.top().nextChars[0])
-              || (context.top().nextChars[0] == '_'));
+    while (   islower(context.top().Peek(0))
+              || isupper(context.top().Peek(0))
+              || (context.top().Peek(0) == '_'));
 }
 
 
@@ -1922,11 +2015,11 @@ void Lexer_t::PullGroupName
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (   islower(context.top().nextChars[0])
-           || isupper(context.top().nextChars[0])
-           || (context.top().nextChars[0] == '_') )
+    if (   islower(context.top().Peek(0))
+           || isupper(context.top().Peek(0))
+           || (context.top().Peek(0) == '_') )
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
     else
     {
@@ -1935,13 +2028,13 @@ void Lexer_t::PullGroupName
                                "('a'-'z' or 'A'-'Z') or an underscore ('_')."));
     }
 
-    while (   islower(context.top().nextChars[0])
-              || isupper(context.top().nextChars[0])
-              || isdigit(context.top().nextChars[0])
-              || (context.top().nextChars[0] == '_')
-              || (context.top().nextChars[0] == '-') )
+    while (   islower(context.top().Peek(0))
+              || isupper(context.top().Peek(0))
+              || isdigit(context.top().Peek(0))
+              || (context.top().Peek(0) == '_')
+              || (context.top().Peek(0) == '-') )
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 }
 
@@ -1957,45 +2050,45 @@ void Lexer_t::PullIpcAgentName
 )
 //--------------------------------------------------------------------------------------------------
 {
-    auto firstChar = context.top().nextChars[0];
+    auto firstChar = context.top().Peek(0);
 
     // User names are enclosed in angle brackets (e.g., "<username>").
     if (firstChar == '<')
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-        while (   islower(context.top().nextChars[0])
-                  || isupper(context.top().nextChars[0])
-                  || isdigit(context.top().nextChars[0])
-                  || (context.top().nextChars[0] == '_')
-                  || (context.top().nextChars[0] == '-') )
+        while (   islower(context.top().Peek(0))
+                  || isupper(context.top().Peek(0))
+                  || isdigit(context.top().Peek(0))
+                  || (context.top().Peek(0) == '_')
+                  || (context.top().Peek(0) == '-') )
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
 
-        if (context.top().nextChars[0] != '>')
+        if (context.top().Peek(0) != '>')
         {
             UnexpectedChar(LE_I18N("Unexpected character %s in user name.  "
                                    "Must be terminated with '>'."));
         }
         else
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
     }
     // App names have the same rules as C programming language identifiers.
-    else if (   islower(context.top().nextChars[0])
-                || isupper(context.top().nextChars[0])
-                || (context.top().nextChars[0] == '_') )
+    else if (   islower(context.top().Peek(0))
+                || isupper(context.top().Peek(0))
+                || (context.top().Peek(0) == '_') )
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
 
-        while (   islower(context.top().nextChars[0])
-                  || isupper(context.top().nextChars[0])
-                  || isdigit(context.top().nextChars[0])
-                  || (context.top().nextChars[0] == '_') )
+        while (   islower(context.top().Peek(0))
+                  || isupper(context.top().Peek(0))
+                  || isdigit(context.top().Peek(0))
+                  || (context.top().Peek(0) == '_') )
         {
-            AdvanceOneCharacter(tokenPtr);
+            AdvanceOneCharacter();
         }
     }
     else
@@ -2023,25 +2116,25 @@ void Lexer_t::PullQuoted
 //--------------------------------------------------------------------------------------------------
 {
     // Eat the leading quote.
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
 
-    while (context.top().nextChars[0] != quoteChar)
+    while (context.top().Peek(0) != quoteChar)
     {
         // Don't allow end of file or end of line characters inside the quoted string.
-        if (context.top().nextChars[0] == EOF)
+        if (context.top().Peek(0) == EOF)
         {
             ThrowException(LE_I18N("Unexpected end-of-file before end of quoted string."));
         }
-        if ((context.top().nextChars[0] == '\n') || (context.top().nextChars[0] == '\r'))
+        if ((context.top().Peek(0) == '\n') || (context.top().Peek(0) == '\r'))
         {
             ThrowException(LE_I18N("Unexpected end-of-line before end of quoted string."));
         }
 
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 
     // Eat the trailing quote.
-    AdvanceOneCharacter(tokenPtr);
+    AdvanceOneCharacter();
 }
 
 
@@ -2060,22 +2153,22 @@ void Lexer_t::PullEnvVar
 //--------------------------------------------------------------------------------------------------
 {
     // Get the '$'.
-    AdvanceOneCharacter(tokenPtr->text);
+    AdvanceOneCharacter();
 
     // If the next character is a curly brace, remember that we need to look for the closing curly.
     bool hasCurlies = false;    // true if ${ENV_VAR} style.  false if $ENV_VAR style.
-    if (context.top().nextChars[0] == '{')
+    if (context.top().Peek(0) == '{')
     {
-        AdvanceOneCharacter(tokenPtr->text);
+        AdvanceOneCharacter();
         hasCurlies = true;
     }
 
     // Pull the first character of the environment variable name.
-    if (   islower(context.top().nextChars[0])
-           || isupper(context.top().nextChars[0])
-           || (context.top().nextChars[0] == '_') )
+    if (   islower(context.top().Peek(0))
+           || isupper(context.top().Peek(0))
+           || (context.top().Peek(0) == '_') )
     {
-        AdvanceOneCharacter(tokenPtr->text);
+        AdvanceOneCharacter();
     }
     else
     {
@@ -2086,29 +2179,29 @@ void Lexer_t::PullEnvVar
     }
 
     // Pull the rest of the environment variable name.
-    while (   islower(context.top().nextChars[0])
-              || isupper(context.top().nextChars[0])
-              || isdigit(context.top().nextChars[0])
-              || (context.top().nextChars[0] == '_') )
+    while (   islower(context.top().Peek(0))
+              || isupper(context.top().Peek(0))
+              || isdigit(context.top().Peek(0))
+              || (context.top().Peek(0) == '_') )
     {
-        AdvanceOneCharacter(tokenPtr->text);
+        AdvanceOneCharacter();
     }
 
     // If there was an opening curly brace, match the closing one now.
     if (hasCurlies)
     {
-        if (context.top().nextChars[0] == '}')
+        if (context.top().Peek(0) == '}')
         {
-            AdvanceOneCharacter(tokenPtr->text);
+            AdvanceOneCharacter();
         }
-        else if (context.top().nextChars[0] == EOF)
+        else if (context.top().Peek(0) == EOF)
         {
             ThrowException(LE_I18N("Unexpected end-of-file inside environment variable name."));
         }
         else
         {
             ThrowException(
-                mk::format(LE_I18N("'}' expected.  '%c' found."), (char)context.top().nextChars[0])
+                mk::format(LE_I18N("'}' expected.  '%c' found."), (char)context.top().Peek(0))
             );
         }
     }
@@ -2129,15 +2222,15 @@ void Lexer_t::PullMd5
     // There are always exactly 32 hexadecimal digits in an md5 sum.
     for (int i = 0; i < 32; i++)
     {
-        if (   (!isdigit(context.top().nextChars[0]))
-               && (context.top().nextChars[0] != 'a')
-               && (context.top().nextChars[0] != 'b')
-               && (context.top().nextChars[0] != 'c')
-               && (context.top().nextChars[0] != 'd')
-               && (context.top().nextChars[0] != 'e')
-               && (context.top().nextChars[0] != 'f')  )
+        if (   (!isdigit(context.top().Peek(0)))
+               && (context.top().Peek(0) != 'a')
+               && (context.top().Peek(0) != 'b')
+               && (context.top().Peek(0) != 'c')
+               && (context.top().Peek(0) != 'd')
+               && (context.top().Peek(0) != 'e')
+               && (context.top().Peek(0) != 'f')  )
         {
-            if (IsWhitespace(context.top().nextChars[0]))
+            if (IsWhitespace(context.top().Peek(0)))
             {
                 ThrowException(LE_I18N("MD5 hash too short."));
             }
@@ -2145,17 +2238,17 @@ void Lexer_t::PullMd5
             UnexpectedChar(LE_I18N("Unexpected character %s in MD5 hash."));
         }
 
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 
     // Make sure it isn't too long.
-    if (   isdigit(context.top().nextChars[0])
-           || (context.top().nextChars[0] == 'a')
-           || (context.top().nextChars[0] == 'b')
-           || (context.top().nextChars[0] == 'c')
-           || (context.top().nextChars[0] == 'd')
-           || (context.top().nextChars[0] == 'e')
-           || (context.top().nextChars[0] == 'f')  )
+    if (   isdigit(context.top().Peek(0))
+           || (context.top().Peek(0) == 'a')
+           || (context.top().Peek(0) == 'b')
+           || (context.top().Peek(0) == 'c')
+           || (context.top().Peek(0) == 'd')
+           || (context.top().Peek(0) == 'e')
+           || (context.top().Peek(0) == 'f')  )
     {
         ThrowException(LE_I18N("MD5 hash too long."));
     }
@@ -2174,9 +2267,9 @@ void Lexer_t::PullDirective
 //--------------------------------------------------------------------------------------------------
 {
     // advance past the '#'
-    if (context.top().nextChars[0] == '#')
+    if (context.top().Peek(0) == '#')
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
     else
     {
@@ -2184,10 +2277,10 @@ void Lexer_t::PullDirective
                                "Must start with '#' character."));
     }
 
-    if (   islower(context.top().nextChars[0])
-           || isupper(context.top().nextChars[0]))
+    if (   islower(context.top().Peek(0))
+           || isupper(context.top().Peek(0)))
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
     else
     {
@@ -2195,29 +2288,27 @@ void Lexer_t::PullDirective
                                "Must start with a letter ('a'-'z' or 'A'-'Z')."));
     }
 
-    while (   islower(context.top().nextChars[0])
-              || isupper(context.top().nextChars[0]))
+    while (   islower(context.top().Peek(0))
+              || isupper(context.top().Peek(0)))
     {
-        AdvanceOneCharacter(tokenPtr);
+        AdvanceOneCharacter();
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Advance the current file position by one character, appending the character into a given token's
- * text value and updating the line and column numbers.
- *
- * @throw mk::Exception_t if this can't be done.
+ * Set the text of a token to the characters consumed from the file since a given position.
  */
 //--------------------------------------------------------------------------------------------------
-void Lexer_t::AdvanceOneCharacter
+void Lexer_t::CopyText
 (
-    parseTree::Token_t* tokenPtr    ///< Token object to add the character to.
+    parseTree::Token_t* tokenPtr,   ///< Token object to set the text of.
+    size_t startPos                 ///< Offset in the file of the first character of the token.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    AdvanceOneCharacter(tokenPtr->text);
+    tokenPtr->text.assign(context.top().dataPtr + startPos, context.top().pos - startPos);
 }
 
 
@@ -2412,37 +2503,37 @@ parseTree::Token_t *Lexer_t::FindVarUse
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Advance the current file position by one character, appending the character into a given string
- * and updating the line and column numbers.
+ * Advance the current file position by one character, updating the line and column numbers.
+ *
+ * The character is not copied anywhere: the text of a token is copied from the file in one go by
+ * CopyText() once all its characters have been consumed.
  *
  * @throw mk::Exception_t if this can't be done.
  */
 //--------------------------------------------------------------------------------------------------
 void Lexer_t::AdvanceOneCharacter
 (
-    std::string& string     ///< String to add the character to.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    string += context.top().nextChars[0];
+    auto& top = context.top();
 
-    if (context.top().nextChars[0] == '\n')
+    if (top.pos >= top.size)
     {
-        context.top().line++;
-        context.top().column = 0;
+        ThrowException(LE_I18N("Unexpected end-of-file."));
     }
-    else
+
+    if (top.dataPtr[top.pos] == '\n')
     {
-        context.top().column++;
+        top.line++;
+        top.column = 0;
     }
-
-    context.top().nextChars.pop_front();
-    context.top().Buffer(2);
-
-    if (context.top().inputStream.bad())
+    else
     {
-        ThrowException(LE_I18N("Failed to fetch next character from file."));
+        top.column++;
     }
+
+    top.pos++;
 }
 
 
@@ -2483,7 +2574,7 @@ void Lexer_t::UnexpectedChar
 )
 //--------------------------------------------------------------------------------------------------
 {
-    throw mk::Exception_t(UnexpectedCharErrorMsg(context.top().nextChars[0],
+    throw mk::Exception_t(UnexpectedCharErrorMsg(context.top().Peek(0),
                                                  context.top().line,
                                                  context.top().column,
                                                  message));
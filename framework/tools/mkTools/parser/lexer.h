@@ -6,6 +6,9 @@
  *
  * As a side-effect, the Lexer_t builds a list of tokens in a given DefFile_t object.
  *
+ * Files are mapped into memory and scanned in place.  A token's text is copied out of the mapping
+ * in one go once the token is complete, and backtracking only moves the scan position back.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 //--------------------------------------------------------------------------------------------------
@@ -58,16 +61,24 @@ class Lexer_t
         {
             parseTree::DefFileFragment_t* filePtr;  ///< Pointer to the File object for the file being parsed.
 
-            std::ifstream inputStream;      ///< File input stream from which tokens will be matched.
-            std::deque<int> nextChars;      ///< File buffer for characters read from the input
-                                            ///< stream but not yet consumed.
+            const char* dataPtr;            ///< Contents of the file, from which tokens will be
+                                            ///< matched (mapped into memory if possible).
+            size_t size;                    ///< Number of bytes in the file.
+            size_t pos;                     ///< Offset of the next character to be consumed.
+            bool isMapped;                  ///< true = dataPtr points to a memory mapping.
+            std::string buffer;             ///< Contents of a file that couldn't be mapped.
             size_t line;                    ///< File line number.
             size_t column;                  ///< Char index on line (treat tab & return same as space).
             size_t ifNestDepth;             ///< Current number of nested #if directives.
 
             LexerContext_t(parseTree::DefFileFragment_t *filePtr);
+            ~LexerContext_t();
+
+            LexerContext_t(const LexerContext_t&) = delete;
+            LexerContext_t& operator=(const LexerContext_t&) = delete;
 
-            void Buffer(size_t n);
+            int Peek(size_t n) const;
+            bool IsNext(const char* string) const;
         };
 
         std::stack<LexerContext_t> context;
@@ -119,8 +130,8 @@ class Lexer_t
         void PullEnvVar(parseTree::Token_t* tokenPtr);
         void PullMd5(parseTree::Token_t* tokenPtr);
         void PullDirective(parseTree::Token_t* tokenPtr);
-        void AdvanceOneCharacter(parseTree::Token_t* tokenPtr);
-        void AdvanceOneCharacter(std::string& string);
+        void CopyText(parseTree::Token_t* tokenPtr, size_t startPos);
+        void AdvanceOneCharacter();
         std::string UnexpectedCharErrorMsg(char unexpectedChar,
                                            size_t lineNum,
                                            size_t columnNum,
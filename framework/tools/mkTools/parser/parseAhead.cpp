@@ -0,0 +1,419 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parseAhead.cpp  Implementation of the parallel parsing of .adef and .cdef files.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "mkTools.h"
+
+
+namespace parser
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The pool in use, if any.
+ */
+//--------------------------------------------------------------------------------------------------
+ParseAhead_t* ParseAhead_t::CurrentPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.  Starts one worker thread per CPU, except the one the modeller runs on.  With a
+ * single CPU, nothing is parsed ahead.
+ */
+//--------------------------------------------------------------------------------------------------
+ParseAhead_t::ParseAhead_t
+(
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+:   componentDirs(buildParams.componentDirs),
+    isStopping(false)
+{
+    if (CurrentPtr != NULL)
+    {
+        throw mk::Exception_t(LE_I18N("Internal error: Parsing ahead more than once at a time."));
+    }
+
+    CurrentPtr = this;
+
+    unsigned int cpuCount = std::thread::hardware_concurrency();
+
+    for (unsigned int i = 1; i < cpuCount; i++)
+    {
+        workers.emplace_back(&ParseAhead_t::RunWorker, this);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor.  Lets the workers finish the files they are parsing, but not start new ones.
+ */
+//--------------------------------------------------------------------------------------------------
+ParseAhead_t::~ParseAhead_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        isStopping = true;
+    }
+
+    changed.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    CurrentPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue an app's .adef file for parsing.  The .cdef files of the components it uses are queued
+ * once it is parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+void ParseAhead_t::AddAdef
+(
+    const std::string& filePath     ///< Path of the .adef file, as given to GetAdef() later.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Add(filePath, true);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the parse tree of a .adef file.
+ *
+ * @return Pointer to a fully populated AdefFile_t object.
+ *
+ * @throw mk::Exception_t if an error is encountered.
+ */
+//--------------------------------------------------------------------------------------------------
+parseTree::AdefFile_t* ParseAhead_t::GetAdef
+(
+    const std::string& filePath,    ///< Path to .adef file to be parsed.
+    bool beVerbose                  ///< true if progress messages should be printed.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CurrentPtr == NULL)
+    {
+        return adef::Parse(filePath, beVerbose);
+    }
+
+    return static_cast<parseTree::AdefFile_t*>(CurrentPtr->Get(filePath, true, beVerbose));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the parse tree of a .cdef file.
+ *
+ * @return Pointer to a fully populated CdefFile_t object.
+ *
+ * @throw mk::Exception_t if an error is encountered.
+ */
+//--------------------------------------------------------------------------------------------------
+parseTree::CdefFile_t* ParseAhead_t::GetCdef
+(
+    const std::string& filePath,    ///< Path to .cdef file to be parsed.
+    bool beVerbose                  ///< true if progress messages should be printed.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CurrentPtr == NULL)
+    {
+        return cdef::Parse(filePath, beVerbose);
+    }
+
+    return static_cast<parseTree::CdefFile_t*>(CurrentPtr->Get(filePath, false, beVerbose));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a file for parsing, unless it has been seen already.  The mutex must be locked.
+ */
+//--------------------------------------------------------------------------------------------------
+void ParseAhead_t::Add
+(
+    const std::string& filePath,
+    bool isAdef
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (workers.empty() || (jobs.find(filePath) != jobs.end()))
+    {
+        return;
+    }
+
+    Job_t& job = jobs[filePath];
+
+    job.state = Job_t::QUEUED;
+    job.isAdef = isAdef;
+    job.filePtr = NULL;
+
+    queue.push_back(filePath);
+
+    changed.notify_all();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the parse tree of a file.  If the file is still queued, it is parsed by the calling thread
+ * rather than waiting for a worker.
+ *
+ * @throw mk::Exception_t if an error is encountered.
+ */
+//--------------------------------------------------------------------------------------------------
+parseTree::DefFile_t* ParseAhead_t::Get
+(
+    const std::string& filePath,
+    bool isAdef,
+    bool beVerbose
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    auto jobIter = jobs.find(filePath);
+
+    if ((jobIter == jobs.end()) || (jobIter->second.isAdef != isAdef))
+    {
+        lock.unlock();
+
+        if (isAdef)
+        {
+            return adef::Parse(filePath, beVerbose);
+        }
+        return cdef::Parse(filePath, beVerbose);
+    }
+
+    Job_t& job = jobIter->second;
+
+    if (job.state == Job_t::QUEUED)
+    {
+        queue.remove(filePath);
+        Parse(filePath, job, lock);
+    }
+
+    while (job.state != Job_t::DONE)
+    {
+        changed.wait(lock);
+    }
+
+    // Workers parse quietly, so report the file the way the parser would have.
+    if (beVerbose)
+    {
+        std::cout << mk::format(LE_I18N("Parsing file: '%s'."), path::MakeAbsolute(filePath))
+                  << std::endl;
+    }
+
+    if (job.exceptionPtr)
+    {
+        std::rethrow_exception(job.exceptionPtr);
+    }
+
+    return job.filePtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a queued file and queue the .cdef files of the components it uses.  The mutex must be
+ * locked; it is released while parsing.
+ */
+//--------------------------------------------------------------------------------------------------
+void ParseAhead_t::Parse
+(
+    const std::string& filePath,
+    Job_t& job,
+    std::unique_lock<std::mutex>& lock
+)
+//--------------------------------------------------------------------------------------------------
+{
+    parseTree::DefFile_t* filePtr = NULL;
+    std::exception_ptr exceptionPtr;
+
+    job.state = Job_t::PARSING;
+    lock.unlock();
+
+    try
+    {
+        if (job.isAdef)
+        {
+            filePtr = adef::Parse(filePath, false);
+        }
+        else
+        {
+            filePtr = cdef::Parse(filePath, false);
+        }
+
+        AddComponents(filePtr);
+    }
+    catch (...)
+    {
+        exceptionPtr = std::current_exception();
+    }
+
+    lock.lock();
+
+    job.filePtr = filePtr;
+    job.exceptionPtr = exceptionPtr;
+    job.state = Job_t::DONE;
+
+    changed.notify_all();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue the .cdef file of a component, found the way the modeller finds it.  Components that
+ * can't be found are skipped: the modeller reports them.
+ */
+//--------------------------------------------------------------------------------------------------
+void ParseAhead_t::AddComponent
+(
+    const parseTree::Token_t* tokenPtr,     ///< Component path token.
+    const std::string& dir                  ///< Dir to search before the component search path.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string resolvedPath;
+
+    try
+    {
+        auto componentPath = path::Unquote(parseTree::DoSubstitution(tokenPtr));
+
+        if (componentPath.empty())
+        {
+            return;
+        }
+
+        resolvedPath = file::FindComponent(componentPath, { dir });
+        if (resolvedPath.empty())
+        {
+            resolvedPath = file::FindComponent(componentPath, componentDirs);
+        }
+    }
+    catch (...)
+    {
+        return;
+    }
+
+    if (!resolvedPath.empty())
+    {
+        auto cdefPath = path::Combine(path::MakeAbsolute(resolvedPath), "Component.cdef");
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Add(cdefPath, false);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue the .cdef files of the components used by an app or by a component.
+ */
+//--------------------------------------------------------------------------------------------------
+void ParseAhead_t::AddComponents
+(
+    const parseTree::DefFile_t* filePtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto dir = path::GetContainingDir(filePtr->path);
+
+    for (auto sectionPtr : filePtr->sections)
+    {
+        auto& sectionName = sectionPtr->firstTokenPtr->text;
+
+        if (filePtr->type == parseTree::DefFile_t::ADEF)
+        {
+            if (sectionName == "components")
+            {
+                for (auto tokenPtr : parseTree::ToTokenListSectionPtr(sectionPtr)->Contents())
+                {
+                    AddComponent(tokenPtr, dir);
+                }
+            }
+            else if (sectionName == "executables")
+            {
+                for (auto itemPtr : parseTree::ToCompoundItemListPtr(sectionPtr)->Contents())
+                {
+                    for (auto tokenPtr : parseTree::ToTokenListPtr(itemPtr)->Contents())
+                    {
+                        AddComponent(tokenPtr, dir);
+                    }
+                }
+            }
+        }
+        else if (sectionName == "requires")
+        {
+            for (auto memberPtr : parseTree::ToCompoundItemListPtr(sectionPtr)->Contents())
+            {
+                if (memberPtr->firstTokenPtr->text == "component")
+                {
+                    for (auto tokenPtr : parseTree::ToTokenListPtr(memberPtr)->Contents())
+                    {
+                        AddComponent(tokenPtr, dir);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Worker thread: parse queued files, in order, until stopped.
+ */
+//--------------------------------------------------------------------------------------------------
+void ParseAhead_t::RunWorker
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        while (!isStopping && queue.empty())
+        {
+            changed.wait(lock);
+        }
+
+        if (isStopping)
+        {
+            return;
+        }
+
+        std::string filePath = queue.front();
+        queue.pop_front();
+
+        Parse(filePath, jobs[filePath], lock);
+    }
+}
+
+
+
+} // namespace parser
@@ -0,0 +1,83 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parseAhead.h  Parallel parsing of the .adef and .cdef files of a system.
+ *
+ * While the modeller works through the apps of a system one at a time, a pool of worker threads
+ * parses the .adef files of the apps that come next and the .cdef files of the components they
+ * use (found the same way the modeller finds them), so that the modeller finds most parse trees
+ * ready when it needs them.
+ *
+ * Parsing ahead never changes the outcome of a build: a file that wasn't parsed ahead (or whose
+ * components couldn't be found by the workers) is simply parsed when the modeller asks for it, and
+ * a parse error is only reported when the modeller asks for the file that has it.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_MKTOOLS_PARSE_AHEAD_H_INCLUDE_GUARD
+#define LEGATO_MKTOOLS_PARSE_AHEAD_H_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of threads parsing definition files ahead of the modeller.  Only one can exist at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+class ParseAhead_t
+{
+    public:
+
+        // Constructor.  Starts the worker threads, if there's more than one CPU to run them.
+        ParseAhead_t(const mk::BuildParams_t& buildParams);
+
+        // Destructor.  Stops the worker threads.  Parse trees already handed out remain valid.
+        ~ParseAhead_t();
+
+        // Queue an app's .adef file, and so the .cdef files of its components, for parsing.
+        void AddAdef(const std::string& filePath);
+
+        // Get the parse tree of a .adef or .cdef file, waiting for it if it is being parsed ahead,
+        // or parsing it now if it wasn't queued.
+        static parseTree::AdefFile_t* GetAdef(const std::string& filePath, bool beVerbose);
+        static parseTree::CdefFile_t* GetCdef(const std::string& filePath, bool beVerbose);
+
+    private:
+
+        // A file to parse.
+        struct Job_t
+        {
+            enum State_t
+            {
+                QUEUED,         ///< Waiting for a thread.
+                PARSING,        ///< Being parsed.
+                DONE            ///< Parsed, or failed to parse.
+            };
+
+            State_t state;
+            bool isAdef;                            ///< true = .adef, false = .cdef.
+            parseTree::DefFile_t* filePtr;          ///< Parse tree, once DONE.
+            std::exception_ptr exceptionPtr;        ///< Parse error, once DONE.
+        };
+
+        void Add(const std::string& filePath, bool isAdef);
+        parseTree::DefFile_t* Get(const std::string& filePath, bool isAdef, bool beVerbose);
+        void Parse(const std::string& filePath, Job_t& job, std::unique_lock<std::mutex>& lock);
+        void AddComponent(const parseTree::Token_t* tokenPtr, const std::string& dir);
+        void AddComponents(const parseTree::DefFile_t* filePtr);
+        void RunWorker();
+
+        const std::list<std::string> componentDirs;     ///< Component search path.
+
+        std::mutex mutex;                               ///< Protects everything below.
+        std::condition_variable changed;                ///< Signalled when a job is queued or done.
+        std::map<std::string, Job_t> jobs;              ///< All the files seen, by path.
+        std::list<std::string> queue;                   ///< Paths of the QUEUED jobs, in order.
+        bool isStopping;                                ///< true = workers must exit.
+        std::vector<std::thread> workers;
+
+        static ParseAhead_t* CurrentPtr;                ///< The pool in use (NULL if none).
+};
+
+
+#endif // LEGATO_MKTOOLS_PARSE_AHEAD_H_INCLUDE_GUARD
@@ -14,6 +14,7 @@
  * - @ref mdefParser.h
  * - @ref sdefParser.h
  * - @ref apiParser.h
+ * - @ref parseAhead.h
  *
  * Also, there's a set of parsing functions declared in @ref parser.h that are shared by multiple
  * parsers.
@@ -50,6 +51,7 @@ namespace parser
 #include "mdefParser.h"
 #include "sdefParser.h"
 #include "apiParser.h"
+#include "parseAhead.h"
 
 
 //--------------------------------------------------------------------------------------------------
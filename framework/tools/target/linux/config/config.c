@@ -39,8 +39,6 @@
 /// Json field names.
 #define JSON_FIELD_TYPE "type"
 #define JSON_FIELD_NAME "name"
-#define JSON_FIELD_CHILDREN "children"
-#define JSON_FIELD_VALUE "value"
 
 
 
@@ -243,136 +241,6 @@ static json_t* CreateJsonNode
 
 
 
-// -------------------------------------------------------------------------------------------------
-/**
- *  Read the iterator's current node and create a new JSON object from that info.
- */
-// -------------------------------------------------------------------------------------------------
-static json_t* CreateJsonNodeFromIterator
-(
-    le_cfg_IteratorRef_t iterRef  ///< The iterator to read from.
-)
-// -------------------------------------------------------------------------------------------------
-{
-    char nodeName[LE_CFG_NAME_LEN_BYTES] = "";
-
-    le_cfg_nodeType_t type = le_cfg_GetNodeType(iterRef, "");
-    le_cfg_GetNodeName(iterRef, "", nodeName, sizeof(nodeName));
-
-    json_t* nodePtr = CreateJsonNode(nodeName, NodeTypeStr(type));
-
-    switch (type)
-    {
-        case LE_CFG_TYPE_EMPTY:
-            json_object_set_new(nodePtr,
-                                JSON_FIELD_TYPE,
-                                json_string(NodeTypeStr(LE_CFG_TYPE_STEM)));
-            json_object_set_new(nodePtr, JSON_FIELD_CHILDREN, json_array());
-            break;
-
-        case LE_CFG_TYPE_BOOL:
-            json_object_set_new(nodePtr,
-                                JSON_FIELD_VALUE,
-                                json_boolean(le_cfg_GetBool(iterRef, "", false)));
-            break;
-
-        case LE_CFG_TYPE_STRING:
-            {
-                char strBuffer[LE_CFG_STR_LEN_BYTES] = "";
-                le_cfg_GetString(iterRef, "", strBuffer, LE_CFG_STR_LEN_BYTES, "");
-                json_object_set_new(nodePtr, JSON_FIELD_VALUE, json_string(strBuffer));
-            }
-            break;
-
-        case LE_CFG_TYPE_INT:
-            json_object_set_new(nodePtr,
-                                JSON_FIELD_VALUE,
-                                json_integer(le_cfg_GetInt(iterRef, "", false)));
-            break;
-
-        case LE_CFG_TYPE_FLOAT:
-            json_object_set_new(nodePtr,
-                                JSON_FIELD_VALUE,
-                                json_real(le_cfg_GetFloat(iterRef, "", false)));
-            break;
-
-        case LE_CFG_TYPE_STEM:
-        default:
-            // Unknown type, nothing to do
-            json_decref(nodePtr);
-            nodePtr = NULL;
-            break;
-    }
-
-    return nodePtr;
-}
-
-
-
-
-// -------------------------------------------------------------------------------------------------
-/**
- *  Dump tree data to a JSON object.  This function will start at the iterator's current location
- *  extract all tree data from there and insert it into the given JSON object.
- */
-// -------------------------------------------------------------------------------------------------
-static void DumpTreeJSON
-(
-    le_cfg_IteratorRef_t iterRef,  ///< Read the tree data from this iterator.
-    json_t* jsonObject             ///< JSON object to hold the tree data.
-)
-// -------------------------------------------------------------------------------------------------
-{
-    // Note that because this is a recursive function, the buffer here is static in order to save on
-    // stack space.  The implication here is that we then have to be careful how it is later
-    // accessed.  Also, this makes the function not thread safe.  But this trade off was made as
-    // this was not intended to be a multi-threaded program.
-    static char strBuffer[LE_CFG_STR_LEN_BYTES] = "";
-
-    // Build up the child array.
-    json_t* childArrayPtr = json_array();
-
-    do
-    {
-        // Simply grab the name and the type of the current node.
-        le_cfg_GetNodeName(iterRef, "", strBuffer, sizeof(strBuffer));
-        le_cfg_nodeType_t type = le_cfg_GetNodeType(iterRef, "");
-
-        switch (type)
-        {
-            // It's a stem object, so mark this item as being a stem and recurse into the stem's
-            // sub-items.
-            case LE_CFG_TYPE_STEM:
-                {
-                    json_t* nodePtr = CreateJsonNode(strBuffer, NodeTypeStr(type));
-
-                    le_cfg_GoToFirstChild(iterRef);
-                    DumpTreeJSON(iterRef, nodePtr);
-                    le_cfg_GoToParent(iterRef);
-                    json_array_append(childArrayPtr, nodePtr);
-                }
-                break;
-
-            default:
-                {
-                    json_t* nodePtr = CreateJsonNodeFromIterator(iterRef);
-                    if (nodePtr != NULL)
-                    {
-                        json_array_append(childArrayPtr, nodePtr);
-                    }
-                }
-                break;
-        }
-    }
-    while (le_cfg_GoToNextSibling(iterRef) == LE_OK);
-
-    // Set children into the JSON document.
-    json_object_set_new(jsonObject, JSON_FIELD_CHILDREN, childArrayPtr);
-}
-
-
-
-
 // -------------------------------------------------------------------------------------------------
 /**
  *  Given an iterator object, walk the tree from that location and write out the tree structure to
@@ -590,139 +458,203 @@ static int HandleGetUserFriendly
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  This function will attempt read a value from the tree, and write it to standard out, or to a
- *  file.  The tree data will be written in JSON format.
+ *  Open a file to import tree data from, or to export it to.
  *
- *  If the specified node is a stem, then the tree structure will be dumped, starting at the
- *  specified node.  If a '*' is given for a node path then all trees in the system will be dumped
- *  into a JSON document.
- *
- *  @return EXIT_SUCCESS if the command completes properly.  EXIT_FAILURE otherwise.
+ *  @return The file descriptor, or -1 if the file could not be opened.
  */
 // -------------------------------------------------------------------------------------------------
-static int HandleGetJSON
+static int OpenDataFile
 (
-    const char* nodePathPtr,  ///< Path to the node in the configTree.
-    const char* filePathPtr   ///< Path to the file in the file system.  If NULL STDOUT is used
-                              ///< instead of a file.
+    const char* filePathPtr,  ///< Path to the file in the file system.
+    int flags                 ///< Flags to open the file with.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    json_t* nodePtr = NULL;
-    char *json_dumps_result;
+    int fd;
 
-    // Get the node path from our command line arguments.
-    if (strcmp("*", nodePathPtr) == 0)
+    do
     {
-        // Dump all trees
-        // Create JSON root item
-        json_t* rootPtr = CreateJsonNode("root", "root");
-        json_t* treeListPtr = json_array();
+        fd = open(filePathPtr, flags | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    }
+    while ((fd == -1) && (errno == EINTR));
 
-        // Loop through the trees in the system.
-        le_cfgAdmin_IteratorRef_t iteratorRef = le_cfgAdmin_CreateTreeIterator();
-        while (le_cfgAdmin_NextTree(iteratorRef) == LE_OK)
-        {
-            // Allocate space for the tree name, plus space for a trailing :/ used when we create a
-            // transaction for that tree.
-            char treeName[MAX_TREE_NAME_BYTES + 2] = "";
+    if (fd == -1)
+    {
+        fprintf(stderr, "Could not open file '%s'. Reason, %s (%d).\n",
+                filePathPtr,
+                strerror(errno),
+                errno);
+    }
 
-            if (le_cfgAdmin_GetTreeName(iteratorRef, treeName, MAX_TREE_NAME_BYTES) != LE_OK)
-            {
-                continue;
-            }
+    return fd;
+}
 
-            // JSON node for the tree.
-            json_t* treeNodePtr = CreateJsonNode(treeName, "tree");
-            strcat(treeName, ":/");
 
-            // Start a read transaction at the specified node path.  Then dump the value, (if any.)
-            le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(treeName);
-            le_cfg_GoToFirstChild(iterRef);
 
-            // Dump tree to JSON
-            DumpTreeJSON(iterRef, treeNodePtr);
-            le_cfg_CancelTxn(iterRef);
 
-            json_array_append(treeListPtr, treeNodePtr);
-        }
-        le_cfgAdmin_ReleaseTreeIterator(iteratorRef);
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check whether an open file is a regular file.  The configTree only streams tree data through
+ *  regular files, anything else has to go through a temp file.
+ *
+ *  @return True if the file is a regular file, false if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool IsRegularFile
+(
+    int fd  ///< The file to check.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
 
-        // Finalize root object...
-        json_object_set_new(rootPtr, "trees", treeListPtr);
-        nodePtr = rootPtr;
+    return (fstat(fd, &fileStat) == 0) && S_ISREG(fileStat.st_mode);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Create an anonymous temp file, which is deleted once it is closed.
+ *
+ *  @return The file, or NULL if it could not be created.
+ */
+// -------------------------------------------------------------------------------------------------
+static FILE* CreateTempFile
+(
+    void
+)
+// -------------------------------------------------------------------------------------------------
+{
+    FILE* tempFilePtr = tmpfile();
+
+    if (tempFilePtr == NULL)
+    {
+        fprintf(stderr, "Could not create temp file. Reason, %s (%d).\n",
+                strerror(errno),
+                errno);
     }
-    else
+
+    return tempFilePtr;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Copy everything left to read from one open file into another.
+ *
+ *  @return LE_OK if the copy is successful, LE_FAULT otherwise.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t CopyFileData
+(
+    int fromFd,  ///< The file to read from.
+    int toFd     ///< The file to write to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char buffer[4096];
+    ssize_t readCount;
+
+    do
     {
-        // Start a read transaction at the specified node path.  Then dump the value, (if any.)
-        le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(nodePathPtr);
+        readCount = read(fromFd, buffer, sizeof(buffer));
 
-        le_cfg_nodeType_t type = le_cfg_GetNodeType(iterRef, "");
-        switch (type)
+        if (readCount > 0)
         {
-            case LE_CFG_TYPE_STEM:
-                {
-                    char strBuffer[LE_CFG_STR_LEN_BYTES] = "";
-                    char nodeType[LE_CFG_STR_LEN_BYTES] = "";
-                    le_cfg_GetNodeName(iterRef, "", strBuffer, sizeof(strBuffer));
+            ssize_t writeCount = 0;
 
-                    // If no name, we are dumping a complete tree.
-                    if (strlen(strBuffer) == 0)
-                    {
-                        strcpy(nodeType, "tree");
-                    }
-                    else
-                    {
-                        strcpy(nodeType, NodeTypeStr(type));
-                    }
+            while (writeCount < readCount)
+            {
+                ssize_t count = write(toFd, buffer + writeCount, readCount - writeCount);
 
-                    nodePtr = CreateJsonNode(strBuffer, nodeType);
-                    le_cfg_GoToFirstChild(iterRef);
-                    DumpTreeJSON(iterRef, nodePtr);
-                    le_cfg_GoToParent(iterRef);
+                if (count >= 0)
+                {
+                    writeCount += count;
                 }
-                break;
-
-            default:
-                nodePtr = CreateJsonNodeFromIterator(iterRef);
-                break;
+                else if (errno != EINTR)
+                {
+                    fprintf(stderr, "Could not write file. Reason, %s (%d).\n",
+                            strerror(errno),
+                            errno);
+                    return LE_FAULT;
+                }
+            }
         }
-
-        le_cfg_CancelTxn(iterRef);
     }
+    while (   (readCount > 0)
+           || ((readCount == -1) && (errno == EINTR)));
 
-    if (nodePtr == NULL)
+    if (readCount == -1)
     {
-        // Empty node
-        nodePtr = json_object();
+        fprintf(stderr, "Could not read file. Reason, %s (%d).\n", strerror(errno), errno);
+        return LE_FAULT;
     }
 
-    // Dump Json content
-    // stdout mode?
+    return LE_OK;
+}
+
 
-    int result = EXIT_SUCCESS;
 
-    if (filePathPtr == NULL)
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Have the configTree export a tree node to an open file.  The file descriptor is duplicated, as
+ *  the one sent to the configTree is closed once the request has been sent, so the caller keeps its
+ *  own open.
+ *
+ *  The configTree only writes to regular files, so that it is never held up by whatever is reading
+ *  a pipe or a terminal.  For other files, the node is exported to a temp file that is then copied
+ *  over.
+ *
+ *  @return LE_OK if the export is successful, LE_FAULT otherwise.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ExportToFd
+(
+    le_cfg_IteratorRef_t iterRef,      ///< Export the node this iterator is on.
+    int fd,                            ///< Write the tree data to this file.
+    le_cfgAdmin_format_t dataFormat    ///< Format to write the tree data in.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (IsRegularFile(fd) == false)
     {
-        json_dumps_result = json_dumps(nodePtr, JSON_COMPACT);
-        if (!json_dumps_result)
+        FILE* tempFilePtr = CreateTempFile();
+
+        if (tempFilePtr == NULL)
         {
-            fprintf(stderr,"json_dumps failed");
-            result = EXIT_FAILURE;
+            return LE_FAULT;
         }
-        else
+
+        le_result_t result = ExportToFd(iterRef, fileno(tempFilePtr), dataFormat);
+
+        if (result == LE_OK)
         {
-            printf("%s\n", json_dumps_result);
-            free(json_dumps_result);
+            result = (lseek(fileno(tempFilePtr), 0, SEEK_SET) == 0)
+                         ? CopyFileData(fileno(tempFilePtr), fd)
+                         : LE_FAULT;
         }
+
+        fclose(tempFilePtr);
+
+        return result;
     }
-    else if (json_dump_file(nodePtr, filePathPtr, JSON_COMPACT) != 0)
+
+    int exportFd = dup(fd);
+
+    if (exportFd == -1)
     {
-        result = EXIT_FAILURE;
+        fprintf(stderr, "Could not duplicate file descriptor. Reason, %s (%d).\n",
+                strerror(errno),
+                errno);
+        return LE_FAULT;
     }
 
-    json_decref(nodePtr);
-    return result;
+    return le_cfgAdmin_ExportTreeStream(iterRef, exportFd, "", dataFormat);
 }
 
 
@@ -730,95 +662,57 @@ static int HandleGetJSON
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Function that handles the actual import of JSON data into the configTree.
+ *  Have the configTree import tree data from an open file into the node an iterator is on.  The
+ *  file descriptor is sent to the configTree, which closes it.
  *
- *  @return LE_OK if the import is successful, LE_FAULT otherwise.
+ *  The configTree only reads from regular files, so data from any other kind of file is copied into
+ *  a temp file first.
+ *
+ *  @return The result of the import.
  */
 // -------------------------------------------------------------------------------------------------
-static le_result_t HandleImportJSONIteration
+static le_result_t ImportFromFd
 (
-    le_cfg_IteratorRef_t iterRef,  ///< Dump the JSON data into this iterator.
-    json_t* nodePtr                ///< From this JSON object.
+    le_cfg_IteratorRef_t iterRef,      ///< Import into the node this iterator is on.
+    int fd,                            ///< Read the tree data from this file.
+    le_cfgAdmin_format_t dataFormat    ///< Format of the tree data.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // Get value
-    json_t* value = json_object_get(nodePtr, JSON_FIELD_VALUE);
-
-    // Check type
-    const char* typeStr = json_string_value(json_object_get(nodePtr, JSON_FIELD_TYPE));
-    le_cfg_nodeType_t type = GetNodeTypeFromString(typeStr);
-
-    switch (type)
+    if (IsRegularFile(fd))
     {
-        case LE_CFG_TYPE_BOOL:
-            le_cfg_SetBool(iterRef, "", json_is_true(value));
-            break;
-
-        case LE_CFG_TYPE_STRING:
-            le_cfg_SetString(iterRef, "", json_string_value(value));
-            break;
-
-        case LE_CFG_TYPE_INT:
-            le_cfg_SetInt(iterRef, "", json_integer_value(value));
-            break;
-
-        case LE_CFG_TYPE_FLOAT:
-            le_cfg_SetFloat(iterRef, "", json_real_value(value));
-            break;
+        return le_cfgAdmin_ImportTreeStream(iterRef, fd, "", dataFormat);
+    }
 
-        case LE_CFG_TYPE_STEM:
-            {
-                // Iterate on children
-                json_t* childrenPtr = json_object_get(nodePtr, JSON_FIELD_CHILDREN);
-                json_t* childPtr;
-                int i;
+    FILE* tempFilePtr = CreateTempFile();
+    le_result_t result = LE_FAULT;
 
-                json_array_foreach(childrenPtr, i, childPtr)
-                {
-                    // Get name
-                    const char* name = json_string_value(json_object_get(childPtr,
-                                                                         JSON_FIELD_NAME));
+    if (tempFilePtr != NULL)
+    {
+        result = CopyFileData(fd, fileno(tempFilePtr));
+    }
 
-                    // Is node exist with this name?
-                    le_cfg_nodeType_t existingType = le_cfg_GetNodeType(iterRef, name);
-                    switch (existingType)
-                    {
-                        case LE_CFG_TYPE_DOESNT_EXIST:
-                        case LE_CFG_TYPE_STEM:
-                        case LE_CFG_TYPE_EMPTY:
-                            // Not existing, already a stem or empty node, nothing to do
-                        break;
-
-                        default:
-                            // Issue with node creation
-                            fprintf(stderr, "Node conflict when importing, at node %s", name);
-                            return LE_NOT_POSSIBLE;
-                        break;
-                    }
+    close(fd);
 
-                    // Iterate to this child
-                    le_cfg_GoToNode(iterRef, name);
+    if (result == LE_OK)
+    {
+        int importFd = -1;
 
-                    // Iterate
-                    le_result_t subResult = HandleImportJSONIteration(iterRef, childPtr);
-                    if (subResult != LE_OK)
-                    {
-                        // Something went wrong
-                        return subResult;
-                    }
+        if (lseek(fileno(tempFilePtr), 0, SEEK_SET) == 0)
+        {
+            importFd = dup(fileno(tempFilePtr));
+        }
 
-                    // Go back to parent
-                    le_cfg_GoToParent(iterRef);
-                }
-            }
-            break;
+        result = (importFd != -1) ? le_cfgAdmin_ImportTreeStream(iterRef, importFd, "", dataFormat)
+                                  : LE_FAULT;
+    }
 
-        default:
-            return LE_FAULT;
+    if (tempFilePtr != NULL)
+    {
+        fclose(tempFilePtr);
     }
 
-    return LE_OK;
+    return result;
 }
 
 
@@ -826,40 +720,125 @@ static le_result_t HandleImportJSONIteration
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Load a JSON representation of some config data and import it into the configTree at the
- *  iterator's starting location.
+ *  This function will attempt read a value from the tree, and write it to standard out, or to a
+ *  file.  The tree data will be written in JSON format.
+ *
+ *  If the specified node is a stem, then the tree structure will be dumped, starting at the
+ *  specified node.  If a '*' is given for a node path then all trees in the system will be dumped
+ *  into a JSON document.
+ *
+ *  The JSON is written by the configTree itself instead of walking the tree one node at a time,
+ *  through a temp file unless the file is a regular one.
  *
- *  @return LE_OK if the import is successful.  LE_FAULT otherwise.
+ *  @return LE_OK if the export is successful, LE_FAULT otherwise.
  */
 // -------------------------------------------------------------------------------------------------
-static le_result_t HandleImportJSON
+static le_result_t HandleGetJSON
 (
-    le_cfg_IteratorRef_t iterRef,  ///< The iterator being written to.
-    const char* filePathPtr        ///< Load the JSON from a file at this path.
+    const char* nodePathPtr,  ///< Path to the node in the configTree.
+    int fd                    ///< Write the JSON document to this file.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // Attempt to load JSON file.  If it fails to validate, then bail out.
-    json_error_t error;
-    json_t* decodedRootPtr = json_load_file(filePathPtr, 0, &error);
+    le_result_t result = LE_OK;
 
-    if (decodedRootPtr == NULL)
+    // Get the node path from our command line arguments.
+    if (strcmp("*", nodePathPtr) == 0)
     {
-        fprintf(stderr,
-                "JSON import error: line: %d, column: %d, position: %d, source: '%s', error: %s",
-                error.line,
-                error.column,
-                error.position,
-                error.source,
-                error.text);
+        // Dump all trees
+        // Create JSON root item
+        json_t* rootPtr = CreateJsonNode("root", "root");
+        json_t* treeListPtr = json_array();
 
-        return LE_FAULT;
+        // Loop through the trees in the system.
+        le_cfgAdmin_IteratorRef_t iteratorRef = le_cfgAdmin_CreateTreeIterator();
+        while (   (result == LE_OK)
+               && (le_cfgAdmin_NextTree(iteratorRef) == LE_OK))
+        {
+            // Allocate space for the tree name, plus space for a trailing :/ used when we create a
+            // transaction for that tree.
+            char treeName[MAX_TREE_NAME_BYTES + 2] = "";
+
+            if (le_cfgAdmin_GetTreeName(iteratorRef, treeName, MAX_TREE_NAME_BYTES) != LE_OK)
+            {
+                continue;
+            }
+
+            // Have the tree exported into a scratch file, then load it back as the tree's node.
+            FILE* tempFilePtr = CreateTempFile();
+
+            if (tempFilePtr == NULL)
+            {
+                result = LE_FAULT;
+                break;
+            }
+
+            char treePath[MAX_TREE_NAME_BYTES + 2] = "";
+            snprintf(treePath, sizeof(treePath), "%s:/", treeName);
+
+            le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(treePath);
+            result = ExportToFd(iterRef, fileno(tempFilePtr), LE_CFGADMIN_FORMAT_JSON);
+            le_cfg_CancelTxn(iterRef);
+
+            if (result == LE_OK)
+            {
+                json_error_t error;
+
+                rewind(tempFilePtr);
+                json_t* treeNodePtr = json_loadf(tempFilePtr, 0, &error);
+
+                if (treeNodePtr == NULL)
+                {
+                    fprintf(stderr, "Could not load exported tree '%s': %s\n", treeName, error.text);
+                    result = LE_FAULT;
+                }
+                else
+                {
+                    json_object_set_new(treeNodePtr, JSON_FIELD_NAME, json_string(treeName));
+                    json_object_set_new(treeNodePtr, JSON_FIELD_TYPE, json_string("tree"));
+                    json_array_append_new(treeListPtr, treeNodePtr);
+                }
+            }
+
+            fclose(tempFilePtr);
+        }
+        le_cfgAdmin_ReleaseTreeIterator(iteratorRef);
+
+        // Finalize root object...
+        json_object_set_new(rootPtr, "trees", treeListPtr);
+
+        if (result == LE_OK)
+        {
+            FILE* filePtr = fdopen(dup(fd), "w");
+
+            if (   (filePtr == NULL)
+                || (json_dumpf(rootPtr, filePtr, JSON_COMPACT) != 0))
+            {
+                result = LE_FAULT;
+            }
+
+            if (   (filePtr != NULL)
+                && (fclose(filePtr) != 0))
+            {
+                result = LE_FAULT;
+            }
+        }
+
+        json_decref(rootPtr);
+    }
+    else
+    {
+        // Start a read transaction at the specified node path, and have its data streamed out.
+        le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(nodePathPtr);
+        result = ExportToFd(iterRef, fd, LE_CFGADMIN_FORMAT_JSON);
+        le_cfg_CancelTxn(iterRef);
     }
 
-    // OK, looks like the JSON loaded, so iterate through it and dump it's contents into the
-    // configTree.
-    le_result_t result = HandleImportJSONIteration(iterRef, decodedRootPtr);
-    json_decref(decodedRootPtr);
+    if (   (result == LE_OK)
+        && (write(fd, "\n", 1) != 1))
+    {
+        result = LE_FAULT;
+    }
 
     return result;
 }
@@ -884,7 +863,18 @@ static int HandleGet
 {
     if (UseJson)
     {
-        return HandleGetJSON(NodePath, NULL);
+        // Anything already buffered has to go out ahead of the JSON document.
+        fflush(stdout);
+
+        le_result_t result = HandleGetJSON(NodePath, STDOUT_FILENO);
+
+        if (result != LE_OK)
+        {
+            fprintf(stderr, "Get failure, %d: %s.\n", result, LE_RESULT_TXT(result));
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
     }
 
     // Looks like we're just outputing the human readable format.
@@ -1076,7 +1066,7 @@ static int HandleCopy
 
     // Create a transaction and export the data from the config tree.
     le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(NodePath);
-    le_result_t result = le_cfgAdmin_ExportTree(iterRef, tempFilePath, "");
+    le_result_t result = ExportToFd(iterRef, tempFd, LE_CFGADMIN_FORMAT_TEXT);
 
     if (result != LE_OK)
     {
@@ -1092,9 +1082,28 @@ static int HandleCopy
         le_cfg_DeleteNode(iterRef, "");
     }
 
-    // Now, move the iterator to the node's new name, then attempt to reload the data.
+    // Now, move the iterator to the node's new name, then attempt to reload the data from the
+    // start of the temp file.
     le_cfg_GoToNode(iterRef, "..");
-    result = le_cfgAdmin_ImportTree(iterRef, tempFilePath, NodeDestPath);
+
+    int importFd = -1;
+
+    if (lseek(tempFd, 0, SEEK_SET) == 0)
+    {
+        importFd = dup(tempFd);
+    }
+
+    if (importFd == -1)
+    {
+        result = LE_FAULT;
+    }
+    else
+    {
+        result = le_cfgAdmin_ImportTreeStream(iterRef,
+                                              importFd,
+                                              NodeDestPath,
+                                              LE_CFGADMIN_FORMAT_TEXT);
+    }
 
     if (result != LE_OK)
     {
@@ -1168,21 +1177,28 @@ static int HandleImport
 )
 // -------------------------------------------------------------------------------------------------
 {
-    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(NodePath);
-    le_result_t result;
+    // The file is opened here, so it is read with the permissions of the user running this tool.
+    // The configTree then parses the whole file in one go, whatever its format.  JSON data is
+    // merged into the node, failing if it has a node where the tree already has a value.
+    int fd = OpenDataFile(FilePath, O_RDONLY);
 
-    // Check requested format format.
-    if (UseJson)
+    if (fd == -1)
     {
-        result = HandleImportJSON(iterRef, FilePath);
-    }
-    else
-    {
-        result = le_cfgAdmin_ImportTree(iterRef, FilePath, "");
+        return EXIT_FAILURE;
     }
 
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(NodePath);
+    le_result_t result = ImportFromFd(iterRef,
+                                      fd,
+                                      UseJson ? LE_CFGADMIN_FORMAT_JSON : LE_CFGADMIN_FORMAT_TEXT);
+
     if (result != LE_OK)
     {
+        if (result == LE_NOT_POSSIBLE)
+        {
+            fprintf(stderr, "Node conflict when importing, the configTree log names the node.\n");
+        }
+
         ReportImportExportFail(result, "Import", NodePath, FilePath);
         le_cfg_CancelTxn(iterRef);
 
@@ -1210,19 +1226,31 @@ static int HandleExport
 // -------------------------------------------------------------------------------------------------
 {
     le_result_t result;
+    int fd = OpenDataFile(FilePath, O_WRONLY | O_CREAT | O_TRUNC);
+
+    if (fd == -1)
+    {
+        return EXIT_FAILURE;
+    }
 
     // Check required format.
     if (UseJson)
     {
-        result = HandleGetJSON(NodePath, FilePath);
+        result = HandleGetJSON(NodePath, fd);
     }
     else
     {
         le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(NodePath);
-        result = le_cfgAdmin_ExportTree(iterRef, FilePath, "");
+        result = ExportToFd(iterRef, fd, LE_CFGADMIN_FORMAT_TEXT);
         le_cfg_CancelTxn(iterRef);
     }
 
+    if (   (close(fd) == -1)
+        && (result == LE_OK))
+    {
+        result = LE_FAULT;
+    }
+
     if (result != LE_OK)
     {
         ReportImportExportFail(result, "Export", NodePath, FilePath);
@@ -34,6 +34,7 @@ typedef struct MemPoolIter*         MemPoolIter_Ref_t;
 typedef struct ThreadObjIter*       ThreadObjIter_Ref_t;
 typedef struct TimerIter*           TimerIter_Ref_t;
 typedef struct MutexIter*           MutexIter_Ref_t;
+typedef struct MutexProfileIter*    MutexProfileIter_Ref_t;
 typedef struct SemaphoreIter*       SemaphoreIter_Ref_t;
 typedef struct ThreadMemberObjIter* ThreadMemberObjIter_Ref_t;
 typedef struct ServiceObjIter*      ServiceObjIter_Ref_t;
@@ -53,6 +54,7 @@ typedef enum
     INSPECT_INSP_TYPE_THREAD_OBJ,
     INSPECT_INSP_TYPE_TIMER,
     INSPECT_INSP_TYPE_MUTEX,
+    INSPECT_INSP_TYPE_MUTEX_PROFILE,
     INSPECT_INSP_TYPE_SEMAPHORE,
     INSPECT_INSP_TYPE_IPC_SERVERS,
     INSPECT_INSP_TYPE_IPC_CLIENTS,
@@ -128,6 +130,13 @@ typedef struct MutexIter
 }
 MutexIter_t;
 
+typedef struct MutexProfileIter
+{
+    RemoteListAccess_t mutexList;     ///< List of all the mutexes in the remote process.
+    Mutex_t currMutex;                ///< Current mutex from the list.
+}
+MutexProfileIter_t;
+
 typedef struct SemaphoreIter
 {
     RemoteListAccess_t threadObjList;
@@ -638,6 +647,51 @@ static SemaphoreIter_Ref_t CreateSemaphoreIter
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an iterator that can be used to iterate over the list of all the mutexes of a specific
+ * process, for their contention profiles. See the comment block for CreateMemPoolIter for
+ * additional detail.
+ *
+ * @return
+ *      An iterator to the list of mutexes for the specified process.
+ */
+//--------------------------------------------------------------------------------------------------
+static MutexProfileIter_Ref_t CreateMutexProfileIter
+(
+    void
+)
+{
+    // Get the address offset of the mutex list for the process to inspect.
+    off_t listAddrOffset = GetRemoteAddress(PidToInspect, mutex_GetMutexList());
+
+    // Get the address offset of the mutex creation/deletion counter for the process to inspect.
+    off_t listChgCntAddrOffset = GetRemoteAddress(PidToInspect,
+                                                  mutex_GetMutexCreateDeleteCntRef());
+
+    // Create the iterator.
+    MutexProfileIter_t* iteratorPtr = le_mem_ForceAlloc(IteratorPool);
+    InitRemoteListAccessObj(&iteratorPtr->mutexList);
+
+    // Get the List for the process-under-inspection.
+    if (fd_ReadFromOffset(FdProcMem, listAddrOffset, &(iteratorPtr->mutexList.List),
+                             sizeof(iteratorPtr->mutexList.List)) != LE_OK)
+    {
+        INTERNAL_ERR(REMOTE_READ_ERR("mutex list"));
+    }
+
+    // Get the ListChgCntRef for the process-under-inspection.
+    if (fd_ReadFromOffset(FdProcMem, listChgCntAddrOffset,
+                          &(iteratorPtr->mutexList.ListChgCntRef),
+                          sizeof(iteratorPtr->mutexList.ListChgCntRef)) != LE_OK)
+    {
+        INTERNAL_ERR(REMOTE_READ_ERR("mutex creation/deletion counter ref"));
+    }
+
+    return iteratorPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates an iterator that can be used to iterate over the map of interface objects. See the
@@ -861,6 +915,31 @@ static size_t GetThreadObjListChgCnt
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the mutex list change counter from the specified iterator.  The list only changes when
+ * mutexes are created or deleted.
+ *
+ * @return
+ *      List change counter.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t GetMutexListChgCnt
+(
+    MutexProfileIter_Ref_t iterator ///< [IN] The iterator to get the list change counter from.
+)
+{
+    size_t mutexListChgCnt;
+    if (fd_ReadFromOffset(FdProcMem, (ssize_t)(iterator->mutexList.ListChgCntRef),
+                          &mutexListChgCnt, sizeof(mutexListChgCnt)) != LE_OK)
+    {
+        INTERNAL_ERR(REMOTE_READ_ERR("mutex creation/deletion counter"));
+    }
+
+    return mutexListChgCnt;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the timer list change counter from the specified iterator. Note while there's one timer list
@@ -1277,6 +1356,42 @@ static Mutex_t* GetNextMutex
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the next mutex from the list of all the mutexes of the process. For other detail see
+ * GetNextMemPool.
+ *
+ * @return
+ *      A mutex from the iterator's list of mutexes.
+ */
+//--------------------------------------------------------------------------------------------------
+static Mutex_t* GetNextMutexProfile
+(
+    MutexProfileIter_Ref_t mutexIterRef ///< [IN] The iterator to get the next mutex from.
+)
+{
+    le_dls_Link_t* linkPtr = GetNextLink(&(mutexIterRef->mutexList),
+                                         &(mutexIterRef->currMutex.mutexListLink));
+
+    if (linkPtr == NULL)
+    {
+        return NULL;
+    }
+
+    // Get the address of mutex.
+    Mutex_t* remMutexPtr = CONTAINER_OF(linkPtr, Mutex_t, mutexListLink);
+
+    // Read the mutex into our own memory.
+    if (fd_ReadFromOffset(FdProcMem, (ssize_t)remMutexPtr, &(mutexIterRef->currMutex),
+                          sizeof(mutexIterRef->currMutex)) != LE_OK)
+    {
+        INTERNAL_ERR(REMOTE_READ_ERR("mutex object"));
+    }
+
+    return &(mutexIterRef->currMutex);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the next semaphore. Since there's no "semaphore list" and therefore each thread object owns
@@ -1555,7 +1670,7 @@ static void PrintHelp
         "              Legato process.\n"
         "\n"
         "SYNOPSIS:\n"
-        "    inspect <pools|threads|timers|mutexes|semaphores> [OPTIONS] PID\n"
+        "    inspect <pools|threads|timers|mutexes|locks|semaphores> [OPTIONS] PID\n"
         "    inspect ipc <servers|clients [sessions]> [OPTIONS] PID\n"
         "\n"
         "DESCRIPTION:\n"
@@ -1565,6 +1680,9 @@ static void PrintHelp
                                         " specified process.\n"
         "    inspect mutexes            Prints the info of mutexes in all threads for the"
                                         " specified process.\n"
+        "    inspect locks              Prints the contention profiles of all the mutexes of the"
+                                        " specified process,\n"
+        "                               which must have been started with LE_MUTEX_PROFILE=1.\n"
         "    inspect semaphores         Prints the info of semaphores in all threads for the"
                                         " specified process.\n"
         "    inspect ipc                Prints the info of ipc in all threads for the"
@@ -1699,6 +1817,25 @@ static ColumnInfo_t MutexTableInfo[] =
 };
 static size_t MutexTableInfoSize = NUM_ARRAY_MEMBERS(MutexTableInfo);
 
+// The wait time histogram is only printed in verbose mode.
+static ColumnInfo_t MutexProfileTableInfo[] =
+{
+    {"NAME",         "%*s", NULL, "%*s",        MAX_NAME_BYTES,       true,  0, true},
+    {"ACQUIRED",     "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),     false, 0, true},
+    {"CONTENDED",    "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),     false, 0, true},
+    {"WAIT US",      "%*s", NULL, "%*"PRIu64"", sizeof(uint64_t),     false, 0, true},
+    {"MAX WAIT US",  "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, true},
+    {"<10US",        "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, false},
+    {"<100US",       "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, false},
+    {"<1MS",         "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, false},
+    {"<10MS",        "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, false},
+    {"<100MS",       "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, false},
+    {"<1S",          "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, false},
+    {">=1S",         "%*s", NULL, "%*u",        sizeof(uint32_t),     false, 0, false},
+    {"HOLDER",       "%*s", NULL, "%*s",        MAX_THREAD_NAME_SIZE, true,  0, true}
+};
+static size_t MutexProfileTableInfoSize = NUM_ARRAY_MEMBERS(MutexProfileTableInfo);
+
 static ColumnInfo_t SemaphoreTableInfo[] =
 {
     {"NAME",         "%*s", NULL, "%*s", LIMIT_MAX_SEMAPHORE_NAME_BYTES, true,  0, true},
@@ -2050,6 +2187,10 @@ static void InitDisplay
             InitDisplayTable(MutexTableInfo, MutexTableInfoSize);
             break;
 
+        case INSPECT_INSP_TYPE_MUTEX_PROFILE:
+            InitDisplayTable(MutexProfileTableInfo, MutexProfileTableInfoSize);
+            break;
+
         case INSPECT_INSP_TYPE_SEMAPHORE:
             InitDisplayTable(SemaphoreTableInfo, SemaphoreTableInfoSize);
             break;
@@ -2243,6 +2384,12 @@ static int PrintInspectHeader
             tableSize = MutexTableInfoSize;
             break;
 
+        case INSPECT_INSP_TYPE_MUTEX_PROFILE:
+            strncpy(inspectTypeString, "Mutex Contention", inspectTypeStringSize);
+            table = MutexProfileTableInfo;
+            tableSize = MutexProfileTableInfoSize;
+            break;
+
         case INSPECT_INSP_TYPE_SEMAPHORE:
             strncpy(inspectTypeString, "Semaphores", inspectTypeStringSize);
             table = SemaphoreTableInfo;
@@ -3324,6 +3471,91 @@ static int PrintMutexInfo
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the contention profile of a mutex to stdout.
+ */
+//--------------------------------------------------------------------------------------------------
+static int PrintMutexProfileInfo
+(
+    Mutex_t* mutexRef   ///< [IN] ref to mutex to be printed.
+)
+{
+    int lineCount = 0;
+    mutex_Profile_t* profilePtr = &mutexRef->profile;
+    int i;
+
+    // The holder name is read from another process, so make sure it is terminated.
+    profilePtr->holderName[sizeof(profilePtr->holderName) - 1] = '\0';
+
+    // Output mutex profile info
+    int index = 0;
+
+    if (!IsOutputJson)
+    {
+        FillStrColField   (mutexRef->name,              MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index);
+        FillUint64ColField(profilePtr->acquireCount,    MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index);
+        FillUint64ColField(profilePtr->contendedCount,  MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index);
+        FillUint64ColField(profilePtr->totalWaitUsec,   MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index);
+        FillUint32ColField(profilePtr->maxWaitUsec,     MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index);
+        for (i = 0; i < MUTEX_WAIT_BUCKET_COUNT; i++)
+        {
+            FillUint32ColField(profilePtr->waitBuckets[i], MutexProfileTableInfo,
+                                                           MutexProfileTableInfoSize, &index);
+        }
+        FillStrColField   (profilePtr->holderName,      MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index);
+
+        PrintInfo(MutexProfileTableInfo, MutexProfileTableInfoSize);
+        lineCount++;
+    }
+    else
+    {
+        // If it's not the first time, print a comma.
+        if (!IsPrintedNodeFirst)
+        {
+            printf(",");
+        }
+        else
+        {
+            IsPrintedNodeFirst = false;
+        }
+
+        bool printed = false;
+
+        printf("[");
+
+        ExportStrToJson   (mutexRef->name,              MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index, &printed);
+        ExportUint64ToJson(profilePtr->acquireCount,    MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index, &printed);
+        ExportUint64ToJson(profilePtr->contendedCount,  MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index, &printed);
+        ExportUint64ToJson(profilePtr->totalWaitUsec,   MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index, &printed);
+        ExportUint32ToJson(profilePtr->maxWaitUsec,     MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index, &printed);
+        for (i = 0; i < MUTEX_WAIT_BUCKET_COUNT; i++)
+        {
+            ExportUint32ToJson(profilePtr->waitBuckets[i], MutexProfileTableInfo,
+                                                           MutexProfileTableInfoSize,
+                                                           &index, &printed);
+        }
+        ExportStrToJson   (profilePtr->holderName,      MutexProfileTableInfo,
+                                                        MutexProfileTableInfoSize, &index, &printed);
+
+        printf("]");
+    }
+
+    return lineCount;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Print semaphore information to stdout.
@@ -3812,6 +4044,13 @@ static void InspectFunc
             printNodeInfoFunc = (PrintNodeInfoFunc_t) PrintMutexInfo;
             break;
 
+        case INSPECT_INSP_TYPE_MUTEX_PROFILE:
+            createIterFunc    = (CreateIterFunc_t)    CreateMutexProfileIter;
+            getListChgCntFunc = (GetListChgCntFunc_t) GetMutexListChgCnt;
+            getNextNodeFunc   = (GetNextNodeFunc_t)   GetNextMutexProfile;
+            printNodeInfoFunc = (PrintNodeInfoFunc_t) PrintMutexProfileInfo;
+            break;
+
         case INSPECT_INSP_TYPE_SEMAPHORE:
             createIterFunc    = (CreateIterFunc_t)    CreateSemaphoreIter;
             getListChgCntFunc = (GetListChgCntFunc_t) GetThreadMemberObjListChgCnt;
@@ -4034,6 +4273,10 @@ static void CommandArgHandler
     {
         InspectType = INSPECT_INSP_TYPE_MUTEX;
     }
+    else if (strcmp(command, "locks") == 0)
+    {
+        InspectType = INSPECT_INSP_TYPE_MUTEX_PROFILE;
+    }
     else if (strcmp(command, "semaphores") == 0)
     {
         InspectType = INSPECT_INSP_TYPE_SEMAPHORE;
@@ -4133,6 +4376,10 @@ static void InitIteratorPool
             size = sizeof(MutexIter_t);
             break;
 
+        case INSPECT_INSP_TYPE_MUTEX_PROFILE:
+            size = sizeof(MutexProfileIter_t);
+            break;
+
         case INSPECT_INSP_TYPE_SEMAPHORE:
             size = sizeof(SemaphoreIter_t);
             break;
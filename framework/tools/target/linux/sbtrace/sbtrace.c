@@ -17,20 +17,31 @@
 #include "interfaces.h"
 #include "sysPaths.h"
 #include <sys/ptrace.h>
+#include <sys/uio.h>
+#include <sys/user.h>
+#include <elf.h>
 #include <unistd.h>
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Structure to hold register values.
+ * Maximum number of arguments a system call can have.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SYSCALL_ARGS        6
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A system call made by a tracee, as read from the tracee when it is stopped at the system call.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    // This is ARM specific.
-    int regs[18];
+    long nr;                                ///< The system call number.
+    unsigned long args[MAX_SYSCALL_ARGS];   ///< The system call arguments.
 }
-Registers_t;
+SysCall_t;
 
 
 //--------------------------------------------------------------------------------------------------
@@ -88,38 +99,45 @@ FileAccessSysCall_t;
 //--------------------------------------------------------------------------------------------------
 /**
  * Array of system calls that access a file or directory.
+ *
+ * The directory file descriptor given to the *at() variants is not looked at, so the paths they
+ * access are only found if they are absolute or relative to the current working directory.
  */
 //--------------------------------------------------------------------------------------------------
 static const FileAccessSysCall_t FileAccessSysCalls[] =
 {
+    // Not all architectures have these, some only have the *at() variants.
+#ifdef __NR_open
     {__NR_open,             0,      "open"},
     {__NR_creat,            0,      "creat"},
     {__NR_link,             0,      "link"},
     {__NR_unlink,           0,      "unlink"},
-    {__NR_execve,           0,      "execve"},
-    {__NR_chdir,            0,      "chdir"},
     {__NR_mknod,            0,      "mknod"},
     {__NR_chmod,            0,      "chmod"},
     {__NR_lchown,           0,      "lchown"},
-    {__NR_mount,            0,      "mount"},
     {__NR_access,           0,      "access"},
     {__NR_rename,           0,      "rename"},
     {__NR_mkdir,            0,      "mkdir"},
     {__NR_rmdir,            0,      "rmdir"},
-    {__NR_acct,             0,      "acct"},
-    {__NR_umount2,          0,      "umount2"},
-    {__NR_chroot,           0,      "chroot"},
     {__NR_symlink,          0,      "symlink"},
     {__NR_readlink,         0,      "readlink"},
     {__NR_uselib,           0,      "uselib"},
+    {__NR_stat,             0,      "stat"},
+    {__NR_lstat,            0,      "lstat"},
+    {__NR_chown,            0,      "chown"},
+#endif
+
+    {__NR_execve,           0,      "execve"},
+    {__NR_chdir,            0,      "chdir"},
+    {__NR_mount,            0,      "mount"},
+    {__NR_acct,             0,      "acct"},
+    {__NR_umount2,          0,      "umount2"},
+    {__NR_chroot,           0,      "chroot"},
     {__NR_swapon,           0,      "swapon"},
     {__NR_truncate,         0,      "truncate"},
     {__NR_statfs,           0,      "statfs"},
-    {__NR_stat,             0,      "stat"},
-    {__NR_lstat,            0,      "lstat"},
     {__NR_swapoff,          0,      "swapoff"},
     {__NR_quotactl,         1,      "quotactl"},
-    {__NR_chown,            0,      "chown"},
     {__NR_setxattr,         0,      "setxattr"},
     {__NR_lsetxattr,        0,      "lsetxattr"},
     {__NR_getxattr,         0,      "getxattr"},
@@ -129,10 +147,76 @@ static const FileAccessSysCall_t FileAccessSysCalls[] =
     {__NR_removexattr,      0,      "removexattr"},
     {__NR_lremovexattr,     0,      "lremovexattr"},
 
-#ifdef __NR_recvfrom
-    {__NR_recvfrom,         4,      "recvfrom"},
+#ifdef __NR_openat
+    {__NR_openat,           1,      "openat"},
+#endif
+
+#ifdef __NR_mkdirat
+    {__NR_mkdirat,          1,      "mkdirat"},
+#endif
+
+#ifdef __NR_mknodat
+    {__NR_mknodat,          1,      "mknodat"},
+#endif
+
+#ifdef __NR_fchownat
+    {__NR_fchownat,         1,      "fchownat"},
+#endif
+
+#ifdef __NR_newfstatat
+    {__NR_newfstatat,       1,      "newfstatat"},
+#endif
+
+#ifdef __NR_fstatat64
+    {__NR_fstatat64,        1,      "fstatat64"},
+#endif
+
+#ifdef __NR_unlinkat
+    {__NR_unlinkat,         1,      "unlinkat"},
+#endif
+
+#ifdef __NR_renameat
+    {__NR_renameat,         1,      "renameat"},
+#endif
+
+#ifdef __NR_renameat2
+    {__NR_renameat2,        1,      "renameat2"},
 #endif
 
+#ifdef __NR_linkat
+    {__NR_linkat,           1,      "linkat"},
+#endif
+
+#ifdef __NR_symlinkat
+    {__NR_symlinkat,        0,      "symlinkat"},
+#endif
+
+#ifdef __NR_readlinkat
+    {__NR_readlinkat,       1,      "readlinkat"},
+#endif
+
+#ifdef __NR_fchmodat
+    {__NR_fchmodat,         1,      "fchmodat"},
+#endif
+
+#ifdef __NR_faccessat
+    {__NR_faccessat,        1,      "faccessat"},
+#endif
+
+#ifdef __NR_faccessat2
+    {__NR_faccessat2,       1,      "faccessat2"},
+#endif
+
+#ifdef __NR_execveat
+    {__NR_execveat,         1,      "execveat"},
+#endif
+
+#ifdef __NR_statx
+    {__NR_statx,            1,      "statx"},
+#endif
+
+    // The address given to recvfrom() is only filled in by the kernel, so it can't be read when the
+    // system call is made.
 #ifdef __NR_sendto
     {__NR_sendto,           4,      "sendto"},
 #endif
@@ -273,6 +357,59 @@ static le_mem_PoolRef_t FilePool = NULL;
 static const char* RequiresPathPtr = NULL;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag that indicates whether the supervisor is asked to filter the system calls the app's
+ * processes stop at, so that the tracees only stop at the system calls in FileAccessSysCalls rather
+ * than at every system call.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool UseFilter = true;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Paths that the app has already accessed.  Once the app has tried to access a path, whether it was
+ * added to the sandbox, or denied or can't be added, nothing more needs to be done the next time
+ * it's accessed.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t SeenPathMap = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Estimated maximum number of different paths an app accesses.
+ */
+//--------------------------------------------------------------------------------------------------
+#define ESTIMATED_NUM_PATHS                 127
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of paths in SeenPathMap.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t SeenPathPool = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of file access system calls that the tracees have made.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t NumSysCallsTraced = 0;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Flag that indicates whether the tracees' memory can be read with process_vm_readv().  If not,
+ * it is read a word at a time with PTRACE_PEEKDATA.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CanReadVm = true;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Prints a generic message on stderr so that the user is aware there is a problem, logs the
@@ -330,6 +467,12 @@ static void PrintHelp
         "   -o <PATH>, --output=<PATH>\n"
         "       Writes the 'requires' section to a file specified at PATH.\n"
         "\n"
+        "   --no-filter\n"
+        "       Stop the app at every system call it makes, rather than having the kernel only\n"
+        "       stop it at the system calls that access files.  This is much slower and is only\n"
+        "       needed to trace an app on a kernel without seccomp filters, which sbtrace falls\n"
+        "       back to by itself.\n"
+        "\n"
         );
 
     exit(EXIT_SUCCESS);
@@ -352,88 +495,181 @@ static void SetRequireFilePath
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Gets the system call number from the registers.
+ * Turns off system call filtering.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DisableFilter
+(
+    void
+)
+{
+    UseFilter = false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wrapper for ptrace() calls that only return a result code, ie. do not use this for
+ * PTRACE_PEEK* calls.
  *
- * This function should be used rather than accessing the registers directly as it handles platform
- * specific differences.
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the tracee does not exist, is not being traced, or is not stopped.
  */
 //--------------------------------------------------------------------------------------------------
-static int GetSysCallNum
+static int Ptrace
 (
-    const Registers_t* regPtr           ///< [IN] Set of register values.
+    enum __ptrace_request request,
+    pid_t pid,
+    void *addr,
+    void *data
 )
 {
-    // This is ARM specific.
-    return regPtr->regs[7];
+
+    if (ptrace(request, pid, addr, data) == -1)
+    {
+        if (errno == ESRCH)
+        {
+            return LE_NOT_FOUND;
+        }
+
+        fprintf(stderr, "Error could not make ptrace() request %d.  %m.\n", request);
+        exit(EXIT_FAILURE);
+    }
+
+    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get system call arguments.
+ * Gets the system call that a tracee is stopped at from its registers.
  *
- * This function should be used rather than accessing the registers directly as it handles platform
- * specific differences.
+ * This handles the platform specific differences in how system calls are made, and is used on
+ * kernels that can't give the system call with PTRACE_GET_SYSCALL_INFO.
  *
  * @return
- *      Returns the arguments value, or the address to the argumnets for arguments that are passed
- *      by reference.
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if the tracee does not exist, is not being traced, or is not stopped.
  */
 //--------------------------------------------------------------------------------------------------
-static int GetSysCallArg
+static le_result_t GetSysCallFromRegs
 (
-    const Registers_t* regPtr,          ///< [IN] Set of register values.
-    uint argIndex                       ///< [IN] Index of the argument to get.
+    pid_t pid,                          ///< [IN] PID (actually the thread ID) of the tracee.
+    SysCall_t* sysCallPtr               ///< [OUT] The system call.
 )
 {
-#define MAX_ARGS        7
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    struct user_regs_struct regs;
+#elif defined(__arm__)
+    struct user_regs regs;
+#else
+#error "Getting system calls from the registers is not supported on this architecture."
+#endif
+
+    struct iovec regsVec = { .iov_base = &regs, .iov_len = sizeof(regs) };
 
-    if (argIndex < MAX_ARGS)
+    if (Ptrace(PTRACE_GETREGSET, pid, (void*)NT_PRSTATUS, &regsVec) == LE_NOT_FOUND)
     {
-        // This is ARM specific.
-        return regPtr->regs[argIndex];
+        return LE_NOT_FOUND;
     }
 
-    LE_FATAL("More than %d arguments is not supported.", MAX_ARGS);
+#if defined(__x86_64__)
+    sysCallPtr->nr = regs.orig_rax;
+    sysCallPtr->args[0] = regs.rdi;
+    sysCallPtr->args[1] = regs.rsi;
+    sysCallPtr->args[2] = regs.rdx;
+    sysCallPtr->args[3] = regs.r10;
+    sysCallPtr->args[4] = regs.r8;
+    sysCallPtr->args[5] = regs.r9;
+#elif defined(__i386__)
+    sysCallPtr->nr = regs.orig_eax;
+    sysCallPtr->args[0] = regs.ebx;
+    sysCallPtr->args[1] = regs.ecx;
+    sysCallPtr->args[2] = regs.edx;
+    sysCallPtr->args[3] = regs.esi;
+    sysCallPtr->args[4] = regs.edi;
+    sysCallPtr->args[5] = regs.ebp;
+#elif defined(__aarch64__)
+    sysCallPtr->nr = regs.regs[8];
+    memcpy(sysCallPtr->args, regs.regs, sizeof(sysCallPtr->args));
+#elif defined(__arm__)
+    sysCallPtr->nr = regs.uregs[7];
+    memcpy(sysCallPtr->args, regs.uregs, sizeof(sysCallPtr->args));
+#endif
+
+    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Wrapper for ptrace() calls that only return a result code, ie. do not use this for
- * PTRACE_PEEK* calls.
+ * Gets the system call that a tracee is stopped at.
  *
  * @return
  *      LE_OK if successful.
- *      LE_NOT_FOUND if the tracee does not exist, is not being traced, or is not stopped.
+ *      LE_NOT_FOUND if the tracee does not exist, is not being traced, or is not stopped at a
+ *                   system call.
  */
 //--------------------------------------------------------------------------------------------------
-static int Ptrace
+static le_result_t GetSysCall
 (
-    enum __ptrace_request request,
-    pid_t pid,
-    void *addr,
-    void *data
+    pid_t pid,                          ///< [IN] PID (actually the thread ID) of the tracee.
+    SysCall_t* sysCallPtr               ///< [OUT] The system call.
 )
 {
+#ifdef PTRACE_GET_SYSCALL_INFO
+    static bool hasSysCallInfo = true;
 
-    if (ptrace(request, pid, addr, data) == -1)
+    if (hasSysCallInfo)
     {
-        if (errno == ESRCH)
+        struct __ptrace_syscall_info info;
+
+        if (ptrace(PTRACE_GET_SYSCALL_INFO, pid, (void*)sizeof(info), &info) == -1)
         {
-            return LE_NOT_FOUND;
+            if (errno == ESRCH)
+            {
+                return LE_NOT_FOUND;
+            }
+
+            INTERNAL_ERR_IF(errno != EIO, "Could not get the tracee's system call.  %m.");
+
+            // Kernels older than 5.3 don't have PTRACE_GET_SYSCALL_INFO.
+            hasSysCallInfo = false;
         }
+        else
+        {
+            int i;
 
-        fprintf(stderr, "Error could not make ptrace() request %d.  %m.\n", request);
-        exit(EXIT_FAILURE);
+            switch (info.op)
+            {
+                case PTRACE_SYSCALL_INFO_ENTRY:
+                    sysCallPtr->nr = info.entry.nr;
+                    for (i = 0; i < MAX_SYSCALL_ARGS; i++)
+                    {
+                        sysCallPtr->args[i] = info.entry.args[i];
+                    }
+                    return LE_OK;
+
+                case PTRACE_SYSCALL_INFO_SECCOMP:
+                    sysCallPtr->nr = info.seccomp.nr;
+                    for (i = 0; i < MAX_SYSCALL_ARGS; i++)
+                    {
+                        sysCallPtr->args[i] = info.seccomp.args[i];
+                    }
+                    return LE_OK;
+
+                default:
+                    return LE_NOT_FOUND;
+            }
+        }
     }
+#endif
 
-    return LE_OK;
+    return GetSysCallFromRegs(pid, sysCallPtr);
 }
 
 
-#if defined(__NR_recvfrom) && defined(__NR_sendto) && defined(__NR_connect) && defined(__NR_bind)
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Reads bufSize number of bytes from the tracee's memory starting at addr.
@@ -446,21 +682,49 @@ static int Ptrace
 static le_result_t ReadTraceeBuf
 (
     pid_t pid,                  ///< [IN] PID (actually the thread ID) of the tracee.
-    int addr,                   ///< [IN] Address to start reading from.
-    char* bufPtr,               ///< [OUT] Buffer to store the string in.
+    unsigned long addr,         ///< [IN] Address to start reading from.
+    void* bufPtr,               ///< [OUT] Buffer to store the data in.
     size_t bufSize              ///< [IN] Size of the buffer.
 )
 {
-    int i = 0;
+    if (CanReadVm)
+    {
+        struct iovec localVec = { .iov_base = bufPtr, .iov_len = bufSize };
+        struct iovec remoteVec = { .iov_base = (void*)addr, .iov_len = bufSize };
 
-    for (; i < bufSize; i++)
+        ssize_t readSize = process_vm_readv(pid, &localVec, 1, &remoteVec, 1, 0);
+
+        if (readSize == (ssize_t)bufSize)
+        {
+            return LE_OK;
+        }
+
+        if ( (readSize >= 0) || (errno == EFAULT) || (errno == ESRCH) )
+        {
+            return LE_FAULT;
+        }
+
+        INTERNAL_ERR_IF((errno != ENOSYS) && (errno != EPERM),
+                        "Could not read tracee's address.  %m.");
+
+        // Fall back to reading through ptrace.
+        CanReadVm = false;
+    }
+
+    // PTRACE_PEEKDATA reads a word at a time, from word aligned addresses.
+    size_t i = 0;
+
+    while (i < bufSize)
     {
+        unsigned long wordAddr = (addr + i) & ~(sizeof(long) - 1);
+        size_t offset = (addr + i) - wordAddr;
+
         errno = 0;
-        char c = ptrace(PTRACE_PEEKDATA, pid, addr + i, NULL);
+        long word = ptrace(PTRACE_PEEKDATA, pid, (void*)wordAddr, NULL);
 
-        if ( (c == -1) && (errno != 0) )
+        if ( (word == -1) && (errno != 0) )
         {
-            if (errno == ESRCH)
+            if ( (errno == ESRCH) || (errno == EIO) || (errno == EFAULT) )
             {
                 return LE_FAULT;
             }
@@ -468,13 +732,21 @@ static le_result_t ReadTraceeBuf
             INTERNAL_ERR("Could not read tracee's address.  %m.");
         }
 
-        bufPtr[i] = c;
+        size_t copySize = sizeof(word) - offset;
+
+        if (copySize > bufSize - i)
+        {
+            copySize = bufSize - i;
+        }
+
+        memcpy((char*)bufPtr + i, (char*)&word + offset, copySize);
+
+        i += copySize;
     }
 
     return LE_OK;
 }
 
-#endif
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -489,46 +761,48 @@ static le_result_t ReadTraceeBuf
 static le_result_t ReadTraceeStr
 (
     pid_t pid,                  ///< [IN] PID (actually the thread ID) of the tracee.
-    int addr,                   ///< [IN] Address to start reading from.
+    unsigned long addr,         ///< [IN] Address to start reading from.
     char* bufPtr,               ///< [OUT] Buffer to store the string in.
     size_t bufSize              ///< [IN] Size of the buffer.
 )
 {
-    int i = 0;
+    static size_t pageSize = 0;
 
-    while (i < bufSize-1)
+    if (pageSize == 0)
     {
-        errno = 0;
-        char c = ptrace(PTRACE_PEEKDATA, pid, addr + i, NULL);
+        pageSize = sysconf(_SC_PAGESIZE);
+    }
 
-        if ( (c == -1) && (errno != 0) )
-        {
-            if (errno == ESRCH)
-            {
-                return LE_FAULT;
-            }
+    size_t len = 0;
 
-            INTERNAL_ERR("Could not read tracee's address.  %m.");
-        }
+    while (len < bufSize - 1)
+    {
+        // Don't read past the end of the page, or the word when reading with ptrace, as the string
+        // may end right before memory that can't be read.
+        unsigned long chunkAddr = addr + len;
+        size_t chunkSize = CanReadVm ? (pageSize - (chunkAddr % pageSize)) :
+                                       (sizeof(long) - (chunkAddr % sizeof(long)));
 
-        if (c == 0)
+        if (chunkSize > bufSize - 1 - len)
         {
-            bufPtr[i] = '\0';
-            break;
+            chunkSize = bufSize - 1 - len;
         }
 
-        bufPtr[i] = c;
+        if (ReadTraceeBuf(pid, chunkAddr, bufPtr + len, chunkSize) != LE_OK)
+        {
+            return LE_FAULT;
+        }
 
-        i++;
-    }
+        if (memchr(bufPtr + len, '\0', chunkSize) != NULL)
+        {
+            return LE_OK;
+        }
 
-    if (i >= bufSize-1)
-    {
-        bufPtr[bufSize-1] = '\0';
-        return LE_OVERFLOW;
+        len += chunkSize;
     }
 
-    return LE_OK;
+    bufPtr[bufSize - 1] = '\0';
+    return LE_OVERFLOW;
 }
 
 
@@ -545,43 +819,40 @@ static le_result_t ReadTraceeStr
 static le_result_t GetAccessPath
 (
     pid_t pid,                          ///< [IN] PID of the tracee.
-    Registers_t* regPtr,                ///< [IN] The tracee's set of registers when the system call
-                                        ///       was made.
-    const FileAccessSysCall_t* sysCallPtr, ///< [IN] The system call the tracee made.
+    const SysCall_t* sysCallPtr,        ///< [IN] The system call the tracee made.
+    const FileAccessSysCall_t* callObjPtr, ///< [IN] The file access system call object.
     char* bufPtr,                       ///< [OUT] Buffer to hold the path.
     size_t bufSize                      ///< [IN] Buffer size.
 )
 {
-    switch (sysCallPtr->sysCallNum)
+    unsigned long argAddr = sysCallPtr->args[callObjPtr->srcPathArgIndex];
+
+    switch (callObjPtr->sysCallNum)
     {
-#if defined(__NR_recvfrom) && defined(__NR_sendto) && defined(__NR_connect) && defined(__NR_bind)
-        case __NR_recvfrom:
+#if defined(__NR_sendto) && defined(__NR_connect) && defined(__NR_bind)
         case __NR_sendto:
         case __NR_connect:
         case __NR_bind:
         {
-            // Get the address of the struct sockaddr
-            int sockAddr = GetSysCallArg(regPtr, sysCallPtr->srcPathArgIndex);
+            // The argument is the address of the struct sockaddr, and it's followed by its length.
+            socklen_t addrLen = sysCallPtr->args[callObjPtr->srcPathArgIndex + 1];
 
             // Get the address family.
             sa_family_t sun_family;
 
-            if ( (ReadTraceeBuf(pid, sockAddr, (char*)&sun_family, sizeof(sun_family)) == LE_OK) &&
+            // Check that this is not an unnamed socket.
+            if ( (addrLen > sizeof(sa_family_t)) &&
+                 (ReadTraceeBuf(pid, argAddr, &sun_family, sizeof(sun_family)) == LE_OK) &&
                  (sun_family == AF_UNIX) )
             {
-                // Get the length of the sockaddr_un.
-                socklen_t addrLen;
-
-                int addrLenAddr = GetSysCallArg(regPtr, sysCallPtr->srcPathArgIndex + 1);
+                // Get the start of the sun_path in sockaddr_un.  Abstract sockets' names start with
+                // a null character, and are not in the file system.
+                unsigned long pathAddr = argAddr + offsetof(struct sockaddr_un, sun_path);
 
-                // Check that this is not an unnamed socket.
-                if ( (ReadTraceeBuf(pid, addrLenAddr, (char*)&addrLen, sizeof(addrLen)) == LE_OK) &&
-                     (addrLen != sizeof(sa_family_t)) )
+                if ( (ReadTraceeStr(pid, pathAddr, bufPtr, bufSize) == LE_OK) &&
+                     (bufPtr[0] != '\0') )
                 {
-                    // Get the start of the sun_path in sockaddr_un.
-                    size_t pathAddr = sockAddr + offsetof(struct sockaddr_un, sun_path);
-
-                    return ReadTraceeStr(pid, pathAddr, bufPtr, bufSize);
+                    return LE_OK;
                 }
             }
             return LE_FAULT;
@@ -589,10 +860,7 @@ static le_result_t GetAccessPath
 #endif
 
         default:
-        {
-            int pathAddr = GetSysCallArg(regPtr, sysCallPtr->srcPathArgIndex);
-            return ReadTraceeStr(pid, pathAddr, bufPtr, bufSize);
-        }
+            return ReadTraceeStr(pid, argAddr, bufPtr, bufSize);
     }
 }
 
@@ -630,6 +898,35 @@ static Tracee_t* GetTracee
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the ptrace options to set on the tracees.
+ *
+ * @return
+ *      The ptrace options, as the data argument for ptrace().
+ */
+//--------------------------------------------------------------------------------------------------
+static void* GetTraceOptions
+(
+    void
+)
+{
+    int options = PTRACE_O_TRACESYSGOOD |
+                  PTRACE_O_TRACEEXEC |
+                  PTRACE_O_TRACECLONE |
+                  PTRACE_O_TRACEFORK |
+                  PTRACE_O_TRACEVFORK;
+
+    if (UseFilter)
+    {
+        // The filtered system calls only stop the tracee if this is set.
+        options |= PTRACE_O_TRACESECCOMP;
+    }
+
+    return (void*)(intptr_t)options;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Attaches to the app's process.
@@ -645,15 +942,30 @@ static void AttachHandler
 {
     LE_INFO("Attaching to process %d.", pid);
 
-    // Attach to the process.
-    if (Ptrace(PTRACE_ATTACH, pid, NULL, NULL) == LE_NOT_FOUND)
+    // Attach to the process.  When filtering, the options must be set before the process is
+    // unblocked, as the process installs the filter itself before it execs, and will fail the
+    // filtered system calls if it is not being traced with PTRACE_O_TRACESECCOMP.
+    if (UseFilter)
     {
-        fprintf(stderr, "Error could not attach to %d.  %m.\n", pid);
-        exit(EXIT_FAILURE);
+        if (Ptrace(PTRACE_SEIZE, pid, NULL, GetTraceOptions()) == LE_NOT_FOUND)
+        {
+            fprintf(stderr, "Error could not attach to %d.  %m.\n", pid);
+            exit(EXIT_FAILURE);
+        }
+
+        GetTracee(pid)->needInit = false;
     }
+    else
+    {
+        if (Ptrace(PTRACE_ATTACH, pid, NULL, NULL) == LE_NOT_FOUND)
+        {
+            fprintf(stderr, "Error could not attach to %d.  %m.\n", pid);
+            exit(EXIT_FAILURE);
+        }
 
-    // Create an object for this tracee.
-    GetTracee(pid);
+        // Create an object for this tracee.
+        GetTracee(pid);
+    }
 
     // Request the supervisor to unblock the process.
     LE_INFO("Unblocking process %d.", pid);
@@ -676,6 +988,61 @@ static void StoreAppName
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops the app when sbtrace exits.
+ *
+ * The app's processes can't make the filtered system calls when they are not traced, so they must
+ * not be left running.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StopApp
+(
+    void
+)
+{
+    le_appCtrl_Stop(AppNamePtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asks the supervisor to filter the system calls that the app's processes stop at, to only the
+ * system calls that access files.
+ *
+ * Falls back to stopping at every system call if the system doesn't support filtering.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetSysCallFilter
+(
+    void
+)
+{
+    int32_t sysCalls[NUM_ARRAY_MEMBERS(FileAccessSysCalls)];
+    size_t i;
+
+    LE_ASSERT(NUM_ARRAY_MEMBERS(sysCalls) <= LE_APPCTRL_MAX_TRACE_SYS_CALLS);
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(FileAccessSysCalls); i++)
+    {
+        sysCalls[i] = FileAccessSysCalls[i].sysCallNum;
+    }
+
+    le_result_t result = le_appCtrl_SetTraceSysCalls(AppRef, sysCalls, NUM_ARRAY_MEMBERS(sysCalls));
+
+    if (result != LE_OK)
+    {
+        printf("System call filters are not supported, the app will be stopped at every system "
+               "call.\n\n");
+
+        UseFilter = false;
+        return;
+    }
+
+    atexit(StopApp);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Start tracing the app.
@@ -727,6 +1094,11 @@ static void StartAppTrace
     // Set an attach handler.
     le_appCtrl_AddTraceAttachHandler(AppRef, AttachHandler, NULL);
 
+    if (UseFilter)
+    {
+        SetSysCallFilter();
+    }
+
     // Start the app.
     result = le_appCtrl_Start(AppNamePtr);
 
@@ -1032,26 +1404,58 @@ static File_t* FindPathInList
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the index of the flags argument of an open() or openat() system call.
+ *
+ * @return
+ *      The index of the flags argument.
+ *      -1 if the system call doesn't open files.
+ */
+//--------------------------------------------------------------------------------------------------
+static int GetOpenFlagsArgIndex
+(
+    long sysCallNum                 ///< [IN] System call number.
+)
+{
+#ifdef __NR_open
+    if (sysCallNum == __NR_open)
+    {
+        return 1;
+    }
+#endif
+
+#ifdef __NR_openat
+    if (sysCallNum == __NR_openat)
+    {
+        return 2;
+    }
+#endif
+
+    return -1;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the permission for the current open() system call and merges that with what is already in
  * the user's buffer, producing an updated permission string.  For example, if the buffer was "r"
  * and the current open() call has write permission then the buffer would be updated to be "rw".
  *
- * @note This function should only be called if the tracee is in an open() sys call.
+ * @note This function should only be called if the tracee is in an open() or openat() sys call.
  */
 //--------------------------------------------------------------------------------------------------
 static void GetOpenSysCallPermStr
 (
-    pid_t pid,              ///< [IN] Process that made the system call.
-    Registers_t* regPtr,    ///< [IN] The tracees's set of registers when the system call was made.
-    char* bufPtr,           ///< [OUT] Buffer to store the permission string.
-    size_t bufSize          ///< [IN] Size of buffer.
+    const SysCall_t* sysCallPtr,    ///< [IN] The system call.
+    char* bufPtr,                   ///< [OUT] Buffer to store the permission string.
+    size_t bufSize                  ///< [IN] Size of buffer.
 )
 {
     INTERNAL_ERR_IF(bufSize < 3, "Buffer for permission string is too small.");
 
-    int mode = GetSysCallArg(regPtr, 1) & 0x03;  // Only last two bits are the mode.
+    // Only last two bits are the mode.
+    int mode = sysCallPtr->args[GetOpenFlagsArgIndex(sysCallPtr->nr)] & 0x03;
 
     switch (mode)
     {
@@ -1099,12 +1503,11 @@ static void GetOpenSysCallPermStr
 //--------------------------------------------------------------------------------------------------
 static void SetDevicePermissions
 (
-    pid_t pid,              ///< [IN] Process that made the system call.
-    Registers_t* regPtr,    ///< [IN] The process's set of registers when the system call was made.
-    File_t* devFilePtr      ///< [IN] The device file object to set permissions on.
+    const SysCall_t* sysCallPtr,    ///< [IN] The open system call.
+    File_t* devFilePtr              ///< [IN] The device file object to set permissions on.
 )
 {
-    GetOpenSysCallPermStr(pid, regPtr, devFilePtr->permStr, sizeof(devFilePtr->permStr));
+    GetOpenSysCallPermStr(sysCallPtr, devFilePtr->permStr, sizeof(devFilePtr->permStr));
 
     if (devFilePtr->permStr[0] != '\0')
     {
@@ -1130,7 +1533,7 @@ static void SetDevicePermissions
 static bool IsLinkException
 (
     const char* pathPtr,            ///< [IN] File path.
-    int sysCallNum                  ///< [IN] System call number.
+    long sysCallNum                 ///< [IN] System call number.
 )
 {
     // ld.so.cache is generally not needed in a sanbox.
@@ -1141,11 +1544,52 @@ static bool IsLinkException
 
     // readlink(/proc/self/exe) is done by the dynamic linker and is generally not needed in a
     // sanbox.
-    if ( (sysCallNum == __NR_readlink) && (strcmp(pathPtr, "/proc/self/exe") == 0) )
+    if (strcmp(pathPtr, "/proc/self/exe") == 0)
+    {
+#ifdef __NR_readlink
+        if (sysCallNum == __NR_readlink)
+        {
+            return true;
+        }
+#endif
+
+#ifdef __NR_readlinkat
+        if (sysCallNum == __NR_readlinkat)
+        {
+            return true;
+        }
+#endif
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records that the app has accessed a path.
+ *
+ * @return
+ *      true if the app has already accessed the path.
+ *      false if this is the first time.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool CheckSeenPath
+(
+    const char* pathPtr             ///< [IN] File path.
+)
+{
+    if (le_hashmap_ContainsKey(SeenPathMap, pathPtr))
     {
         return true;
     }
 
+    char* seenPathPtr = le_mem_ForceAlloc(SeenPathPool);
+
+    LE_ASSERT(le_utf8_Copy(seenPathPtr, pathPtr, MAX_PATH_BYTES, NULL) == LE_OK);
+
+    le_hashmap_Put(SeenPathMap, seenPathPtr, seenPathPtr);
+
     return false;
 }
 
@@ -1160,49 +1604,56 @@ static void HandleSysCall
     pid_t pid               ///< [IN] Process that made the system call.
 )
 {
-    // Read the register for this system call.
-    Registers_t regs;
+    // Get the system call number and arguments.
+    SysCall_t sysCall;
 
-    if (Ptrace(PTRACE_GETREGS, pid, NULL, &regs) == LE_NOT_FOUND)
+    if (GetSysCall(pid, &sysCall) != LE_OK)
     {
         return;
     }
 
-    // Get the system call number.
-    int callNum = GetSysCallNum(&regs);
-
     // Check if the system call is trying to access a file or directory.
-    const FileAccessSysCall_t* callObjPtr = FindFileAccessSysCallObj(callNum);
+    const FileAccessSysCall_t* callObjPtr = FindFileAccessSysCallObj(sysCall.nr);
 
     if (callObjPtr != NULL)
     {
         // Get the path to the file/dir the sys call is trying to access.
         char path[MAX_PATH_BYTES] = "";
 
-        if (GetAccessPath(pid, &regs, callObjPtr, path, sizeof(path)) != LE_OK)
+        if (GetAccessPath(pid, &sysCall, callObjPtr, path, sizeof(path)) != LE_OK)
         {
             return;
         }
 
+        NumSysCallsTraced++;
+
         LE_DEBUG("[%d] %s(%s)", pid, callObjPtr->sysCallName, path);
 
         // Handle exceptions.
-        if (IsLinkException(path, callNum))
+        if (IsLinkException(path, sysCall.nr))
         {
             return;
         }
 
+        bool isOpen = (GetOpenFlagsArgIndex(sysCall.nr) >= 0);
+
         // Set permissions for devices that have already been added to the app's working dir.
-        if ( (callNum == __NR_open) && (IsDevice(path)) )
+        if ( isOpen && (IsDevice(path)) )
         {
             File_t* filePtr = FindPathInList(path, &AddedDevicesList);
 
             if (filePtr != NULL)
             {
-                SetDevicePermissions(pid, &regs, filePtr);
+                SetDevicePermissions(&sysCall, filePtr);
             }
         }
 
+        // Whatever was decided the first time the app accessed the path still stands.
+        if (CheckSeenPath(path))
+        {
+            return;
+        }
+
         if (CanAddFile(AppNamePtr, path))
         {
             if (ShouldAddFile(AppNamePtr, pid, callObjPtr->sysCallName, path))
@@ -1228,9 +1679,9 @@ static void HandleSysCall
                     // Add the file to the list of added devices.
                     le_sls_Queue(&AddedDevicesList, &(filePtr->link));
 
-                    if (callNum == __NR_open)
+                    if (isOpen)
                     {
-                        SetDevicePermissions(pid, &regs, filePtr);
+                        SetDevicePermissions(&sysCall, filePtr);
                     }
                 }
                 else
@@ -1321,6 +1772,9 @@ static void CreateRequiresSection
     const char* fileToUsePtr = RequiresPathPtr;
     char reqFilePath[MAX_PATH_BYTES] = "";
 
+    printf("Traced %zu file system calls to %zu different paths.\n\n",
+           NumSysCallsTraced, le_hashmap_Size(SeenPathMap));
+
     if (fileToUsePtr == NULL)
     {
         // Ask the user for the path.
@@ -1460,11 +1914,7 @@ static void SigChildHandler
             {
                 // Set ptrace options.
                 if (Ptrace(PTRACE_SETOPTIONS, traceePtr->tid, NULL,
-                           (void*)(PTRACE_O_TRACESYSGOOD |
-                                   PTRACE_O_TRACEEXEC |
-                                   PTRACE_O_TRACECLONE |
-                                   PTRACE_O_TRACEFORK |
-                                   PTRACE_O_TRACEVFORK)) == LE_NOT_FOUND)
+                           GetTraceOptions()) == LE_NOT_FOUND)
                 {
                     continue;
                 }
@@ -1495,8 +1945,13 @@ static void SigChildHandler
                 }
             }
 
+            // Handle the filtered system calls.
+            if ( (status >> 8) == (SIGTRAP | PTRACE_EVENT_SECCOMP << 8) )
+            {
+                HandleSysCall(pid);
+            }
             // Handle syscall-stops.
-            if (sig == (SIGTRAP | 0x80))
+            else if (sig == (SIGTRAP | 0x80))
             {
                 if (!(traceePtr->inSyscall))
                 {
@@ -1505,14 +1960,16 @@ static void SigChildHandler
 
                 traceePtr->inSyscall = !(traceePtr->inSyscall);
             }
-            else if (sig != SIGTRAP)
+            else if ( (sig != SIGTRAP) && ((status >> 16) != PTRACE_EVENT_STOP) )
             {
                 // Forward signals to the tracee.
                 sigToDeliver = sig;
             }
 
-            // Restart the tracee.
-            if (Ptrace(PTRACE_SYSCALL, pid, NULL, (void*)(intptr_t)sigToDeliver) == LE_NOT_FOUND)
+            // Restart the tracee.  When filtering, the kernel stops it at the next filtered system
+            // call, so it doesn't need to be stopped at every system call.
+            if (Ptrace(UseFilter ? PTRACE_CONT : PTRACE_SYSCALL, pid, NULL,
+                       (void*)(intptr_t)sigToDeliver) == LE_NOT_FOUND)
             {
                 continue;
             }
@@ -1620,6 +2077,11 @@ COMPONENT_INIT
     // Create the file object memory pool.
     FilePool = le_mem_CreatePool("FilePool", sizeof(File_t));
 
+    // Create the pool and map of the paths the app has accessed.
+    SeenPathPool = le_mem_CreatePool("SeenPathPool", MAX_PATH_BYTES);
+    SeenPathMap = le_hashmap_Create("SeenPaths", ESTIMATED_NUM_PATHS, le_hashmap_HashString,
+                                    le_hashmap_EqualsString);
+
     // Create the shutdown timer.
     ShutdownTimer = le_timer_Create("ShutdownTimer");
     LE_ASSERT(le_timer_SetHandler(ShutdownTimer, CheckAppShutdown) == LE_OK);
@@ -1637,6 +2099,7 @@ COMPONENT_INIT
     // Handle options.
     le_arg_SetFlagCallback(PrintHelp, "h", "help");
     le_arg_SetStringCallback(SetRequireFilePath, "o", "output");
+    le_arg_SetFlagCallback(DisableFilter, NULL, "no-filter");
 
     // Get the app to trace.
     le_arg_AddPositionalCallback(StoreAppName);